@@ -12,8 +12,10 @@ AC_DEFUN([X_AC_SLURMRESTD],
 [
   dnl
   dnl Check if slurmrestd is requested and define BUILD_SLURMRESTD
-  dnl if it is.
+  dnl if it is. The connection manager is built on epoll.
   dnl
+  AC_CHECK_HEADERS([sys/epoll.h])
+
   AC_MSG_CHECKING([whether to compile slurmrestd])
   AC_ARG_ENABLE(
     [slurmrestd],
@@ -28,11 +30,12 @@ AC_DEFUN([X_AC_SLURMRESTD],
   )
 
   if test "x$x_ac_slurmrestd" != "xno"; then
-    if test -n "$x_ac_cv_http_parser_dir" && test -n "$x_ac_cv_json_dir"; then
+    if test -n "$x_ac_cv_http_parser_dir" && test -n "$x_ac_cv_json_dir" &&
+       test "x$ac_cv_header_sys_epoll_h" = "xyes"; then
       x_ac_slurmrestd=yes
     else
       if test "x$x_ac_slurmrestd" = "xyes"; then
-        AC_MSG_ERROR([unable to build slurmrestd without http-parser and json libraries])
+        AC_MSG_ERROR([unable to build slurmrestd without http-parser and json libraries and sys/epoll.h])
       else
         x_ac_slurmrestd=no
       fi
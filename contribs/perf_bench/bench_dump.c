@@ -0,0 +1,132 @@
+/*****************************************************************************\
+ *  bench_dump.c - load a job table dump for the output benchmarks
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "bench_dump.h"
+
+#define BENCH_DUMP_COLS 17
+
+/* mysql -B writes NULL as the string "NULL" */
+static char *_str(char *val)
+{
+	if (!xstrcmp(val, "NULL"))
+		return NULL;
+	return xstrdup(val);
+}
+
+static int _parse_line(char *line, bench_job_t *job)
+{
+	char *val[BENCH_DUMP_COLS], *save = line, *tok;
+	int i;
+
+	line[strcspn(line, "\n")] = '\0';
+	for (i = 0; i < BENCH_DUMP_COLS; i++) {
+		if (!(tok = strsep(&save, "\t")))
+			return -1;
+		val[i] = tok;
+	}
+
+	job->job_id = strtoul(val[0], NULL, 10);
+	job->name = _str(val[1]);
+	job->partition = _str(val[2]);
+	job->account = _str(val[3]);
+	job->uid = strtoul(val[4], NULL, 10);
+	job->gid = strtoul(val[5], NULL, 10);
+	job->nodes = _str(val[6]);
+	job->nnodes = strtoul(val[7], NULL, 10);
+	job->state = strtoul(val[8], NULL, 10);
+	job->exit_code = strtoul(val[9], NULL, 10);
+	job->submit = strtoll(val[10], NULL, 10);
+	job->eligible = strtoll(val[11], NULL, 10);
+	job->start = strtoll(val[12], NULL, 10);
+	job->end = strtoll(val[13], NULL, 10);
+	job->timelimit = strtoul(val[14], NULL, 10);
+	job->tres_alloc = _str(val[15]);
+	job->tres_req = _str(val[16]);
+
+	return 0;
+}
+
+extern bench_job_t *bench_dump_load(const char *file, int *cnt)
+{
+	FILE *fp = fopen(file, "r");
+	bench_job_t *jobs = NULL;
+	char *line = NULL;
+	size_t line_size = 0;
+	int size = 0, line_num = 0;
+
+	*cnt = 0;
+	if (!fp) {
+		perror(file);
+		return NULL;
+	}
+
+	while (getline(&line, &line_size, fp) > 0) {
+		if (!line_num++)
+			continue;	/* header */
+		if (*cnt == size) {
+			size = size ? (size * 2) : 1024;
+			xrealloc(jobs, size * sizeof(bench_job_t));
+		}
+		if (_parse_line(line, &jobs[*cnt])) {
+			fprintf(stderr, "%s:%d: expected %d columns\n",
+				file, line_num, BENCH_DUMP_COLS);
+			xfree(jobs);
+			*cnt = 0;
+			break;
+		}
+		(*cnt)++;
+	}
+	free(line);
+	fclose(fp);
+
+	if (!jobs && (line_num < 2))
+		fprintf(stderr, "%s: no jobs\n", file);
+	return jobs;
+}
+
+extern double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
@@ -0,0 +1,81 @@
+/*****************************************************************************\
+ *  bench_dump.h - load a job table dump for the output benchmarks
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _BENCH_DUMP_H
+#define _BENCH_DUMP_H
+
+#include <inttypes.h>
+#include <time.h>
+
+/*
+ * One row of the job table of the accounting database, as dumped with
+ *
+ *   mysql -B -e "SELECT id_job, job_name, \`partition\`, account, id_user,
+ *	id_group, nodelist, nodes_alloc, state, exit_code, time_submit,
+ *	time_eligible, time_start, time_end, timelimit, tres_alloc, tres_req
+ *	FROM <cluster>_job_table" <StorageLoc>
+ */
+typedef struct {
+	uint32_t job_id;
+	char *name;
+	char *partition;
+	char *account;
+	uint32_t uid;
+	uint32_t gid;
+	char *nodes;
+	uint32_t nnodes;
+	uint32_t state;
+	uint32_t exit_code;
+	time_t submit;
+	time_t eligible;
+	time_t start;
+	time_t end;
+	uint32_t timelimit;
+	char *tres_alloc;
+	char *tres_req;
+} bench_job_t;
+
+/*
+ * Load the jobs of a dump
+ * IN file - dump written by the query above, the first line is the header
+ * OUT cnt - number of jobs loaded
+ * RET array of jobs or NULL on error, never free'd
+ */
+extern bench_job_t *bench_dump_load(const char *file, int *cnt);
+
+/* RET seconds on a monotonic clock */
+extern double bench_now(void);
+
+#endif
@@ -0,0 +1,235 @@
+/*****************************************************************************\
+ *  sacct_bench.c - time the sacct output of a job table dump
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+/*
+ * Build the job and step records sacct gets from slurmdbd out of a job table
+ * dump, each job with a batch step and one step, and time printing them
+ * with sacct's print_fields(). The output goes to stdout, the time to stderr.
+ *
+ * usage: sacct_bench <dump> [rows] [fields]
+ *   rows   - number of jobs to print, the dump is repeated as needed
+ *   fields - as sacct --format, the default is the --long set
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/common/uid.h"
+#include "src/sacct/sacct.h"
+
+#include "bench_dump.h"
+
+#define BENCH_ROWS 100000
+
+/* Step usage, the TRES ids are those of the table below */
+static void _set_stats(slurmdb_stats_t *stats)
+{
+	stats->tres_usage_in_ave = xstrdup("1=3600,2=1048576,6=4096,7=2097152");
+	stats->tres_usage_in_max = xstrdup("1=3600,2=1048576,6=4096,7=2097152");
+	stats->tres_usage_in_max_nodeid = xstrdup("1=0,2=1,6=0,7=1");
+	stats->tres_usage_in_max_taskid = xstrdup("1=0,2=3,6=0,7=1");
+	stats->tres_usage_in_min = xstrdup("1=1200,2=524288,6=2048,7=1048576");
+	stats->tres_usage_in_min_nodeid = xstrdup("1=0,2=1,6=0,7=1");
+	stats->tres_usage_in_min_taskid = xstrdup("1=0,2=3,6=0,7=1");
+	stats->tres_usage_in_tot = xstrdup("1=7200,2=2097152,6=8192,7=4194304");
+	stats->tres_usage_out_ave = xstrdup("6=1024");
+	stats->tres_usage_out_max = xstrdup("6=1024");
+	stats->tres_usage_out_max_nodeid = xstrdup("6=0");
+	stats->tres_usage_out_max_taskid = xstrdup("6=0");
+	stats->tres_usage_out_min = xstrdup("6=512");
+	stats->tres_usage_out_min_nodeid = xstrdup("6=0");
+	stats->tres_usage_out_min_taskid = xstrdup("6=0");
+	stats->tres_usage_out_tot = xstrdup("6=2048");
+	stats->act_cpufreq = 2400000;
+	stats->consumed_energy = NO_VAL64;
+}
+
+static void _add_tres(uint32_t id, char *type, char *name)
+{
+	slurmdb_tres_rec_t *tres = xmalloc(sizeof(*tres));
+
+	tres->id = id;
+	tres->type = xstrdup(type);
+	tres->name = xstrdup(name);
+	list_append(g_tres_list, tres);
+}
+
+static slurmdb_job_rec_t *_make_job(bench_job_t *dump, uint32_t job_id)
+{
+	slurmdb_job_rec_t *job = xmalloc(sizeof(*job));
+
+	job->jobid = job_id;
+	job->array_task_id = NO_VAL;
+	job->het_job_offset = NO_VAL;
+	job->jobname = xstrdup(dump->name);
+	job->partition = xstrdup(dump->partition);
+	job->account = xstrdup(dump->account);
+	job->cluster = xstrdup("bench");
+	job->uid = dump->uid;
+	job->gid = dump->gid;
+	job->user = uid_to_string_cached(dump->uid);
+	job->nodes = xstrdup(dump->nodes);
+	job->alloc_nodes = dump->nnodes;
+	job->state = dump->state;
+	job->exitcode = dump->exit_code;
+	job->submit = dump->submit;
+	job->eligible = dump->eligible;
+	job->start = dump->start;
+	job->end = dump->end;
+	job->elapsed = (dump->end > dump->start) ?
+		(dump->end - dump->start) : 0;
+	job->timelimit = dump->timelimit;
+	job->tres_alloc_str = xstrdup(dump->tres_alloc);
+	job->tres_req_str = xstrdup(dump->tres_req);
+	job->track_steps = 1;
+	job->show_full = 1;
+	job->steps = list_create(NULL);
+	_set_stats(&job->stats);
+
+	for (int i = 0; i < 2; i++) {
+		slurmdb_step_rec_t *step = xmalloc(sizeof(*step));
+
+		step->job_ptr = job;
+		step->step_id.job_id = job->jobid;
+		step->step_id.step_id = i ? 0 : SLURM_BATCH_SCRIPT;
+		step->step_id.step_het_comp = NO_VAL;
+		step->stepname = xstrdup(i ? "a.out" : "batch");
+		step->nodes = xstrdup(job->nodes);
+		step->nnodes = job->alloc_nodes;
+		step->ntasks = job->alloc_nodes;
+		step->state = job->state;
+		step->exitcode = job->exitcode;
+		step->start = job->start;
+		step->end = job->end;
+		step->elapsed = job->elapsed;
+		step->tres_alloc_str = xstrdup(job->tres_alloc_str);
+		step->req_cpufreq_min = NO_VAL;
+		step->req_cpufreq_max = NO_VAL;
+		step->req_cpufreq_gov = NO_VAL;
+		_set_stats(&step->stats);
+		list_append(job->steps, step);
+	}
+
+	return job;
+}
+
+/* As sacct's --format, but without the %<width> suffix */
+static void _set_fields(char *format)
+{
+	char *tmp = xstrdup(format), *save = NULL, *tok;
+
+	print_fields_list = list_create(NULL);
+	for (tok = strtok_r(tmp, ",", &save); tok;
+	     tok = strtok_r(NULL, ",", &save)) {
+		int i;
+
+		for (i = 0; fields[i].name; i++)
+			if (!xstrncasecmp(fields[i].name, tok, strlen(tok)))
+				break;
+		if (!fields[i].name) {
+			fprintf(stderr, "unknown field %s\n", tok);
+			exit(1);
+		}
+		list_append(print_fields_list, &fields[i]);
+	}
+	xfree(tmp);
+
+	field_count = list_count(print_fields_list);
+	print_fields_itr = list_iterator_create(print_fields_list);
+}
+
+int main(int argc, char **argv)
+{
+	int rows = (argc > 2) ? atoi(argv[2]) : BENCH_ROWS, cnt;
+	bench_job_t *dump;
+	List job_list;
+	ListIterator itr;
+	slurmdb_job_rec_t *job;
+	double start;
+
+	if ((argc < 2) || (rows <= 0)) {
+		fprintf(stderr, "usage: %s <dump> [rows] [fields]\n", argv[0]);
+		return 1;
+	}
+	if (!(dump = bench_dump_load(argv[1], &cnt)))
+		return 1;
+
+	slurm_conf_init(NULL);
+	sacct_init();
+	params.job_cond->flags |= JOBCOND_FLAG_NO_TRUNC;
+	print_fields_parsable_print = PRINT_FIELDS_PARSABLE_NO_ENDING;
+	_set_fields((argc > 3) ? argv[3] : LONG_FIELDS);
+
+	/* the TRES table of a default install with GPUs */
+	g_tres_list = list_create(NULL);
+	_add_tres(TRES_CPU, "cpu", NULL);
+	_add_tres(TRES_MEM, "mem", NULL);
+	_add_tres(TRES_ENERGY, "energy", NULL);
+	_add_tres(TRES_NODE, "node", NULL);
+	_add_tres(TRES_BILLING, "billing", NULL);
+	_add_tres(TRES_FS_DISK, "fs", "disk");
+	_add_tres(TRES_VMEM, "vmem", NULL);
+	_add_tres(TRES_PAGES, "pages", NULL);
+	_add_tres(1001, "gres", "gpu");
+	g_qos_list = list_create(NULL);
+
+	/* job ids stay unique when the dump is repeated */
+	job_list = list_create(NULL);
+	for (int i = 0; i < rows; i++)
+		list_append(job_list,
+			    _make_job(&dump[i % cnt],
+				      dump[i % cnt].job_id +
+				      (i / cnt) * 10000000));
+
+	print_fields_header(print_fields_list);
+	start = bench_now();
+	itr = list_iterator_create(job_list);
+	while ((job = list_next(itr))) {
+		ListIterator step_itr = list_iterator_create(job->steps);
+		slurmdb_step_rec_t *step;
+
+		print_fields(JOB, job);
+		while ((step = list_next(step_itr)))
+			print_fields(JOBSTEP, step);
+		list_iterator_destroy(step_itr);
+	}
+	list_iterator_destroy(itr);
+	fflush(stdout);
+	fprintf(stderr, "%d jobs, %d rows printed in %.3f seconds\n",
+		rows, rows * 3, bench_now() - start);
+
+	return 0;
+}
@@ -0,0 +1,140 @@
+/*****************************************************************************\
+ *  squeue_bench.c - time the squeue output of a job table dump
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+/*
+ * Build the job records squeue gets from slurmctld out of a job table dump
+ * and time sorting and printing them with squeue's print_jobs_array(). The
+ * output goes to stdout, the time to stderr.
+ *
+ * usage: squeue_bench <dump> [rows] [sort] [format]
+ *   rows   - number of jobs to print, the dump is repeated as needed
+ *   sort   - as squeue --sort
+ *   format - as squeue --format
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include "src/squeue/print.h"
+#include "src/squeue/squeue.h"
+
+#include "bench_dump.h"
+
+#define BENCH_ROWS 100000
+#define BENCH_FORMAT "%.18i %.9P %.8j %.8u %.2t %.10M %.6D %R"
+
+/* What squeue.c has for the rest of squeue */
+struct squeue_parameters params;
+int max_line_size;
+
+/* Used by print_jobs_array() for --priority, there is no slurmctld to ask */
+extern int slurm_load_partitions(time_t update_time,
+				 partition_info_msg_t **part_buffer_ptr,
+				 uint16_t show_flags)
+{
+	*part_buffer_ptr = xmalloc(sizeof(partition_info_msg_t));
+	return SLURM_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+	int rows = (argc > 2) ? atoi(argv[2]) : BENCH_ROWS, cnt;
+	char *format = (argc > 4) ? argv[4] : BENCH_FORMAT;
+	bench_job_t *dump;
+	job_info_t *jobs;
+	time_t shift = 0;
+	double start;
+
+	if ((argc < 2) || (rows <= 0)) {
+		fprintf(stderr, "usage: %s <dump> [rows] [sort] [format]\n",
+			argv[0]);
+		return 1;
+	}
+	if (!(dump = bench_dump_load(argv[1], &cnt)))
+		return 1;
+
+	/* move the times of the dump so that it ends now */
+	for (int i = 0; i < cnt; i++)
+		shift = MAX(shift, MAX(dump[i].submit, dump[i].start));
+	shift = time(NULL) - shift;
+
+	/*
+	 * The dump holds finished jobs, show the jobs that had started as
+	 * running and the others as pending so that every job is printed.
+	 */
+	jobs = xcalloc(rows, sizeof(job_info_t));
+	for (int i = 0; i < rows; i++) {
+		bench_job_t *d = &dump[i % cnt];
+		job_info_t *job = &jobs[i];
+
+		/* job ids stay unique when the dump is repeated */
+		job->job_id = d->job_id + (i / cnt) * 10000000;
+		job->array_task_id = NO_VAL;
+		job->name = xstrdup(d->name);
+		job->partition = xstrdup(d->partition);
+		job->account = xstrdup(d->account);
+		job->user_id = d->uid;
+		job->group_id = d->gid;
+		job->submit_time = d->submit + shift;
+		if (d->start) {
+			job->job_state = JOB_RUNNING;
+			job->nodes = xstrdup(d->nodes);
+			job->start_time = d->start + shift;
+			job->end_time = job->start_time + (d->timelimit * 60);
+		} else
+			job->job_state = JOB_PENDING;
+		job->num_nodes = MAX(d->nnodes, 1);
+		job->time_limit = d->timelimit;
+		job->state_reason = WAIT_PRIORITY;
+		job->priority = (d->job_id * 2654435761u) % 100000;
+	}
+
+	max_line_size = 4096;
+	params.all_flag = true;
+	params.format = format;
+	params.sort = (argc > 3) ? xstrdup(argv[3]) : NULL;
+	params.format_list = list_create(NULL);
+	parse_format(format);
+
+	start = bench_now();
+	print_jobs_array(jobs, rows, params.format_list);
+	fflush(stdout);
+	fprintf(stderr, "%d jobs sorted and printed in %.3f seconds\n",
+		rows, bench_now() - start);
+
+	return 0;
+}
@@ -13,7 +13,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #include <errno.h>
 
@@ -42,6 +44,11 @@ static int PMI2_fd = -1;
 static int PMI2_size = 1;
 static int PMI2_rank = 0;
 
+/* slot of this task in the node-local KVS put segment, if any */
+static void *PMI2_shm = NULL;
+static size_t PMI2_shm_size = 0;
+static PMI2_shm_slot *PMI2_shm_slot_p = NULL;
+
 static pthread_mutex_t pmi2_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /* XXX DJG the "const"s on both of these functions and the Keyvalpair
@@ -92,6 +99,9 @@ static void init_kv_strdup_intsuffix(PMI2_Keyvalpair *kv, const char key_prefix[
 
 
 static int getPMIFD(void);
+static void PMIi_ShmInit(void);
+static void PMIi_ShmFini(void);
+static int PMIi_ShmPut(const char key[], const char value[]);
 static int PMIi_ReadCommandExp( int fd, PMI2_Command *cmd, const char *exp, int* rc, const char **errmsg );
 static int PMIi_ReadCommand( int fd, PMI2_Command *cmd );
 
@@ -333,6 +343,8 @@ int PMI2_Init(int *spawned, int *size, int *rank, int *appnum)
         pmi2_errno = PMI2_SUCCESS;
     }
 
+    PMIi_ShmInit();
+
 
     phony();
 
@@ -365,6 +377,7 @@ int PMI2_Finalize(void)
         shutdown(PMI2_fd, SHUT_RDWR);
         close(PMI2_fd);
     }
+    PMIi_ShmFini();
 
 fn_exit:
     PMI2U_printf("[END]");
@@ -717,6 +730,10 @@ int PMI2_KVS_Put(const char key[], const char value[])
     PMI2U_printf("[BEGIN]");
     pthread_mutex_lock(&pmi2_mutex);
 
+    /* staged in shared memory, slurmstepd collects it at the fence */
+    if (PMIi_ShmPut(key, value))
+        goto fn_exit;
+
     pmi2_errno = PMIi_WriteSimpleCommandStr(PMI2_fd, &cmd, KVSPUT_CMD, KEY_KEY, key, VALUE_KEY, value, NULL);
     if (pmi2_errno) PMI2U_ERR_SETANDJUMP(1, pmi2_errno, "PMIi_WriteSimpleCommandStr");
     pmi2_errno = PMIi_ReadCommandExp(PMI2_fd, &cmd, KVSPUTRESP_CMD, &rc, &errmsg);
@@ -1931,6 +1948,79 @@ static int accept_one_connection(int list_sock)
 }
 
 
+/* Map the KVS put segment slurmstepd set up for the tasks on this node.
+ * Any problem just leaves the puts on the PMI socket. */
+static void PMIi_ShmInit(void)
+{
+    char *p;
+    int fd, slot;
+    struct stat st;
+    PMI2_shm_hdr *hdr;
+    void *shm;
+
+    if (!(p = getenv(PMI2_SHM_FD_ENV)))
+        return;
+    fd = atoi(p);
+    if (!(p = getenv(PMI2_SHM_RANK_ENV)))
+        return;
+    slot = atoi(p);
+
+    if ((fstat(fd, &st) < 0) || (st.st_size < PMI2_SHM_HDR_SIZE))
+        return;
+    shm = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (shm == MAP_FAILED)
+        return;
+
+    hdr = shm;
+    if ((hdr->magic != PMI2_SHM_MAGIC) ||
+        (hdr->version != PMI2_SHM_VERSION) ||
+        (hdr->slot_size != PMI2_SHM_SLOT_SIZE) ||
+        (slot < 0) || (slot >= hdr->slot_cnt) ||
+        (PMI2_SHM_HDR_SIZE + (size_t) hdr->slot_cnt * hdr->slot_size >
+         (size_t) st.st_size)) {
+        PMI2U_printf("ignoring invalid KVS segment");
+        munmap(shm, st.st_size);
+        return;
+    }
+
+    PMI2_shm = shm;
+    PMI2_shm_size = st.st_size;
+    PMI2_shm_slot_p = (PMI2_shm_slot *) ((char *) shm + PMI2_SHM_HDR_SIZE +
+                                         (size_t) slot * PMI2_SHM_SLOT_SIZE);
+    close(fd);
+}
+
+static void PMIi_ShmFini(void)
+{
+    if (PMI2_shm)
+        munmap(PMI2_shm, PMI2_shm_size);
+    PMI2_shm = NULL;
+    PMI2_shm_size = 0;
+    PMI2_shm_slot_p = NULL;
+}
+
+/* Append key/value to our slot. Returns 0 if it does not fit, the caller
+ * then sends it with a regular put command. */
+static int PMIi_ShmPut(const char key[], const char value[])
+{
+    PMI2_shm_slot *slot = PMI2_shm_slot_p;
+    size_t key_len, val_len;
+
+    if (!slot)
+        return 0;
+
+    key_len = strlen(key) + 1;
+    val_len = strlen(value) + 1;
+    if (slot->used + key_len + val_len > PMI2_SHM_DATA_SIZE)
+        return 0;
+
+    memcpy(slot->data + slot->used, key, key_len);
+    memcpy(slot->data + slot->used + key_len, value, val_len);
+    slot->used += key_len + val_len;
+    slot->count++;
+    return 1;
+}
+
 /* Get the FD to use for PMI operations.  If a port is used, rather than
    a pre-established FD (i.e., via pipe), this routine will handle the
    initial handshake.
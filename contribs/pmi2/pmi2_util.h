@@ -17,6 +17,29 @@
 #define TRUE  1
 #define FALSE 0
 
+/* node-local KVS put segment, see src/plugins/mpi/pmi2/pmi.h */
+#define PMI2_SHM_FD_ENV      "SLURM_PMI2_SHM_FD"
+#define PMI2_SHM_RANK_ENV    "SLURM_PMI2_SHM_RANK"
+#define PMI2_SHM_MAGIC       0x504d4932
+#define PMI2_SHM_VERSION     1
+#define PMI2_SHM_HDR_SIZE    64
+#define PMI2_SHM_SLOT_SIZE   (64 * 1024)
+
+typedef struct {
+    unsigned int magic;
+    unsigned int version;
+    unsigned int slot_cnt;
+    unsigned int slot_size;
+} PMI2_shm_hdr;
+
+typedef struct {
+    unsigned int used;
+    unsigned int count;
+    char data[];
+} PMI2_shm_slot;
+
+#define PMI2_SHM_DATA_SIZE (PMI2_SHM_SLOT_SIZE - sizeof(PMI2_shm_slot))
+
 #ifdef DEBUG
     #define PMI2U_printf(x...) do {				\
 	char logstr[1024];					\
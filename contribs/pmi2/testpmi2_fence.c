@@ -0,0 +1,111 @@
+/*
+ * Time KVS put + fence + get the way an MPI library's wireup does it.
+ *
+ * Every rank puts <keys> values of <size> bytes, fences and then reads
+ * the values of its right neighbor, <iters> times. The time each rank
+ * spends in PMI2_KVS_Fence() is published through the KVS itself and
+ * rank 0 reports the min/avg/max over all ranks.
+ *
+ * usage: testpmi2_fence [iters] [keys] [size]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <slurm/pmi2.h>
+
+static long usec_since(struct timeval *start)
+{
+    struct timeval end;
+
+    gettimeofday(&end, NULL);
+    return (end.tv_sec - start->tv_sec) * 1000000 +
+           (end.tv_usec - start->tv_usec);
+}
+
+int main(int argc, char **argv)
+{
+    int spawned, size, rank, appnum;
+    int iters = 10, keys = 4, vsize = 256;
+    int i, k, r, len;
+    long fence_usec = 0, min = -1, max = 0, sum = 0, t;
+    char jobid[50], key[64], tbuf[32], *val, *got;
+    struct timeval start;
+
+    if (argc > 1)
+        iters = atoi(argv[1]);
+    if (argc > 2)
+        keys = atoi(argv[2]);
+    if (argc > 3)
+        vsize = atoi(argv[3]);
+    if ((vsize < 2) || (vsize > PMI2_MAX_VALLEN))
+        vsize = 256;
+
+    if (PMI2_Init(&spawned, &size, &rank, &appnum) != PMI2_SUCCESS) {
+        perror("PMI2_Init failed");
+        return 1;
+    }
+    PMI2_Job_GetId(jobid, sizeof(jobid));
+
+    val = malloc(vsize);
+    got = malloc(PMI2_MAX_VALLEN);
+
+    for (i = 0; i < iters; i++) {
+        for (k = 0; k < keys; k++) {
+            snprintf(key, sizeof(key), "bc-%d-%d-%d", i, rank, k);
+            memset(val, 'a' + (rank + k) % 26, vsize - 1);
+            val[vsize - 1] = '\0';
+            if (PMI2_KVS_Put(key, val) != PMI2_SUCCESS) {
+                fprintf(stderr, "%d> PMI2_KVS_Put failed\n", rank);
+                return 1;
+            }
+        }
+
+        gettimeofday(&start, NULL);
+        if (PMI2_KVS_Fence() != PMI2_SUCCESS) {
+            fprintf(stderr, "%d> PMI2_KVS_Fence failed\n", rank);
+            return 1;
+        }
+        fence_usec += usec_since(&start);
+
+        r = (rank + 1) % size;
+        for (k = 0; k < keys; k++) {
+            snprintf(key, sizeof(key), "bc-%d-%d-%d", i, r, k);
+            if ((PMI2_KVS_Get(jobid, PMI2_ID_NULL, key, got,
+                              PMI2_MAX_VALLEN, &len) != PMI2_SUCCESS) ||
+                (len != vsize - 1) || (got[0] != 'a' + (r + k) % 26)) {
+                fprintf(stderr, "%d> bad value for %s\n", rank, key);
+                return 1;
+            }
+        }
+    }
+
+    snprintf(key, sizeof(key), "fence-usec-%d", rank);
+    snprintf(tbuf, sizeof(tbuf), "%ld", fence_usec);
+    PMI2_KVS_Put(key, tbuf);
+    PMI2_KVS_Fence();
+
+    if (rank == 0) {
+        for (r = 0; r < size; r++) {
+            snprintf(key, sizeof(key), "fence-usec-%d", r);
+            if (PMI2_KVS_Get(jobid, PMI2_ID_NULL, key, got,
+                             PMI2_MAX_VALLEN, &len) != PMI2_SUCCESS)
+                continue;
+            t = atol(got) / (iters ? iters : 1);
+            sum += t;
+            if ((min < 0) || (t < min))
+                min = t;
+            if (t > max)
+                max = t;
+        }
+        printf("ranks=%d iters=%d keys=%d size=%d fence usec: "
+               "min=%ld avg=%ld max=%ld\n",
+               size, iters, keys, vsize, min, sum / size, max);
+        fflush(stdout);
+    }
+
+    free(val);
+    free(got);
+    PMI2_Finalize();
+    return 0;
+}
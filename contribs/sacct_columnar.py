@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+#
+# Reference decoder of the output of "sacct --columnar".
+#
+# The layout is described in src/sacct/columnar.c. All integers are big
+# endian. A string is a uint32 length including the terminating NUL followed
+# by the characters and the NUL, a length of 0 is a NULL string.
+#
+#   char[8]   magic "SACCTCOL"
+#   uint16    format version
+#   uint32    TRES count, then for each TRES: uint32 id, string type,
+#             string name
+#   uint32    column count, then for each column: string name, uint8 type
+#             (1 uint32, 2 uint64, 3 string)
+#   row groups, each:
+#     uint32  row count, 0 ends the stream
+#     for each column: uint32 size in bytes, then row count values
+#
+# Used as a program it writes the rows as CSV, a NULL string being an empty
+# field, or the TRES table with --tres:
+#
+#   sacct --columnar -a -S 2020-01-01 | sacct_columnar.py > jobs.csv
+#
+# Used as a module, read_columnar() returns the TRES table, the column names
+# and the columns, each a list holding the values of all of the rows.
+
+import csv
+import struct
+import sys
+
+MAGIC = b"SACCTCOL"
+VERSION = 1
+
+COLUMN_UINT32 = 1
+COLUMN_UINT64 = 2
+COLUMN_STRING = 3
+
+
+class ColumnarError(Exception):
+    pass
+
+
+class _Reader:
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def unpack(self, fmt):
+        try:
+            values = struct.unpack_from(fmt, self.data, self.offset)
+        except struct.error:
+            raise ColumnarError("truncated at offset %d" % self.offset)
+        self.offset += struct.calcsize(fmt)
+        return values
+
+    def uint(self, fmt):
+        return self.unpack(fmt)[0]
+
+    def string(self):
+        size = self.uint(">I")
+        if not size:
+            return None
+        end = self.offset + size
+        if end > len(self.data) or self.data[end - 1] != 0:
+            raise ColumnarError("bad string at offset %d" % self.offset)
+        value = self.data[self.offset:end - 1].decode("utf-8", "replace")
+        self.offset = end
+        return value
+
+
+def read_columnar(data):
+    """Decode a whole --columnar output held in data (bytes).
+
+    Returns (tres, names, columns): tres is a list of (id, type, name),
+    names the column names and columns a dict of column name to the list
+    of its values, one per row.
+    """
+    reader = _Reader(data)
+
+    if data[:len(MAGIC)] != MAGIC:
+        raise ColumnarError("not a sacct --columnar output")
+    reader.offset = len(MAGIC)
+    version = reader.uint(">H")
+    if version != VERSION:
+        raise ColumnarError("unknown format version %d" % version)
+
+    tres = []
+    for _ in range(reader.uint(">I")):
+        tres.append((reader.uint(">I"), reader.string(), reader.string()))
+
+    names = []
+    types = []
+    for _ in range(reader.uint(">I")):
+        names.append(reader.string())
+        types.append(reader.uint(">B"))
+    columns = {name: [] for name in names}
+
+    while True:
+        rows = reader.uint(">I")
+        if not rows:
+            break
+        for name, column_type in zip(names, types):
+            size = reader.uint(">I")
+            end = reader.offset + size
+            if column_type == COLUMN_UINT32:
+                columns[name].extend(reader.unpack(">%dI" % rows))
+            elif column_type == COLUMN_UINT64:
+                columns[name].extend(reader.unpack(">%dQ" % rows))
+            elif column_type == COLUMN_STRING:
+                columns[name].extend(reader.string() for _ in range(rows))
+            else:
+                raise ColumnarError("column %s has unknown type %d" %
+                                    (name, column_type))
+            if reader.offset != end:
+                raise ColumnarError("column %s is not %d bytes" %
+                                    (name, size))
+
+    if reader.offset != len(data):
+        raise ColumnarError("%d bytes after the end" %
+                            (len(data) - reader.offset))
+
+    return tres, names, columns
+
+
+def main(argv):
+    args = [arg for arg in argv[1:] if arg != "--tres"]
+    if len(args) > 1:
+        sys.stderr.write("usage: %s [--tres] [file]\n" % argv[0])
+        return 1
+
+    if args:
+        with open(args[0], "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    try:
+        tres, names, columns = read_columnar(data)
+    except ColumnarError as e:
+        sys.stderr.write("%s: %s\n" % (argv[0], e))
+        return 1
+
+    out = csv.writer(sys.stdout)
+    if "--tres" in argv:
+        out.writerow(("ID", "Type", "Name"))
+        out.writerows(tres)
+        return 0
+
+    out.writerow(names)
+    out.writerows(zip(*(columns[name] for name in names)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -201,6 +201,10 @@ enum cluster_fed_states {
 #define JOBCOND_FLAG_NO_DEFAULT_USAGE 0x00000080 /* Use usage_time as the
 						  * submit_time of the job.
 						  */
+#define JOBCOND_FLAG_STREAM           0x00000100 /* Have slurmdbd send the
+						  * jobs in parts as they are
+						  * read, set internally.
+						  */
 
 /* Archive / Purge time flags */
 #define SLURMDB_PURGE_BASE    0x0000ffff   /* Apply to get the number
@@ -212,6 +216,14 @@ enum cluster_fed_states {
 					    * the default */
 #define SLURMDB_PURGE_ARCHIVE 0x00080000   /* Archive before purge */
 
+/*
+ * Values of with_usage in the association, cluster and wckey conditions.
+ * With SLURMDB_USAGE_SUMMED the usage over the whole usage_start/usage_end
+ * range is returned as one record per TRES instead of one per period.
+ */
+#define SLURMDB_USAGE_PERIODS 0x0001 /* Usage per period (any non-zero) */
+#define SLURMDB_USAGE_SUMMED  0x0002 /* Usage summed over the range */
+
 /* Parent account should be used when calculating FairShare */
 #define SLURMDB_FS_USE_PARENT 0x7FFFFFFF
 
@@ -286,7 +298,7 @@ typedef struct {
 
 	List user_list;		/* list of char * */
 
-	uint16_t with_usage;  /* fill in usage */
+	uint16_t with_usage;  /* fill in usage, SLURMDB_USAGE_* */
 	uint16_t with_deleted; /* return deleted associations */
 	uint16_t with_raw_qos; /* return a raw qos or delta_qos */
 	uint16_t with_sub_accts; /* return sub acct information also */
@@ -420,6 +432,10 @@ typedef struct {
 				once flushed from the database */
 	char *insert;     /* an sql statement to be ran containing the
 			     insert of jobs since past */
+	time_t time_end;  /* only load records of a columnar archive_file
+			     up to this time, 0 for no limit */
+	time_t time_start; /* only load records of a columnar archive_file
+			      from this time on, 0 for no limit */
 } slurmdb_archive_rec_t;
 
 typedef struct {
@@ -653,7 +669,7 @@ typedef struct {
 	time_t usage_end;
 	time_t usage_start;
 	uint16_t with_deleted;
-	uint16_t with_usage;
+	uint16_t with_usage;	/* fill in usage, SLURMDB_USAGE_* */
 } slurmdb_cluster_cond_t;
 
 typedef struct {
@@ -1205,7 +1221,7 @@ typedef struct {
 
 	List user_list;		/* list of char * */
 
-	uint16_t with_usage;    /* fill in usage */
+	uint16_t with_usage;    /* fill in usage, SLURMDB_USAGE_* */
 	uint16_t with_deleted;  /* return deleted associations */
 } slurmdb_wckey_cond_t;
 
@@ -1298,6 +1314,15 @@ enum {
 	DBD_ROLLUP_COUNT
 };
 
+/* Phases of an hourly rollup timed in slurmdb_rollup_stats_t */
+enum {
+	DBD_ROLLUP_PHASE_RESV,	/* Reading reservations */
+	DBD_ROLLUP_PHASE_EVENT,	/* Reading cluster and node events */
+	DBD_ROLLUP_PHASE_JOB,	/* Reading and summing jobs */
+	DBD_ROLLUP_PHASE_INSERT,/* Writing the usage tables */
+	DBD_ROLLUP_PHASE_COUNT
+};
+
 typedef struct {
 	char *cluster_name;                      /* Cluster name */
 	uint16_t count[DBD_ROLLUP_COUNT]; /* How many rollups have
@@ -1308,6 +1333,9 @@ typedef struct {
 						     * for each rollup */
 	uint64_t time_total[DBD_ROLLUP_COUNT]; /* Time it took to do each
 						 * rollup */
+	uint64_t phase_time[DBD_ROLLUP_PHASE_COUNT]; /* Time spent in each
+						      * phase of the hourly
+						      * rollups */
 } slurmdb_rollup_stats_t;
 
 typedef struct {
@@ -1630,6 +1658,19 @@ extern List slurmdb_job_modify(void *db_conn,
  */
 extern List slurmdb_jobs_get(void *db_conn, slurmdb_job_cond_t *job_cond);
 
+/*
+ * get info from the storage a part at a time
+ * IN: part_cb - called with each part of the jobs as it arrives, may take
+ *	the slurmdb_job_rec_t's out of the list, returns SLURM_SUCCESS to get
+ *	the next part. Each part covers a later range of submit times than
+ *	the one before.
+ * RET: SLURM_SUCCESS on success SLURM_ERROR else
+ */
+extern int slurmdb_jobs_get_stream(void *db_conn,
+				   slurmdb_job_cond_t *job_cond,
+				   int (*part_cb)(List job_list, void *arg),
+				   void *arg);
+
 /*
  * Fix runaway jobs
  * IN: jobs, a list of all the runaway jobs
@@ -260,7 +260,7 @@ static List _process_util_by_report(void *db_conn, char *calling_name,
 	slurmdb_init_cluster_cond(&cluster_cond, 0);
 
 	cluster_cond.with_deleted = 1;
-	cluster_cond.with_usage = 1;
+	cluster_cond.with_usage = SLURMDB_USAGE_PERIODS | SLURMDB_USAGE_SUMMED;
 	if ((type == CLUSTER_REPORT_UA) || (type == CLUSTER_REPORT_AU)) {
 		start_time = ((slurmdb_assoc_cond_t *)cond)->usage_start;
 		end_time = ((slurmdb_assoc_cond_t *)cond)->usage_end;
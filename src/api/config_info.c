@@ -1987,6 +1987,21 @@ void slurm_print_slurmd_status (FILE* out,
 		slurmd_status_ptr->slurmd_debug);
 	fprintf(out, "Slurmd Logfile           = %s\n",
 		slurmd_status_ptr->slurmd_logfile);
+	fprintf(out, "Slurmstepd Pool          = %u (idle %u)\n",
+		slurmd_status_ptr->stepd_pool_size,
+		slurmd_status_ptr->stepd_pool_idle);
+	fprintf(out, "Slurmstepd Fork Launches = %u (avg %"PRIu64" usec, max %"PRIu64" usec)\n",
+		slurmd_status_ptr->stepd_fork_cnt,
+		slurmd_status_ptr->stepd_fork_cnt ?
+		(slurmd_status_ptr->stepd_fork_usec /
+		 slurmd_status_ptr->stepd_fork_cnt) : 0,
+		slurmd_status_ptr->stepd_fork_max);
+	fprintf(out, "Slurmstepd Pool Launches = %u (avg %"PRIu64" usec, max %"PRIu64" usec)\n",
+		slurmd_status_ptr->stepd_pool_cnt,
+		slurmd_status_ptr->stepd_pool_cnt ?
+		(slurmd_status_ptr->stepd_pool_usec /
+		 slurmd_status_ptr->stepd_pool_cnt) : 0,
+		slurmd_status_ptr->stepd_pool_max);
 	fprintf(out, "Version                  = %s\n",
 		slurmd_status_ptr->version);
 	return;
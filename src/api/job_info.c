@@ -1287,18 +1287,8 @@ extern int slurm_job_batch_script(FILE *out, uint32_t jobid)
 	return rc;
 }
 
-/*
- * slurm_load_jobs - issue RPC to get all job configuration
- *	information if changed since update_time
- * IN update_time - time of current configuration data
- * IN/OUT job_info_msg_pptr - place to store a job configuration pointer
- * IN show_flags -  job filtering option: 0, SHOW_ALL, SHOW_DETAIL or SHOW_LOCAL
- * RET 0 or -1 on error
- * NOTE: free the response using slurm_free_job_info_msg
- */
-extern int
-slurm_load_jobs (time_t update_time, job_info_msg_t **job_info_msg_pptr,
-		 uint16_t show_flags)
+static int _load_jobs(time_t update_time, job_info_msg_t **job_info_msg_pptr,
+		      uint16_t show_flags, job_info_filter_t *filter)
 {
 	slurm_msg_t req_msg;
 	job_info_request_msg_t req;
@@ -1332,10 +1322,25 @@ slurm_load_jobs (time_t update_time, job_info_msg_t **job_info_msg_pptr,
 	req_msg.data     = &req;
 
 	if (show_flags & SHOW_FEDERATION) {
+		/*
+		 * Merging jobs from siblings needs the federation fields of
+		 * every job, so the filter is only sent to the local cluster.
+		 */
 		fed = (slurmdb_federation_rec_t *) ptr;
 		rc = _load_fed_jobs(&req_msg, job_info_msg_pptr, show_flags,
 				    cluster_name, fed);
 	} else {
+		/*
+		 * A slurmctld older than 20.11 does not know the filter. It is
+		 * left out and all jobs are loaded, callers filter them again.
+		 */
+		if (filter &&
+		    (!working_cluster_rec ||
+		     (working_cluster_rec->rpc_version >=
+		      SLURM_20_11_PROTOCOL_VERSION))) {
+			req.filter = filter;
+			req_msg.msg_type = REQUEST_JOB_INFO_FILTER;
+		}
 		rc = _load_cluster_jobs(&req_msg, job_info_msg_pptr,
 					working_cluster_rec);
 	}
@@ -1346,6 +1351,40 @@ slurm_load_jobs (time_t update_time, job_info_msg_t **job_info_msg_pptr,
 	return rc;
 }
 
+/*
+ * slurm_load_jobs - issue RPC to get all job configuration
+ *	information if changed since update_time
+ * IN update_time - time of current configuration data
+ * IN/OUT job_info_msg_pptr - place to store a job configuration pointer
+ * IN show_flags -  job filtering option: 0, SHOW_ALL, SHOW_DETAIL or SHOW_LOCAL
+ * RET 0 or -1 on error
+ * NOTE: free the response using slurm_free_job_info_msg
+ */
+extern int
+slurm_load_jobs (time_t update_time, job_info_msg_t **job_info_msg_pptr,
+		 uint16_t show_flags)
+{
+	return _load_jobs(update_time, job_info_msg_pptr, show_flags, NULL);
+}
+
+/*
+ * slurm_load_jobs_filter - issue RPC to get slurm information about jobs
+ *	matching filter if changed since update_time
+ * IN update_time - time of current configuration data
+ * IN/OUT job_info_msg_pptr - place to store a job configuration pointer
+ * IN show_flags - job filtering options
+ * IN filter - jobs to load and fields to leave out
+ * RET 0 or -1 on error
+ * NOTE: free the response using slurm_free_job_info_msg
+ */
+extern int slurm_load_jobs_filter(time_t update_time,
+				  job_info_msg_t **job_info_msg_pptr,
+				  uint16_t show_flags,
+				  job_info_filter_t *filter)
+{
+	return _load_jobs(update_time, job_info_msg_pptr, show_flags, filter);
+}
+
 /*
  * slurm_load_job_user - issue RPC to get slurm information about all jobs
  *	to be run as the specified user
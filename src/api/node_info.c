@@ -669,17 +669,8 @@ static int _load_fed_nodes(slurm_msg_t *req_msg,
 	return SLURM_SUCCESS;
 }
 
-/*
- * slurm_load_node - issue RPC to get slurm all node configuration information
- *	if changed since update_time
- * IN update_time - time of current configuration data
- * OUT resp - place to store a node configuration pointer
- * IN show_flags - node filtering options
- * RET 0 or a slurm error code
- * NOTE: free the response using slurm_free_node_info_msg
- */
-extern int slurm_load_node(time_t update_time, node_info_msg_t **resp,
-			   uint16_t show_flags)
+static int _load_node(time_t update_time, node_info_msg_t **resp,
+		      uint16_t show_flags, node_info_filter_t *filter)
 {
 	slurm_msg_t req_msg;
 	node_info_request_msg_t req;
@@ -713,10 +704,22 @@ extern int slurm_load_node(time_t update_time, node_info_msg_t **resp,
 	req_msg.data     = &req;
 
 	if ((show_flags & SHOW_FEDERATION) && ptr) { /* "ptr" check for CLANG */
+		/* Siblings may not support the filter, so it is local only */
 		fed = (slurmdb_federation_rec_t *) ptr;
 		rc = _load_fed_nodes(&req_msg, resp, show_flags, cluster_name,
 				     fed);
 	} else {
+		/*
+		 * A slurmctld older than 20.11 does not know the filter. It is
+		 * left out and all nodes are loaded, callers filter them again.
+		 */
+		if (filter &&
+		    (!working_cluster_rec ||
+		     (working_cluster_rec->rpc_version >=
+		      SLURM_20_11_PROTOCOL_VERSION))) {
+			req.filter = filter;
+			req_msg.msg_type = REQUEST_NODE_INFO_FILTER;
+		}
 		rc = _load_cluster_nodes(&req_msg, resp, working_cluster_rec,
 					 show_flags);
 	}
@@ -727,6 +730,38 @@ extern int slurm_load_node(time_t update_time, node_info_msg_t **resp,
 	return rc;
 }
 
+/*
+ * slurm_load_node - issue RPC to get slurm all node configuration information
+ *	if changed since update_time
+ * IN update_time - time of current configuration data
+ * OUT resp - place to store a node configuration pointer
+ * IN show_flags - node filtering options
+ * RET 0 or a slurm error code
+ * NOTE: free the response using slurm_free_node_info_msg
+ */
+extern int slurm_load_node(time_t update_time, node_info_msg_t **resp,
+			   uint16_t show_flags)
+{
+	return _load_node(update_time, resp, show_flags, NULL);
+}
+
+/*
+ * slurm_load_node_filter - issue RPC to get slurm information about nodes
+ *	matching filter if changed since update_time
+ * IN update_time - time of current configuration data
+ * OUT resp - place to store a node configuration pointer
+ * IN show_flags - node filtering options
+ * IN filter - nodes to load and fields to leave out
+ * RET 0 or a slurm error code
+ * NOTE: free the response using slurm_free_node_info_msg
+ */
+extern int slurm_load_node_filter(time_t update_time, node_info_msg_t **resp,
+				  uint16_t show_flags,
+				  node_info_filter_t *filter)
+{
+	return _load_node(update_time, resp, show_flags, filter);
+}
+
 /*
  * slurm_load_node2 - equivalent to slurm_load_node() with addition
  *	of cluster record for communications in a federation
@@ -86,7 +86,8 @@ extern List slurmdb_report_user_top_usage(void *db_conn,
 
 	user_cond->with_deleted = 1;
 	user_cond->with_assocs = 1;
-	user_cond->assoc_cond->with_usage = 1;
+	user_cond->assoc_cond->with_usage =
+		SLURMDB_USAGE_PERIODS | SLURMDB_USAGE_SUMMED;
 	user_cond->assoc_cond->without_parent_info = 1;
 
 	/* This needs to be done on some systems to make sure
@@ -111,7 +112,7 @@ extern List slurmdb_report_user_top_usage(void *db_conn,
 	   are not enforced.
 	*/
 	slurmdb_init_cluster_cond(&cluster_cond, 0);
-	cluster_cond.with_usage = 1;
+	cluster_cond.with_usage = SLURMDB_USAGE_PERIODS | SLURMDB_USAGE_SUMMED;
 	cluster_cond.with_deleted = 1;
 	cluster_cond.usage_end = user_cond->assoc_cond->usage_end;
 	cluster_cond.usage_start = user_cond->assoc_cond->usage_start;
@@ -0,0 +1,497 @@
+/*****************************************************************************\
+ *  archive_col.c - columnar, block compressed accounting archive files
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if HAVE_LIBZ
+# include <zlib.h>
+#endif
+
+#include "slurm/slurm_errno.h"
+#include "src/common/archive_col.h"
+#include "src/common/log.h"
+#include "src/common/slurm_protocol_common.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+/*
+ * File layout, everything packed with the usual pack functions:
+ *
+ *	header:	magic, format version, protocol version, create time,
+ *		type, cluster name, period, time column, column names,
+ *		record count, block count, min time, max time
+ *	block:	row count, min time, max time, compression, raw size,
+ *		block data (packmem)
+ *
+ * Uncompressed block data is, for every column, the byte length of the
+ * column followed by the packstr() of its value in every row.
+ *
+ * The magic can not be mistaken for the protocol version the old row based
+ * archives start with.
+ */
+#define ARCHIVE_COL_MAGIC	0x41524331	/* "ARC1" */
+#define ARCHIVE_COL_VERSION	1
+
+#define COMPRESS_NONE	0
+#define COMPRESS_ZLIB	1
+
+/* Sanity limit on the rows of a block we are asked to read */
+#define MAX_BLOCK_ROWS	(1024 * 1024)
+
+struct archive_col_writer {
+	uint32_t block_cnt;
+	time_t block_max;
+	time_t block_min;
+	uint32_t block_rows;
+	Buf buffer;		/* archive being written */
+	Buf *col_bufs;		/* values of each column in current block */
+	uint32_t col_cnt;
+	uint32_t cnt_offset;	/* offset of record count in buffer */
+	time_t max_time;
+	time_t min_time;
+	uint32_t rec_cnt;
+	uint32_t time_col;
+};
+
+struct archive_col_reader {
+	Buf block;		/* decompressed data of the current block */
+	uint32_t block_cnt;
+	uint32_t block_inx;
+	uint32_t blocks_read;
+	uint32_t blocks_skipped;
+	Buf buffer;		/* archive being read, not owned */
+	archive_col_hdr_t hdr;
+	char **row;		/* values of the row returned */
+	uint32_t row_cnt;	/* rows in the current block */
+	uint32_t row_inx;
+	time_t time_end;
+	time_t time_start;
+	char **values;		/* values of the current block, by column */
+};
+
+static time_t _str_to_time(char *value)
+{
+	if (!value)
+		return 0;
+	return (time_t) strtoll(value, NULL, 10);
+}
+
+/* Append the used part of "in" to "out" */
+static void _append_buf(Buf out, Buf in)
+{
+	uint32_t len = get_buf_offset(in);
+
+	if (remaining_buf(out) < len)
+		grow_buf(out, len);
+	memcpy(get_buf_data(out) + get_buf_offset(out), get_buf_data(in), len);
+	set_buf_offset(out, get_buf_offset(out) + len);
+}
+
+static void _flush_block(archive_col_writer_t *writer)
+{
+	Buf raw;
+	uint32_t raw_size, i;
+	uint8_t compression = COMPRESS_NONE;
+	char *data;
+	uint32_t data_size;
+#if HAVE_LIBZ
+	char *zdata = NULL;
+	uLongf zsize;
+#endif
+
+	if (!writer->block_rows)
+		return;
+
+	raw = init_buf(BUF_SIZE);
+	for (i = 0; i < writer->col_cnt; i++) {
+		pack32(get_buf_offset(writer->col_bufs[i]), raw);
+		_append_buf(raw, writer->col_bufs[i]);
+		set_buf_offset(writer->col_bufs[i], 0);
+	}
+	raw_size = get_buf_offset(raw);
+	data = get_buf_data(raw);
+	data_size = raw_size;
+
+#if HAVE_LIBZ
+	zsize = compressBound(raw_size);
+	zdata = xmalloc_nz(zsize);
+	if ((compress2((Bytef *) zdata, &zsize, (Bytef *) data, raw_size,
+		       Z_DEFAULT_COMPRESSION) == Z_OK) &&
+	    (zsize < raw_size)) {
+		compression = COMPRESS_ZLIB;
+		data = zdata;
+		data_size = zsize;
+	}
+#endif
+
+	pack32(writer->block_rows, writer->buffer);
+	pack_time(writer->block_min, writer->buffer);
+	pack_time(writer->block_max, writer->buffer);
+	pack8(compression, writer->buffer);
+	pack32(raw_size, writer->buffer);
+	packmem(data, data_size, writer->buffer);
+
+#if HAVE_LIBZ
+	xfree(zdata);
+#endif
+	free_buf(raw);
+
+	writer->block_cnt++;
+	writer->block_rows = 0;
+}
+
+extern bool archive_col_detect(Buf buffer)
+{
+	uint32_t offset = get_buf_offset(buffer);
+	uint32_t magic = 0;
+	int rc;
+
+	rc = unpack32(&magic, buffer);
+	set_buf_offset(buffer, offset);
+
+	return ((rc == SLURM_SUCCESS) && (magic == ARCHIVE_COL_MAGIC));
+}
+
+extern archive_col_writer_t *archive_col_writer_create(uint16_t type,
+						       char *cluster_name,
+						       uint16_t period,
+						       char **col_names,
+						       uint32_t col_cnt,
+						       uint32_t time_col)
+{
+	archive_col_writer_t *writer = xmalloc(sizeof(*writer));
+	uint32_t i;
+
+	xassert(time_col < col_cnt);
+
+	writer->col_cnt = col_cnt;
+	writer->time_col = time_col;
+	writer->col_bufs = xcalloc(col_cnt, sizeof(Buf));
+	for (i = 0; i < col_cnt; i++)
+		writer->col_bufs[i] = init_buf(BUF_SIZE);
+
+	writer->buffer = init_buf(1024 * 1024);
+	pack32(ARCHIVE_COL_MAGIC, writer->buffer);
+	pack16(ARCHIVE_COL_VERSION, writer->buffer);
+	pack16(SLURM_PROTOCOL_VERSION, writer->buffer);
+	pack_time(time(NULL), writer->buffer);
+	pack16(type, writer->buffer);
+	packstr(cluster_name, writer->buffer);
+	pack16(period, writer->buffer);
+	pack32(time_col, writer->buffer);
+	packstr_array(col_names, col_cnt, writer->buffer);
+
+	/* Filled in by archive_col_writer_fini() */
+	writer->cnt_offset = get_buf_offset(writer->buffer);
+	pack32(0, writer->buffer);
+	pack32(0, writer->buffer);
+	pack_time(0, writer->buffer);
+	pack_time(0, writer->buffer);
+
+	return writer;
+}
+
+extern void archive_col_add_row(archive_col_writer_t *writer, char **row)
+{
+	time_t row_time = _str_to_time(row[writer->time_col]);
+	uint32_t i;
+
+	for (i = 0; i < writer->col_cnt; i++)
+		packstr(row[i], writer->col_bufs[i]);
+
+	if (!writer->block_rows || (row_time < writer->block_min))
+		writer->block_min = row_time;
+	if (!writer->block_rows || (row_time > writer->block_max))
+		writer->block_max = row_time;
+	if (!writer->rec_cnt || (row_time < writer->min_time))
+		writer->min_time = row_time;
+	if (!writer->rec_cnt || (row_time > writer->max_time))
+		writer->max_time = row_time;
+
+	writer->rec_cnt++;
+	if (++writer->block_rows >= ARCHIVE_COL_BLOCK_ROWS)
+		_flush_block(writer);
+}
+
+extern Buf archive_col_writer_fini(archive_col_writer_t *writer)
+{
+	Buf buffer;
+	uint32_t end_offset, i;
+
+	_flush_block(writer);
+
+	buffer = writer->buffer;
+	end_offset = get_buf_offset(buffer);
+	set_buf_offset(buffer, writer->cnt_offset);
+	pack32(writer->rec_cnt, buffer);
+	pack32(writer->block_cnt, buffer);
+	pack_time(writer->min_time, buffer);
+	pack_time(writer->max_time, buffer);
+	set_buf_offset(buffer, end_offset);
+
+	for (i = 0; i < writer->col_cnt; i++)
+		free_buf(writer->col_bufs[i]);
+	xfree(writer->col_bufs);
+	xfree(writer);
+
+	return buffer;
+}
+
+extern archive_col_reader_t *archive_col_reader_create(Buf buffer,
+						       time_t time_start,
+						       time_t time_end)
+{
+	archive_col_reader_t *reader = xmalloc(sizeof(*reader));
+	archive_col_hdr_t *hdr = &reader->hdr;
+	uint32_t magic, uint32_tmp;
+	uint16_t version;
+
+	reader->buffer = buffer;
+	reader->time_start = time_start;
+	reader->time_end = time_end;
+
+	safe_unpack32(&magic, buffer);
+	if (magic != ARCHIVE_COL_MAGIC) {
+		error("%s: bad magic %x in archive", __func__, magic);
+		goto unpack_error;
+	}
+	safe_unpack16(&version, buffer);
+	if (version > ARCHIVE_COL_VERSION) {
+		error("%s: archive format version %u is newer than supported version %u",
+		      __func__, version, ARCHIVE_COL_VERSION);
+		goto unpack_error;
+	}
+	safe_unpack16(&hdr->protocol_version, buffer);
+	safe_unpack_time(&hdr->create_time, buffer);
+	safe_unpack16(&hdr->type, buffer);
+	safe_unpackstr_xmalloc(&hdr->cluster_name, &uint32_tmp, buffer);
+	safe_unpack16(&hdr->period, buffer);
+	safe_unpack32(&hdr->time_col, buffer);
+	safe_unpackstr_array(&hdr->col_names, &hdr->col_cnt, buffer);
+	safe_unpack32(&hdr->rec_cnt, buffer);
+	safe_unpack32(&reader->block_cnt, buffer);
+	safe_unpack_time(&hdr->min_time, buffer);
+	safe_unpack_time(&hdr->max_time, buffer);
+
+	if (!hdr->col_cnt || (hdr->time_col >= hdr->col_cnt)) {
+		error("%s: bad time column %u of %u columns",
+		      __func__, hdr->time_col, hdr->col_cnt);
+		goto unpack_error;
+	}
+	reader->row = xcalloc(hdr->col_cnt, sizeof(char *));
+
+	return reader;
+
+unpack_error:
+	error("%s: unable to read archive header", __func__);
+	archive_col_reader_destroy(reader);
+	return NULL;
+}
+
+extern archive_col_hdr_t *archive_col_reader_hdr(archive_col_reader_t *reader)
+{
+	return &reader->hdr;
+}
+
+/* Decompress the block data into reader->block */
+static int _inflate_block(archive_col_reader_t *reader, uint8_t compression,
+			  char *data, uint32_t data_size, uint32_t raw_size)
+{
+	char *raw;
+
+	if (raw_size > MAX_PACK_MEM_LEN) {
+		error("%s: block size %u too large", __func__, raw_size);
+		return SLURM_ERROR;
+	}
+
+	if (compression == COMPRESS_NONE) {
+		if (data_size != raw_size)
+			return SLURM_ERROR;
+		raw = xmalloc_nz(raw_size + 1);
+		memcpy(raw, data, raw_size);
+#if HAVE_LIBZ
+	} else if (compression == COMPRESS_ZLIB) {
+		uLongf len = raw_size;
+
+		raw = xmalloc_nz(raw_size + 1);
+		if ((uncompress((Bytef *) raw, &len, (Bytef *) data,
+				data_size) != Z_OK) || (len != raw_size)) {
+			error("%s: unable to decompress block", __func__);
+			xfree(raw);
+			return SLURM_ERROR;
+		}
+#endif
+	} else {
+		error("%s: unsupported block compression %u",
+		      __func__, compression);
+		return SLURM_ERROR;
+	}
+
+	FREE_NULL_BUFFER(reader->block);
+	reader->block = create_buf(raw, raw_size);
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Read block headers until one overlapping the time range is found and
+ * unpack it. Sets reader->row_cnt to 0 once there are no blocks left.
+ */
+static int _next_block(archive_col_reader_t *reader)
+{
+	Buf buffer = reader->buffer;
+	uint32_t col, row, col_len, col_end, raw_size, data_size, uint32_tmp;
+	uint32_t col_cnt = reader->hdr.col_cnt;
+	time_t min_time, max_time;
+	uint8_t compression;
+	char *data;
+
+	reader->row_cnt = 0;
+	reader->row_inx = 0;
+
+	while (reader->block_inx < reader->block_cnt) {
+		reader->block_inx++;
+
+		safe_unpack32(&reader->row_cnt, buffer);
+		safe_unpack_time(&min_time, buffer);
+		safe_unpack_time(&max_time, buffer);
+		safe_unpack8(&compression, buffer);
+		safe_unpack32(&raw_size, buffer);
+		safe_unpackmem_ptr(&data, &data_size, buffer);
+
+		if ((reader->time_start && (max_time < reader->time_start)) ||
+		    (reader->time_end && (min_time > reader->time_end))) {
+			reader->blocks_skipped++;
+			reader->row_cnt = 0;
+			continue;
+		}
+		if (!reader->row_cnt)
+			continue;
+		if ((reader->row_cnt > MAX_BLOCK_ROWS) ||
+		    (_inflate_block(reader, compression, data, data_size,
+				    raw_size) != SLURM_SUCCESS))
+			goto unpack_error;
+		reader->blocks_read++;
+
+		xrecalloc(reader->values, reader->row_cnt * col_cnt,
+			  sizeof(char *));
+		for (col = 0; col < col_cnt; col++) {
+			safe_unpack32(&col_len, reader->block);
+			col_end = get_buf_offset(reader->block) + col_len;
+			for (row = 0; row < reader->row_cnt; row++)
+				safe_unpackmem_ptr(
+					&reader->values[(col *
+							 reader->row_cnt) +
+							row],
+					&uint32_tmp, reader->block);
+			if (get_buf_offset(reader->block) != col_end)
+				goto unpack_error;
+		}
+		return SLURM_SUCCESS;
+	}
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	error("%s: corrupt block %u of archive",
+	      __func__, reader->block_inx);
+	reader->row_cnt = 0;
+	return SLURM_ERROR;
+}
+
+extern int archive_col_next_row(archive_col_reader_t *reader, char ***row)
+{
+	uint32_t col, col_cnt = reader->hdr.col_cnt;
+	time_t row_time;
+	char *value;
+
+	*row = NULL;
+
+	while (1) {
+		if (reader->row_inx >= reader->row_cnt) {
+			if (_next_block(reader) != SLURM_SUCCESS)
+				return SLURM_ERROR;
+			if (!reader->row_cnt)
+				return SLURM_SUCCESS;
+		}
+
+		if (reader->time_start || reader->time_end) {
+			value = reader->values[(reader->hdr.time_col *
+						reader->row_cnt) +
+					       reader->row_inx];
+			row_time = _str_to_time(value);
+			if ((reader->time_start &&
+			     (row_time < reader->time_start)) ||
+			    (reader->time_end &&
+			     (row_time > reader->time_end))) {
+				reader->row_inx++;
+				continue;
+			}
+		}
+
+		for (col = 0; col < col_cnt; col++)
+			reader->row[col] = reader->values[(col *
+							   reader->row_cnt) +
+							  reader->row_inx];
+		reader->row_inx++;
+		*row = reader->row;
+		return SLURM_SUCCESS;
+	}
+}
+
+extern void archive_col_reader_destroy(archive_col_reader_t *reader)
+{
+	uint32_t i;
+
+	if (!reader)
+		return;
+
+	debug2("%s: read %u and skipped %u of %u blocks",
+	       __func__, reader->blocks_read, reader->blocks_skipped,
+	       reader->block_cnt);
+
+	if (reader->hdr.col_names) {
+		for (i = 0; i < reader->hdr.col_cnt; i++)
+			xfree(reader->hdr.col_names[i]);
+		xfree(reader->hdr.col_names);
+	}
+	xfree(reader->hdr.cluster_name);
+	FREE_NULL_BUFFER(reader->block);
+	xfree(reader->row);
+	xfree(reader->values);
+	xfree(reader);
+}
@@ -0,0 +1,124 @@
+/*****************************************************************************\
+ *  archive_col.h - columnar, block compressed accounting archive files
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _ARCHIVE_COL_H
+#define _ARCHIVE_COL_H
+
+#include <time.h>
+
+#include "src/common/pack.h"
+
+/*
+ * A columnar archive holds the rows of one database table as strings. After
+ * a header naming the table type and its columns the rows are stored in
+ * blocks of ARCHIVE_COL_BLOCK_ROWS. Inside a block all the values of the
+ * first column come first, then all the values of the second column and so
+ * on, and the block is compressed with zlib when Slurm was built with it.
+ * Every block records the lowest and highest value of the table's time column
+ * so a reader interested in a time range can skip whole blocks without
+ * decompressing them.
+ */
+
+#define ARCHIVE_COL_BLOCK_ROWS 4096
+
+typedef struct {
+	char *cluster_name;
+	uint32_t col_cnt;
+	char **col_names;
+	time_t create_time;
+	time_t max_time;	/* highest value of time_col in the file */
+	time_t min_time;	/* lowest value of time_col in the file */
+	uint16_t period;	/* DBD_ROLLUP_* for usage tables, else 0 */
+	uint16_t protocol_version;
+	uint32_t rec_cnt;
+	uint32_t time_col;	/* index of the column to filter on */
+	uint16_t type;		/* DBD_GOT_JOBS, DBD_STEP_START, ... */
+} archive_col_hdr_t;
+
+typedef struct archive_col_writer archive_col_writer_t;
+typedef struct archive_col_reader archive_col_reader_t;
+
+/* Return true if the buffer holds a columnar archive */
+extern bool archive_col_detect(Buf buffer);
+
+/*
+ * Start a new columnar archive.
+ * IN type - DBD_GOT_* message type of the records
+ * IN cluster_name - cluster the records belong to
+ * IN period - DBD_ROLLUP_* of usage records, else 0
+ * IN col_names - names of the columns of each row, not copied
+ * IN col_cnt - number of columns
+ * IN time_col - index of the column holding the time rows are ordered by
+ */
+extern archive_col_writer_t *archive_col_writer_create(uint16_t type,
+						       char *cluster_name,
+						       uint16_t period,
+						       char **col_names,
+						       uint32_t col_cnt,
+						       uint32_t time_col);
+
+/* Add a row of col_cnt values (NULL values are allowed) to the archive */
+extern void archive_col_add_row(archive_col_writer_t *writer, char **row);
+
+/* Finish the archive, free the writer and return the archive contents */
+extern Buf archive_col_writer_fini(archive_col_writer_t *writer);
+
+/*
+ * Open a columnar archive for reading.
+ * IN buffer - archive contents, must stay around until the reader is
+ *	destroyed
+ * IN time_start, time_end - only return rows with a time_col value in
+ *	this range, 0 means no limit
+ * RET reader or NULL if the header could not be read
+ */
+extern archive_col_reader_t *archive_col_reader_create(Buf buffer,
+						       time_t time_start,
+						       time_t time_end);
+
+/* Return the header of the archive being read */
+extern archive_col_hdr_t *archive_col_reader_hdr(archive_col_reader_t *reader);
+
+/*
+ * Get the next row of the archive matching the time range.
+ * OUT row - array of col_cnt values, valid until the next call, or NULL
+ *	once all the rows were read
+ * RET SLURM_SUCCESS or SLURM_ERROR if the archive is corrupt
+ */
+extern int archive_col_next_row(archive_col_reader_t *reader, char ***row);
+
+/* Free the reader, logging how many blocks were read and skipped */
+extern void archive_col_reader_destroy(archive_col_reader_t *reader);
+
+#endif
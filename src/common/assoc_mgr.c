@@ -52,12 +52,27 @@
 
 #define ASSOC_HASH_SIZE 1000
 #define ASSOC_HASH_ID_INX(_assoc_id)	(_assoc_id % ASSOC_HASH_SIZE)
+#define ASSOC_MGR_INDEX_SIZE 4096
+#define ASSOC_MGR_INDEX_INX(_key)	((uint32_t)(_key) % ASSOC_MGR_INDEX_SIZE)
+
+/*
+ * Chained hash index into one of the assoc_mgr lists. Unlike assoc_hash the
+ * records are not linked through themselves, so any number of indexes can
+ * point at the same record and keys do not need to be unique. Entries are
+ * kept in the order they were added so a lookup returns the same record a
+ * walk of the list would have.
+ */
+typedef struct index_entry {
+	struct index_entry *next;
+	void *rec;
+} index_entry_t;
 
 slurmdb_assoc_rec_t *assoc_mgr_root_assoc = NULL;
 uint32_t g_qos_max_priority = 0;
 uint32_t g_assoc_max_priority = 0;
 uint32_t g_qos_count = 0;
 uint32_t g_user_assoc_count = 0;
+uint32_t g_assoc_tree_gen = 0;
 uint32_t g_tres_count = 0;
 
 List assoc_mgr_tres_list = NULL;
@@ -76,6 +91,13 @@ static pthread_mutex_t assoc_lock_init = PTHREAD_MUTEX_INITIALIZER;
 static assoc_init_args_t init_setup;
 static slurmdb_assoc_rec_t **assoc_hash_id = NULL;
 static slurmdb_assoc_rec_t **assoc_hash = NULL;
+static index_entry_t **assoc_uid_index = NULL;
+static index_entry_t **qos_id_index = NULL;
+static index_entry_t **qos_name_index = NULL;
+static index_entry_t **user_name_index = NULL;
+static index_entry_t **user_uid_index = NULL;
+static index_entry_t **wckey_id_index = NULL;
+static index_entry_t **wckey_name_index = NULL;
 static int *assoc_mgr_tres_old_pos = NULL;
 
 static bool _running_cache(void)
@@ -100,6 +122,174 @@ static int _get_str_inx(char *name)
 	return index;
 }
 
+static void _index_add(index_entry_t ***index, uint32_t key, void *rec)
+{
+	index_entry_t **entry_pptr, *entry;
+
+	if (!*index)
+		*index = xcalloc(ASSOC_MGR_INDEX_SIZE, sizeof(index_entry_t *));
+
+	entry_pptr = &(*index)[ASSOC_MGR_INDEX_INX(key)];
+	while (*entry_pptr)
+		entry_pptr = &(*entry_pptr)->next;
+
+	entry = xmalloc(sizeof(index_entry_t));
+	entry->rec = rec;
+	*entry_pptr = entry;
+}
+
+static void _index_remove(index_entry_t **index, uint32_t key, void *rec)
+{
+	index_entry_t **entry_pptr, *entry;
+
+	if (!index)
+		return;
+
+	entry_pptr = &index[ASSOC_MGR_INDEX_INX(key)];
+	while ((entry = *entry_pptr)) {
+		if (entry->rec == rec) {
+			*entry_pptr = entry->next;
+			xfree(entry);
+			return;
+		}
+		entry_pptr = &entry->next;
+	}
+}
+
+/* Return the first entry of the chain key falls in, NULL if none */
+static index_entry_t *_index_first(index_entry_t **index, uint32_t key)
+{
+	if (!index)
+		return NULL;
+
+	return index[ASSOC_MGR_INDEX_INX(key)];
+}
+
+static void _index_free(index_entry_t ***index)
+{
+	index_entry_t *entry, *next;
+	int i;
+
+	if (!*index)
+		return;
+
+	for (i = 0; i < ASSOC_MGR_INDEX_SIZE; i++) {
+		for (entry = (*index)[i]; entry; entry = next) {
+			next = entry->next;
+			xfree(entry);
+		}
+	}
+	xfree(*index);
+}
+
+static void _index_user(slurmdb_user_rec_t *user)
+{
+	if (user->uid != NO_VAL)
+		_index_add(&user_uid_index, user->uid, user);
+	_index_add(&user_name_index, _get_str_inx(user->name), user);
+}
+
+static void _unindex_user(slurmdb_user_rec_t *user)
+{
+	if (user->uid != NO_VAL)
+		_index_remove(user_uid_index, user->uid, user);
+	_index_remove(user_name_index, _get_str_inx(user->name), user);
+}
+
+/* locks should be put in place before calling this function USER_WRITE */
+static void _index_user_list(void)
+{
+	slurmdb_user_rec_t *user;
+	ListIterator itr;
+
+	_index_free(&user_uid_index);
+	_index_free(&user_name_index);
+
+	if (!assoc_mgr_user_list)
+		return;
+
+	itr = list_iterator_create(assoc_mgr_user_list);
+	while ((user = list_next(itr)))
+		_index_user(user);
+	list_iterator_destroy(itr);
+}
+
+static void _index_qos(slurmdb_qos_rec_t *qos)
+{
+	_index_add(&qos_id_index, qos->id, qos);
+	_index_add(&qos_name_index, _get_str_inx(qos->name), qos);
+}
+
+static void _unindex_qos(slurmdb_qos_rec_t *qos)
+{
+	_index_remove(qos_id_index, qos->id, qos);
+	_index_remove(qos_name_index, _get_str_inx(qos->name), qos);
+}
+
+/* locks should be put in place before calling this function QOS_WRITE */
+static void _index_qos_list(void)
+{
+	slurmdb_qos_rec_t *qos;
+	ListIterator itr;
+
+	_index_free(&qos_id_index);
+	_index_free(&qos_name_index);
+
+	if (!assoc_mgr_qos_list)
+		return;
+
+	itr = list_iterator_create(assoc_mgr_qos_list);
+	while ((qos = list_next(itr)))
+		_index_qos(qos);
+	list_iterator_destroy(itr);
+}
+
+static void _index_wckey(slurmdb_wckey_rec_t *wckey)
+{
+	_index_add(&wckey_id_index, wckey->id, wckey);
+	_index_add(&wckey_name_index, _get_str_inx(wckey->name), wckey);
+}
+
+static void _unindex_wckey(slurmdb_wckey_rec_t *wckey)
+{
+	_index_remove(wckey_id_index, wckey->id, wckey);
+	_index_remove(wckey_name_index, _get_str_inx(wckey->name), wckey);
+}
+
+/* locks should be put in place before calling this function WCKEY_WRITE */
+static void _index_wckey_list(void)
+{
+	slurmdb_wckey_rec_t *wckey;
+	ListIterator itr;
+
+	_index_free(&wckey_id_index);
+	_index_free(&wckey_name_index);
+
+	if (!assoc_mgr_wckey_list)
+		return;
+
+	itr = list_iterator_create(assoc_mgr_wckey_list);
+	while ((wckey = list_next(itr)))
+		_index_wckey(wckey);
+	list_iterator_destroy(itr);
+}
+
+/* locks should be put in place before calling this function USER_READ */
+static slurmdb_user_rec_t *_find_user_uid(uint32_t uid)
+{
+	index_entry_t *entry;
+	slurmdb_user_rec_t *user;
+
+	for (entry = _index_first(user_uid_index, uid); entry;
+	     entry = entry->next) {
+		user = entry->rec;
+		if (user->uid == uid)
+			return user;
+	}
+
+	return NULL;
+}
+
 static int _assoc_hash_index(slurmdb_assoc_rec_t *assoc)
 {
 	int index;
@@ -147,6 +337,8 @@ static void _add_assoc_hash(slurmdb_assoc_rec_t *assoc)
 	inx = _assoc_hash_index(assoc);
 	assoc->assoc_next = assoc_hash[inx];
 	assoc_hash[inx] = assoc;
+
+	_index_add(&assoc_uid_index, assoc->uid, assoc);
 }
 
 static bool _remove_from_assoc_list(slurmdb_assoc_rec_t *assoc)
@@ -314,6 +506,8 @@ static void _delete_assoc_hash(slurmdb_assoc_rec_t *assoc)
 		return;	/* Fix CLANG false positive error */
 	} else
 		*assoc_pptr = assoc_ptr->assoc_next;
+
+	_index_remove(assoc_uid_index, assoc->uid, assoc);
 }
 
 
@@ -667,16 +861,6 @@ static int _local_update_assoc_qos_list(slurmdb_assoc_rec_t *assoc,
 	return SLURM_SUCCESS;
 }
 
-static int _list_find_uid(void *x, void *key)
-{
-	slurmdb_user_rec_t *user = (slurmdb_user_rec_t *) x;
-	uint32_t uid = *(uint32_t *) key;
-
-	if (user->uid == uid)
-		return 1;
-	return 0;
-}
-
 /* locks should be put in place before calling this function USER_WRITE */
 static void _set_user_default_acct(slurmdb_assoc_rec_t *assoc)
 {
@@ -686,8 +870,7 @@ static void _set_user_default_acct(slurmdb_assoc_rec_t *assoc)
 
 	/* set up the default if this is it */
 	if ((assoc->is_def == 1) && (assoc->uid != NO_VAL)) {
-		slurmdb_user_rec_t *user = list_find_first(
-			assoc_mgr_user_list, _list_find_uid, &assoc->uid);
+		slurmdb_user_rec_t *user = _find_user_uid(assoc->uid);
 
 		if (!user)
 			return;
@@ -713,8 +896,7 @@ static void _set_user_default_wckey(slurmdb_wckey_rec_t *wckey)
 
 	/* set up the default if this is it */
 	if ((wckey->is_def == 1) && (wckey->uid != NO_VAL)) {
-		slurmdb_user_rec_t *user = list_find_first(
-			assoc_mgr_user_list, _list_find_uid, &wckey->uid);
+		slurmdb_user_rec_t *user = _find_user_uid(wckey->uid);
 
 		if (!user)
 			return;
@@ -1016,6 +1198,7 @@ static int _post_assoc_list(void)
 
 	xfree(assoc_hash_id);
 	xfree(assoc_hash);
+	_index_free(&assoc_uid_index);
 
 	itr = list_iterator_create(assoc_mgr_assoc_list);
 
@@ -1050,6 +1233,7 @@ static int _post_assoc_list(void)
 	_calculate_assoc_norm_priorities(true);
 
 	slurmdb_sort_hierarchical_assoc_list(assoc_mgr_assoc_list, true);
+	g_assoc_tree_gen++;
 
 	//END_TIMER2("load_associations");
 	return SLURM_SUCCESS;
@@ -1642,6 +1826,7 @@ static int _get_assoc_mgr_qos_list(void *db_conn, int enforce)
 	new_list = NULL;
 
 	_post_qos_list(assoc_mgr_qos_list);
+	_index_qos_list();
 
 	assoc_mgr_unlock(&locks);
 
@@ -1662,6 +1847,7 @@ static int _get_assoc_mgr_user_list(void *db_conn, int enforce)
 	assoc_mgr_user_list = acct_storage_g_get_users(db_conn, uid, &user_q);
 
 	if (!assoc_mgr_user_list) {
+		_index_user_list();
 		assoc_mgr_unlock(&locks);
 		if (enforce & ACCOUNTING_ENFORCE_ASSOCS) {
 			error("%s: no list was made.", __func__);
@@ -1672,6 +1858,7 @@ static int _get_assoc_mgr_user_list(void *db_conn, int enforce)
 	}
 
 	_post_user_list(assoc_mgr_user_list);
+	_index_user_list();
 
 	assoc_mgr_unlock(&locks);
 	return SLURM_SUCCESS;
@@ -1708,6 +1895,7 @@ static int _get_assoc_mgr_wckey_list(void *db_conn, int enforce)
 		/* create list so we don't keep calling this if there
 		   isn't anything there */
 		assoc_mgr_wckey_list = list_create(slurmdb_destroy_wckey_rec);
+		_index_wckey_list();
 		assoc_mgr_unlock(&locks);
 		if (enforce & ACCOUNTING_ENFORCE_WCKEYS) {
 			error("%s: no list was made.", __func__);
@@ -1720,6 +1908,7 @@ static int _get_assoc_mgr_wckey_list(void *db_conn, int enforce)
 	}
 
 	_post_wckey_list(assoc_mgr_wckey_list);
+	_index_wckey_list();
 
 	assoc_mgr_unlock(&locks);
 
@@ -1895,6 +2084,7 @@ static int _refresh_assoc_mgr_qos_list(void *db_conn, int enforce)
 	}
 
 	assoc_mgr_qos_list = current_qos;
+	_index_qos_list();
 
 	assoc_mgr_unlock(&locks);
 
@@ -1928,6 +2118,7 @@ static int _refresh_assoc_mgr_user_list(void *db_conn, int enforce)
 	FREE_NULL_LIST(assoc_mgr_user_list);
 
 	assoc_mgr_user_list = current_users;
+	_index_user_list();
 
 	assoc_mgr_unlock(&locks);
 
@@ -1969,6 +2160,7 @@ static int _refresh_assoc_wckey_list(void *db_conn, int enforce)
 	FREE_NULL_LIST(assoc_mgr_wckey_list);
 
 	assoc_mgr_wckey_list = current_wckeys;
+	_index_wckey_list();
 	assoc_mgr_unlock(&locks);
 
 	return SLURM_SUCCESS;
@@ -2094,6 +2286,13 @@ extern int assoc_mgr_fini(bool save_state)
 
 	xfree(assoc_hash_id);
 	xfree(assoc_hash);
+	_index_free(&assoc_uid_index);
+	_index_free(&qos_id_index);
+	_index_free(&qos_name_index);
+	_index_free(&user_name_index);
+	_index_free(&user_uid_index);
+	_index_free(&wckey_id_index);
+	_index_free(&wckey_name_index);
 
 	assoc_mgr_unlock(&locks);
 
@@ -2238,7 +2437,7 @@ extern int assoc_mgr_get_user_assocs(void *db_conn,
 				     int enforce,
 				     List assoc_list)
 {
-	ListIterator itr = NULL;
+	index_entry_t *entry;
 	slurmdb_assoc_rec_t *found_assoc = NULL;
 	int set = 0;
 
@@ -2256,8 +2455,9 @@ extern int assoc_mgr_get_user_assocs(void *db_conn,
 
 	xassert(assoc_mgr_assoc_list);
 
-	itr = list_iterator_create(assoc_mgr_assoc_list);
-	while ((found_assoc = list_next(itr))) {
+	for (entry = _index_first(assoc_uid_index, assoc->uid); entry;
+	     entry = entry->next) {
+		found_assoc = entry->rec;
 		if (assoc->uid != found_assoc->uid) {
 			debug4("not the right user %u != %u",
 			       assoc->uid, found_assoc->uid);
@@ -2267,7 +2467,6 @@ extern int assoc_mgr_get_user_assocs(void *db_conn,
 		list_append(assoc_list, found_assoc);
 		set = 1;
 	}
-	list_iterator_destroy(itr);
 
 	if (!set) {
 		debug("UID %u has no associations", assoc->uid);
@@ -2598,7 +2797,7 @@ extern int assoc_mgr_fill_in_user(void *db_conn, slurmdb_user_rec_t *user,
 				  slurmdb_user_rec_t **user_pptr,
 				  bool locked)
 {
-	ListIterator itr = NULL;
+	index_entry_t *entry = NULL;
 	slurmdb_user_rec_t * found_user = NULL;
 	assoc_mgr_lock_t locks = { .user = READ_LOCK };
 
@@ -2620,16 +2819,17 @@ extern int assoc_mgr_fill_in_user(void *db_conn, slurmdb_user_rec_t *user,
 		return SLURM_SUCCESS;
 	}
 
-	itr = list_iterator_create(assoc_mgr_user_list);
-	while ((found_user = list_next(itr))) {
-		if (user->uid != NO_VAL) {
-			if (user->uid == found_user->uid)
-				break;
-		} else if (user->name
-			   && !xstrcasecmp(user->name, found_user->name))
+	if (user->uid != NO_VAL)
+		found_user = _find_user_uid(user->uid);
+	else if (user->name)
+		entry = _index_first(user_name_index,
+				     _get_str_inx(user->name));
+	for (; entry; entry = entry->next) {
+		found_user = entry->rec;
+		if (!xstrcasecmp(user->name, found_user->name))
 			break;
+		found_user = NULL;
 	}
-	list_iterator_destroy(itr);
 
 	if (!found_user) {
 		if (!locked)
@@ -2675,7 +2875,7 @@ extern int assoc_mgr_fill_in_qos(void *db_conn, slurmdb_qos_rec_t *qos,
 				 int enforce,
 				 slurmdb_qos_rec_t **qos_pptr, bool locked)
 {
-	ListIterator itr = NULL;
+	index_entry_t *entry;
 	slurmdb_qos_rec_t * found_qos = NULL;
 	assoc_mgr_lock_t locks = { .qos = READ_LOCK };
 
@@ -2710,14 +2910,23 @@ extern int assoc_mgr_fill_in_qos(void *db_conn, slurmdb_qos_rec_t *qos,
 		return SLURM_SUCCESS;
 	}
 
-	itr = list_iterator_create(assoc_mgr_qos_list);
-	while ((found_qos = list_next(itr))) {
+	for (entry = _index_first(qos_id_index, qos->id); entry;
+	     entry = entry->next) {
+		found_qos = entry->rec;
 		if (qos->id == found_qos->id)
 			break;
-		else if (qos->name && !xstrcasecmp(qos->name, found_qos->name))
-			break;
+		found_qos = NULL;
+	}
+	if (!found_qos && qos->name) {
+		for (entry = _index_first(qos_name_index,
+					  _get_str_inx(qos->name));
+		     entry; entry = entry->next) {
+			found_qos = entry->rec;
+			if (!xstrcasecmp(qos->name, found_qos->name))
+				break;
+			found_qos = NULL;
+		}
 	}
-	list_iterator_destroy(itr);
 
 	if (!found_qos) {
 		if (!locked)
@@ -2823,7 +3032,7 @@ extern int assoc_mgr_fill_in_wckey(void *db_conn, slurmdb_wckey_rec_t *wckey,
 				   slurmdb_wckey_rec_t **wckey_pptr,
 				   bool locked)
 {
-	ListIterator itr = NULL;
+	index_entry_t *entry;
 	slurmdb_wckey_rec_t * found_wckey = NULL;
 	slurmdb_wckey_rec_t * ret_wckey = NULL;
 	assoc_mgr_lock_t locks = { .wckey = READ_LOCK };
@@ -2908,8 +3117,13 @@ extern int assoc_mgr_fill_in_wckey(void *db_conn, slurmdb_wckey_rec_t *wckey,
 
 	xassert(verify_assoc_lock(WCKEY_LOCK, READ_LOCK));
 
-	itr = list_iterator_create(assoc_mgr_wckey_list);
-	while ((found_wckey = list_next(itr))) {
+	if (wckey->id)
+		entry = _index_first(wckey_id_index, wckey->id);
+	else
+		entry = _index_first(wckey_name_index,
+				     _get_str_inx(wckey->name));
+	for (; entry; entry = entry->next) {
+		found_wckey = entry->rec;
 		/* only and always check for on the slurmdbd */
 		if (slurmdbd_conf) {
 			if (!wckey->cluster) {
@@ -2954,7 +3168,6 @@ extern int assoc_mgr_fill_in_wckey(void *db_conn, slurmdb_wckey_rec_t *wckey,
 		ret_wckey = found_wckey;
 		break;
 	}
-	list_iterator_destroy(itr);
 
 	if (!ret_wckey) {
 		if (!locked)
@@ -3005,7 +3218,7 @@ extern slurmdb_admin_level_t assoc_mgr_get_admin_level(void *db_conn,
 		return SLURMDB_ADMIN_NOTSET;
 	}
 
-	found_user = list_find_first(assoc_mgr_user_list, _list_find_uid, &uid);
+	found_user = _find_user_uid(uid);
 
 	if (found_user)
 		level = found_user->admin_level;
@@ -3037,8 +3250,7 @@ extern bool assoc_mgr_is_user_acct_coord(void *db_conn,
 		return false;
 	}
 
-	found_user = list_find_first(assoc_mgr_user_list, _list_find_uid,
-				     &uid);
+	found_user = _find_user_uid(uid);
 
 	if (!found_user || !found_user->coord_accts) {
 		assoc_mgr_unlock(&locks);
@@ -4094,6 +4306,7 @@ extern int assoc_mgr_update_assocs(slurmdb_update_object_t *update, bool locked)
 	} else if (resort)
 		slurmdb_sort_hierarchical_assoc_list(
 			assoc_mgr_assoc_list, true);
+	g_assoc_tree_gen++;
 
 	if (!locked)
 		assoc_mgr_unlock(&locks);
@@ -4221,6 +4434,7 @@ extern int assoc_mgr_update_wckeys(slurmdb_update_object_t *update, bool locked)
 			else
 				object->is_def = 0;
 			list_append(assoc_mgr_wckey_list, object);
+			_index_wckey(object);
 			object = NULL;
 			break;
 		case SLURMDB_REMOVE_WCKEY:
@@ -4228,6 +4442,7 @@ extern int assoc_mgr_update_wckeys(slurmdb_update_object_t *update, bool locked)
 				//rc = SLURM_ERROR;
 				break;
 			}
+			_unindex_wckey(rec);
 			list_delete_item(itr);
 			break;
 		default:
@@ -4293,11 +4508,13 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update, bool locked)
 					      rec->name);
 					break;
 				}
+				_unindex_user(rec);
 				xfree(rec->old_name);
 				rec->old_name = rec->name;
 				rec->name = object->name;
 				object->name = NULL;
 				rc = _change_user_name(rec);
+				_index_user(rec);
 			}
 
 			if (object->default_acct) {
@@ -4328,6 +4545,7 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update, bool locked)
 			} else
 				object->uid = pw_uid;
 			list_append(assoc_mgr_user_list, object);
+			_index_user(object);
 			object = NULL;
 			break;
 		case SLURMDB_REMOVE_USER:
@@ -4335,6 +4553,7 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update, bool locked)
 				//rc = SLURM_ERROR;
 				break;
 			}
+			_unindex_user(rec);
 			list_delete_item(itr);
 			break;
 		case SLURMDB_ADD_COORD:
@@ -4415,6 +4634,7 @@ extern int assoc_mgr_update_qos(slurmdb_update_object_t *update, bool locked)
 			assoc_mgr_set_qos_tres_cnt(object);
 
 			list_append(assoc_mgr_qos_list, object);
+			_index_qos(object);
 /* 			char *tmp = get_qos_complete_str_bitstr( */
 /* 				assoc_mgr_qos_list, */
 /* 				object->preempt_bitstr); */
@@ -4701,6 +4921,7 @@ extern int assoc_mgr_update_qos(slurmdb_update_object_t *update, bool locked)
 			if (rec->priority == g_qos_max_priority)
 				redo_priority = 2;
 
+			_unindex_qos(rec);
 			if (init_setup.remove_qos_notify) {
 				/* since there are some deadlock
 				   issues while inside our lock here
@@ -5199,6 +5420,7 @@ extern void assoc_mgr_remove_assoc_usage(slurmdb_assoc_rec_t *assoc)
 	xassert(assoc);
 	xassert(assoc->usage);
 
+	g_assoc_tree_gen++;
 	if (assoc->user) {
 		child = "user";
 		child_str = assoc->user;
@@ -5672,6 +5894,7 @@ extern int load_assoc_usage(void)
 
 		xfree(tmp_str);
 	}
+	g_assoc_tree_gen++;
 	assoc_mgr_unlock(&locks);
 
 	free_buf(buffer);
@@ -5942,6 +6165,7 @@ extern int load_assoc_mgr_state(bool only_tres)
 			FREE_NULL_LIST(assoc_mgr_user_list);
 			assoc_mgr_user_list = msg->my_list;
 			_post_user_list(assoc_mgr_user_list);
+			_index_user_list();
 			debug("Recovered %u users",
 			      list_count(assoc_mgr_user_list));
 			msg->my_list = NULL;
@@ -5981,6 +6205,7 @@ extern int load_assoc_mgr_state(bool only_tres)
 			FREE_NULL_LIST(assoc_mgr_qos_list);
 			assoc_mgr_qos_list = msg->my_list;
 			_post_qos_list(assoc_mgr_qos_list);
+			_index_qos_list();
 			debug("Recovered %u qos",
 			      list_count(assoc_mgr_qos_list));
 			msg->my_list = NULL;
@@ -5997,6 +6222,7 @@ extern int load_assoc_mgr_state(bool only_tres)
 			}
 			FREE_NULL_LIST(assoc_mgr_wckey_list);
 			assoc_mgr_wckey_list = msg->my_list;
+			_index_wckey_list();
 			debug("Recovered %u wckeys",
 			      list_count(assoc_mgr_wckey_list));
 			msg->my_list = NULL;
@@ -6142,6 +6368,8 @@ extern int assoc_mgr_set_missing_uids()
 					debug5("%s: found uid %u for user %s",
 					       __func__, pw_uid, object->name);
 					object->uid = pw_uid;
+					_index_add(&user_uid_index,
+						   object->uid, object);
 				}
 			}
 		}
@@ -121,6 +121,8 @@ extern slurmdb_assoc_rec_t *assoc_mgr_root_assoc;
 extern uint32_t g_qos_max_priority; /* max priority in all qos's */
 extern uint32_t g_qos_count; /* count used for generating qos bitstr's */
 extern uint32_t g_user_assoc_count; /* Number of associations which are users */
+extern uint32_t g_assoc_tree_gen; /* Bumped when the association tree, its
+				  * shares or its usage is changed here */
 extern uint32_t g_tres_count; /* Number of TRES from the database
 			       * which also is the number of elements
 			       * in the assoc_mgr_tres_array */
@@ -71,6 +71,14 @@ static bool initialized = false; /* protected by init_mutex */
 #define DATA_MAGIC 0x1992189F
 #define DATA_LIST_MAGIC 0x1992F89F
 #define DATA_LIST_NODE_MAGIC 0x1921F89F
+#define DATA_ARENA_MAGIC 0x1992A89F
+
+/* allocation size of arena blocks */
+#define DATA_ARENA_BLOCK_SIZE (64 * 1024)
+#define DATA_ARENA_ALIGN(_size) (((_size) + 15) & ~((size_t) 15))
+
+/* dictionaries get a key index once they hold this many entries */
+#define DATA_DICT_INDEX_MIN 16
 
 typedef struct data_list_node_s data_list_node_t;
 struct data_list_node_s {
@@ -79,18 +87,52 @@ struct data_list_node_s {
 
 	data_t *data;
 	char *key; /* key for dictionary (only) */
+	uint32_t hash; /* hash of key */
+	data_list_node_t *index_next; /* next node in same index bucket */
 };
 
-/* single forward linked list */
+/*
+ * Single forward linked list. Dictionaries past DATA_DICT_INDEX_MIN entries
+ * also get a chained hash index of their keys, the list still holds the
+ * order the keys were added in.
+ */
 struct data_list_s {
 	int magic;
 	size_t count;
+	data_arena_t *arena;
 
 	data_list_node_t *begin;
 	data_list_node_t *end;
+
+	data_list_node_t **index; /* key index or NULL */
+	size_t index_size; /* number of index buckets (power of 2) */
+};
+
+typedef struct data_arena_block_s data_arena_block_t;
+struct data_arena_block_s {
+	data_arena_block_t *next;
+	size_t size;
+	size_t used;
+};
+
+/*
+ * Allocator of a data_new_arena() tree. Memory is carved out of large
+ * blocks and never returned until the root is freed. Strings given to
+ * data_set_string_own() were xmalloc()ed by the caller, so they are only
+ * tracked here to be xfree()d along with the blocks.
+ */
+struct data_arena_s {
+	int magic;
+	data_t *root;
+	data_arena_block_t *blocks;
+
+	void **owned;
+	size_t owned_cnt;
+	size_t owned_size;
 };
 
 static void _check_magic(const data_t *data);
+static void _check_data_list_node_magic(const data_list_node_t *dn);
 static void _release(data_t *data);
 static void _release_data_list_node(data_list_t *dl, data_list_node_t *dn);
 
@@ -200,10 +242,207 @@ cleanup:
 	return rc;
 }
 
-static data_list_t *_data_list_new(void)
+static void *_arena_alloc(data_arena_t *arena, size_t size)
+{
+	data_arena_block_t *block = arena->blocks;
+	void *ptr;
+
+	xassert(arena->magic == DATA_ARENA_MAGIC);
+
+	size = DATA_ARENA_ALIGN(size);
+	if (!block || ((block->size - block->used) < size)) {
+		size_t block_size = DATA_ARENA_ALIGN(sizeof(*block)) + size;
+
+		if (block_size < DATA_ARENA_BLOCK_SIZE)
+			block_size = DATA_ARENA_BLOCK_SIZE;
+
+		block = xmalloc(block_size);
+		block->size = block_size;
+		block->used = DATA_ARENA_ALIGN(sizeof(*block));
+		block->next = arena->blocks;
+		arena->blocks = block;
+	}
+
+	ptr = ((char *) block) + block->used;
+	block->used += size;
+
+	return ptr;
+}
+
+/* Make string part of the arena, string must be from xmalloc() */
+static void _arena_own(data_arena_t *arena, void *ptr)
+{
+	if (arena->owned_cnt >= arena->owned_size) {
+		arena->owned_size = arena->owned_size ?
+			(arena->owned_size * 2) : 64;
+		xrecalloc(arena->owned, arena->owned_size, sizeof(void *));
+	}
+
+	arena->owned[arena->owned_cnt++] = ptr;
+}
+
+static void _arena_free(data_arena_t *arena)
+{
+	data_arena_block_t *block;
+	size_t bytes = 0;
+
+	xassert(arena->magic == DATA_ARENA_MAGIC);
+
+	for (size_t i = 0; i < arena->owned_cnt; i++)
+		xfree(arena->owned[i]);
+	xfree(arena->owned);
+
+	while ((block = arena->blocks)) {
+		arena->blocks = block->next;
+		bytes += block->size;
+		xfree(block);
+	}
+
+	log_flag(DATA, "%s: free data arena (0x%"PRIXPTR") of %zu bytes",
+		 __func__, (uintptr_t) arena, bytes);
+
+	arena->magic = ~DATA_ARENA_MAGIC;
+	xfree(arena);
+}
+
+/* Allocate zeroed memory from arena or xmalloc() if there is no arena */
+static void *_alloc(data_arena_t *arena, size_t size)
+{
+	if (arena)
+		return _arena_alloc(arena, size);
+
+	return xmalloc(size);
+}
+
+/* Free memory from _alloc(), arena memory is released with the arena */
+static void _free(data_arena_t *arena, void *ptr)
+{
+	if (!arena)
+		xfree(ptr);
+}
+
+static char *_strdup(data_arena_t *arena, const char *str)
+{
+	char *dst;
+	size_t len;
+
+	if (!arena)
+		return xstrdup(str);
+	if (!str)
+		return NULL;
+
+	len = strlen(str) + 1;
+	dst = _arena_alloc(arena, len);
+	memcpy(dst, str, len);
+
+	return dst;
+}
+
+/* FNV-1a hash of dictionary key */
+static uint32_t _hash_key(const char *key)
+{
+	uint32_t hash = 2166136261U;
+
+	for (; *key; key++) {
+		hash ^= (uint8_t) *key;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+/* (Re)build the key index of a dictionary with size buckets */
+static void _index_build(data_list_t *dl, size_t size)
+{
+	data_list_node_t *i;
+
+	_free(dl->arena, dl->index);
+	dl->index = _alloc(dl->arena, size * sizeof(*dl->index));
+	dl->index_size = size;
+
+	for (i = dl->begin; i; i = i->next) {
+		data_list_node_t **bucket =
+			&dl->index[i->hash & (dl->index_size - 1)];
+
+		xassert(i->key);
+		i->index_next = *bucket;
+		*bucket = i;
+	}
+
+	log_flag(DATA, "%s: indexed %zu keys of data list (0x%"PRIXPTR") in %zu buckets",
+		 __func__, dl->count, (uintptr_t) dl, size);
+}
+
+/* Add a new dictionary node to the key index once it is big enough */
+static void _index_add(data_list_t *dl, data_list_node_t *dn)
+{
+	data_list_node_t **bucket;
+
+	if (!dl->index) {
+		if (dl->count >= DATA_DICT_INDEX_MIN)
+			_index_build(dl, DATA_DICT_INDEX_MIN * 2);
+		return;
+	}
+
+	if (dl->count > dl->index_size) {
+		_index_build(dl, dl->index_size * 2);
+		return;
+	}
+
+	bucket = &dl->index[dn->hash & (dl->index_size - 1)];
+	dn->index_next = *bucket;
+	*bucket = dn;
+}
+
+static void _index_remove(data_list_t *dl, data_list_node_t *dn)
+{
+	data_list_node_t **i;
+
+	for (i = &dl->index[dn->hash & (dl->index_size - 1)]; *i;
+	     i = &(*i)->index_next) {
+		if (*i == dn) {
+			*i = dn->index_next;
+			return;
+		}
+	}
+
+	fatal_abort("%s: key missing from index", __func__);
+}
+
+/* Find the node of key in a dictionary or NULL */
+static data_list_node_t *_dict_find(const data_list_t *dl, const char *key)
+{
+	data_list_node_t *i;
+
+	if (dl->index) {
+		uint32_t hash = _hash_key(key);
+
+		for (i = dl->index[hash & (dl->index_size - 1)]; i;
+		     i = i->index_next) {
+			_check_data_list_node_magic(i);
+
+			if ((i->hash == hash) && !xstrcmp(key, i->key))
+				return i;
+		}
+
+		return NULL;
+	}
+
+	for (i = dl->begin; i; i = i->next) {
+		_check_data_list_node_magic(i);
+
+		if (!xstrcmp(key, i->key))
+			return i;
+	}
+
+	return NULL;
+}
+
+static data_list_t *_data_list_new(data_arena_t *arena)
 {
-	data_list_t *dl = xmalloc(sizeof(*dl));
+	data_list_t *dl = _alloc(arena, sizeof(*dl));
 	dl->magic = DATA_LIST_MAGIC;
+	dl->arena = arena;
 
 	log_flag(DATA, "%s: new data list (0x%"PRIXPTR")",
 		 __func__, (uintptr_t) dl);
@@ -270,16 +509,21 @@ static void _release_data_list_node(data_list_t *dl, data_list_node_t *dn)
 	_check_data_list_magic(dl);
 	_check_data_list_node_magic(dn);
 	_check_data_list_node_parent(dl, dn);
-	data_list_node_t *prev;
+	data_list_node_t *prev = NULL;
 
 	/* walk list to find new previous */
-	for (prev = dl->begin; prev && prev->next != dn; ) {
-		_check_data_list_node_magic(prev);
-		prev = prev->next;
-		if (prev)
+	if (dn != dl->begin) {
+		for (prev = dl->begin; prev && prev->next != dn; ) {
 			_check_data_list_node_magic(prev);
+			prev = prev->next;
+			if (prev)
+				_check_data_list_node_magic(prev);
+		}
 	}
 
+	if (dl->index && dn->key)
+		_index_remove(dl, dn);
+
 	if (dn == dl->begin) {
 		/* at the beginning */
 		dl->begin = dn->next;
@@ -304,10 +548,10 @@ static void _release_data_list_node(data_list_t *dl, data_list_node_t *dn)
 
 	dl->count--;
 	FREE_NULL_DATA(dn->data);
-	xfree(dn->key);
+	_free(dl->arena, dn->key);
 
 	dn->magic = ~DATA_LIST_NODE_MAGIC;
-	xfree(dn);
+	_free(dl->arena, dn);
 }
 
 static void _release_data_list(data_list_t *dl)
@@ -322,7 +566,7 @@ static void _release_data_list(data_list_t *dl)
 
 	if (!n) {
 		xassert(!dl->end);
-		return;
+		goto done;
 	}
 
 	xassert(dl->end);
@@ -340,24 +584,30 @@ static void _release_data_list(data_list_t *dl)
 #ifndef NDEBUG
 	xassert(count == init_count);
 #endif
+done:
+	_free(dl->arena, dl->index);
 	dl->magic = ~DATA_LIST_MAGIC;
-	xfree(dl);
+	_free(dl->arena, dl);
 }
 
 /*
  * Create new data list node entry
+ * IN dl - list the entry is for
  * IN d - data type to take ownership of
  * IN key - dictionary key to dup or NULL
  */
-static data_list_node_t *_new_data_list_node(data_t *d, const char *key)
+static data_list_node_t *_new_data_list_node(data_list_t *dl, data_t *d,
+					     const char *key)
 {
-	data_list_node_t *dn = xmalloc(sizeof(*dn));
+	data_list_node_t *dn = _alloc(dl->arena, sizeof(*dn));
 	dn->magic = DATA_LIST_NODE_MAGIC;
 	_check_magic(d);
 
 	dn->data = d;
-	if (key)
-		dn->key = xstrdup(key);
+	if (key) {
+		dn->key = _strdup(dl->arena, key);
+		dn->hash = _hash_key(key);
+	}
 
 	log_flag(DATA, "%s: new data list node (0x%"PRIXPTR")",
 		 __func__, (uintptr_t) dn);
@@ -367,7 +617,7 @@ static data_list_node_t *_new_data_list_node(data_t *d, const char *key)
 
 static void _data_list_append(data_list_t *dl, data_t *d, const char *key)
 {
-	data_list_node_t *n = _new_data_list_node(d, key);
+	data_list_node_t *n = _new_data_list_node(dl, d, key);
 	_check_data_list_magic(dl);
 	_check_magic(d);
 
@@ -385,11 +635,14 @@ static void _data_list_append(data_list_t *dl, data_t *d, const char *key)
 	}
 
 	dl->count++;
+
+	if (key)
+		_index_add(dl, n);
 }
 
 static void _data_list_prepend(data_list_t *dl, data_t *d, const char *key)
 {
-	data_list_node_t *n = _new_data_list_node(d, key);
+	data_list_node_t *n = _new_data_list_node(dl, d, key);
 	_check_data_list_magic(dl);
 	_check_magic(d);
 
@@ -404,13 +657,17 @@ static void _data_list_prepend(data_list_t *dl, data_t *d, const char *key)
 	}
 
 	dl->count++;
+
+	if (key)
+		_index_add(dl, n);
 }
 
-data_t *data_new(void)
+static data_t *_data_new(data_arena_t *arena)
 {
-	data_t *data = xmalloc(sizeof(*data));
+	data_t *data = _alloc(arena, sizeof(*data));
 	data->magic = DATA_MAGIC;
 	data->type = DATA_TYPE_NULL;
+	data->arena = arena;
 
 	log_flag(DATA, "%s: new data (0x%"PRIXPTR")",
 		 __func__, (uintptr_t) data);
@@ -418,6 +675,23 @@ data_t *data_new(void)
 	return data;
 }
 
+data_t *data_new(void)
+{
+	return _data_new(NULL);
+}
+
+extern data_t *data_new_arena(void)
+{
+	data_arena_t *arena = xmalloc(sizeof(*arena));
+	arena->magic = DATA_ARENA_MAGIC;
+	arena->root = _data_new(arena);
+
+	log_flag(DATA, "%s: new data arena (0x%"PRIXPTR") for (0x%"PRIXPTR")",
+		 __func__, (uintptr_t) arena, (uintptr_t) arena->root);
+
+	return arena->root;
+}
+
 static void _check_magic(const data_t *data)
 {
 	xassert(data);
@@ -440,13 +714,16 @@ static void _release(data_t *data)
 
 	switch (data->type) {
 	case DATA_TYPE_LIST:
-		_release_data_list(data->data.list_u);
+		/* nothing to walk if it all goes with the arena */
+		if (!data->arena)
+			_release_data_list(data->data.list_u);
 		break;
 	case DATA_TYPE_DICT:
-		_release_data_list(data->data.dict_u);
+		if (!data->arena)
+			_release_data_list(data->data.dict_u);
 		break;
 	case DATA_TYPE_STRING:
-		xfree(data->data.string_u);
+		_free(data->arena, data->data.string_u);
 		break;
 	default:
 		/* other types don't need to be freed */
@@ -465,10 +742,16 @@ extern void data_free(data_t *data)
 		 __func__, (uintptr_t) data);
 
 	_check_magic(data);
+
+	if (data->arena && (data->arena->root == data)) {
+		_arena_free(data->arena);
+		return;
+	}
+
 	_release(data);
 
 	data->magic = ~DATA_MAGIC;
-	xfree(data);
+	_free(data->arena, data);
 }
 
 extern data_type_t data_get_type(const data_t *data)
@@ -556,7 +839,7 @@ extern data_t *data_set_string(data_t *data, const char *value)
 	       __func__, (uintptr_t) data, value);
 
 	data->type = DATA_TYPE_STRING;
-	data->data.string_u = xstrdup(value);
+	data->data.string_u = _strdup(data->arena, value);
 
 	return data;
 }
@@ -567,6 +850,7 @@ extern data_t *data_set_string_own(data_t *data, char *value)
 
 	if (!data || !value)
 		return NULL;
+	_release(data);
 
 	log_flag(DATA, "%s: set data (0x%"PRIXPTR") to string: %s",
 		 __func__, (uintptr_t) data, value);
@@ -574,6 +858,8 @@ extern data_t *data_set_string_own(data_t *data, char *value)
 	data->type = DATA_TYPE_STRING;
 	/* take ownership of string */
 	data->data.string_u = value;
+	if (data->arena)
+		_arena_own(data->arena, value);
 
 	return data;
 }
@@ -590,7 +876,7 @@ extern data_t *data_set_dict(data_t *data)
 		 __func__, (uintptr_t) data);
 
 	data->type = DATA_TYPE_DICT;
-	data->data.dict_u = _data_list_new();
+	data->data.dict_u = _data_list_new(data->arena);
 
 	return data;
 }
@@ -607,7 +893,7 @@ extern data_t *data_set_list(data_t *data)
 		 __func__, (uintptr_t) data);
 
 	data->type = DATA_TYPE_LIST;
-	data->data.dict_u = _data_list_new();
+	data->data.dict_u = _data_list_new(data->arena);
 
 	return data;
 }
@@ -621,7 +907,7 @@ extern data_t *data_list_append(data_t *data)
 	if (!data || data->type != DATA_TYPE_LIST)
 		return NULL;
 
-	ndata = data_new();
+	ndata = _data_new(data->arena);
 	_data_list_append(data->data.list_u, ndata, NULL);
 
 	log_flag(DATA, "%s: list append data (0x%"PRIXPTR") to (0x%"PRIXPTR")",
@@ -639,7 +925,7 @@ extern data_t *data_list_prepend(data_t *data)
 	if (!data || data->type != DATA_TYPE_LIST)
 		return NULL;
 
-	ndata = data_new();
+	ndata = _data_new(data->arena);
 	_data_list_prepend(data->data.list_u, ndata, NULL);
 
 	log_flag(DATA, "%s: list prepend data (0x%"PRIXPTR") to (0x%"PRIXPTR")",
@@ -692,15 +978,7 @@ const data_t *data_key_get_const(const data_t *data, const char *key)
 		return NULL;
 
 	_check_data_list_magic(data->data.dict_u);
-	i = data->data.dict_u->begin;
-	while (i) {
-		_check_data_list_node_magic(i);
-
-		if (!xstrcmp(key, i->key))
-			break;
-
-		i = i->next;
-	}
+	i = _dict_find(data->data.dict_u, key);
 
 	if (i)
 		return i->data;
@@ -722,15 +1000,7 @@ data_t *data_key_get(data_t *data, const char *key)
 		return NULL;
 
 	_check_data_list_magic(data->data.dict_u);
-	i = data->data.dict_u->begin;
-	while (i) {
-		_check_data_list_node_magic(i);
-
-		if (!xstrcmp(key, i->key))
-			break;
-
-		i = i->next;
-	}
+	i = _dict_find(data->data.dict_u, key);
 
 	if (i)
 		return i->data;
@@ -754,7 +1024,7 @@ data_t *data_key_set(data_t *data, const char *key)
 		return d;
 	}
 
-	d = data_new();
+	d = _data_new(data->arena);
 	_data_list_append(data->data.dict_u, d, key);
 
 	log_flag(DATA, "%s: set new key in data (0x%"PRIXPTR") key: %s data (0x%"PRIXPTR")",
@@ -783,15 +1053,7 @@ bool data_key_unset(data_t *data, const char *key)
 		return NULL;
 
 	_check_data_list_magic(data->data.dict_u);
-	i = data->data.dict_u->begin;
-	while (i) {
-		_check_data_list_node_magic(i);
-
-		if (!xstrcmp(key, i->key))
-			break;
-
-		i = i->next;
-	}
+	i = _dict_find(data->data.dict_u, key);
 
 	if (!i) {
 		log_flag(DATA, "%s: remove non-existent key in data (0x%"PRIXPTR") key: %s",
@@ -1054,8 +1316,14 @@ extern int data_list_for_each(data_t *d, DataListForF f, void *arg)
 		case DATA_FOR_EACH_CONT:
 			break;
 		case DATA_FOR_EACH_DELETE:
+		{
+			/* node is gone after release */
+			data_list_node_t *next = i->next;
+
 			_release_data_list_node(d->data.list_u, i);
-			break;
+			i = next;
+			continue;
+		}
 		case DATA_FOR_EACH_FAIL:
 			count *= -1;
 			/* fall through */
@@ -1151,8 +1419,14 @@ extern int data_dict_for_each(data_t *d, DataDictForF f, void *arg)
 		case DATA_FOR_EACH_CONT:
 			break;
 		case DATA_FOR_EACH_DELETE:
+		{
+			/* node is gone after release */
+			data_list_node_t *next = i->next;
+
 			_release_data_list_node(d->data.dict_u, i);
-			break;
+			i = next;
+			continue;
+		}
 		case DATA_FOR_EACH_FAIL:
 			count *= -1;
 			/* fall through */
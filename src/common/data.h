@@ -70,6 +70,9 @@ extern char *data_type_to_string(data_type_t type);
 /* opaque type for list_u and dict_u */
 typedef struct data_list_s data_list_t;
 
+/* opaque type of the allocator of a data_new_arena() tree */
+typedef struct data_arena_s data_arena_t;
+
 /*
  * Opaque data struct to hold generic data.
  * data is based on the JSON data type and has the same types.
@@ -81,6 +84,7 @@ typedef struct data_list_s data_list_t;
 typedef struct {
 	int magic;
 	data_type_t type;
+	data_arena_t *arena; /* arena data was allocated from or NULL */
 	union { /* append "_u" to every type to avoid reserved words */
 		data_list_t *list_u;
 		data_list_t *dict_u;
@@ -142,6 +146,16 @@ extern void data_destroy_static(void);
  * RET data structure or will abort()
  */
 extern data_t *data_new(void);
+/*
+ * Create new data struct with its own arena.
+ * 	Every part of the tree later built under it is allocated from
+ * 	the arena, and FREE_NULL_DATA() against resultant releases the whole
+ * 	tree at once without walking it. Freeing or replacing anything
+ * 	below the root only unlinks it, its memory is returned with the
+ * 	root. Meant for trees that only live for one request.
+ * RET data structure or will abort()
+ */
+extern data_t *data_new_arena(void);
 /*
  * safely and recursively frees all parts of data struct.
  * 	Try to use FREE_NULL_DATA() instead.
@@ -76,6 +76,7 @@ strong_alias(free_buf,		slurm_free_buf);
 strong_alias(grow_buf,		slurm_grow_buf);
 strong_alias(init_buf,		slurm_init_buf);
 strong_alias(xfer_buf_data,	slurm_xfer_buf_data);
+strong_alias(write_buf,		slurm_write_buf);
 strong_alias(pack_time,		slurm_pack_time);
 strong_alias(unpack_time,	slurm_unpack_time);
 strong_alias(packfloat, 	slurm_packfloat);
@@ -241,6 +242,31 @@ void *xfer_buf_data(Buf my_buf)
 	return data_ptr;
 }
 
+/*
+ * write_buf - append len bytes of data at the buffer's offset, growing the
+ * buffer as needed and always leaving room for a terminating NUL. The
+ * write_func of the dump_*_stream() emitters, with the Buf as its arg.
+ */
+int write_buf(void *arg, const char *data, size_t len)
+{
+	Buf buffer = arg;
+
+	xassert(buffer->magic == BUF_MAGIC);
+
+	if (remaining_buf(buffer) <= len) {
+		uint32_t size = size_buf(buffer);
+
+		grow_buf(buffer, MAX(len + 1, size));
+		if (size_buf(buffer) == size)
+			return SLURM_ERROR;
+	}
+
+	memcpy(get_buf_data(buffer) + get_buf_offset(buffer), data, len);
+	set_buf_offset(buffer, get_buf_offset(buffer) + len);
+
+	return SLURM_SUCCESS;
+}
+
 /*
  * Given a time_t in host byte order, promote it to int64_t, convert to
  * network byte order, store in buffer and adjust buffer acc'd'ngly
@@ -36,6 +36,9 @@
  *  with Slurm; if not, write to the Free Software Foundation, Inc.,
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
+#include <stdarg.h>
+
+#include "src/common/macros.h"
 #include "src/common/print_fields.h"
 #include "src/common/parse_time.h"
 #include "src/common/read_config.h"
@@ -44,6 +47,58 @@ int print_fields_parsable_print = 0;
 int print_fields_have_header = 1;
 char *fields_delimiter = NULL;
 
+/* Row rendered between print_fields_row_start() and print_fields_row_end() */
+static char *row_buf = NULL;
+static size_t row_size = 0, row_len = 0;
+static bool row_active = false;
+
+/* printf() to stdout, or append to the row when one is being rendered */
+__attribute__((format(printf, 1, 2)))
+static void _print(const char *fmt, ...)
+{
+	va_list ap;
+	int len;
+
+	if (!row_active) {
+		va_start(ap, fmt);
+		vprintf(fmt, ap);
+		va_end(ap);
+		return;
+	}
+
+	while (1) {
+		va_start(ap, fmt);
+		len = vsnprintf(row_buf + row_len, row_size - row_len, fmt, ap);
+		va_end(ap);
+
+		if (len < 0)
+			return;
+		if ((row_len + len) < row_size) {
+			row_len += len;
+			return;
+		}
+
+		/* the buffer is kept and reused by the following rows */
+		row_size = MAX(row_size * 2, row_len + len + 1);
+		xrealloc_nz(row_buf, row_size);
+	}
+}
+
+extern void print_fields_row_start(void)
+{
+	row_len = 0;
+	row_active = true;
+}
+
+extern void print_fields_row_end(void)
+{
+	row_active = false;
+	if (row_len)
+		fwrite(row_buf, 1, row_len, stdout);
+	putchar('\n');
+	row_len = 0;
+}
+
 extern void destroy_print_field(void *object)
 {
 	print_field_t *field = (print_field_t *)object;
@@ -71,31 +126,31 @@ extern void print_fields_header(List print_fields_list)
 		if (print_fields_parsable_print
 		   == PRINT_FIELDS_PARSABLE_NO_ENDING
 		   && (curr_inx == field_count))
-			printf("%s", field->name);
+			_print("%s", field->name);
 		else if (print_fields_parsable_print
 			 && fields_delimiter) {
-			printf("%s%s", field->name, fields_delimiter);
+			_print("%s%s", field->name, fields_delimiter);
 		} else if (print_fields_parsable_print
 			 && !fields_delimiter) {
-			printf("%s|", field->name);
+			_print("%s|", field->name);
 
 		} else {
 			int abs_len = abs(field->len);
-			printf("%*.*s ", abs_len, abs_len, field->name);
+			_print("%*.*s ", abs_len, abs_len, field->name);
 		}
 		curr_inx++;
 	}
 	list_iterator_reset(itr);
-	printf("\n");
+	_print("\n");
 	if (print_fields_parsable_print)
 		return;
 	while ((field = list_next(itr))) {
 		int abs_len = abs(field->len);
-		printf("%*.*s ", abs_len, abs_len,
+		_print("%*.*s ", abs_len, abs_len,
 		       "-----------------------------------------------------");
 	}
 	list_iterator_destroy(itr);
-	printf("\n");
+	_print("\n");
 }
 
 extern void print_fields_date(print_field_t *field, time_t value, int last)
@@ -106,15 +161,15 @@ extern void print_fields_date(print_field_t *field, time_t value, int last)
 	slurm_make_time_str(&value, (char *)temp_char, sizeof(temp_char));
 	if (print_fields_parsable_print == PRINT_FIELDS_PARSABLE_NO_ENDING
 	   && last)
-		printf("%s", temp_char);
+		_print("%s", temp_char);
 	else if (print_fields_parsable_print && !fields_delimiter)
-		printf("%s|", temp_char);
+		_print("%s|", temp_char);
 	else if (print_fields_parsable_print && fields_delimiter)
-		printf("%s%s", temp_char, fields_delimiter);
+		_print("%s%s", temp_char, fields_delimiter);
 	else if (field->len == abs_len)
-		printf("%*.*s ", abs_len, abs_len, temp_char);
+		_print("%*.*s ", abs_len, abs_len, temp_char);
 	else
-		printf("%-*.*s ", abs_len, abs_len, temp_char);
+		_print("%-*.*s ", abs_len, abs_len, temp_char);
 }
 
 extern void print_fields_str(print_field_t *field, char *value, int last)
@@ -132,11 +187,11 @@ extern void print_fields_str(print_field_t *field, char *value, int last)
 
 	if (print_fields_parsable_print == PRINT_FIELDS_PARSABLE_NO_ENDING
 	   && last)
-		printf("%s", print_this);
+		_print("%s", print_this);
 	else if (print_fields_parsable_print && !fields_delimiter)
-		printf("%s|", print_this);
+		_print("%s|", print_this);
 	else if (print_fields_parsable_print && fields_delimiter)
-		printf("%s%s", print_this, fields_delimiter);
+		_print("%s%s", print_this, fields_delimiter);
 	else {
 		if (value) {
 			int len = strlen(value);
@@ -148,9 +203,9 @@ extern void print_fields_str(print_field_t *field, char *value, int last)
 		}
 
 		if (field->len == abs_len)
-			printf("%*.*s ", abs_len, abs_len, print_this);
+			_print("%*.*s ", abs_len, abs_len, print_this);
 		else
-			printf("%-*.*s ", abs_len, abs_len, print_this);
+			_print("%-*.*s ", abs_len, abs_len, print_this);
 	}
 }
 
@@ -168,24 +223,24 @@ extern void print_fields_uint16(print_field_t *field, uint32_t value, int last)
 		   && last)
 			;
 		else if (print_fields_parsable_print && !fields_delimiter)
-			printf("|");
+			_print("|");
 		else if (print_fields_parsable_print && fields_delimiter)
-			printf("%s", fields_delimiter);
+			_print("%s", fields_delimiter);
 		else
-			printf("%*s ", field->len, " ");
+			_print("%*s ", field->len, " ");
 	} else {
 		if (print_fields_parsable_print
 		   == PRINT_FIELDS_PARSABLE_NO_ENDING
 		   && last)
-			printf("%u", value);
+			_print("%u", value);
 		else if (print_fields_parsable_print && !fields_delimiter)
-			printf("%u|", value);
+			_print("%u|", value);
 		else if (print_fields_parsable_print && fields_delimiter)
-			printf("%u%s", value, fields_delimiter);
+			_print("%u%s", value, fields_delimiter);
 		else if (field->len == abs_len)
-			printf("%*u ", abs_len, value);
+			_print("%*u ", abs_len, value);
 		else
-			printf("%-*u ", abs_len, value);
+			_print("%-*u ", abs_len, value);
 	}
 }
 
@@ -199,24 +254,24 @@ extern void print_fields_uint32(print_field_t *field, uint32_t value, int last)
 		   && last)
 			;
 		else if (print_fields_parsable_print && !fields_delimiter)
-			printf("|");
+			_print("|");
 		else if (print_fields_parsable_print && fields_delimiter)
-			printf("%s", fields_delimiter);
+			_print("%s", fields_delimiter);
 		else
-			printf("%*s ", field->len, " ");
+			_print("%*s ", field->len, " ");
 	} else {
 		if (print_fields_parsable_print
 		   == PRINT_FIELDS_PARSABLE_NO_ENDING
 		   && last)
-			printf("%u", value);
+			_print("%u", value);
 		else if (print_fields_parsable_print && !fields_delimiter)
-			printf("%u|", value);
+			_print("%u|", value);
 		else if (print_fields_parsable_print && fields_delimiter)
-			printf("%u%s", value, fields_delimiter);
+			_print("%u%s", value, fields_delimiter);
 		else if (field->len == abs_len)
-			printf("%*u ", abs_len, value);
+			_print("%*u ", abs_len, value);
 		else
-			printf("%-*u ", abs_len, value);
+			_print("%-*u ", abs_len, value);
 	}
 }
 
@@ -231,25 +286,25 @@ extern void print_fields_uint64(print_field_t *field, uint64_t value, int last)
 		   && last)
 			;
 		else if (print_fields_parsable_print && !fields_delimiter)
-			printf("|");
+			_print("|");
 		else if (print_fields_parsable_print && fields_delimiter)
-			printf("%s", fields_delimiter);
+			_print("%s", fields_delimiter);
 		else
-			printf("%*s ", field->len, " ");
+			_print("%*s ", field->len, " ");
 	} else {
 		if (print_fields_parsable_print
 		   == PRINT_FIELDS_PARSABLE_NO_ENDING
 		   && last)
-			printf("%llu", (long long unsigned) value);
+			_print("%llu", (long long unsigned) value);
 		else if (print_fields_parsable_print && !fields_delimiter)
-			printf("%llu|", (long long unsigned) value);
+			_print("%llu|", (long long unsigned) value);
 		else if (print_fields_parsable_print && fields_delimiter)
-			printf("%llu%s", (long long unsigned) value,
+			_print("%llu%s", (long long unsigned) value,
 				fields_delimiter);
 		else if (field->len == abs_len)
-			printf("%*llu ", abs_len, (long long unsigned) value);
+			_print("%*llu ", abs_len, (long long unsigned) value);
 		else
-			printf("%-*llu ", abs_len, (long long unsigned) value);
+			_print("%-*llu ", abs_len, (long long unsigned) value);
 	}
 }
 
@@ -264,20 +319,20 @@ extern void print_fields_double(print_field_t *field, double value, int last)
 		   && last)
 			;
 		else if (print_fields_parsable_print && !fields_delimiter)
-			printf("|");
+			_print("|");
 		else if (print_fields_parsable_print && fields_delimiter)
-			printf("%s", fields_delimiter);
+			_print("%s", fields_delimiter);
 		else
-			printf("%*s ", field->len, " ");
+			_print("%*s ", field->len, " ");
 	} else {
 		if (print_fields_parsable_print
 		   == PRINT_FIELDS_PARSABLE_NO_ENDING
 		   && last)
-			printf("%f", value);
+			_print("%f", value);
 		else if (print_fields_parsable_print && !fields_delimiter)
-			printf("%f|", value);
+			_print("%f|", value);
 		else if (print_fields_parsable_print && fields_delimiter)
-			printf("%f%s", value, fields_delimiter);
+			_print("%f%s", value, fields_delimiter);
 		else {
 			int length, width = abs_len;
 			int new_length;
@@ -290,14 +345,14 @@ extern void print_fields_double(print_field_t *field, double value, int last)
 				if (new_length > width)
 					width -= new_length - width;
 				if (field->len == abs_len)
-					printf("%*.*e ", width, width, value);
+					_print("%*.*e ", width, width, value);
 				else
-					printf("%-*.*e ", width, width, value);
+					_print("%-*.*e ", width, width, value);
 			} else {
 				if (field->len == abs_len)
-					printf("%*f ", width, value);
+					_print("%*f ", width, value);
 				else
-					printf("%-*f ", width, value);
+					_print("%-*f ", width, value);
 			}
 			xfree(tmp);
 		}
@@ -314,26 +369,26 @@ extern void print_fields_time(print_field_t *field, uint32_t value, int last)
 		   && last)
 			;
 		else if (print_fields_parsable_print && !fields_delimiter)
-			printf("|");
+			_print("|");
 		else if (print_fields_parsable_print && fields_delimiter)
-			printf("%s", fields_delimiter);
+			_print("%s", fields_delimiter);
 		else
-			printf("%*s ", field->len, " ");
+			_print("%*s ", field->len, " ");
 	} else {
 		char time_buf[32];
 		mins2time_str((time_t) value, time_buf, sizeof(time_buf));
 		if (print_fields_parsable_print
 		   == PRINT_FIELDS_PARSABLE_NO_ENDING
 		   && last)
-			printf("%s", time_buf);
+			_print("%s", time_buf);
 		else if (print_fields_parsable_print && !fields_delimiter)
-			printf("%s|", time_buf);
+			_print("%s|", time_buf);
 		else if (print_fields_parsable_print && fields_delimiter)
-			printf("%s%s", time_buf, fields_delimiter);
+			_print("%s%s", time_buf, fields_delimiter);
 		else if (field->len == abs_len)
-			printf("%*s ", abs_len, time_buf);
+			_print("%*s ", abs_len, time_buf);
 		else
-			printf("%-*s ", abs_len, time_buf);
+			_print("%-*s ", abs_len, time_buf);
 	}
 }
 
@@ -348,26 +403,26 @@ extern void print_fields_time_from_secs(print_field_t *field,
 		   && last)
 			;
 		else if (print_fields_parsable_print && !fields_delimiter)
-			printf("|");
+			_print("|");
 		else if (print_fields_parsable_print && fields_delimiter)
-			printf("%s", fields_delimiter);
+			_print("%s", fields_delimiter);
 		else
-			printf("%*s ", field->len, " ");
+			_print("%*s ", field->len, " ");
 	} else {
 		char time_buf[32];
 		secs2time_str((time_t) value, time_buf, sizeof(time_buf));
 		if (print_fields_parsable_print
 		   == PRINT_FIELDS_PARSABLE_NO_ENDING
 		   && last)
-			printf("%s", time_buf);
+			_print("%s", time_buf);
 		else if (print_fields_parsable_print && !fields_delimiter)
-			printf("%s|", time_buf);
+			_print("%s|", time_buf);
 		else if (print_fields_parsable_print && fields_delimiter)
-			printf("%s%s", time_buf, fields_delimiter);
+			_print("%s%s", time_buf, fields_delimiter);
 		else if (field->len == abs_len)
-			printf("%*s ", abs_len, time_buf);
+			_print("%*s ", abs_len, time_buf);
 		else
-			printf("%-*s ", abs_len, time_buf);
+			_print("%-*s ", abs_len, time_buf);
 	}
 }
 
@@ -387,19 +442,19 @@ extern void print_fields_char_list(print_field_t *field, List value, int last)
 
 	if (print_fields_parsable_print == PRINT_FIELDS_PARSABLE_NO_ENDING
 	   && last)
-		printf("%s", print_this);
+		_print("%s", print_this);
 	else if (print_fields_parsable_print && !fields_delimiter)
-		printf("%s|", print_this);
+		_print("%s|", print_this);
 	else if (print_fields_parsable_print && fields_delimiter)
-		printf("%s%s", print_this, fields_delimiter);
+		_print("%s%s", print_this, fields_delimiter);
 	else if (print_this) {
 		if (strlen(print_this) > abs_len)
 			print_this[abs_len-1] = '+';
 
 		if (field->len == abs_len)
-			printf("%*.*s ", abs_len, abs_len, print_this);
+			_print("%*.*s ", abs_len, abs_len, print_this);
 		else
-			printf("%-*.*s ", abs_len, abs_len, print_this);
+			_print("%-*.*s ", abs_len, abs_len, print_this);
 	}
 	xfree(print_this);
 }
@@ -73,6 +73,14 @@ extern char *fields_delimiter;
 
 extern void destroy_print_field(void *object);
 extern void print_fields_header(List print_fields_list);
+
+/*
+ * Render the fields printed between print_fields_row_start() and
+ * print_fields_row_end() into a buffer reused from row to row, and write
+ * the row followed by a newline to stdout at once.
+ */
+extern void print_fields_row_start(void);
+extern void print_fields_row_end(void);
 extern void print_fields_date(print_field_t *field, time_t value, int last);
 extern void print_fields_str(print_field_t *field, char *value, int last);
 extern void print_fields_double(print_field_t *field, double value, int last);
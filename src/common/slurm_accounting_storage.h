@@ -644,6 +644,17 @@ extern int jobacct_storage_g_job_suspend(void *db_conn,
 extern List jobacct_storage_g_get_jobs_cond(void *db_conn, uint32_t uid,
 					    slurmdb_job_cond_t *job_cond);
 
+/*
+ * get info from the storage, handing each part of the jobs to part_cb as
+ * it is read instead of building one list of all of them
+ * IN: part_cb - returns SLURM_SUCCESS to continue, may take the
+ *	jobacct_job_rec_t's out of the list
+ * RET: SLURM_SUCCESS on success SLURM_ERROR else
+ */
+extern int jobacct_storage_g_get_jobs_cond_stream(
+	void *db_conn, uint32_t uid, slurmdb_job_cond_t *job_cond,
+	int (*part_cb)(List job_list, void *arg), void *arg);
+
 /*
  * expire old info from the storage
  */
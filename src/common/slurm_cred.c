@@ -62,6 +62,7 @@
 #include "src/common/slurm_time.h"
 #include "src/common/uid.h"
 #include "src/common/xassert.h"
+#include "src/common/xhash.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
@@ -82,6 +83,13 @@ typedef struct sbcast_cred sbcast_cred_t;		/* opaque data type */
  */
 #define DEFAULT_EXPIRATION_WINDOW 120
 
+/*
+ * Number of verified credential signatures remembered by a verifier context
+ * so that a credential checked more than once (e.g. by the prolog and the
+ * launch request, or again after slurm_cred_rewind()) skips the plugin.
+ */
+#define SIG_CACHE_SIZE 256
+
 #define MAX_TIME 0x7fffffff
 
 /*
@@ -89,11 +97,15 @@ typedef struct sbcast_cred sbcast_cred_t;		/* opaque data type */
  *
  */
 typedef struct {
+	/* ctime and step_id are adjacent, they form the hash key */
 	time_t   ctime;		/* Time that the cred was created	*/
-	time_t   expiration;    /* Time at which cred is no longer good	*/
 	slurm_step_id_t step_id; /* Slurm step id for this credential	*/
+	time_t   expiration;    /* Time at which cred is no longer good	*/
 } cred_state_t;
 
+#define CRED_STATE_KEY_LEN \
+	(offsetof(cred_state_t, step_id) + sizeof(slurm_step_id_t))
+
 /*
  * slurm job state information
  * tracks jobids for which all future credentials have been revoked
@@ -106,6 +118,20 @@ typedef struct {
 	time_t   revoked;       /* Time at which credentials were revoked   */
 } job_state_t;
 
+/*
+ * Recently verified credential signature, along with the packed credential
+ * it was verified against
+ */
+typedef struct sig_cache {
+	char *sig;		/* signature, the hash key		*/
+	uint32_t siglen;	/* signature length in bytes		*/
+	char *data;		/* packed credential			*/
+	uint32_t data_len;	/* packed credential length in bytes	*/
+	time_t expiration;	/* Time at which cred is no longer good	*/
+	struct sig_cache *prev;	/* more recently used			*/
+	struct sig_cache *next;	/* less recently used			*/
+} sig_cache_t;
+
 
 /*
  * Completion of slurm credential context
@@ -147,7 +173,13 @@ struct slurm_cred_context {
 	enum ctx_type type;	/* context type (creator or verifier)	*/
 	void *key;		/* private or public key		*/
 	List job_list;		/* List of used jobids (for verifier)	*/
+	xhash_t *job_hash;	/* job_list indexed by jobid		*/
 	List state_list;	/* List of cred states (for verifier)	*/
+	xhash_t *state_hash;	/* state_list indexed by ctime+step_id	*/
+
+	xhash_t *sig_hash;	/* verified signatures (for verifier)	*/
+	sig_cache_t *sig_head;	/* most recently used signature		*/
+	sig_cache_t *sig_tail;	/* least recently used signature	*/
 
 	int expiry_window;	/* expiration window for cached creds	*/
 
@@ -262,7 +294,8 @@ static void           _job_state_destroy(job_state_t   *js);
 
 static job_state_t  * _find_job_state(slurm_cred_ctx_t ctx, uint32_t jobid);
 static job_state_t  * _insert_job_state(slurm_cred_ctx_t ctx,  uint32_t jobid);
-static int _list_find_cred_state(void *x, void *key);
+static cred_state_t * _find_cred_state(slurm_cred_ctx_t ctx,
+				       slurm_cred_t *cred);
 
 static void _insert_cred_state(slurm_cred_ctx_t ctx, slurm_cred_t *cred);
 static void _clear_expired_job_states(slurm_cred_ctx_t ctx);
@@ -294,6 +327,12 @@ static void _cred_state_pack_one(cred_state_t *s, Buf buffer);
 
 static void _sbast_cache_add(sbcast_cred_t *sbcast_cred);
 
+static void _sig_cache_flush(slurm_cred_ctx_t ctx);
+static bool _sig_cache_find(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
+			    Buf buffer);
+static void _sig_cache_add(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
+			   Buf buffer);
+
 static int _slurm_cred_init(void)
 {
 	char *tok;
@@ -447,8 +486,11 @@ slurm_cred_ctx_destroy(slurm_cred_ctx_t ctx)
 		(*(ops.cred_destroy_key))(ctx->exkey);
 	if (ctx->key)
 		(*(ops.cred_destroy_key))(ctx->key);
+	xhash_free(ctx->job_hash);
 	FREE_NULL_LIST(ctx->job_list);
+	xhash_free(ctx->state_hash);
 	FREE_NULL_LIST(ctx->state_list);
+	xhash_free(ctx->sig_hash);
 
 	ctx->magic = ~CRED_CTX_MAGIC;
 	slurm_mutex_unlock(&ctx->mutex);
@@ -1022,6 +1064,7 @@ slurm_cred_insert_jobid(slurm_cred_ctx_t ctx, uint32_t jobid)
 int
 slurm_cred_rewind(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 {
+	cred_state_t *s;
 	int rc = 0;
 
 	xassert(ctx != NULL);
@@ -1031,7 +1074,11 @@ slurm_cred_rewind(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 	xassert(ctx->magic == CRED_CTX_MAGIC);
 	xassert(ctx->type  == SLURM_CRED_VERIFIER);
 
-	rc = list_delete_all(ctx->state_list, _list_find_cred_state, cred);
+	if ((s = _find_cred_state(ctx, cred))) {
+		xhash_pop(ctx->state_hash, (char *) &s->ctime,
+			  CRED_STATE_KEY_LEN);
+		rc = list_delete_ptr(ctx->state_list, s);
+	}
 
 	slurm_mutex_unlock(&ctx->mutex);
 
@@ -1554,6 +1601,41 @@ slurm_cred_print(slurm_cred_t *cred)
 
 }
 
+static void _job_state_key(void *item, const char **key, uint32_t *key_len)
+{
+	job_state_t *j = (job_state_t *) item;
+
+	*key = (const char *) &j->jobid;
+	*key_len = sizeof(j->jobid);
+}
+
+static void _cred_state_key(void *item, const char **key, uint32_t *key_len)
+{
+	cred_state_t *s = (cred_state_t *) item;
+
+	*key = (const char *) &s->ctime;
+	*key_len = CRED_STATE_KEY_LEN;
+}
+
+static void _sig_cache_key(void *item, const char **key, uint32_t *key_len)
+{
+	sig_cache_t *c = (sig_cache_t *) item;
+
+	*key = c->sig;
+	*key_len = c->siglen;
+}
+
+static void _sig_cache_free(void *item)
+{
+	sig_cache_t *c = (sig_cache_t *) item;
+
+	if (c) {
+		xfree(c->sig);
+		xfree(c->data);
+		xfree(c);
+	}
+}
+
 static void
 _verifier_ctx_init(slurm_cred_ctx_t ctx)
 {
@@ -1562,7 +1644,10 @@ _verifier_ctx_init(slurm_cred_ctx_t ctx)
 	xassert(ctx->type == SLURM_CRED_VERIFIER);
 
 	ctx->job_list   = list_create((ListDelF) _job_state_destroy);
+	ctx->job_hash   = xhash_init(_job_state_key, NULL);
 	ctx->state_list = list_create(xfree_ptr);
+	ctx->state_hash = xhash_init(_cred_state_key, NULL);
+	ctx->sig_hash   = xhash_init(_sig_cache_key, _sig_cache_free);
 
 	return;
 }
@@ -1623,6 +1708,9 @@ _ctx_update_public_key(slurm_cred_ctx_t ctx, const char *path)
 	 */
 	ctx->exkey_exp = time(NULL) + ctx->expiry_window + 60;
 
+	/* Be conservative and check everything against the new key set */
+	_sig_cache_flush(ctx);
+
 	slurm_mutex_unlock(&ctx->mutex);
 	return SLURM_SUCCESS;
 }
@@ -1706,10 +1794,17 @@ _slurm_cred_verify_signature(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 	Buf            buffer;
 	int            rc;
 
-	debug("Checking credential with %u bytes of sig data", cred->siglen);
 	buffer = init_buf(4096);
 	_pack_cred(cred, buffer, protocol_version);
 
+	if (_sig_cache_find(ctx, cred, buffer)) {
+		debug("Credential with %u bytes of sig data verified previously",
+		      cred->siglen);
+		free_buf(buffer);
+		return SLURM_SUCCESS;
+	}
+
+	debug("Checking credential with %u bytes of sig data", cred->siglen);
 	rc = (*(ops.cred_verify_sign))(ctx->key,
 				       get_buf_data(buffer),
 				       get_buf_offset(buffer),
@@ -1722,6 +1817,8 @@ _slurm_cred_verify_signature(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 					       cred->signature,
 					       cred->siglen);
 	}
+	if (!rc)
+		_sig_cache_add(ctx, cred, buffer);
 	free_buf(buffer);
 
 	if (rc) {
@@ -1733,6 +1830,105 @@ _slurm_cred_verify_signature(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
 }
 
 
+static void _sig_cache_unlink(slurm_cred_ctx_t ctx, sig_cache_t *c)
+{
+	if (c->prev)
+		c->prev->next = c->next;
+	else
+		ctx->sig_head = c->next;
+	if (c->next)
+		c->next->prev = c->prev;
+	else
+		ctx->sig_tail = c->prev;
+	c->prev = c->next = NULL;
+}
+
+static void _sig_cache_push(slurm_cred_ctx_t ctx, sig_cache_t *c)
+{
+	c->prev = NULL;
+	c->next = ctx->sig_head;
+	if (ctx->sig_head)
+		ctx->sig_head->prev = c;
+	ctx->sig_head = c;
+	if (!ctx->sig_tail)
+		ctx->sig_tail = c;
+}
+
+static void _sig_cache_delete(slurm_cred_ctx_t ctx, sig_cache_t *c)
+{
+	_sig_cache_unlink(ctx, c);
+	xhash_delete(ctx->sig_hash, c->sig, c->siglen);
+}
+
+static void _sig_cache_flush(slurm_cred_ctx_t ctx)
+{
+	xhash_clear(ctx->sig_hash);
+	ctx->sig_head = ctx->sig_tail = NULL;
+}
+
+/*
+ * Return true if this signature was already verified against the exact same
+ * packed credential. Caller must hold ctx->mutex.
+ */
+static bool _sig_cache_find(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
+			    Buf buffer)
+{
+	sig_cache_t *c;
+
+	if (!ctx->sig_hash || !cred->signature || !cred->siglen)
+		return false;
+
+	if (!(c = xhash_get(ctx->sig_hash, cred->signature, cred->siglen)))
+		return false;
+
+	if (time(NULL) > c->expiration) {
+		_sig_cache_delete(ctx, c);
+		return false;
+	}
+
+	if ((c->data_len != get_buf_offset(buffer)) ||
+	    memcmp(c->data, get_buf_data(buffer), c->data_len))
+		return false;
+
+	_sig_cache_unlink(ctx, c);
+	_sig_cache_push(ctx, c);
+
+	return true;
+}
+
+/*
+ * Remember a verified signature, evicting the least recently used entry if
+ * the cache is full. Caller must hold ctx->mutex.
+ */
+static void _sig_cache_add(slurm_cred_ctx_t ctx, slurm_cred_t *cred,
+			   Buf buffer)
+{
+	sig_cache_t *c;
+
+	if (!ctx->sig_hash || !cred->signature || !cred->siglen)
+		return;
+
+	/* Same signature over different data, keep the newest */
+	if ((c = xhash_get(ctx->sig_hash, cred->signature, cred->siglen)))
+		_sig_cache_delete(ctx, c);
+
+	if (xhash_count(ctx->sig_hash) >= SIG_CACHE_SIZE)
+		_sig_cache_delete(ctx, ctx->sig_tail);
+
+	c = xmalloc(sizeof(*c));
+	c->sig = xmalloc(cred->siglen);
+	memcpy(c->sig, cred->signature, cred->siglen);
+	c->siglen = cred->siglen;
+	c->data_len = get_buf_offset(buffer);
+	c->data = xmalloc(c->data_len);
+	memcpy(c->data, get_buf_data(buffer), c->data_len);
+	c->expiration = cred->ctime + ctx->expiry_window;
+
+	_sig_cache_push(ctx, c);
+	xhash_add(ctx->sig_hash, c);
+}
+
+
 static void
 _pack_cred(slurm_cred_t *cred, Buf buffer, uint16_t protocol_version)
 {
@@ -1833,16 +2029,17 @@ _pack_cred(slurm_cred_t *cred, Buf buffer, uint16_t protocol_version)
 	}
 }
 
-static int _list_find_cred_state(void *x, void *key)
+static cred_state_t *_find_cred_state(slurm_cred_ctx_t ctx,
+				      slurm_cred_t *cred)
 {
-	cred_state_t *s = (cred_state_t *) x;
-	slurm_cred_t *cred = (slurm_cred_t *) key;
+	cred_state_t key;
 
-	if (!memcmp(&s->step_id, &cred->step_id, sizeof(s->step_id)) &&
-	    (s->ctime == cred->ctime))
-		return 1;
+	memset(&key, 0, sizeof(key));
+	key.ctime = cred->ctime;
+	memcpy(&key.step_id, &cred->step_id, sizeof(key.step_id));
 
-	return 0;
+	return xhash_get(ctx->state_hash, (char *) &key.ctime,
+			 CRED_STATE_KEY_LEN);
 }
 
 
@@ -1853,7 +2050,7 @@ _credential_replayed(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 
 	_clear_expired_credential_states(ctx);
 
-	s = list_find_first(ctx->state_list, _list_find_cred_state, cred);
+	s = _find_cred_state(ctx, cred);
 
 	/*
 	 * If we found a match, this credential is being replayed.
@@ -1933,31 +2130,20 @@ _credential_revoked(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 	return false;
 }
 
-static int _list_find_job_state(void *x, void *key)
-{
-	job_state_t *j = (job_state_t *) x;
-	uint32_t jobid = *(uint32_t *) key;
-	if (j->jobid == jobid)
-		return 1;
-	return 0;
-}
-
 static job_state_t *
 _find_job_state(slurm_cred_ctx_t ctx, uint32_t jobid)
 {
-	job_state_t *j =
-		list_find_first(ctx->job_list, _list_find_job_state, &jobid);
-	return j;
+	return xhash_get(ctx->job_hash, (char *) &jobid, sizeof(jobid));
 }
 
 static job_state_t *
 _insert_job_state(slurm_cred_ctx_t ctx, uint32_t jobid)
 {
-	job_state_t *j = list_find_first(
-		ctx->job_list, _list_find_job_state, &jobid);;
+	job_state_t *j = _find_job_state(ctx, jobid);
 	if (!j) {
 		j = _job_state_create(jobid);
 		list_append(ctx->job_list, j);
+		xhash_add(ctx->job_hash, j);
 	} else
 		debug2("%s: we already have a job state for job %u.  No big deal, just an FYI.",
 		       __func__, jobid);
@@ -2003,6 +2189,8 @@ _clear_expired_job_states(slurm_cred_ctx_t ctx)
 		debug3("state for jobid %u: ctime:%ld revoked:%ld expires:%ld",
 		       j->jobid, j->ctime, j->revoked, j->expiration);
 		if (j->revoked && (now > j->expiration)) {
+			xhash_pop(ctx->job_hash, (char *) &j->jobid,
+				  sizeof(j->jobid));
 			list_delete_item(i);
 		}
 	}
@@ -2010,27 +2198,27 @@ _clear_expired_job_states(slurm_cred_ctx_t ctx)
 	list_iterator_destroy(i);
 }
 
-static int _list_find_expired(void *x, void *key)
-{
-	cred_state_t *s = (cred_state_t *)x;
-	time_t curr_time = *(time_t *)key;
-
-	if (curr_time > s->expiration)
-		return 1;
-	return 0;
-}
-
 static void
 _clear_expired_credential_states(slurm_cred_ctx_t ctx)
 {
 	static time_t last_scan = 0;
 	time_t        now = time(NULL);
+	ListIterator  i   = NULL;
+	cred_state_t *s   = NULL;
 
 	if ((now - last_scan) < 2)	/* Reduces slurmd overhead */
 		return;
 	last_scan = now;
 
-	list_delete_all(ctx->state_list, _list_find_expired, &now);
+	i = list_iterator_create(ctx->state_list);
+	while ((s = list_next(i))) {
+		if (now > s->expiration) {
+			xhash_pop(ctx->state_hash, (char *) &s->ctime,
+				  CRED_STATE_KEY_LEN);
+			list_delete_item(i);
+		}
+	}
+	list_iterator_destroy(i);
 }
 
 
@@ -2039,6 +2227,7 @@ _insert_cred_state(slurm_cred_ctx_t ctx, slurm_cred_t *cred)
 {
 	cred_state_t *s = _cred_state_create(ctx, cred);
 	list_append(ctx->state_list, s);
+	xhash_add(ctx->state_hash, s);
 }
 
 
@@ -2147,9 +2336,12 @@ _cred_state_unpack(slurm_cred_ctx_t ctx, Buf buffer)
 		if (!(s = _cred_state_unpack_one(buffer)))
 			goto unpack_error;
 
-		if (now < s->expiration)
+		if ((now < s->expiration) &&
+		    !xhash_get(ctx->state_hash, (char *) &s->ctime,
+			       CRED_STATE_KEY_LEN)) {
 			list_append(ctx->state_list, s);
-		else
+			xhash_add(ctx->state_hash, s);
+		} else
 			xfree(s);
 	}
 
@@ -2192,9 +2384,15 @@ _job_state_unpack(slurm_cred_ctx_t ctx, Buf buffer)
 		if (!(j = _job_state_unpack_one(buffer)))
 			goto unpack_error;
 
-		if (!j->revoked || (j->revoked && (now < j->expiration)))
+		if (_find_job_state(ctx, j->jobid)) {
+			debug3("not appending duplicate job %u state",
+			       j->jobid);
+			_job_state_destroy(j);
+		} else if (!j->revoked || (j->revoked &&
+					   (now < j->expiration))) {
 			list_append(ctx->job_list, j);
-		else {
+			xhash_add(ctx->job_hash, j);
+		} else {
 			debug3 ("not appending expired job %u state",
 			        j->jobid);
 			_job_state_destroy(j);
@@ -45,6 +45,8 @@
 #define PERSIST_FLAG_ALREADY_INITED 0x0004
 #define PERSIST_FLAG_P_USER_CASE    0x0008
 #define PERSIST_FLAG_SUPPRESS_ERR   0x0010
+#define PERSIST_FLAG_READ_ONLY      0x0020 /* storage connection only used
+					    * for queries, never sent */
 
 typedef enum {
 	PERSIST_TYPE_NONE = 0,
@@ -52,6 +54,7 @@ typedef enum {
 	PERSIST_TYPE_FED,
 	PERSIST_TYPE_HA_CTL,
 	PERSIST_TYPE_HA_DBD,
+	PERSIST_TYPE_DBD_AGENT,	/* extra slurmctld agent connection */
 } persist_conn_type_t;
 
 typedef struct {
@@ -990,10 +990,26 @@ extern void slurm_free_job_step_kill_msg(job_step_kill_msg_t * msg)
 	}
 }
 
+extern void slurm_free_job_info_filter(job_info_filter_t *filter)
+{
+	if (filter) {
+		FREE_NULL_LIST(filter->accounts);
+		FREE_NULL_LIST(filter->names);
+		xfree(filter->nodes);
+		FREE_NULL_LIST(filter->partitions);
+		FREE_NULL_LIST(filter->qos);
+		xfree(filter->reservation);
+		FREE_NULL_LIST(filter->states);
+		FREE_NULL_LIST(filter->user_ids);
+		xfree(filter);
+	}
+}
+
 extern void slurm_free_job_info_request_msg(job_info_request_msg_t *msg)
 {
 	if (msg) {
 		FREE_NULL_LIST(msg->job_ids);
+		slurm_free_job_info_filter(msg->filter);
 		xfree(msg);
 	}
 }
@@ -1009,9 +1025,22 @@ extern void slurm_free_front_end_info_request_msg
 	xfree(msg);
 }
 
+extern void slurm_free_node_info_filter(node_info_filter_t *filter)
+{
+	if (filter) {
+		xfree(filter->nodes);
+		FREE_NULL_LIST(filter->partitions);
+		FREE_NULL_LIST(filter->states);
+		xfree(filter);
+	}
+}
+
 extern void slurm_free_node_info_request_msg(node_info_request_msg_t *msg)
 {
-	xfree(msg);
+	if (msg) {
+		slurm_free_node_info_filter(msg->filter);
+		xfree(msg);
+	}
 }
 
 extern void slurm_free_node_info_single_msg(node_info_single_msg_t *msg)
@@ -1211,6 +1240,12 @@ extern void slurm_free_job_launch_msg(batch_job_launch_msg_t * msg)
 	}
 }
 
+/* ListDelF for the List carried by REQUEST_BATCH_JOB_LAUNCH_MULT */
+extern void slurm_free_job_launch_msg_list(void *x)
+{
+	slurm_free_job_launch_msg((batch_job_launch_msg_t *) x);
+}
+
 extern void slurm_free_job_info(job_info_t * job)
 {
 	if (job) {
@@ -4820,9 +4855,11 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 		slurm_free_last_update_msg(data);
 		break;
 	case REQUEST_JOB_INFO:
+	case REQUEST_JOB_INFO_FILTER:
 		slurm_free_job_info_request_msg(data);
 		break;
 	case REQUEST_NODE_INFO:
+	case REQUEST_NODE_INFO_FILTER:
 		slurm_free_node_info_request_msg(data);
 		break;
 	case REQUEST_NODE_INFO_SINGLE:
@@ -5157,6 +5194,7 @@ extern int slurm_free_msg_data(slurm_msg_type_t type, void *data)
 	case REQUEST_HET_JOB_ALLOCATION:
 	case REQUEST_SUBMIT_BATCH_HET_JOB:
 	case RESPONSE_HET_JOB_ALLOCATION:
+	case REQUEST_BATCH_JOB_LAUNCH_MULT:
 		FREE_NULL_LIST(data);
 		break;
 	case REQUEST_SET_FS_DAMPENING_FACTOR:
@@ -5435,6 +5473,10 @@ rpc_num2string(uint16_t opcode)
 		return "REQUEST_BURST_BUFFER_STATUS";
 	case RESPONSE_BURST_BUFFER_STATUS:
 		return "RESPONSE_BURST_BUFFER_STATUS";
+	case REQUEST_JOB_INFO_FILTER:
+		return "REQUEST_JOB_INFO_FILTER";
+	case REQUEST_NODE_INFO_FILTER:
+		return "REQUEST_NODE_INFO_FILTER";
 
 	case REQUEST_UPDATE_JOB:				/* 3001 */
 		return "REQUEST_UPDATE_JOB";
@@ -5514,6 +5556,8 @@ rpc_num2string(uint16_t opcode)
 		return "REQUEST_HET_JOB_ALLOC_INFO";
 	case REQUEST_SUBMIT_BATCH_HET_JOB:
 		return "REQUEST_SUBMIT_BATCH_HET_JOB";
+	case REQUEST_BATCH_JOB_LAUNCH_MULT:
+		return "REQUEST_BATCH_JOB_LAUNCH_MULT";
 
 	case REQUEST_JOB_STEP_CREATE:				/* 5001 */
 		return "REQUEST_JOB_STEP_CREATE";
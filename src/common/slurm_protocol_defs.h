@@ -296,6 +296,8 @@ typedef enum {
 	RESPONSE_CONTROL_STATUS,
 	REQUEST_BURST_BUFFER_STATUS,
 	RESPONSE_BURST_BUFFER_STATUS,
+	REQUEST_JOB_INFO_FILTER,
+	REQUEST_NODE_INFO_FILTER,
 
 	REQUEST_UPDATE_JOB = 3001,
 	REQUEST_UPDATE_NODE,
@@ -339,6 +341,7 @@ typedef enum {
 	RESPONSE_HET_JOB_ALLOCATION,
 	REQUEST_HET_JOB_ALLOC_INFO,
 	REQUEST_SUBMIT_BATCH_HET_JOB,
+	REQUEST_BATCH_JOB_LAUNCH_MULT,	/* List of batch_job_launch_msg_t */
 
 	REQUEST_CTLD_MULT_MSG = 4500,
 	RESPONSE_CTLD_MULT_MSG,
@@ -636,6 +639,7 @@ typedef struct job_info_request_msg {
 	uint16_t show_flags;
 	List   job_ids;		/* Optional list of job_ids, otherwise show all
 				 * jobs. */
+	job_info_filter_t *filter; /* Optional, REQUEST_JOB_INFO_FILTER only */
 } job_info_request_msg_t;
 
 typedef struct job_step_info_request_msg {
@@ -647,6 +651,7 @@ typedef struct job_step_info_request_msg {
 typedef struct node_info_request_msg {
 	time_t last_update;
 	uint16_t show_flags;
+	node_info_filter_t *filter; /* Optional, REQUEST_NODE_INFO_FILTER only */
 } node_info_request_msg_t;
 
 typedef struct node_info_single_msg {
@@ -1377,11 +1382,13 @@ extern void slurm_free_last_update_msg(last_update_msg_t * msg);
 extern void slurm_free_return_code_msg(return_code_msg_t * msg);
 extern void slurm_free_reroute_msg(reroute_msg_t *msg);
 extern void slurm_free_job_alloc_info_msg(job_alloc_info_msg_t * msg);
+extern void slurm_free_job_info_filter(job_info_filter_t *filter);
 extern void slurm_free_job_info_request_msg(job_info_request_msg_t *msg);
 extern void slurm_free_job_step_info_request_msg(
 		job_step_info_request_msg_t *msg);
 extern void slurm_free_front_end_info_request_msg(
 		front_end_info_request_msg_t *msg);
+extern void slurm_free_node_info_filter(node_info_filter_t *filter);
 extern void slurm_free_node_info_request_msg(node_info_request_msg_t *msg);
 extern void slurm_free_node_info_single_msg(node_info_single_msg_t *msg);
 extern void slurm_free_part_info_request_msg(part_info_request_msg_t *msg);
@@ -1435,6 +1442,7 @@ extern void slurm_free_config_response_msg(config_response_msg_t *msg);
 extern void slurm_free_step_id(slurm_step_id_t *msg);
 
 extern void slurm_free_job_launch_msg(batch_job_launch_msg_t * msg);
+extern void slurm_free_job_launch_msg_list(void *x);
 
 extern void slurm_free_update_front_end_msg(update_front_end_msg_t * msg);
 extern void slurm_free_update_node_msg(update_node_msg_t * msg);
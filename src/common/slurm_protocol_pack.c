@@ -9318,6 +9318,162 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static int _for_each_pack_str(void *x, void *arg)
+{
+	Buf buffer = arg;
+
+	packstr(x, buffer);
+
+	return SLURM_SUCCESS;
+}
+
+static int _for_each_pack_uint32(void *x, void *arg)
+{
+	Buf buffer = arg;
+
+	pack32(*(uint32_t *) x, buffer);
+
+	return SLURM_SUCCESS;
+}
+
+/* Pack list of char * or NO_VAL if there is no list */
+static void _pack_str_list(List l, Buf buffer)
+{
+	uint32_t count = NO_VAL;
+
+	if (l)
+		count = list_count(l);
+
+	pack32(count, buffer);
+	if (count && (count != NO_VAL))
+		list_for_each(l, _for_each_pack_str, buffer);
+}
+
+static int _unpack_str_list(List *l, Buf buffer)
+{
+	uint32_t count, uint32_tmp;
+	char *str;
+
+	safe_unpack32(&count, buffer);
+	if (count > NO_VAL)
+		goto unpack_error;
+	if (count != NO_VAL) {
+		*l = list_create(xfree_ptr);
+		for (int i = 0; i < count; i++) {
+			safe_unpackstr_xmalloc(&str, &uint32_tmp, buffer);
+			list_append(*l, str);
+		}
+	}
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	return SLURM_ERROR;
+}
+
+/* Pack list of uint32_t * or NO_VAL if there is no list */
+static void _pack_uint32_list(List l, Buf buffer)
+{
+	uint32_t count = NO_VAL;
+
+	if (l)
+		count = list_count(l);
+
+	pack32(count, buffer);
+	if (count && (count != NO_VAL))
+		list_for_each(l, _for_each_pack_uint32, buffer);
+}
+
+static int _unpack_uint32_list(List *l, Buf buffer)
+{
+	uint32_t count, *uint32_ptr = NULL;
+
+	safe_unpack32(&count, buffer);
+	if (count > NO_VAL)
+		goto unpack_error;
+	if (count != NO_VAL) {
+		*l = list_create(xfree_ptr);
+		for (int i = 0; i < count; i++) {
+			uint32_ptr = xmalloc(sizeof(uint32_t));
+			safe_unpack32(uint32_ptr, buffer);
+			list_append(*l, uint32_ptr);
+			uint32_ptr = NULL;
+		}
+	}
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	xfree(uint32_ptr);
+	return SLURM_ERROR;
+}
+
+static void
+_pack_job_info_filter_request_msg(job_info_request_msg_t *msg, Buf buffer,
+				  uint16_t protocol_version)
+{
+	job_info_filter_t *filter = msg->filter;
+
+	_pack_job_info_request_msg(msg, buffer, protocol_version);
+
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		if (!filter) {
+			pack8(0, buffer);
+			return;
+		}
+		pack8(1, buffer);
+		_pack_str_list(filter->accounts, buffer);
+		_pack_str_list(filter->names, buffer);
+		packstr(filter->nodes, buffer);
+		_pack_str_list(filter->partitions, buffer);
+		_pack_str_list(filter->qos, buffer);
+		packstr(filter->reservation, buffer);
+		_pack_uint32_list(filter->states, buffer);
+		_pack_uint32_list(filter->user_ids, buffer);
+		pack32(filter->skip_fields, buffer);
+	}
+}
+
+static int
+_unpack_job_info_filter_request_msg(job_info_request_msg_t **msg, Buf buffer,
+				    uint16_t protocol_version)
+{
+	uint8_t has_filter;
+	uint32_t uint32_tmp;
+	job_info_filter_t *filter;
+
+	if (_unpack_job_info_request_msg(msg, buffer, protocol_version))
+		return SLURM_ERROR;
+
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		safe_unpack8(&has_filter, buffer);
+		if (!has_filter)
+			return SLURM_SUCCESS;
+
+		filter = (*msg)->filter = xmalloc(sizeof(*filter));
+		if (_unpack_str_list(&filter->accounts, buffer) ||
+		    _unpack_str_list(&filter->names, buffer))
+			goto unpack_error;
+		safe_unpackstr_xmalloc(&filter->nodes, &uint32_tmp, buffer);
+		if (_unpack_str_list(&filter->partitions, buffer) ||
+		    _unpack_str_list(&filter->qos, buffer))
+			goto unpack_error;
+		safe_unpackstr_xmalloc(&filter->reservation, &uint32_tmp,
+				       buffer);
+		if (_unpack_uint32_list(&filter->states, buffer) ||
+		    _unpack_uint32_list(&filter->user_ids, buffer))
+			goto unpack_error;
+		safe_unpack32(&filter->skip_fields, buffer);
+	}
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_job_info_request_msg(*msg);
+	*msg = NULL;
+	return SLURM_ERROR;
+}
+
 static int _unpack_burst_buffer_info_msg(
 	burst_buffer_info_msg_t **burst_buffer_info, Buf buffer,
 	uint16_t protocol_version)
@@ -9527,6 +9683,59 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static void
+_pack_node_info_filter_request_msg(node_info_request_msg_t *msg, Buf buffer,
+				   uint16_t protocol_version)
+{
+	node_info_filter_t *filter = msg->filter;
+
+	_pack_node_info_request_msg(msg, buffer, protocol_version);
+
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		if (!filter) {
+			pack8(0, buffer);
+			return;
+		}
+		pack8(1, buffer);
+		packstr(filter->nodes, buffer);
+		_pack_str_list(filter->partitions, buffer);
+		_pack_uint32_list(filter->states, buffer);
+		pack32(filter->skip_fields, buffer);
+	}
+}
+
+static int
+_unpack_node_info_filter_request_msg(node_info_request_msg_t **msg,
+				     Buf buffer, uint16_t protocol_version)
+{
+	uint8_t has_filter;
+	uint32_t uint32_tmp;
+	node_info_filter_t *filter;
+
+	if (_unpack_node_info_request_msg(msg, buffer, protocol_version))
+		return SLURM_ERROR;
+
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		safe_unpack8(&has_filter, buffer);
+		if (!has_filter)
+			return SLURM_SUCCESS;
+
+		filter = (*msg)->filter = xmalloc(sizeof(*filter));
+		safe_unpackstr_xmalloc(&filter->nodes, &uint32_tmp, buffer);
+		if (_unpack_str_list(&filter->partitions, buffer) ||
+		    _unpack_uint32_list(&filter->states, buffer))
+			goto unpack_error;
+		safe_unpack32(&filter->skip_fields, buffer);
+	}
+
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_node_info_request_msg(*msg);
+	*msg = NULL;
+	return SLURM_ERROR;
+}
+
 static void
 _pack_node_info_single_msg(node_info_single_msg_t * msg, Buf buffer,
 			   uint16_t protocol_version)
@@ -10150,6 +10359,41 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+static void _pack_batch_job_launch_list_item(void *object,
+					     uint16_t protocol_version,
+					     Buf buffer)
+{
+	_pack_batch_job_launch_msg((batch_job_launch_msg_t *) object, buffer,
+				   protocol_version);
+}
+
+static int _unpack_batch_job_launch_list_item(void **object,
+					      uint16_t protocol_version,
+					      Buf buffer)
+{
+	return _unpack_batch_job_launch_msg((batch_job_launch_msg_t **) object,
+					    buffer, protocol_version);
+}
+
+/* _pack_batch_job_launch_mult_msg
+ * packs a list of batch_job_launch_msg_t structs, all for the same node
+ */
+static void _pack_batch_job_launch_mult_msg(List launch_list, Buf buffer,
+					    uint16_t protocol_version)
+{
+	(void) slurm_pack_list(launch_list, _pack_batch_job_launch_list_item,
+			       buffer, protocol_version);
+}
+
+static int _unpack_batch_job_launch_mult_msg(List *launch_list, Buf buffer,
+					     uint16_t protocol_version)
+{
+	return slurm_unpack_list(launch_list,
+				 _unpack_batch_job_launch_list_item,
+				 slurm_free_job_launch_msg_list,
+				 buffer, protocol_version);
+}
+
 static void
 _pack_job_id_request_msg(job_id_request_msg_t * msg, Buf buffer,
 			 uint16_t protocol_version)
@@ -11306,7 +11550,35 @@ static void _pack_slurmd_status(slurmd_status_t *msg, Buf buffer,
 {
 	xassert(msg);
 
-	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		pack_time(msg->booted, buffer);
+		pack_time(msg->last_slurmctld_msg, buffer);
+
+		pack16(msg->slurmd_debug, buffer);
+		pack16(msg->actual_cpus, buffer);
+		pack16(msg->actual_boards, buffer);
+		pack16(msg->actual_sockets, buffer);
+		pack16(msg->actual_cores, buffer);
+		pack16(msg->actual_threads, buffer);
+
+		pack64(msg->actual_real_mem, buffer);
+		pack32(msg->actual_tmp_disk, buffer);
+		pack32(msg->pid, buffer);
+
+		packstr(msg->hostname, buffer);
+		packstr(msg->slurmd_logfile, buffer);
+		packstr(msg->step_list, buffer);
+		packstr(msg->version, buffer);
+
+		pack16(msg->stepd_pool_size, buffer);
+		pack16(msg->stepd_pool_idle, buffer);
+		pack32(msg->stepd_fork_cnt, buffer);
+		pack64(msg->stepd_fork_usec, buffer);
+		pack64(msg->stepd_fork_max, buffer);
+		pack32(msg->stepd_pool_cnt, buffer);
+		pack64(msg->stepd_pool_usec, buffer);
+		pack64(msg->stepd_pool_max, buffer);
+	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		pack_time(msg->booted, buffer);
 		pack_time(msg->last_slurmctld_msg, buffer);
 
@@ -11338,7 +11610,39 @@ static int _unpack_slurmd_status(slurmd_status_t **msg_ptr, Buf buffer,
 
 	msg = xmalloc(sizeof(slurmd_status_t));
 
-	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		safe_unpack_time(&msg->booted, buffer);
+		safe_unpack_time(&msg->last_slurmctld_msg, buffer);
+
+		safe_unpack16(&msg->slurmd_debug, buffer);
+		safe_unpack16(&msg->actual_cpus, buffer);
+		safe_unpack16(&msg->actual_boards, buffer);
+		safe_unpack16(&msg->actual_sockets, buffer);
+		safe_unpack16(&msg->actual_cores, buffer);
+		safe_unpack16(&msg->actual_threads, buffer);
+
+		safe_unpack64(&msg->actual_real_mem, buffer);
+		safe_unpack32(&msg->actual_tmp_disk, buffer);
+		safe_unpack32(&msg->pid, buffer);
+
+		safe_unpackstr_xmalloc(&msg->hostname,
+				       &uint32_tmp, buffer);
+		safe_unpackstr_xmalloc(&msg->slurmd_logfile,
+				       &uint32_tmp, buffer);
+		safe_unpackstr_xmalloc(&msg->step_list,
+				       &uint32_tmp, buffer);
+		safe_unpackstr_xmalloc(&msg->version,
+				       &uint32_tmp, buffer);
+
+		safe_unpack16(&msg->stepd_pool_size, buffer);
+		safe_unpack16(&msg->stepd_pool_idle, buffer);
+		safe_unpack32(&msg->stepd_fork_cnt, buffer);
+		safe_unpack64(&msg->stepd_fork_usec, buffer);
+		safe_unpack64(&msg->stepd_fork_max, buffer);
+		safe_unpack32(&msg->stepd_pool_cnt, buffer);
+		safe_unpack64(&msg->stepd_pool_usec, buffer);
+		safe_unpack64(&msg->stepd_pool_max, buffer);
+	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		safe_unpack_time(&msg->booted, buffer);
 		safe_unpack_time(&msg->last_slurmctld_msg, buffer);
 
@@ -11759,6 +12063,20 @@ static int  _unpack_stats_response_msg(stats_info_response_msg_t **msg_ptr,
 
 			safe_unpack32(&msg->bf_active,		buffer);
 			safe_unpack32(&msg->bf_backfilled_het_jobs, buffer);
+
+			if (protocol_version >=
+			    SLURM_20_11_PROTOCOL_VERSION) {
+				safe_unpack32(&msg->prio_cycle_counter,
+					      buffer);
+				safe_unpack64(&msg->prio_cycle_sum, buffer);
+				safe_unpack32(&msg->prio_cycle_last, buffer);
+				safe_unpack32(&msg->prio_cycle_max, buffer);
+				safe_unpack32(&msg->prio_last_jobs_moved,
+					      buffer);
+				safe_unpack32(&msg->prio_last_jobs_same,
+					      buffer);
+				safe_unpack32(&msg->prio_norm_counter, buffer);
+			}
 		}
 
 		safe_unpack32(&msg->rpc_type_size,		buffer);
@@ -12381,6 +12699,11 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 					    msg->data, buffer,
 					    msg->protocol_version);
 		break;
+	case REQUEST_NODE_INFO_FILTER:
+		_pack_node_info_filter_request_msg((node_info_request_msg_t *)
+						   msg->data, buffer,
+						   msg->protocol_version);
+		break;
 	case REQUEST_NODE_INFO_SINGLE:
 		_pack_node_info_single_msg((node_info_single_msg_t *)
 					   msg->data, buffer,
@@ -12615,6 +12938,11 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 					   msg->data, buffer,
 					   msg->protocol_version);
 		break;
+	case REQUEST_JOB_INFO_FILTER:
+		_pack_job_info_filter_request_msg((job_info_request_msg_t *)
+						  msg->data, buffer,
+						  msg->protocol_version);
+		break;
 	case REQUEST_CANCEL_JOB_STEP:
 	case REQUEST_KILL_JOB:
 	case SRUN_STEP_SIGNAL:
@@ -12689,6 +13017,10 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 					   msg->data, buffer,
 					   msg->protocol_version);
 		break;
+	case REQUEST_BATCH_JOB_LAUNCH_MULT:
+		_pack_batch_job_launch_mult_msg((List) msg->data, buffer,
+						msg->protocol_version);
+		break;
 	case REQUEST_LAUNCH_PROLOG:
 		_pack_prolog_launch_msg((prolog_launch_msg_t *)
 					msg->data, buffer, msg->protocol_version);
@@ -13010,6 +13342,11 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 						   & (msg->data), buffer,
 						   msg->protocol_version);
 		break;
+	case REQUEST_NODE_INFO_FILTER:
+		rc = _unpack_node_info_filter_request_msg(
+			(node_info_request_msg_t **) &(msg->data), buffer,
+			msg->protocol_version);
+		break;
 	case REQUEST_NODE_INFO_SINGLE:
 		rc = _unpack_node_info_single_msg((node_info_single_msg_t **)
 						  & (msg->data), buffer,
@@ -13263,6 +13600,11 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 						  & (msg->data), buffer,
 						  msg->protocol_version);
 		break;
+	case REQUEST_JOB_INFO_FILTER:
+		rc = _unpack_job_info_filter_request_msg(
+			(job_info_request_msg_t **) &(msg->data), buffer,
+			msg->protocol_version);
+		break;
 	case REQUEST_CANCEL_JOB_STEP:
 	case REQUEST_KILL_JOB:
 	case SRUN_STEP_SIGNAL:
@@ -13343,6 +13685,11 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 						  & (msg->data), buffer,
 						  msg->protocol_version);
 		break;
+	case REQUEST_BATCH_JOB_LAUNCH_MULT:
+		rc = _unpack_batch_job_launch_mult_msg((List *) &(msg->data),
+						       buffer,
+						       msg->protocol_version);
+		break;
 	case REQUEST_LAUNCH_PROLOG:
 		rc = _unpack_prolog_launch_msg((prolog_launch_msg_t **)
 					       & (msg->data),
@@ -241,6 +241,7 @@
 #define grow_buf		slurm_grow_buf
 #define	init_buf		slurm_init_buf
 #define	xfer_buf_data		slurm_xfer_buf_data
+#define	write_buf		slurm_write_buf
 #define	pack_time		slurm_pack_time
 #define	unpack_time		slurm_unpack_time
 #define	packdouble		slurm_packdouble
@@ -2305,6 +2305,22 @@ extern const char *rollup_interval_to_string(int interval)
 	}
 }
 
+extern const char *rollup_phase_to_string(int phase)
+{
+	switch (phase) {
+	case DBD_ROLLUP_PHASE_RESV:
+		return "Reservations";
+	case DBD_ROLLUP_PHASE_EVENT:
+		return "Events";
+	case DBD_ROLLUP_PHASE_JOB:
+		return "Jobs";
+	case DBD_ROLLUP_PHASE_INSERT:
+		return "Usage insert";
+	default:
+		return "Unknown";
+	}
+}
+
 extern int set_qos_bitstr_from_string(bitstr_t *valid_qos, char *names)
 {
 	int rc = SLURM_SUCCESS;
@@ -3648,6 +3664,7 @@ extern char *slurmdb_make_tres_string_from_simple(
 	uint64_t count;
 	slurmdb_tres_rec_t *tres_rec;
 	char *node_name = NULL;
+	hostlist_t hl = NULL;
 	List char_list = NULL;
 
 	if (!full_tres_list || !tmp_str || !tmp_str[0]
@@ -3655,6 +3672,9 @@ extern char *slurmdb_make_tres_string_from_simple(
 		return tres_str;
 
 	while (tmp_str) {
+		char outbuf[FORMAT_STRING_SIZE];
+		char *value = outbuf;
+
 		id = atoi(tmp_str);
 		if (id <= 0) {
 			error("slurmdb_make_tres_string_from_simple: no id "
@@ -3679,47 +3699,54 @@ extern char *slurmdb_make_tres_string_from_simple(
 		if (count == NO_VAL64)
 			goto get_next;
 
-		if (tres_str)
-			xstrcat(tres_str, ",");
-		if (!tres_rec->type)
-			xstrfmtcat(tres_str, "%u=", tres_rec->id);
+		/* format the value first so each entry is a single append */
+		if (count == INFINITE64) {
+			value = "NONE";
+		} else if (nodes) {
+			/* parse nodes once for all of the entries */
+			if (!hl)
+				hl = hostlist_create(nodes);
+			if ((count < NO_VAL) &&
+			    (node_name = hostlist_nth(hl, (int) count)))
+				value = node_name;
+			else	/* as find_hostname() printed with "%s" */
+				value = "(null)";
+		} else if (tres_str_flags & TRES_STR_FLAG_BYTES) {
+			/* This mean usage */
+			if (tres_rec->id == TRES_CPU) {
+				count /= CPU_TIME_ADJ;
+				secs2time_str((time_t)count, outbuf,
+					      FORMAT_STRING_SIZE);
+			} else
+				convert_num_unit((double)count, outbuf,
+						 sizeof(outbuf),
+						 UNIT_NONE,
+						 spec_unit,
+						 convert_flags);
+		} else if ((tres_rec->id == TRES_MEM) ||
+			   !xstrcasecmp(tres_rec->type, "bb")) {
+			convert_num_unit((double)count, outbuf,
+					 sizeof(outbuf), UNIT_MEGA,
+					 spec_unit, convert_flags);
+		} else {
+			snprintf(outbuf, sizeof(outbuf), "%"PRIu64, count);
+		}
 
+		if (!tres_rec->type)
+			xstrfmtcat(tres_str, "%s%u=%s",
+				   tres_str ? "," : "", tres_rec->id, value);
 		else
-			xstrfmtcat(tres_str, "%s%s%s=",
+			xstrfmtcat(tres_str, "%s%s%s%s=%s",
+				   tres_str ? "," : "",
 				   tres_rec->type,
 				   tres_rec->name ? "/" : "",
-				   tres_rec->name ? tres_rec->name : "");
-		if (count != INFINITE64) {
-			if (nodes) {
-				node_name = find_hostname(count, nodes);
-				xstrfmtcat(tres_str, "%s", node_name);
-				xfree(node_name);
-			} else if (tres_str_flags & TRES_STR_FLAG_BYTES) {
-				/* This mean usage */
-				char outbuf[FORMAT_STRING_SIZE];
-				if (tres_rec->id == TRES_CPU) {
-					count /= CPU_TIME_ADJ;
-					secs2time_str((time_t)count, outbuf,
-						      FORMAT_STRING_SIZE);
-				} else
-					convert_num_unit((double)count, outbuf,
-							 sizeof(outbuf),
-							 UNIT_NONE,
-							 spec_unit,
-							 convert_flags);
-				xstrfmtcat(tres_str, "%s", outbuf);
-			} else if ((tres_rec->id == TRES_MEM) ||
-				   !xstrcasecmp(tres_rec->type, "bb")) {
-				char outbuf[FORMAT_STRING_SIZE];
-				convert_num_unit((double)count, outbuf,
-						 sizeof(outbuf), UNIT_MEGA,
-						 spec_unit, convert_flags);
-				xstrfmtcat(tres_str, "%s", outbuf);
-			} else {
-				xstrfmtcat(tres_str, "%"PRIu64, count);
-			}
-		} else
-			xstrfmtcat(tres_str, "NONE");
+				   tres_rec->name ? tres_rec->name : "",
+				   value);
+
+		if (node_name) {
+			free(node_name);
+			node_name = NULL;
+		}
 
 		if (!(tres_str_flags & TRES_STR_FLAG_SORT_ID)) {
 			if (!char_list)
@@ -3733,6 +3760,8 @@ extern char *slurmdb_make_tres_string_from_simple(
 		tmp_str++;
 	}
 
+	FREE_NULL_HOSTLIST(hl);
+
 	if (char_list) {
 		tres_str = slurm_char_list_to_xstr(char_list);
 		FREE_NULL_LIST(char_list);
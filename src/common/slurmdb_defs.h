@@ -162,6 +162,7 @@ extern char *get_classification_str(uint16_t classification);
 extern uint16_t str_2_classification(char *classification);
 
 extern const char *rollup_interval_to_string(int interval);
+extern const char *rollup_phase_to_string(int phase);
 
 extern char *slurmdb_problem_str_get(uint16_t problem);
 extern uint16_t str_2_slurmdb_problem(char *problem);
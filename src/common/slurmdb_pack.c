@@ -2755,14 +2755,29 @@ extern void slurmdb_pack_archive_rec(void *in, uint16_t protocol_version,
 {
 	slurmdb_archive_rec_t *object = (slurmdb_archive_rec_t *)in;
 
-	if (!object) {
-		packnull(buffer);
-		packnull(buffer);
-		return;
-	}
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		if (!object) {
+			packnull(buffer);
+			packnull(buffer);
+			pack_time(0, buffer);
+			pack_time(0, buffer);
+			return;
+		}
+
+		packstr(object->archive_file, buffer);
+		packstr(object->insert, buffer);
+		pack_time(object->time_end, buffer);
+		pack_time(object->time_start, buffer);
+	} else {
+		if (!object) {
+			packnull(buffer);
+			packnull(buffer);
+			return;
+		}
 
-	packstr(object->archive_file, buffer);
-	packstr(object->insert, buffer);
+		packstr(object->archive_file, buffer);
+		packstr(object->insert, buffer);
+	}
 }
 
 extern int slurmdb_unpack_archive_rec(void **object, uint16_t protocol_version,
@@ -2776,6 +2791,10 @@ extern int slurmdb_unpack_archive_rec(void **object, uint16_t protocol_version,
 
 	safe_unpackstr_xmalloc(&object_ptr->archive_file, &uint32_tmp, buffer);
 	safe_unpackstr_xmalloc(&object_ptr->insert, &uint32_tmp, buffer);
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		safe_unpack_time(&object_ptr->time_end, buffer);
+		safe_unpack_time(&object_ptr->time_start, buffer);
+	}
 
 	return SLURM_SUCCESS;
 
@@ -5805,7 +5824,19 @@ extern void slurmdb_pack_rollup_stats(void *in, uint16_t protocol_version,
 	slurmdb_rollup_stats_t *object = (slurmdb_rollup_stats_t *) in;
 	uint32_t i;
 
-	if (protocol_version >= SLURM_20_02_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+		packstr(object->cluster_name, buffer);
+		pack16(DBD_ROLLUP_COUNT, buffer);
+		for (i = 0; i < DBD_ROLLUP_COUNT; i++) {
+			pack16(object->count[i], buffer);
+			pack_time(object->timestamp[i], buffer);
+			pack64(object->time_last[i], buffer);
+			pack64(object->time_max[i], buffer);
+			pack64(object->time_total[i], buffer);
+		}
+		pack64_array(object->phase_time, DBD_ROLLUP_PHASE_COUNT,
+			     buffer);
+	} else if (protocol_version >= SLURM_20_02_PROTOCOL_VERSION) {
 		packstr(object->cluster_name, buffer);
 		pack16(DBD_ROLLUP_COUNT, buffer);
 		for (i = 0; i < DBD_ROLLUP_COUNT; i++) {
@@ -5827,6 +5858,7 @@ extern int slurmdb_unpack_rollup_stats(void **object, uint16_t protocol_version,
 {
 	uint32_t uint32_tmp;
 	uint16_t rollup_count;
+	uint64_t *phase_time = NULL;
 	int i;
 	slurmdb_rollup_stats_t *object_ptr =
 		xmalloc(sizeof(slurmdb_rollup_stats_t));
@@ -5855,6 +5887,14 @@ extern int slurmdb_unpack_rollup_stats(void **object, uint16_t protocol_version,
 			safe_unpack64(&object_ptr->time_max[i], buffer);
 			safe_unpack64(&object_ptr->time_total[i], buffer);
 		}
+
+		if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+			safe_unpack64_array(&phase_time, &uint32_tmp, buffer);
+			memcpy(object_ptr->phase_time, phase_time,
+			       sizeof(uint64_t) *
+			       MIN(uint32_tmp, DBD_ROLLUP_PHASE_COUNT));
+			xfree(phase_time);
+		}
 	} else {
 		error("%s: protocol_version %hu not supported",
 		      __func__, protocol_version);
@@ -5864,6 +5904,7 @@ extern int slurmdb_unpack_rollup_stats(void **object, uint16_t protocol_version,
 	return SLURM_SUCCESS;
 
 unpack_error:
+	xfree(phase_time);
 	slurmdb_destroy_rollup_stats(object_ptr);
 	*object = NULL;
 	return SLURM_ERROR;
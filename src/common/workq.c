@@ -332,3 +332,16 @@ extern int workq_get_active(workq_t *workq)
 
 	return active;
 }
+
+extern int workq_get_queued(workq_t *workq)
+{
+	int queued;
+
+	_check_magic_workq(workq);
+
+	slurm_mutex_lock(&workq->mutex);
+	queued = list_count(workq->work);
+	slurm_mutex_unlock(&workq->mutex);
+
+	return queued;
+}
@@ -102,6 +102,11 @@ extern int workq_add_work(workq_t *workq, work_func_t func, void *arg,
  */
 extern int workq_get_active(workq_t *workq);
 
+/*
+ * Grab copy of the workq count of work waiting on a worker
+ */
+extern int workq_get_queued(workq_t *workq);
+
 #define FREE_NULL_WORKQ(_X)             \
 	do {                            \
 		if (_X)                 \
@@ -49,6 +49,9 @@
 #include "src/common/read_config.h"
 
 #define MAX_DEADLOCK_ATTEMPTS 10
+/* Send deferred statements once there are this many or they get this big */
+#define MAX_DEFERRED_CNT 1000
+#define MAX_DEFERRED_SIZE (512 * 1024)
 
 static char *table_defs_table = "table_defs_table";
 
@@ -202,6 +205,75 @@ end_it:
 	return rc;
 }
 
+/* NOTE: Ensure that mysql_conn->lock is set on function entry */
+static void _close_deferred_insert(mysql_conn_t *mysql_conn)
+{
+	if (!mysql_conn->defer_insert)
+		return;
+
+	if (mysql_conn->defer_insert_end)
+		xstrfmtcat(mysql_conn->deferred_query, " %s",
+			   mysql_conn->defer_insert_end);
+	xstrcat(mysql_conn->deferred_query, ";");
+	xfree(mysql_conn->defer_insert);
+	xfree(mysql_conn->defer_insert_end);
+}
+
+/* NOTE: Ensure that mysql_conn->lock is set on function entry */
+static void _discard_deferred(mysql_conn_t *mysql_conn)
+{
+	if (mysql_conn->deferred_cnt)
+		debug("%s: dropping %u deferred statement(s)",
+		      __func__, mysql_conn->deferred_cnt);
+	xfree(mysql_conn->defer_insert);
+	xfree(mysql_conn->defer_insert_end);
+	xfree(mysql_conn->deferred_query);
+	mysql_conn->deferred_cnt = 0;
+	mysql_conn->deferred_rc = SLURM_SUCCESS;
+}
+
+/* NOTE: Ensure that mysql_conn->lock is set on function entry */
+static int _flush_deferred(mysql_conn_t *mysql_conn)
+{
+	int rc;
+
+	if (!mysql_conn->deferred_query)
+		return SLURM_SUCCESS;
+
+	if (!mysql_conn->db_conn) {
+		_discard_deferred(mysql_conn);
+		mysql_conn->deferred_rc = SLURM_ERROR;
+		return SLURM_ERROR;
+	}
+
+	_close_deferred_insert(mysql_conn);
+	if ((rc = _mysql_query_internal(mysql_conn->db_conn,
+					mysql_conn->deferred_query))
+	    != SLURM_ERROR)
+		rc = _clear_results(mysql_conn->db_conn);
+	if (rc != SLURM_SUCCESS) {
+		error("%s: %u deferred statement(s) failed",
+		      __func__, mysql_conn->deferred_cnt);
+		if (!mysql_conn->deferred_rc)
+			mysql_conn->deferred_rc = rc;
+	}
+
+	xfree(mysql_conn->deferred_query);
+	mysql_conn->deferred_cnt = 0;
+
+	return rc;
+}
+
+/* NOTE: Ensure that mysql_conn->lock is set on function entry */
+static int _check_deferred(mysql_conn_t *mysql_conn)
+{
+	if ((mysql_conn->deferred_cnt < MAX_DEFERRED_CNT) &&
+	    (strlen(mysql_conn->deferred_query) < MAX_DEFERRED_SIZE))
+		return SLURM_SUCCESS;
+
+	return _flush_deferred(mysql_conn);
+}
+
 /* NOTE: Ensure that mysql_conn->lock is NOT set on function entry */
 static int _mysql_make_table_current(mysql_conn_t *mysql_conn, char *table_name,
 				     storage_field_t *fields, char *ending)
@@ -707,6 +779,9 @@ extern int destroy_mysql_conn(mysql_conn_t *mysql_conn)
 {
 	if (mysql_conn) {
 		mysql_db_close_db_connection(mysql_conn);
+		xfree(mysql_conn->deferred_query);
+		xfree(mysql_conn->defer_insert);
+		xfree(mysql_conn->defer_insert_end);
 		xfree(mysql_conn->pre_commit_query);
 		xfree(mysql_conn->cluster_name);
 		slurm_mutex_destroy(&mysql_conn->lock);
@@ -848,6 +923,7 @@ extern int mysql_db_get_db_connection(mysql_conn_t *mysql_conn, char *db_name,
 extern int mysql_db_close_db_connection(mysql_conn_t *mysql_conn)
 {
 	slurm_mutex_lock(&mysql_conn->lock);
+	_discard_deferred(mysql_conn);
 	if (mysql_conn && mysql_conn->db_conn) {
 		if (mysql_thread_safe())
 			mysql_thread_end();
@@ -880,11 +956,61 @@ extern int mysql_db_query(mysql_conn_t *mysql_conn, char *query)
 		return 0;	/* For CLANG false positive */
 	}
 	slurm_mutex_lock(&mysql_conn->lock);
+	(void) _flush_deferred(mysql_conn);
 	rc = _mysql_query_internal(mysql_conn->db_conn, query);
 	slurm_mutex_unlock(&mysql_conn->lock);
 	return rc;
 }
 
+extern int mysql_db_defer_query(mysql_conn_t *mysql_conn, char *query)
+{
+	int rc;
+
+	slurm_mutex_lock(&mysql_conn->lock);
+	_close_deferred_insert(mysql_conn);
+	xstrfmtcat(mysql_conn->deferred_query, "%s;", query);
+	mysql_conn->deferred_cnt++;
+	rc = _check_deferred(mysql_conn);
+	slurm_mutex_unlock(&mysql_conn->lock);
+
+	return rc;
+}
+
+extern int mysql_db_defer_insert(mysql_conn_t *mysql_conn, char *insert,
+				 char *values, char *end)
+{
+	int rc;
+
+	slurm_mutex_lock(&mysql_conn->lock);
+	if (mysql_conn->defer_insert &&
+	    !xstrcmp(mysql_conn->defer_insert, insert) &&
+	    !xstrcmp(mysql_conn->defer_insert_end, end)) {
+		xstrfmtcat(mysql_conn->deferred_query, ", %s", values);
+	} else {
+		_close_deferred_insert(mysql_conn);
+		xstrfmtcat(mysql_conn->deferred_query, "%s values %s",
+			   insert, values);
+		mysql_conn->defer_insert = xstrdup(insert);
+		mysql_conn->defer_insert_end = xstrdup(end);
+	}
+	mysql_conn->deferred_cnt++;
+	rc = _check_deferred(mysql_conn);
+	slurm_mutex_unlock(&mysql_conn->lock);
+
+	return rc;
+}
+
+extern int mysql_db_flush_deferred(mysql_conn_t *mysql_conn)
+{
+	int rc;
+
+	slurm_mutex_lock(&mysql_conn->lock);
+	rc = _flush_deferred(mysql_conn);
+	slurm_mutex_unlock(&mysql_conn->lock);
+
+	return rc;
+}
+
 /*
  * Executes a single delete sql query.
  * Returns the number of deleted rows, <0 for failure.
@@ -898,6 +1024,7 @@ extern int mysql_db_delete_affected_rows(mysql_conn_t *mysql_conn, char *query)
 		return 0;	/* For CLANG false positive */
 	}
 	slurm_mutex_lock(&mysql_conn->lock);
+	(void) _flush_deferred(mysql_conn);
 	if (!(rc = _mysql_query_internal(mysql_conn->db_conn, query)))
 		rc = mysql_affected_rows(mysql_conn->db_conn);
 	slurm_mutex_unlock(&mysql_conn->lock);
@@ -933,9 +1060,19 @@ extern int mysql_db_commit(mysql_conn_t *mysql_conn)
 		return SLURM_ERROR;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	(void) _flush_deferred(mysql_conn);
 	/* clear out the old results so we don't get a 2014 error */
 	_clear_results(mysql_conn->db_conn);
-	if (mysql_commit(mysql_conn->db_conn)) {
+	if ((rc = mysql_conn->deferred_rc)) {
+		/* Don't commit half of a batch, it will be sent again */
+		error("%s: deferred statements failed, rolling back",
+		      __func__);
+		mysql_conn->deferred_rc = SLURM_SUCCESS;
+		if (mysql_rollback(mysql_conn->db_conn))
+			error("mysql_rollback failed: %d %s",
+			      mysql_errno(mysql_conn->db_conn),
+			      mysql_error(mysql_conn->db_conn));
+	} else if (mysql_commit(mysql_conn->db_conn)) {
 		error("mysql_commit failed: %d %s",
 		      mysql_errno(mysql_conn->db_conn),
 		      mysql_error(mysql_conn->db_conn));
@@ -954,6 +1091,7 @@ extern int mysql_db_rollback(mysql_conn_t *mysql_conn)
 		return SLURM_ERROR;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	_discard_deferred(mysql_conn);
 	/* clear out the old results so we don't get a 2014 error */
 	_clear_results(mysql_conn->db_conn);
 	if (mysql_rollback(mysql_conn->db_conn)) {
@@ -980,6 +1118,7 @@ extern MYSQL_RES *mysql_db_query_ret(mysql_conn_t *mysql_conn,
 	MYSQL_RES *result = NULL;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	(void) _flush_deferred(mysql_conn);
 	if (_mysql_query_internal(mysql_conn->db_conn, query) != SLURM_ERROR)  {
 		if (mysql_errno(mysql_conn->db_conn) == ER_NO_SUCH_TABLE)
 			goto fini;
@@ -1009,6 +1148,7 @@ extern int mysql_db_query_check_after(mysql_conn_t *mysql_conn, char *query)
 	int rc = SLURM_SUCCESS;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	(void) _flush_deferred(mysql_conn);
 	if ((rc = _mysql_query_internal(
 		     mysql_conn->db_conn, query)) != SLURM_ERROR)
 		rc = _clear_results(mysql_conn->db_conn);
@@ -1021,6 +1161,7 @@ extern uint64_t mysql_db_insert_ret_id(mysql_conn_t *mysql_conn, char *query)
 	uint64_t new_id = 0;
 
 	slurm_mutex_lock(&mysql_conn->lock);
+	(void) _flush_deferred(mysql_conn);
 	if (_mysql_query_internal(mysql_conn->db_conn, query) != SLURM_ERROR)  {
 		new_id = mysql_insert_id(mysql_conn->db_conn);
 		if (!new_id) {
@@ -62,8 +62,14 @@ typedef struct {
 	bool cluster_deleted;
 	char *cluster_name;
 	MYSQL *db_conn;
+	char *defer_insert;	/* "insert into ..." deferred_query ends with */
+	char *defer_insert_end;	/* what closes defer_insert */
+	uint32_t deferred_cnt;	/* records in deferred_query */
+	char *deferred_query;	/* statements sent with the next query */
+	int deferred_rc;	/* first deferred failure since last commit */
 	pthread_mutex_t lock;
 	char *pre_commit_query;
+	bool read_only;		/* only runs queries, may use a read replica */
 	bool rollback;
 	List update_list;
 	int conn;
@@ -94,6 +100,24 @@ extern int mysql_db_get_db_connection(mysql_conn_t *mysql_conn, char *db_name,
 extern int mysql_db_close_db_connection(mysql_conn_t *mysql_conn);
 extern int mysql_db_cleanup();
 extern int mysql_db_query(mysql_conn_t *mysql_conn, char *query);
+
+/*
+ * Queue a statement that returns nothing to be sent along with the next
+ * query, commit or once enough are queued, so a batch of them costs one
+ * round trip.  Deferred statements are part of the current transaction and
+ * are dropped on rollback.  If any of them fails mysql_db_commit() rolls
+ * back instead and returns an error.
+ */
+extern int mysql_db_defer_query(mysql_conn_t *mysql_conn, char *query);
+/*
+ * Same as mysql_db_defer_query() for "<insert> values <values> <end>".
+ * Consecutive calls with the same insert and end are sent as one multi-row
+ * insert.
+ */
+extern int mysql_db_defer_insert(mysql_conn_t *mysql_conn, char *insert,
+				 char *values, char *end);
+/* Send any deferred statements now */
+extern int mysql_db_flush_deferred(mysql_conn_t *mysql_conn);
 extern int mysql_db_delete_affected_rows(mysql_conn_t *mysql_conn, char *query);
 extern int mysql_db_ping(mysql_conn_t *mysql_conn);
 extern int mysql_db_commit(mysql_conn_t *mysql_conn);
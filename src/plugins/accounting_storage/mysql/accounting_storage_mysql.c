@@ -104,6 +104,7 @@ const char plugin_type[] = "accounting_storage/as_mysql";
 const uint32_t plugin_version = SLURM_VERSION_NUMBER;
 
 static mysql_db_info_t *mysql_db_info = NULL;
+static mysql_db_info_t *mysql_read_db_info = NULL; /* StorageReadHost */
 static char *mysql_db_name = NULL;
 
 #define DELETE_SEC_BACK 86400
@@ -160,6 +161,14 @@ enum {
 
 extern int acct_storage_p_close_connection(mysql_conn_t **mysql_conn);
 
+/* Read only connections go to StorageReadHost if there is one */
+static mysql_db_info_t *_get_db_info(mysql_conn_t *mysql_conn)
+{
+	if (mysql_conn->read_only && mysql_read_db_info)
+		return mysql_read_db_info;
+	return mysql_db_info;
+}
+
 static List _get_cluster_names(mysql_conn_t *mysql_conn, bool with_deleted)
 {
 	MYSQL_RES *result = NULL;
@@ -1102,7 +1111,8 @@ extern int check_connection(mysql_conn_t *mysql_conn)
 		/* avoid memory leak and end thread */
 		mysql_db_close_db_connection(mysql_conn);
 		if (mysql_db_get_db_connection(
-			    mysql_conn, mysql_db_name, mysql_db_info)
+			    mysql_conn, mysql_db_name,
+			    _get_db_info(mysql_conn))
 		    != SLURM_SUCCESS) {
 			error("unable to re-connect to as_mysql database");
 			errno = ESLURM_DB_CONNECTION;
@@ -1118,6 +1128,24 @@ extern int check_connection(mysql_conn_t *mysql_conn)
 	return SLURM_SUCCESS;
 }
 
+extern List as_mysql_copy_cluster_list(void)
+{
+	List cluster_list = list_create(xfree_ptr);
+	ListIterator itr;
+	char *cluster_name;
+
+	slurm_mutex_lock(&as_mysql_cluster_list_lock);
+	if (as_mysql_cluster_list) {
+		itr = list_iterator_create(as_mysql_cluster_list);
+		while ((cluster_name = list_next(itr)))
+			list_append(cluster_list, xstrdup(cluster_name));
+		list_iterator_destroy(itr);
+	}
+	slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+
+	return cluster_list;
+}
+
 /* Let me know if the last statement had rows that were affected.
  * This only gets called by a non-threaded connection, so there is no
  * need to worry about locks.
@@ -1466,7 +1494,8 @@ extern int create_cluster_tables(mysql_conn_t *mysql_conn, char *cluster_name)
 
 	/*
 	 * sacct_def is the index for query's with state as time_start is used
-	 * in these queries. sacct_def2 is for plain sacct queries.
+	 * in these queries. sacct_def2 is for plain sacct queries. submit is
+	 * for the pages of streamed sacct queries.
 	 */
 	if (mysql_db_create_table(mysql_conn, table_name, job_table_fields,
 				  ", primary key (job_db_inx), "
@@ -1482,6 +1511,7 @@ extern int create_cluster_tables(mysql_conn_t *mysql_conn, char *cluster_name)
 				  "key array_job (id_array_job), "
 				  "key het_job (het_job_id), "
 				  "key reserv (id_resv), "
+				  "key submit (time_submit), "
 				  "key sacct_def (id_user, time_start, "
 				  "time_end), "
 				  "key sacct_def2 (id_user, time_end, "
@@ -2624,6 +2654,16 @@ extern int init(void)
 	mysql_db_info = create_mysql_db_info(SLURM_MYSQL_PLUGIN_AS);
 	mysql_db_name = acct_get_db_name();
 
+	/* Fall back to the primary if the replica is unreachable */
+	if (slurmdbd_conf->storage_read_host) {
+		mysql_read_db_info =
+			create_mysql_db_info(SLURM_MYSQL_PLUGIN_AS);
+		xfree(mysql_read_db_info->backup);
+		mysql_read_db_info->backup = mysql_read_db_info->host;
+		mysql_read_db_info->host =
+			xstrdup(slurmdbd_conf->storage_read_host);
+	}
+
 	debug2("mysql_connect() called for db %s", mysql_db_name);
 	mysql_conn = create_mysql_conn(0, 1, NULL);
 	while (mysql_db_get_db_connection(
@@ -2664,8 +2704,10 @@ extern int fini ( void )
 	slurm_mutex_unlock(&as_mysql_cluster_list_lock);
 	slurm_mutex_destroy(&as_mysql_cluster_list_lock);
 	destroy_mysql_db_info(mysql_db_info);
+	destroy_mysql_db_info(mysql_read_db_info);
 	xfree(mysql_db_name);
 	xfree(default_qos_str);
+	as_mysql_usage_cache_clear(NULL);
 
 	mysql_db_cleanup();
 	return SLURM_SUCCESS;
@@ -2726,9 +2768,13 @@ extern void *acct_storage_p_get_connection(
 		fatal("couldn't get a mysql_conn");
 		return NULL;	/* Fix CLANG false positive error */
 	}
+	if (persist_conn_flags &&
+	    (*persist_conn_flags & PERSIST_FLAG_READ_ONLY))
+		mysql_conn->read_only = true;
 
 	errno = SLURM_SUCCESS;
-	mysql_db_get_db_connection(mysql_conn, mysql_db_name, mysql_db_info);
+	mysql_db_get_db_connection(mysql_conn, mysql_db_name,
+				   _get_db_info(mysql_conn));
 
 	if (mysql_conn->db_conn)
 		errno = SLURM_SUCCESS;
@@ -2753,6 +2799,7 @@ extern int acct_storage_p_close_connection(mysql_conn_t **mysql_conn)
 extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 {
 	int rc = check_connection(mysql_conn);
+	int commit_rc = SLURM_SUCCESS;
 
 	/* always reset this here */
 	if (mysql_conn)
@@ -2791,9 +2838,14 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 			if (rc != SLURM_SUCCESS) {
 				if (mysql_db_rollback(mysql_conn))
 					error("rollback failed");
-			} else {
-				if (mysql_db_commit(mysql_conn))
-					error("commit failed");
+			} else if (mysql_db_commit(mysql_conn)) {
+				/*
+				 * Deferred statements are sent at commit
+				 * time, let the caller know they didn't
+				 * make it so they can be resent.
+				 */
+				error("commit failed");
+				commit_rc = SLURM_ERROR;
 			}
 		}
 	}
@@ -2827,6 +2879,7 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 		mysql_free_result(result);
 	skip:
 		(void) assoc_mgr_update(mysql_conn->update_list, 0);
+		as_mysql_usage_cache_update(mysql_conn->update_list);
 
 		slurm_mutex_lock(&as_mysql_cluster_list_lock);
 		itr = list_iterator_create(mysql_conn->update_list);
@@ -2858,7 +2911,7 @@ extern int acct_storage_p_commit(mysql_conn_t *mysql_conn, bool commit)
 	xfree(mysql_conn->pre_commit_query);
 	list_flush(mysql_conn->update_list);
 
-	return SLURM_SUCCESS;
+	return commit_rc;
 }
 
 extern int acct_storage_p_add_users(mysql_conn_t *mysql_conn, uint32_t uid,
@@ -3185,7 +3238,8 @@ extern int acct_storage_p_get_usage(mysql_conn_t *mysql_conn, uid_t uid,
 				    void *in, slurmdbd_msg_type_t type,
 				    time_t start, time_t end)
 {
-	return as_mysql_get_usage(mysql_conn, uid, in, type, start, end);
+	return as_mysql_get_usage(mysql_conn, uid, in, type, start, end,
+				  SLURMDB_USAGE_PERIODS);
 }
 
 extern int acct_storage_p_roll_usage(mysql_conn_t *mysql_conn,
@@ -3375,6 +3429,20 @@ extern List jobacct_storage_p_get_jobs_cond(mysql_conn_t *mysql_conn,
 	return job_list;
 }
 
+/*
+ * get info from the storage a part at a time
+ */
+extern int jobacct_storage_p_get_jobs_cond_stream(
+	mysql_conn_t *mysql_conn, uid_t uid, slurmdb_job_cond_t *job_cond,
+	int (*part_cb)(List job_list, void *arg), void *arg)
+{
+	if (check_connection(mysql_conn) != SLURM_SUCCESS)
+		return ESLURM_DB_CONNECTION;
+
+	return as_mysql_jobacct_process_get_jobs_stream(mysql_conn, uid,
+							job_cond, part_cb, arg);
+}
+
 /*
  * expire old info from the storage
  */
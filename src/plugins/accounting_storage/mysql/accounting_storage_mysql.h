@@ -112,6 +112,13 @@ extern List as_mysql_cluster_list;
 extern List as_mysql_total_cluster_list;
 extern pthread_mutex_t as_mysql_cluster_list_lock;
 
+/*
+ * Return a copy of as_mysql_cluster_list, for work that runs queries for
+ * every cluster and shouldn't hold as_mysql_cluster_list_lock meanwhile.
+ * Free with FREE_NULL_LIST().
+ */
+extern List as_mysql_copy_cluster_list(void);
+
 extern bool backup_dbd;
 
 typedef enum {
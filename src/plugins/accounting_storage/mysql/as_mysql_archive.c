@@ -42,6 +42,8 @@
 #include <unistd.h>
 
 #include "as_mysql_archive.h"
+#include "as_mysql_usage.h"
+#include "src/common/archive_col.h"
 #include "src/common/env.h"
 #include "src/common/slurm_time.h"
 #include "src/common/slurmdbd_defs.h"
@@ -2753,60 +2755,311 @@ static int _process_old_sql(char **data)
 	return rc;
 }
 
+/*
+ * Get the columns archived for a type of record and the index of the time
+ * column the records are ordered by.
+ */
+static int _get_archive_cols(purge_type_t type, char ***cols,
+			     uint32_t *col_count, uint32_t *time_col)
+{
+	switch (type) {
+	case PURGE_EVENT:
+		*cols      = event_req_inx;
+		*col_count = EVENT_REQ_COUNT;
+		*time_col  = EVENT_REQ_START;
+		break;
+	case PURGE_SUSPEND:
+		*cols      = suspend_req_inx;
+		*col_count = SUSPEND_REQ_COUNT;
+		*time_col  = SUSPEND_REQ_START;
+		break;
+	case PURGE_RESV:
+		*cols      = resv_req_inx;
+		*col_count = RESV_REQ_COUNT;
+		*time_col  = RESV_REQ_START;
+		break;
+	case PURGE_JOB:
+		*cols      = job_req_inx;
+		*col_count = JOB_REQ_COUNT;
+		*time_col  = JOB_REQ_SUBMIT;
+		break;
+	case PURGE_STEP:
+		*cols      = step_req_inx;
+		*col_count = STEP_REQ_COUNT;
+		*time_col  = STEP_REQ_START;
+		break;
+	case PURGE_TXN:
+		*cols      = txn_req_inx;
+		*col_count = TXN_REQ_COUNT;
+		*time_col  = TXN_REQ_TS;
+		break;
+	case PURGE_USAGE:
+		*cols      = usage_req_inx;
+		*col_count = USAGE_COUNT;
+		*time_col  = USAGE_START;
+		break;
+	case PURGE_CLUSTER_USAGE:
+		*cols      = cluster_req_inx;
+		*col_count = CLUSTER_COUNT;
+		*time_col  = CLUSTER_START;
+		break;
+	default:
+		xassert(0);
+		return SLURM_ERROR;
+	}
+
+	return SLURM_SUCCESS;
+}
+
 static char *_get_archive_columns(purge_type_t type)
 {
 	char **cols = NULL;
 	char *tmp = NULL;
-	int col_count = 0, i = 0;
+	uint32_t col_count = 0, time_col = 0, i = 0;
 
-	xfree(cols);
+	if (_get_archive_cols(type, &cols, &col_count, &time_col) !=
+	    SLURM_SUCCESS)
+		return NULL;
+
+	xstrfmtcat(tmp, "%s", cols[0]);
+	for (i=1; i<col_count; i++) {
+		xstrfmtcat(tmp, ", %s", cols[i]);
+	}
+
+	return tmp;
+}
+
+/*
+ * Pack the result in the columnar format of src/common/archive_col.c, the
+ * record type and usage period are the same as in the row based archives.
+ */
+static Buf _pack_archive_columnar(purge_type_t type, MYSQL_RES *result,
+				  char *cluster_name, uint32_t usage_info,
+				  time_t *period_start)
+{
+	MYSQL_ROW row;
+	archive_col_writer_t *writer;
+	char **cols = NULL;
+	uint32_t col_count = 0, time_col = 0;
+	uint16_t msg_type, period = 0;
 
 	switch (type) {
 	case PURGE_EVENT:
-		cols      = event_req_inx;
-		col_count = EVENT_REQ_COUNT;
+		msg_type = DBD_GOT_EVENTS;
 		break;
 	case PURGE_SUSPEND:
-		cols      = suspend_req_inx;
-		col_count = SUSPEND_REQ_COUNT;
+		msg_type = DBD_JOB_SUSPEND;
 		break;
 	case PURGE_RESV:
-		cols      = resv_req_inx;
-		col_count = RESV_REQ_COUNT;
+		msg_type = DBD_GOT_RESVS;
 		break;
 	case PURGE_JOB:
-		cols      = job_req_inx;
-		col_count = JOB_REQ_COUNT;
+		msg_type = DBD_GOT_JOBS;
 		break;
 	case PURGE_STEP:
-		cols      = step_req_inx;
-		col_count = STEP_REQ_COUNT;
+		msg_type = DBD_STEP_START;
 		break;
 	case PURGE_TXN:
-		cols      = txn_req_inx;
-		col_count = TXN_REQ_COUNT;
+		msg_type = DBD_GOT_TXN;
 		break;
 	case PURGE_USAGE:
-		cols      = usage_req_inx;
-		col_count = USAGE_COUNT;
+		msg_type = usage_info & 0x0000ffff;
+		period = usage_info >> 16;
 		break;
 	case PURGE_CLUSTER_USAGE:
-		cols      = cluster_req_inx;
-		col_count = CLUSTER_COUNT;
+		msg_type = DBD_GOT_CLUSTER_USAGE;
+		period = usage_info >> 16;
 		break;
 	default:
 		xassert(0);
 		return NULL;
 	}
 
-	xstrfmtcat(tmp, "%s", cols[0]);
-	for (i=1; i<col_count; i++) {
-		xstrfmtcat(tmp, ", %s", cols[i]);
+	if (_get_archive_cols(type, &cols, &col_count, &time_col) !=
+	    SLURM_SUCCESS)
+		return NULL;
+
+	writer = archive_col_writer_create(msg_type, cluster_name, period,
+					   cols, col_count, time_col);
+	while ((row = mysql_fetch_row(result))) {
+		if (period_start && !*period_start)
+			*period_start = slurm_atoul(row[time_col]);
+		archive_col_add_row(writer, row);
 	}
 
-	return tmp;
+	return archive_col_writer_fini(writer);
 }
 
+/* Return the quoted name of the table records of "type" are loaded into */
+static char *_get_load_table(uint16_t type, uint16_t period,
+			     char *cluster_name)
+{
+	char *table = NULL;
+
+	switch (type) {
+	case DBD_GOT_EVENTS:
+		table = event_table;
+		break;
+	case DBD_GOT_JOBS:
+		table = job_table;
+		break;
+	case DBD_GOT_RESVS:
+		table = resv_table;
+		break;
+	case DBD_STEP_START:
+		table = step_table;
+		break;
+	case DBD_JOB_SUSPEND:
+		table = suspend_table;
+		break;
+	case DBD_GOT_TXN:
+		/* Not a cluster table */
+		return xstrdup_printf("\"%s\"", txn_table);
+	case DBD_GOT_ASSOC_USAGE:
+		if (period == DBD_ROLLUP_HOUR)
+			table = assoc_hour_table;
+		else if (period == DBD_ROLLUP_DAY)
+			table = assoc_day_table;
+		else if (period == DBD_ROLLUP_MONTH)
+			table = assoc_month_table;
+		break;
+	case DBD_GOT_WCKEY_USAGE:
+		if (period == DBD_ROLLUP_HOUR)
+			table = wckey_hour_table;
+		else if (period == DBD_ROLLUP_DAY)
+			table = wckey_day_table;
+		else if (period == DBD_ROLLUP_MONTH)
+			table = wckey_month_table;
+		break;
+	case DBD_GOT_CLUSTER_USAGE:
+		if (period == DBD_ROLLUP_HOUR)
+			table = cluster_hour_table;
+		else if (period == DBD_ROLLUP_DAY)
+			table = cluster_day_table;
+		else if (period == DBD_ROLLUP_MONTH)
+			table = cluster_month_table;
+		break;
+	default:
+		break;
+	}
+
+	if (!table) {
+		error("Unknown type '%u' period %u to load from archive",
+		      type, period);
+		return NULL;
+	}
+
+	return xstrdup_printf("\"%s_%s\"", cluster_name, table);
+}
+
+/*
+ * Load a columnar archive, only the records with a time in
+ * [time_start, time_end] (0 meaning no limit) are loaded.
+ * The insert statement is built from the column names in the file, every
+ * RECORDS_PER_PASS records it is sent to the database.
+ */
+static int _load_columnar(mysql_conn_t *mysql_conn, Buf buffer,
+			  time_t time_start, time_t time_end)
+{
+	archive_col_reader_t *reader;
+	archive_col_hdr_t *hdr;
+	char *table = NULL, *columns = NULL, *insert = NULL, *pos = NULL;
+	char **row, *tmp;
+	uint32_t i, rec_cnt = 0, pass_cnt = 0;
+	int rc = SLURM_SUCCESS;
+	DEF_TIMERS;
+
+	START_TIMER;
+	if (!(reader = archive_col_reader_create(buffer, time_start,
+						 time_end)))
+		return EFAULT;
+	hdr = archive_col_reader_hdr(reader);
+
+	DB_DEBUG(DB_ARCHIVE, mysql_conn->conn,
+		 "Version in columnar archive header is %u, %u records of type '%s' from %ld to %ld",
+		 hdr->protocol_version, hdr->rec_cnt,
+		 slurmdbd_msg_type_2_str(hdr->type, 0),
+		 (long) hdr->min_time, (long) hdr->max_time);
+
+	if (hdr->protocol_version > SLURM_PROTOCOL_VERSION) {
+		error("***********************************************");
+		error("Can not recover archive file, incompatible version, "
+		      "got %u need <= %u", hdr->protocol_version,
+		      SLURM_PROTOCOL_VERSION);
+		error("***********************************************");
+		archive_col_reader_destroy(reader);
+		return EFAULT;
+	}
+
+	if (!(table = _get_load_table(hdr->type, hdr->period,
+				      hdr->cluster_name))) {
+		archive_col_reader_destroy(reader);
+		return SLURM_ERROR;
+	}
+
+	xstrfmtcat(columns, "insert into %s (%s", table, hdr->col_names[0]);
+	for (i = 1; i < hdr->col_cnt; i++)
+		xstrfmtcat(columns, ", %s", hdr->col_names[i]);
+	xstrcat(columns, ") values ");
+
+	while ((rc = archive_col_next_row(reader, &row)) == SLURM_SUCCESS) {
+		if (row) {
+			if (!insert)
+				xstrfmtcatat(insert, &pos, "%s(", columns);
+			else
+				xstrfmtcatat(insert, &pos, ", (");
+			for (i = 0; i < hdr->col_cnt; i++) {
+				char *sep = i ? ", " : "";
+
+				if (!row[i]) {
+					xstrfmtcatat(insert, &pos, "%sNULL",
+						     sep);
+				} else if (strpbrk(row[i], "'\"\\")) {
+					tmp = slurm_add_slash_to_quotes(row[i]);
+					xstrfmtcatat(insert, &pos, "%s'%s'",
+						     sep, tmp);
+					xfree(tmp);
+				} else {
+					xstrfmtcatat(insert, &pos, "%s'%s'",
+						     sep, row[i]);
+				}
+			}
+			xstrfmtcatat(insert, &pos, ")");
+			if (++rec_cnt % RECORDS_PER_PASS)
+				continue;
+		}
+
+		if (insert) {
+			DB_DEBUG(DB_ARCHIVE, mysql_conn->conn,
+				 "%s: Pass %u: loaded %u records.",
+				 __func__, pass_cnt, rec_cnt);
+			if (slurm_conf.debug_flags & DEBUG_FLAG_DB_ARCHIVE)
+				DB_DEBUG(DB_QUERY, mysql_conn->conn,
+					 "query\n%s", insert);
+			rc = mysql_db_query_check_after(mysql_conn, insert);
+			xfree(insert);
+			pos = NULL;
+			pass_cnt++;
+			if (rc != SLURM_SUCCESS)
+				break;
+		}
+		if (!row)
+			break;
+	}
+	END_TIMER2("archive load");
+
+	if (rc == SLURM_SUCCESS)
+		DB_DEBUG(DB_ARCHIVE, mysql_conn->conn,
+			 "%s: loaded %u of %u records in %u passes %s",
+			 __func__, rec_cnt, hdr->rec_cnt, pass_cnt, TIME_STR);
+
+	xfree(insert);
+	xfree(columns);
+	xfree(table);
+	archive_col_reader_destroy(reader);
+
+	return rc;
+}
 
 static Buf _pack_archive_events(MYSQL_RES *result, char *cluster_name,
 				uint32_t cnt, uint32_t usage_info,
@@ -3933,8 +4186,12 @@ static uint32_t _archive_table(purge_type_t type, mysql_conn_t *mysql_conn,
 		return 0;
 	}
 
-	buffer = (*pack_func)(result, cluster_name, cnt, usage_info,
-			      &period_start);
+	if (slurmdbd_conf->archive_columnar)
+		buffer = _pack_archive_columnar(type, result, cluster_name,
+						usage_info, &period_start);
+	else
+		buffer = (*pack_func)(result, cluster_name, cnt, usage_info,
+				      &period_start);
 	mysql_free_result(result);
 
 	error_code = archive_write_file(buffer, cluster_name,
@@ -4359,13 +4616,7 @@ extern int as_mysql_jobacct_process_archive(mysql_conn_t *mysql_conn,
 		 * that.
 		 */
 		new_cluster_list = true;
-		use_cluster_list = list_create(xfree_ptr);
-		slurm_mutex_lock(&as_mysql_cluster_list_lock);
-		itr = list_iterator_create(as_mysql_cluster_list);
-		while ((cluster_name = list_next(itr)))
-			list_append(use_cluster_list, xstrdup(cluster_name));
-		list_iterator_destroy(itr);
-		slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+		use_cluster_list = as_mysql_copy_cluster_list();
 	}
 
 	itr = list_iterator_create(use_cluster_list);
@@ -4460,6 +4711,11 @@ extern int as_mysql_jobacct_process_archive_load(
 		|| !xstrncmp("delete from ", data, 12)
 		|| !xstrncmp("drop table ", data, 11)
 		|| !xstrncmp("truncate table ", data, 15))) {
+		if (arch_rec->time_start || arch_rec->time_end) {
+			error("A time range can only be used to load a columnar archive");
+			xfree(data);
+			return EINVAL;
+		}
 		_process_old_sql(&data);
 		goto got_sql;
 	}
@@ -4467,6 +4723,18 @@ extern int as_mysql_jobacct_process_archive_load(
 	buffer = create_buf(data, data_size);
 	data = NULL;	/* Moved to "buffer" */
 
+	if (archive_col_detect(buffer)) {
+		error_code = _load_columnar(mysql_conn, buffer,
+					    arch_rec->time_start,
+					    arch_rec->time_end);
+		goto cleanup;
+	}
+	if (arch_rec->time_start || arch_rec->time_end) {
+		error("A time range can only be used to load a columnar archive");
+		FREE_NULL_BUFFER(buffer);
+		return EINVAL;
+	}
+
 	safe_unpack16(&ver, buffer);
 	DB_DEBUG(DB_ARCHIVE, mysql_conn->conn,
 	         "Version in archive header is %u", ver);
@@ -4566,6 +4834,9 @@ unpack_error:
 	}
 
 cleanup:
+	/* Loaded usage makes cached sums stale, NULL clears all clusters */
+	if (error_code == SLURM_SUCCESS)
+		as_mysql_usage_cache_clear(cluster_name);
 	xfree(cluster_name);
 	FREE_NULL_BUFFER(buffer);
 
@@ -2368,7 +2368,7 @@ static int _cluster_get_assocs(mysql_conn_t *mysql_conn,
 		get_usage_for_list(mysql_conn, DBD_GET_ASSOC_USAGE,
 				   assoc_list, cluster_name,
 				   assoc_cond->usage_start,
-				   assoc_cond->usage_end);
+				   assoc_cond->usage_end, with_usage);
 
 	list_transfer(sent_list, assoc_list);
 	FREE_NULL_LIST(assoc_list);
@@ -3385,7 +3385,8 @@ extern List as_mysql_get_assocs(mysql_conn_t *mysql_conn, uid_t uid,
 	int i=0, is_admin=1;
 	slurmdb_user_rec_t user;
 	char *prefix = "t1";
-	List use_cluster_list = as_mysql_cluster_list;
+	List use_cluster_list = NULL;
+	bool new_cluster_list = false;
 	char *cluster_name = NULL;
 
 	if (!assoc_cond) {
@@ -3432,8 +3433,10 @@ empty:
 	}
 	assoc_list = list_create(slurmdb_destroy_assoc_rec);
 
-	if (use_cluster_list == as_mysql_cluster_list)
-		slurm_mutex_lock(&as_mysql_cluster_list_lock);
+	if (!use_cluster_list) {
+		use_cluster_list = as_mysql_copy_cluster_list();
+		new_cluster_list = true;
+	}
 	itr = list_iterator_create(use_cluster_list);
 	while ((cluster_name = list_next(itr))) {
 		int rc;
@@ -3447,8 +3450,8 @@ empty:
 		}
 	}
 	list_iterator_destroy(itr);
-	if (use_cluster_list == as_mysql_cluster_list)
-		slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+	if (new_cluster_list)
+		FREE_NULL_LIST(use_cluster_list);
 	xfree(tmp);
 	xfree(extra);
 
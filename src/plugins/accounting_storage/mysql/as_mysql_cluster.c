@@ -855,6 +855,7 @@ extern List as_mysql_remove_clusters(mysql_conn_t *mysql_conn, uint32_t uid,
 			if ((rc = remove_cluster_tables(mysql_conn, object))
 			    != SLURM_SUCCESS)
 				break;
+			as_mysql_usage_cache_clear(object);
 			cluster_name = xstrdup(object);
 			if (addto_update_list(mysql_conn->update_list,
 					      SLURMDB_REMOVE_CLUSTER,
@@ -1028,7 +1029,8 @@ empty:
 				mysql_conn, uid, cluster,
 				DBD_GET_CLUSTER_USAGE,
 				cluster_cond->usage_start,
-				cluster_cond->usage_end);
+				cluster_cond->usage_end,
+				cluster_cond->with_usage);
 		}
 
 	}
@@ -1105,6 +1105,28 @@ extern int as_mysql_job_complete(mysql_conn_t *mysql_conn,
 	return rc;
 }
 
+/* Step starts are sent as "insert ... values (...), (...) step_start_dup" */
+static char *step_start_dup =
+	"on duplicate key update "
+	"nodes_alloc=VALUES(nodes_alloc), task_cnt=VALUES(task_cnt), "
+	"time_end=0, state=VALUES(state), "
+	"nodelist=VALUES(nodelist), node_inx=VALUES(node_inx), "
+	"task_dist=VALUES(task_dist), req_cpufreq=VALUES(req_cpufreq), "
+	"req_cpufreq_min=VALUES(req_cpufreq_min), "
+	"req_cpufreq_gov=VALUES(req_cpufreq_gov), "
+	"tres_alloc=VALUES(tres_alloc)";
+
+/*
+ * Deferred statements only run at commit. slurmdbd commits each message, or
+ * each DBD_SEND_MULT_MSG, before it replies and checks the commit, but with
+ * CommitDelay it acks messages long before the commit.
+ */
+static bool _defer_step_query(mysql_conn_t *mysql_conn)
+{
+	return (mysql_conn->rollback && slurmdbd_conf &&
+		!slurmdbd_conf->commit_delay);
+}
+
 extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 			       step_record_t *step_ptr)
 {
@@ -1114,7 +1136,7 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 	char *node_list = NULL;
 	char *node_inx = NULL;
 	time_t start_time, submit_time;
-	char *query = NULL;
+	char *query = NULL, *values = NULL;
 
 	if (!step_ptr->job_ptr->db_index
 	    && ((!step_ptr->job_ptr->details
@@ -1220,15 +1242,11 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 		"insert into \"%s_%s\" (job_db_inx, id_step, step_het_comp, "
 		"time_start, step_name, state, tres_alloc, "
 		"nodes_alloc, task_cnt, nodelist, node_inx, "
-		"task_dist, req_cpufreq, req_cpufreq_min, req_cpufreq_gov) "
-		"values (%"PRIu64", %d, %u, %d, '%s', %d, '%s', %d, %d, "
-		"'%s', '%s', %d, %u, %u, %u) "
-		"on duplicate key update "
-		"nodes_alloc=%d, task_cnt=%d, time_end=0, state=%d, "
-		"nodelist='%s', node_inx='%s', task_dist=%d, "
-		"req_cpufreq=%u, req_cpufreq_min=%u, req_cpufreq_gov=%u,"
-		"tres_alloc='%s';",
-		mysql_conn->cluster_name, step_table,
+		"task_dist, req_cpufreq, req_cpufreq_min, req_cpufreq_gov)",
+		mysql_conn->cluster_name, step_table);
+	values = xstrdup_printf(
+		"(%"PRIu64", %d, %u, %d, '%s', %d, '%s', %d, %d, "
+		"'%s', '%s', %d, %u, %u, %u)",
 		step_ptr->job_ptr->db_index,
 		step_ptr->step_id.step_id,
 		step_ptr->step_id.step_het_comp,
@@ -1236,13 +1254,23 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 		JOB_RUNNING, step_ptr->tres_alloc_str,
 		nodes, tasks, node_list, node_inx, task_dist,
 		step_ptr->cpu_freq_max, step_ptr->cpu_freq_min,
-		step_ptr->cpu_freq_gov, nodes, tasks, JOB_RUNNING,
-		node_list, node_inx, task_dist, step_ptr->cpu_freq_max,
-		step_ptr->cpu_freq_min, step_ptr->cpu_freq_gov,
-		step_ptr->tres_alloc_str);
-	DB_DEBUG(DB_STEP, mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
+		step_ptr->cpu_freq_gov);
+	DB_DEBUG(DB_STEP, mysql_conn->conn, "query\n%s values %s %s",
+		 query, values, step_start_dup);
+
+	/*
+	 * Steps of a DBD_SEND_MULT_MSG all go in as one multi-row insert
+	 * with the commit at the end of it.
+	 */
+	if (_defer_step_query(mysql_conn))
+		rc = mysql_db_defer_insert(mysql_conn, query, values,
+					   step_start_dup);
+	else {
+		xstrfmtcat(query, " values %s %s", values, step_start_dup);
+		rc = mysql_db_query(mysql_conn, query);
+	}
 	xfree(query);
+	xfree(values);
 
 	return rc;
 }
@@ -1489,22 +1517,23 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 		   " where job_db_inx=%"PRIu64" and id_step=%d and step_het_comp=%u",
 		   step_ptr->job_ptr->db_index, step_ptr->step_id.step_id,
 		   step_ptr->step_id.step_het_comp);
-	DB_DEBUG(DB_STEP, mysql_conn->conn, "query\n%s", query);
-	rc = mysql_db_query(mysql_conn, query);
-	xfree(query);
 
 	/* set the energy for the entire job. */
-	if (step_ptr->job_ptr->tres_alloc_str) {
-		query = xstrdup_printf(
-			"update \"%s_%s\" set tres_alloc='%s' where "
-			"job_db_inx=%"PRIu64,
-			mysql_conn->cluster_name, job_table,
-			step_ptr->job_ptr->tres_alloc_str,
-			step_ptr->job_ptr->db_index);
-		DB_DEBUG(DB_STEP, mysql_conn->conn, "query\n%s", query);
-		rc = mysql_db_query(mysql_conn, query);
-		xfree(query);
-	}
+	if (step_ptr->job_ptr->tres_alloc_str)
+		xstrfmtcat(query,
+			   "; update \"%s_%s\" set tres_alloc='%s' where "
+			   "job_db_inx=%"PRIu64,
+			   mysql_conn->cluster_name, job_table,
+			   step_ptr->job_ptr->tres_alloc_str,
+			   step_ptr->job_ptr->db_index);
+	DB_DEBUG(DB_STEP, mysql_conn->conn, "query\n%s", query);
+
+	/* Sent along with the rest of a DBD_SEND_MULT_MSG, see step_start */
+	if (_defer_step_query(mysql_conn))
+		rc = mysql_db_defer_query(mysql_conn, query);
+	else
+		rc = mysql_db_query_check_after(mysql_conn, query);
+	xfree(query);
 
 	return rc;
 }
@@ -43,6 +43,24 @@
 
 #include "as_mysql_jobacct_process.h"
 
+/* job rows read at a time when streaming jobs to slurmdbd */
+#define JOB_PAGE_ROWS 10000
+
+/* a job id submitted more than once, with its last submit time */
+typedef struct {
+	uint32_t id_job;
+	time_t time_submit;
+} later_job_t;
+
+/* bsearch() comparator of a job id with a later_job_t */
+static int _cmp_later_job(const void *key, const void *x)
+{
+	uint32_t id1 = *(uint32_t *) key;
+	uint32_t id2 = ((later_job_t *) x)->id_job;
+
+	return (id1 > id2) - (id1 < id2);
+}
+
 typedef struct {
 	hostlist_t hl;
 	time_t start;
@@ -458,9 +476,13 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 			     char *cluster_name,
 			     char *job_fields, char *step_fields,
 			     char *sent_extra,
-			     bool is_admin, int only_pending, List sent_list)
+			     bool is_admin, int only_pending, List sent_list,
+			     assoc_mgr_lock_t *locks,
+			     int (*part_cb)(List job_list, void *arg),
+			     void *part_arg)
 {
-	char *query = NULL;
+	char *query = NULL, *from_query = NULL, *job_query = NULL;
+	char *page_query = NULL, *where;
 	char *extra = xstrdup(sent_extra);
 	slurm_selected_step_t *selected_step = NULL;
 	MYSQL_RES *result = NULL, *step_result = NULL;
@@ -475,6 +497,10 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	char *prefix="t2";
 	int rc = SLURM_SUCCESS;
 	int last_id = -1, curr_id = -1;
+	later_job_t *later_jobs = NULL, *later;
+	uint32_t later_cnt = 0;
+	time_t page_start = 0, page_end = 0;
+	bool last_page = true;
 	local_cluster_t *curr_cluster = NULL;
 
 	/* This is here to make sure we are looking at only this user
@@ -543,7 +569,7 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	setup_job_cluster_cond_limits(mysql_conn, job_cond,
 				      cluster_name, &extra);
 
-	query = xstrdup_printf("select %s from \"%s_%s\" as t1 "
+	query = xstrdup_printf(" from \"%s_%s\" as t1 "
 			       "left join \"%s_%s\" as t2 "
 			       "on t1.id_assoc=t2.id_assoc "
 			       "left join \"%s_%s\" as t3 "
@@ -557,7 +583,7 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 			       "(t3.time_end >= t1.time_submit || "
 			       "t3.time_end = 0)) || "
 			       "(t3.time_start > t1.time_submit))))",
-			       job_fields, cluster_name, job_table,
+			       cluster_name, job_table,
 			       cluster_name, assoc_table,
 			       cluster_name, resv_table);
 
@@ -571,22 +597,13 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	if (extra) {
 		xstrcat(query, extra);
 		xfree(extra);
-	}
-
-	/* Here we want to order them this way in such a way so it is
-	   easy to look for duplicates, it is also easy to sort the
-	   resized jobs.
-	*/
-	xstrcat(query, " order by id_job, time_submit desc");
-
-	DB_DEBUG(DB_JOB, mysql_conn->conn, "query\n%s", query);
-	if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
-		xfree(query);
-		rc = SLURM_ERROR;
-		goto end_it;
-	}
-	xfree(query);
-
+		where = " &&";
+	} else
+		where = " where";
+	/* query is reused for the step queries below */
+	from_query = query;
+	query = NULL;
+	job_query = xstrdup_printf("select %s%s", job_fields, from_query);
 
 	/* Here we set up environment to check used nodes of jobs.
 	   Since we store the bitmap of the entire cluster we can use
@@ -598,12 +615,101 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 		local_cluster_list = setup_cluster_list_with_inx(
 			mysql_conn, job_cond, (void **)&curr_cluster);
 		if (!local_cluster_list) {
-			mysql_free_result(result);
 			rc = SLURM_ERROR;
 			goto end_it;
 		}
 	}
 
+	/*
+	 * When streaming, only one page of about JOB_PAGE_ROWS rows is read
+	 * at a time and handed to part_cb. The step and suspend queries run
+	 * on this connection for every job, so the rows can't be left on
+	 * the server with mysql_use_result() while we go through them.
+	 *
+	 * Pages are consecutive ranges of submit time, so handing them out
+	 * one after the other keeps the jobs in the submit time order sacct
+	 * sorts them in, array tasks included. A second with more jobs than
+	 * JOB_PAGE_ROWS makes one larger page.
+	 *
+	 * A job id submitted again later is only shown with its last
+	 * submission. The ids submitted more than once are looked up once
+	 * for the whole query, a page skips those submitted again after it.
+	 */
+	if (part_cb && !(job_cond->flags & JOBCOND_FLAG_DUP)) {
+		query = xstrdup_printf("select t1.id_job, max(t1.time_submit)%s "
+				       "group by t1.id_job having count(*)>1 "
+				       "order by t1.id_job", from_query);
+		DB_DEBUG(DB_JOB, mysql_conn->conn, "query\n%s", query);
+		if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
+			xfree(query);
+			rc = SLURM_ERROR;
+			goto end_it;
+		}
+		xfree(query);
+		if (mysql_num_rows(result))
+			later_jobs = xcalloc(mysql_num_rows(result),
+					     sizeof(later_job_t));
+		while ((row = mysql_fetch_row(result))) {
+			later_jobs[later_cnt].id_job = slurm_atoul(row[0]);
+			later_jobs[later_cnt++].time_submit =
+				slurm_atoull(row[1]);
+		}
+		mysql_free_result(result);
+	}
+
+next_page:
+	xfree(page_query);
+	last_id = -1;
+	last_page = true;
+	if (part_cb) {
+		/*
+		 * The page ends before the submit time of its last row, found
+		 * on the submit index from where the page starts.
+		 */
+		query = xstrdup_printf("select count(*), max(time_submit) "
+				       "from (select t1.time_submit%s%s "
+				       "t1.time_submit>=%ld "
+				       "order by t1.time_submit limit %d) "
+				       "as page",
+				       from_query, where, (long) page_start,
+				       JOB_PAGE_ROWS);
+		DB_DEBUG(DB_JOB, mysql_conn->conn, "query\n%s", query);
+		if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
+			xfree(query);
+			rc = SLURM_ERROR;
+			goto end_it;
+		}
+		xfree(query);
+		if ((row = mysql_fetch_row(result)) &&
+		    (slurm_atoul(row[0]) >= JOB_PAGE_ROWS)) {
+			page_end = slurm_atoull(row[1]);
+			if (page_end == page_start)
+				page_end++;
+			last_page = false;
+		}
+		mysql_free_result(result);
+
+		page_query = xstrdup_printf("%s%s t1.time_submit>=%ld",
+					    job_query, where,
+					    (long) page_start);
+		if (!last_page)
+			xstrfmtcat(page_query, " && t1.time_submit<%ld",
+				   (long) page_end);
+	} else
+		page_query = xstrdup(job_query);
+
+	/* Here we want to order them this way in such a way so it is
+	   easy to look for duplicates, it is also easy to sort the
+	   resized jobs.
+	*/
+	xstrcat(page_query, " order by id_job, time_submit desc");
+
+	DB_DEBUG(DB_JOB, mysql_conn->conn, "query\n%s", page_query);
+	if (!(result = mysql_db_query_ret(mysql_conn, page_query, 0))) {
+		rc = SLURM_ERROR;
+		goto end_it;
+	}
+
 	while ((row = mysql_fetch_row(result))) {
 		char *db_inx_char = row[JOB_REQ_DB_INX];
 		bool job_ended = 0;
@@ -616,6 +722,15 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 		    && (slurm_atoul(row[JOB_REQ_STATE]) != JOB_RESIZING))
 			continue;
 
+		if (!last_page && later_cnt && (curr_id != last_id)
+		    && (slurm_atoul(row[JOB_REQ_STATE]) != JOB_RESIZING)
+		    && (later = bsearch(&curr_id, later_jobs, later_cnt,
+					sizeof(later_job_t), _cmp_later_job))
+		    && (later->time_submit >= page_end)) {
+			last_id = curr_id;
+			continue;
+		}
+
 		/* check the bitmap to see if this is one of the jobs
 		   we are looking for */
 		/* Use start time instead of submit time because node
@@ -1102,13 +1217,35 @@ static int _cluster_get_jobs(mysql_conn_t *mysql_conn,
 	}
 	mysql_free_result(result);
 
+	if (!job_list) {
+		rc = SLURM_ERROR;
+	} else if (part_cb) {
+		/*
+		 * The records of the page only hold copies of what they need,
+		 * don't keep the assoc_mgr locked while part_cb sends them.
+		 */
+		assoc_mgr_unlock(locks);
+		if (list_count(job_list))
+			rc = (*part_cb)(job_list, part_arg);
+		list_flush(job_list);
+		assoc_mgr_lock(locks);
+		if ((rc == SLURM_SUCCESS) && !last_page) {
+			page_start = page_end;
+			goto next_page;
+		}
+	}
+
 end_it:
 	if (itr2)
 		list_iterator_destroy(itr2);
 
 	FREE_NULL_LIST(local_cluster_list);
+	xfree(from_query);
+	xfree(job_query);
+	xfree(page_query);
+	xfree(later_jobs);
 
-	if (rc == SLURM_SUCCESS)
+	if ((rc == SLURM_SUCCESS) && sent_list && job_list)
 		list_transfer(sent_list, job_list);
 
 	FREE_NULL_LIST(job_list);
@@ -1669,19 +1806,19 @@ extern int setup_job_cond_limits(slurmdb_job_cond_t *job_cond,
 	return set;
 }
 
-extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
-					      uid_t uid,
-					      slurmdb_job_cond_t *job_cond)
+static int _get_jobs(mysql_conn_t *mysql_conn, uid_t uid,
+		     slurmdb_job_cond_t *job_cond, List job_list,
+		     int (*part_cb)(List job_list, void *arg), void *part_arg)
 {
 	char *extra = NULL;
 	char *tmp = NULL, *tmp2 = NULL;
 	ListIterator itr = NULL;
 	int is_admin=1;
-	int i;
-	List job_list = NULL;
+	int i, rc = SLURM_SUCCESS;
 	slurmdb_user_rec_t user;
 	int only_pending = 0;
-	List use_cluster_list = as_mysql_cluster_list;
+	List use_cluster_list = NULL;
+	bool new_cluster_list = false;
 	char *cluster_name;
 	assoc_mgr_lock_t locks = { NO_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
 				   READ_LOCK, NO_LOCK, NO_LOCK };
@@ -1701,7 +1838,7 @@ extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 		if (!is_admin && !user.name) {
 			debug("User %u has no associations, and is not admin, "
 			      "so not returning any jobs.", user.uid);
-			return NULL;
+			return SLURM_SUCCESS;
 		}
 	}
 
@@ -1727,33 +1864,67 @@ extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
 	if (job_cond
 	    && job_cond->cluster_list && list_count(job_cond->cluster_list))
 		use_cluster_list = job_cond->cluster_list;
-	else
-		slurm_mutex_lock(&as_mysql_cluster_list_lock);
+	else {
+		/*
+		 * Big queries take a while, work off a copy so
+		 * as_mysql_cluster_list_lock isn't held meanwhile.
+		 */
+		use_cluster_list = as_mysql_copy_cluster_list();
+		new_cluster_list = true;
+	}
 
 	assoc_mgr_lock(&locks);
 
-	job_list = list_create(slurmdb_destroy_job_rec);
 	itr = list_iterator_create(use_cluster_list);
 	while ((cluster_name = list_next(itr))) {
-		int rc;
 		_setup_job_cond_selected_steps(job_cond, cluster_name, &extra);
 		if ((rc = _cluster_get_jobs(mysql_conn, &user, job_cond,
 					    cluster_name, tmp, tmp2, extra,
-					    is_admin, only_pending, job_list))
-		    != SLURM_SUCCESS)
+					    is_admin, only_pending, job_list,
+					    &locks, part_cb, part_arg))
+		    != SLURM_SUCCESS) {
 			error("Problem getting jobs for cluster %s",
 			      cluster_name);
+			/* The parts sent so far can't be taken back */
+			if (part_cb)
+				break;
+			rc = SLURM_SUCCESS;
+		}
 	}
 	list_iterator_destroy(itr);
 
 	assoc_mgr_unlock(&locks);
 
-	if (use_cluster_list == as_mysql_cluster_list)
-		slurm_mutex_unlock(&as_mysql_cluster_list_lock);
+	if (new_cluster_list)
+		FREE_NULL_LIST(use_cluster_list);
 
 	xfree(tmp);
 	xfree(tmp2);
 	xfree(extra);
 
+	return rc;
+}
+
+extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn,
+					      uid_t uid,
+					      slurmdb_job_cond_t *job_cond)
+{
+	List job_list = list_create(slurmdb_destroy_job_rec);
+
+	(void) _get_jobs(mysql_conn, uid, job_cond, job_list, NULL, NULL);
+
 	return job_list;
 }
+
+/*
+ * Hand the jobs to part_cb a page at a time instead of returning them all
+ * in one list, so memory use does not grow with the number of jobs.
+ */
+extern int as_mysql_jobacct_process_get_jobs_stream(
+	mysql_conn_t *mysql_conn, uid_t uid, slurmdb_job_cond_t *job_cond,
+	int (*part_cb)(List job_list, void *arg), void *part_arg)
+{
+	xassert(part_cb);
+
+	return _get_jobs(mysql_conn, uid, job_cond, NULL, part_cb, part_arg);
+}
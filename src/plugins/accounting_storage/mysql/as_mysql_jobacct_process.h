@@ -59,5 +59,8 @@ extern int setup_job_cond_limits(slurmdb_job_cond_t *job_cond,
 
 extern List as_mysql_jobacct_process_get_jobs(mysql_conn_t *mysql_conn, uid_t uid,
 					   slurmdb_job_cond_t *job_cond);
+extern int as_mysql_jobacct_process_get_jobs_stream(
+	mysql_conn_t *mysql_conn, uid_t uid, slurmdb_job_cond_t *job_cond,
+	int (*part_cb)(List job_list, void *arg), void *part_arg);
 
 #endif
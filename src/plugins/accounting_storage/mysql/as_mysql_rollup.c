@@ -67,15 +67,28 @@ typedef struct {
 	uint64_t total_time;
 } local_tres_usage_t;
 
+/*
+ * TRES usage kept in a flat array instead of a List.  Static TRES live at
+ * their own id and dynamic TRES (ids above TRES_OFFSET) are packed in
+ * right after them, so finding the usage of a TRES is an index instead of
+ * a list_find_first() for every job and TRES.  Slots not in use have an
+ * id of 0.  An id that doesn't fit either range is probed forward to the
+ * next free slot.
+ */
+typedef struct {
+	uint32_t size;
+	local_tres_usage_t *tres;
+} local_tres_array_t;
+
 typedef struct {
 	int id;
-	List loc_tres;
+	local_tres_array_t loc_tres;
 } local_id_usage_t;
 
 typedef struct {
 	time_t end;
 	int id; /*only needed for reservations */
-	List loc_tres;
+	local_tres_array_t loc_tres;
 	time_t start;
 } local_cluster_usage_t;
 
@@ -86,25 +99,106 @@ typedef struct {
 	hostlist_t hl;
 	List local_assocs; /* list of assocs to spread unused time
 			      over of type local_id_usage_t */
-	List loc_tres;
+	local_tres_array_t loc_tres;
 	time_t orig_start;
 	time_t start;
 	double unused_wall;
 } local_resv_usage_t;
 
-static void _destroy_local_tres_usage(void *object)
+/* Don't write the unused_wall of the reservations, see _roll_resv_wall() */
+#define ROLLUP_FLAG_NO_RESV_WALL 0x0001
+
+typedef struct {
+	int dims;
+	uint16_t flags;
+	uint64_t phase_time[DBD_ROLLUP_PHASE_COUNT];
+} local_rollup_hour_t;
+
+typedef struct {
+	char *cluster_name;
+	int committed;	/* hours rolled up and committed */
+	int dims;
+	time_t end;
+	time_t next_start;
+	mysql_conn_t *parent_conn;
+	uint64_t phase_time[DBD_ROLLUP_PHASE_COUNT];
+	int rc;
+	pthread_mutex_t lock;
+} local_rollup_parallel_t;
+
+static uint32_t _loc_tres_slot(uint32_t id)
+{
+	if (id > TRES_OFFSET)
+		return TRES_STATIC_CNT + (id - TRES_OFFSET - 1);
+	return MIN(id, TRES_STATIC_CNT);
+}
+
+static void _free_loc_tres(local_tres_array_t *loc_tres)
 {
-	local_tres_usage_t *a_usage = (local_tres_usage_t *)object;
-	if (a_usage) {
-		xfree(a_usage);
+	xfree(loc_tres->tres);
+	loc_tres->size = 0;
+}
+
+static local_tres_usage_t *_find_loc_tres(local_tres_array_t *loc_tres,
+					  uint32_t id)
+{
+	uint32_t slot;
+
+	for (slot = _loc_tres_slot(id); slot < loc_tres->size; slot++) {
+		if (loc_tres->tres[slot].id == id)
+			return &loc_tres->tres[slot];
+		if (!loc_tres->tres[slot].id)
+			break;
 	}
+
+	return NULL;
+}
+
+static local_tres_usage_t *_make_loc_tres(local_tres_array_t *loc_tres,
+					  uint32_t id)
+{
+	uint32_t slot = _loc_tres_slot(id);
+
+	while ((slot < loc_tres->size) && loc_tres->tres[slot].id &&
+	       (loc_tres->tres[slot].id != id))
+		slot++;
+
+	if (slot >= loc_tres->size) {
+		uint32_t size = MAX(slot + 1, TRES_STATIC_CNT + 8);
+
+		xrecalloc(loc_tres->tres, size, sizeof(local_tres_usage_t));
+		loc_tres->size = size;
+	}
+
+	loc_tres->tres[slot].id = id;
+	return &loc_tres->tres[slot];
+}
+
+/* Return the next TRES in use at or after *inx, NULL at the end */
+static local_tres_usage_t *_next_loc_tres(local_tres_array_t *loc_tres,
+					  uint32_t *inx)
+{
+	while (*inx < loc_tres->size) {
+		local_tres_usage_t *tres = &loc_tres->tres[(*inx)++];
+		if (tres->id)
+			return tres;
+	}
+
+	return NULL;
+}
+
+static bool _loc_tres_empty(local_tres_array_t *loc_tres)
+{
+	uint32_t inx = 0;
+
+	return !_next_loc_tres(loc_tres, &inx);
 }
 
 static void _destroy_local_id_usage(void *object)
 {
 	local_id_usage_t *a_usage = (local_id_usage_t *)object;
 	if (a_usage) {
-		FREE_NULL_LIST(a_usage->loc_tres);
+		_free_loc_tres(&a_usage->loc_tres);
 		xfree(a_usage);
 	}
 }
@@ -113,7 +207,7 @@ static void _destroy_local_cluster_usage(void *object)
 {
 	local_cluster_usage_t *c_usage = (local_cluster_usage_t *)object;
 	if (c_usage) {
-		FREE_NULL_LIST(c_usage->loc_tres);
+		_free_loc_tres(&c_usage->loc_tres);
 		xfree(c_usage);
 	}
 }
@@ -124,21 +218,11 @@ static void _destroy_local_resv_usage(void *object)
 	if (r_usage) {
 		FREE_NULL_HOSTLIST(r_usage->hl);
 		FREE_NULL_LIST(r_usage->local_assocs);
-		FREE_NULL_LIST(r_usage->loc_tres);
+		_free_loc_tres(&r_usage->loc_tres);
 		xfree(r_usage);
 	}
 }
 
-static int _find_loc_tres(void *x, void *key)
-{
-	local_tres_usage_t *loc_tres = (local_tres_usage_t *)x;
-	uint32_t tres_id = *(uint32_t *)key;
-
-	if (loc_tres->id == tres_id)
-		return 1;
-	return 0;
-}
-
 static int _find_id_usage(void *x, void *key)
 {
 	local_id_usage_t *loc = (local_id_usage_t *)x;
@@ -149,21 +233,19 @@ static int _find_id_usage(void *x, void *key)
 	return 0;
 }
 
-static void _remove_job_tres_time_from_cluster(List c_tres, List j_tres,
+static void _remove_job_tres_time_from_cluster(local_tres_array_t *c_tres,
+					       local_tres_array_t *j_tres,
 					       int seconds)
 {
-	ListIterator c_itr;
 	local_tres_usage_t *loc_c_tres, *loc_j_tres;
 	uint64_t time;
+	uint32_t inx = 0;
 
-	if ((seconds <= 0) || !c_tres || !j_tres ||
-	    !list_count(c_tres) || !list_count(j_tres))
+	if ((seconds <= 0) || !c_tres->size || !j_tres->size)
 		return;
 
-	c_itr = list_iterator_create(c_tres);
-	while ((loc_c_tres = list_next(c_itr))) {
-		if (!(loc_j_tres = list_find_first(
-			      j_tres, _find_loc_tres, &loc_c_tres->id)))
+	while ((loc_c_tres = _next_loc_tres(c_tres, &inx))) {
+		if (!(loc_j_tres = _find_loc_tres(j_tres, loc_c_tres->id)))
 			continue;
 		time = seconds * loc_j_tres->count;
 
@@ -172,11 +254,11 @@ static void _remove_job_tres_time_from_cluster(List c_tres, List j_tres,
 		else
 			loc_c_tres->total_time -= time;
 	}
-	list_iterator_destroy(c_itr);
 }
 
 
-static local_tres_usage_t *_add_time_tres(List tres_list, int type, uint32_t id,
+static local_tres_usage_t *_add_time_tres(local_tres_array_t *tres_array,
+					  int type, uint32_t id,
 					  uint64_t time, bool times_count)
 {
 	local_tres_usage_t *loc_tres;
@@ -187,21 +269,13 @@ static local_tres_usage_t *_add_time_tres(List tres_list, int type, uint32_t id,
 	if (!time || (time == NO_VAL64))
 		return NULL;
 
-	loc_tres = list_find_first(tres_list, _find_loc_tres, &id);
-
-	if (!loc_tres) {
-		if (times_count)
-			return NULL;
-		loc_tres = xmalloc(sizeof(local_tres_usage_t));
-		loc_tres->id = id;
-		list_append(tres_list, loc_tres);
-	}
-
 	if (times_count) {
-		if (!loc_tres->count)
+		if (!(loc_tres = _find_loc_tres(tres_array, id)) ||
+		    !loc_tres->count)
 			return NULL;
 		time *= loc_tres->count;
-	}
+	} else
+		loc_tres = _make_loc_tres(tres_array, id);
 
 	switch (type) {
 	case TIME_ALLOC:
@@ -225,54 +299,46 @@ static local_tres_usage_t *_add_time_tres(List tres_list, int type, uint32_t id,
 	return loc_tres;
 }
 
-static void _add_time_tres_list(List tres_list_out, List tres_list_in, int type,
+static void _add_time_tres_list(local_tres_array_t *tres_array_out,
+				local_tres_array_t *tres_array_in, int type,
 				uint64_t time_in, bool times_count)
 {
-	ListIterator itr;
 	local_tres_usage_t *loc_tres;
+	uint32_t inx = 0;
 
-	xassert(tres_list_in);
-	xassert(tres_list_out);
+	xassert(tres_array_in);
+	xassert(tres_array_out);
 
-	itr = list_iterator_create(tres_list_in);
-	while ((loc_tres = list_next(itr)))
-		_add_time_tres(tres_list_out, type,
+	while ((loc_tres = _next_loc_tres(tres_array_in, &inx)))
+		_add_time_tres(tres_array_out, type,
 			       loc_tres->id,
 			       time_in ? time_in : loc_tres->total_time,
 			       times_count);
-	list_iterator_destroy(itr);
 }
 
 /*
  * Job usage is a ratio of its tres to the reservation's tres:
  * Unused wall = unused wall - job_seconds * job_tres / resv_tres
  */
-static int _update_unused_wall(local_resv_usage_t *r_usage, List job_tres,
+static int _update_unused_wall(local_resv_usage_t *r_usage,
+			       local_tres_array_t *job_tres,
 			       int job_seconds)
 {
-	ListIterator resv_itr;
-	local_tres_usage_t *loc_tres;
-	uint32_t resv_tres_id;
-	uint64_t resv_tres_count;
+	local_tres_usage_t *loc_tres, *job_loc_tres;
+	uint32_t inx = 0;
 	double tres_ratio = 0.0;
 
 	/* Get TRES counts. Make sure the TRES types match. */
-	resv_itr = list_iterator_create(r_usage->loc_tres);
-	while ((loc_tres = list_next(resv_itr))) {
+	while ((loc_tres = _next_loc_tres(&r_usage->loc_tres, &inx))) {
 		/* Avoid dividing by zero. */
 		if (!loc_tres->count)
 			continue;
-		resv_tres_id = loc_tres->id;
-		resv_tres_count = loc_tres->count;
-		if ((loc_tres = list_find_first(job_tres,
-						_find_loc_tres,
-						&resv_tres_id))) {
-			tres_ratio = (double)loc_tres->count /
-				(double)resv_tres_count;
+		if ((job_loc_tres = _find_loc_tres(job_tres, loc_tres->id))) {
+			tres_ratio = (double)job_loc_tres->count /
+				(double)loc_tres->count;
 			break;
 		}
 	}
-	list_iterator_destroy(resv_itr);
 
 	/*
 	 * Here we are converting TRES seconds to wall seconds.  This is needed
@@ -292,43 +358,36 @@ static int _update_unused_wall(local_resv_usage_t *r_usage, List job_tres,
 	return SLURM_SUCCESS;
 }
 
-static void _add_job_alloc_time_to_cluster(List c_tres_list, List j_tres)
+static void _add_job_alloc_time_to_cluster(local_tres_array_t *c_tres,
+					   local_tres_array_t *j_tres)
 {
-	ListIterator c_itr = list_iterator_create(c_tres_list);
 	local_tres_usage_t *loc_c_tres, *loc_j_tres;
+	uint32_t inx = 0;
 
-	while ((loc_c_tres = list_next(c_itr))) {
-		if (!(loc_j_tres = list_find_first(
-			      j_tres, _find_loc_tres, &loc_c_tres->id)))
+	while ((loc_c_tres = _next_loc_tres(c_tres, &inx))) {
+		if (!(loc_j_tres = _find_loc_tres(j_tres, loc_c_tres->id)))
 			continue;
 		loc_c_tres->time_alloc += loc_j_tres->time_alloc;
 	}
-	list_iterator_destroy(c_itr);
 }
 
-static void _setup_cluster_tres(List tres_list, uint32_t id,
+static void _setup_cluster_tres(local_tres_array_t *tres_array, uint32_t id,
 				uint64_t count, int seconds)
 {
-	local_tres_usage_t *loc_tres =
-		list_find_first(tres_list, _find_loc_tres, &id);
-
-	if (!loc_tres) {
-		loc_tres = xmalloc(sizeof(local_tres_usage_t));
-		loc_tres->id = id;
-		list_append(tres_list, loc_tres);
-	}
+	local_tres_usage_t *loc_tres = _make_loc_tres(tres_array, id);
 
 	loc_tres->count = count;
 	loc_tres->total_time += seconds * loc_tres->count;
 }
 
-static void _add_tres_2_list(List tres_list, char *tres_str, int seconds)
+static void _add_tres_2_list(local_tres_array_t *tres_array, char *tres_str,
+			     int seconds)
 {
 	char *tmp_str = tres_str;
 	int id;
 	uint64_t count;
 
-	xassert(tres_list);
+	xassert(tres_array);
 
 	if (!tres_str || !tres_str[0])
 		return;
@@ -353,7 +412,7 @@ static void _add_tres_2_list(List tres_list, char *tres_str, int seconds)
 				break;
 			}
 			count = slurm_atoull(++tmp_str);
-			_setup_cluster_tres(tres_list, id, count, seconds);
+			_setup_cluster_tres(tres_array, id, count, seconds);
 		}
 
 		if (!(tmp_str = strchr(tmp_str, ',')))
@@ -364,49 +423,46 @@ static void _add_tres_2_list(List tres_list, char *tres_str, int seconds)
 	return;
 }
 
-static void _add_job_alloc_time_to_assoc(List a_tres_list, List j_tres_list)
+static void _add_job_alloc_time_to_assoc(local_tres_array_t *a_tres,
+					 local_tres_array_t *j_tres)
 {
 	local_tres_usage_t *loc_a_tres, *loc_j_tres;
+	uint32_t inx = 0;
 
-	/*
-	 * NOTE: You have to use slurm_list_pop here, since
-	 * mysql is exporting something of the same type as a
-	 * macro, which messes everything up
-	 * (my_list.h is the bad boy).
-	 */
-	while ((loc_j_tres = slurm_list_pop(j_tres_list))) {
-		if (!(loc_a_tres = list_find_first(
-			      a_tres_list, _find_loc_tres, &loc_j_tres->id))) {
+	while ((loc_j_tres = _next_loc_tres(j_tres, &inx))) {
+		if (!(loc_a_tres = _find_loc_tres(a_tres, loc_j_tres->id))) {
 			/*
 			 * New TRES we haven't seen before in this association
-			 * just transfer it over.
+			 * just copy it over.
 			 */
-			list_append(a_tres_list, loc_j_tres);
+			*_make_loc_tres(a_tres, loc_j_tres->id) = *loc_j_tres;
 			continue;
 		}
 		loc_a_tres->time_alloc += loc_j_tres->time_alloc;
-		_destroy_local_tres_usage(loc_j_tres);
 	}
 }
 
-/* This will destroy the *loc_tres given after it is transfered */
-static void _transfer_loc_tres(List *loc_tres, local_id_usage_t *usage)
+/* This will free the *loc_tres given after it is transfered */
+static void _transfer_loc_tres(local_tres_array_t *loc_tres,
+			       local_id_usage_t *usage)
 {
-	if (!usage || !*loc_tres) {
-		FREE_NULL_LIST(*loc_tres);
+	if (!usage || !loc_tres->size) {
+		_free_loc_tres(loc_tres);
 		return;
 	}
 
-	if (!usage->loc_tres) {
+	if (!usage->loc_tres.size) {
 		usage->loc_tres = *loc_tres;
-		*loc_tres = NULL;
+		loc_tres->tres = NULL;
+		loc_tres->size = 0;
 	} else {
-		_add_job_alloc_time_to_assoc(usage->loc_tres, *loc_tres);
-		FREE_NULL_LIST(*loc_tres);
+		_add_job_alloc_time_to_assoc(&usage->loc_tres, loc_tres);
+		_free_loc_tres(loc_tres);
 	}
 }
 
-static void _add_tres_time_2_list(List tres_list, char *tres_str,
+static void _add_tres_time_2_list(local_tres_array_t *tres_array,
+				  char *tres_str,
 				  int type, int seconds, int suspend_seconds,
 				  bool times_count)
 {
@@ -415,7 +471,7 @@ static void _add_tres_time_2_list(List tres_list, char *tres_str,
 	uint64_t time, count;
 	local_tres_usage_t *loc_tres;
 
-	xassert(tres_list);
+	xassert(tres_array);
 
 	if (!tres_str || !tres_str[0])
 		return;
@@ -452,7 +508,7 @@ static void _add_tres_time_2_list(List tres_list, char *tres_str,
 		if (id != TRES_ENERGY)
 			time *= loc_seconds;
 
-		loc_tres = _add_time_tres(tres_list, type, id,
+		loc_tres = _add_time_tres(tres_array, type, id,
 					  time, times_count);
 
 		if (loc_tres && !loc_tres->count)
@@ -696,21 +752,18 @@ static int _process_cluster_usage(mysql_conn_t *mysql_conn,
 {
 	int rc = SLURM_SUCCESS;
 	char *query = NULL;
-	ListIterator itr;
 	local_tres_usage_t *loc_tres;
+	uint32_t inx = 0;
 
 	if (!c_usage)
 		return rc;
 	/* Now put the lists into the usage tables */
 
-	xassert(c_usage->loc_tres);
-	itr = list_iterator_create(c_usage->loc_tres);
-	while ((loc_tres = list_next(itr))) {
+	while ((loc_tres = _next_loc_tres(&c_usage->loc_tres, &inx))) {
 		_setup_cluster_tres_usage(mysql_conn, cluster_name,
 					  curr_start, curr_end, now,
 					  c_usage->start, loc_tres, &query);
 	}
-	list_iterator_destroy(itr);
 
 	if (!query)
 		return rc;
@@ -745,7 +798,7 @@ static void _create_id_usage_insert(char *cluster_name, int type,
 				    char **query)
 {
 	local_tres_usage_t *loc_tres;
-	ListIterator itr;
+	uint32_t inx = 0;
 	bool first;
 	char *table = NULL, *id_name = NULL;
 
@@ -766,14 +819,13 @@ static void _create_id_usage_insert(char *cluster_name, int type,
 		break;
 	}
 
-	if (!id_usage->loc_tres || !list_count(id_usage->loc_tres)) {
+	if (_loc_tres_empty(&id_usage->loc_tres)) {
 		error("%s %d doesn't have any tres", id_name, id_usage->id);
 		return;
 	}
 
 	first = 1;
-	itr = list_iterator_create(id_usage->loc_tres);
-	while ((loc_tres = list_next(itr))) {
+	while ((loc_tres = _next_loc_tres(&id_usage->loc_tres, &inx))) {
 		if (!first) {
 			xstrfmtcat(*query,
 				   ", (%ld, %ld, %u, %ld, %u, %"PRIu64")",
@@ -792,7 +844,6 @@ static void _create_id_usage_insert(char *cluster_name, int type,
 			first = 0;
 		}
 	}
-	list_iterator_destroy(itr);
 	xstrfmtcat(*query,
 		   " on duplicate key update mod_time=%ld, "
 		   "alloc_secs=VALUES(alloc_secs);", now);
@@ -826,8 +877,8 @@ static int _add_resv_usage_to_cluster(void *object, void *arg)
 	 * down time.
 	 */
 
-	_add_time_tres_list(c_usage->loc_tres,
-			    r_usage->loc_tres,
+	_add_time_tres_list(&c_usage->loc_tres,
+			    &r_usage->loc_tres,
 			    (r_usage->flags & RESERVE_FLAG_MAINT) ?
 			    TIME_PDOWN : TIME_ALLOC, 0, 0);
 
@@ -943,8 +994,6 @@ static local_cluster_usage_t *_setup_cluster_usage(mysql_conn_t *mysql_conn,
 				loc_c_usage = xmalloc(
 					sizeof(local_cluster_usage_t));
 				loc_c_usage->start = row_start;
-				loc_c_usage->loc_tres =
-					list_create(_destroy_local_tres_usage);
 				/* If this has a state it
 				   means the slurmctld went
 				   down and we should put this
@@ -962,7 +1011,7 @@ static local_cluster_usage_t *_setup_cluster_usage(mysql_conn_t *mysql_conn,
 
 			loc_c_usage->end = row_end;
 
-			_add_tres_2_list(loc_c_usage->loc_tres,
+			_add_tres_2_list(&loc_c_usage->loc_tres,
 					 row[EVENT_REQ_TRES], seconds);
 
 			continue;
@@ -986,7 +1035,7 @@ static local_cluster_usage_t *_setup_cluster_usage(mysql_conn_t *mysql_conn,
 		while ((loc_r_usage = list_next(r_itr))) {
 			time_t temp_end = row_end;
 			time_t temp_start = row_start;
-			List loc_tres = NULL;
+			local_tres_array_t loc_tres = { 0 };
 
 			if (hostlist_find_dims(loc_r_usage->hl,
 					       row[EVENT_REQ_NAME], dims)
@@ -1000,16 +1049,14 @@ static local_cluster_usage_t *_setup_cluster_usage(mysql_conn_t *mysql_conn,
 			if ((resv_seconds = (temp_end - temp_start)) < 1)
 				continue;
 
-			loc_tres = list_create(_destroy_local_tres_usage);
-
-			_add_tres_time_2_list(loc_tres,
+			_add_tres_time_2_list(&loc_tres,
 					      row[EVENT_REQ_TRES],
 					      loc_r_usage->flags &
 					      RESERVE_FLAG_MAINT ?
 					      TIME_PDOWN : TIME_DOWN,
 					      resv_seconds,
 					      0, 0);
-			_add_tres_time_2_list(c_usage->loc_tres,
+			_add_tres_time_2_list(&c_usage->loc_tres,
 					      row[EVENT_REQ_TRES],
 					      loc_r_usage->flags &
 					      RESERVE_FLAG_MAINT ?
@@ -1018,10 +1065,10 @@ static local_cluster_usage_t *_setup_cluster_usage(mysql_conn_t *mysql_conn,
 					      0, 0);
 
 			_remove_job_tres_time_from_cluster(
-				loc_r_usage->loc_tres,
-				loc_tres, resv_seconds);
+				&loc_r_usage->loc_tres,
+				&loc_tres, resv_seconds);
 
-			FREE_NULL_LIST(loc_tres);
+			_free_loc_tres(&loc_tres);
 		}
 
 		local_start = row_start;
@@ -1038,7 +1085,7 @@ static local_cluster_usage_t *_setup_cluster_usage(mysql_conn_t *mysql_conn,
 
 		seconds -= resv_seconds;
 		if (seconds > 0)
-			_add_tres_time_2_list(c_usage->loc_tres,
+			_add_tres_time_2_list(&c_usage->loc_tres,
 					      row[EVENT_REQ_TRES],
 					      TIME_DOWN,
 					      seconds, 0, 0);
@@ -1060,8 +1107,8 @@ static local_cluster_usage_t *_setup_cluster_usage(mysql_conn_t *mysql_conn,
 				continue;
 
 			_remove_job_tres_time_from_cluster(
-				loc_c_usage->loc_tres,
-				c_usage->loc_tres, seconds);
+				&loc_c_usage->loc_tres,
+				&c_usage->loc_tres, seconds);
 			/* info("Node %s was down for " */
 			/*      "%d seconds while " */
 			/*      "cluster %s's slurmctld " */
@@ -1194,10 +1241,7 @@ extern int _setup_resv_usage(mysql_conn_t *mysql_conn,
 		r_usage->local_assocs = list_create(xfree_ptr);
 		slurm_addto_char_list(r_usage->local_assocs,
 				      row[RESV_REQ_ASSOCS]);
-		r_usage->loc_tres =
-			list_create(_destroy_local_tres_usage);
-
-		_add_tres_2_list(r_usage->loc_tres,
+		_add_tres_2_list(&r_usage->loc_tres,
 				 row[RESV_REQ_TRES], resv_seconds);
 
 		/*
@@ -1216,14 +1260,53 @@ extern int _setup_resv_usage(mysql_conn_t *mysql_conn,
 	return SLURM_SUCCESS;
 }
 
-extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
-				  char *cluster_name,
-				  time_t start, time_t end,
-				  uint16_t archive_data)
+static void _add_resv_wall_query(char *cluster_name,
+				 local_resv_usage_t *r_usage, char **query)
+{
+	xstrfmtcat(*query, "update \"%s_%s\" set unused_wall=%f where id_resv=%u and time_start=%ld;",
+		   cluster_name, resv_table,
+		   r_usage->unused_wall, r_usage->id,
+		   r_usage->orig_start);
+}
+
+/* We need to figure out the dimensions of this cluster */
+static int _get_cluster_dims(mysql_conn_t *mysql_conn, char *cluster_name,
+			     int *dims)
+{
+	MYSQL_RES *result = NULL;
+	MYSQL_ROW row;
+	char *query;
+
+	query = xstrdup_printf("select dimensions from %s where name='%s'",
+			       cluster_table, cluster_name);
+	DB_DEBUG(DB_USAGE, mysql_conn->conn, "query\n%s", query);
+	result = mysql_db_query_ret(mysql_conn, query, 0);
+	xfree(query);
+
+	if (!result) {
+		error("%s: error querying cluster_table", __func__);
+		return SLURM_ERROR;
+	}
+
+	if (!(row = mysql_fetch_row(result))) {
+		error("%s: no cluster by name %s known",
+		      __func__, cluster_name);
+		mysql_free_result(result);
+		return SLURM_ERROR;
+	}
+
+	*dims = atoi(row[0]);
+	mysql_free_result(result);
+
+	return SLURM_SUCCESS;
+}
+
+static int _hourly_rollup(mysql_conn_t *mysql_conn, char *cluster_name,
+			  time_t start, time_t end, local_rollup_hour_t *hour)
 {
 	int rc = SLURM_SUCCESS;
 	int add_sec = 3600;
-	int i=0, dims;
+	int i=0, dims = hour->dims;
 	time_t now = time(NULL);
 	time_t curr_start = start;
 	time_t curr_end = curr_start + add_sec;
@@ -1245,6 +1328,7 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 	local_id_usage_t *a_usage = NULL;
 	local_id_usage_t *w_usage = NULL;
 	/* char start_char[20], end_char[20]; */
+	DEF_TIMERS;
 
 	char *job_req_inx[] = {
 		"job.job_db_inx",
@@ -1300,30 +1384,6 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 		xstrfmtcat(suspend_str, ", %s", suspend_req_inx[i]);
 	}
 
-	/* We need to figure out the dimensions of this cluster */
-	query = xstrdup_printf("select dimensions from %s where name='%s'",
-			       cluster_table, cluster_name);
-	DB_DEBUG(DB_USAGE, mysql_conn->conn, "query\n%s", query);
-	result = mysql_db_query_ret(mysql_conn, query, 0);
-	xfree(query);
-
-	if (!result) {
-		error("%s: error querying cluster_table", __func__);
-		rc = SLURM_ERROR;
-		goto end_it;
-	}
-	row = mysql_fetch_row(result);
-
-	if (!row) {
-		error("%s: no cluster by name %s known",
-		      __func__, cluster_name);
-		rc = SLURM_ERROR;
-		goto end_it;
-	}
-
-	dims = atoi(row[0]);
-	mysql_free_result(result);
-
 /* 	info("begin start %s", slurm_ctime2(&curr_start)); */
 /* 	info("begin end %s", slurm_ctime2(&curr_end)); */
 	a_itr = list_iterator_create(assoc_usage_list);
@@ -1340,21 +1400,25 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 /* 		info("start %s", slurm_ctime2(&curr_start)); */
 /* 		info("end %s", slurm_ctime2(&curr_end)); */
 
+		START_TIMER;
 		if ((rc = _setup_resv_usage(mysql_conn, cluster_name,
 					    curr_start, curr_end,
 					    resv_usage_list, dims))
 		    != SLURM_SUCCESS)
 			goto end_it;
+		END_TIMER;
+		hour->phase_time[DBD_ROLLUP_PHASE_RESV] += DELTA_TIMER;
 
+		START_TIMER;
 		c_usage = _setup_cluster_usage(mysql_conn, cluster_name,
 					       curr_start, curr_end,
 					       resv_usage_list,
 					       cluster_down_list,
 					       dims);
+		END_TIMER;
+		hour->phase_time[DBD_ROLLUP_PHASE_EVENT] += DELTA_TIMER;
 
-		if (c_usage)
-			xassert(c_usage->loc_tres);
-
+		START_TIMER;
 		/* now get the jobs during this time only  */
 		query = xstrdup_printf("select %s from \"%s_%s\" as job "
 				       "where (job.time_eligible && "
@@ -1386,7 +1450,7 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			time_t row_start = slurm_atoul(row[JOB_REQ_START]);
 			time_t row_end = slurm_atoul(row[JOB_REQ_END]);
 			uint32_t row_rcpu = slurm_atoul(row[JOB_REQ_RCPU]);
-			List loc_tres = NULL;
+			local_tres_array_t loc_tres = { 0 };
 			int loc_seconds = 0;
 			int seconds = 0, suspend_seconds = 0;
 
@@ -1456,7 +1520,7 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 				a_usage->id = assoc_id;
 				list_append(assoc_usage_list, a_usage);
 				last_id = assoc_id;
-				/* a_usage->loc_tres is made later,
+				/* a_usage->loc_tres is filled in later,
 				   don't do it here.
 				*/
 			}
@@ -1478,8 +1542,6 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 					w_usage->id = wckey_id;
 					list_append(wckey_usage_list,
 						    w_usage);
-					w_usage->loc_tres = list_create(
-						_destroy_local_tres_usage);
 				}
 				last_wckeyid = wckey_id;
 			}
@@ -1491,13 +1553,11 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			 * We need to have this clean for each job
 			 * since we add the time to the cluster individually.
 			 */
-			loc_tres = list_create(_destroy_local_tres_usage);
-
-			_add_tres_time_2_list(loc_tres, row[JOB_REQ_TRES],
+			_add_tres_time_2_list(&loc_tres, row[JOB_REQ_TRES],
 					      TIME_ALLOC, seconds,
 					      suspend_seconds, 0);
 			if (w_usage)
-				_add_tres_time_2_list(w_usage->loc_tres,
+				_add_tres_time_2_list(&w_usage->loc_tres,
 						      row[JOB_REQ_TRES],
 						      TIME_ALLOC, seconds,
 						      suspend_seconds, 0);
@@ -1519,8 +1579,8 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 					continue;
 
 				_remove_job_tres_time_from_cluster(
-					loc_c_usage->loc_tres,
-					loc_tres,
+					&loc_c_usage->loc_tres,
+					&loc_tres,
 					loc_seconds);
 				/* info("Job %u was running for " */
 				/*      "%d seconds while " */
@@ -1584,22 +1644,25 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 						 * individually here
 						 */
 						_add_tres_time_2_list(
-							c_usage->loc_tres,
+							&c_usage->loc_tres,
 							row[JOB_REQ_TRES],
 							TIME_ALLOC,
 							loc_seconds,
 							0, 0);
 
 					_add_time_tres_list(
-						r_usage->loc_tres,
-						loc_tres, TIME_ALLOC,
+						&r_usage->loc_tres,
+						&loc_tres, TIME_ALLOC,
 						loc_seconds, 1);
 					if ((rc = _update_unused_wall(
 						     r_usage,
-						     loc_tres,
+						     &loc_tres,
 						     loc_seconds))
-					    != SLURM_SUCCESS)
+					    != SLURM_SUCCESS) {
+						_free_loc_tres(&loc_tres);
+						mysql_free_result(result);
 						goto end_it;
+					}
 				}
 
 				_transfer_loc_tres(&loc_tres, a_usage);
@@ -1629,8 +1692,8 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 				/*      row_acpu); */
 
 				_add_job_alloc_time_to_cluster(
-					c_usage->loc_tres,
-					loc_tres);
+					&c_usage->loc_tres,
+					&loc_tres);
 			}
 
 			/*
@@ -1670,7 +1733,7 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 					/*      loc_seconds, */
 					/*      row_rcpu); */
 
-					_add_time_tres(c_usage->loc_tres,
+					_add_time_tres(&c_usage->loc_tres,
 						       TIME_RESV, TRES_CPU,
 						       loc_seconds *
 						       (uint64_t) row_rcpu,
@@ -1679,27 +1742,25 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			}
 		}
 		mysql_free_result(result);
+		END_TIMER;
+		hour->phase_time[DBD_ROLLUP_PHASE_JOB] += DELTA_TIMER;
 
 		/* now figure out how much more to add to the
 		   associations that could had run in the reservation
 		*/
+		START_TIMER;
 		query = NULL;
 		list_iterator_reset(r_itr);
 		while ((r_usage = list_next(r_itr))) {
-			ListIterator t_itr;
 			local_tres_usage_t *loc_tres;
+			uint32_t inx = 0;
 
-			xstrfmtcat(query, "update \"%s_%s\" set unused_wall=%f where id_resv=%u and time_start=%ld;",
-				   cluster_name, resv_table,
-				   r_usage->unused_wall, r_usage->id,
-				   r_usage->orig_start);
-
-			if (!r_usage->loc_tres ||
-			    !list_count(r_usage->loc_tres))
-				continue;
+			if (!(hour->flags & ROLLUP_FLAG_NO_RESV_WALL))
+				_add_resv_wall_query(cluster_name, r_usage,
+						     &query);
 
-			t_itr = list_iterator_create(r_usage->loc_tres);
-			while ((loc_tres = list_next(t_itr))) {
+			while ((loc_tres = _next_loc_tres(&r_usage->loc_tres,
+							  &inx))) {
 				int64_t idle = loc_tres->total_time -
 					loc_tres->time_alloc;
 				char *assoc = NULL;
@@ -1737,17 +1798,14 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 						list_append(assoc_usage_list,
 							    a_usage);
 						last_id = associd;
-						a_usage->loc_tres = list_create(
-							_destroy_local_tres_usage);
 					}
 
-					_add_time_tres(a_usage->loc_tres,
+					_add_time_tres(&a_usage->loc_tres,
 						       TIME_ALLOC, loc_tres->id,
 						       resv_unused_secs, 0);
 				}
 				list_iterator_destroy(tmp_itr);
 			}
-			list_iterator_destroy(t_itr);
 		}
 
 		if (query) {
@@ -1766,15 +1824,15 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 			list_iterator_reset(c_itr);
 			while ((loc_c_usage = list_next(c_itr))) {
 				local_tres_usage_t *loc_tres;
-				ListIterator tmp_itr = list_iterator_create(
-					loc_c_usage->loc_tres);
-				while ((loc_tres = list_next(tmp_itr)))
-					_add_time_tres(c_usage->loc_tres,
+				uint32_t inx = 0;
+
+				while ((loc_tres = _next_loc_tres(
+						&loc_c_usage->loc_tres, &inx)))
+					_add_time_tres(&c_usage->loc_tres,
 						       TIME_DOWN,
 						       loc_tres->id,
 						       loc_tres->total_time,
 						       0);
-				list_iterator_destroy(tmp_itr);
 			}
 
 			if ((rc = _process_cluster_usage(
@@ -1821,6 +1879,8 @@ extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
 		}
 
 	end_loop:
+		END_TIMER;
+		hour->phase_time[DBD_ROLLUP_PHASE_INSERT] += DELTA_TIMER;
 		_destroy_local_cluster_usage(c_usage);
 
 		c_usage     = NULL;
@@ -1858,15 +1918,299 @@ end_it:
 /* 	info("stop start %s", slurm_ctime2(&curr_start)); */
 /* 	info("stop end %s", slurm_ctime2(&curr_end)); */
 
+	return rc;
+}
+
+/*
+ * The unused_wall of a reservation carries over from one hour to the next,
+ * so when the hours were rolled up in parallel it is worked out here, in
+ * order, from only the jobs that ran in a reservation.
+ */
+static int _roll_resv_wall(mysql_conn_t *mysql_conn, char *cluster_name,
+			   time_t start, time_t end, int dims)
+{
+	int rc = SLURM_SUCCESS;
+	int add_sec = 3600;
+	time_t curr_start = start;
+	time_t curr_end = curr_start + add_sec;
+	char *query = NULL;
+	MYSQL_RES *result = NULL;
+	MYSQL_ROW row;
+	List resv_usage_list = list_create(_destroy_local_resv_usage);
+	ListIterator r_itr = list_iterator_create(resv_usage_list);
+	local_resv_usage_t *r_usage;
+	enum {
+		JOB_REQ_RESVID,
+		JOB_REQ_START,
+		JOB_REQ_END,
+		JOB_REQ_TRES,
+		JOB_REQ_COUNT
+	};
+
+	while (curr_start < end) {
+		if ((rc = _setup_resv_usage(mysql_conn, cluster_name,
+					    curr_start, curr_end,
+					    resv_usage_list, dims))
+		    != SLURM_SUCCESS)
+			break;
+
+		if (!list_count(resv_usage_list))
+			goto next_hour;
+
+		query = xstrdup_printf("select job.id_resv, job.time_start, job.time_end, job.tres_alloc from \"%s_%s\" as job where (job.id_resv && job.time_eligible && job.time_eligible < %ld && (job.time_end >= %ld || job.time_end = 0)) group by job.job_db_inx",
+				       cluster_name, job_table,
+				       curr_end, curr_start);
+		DB_DEBUG(DB_USAGE, mysql_conn->conn, "query\n%s", query);
+		result = mysql_db_query_ret(mysql_conn, query, 0);
+		xfree(query);
+		if (!result) {
+			rc = SLURM_ERROR;
+			break;
+		}
+
+		while ((row = mysql_fetch_row(result))) {
+			uint32_t resv_id = slurm_atoul(row[JOB_REQ_RESVID]);
+			time_t row_start = slurm_atoul(row[JOB_REQ_START]);
+			time_t row_end = slurm_atoul(row[JOB_REQ_END]);
+			local_tres_array_t loc_tres = { 0 };
+
+			/* Same as the job loop of _hourly_rollup() */
+			if (row_start && (row_start < curr_start))
+				row_start = curr_start;
+
+			if (!row_start && row_end)
+				row_start = row_end;
+
+			if (!row_end || row_end > curr_end)
+				row_end = curr_end;
+
+			if (!row_start || ((row_end - row_start) < 1))
+				continue;
+
+			_add_tres_time_2_list(&loc_tres, row[JOB_REQ_TRES],
+					      TIME_ALLOC, row_end - row_start,
+					      0, 0);
+
+			list_iterator_reset(r_itr);
+			while ((r_usage = list_next(r_itr))) {
+				time_t temp_end = row_end;
+				time_t temp_start = row_start;
+
+				if (r_usage->id != resv_id)
+					continue;
+				if (r_usage->start > temp_start)
+					temp_start = r_usage->start;
+				if (r_usage->end < temp_end)
+					temp_end = r_usage->end;
+				if ((temp_end - temp_start) <= 0)
+					continue;
+
+				(void) _update_unused_wall(
+					r_usage, &loc_tres,
+					temp_end - temp_start);
+			}
+			_free_loc_tres(&loc_tres);
+		}
+		mysql_free_result(result);
+
+		list_iterator_reset(r_itr);
+		while ((r_usage = list_next(r_itr)))
+			_add_resv_wall_query(cluster_name, r_usage, &query);
+
+		DB_DEBUG(DB_USAGE, mysql_conn->conn, "query\n%s", query);
+		rc = mysql_db_query(mysql_conn, query);
+		xfree(query);
+		if (rc != SLURM_SUCCESS) {
+			error("couldn't update reservations with unused time");
+			break;
+		}
+
+	next_hour:
+		list_flush(resv_usage_list);
+		curr_start = curr_end;
+		curr_end = curr_start + add_sec;
+	}
+	list_iterator_destroy(r_itr);
+	FREE_NULL_LIST(resv_usage_list);
+
+	return rc;
+}
+
+/*
+ * Roll up the hours handed out from parallel on a connection of its own,
+ * each hour is committed on its own.
+ */
+static void *_hourly_rollup_thread(void *arg)
+{
+	local_rollup_parallel_t *parallel = (local_rollup_parallel_t *)arg;
+	local_rollup_hour_t hour;
+	mysql_conn_t mysql_conn;
+	time_t curr_start;
+	int i, rc;
+
+	memset(&hour, 0, sizeof(hour));
+	hour.dims = parallel->dims;
+	hour.flags = ROLLUP_FLAG_NO_RESV_WALL;
+
+	memset(&mysql_conn, 0, sizeof(mysql_conn_t));
+	mysql_conn.rollback = 1;
+	mysql_conn.conn = parallel->parent_conn->conn;
+	slurm_mutex_init(&mysql_conn.lock);
+
+	/* Each thread needs it's own connection we can't use the one
+	 * sent from the parent thread. */
+	rc = check_connection(&mysql_conn);
+
+	while (rc == SLURM_SUCCESS) {
+		slurm_mutex_lock(&parallel->lock);
+		if ((parallel->rc != SLURM_SUCCESS) ||
+		    (parallel->next_start >= parallel->end)) {
+			slurm_mutex_unlock(&parallel->lock);
+			break;
+		}
+		curr_start = parallel->next_start;
+		parallel->next_start += 3600;
+		slurm_mutex_unlock(&parallel->lock);
+
+		rc = _hourly_rollup(&mysql_conn, parallel->cluster_name,
+				    curr_start, curr_start + 3600, &hour);
+		if ((rc == SLURM_SUCCESS) && mysql_db_commit(&mysql_conn)) {
+			char start_str[25];
+			error("Couldn't commit cluster (%s) hour rollup for %s",
+			      parallel->cluster_name,
+			      slurm_ctime2_r(&curr_start, start_str));
+			rc = SLURM_ERROR;
+		}
+		if (rc == SLURM_SUCCESS) {
+			slurm_mutex_lock(&parallel->lock);
+			parallel->committed++;
+			slurm_mutex_unlock(&parallel->lock);
+		}
+	}
+
+	if ((rc != SLURM_SUCCESS) && mysql_db_rollback(&mysql_conn))
+		error("rollback failed");
+
+	mysql_db_close_db_connection(&mysql_conn);
+	slurm_mutex_destroy(&mysql_conn.lock);
+
+	slurm_mutex_lock(&parallel->lock);
+	for (i = 0; i < DBD_ROLLUP_PHASE_COUNT; i++)
+		parallel->phase_time[i] += hour.phase_time[i];
+	if ((rc != SLURM_SUCCESS) && (parallel->rc == SLURM_SUCCESS))
+		parallel->rc = rc;
+	slurm_mutex_unlock(&parallel->lock);
+
+	return NULL;
+}
+
+static int _hourly_rollup_parallel(mysql_conn_t *mysql_conn,
+				   char *cluster_name,
+				   time_t start, time_t end,
+				   int threads, local_rollup_hour_t *hour)
+{
+	local_rollup_parallel_t parallel;
+	pthread_t *thread_ids = xcalloc(threads, sizeof(pthread_t));
+	int i;
+	DEF_TIMERS;
+
+	memset(&parallel, 0, sizeof(parallel));
+	parallel.cluster_name = cluster_name;
+	parallel.dims = hour->dims;
+	parallel.end = end;
+	parallel.next_start = start;
+	parallel.parent_conn = mysql_conn;
+	parallel.rc = SLURM_SUCCESS;
+	slurm_mutex_init(&parallel.lock);
+
+	for (i = 0; i < threads; i++)
+		slurm_thread_create(&thread_ids[i], _hourly_rollup_thread,
+				    &parallel);
+	for (i = 0; i < threads; i++)
+		pthread_join(thread_ids[i], NULL);
+
+	xfree(thread_ids);
+	slurm_mutex_destroy(&parallel.lock);
+
+	for (i = 0; i < DBD_ROLLUP_PHASE_COUNT; i++)
+		hour->phase_time[i] += parallel.phase_time[i];
+
+	/*
+	 * The hours are already committed, but the caller only moves the
+	 * last ran time on if every one of them was. Otherwise the whole
+	 * range is rolled up again next time, which just rewrites the hours
+	 * that made it.
+	 */
+	if (parallel.rc != SLURM_SUCCESS)
+		return parallel.rc;
+	if (parallel.committed != ((end - start) / 3600)) {
+		error("%s: only %d of %ld hour(s) of cluster %s committed",
+		      __func__, parallel.committed, (long) (end - start) / 3600,
+		      cluster_name);
+		return SLURM_ERROR;
+	}
+
+	START_TIMER;
+	parallel.rc = _roll_resv_wall(mysql_conn, cluster_name,
+				      start, end, hour->dims);
+	END_TIMER;
+	hour->phase_time[DBD_ROLLUP_PHASE_RESV] += DELTA_TIMER;
+
+	return parallel.rc;
+}
+
+extern int as_mysql_hourly_rollup(mysql_conn_t *mysql_conn,
+				  char *cluster_name,
+				  time_t start, time_t end,
+				  uint16_t archive_data,
+				  slurmdb_rollup_stats_t *rollup_stats)
+{
+	int rc, i, threads = 0;
+	int hours = (end - start) / 3600;
+	local_rollup_hour_t hour;
+
+	memset(&hour, 0, sizeof(hour));
+
+	if ((rc = _get_cluster_dims(mysql_conn, cluster_name, &hour.dims))
+	    != SLURM_SUCCESS)
+		return rc;
+
+	/*
+	 * Hours are only independent of each other apart from the unused
+	 * wall of reservations, so after an outage the backlog of hours can
+	 * be spread over several connections.
+	 */
+	if (slurmdbd_conf)
+		threads = MIN(slurmdbd_conf->rollup_threads, hours);
+
+	if (threads > 1)
+		rc = _hourly_rollup_parallel(mysql_conn, cluster_name,
+					     start, end, threads, &hour);
+	else
+		rc = _hourly_rollup(mysql_conn, cluster_name,
+				    start, end, &hour);
+
+	debug("%s: %s rolled up %d hour(s) with %d thread(s), reservations %"PRIu64" events %"PRIu64" jobs %"PRIu64" usage insert %"PRIu64" usec",
+	      __func__, cluster_name, hours, MAX(threads, 1),
+	      hour.phase_time[DBD_ROLLUP_PHASE_RESV],
+	      hour.phase_time[DBD_ROLLUP_PHASE_EVENT],
+	      hour.phase_time[DBD_ROLLUP_PHASE_JOB],
+	      hour.phase_time[DBD_ROLLUP_PHASE_INSERT]);
+
+	if (rollup_stats) {
+		for (i = 0; i < DBD_ROLLUP_PHASE_COUNT; i++)
+			rollup_stats->phase_time[i] += hour.phase_time[i];
+	}
+
 	/* go check to see if we archive and purge */
 
 	if (rc == SLURM_SUCCESS) {
 		if (mysql_db_commit(mysql_conn)) {
-			char start[25], end[25];
+			char start_str[25], end_str[25];
 			error("Couldn't commit cluster (%s) "
 			      "hour rollup for %s - %s",
-			      cluster_name, slurm_ctime2_r(&curr_start, start),
-			      slurm_ctime2_r(&curr_end, end));
+			      cluster_name, slurm_ctime2_r(&start, start_str),
+			      slurm_ctime2_r(&end, end_str));
 			rc = SLURM_ERROR;
 		} else
 			rc = _process_purge(mysql_conn, cluster_name,
@@ -1875,6 +2219,7 @@ end_it:
 
 	return rc;
 }
+
 extern int as_mysql_nonhour_rollup(mysql_conn_t *mysql_conn,
 				   bool run_month,
 				   char *cluster_name,
@@ -300,7 +300,8 @@ static void *_cluster_rollup_usage(void *arg)
 					    local_rollup->cluster_name,
 					    hour_start,
 					    hour_end,
-					    local_rollup->archive_data);
+					    local_rollup->archive_data,
+					    rollup_stats);
 		snprintf(timer_str, sizeof(timer_str),
 			 "hourly_rollup for %s", local_rollup->cluster_name);
 		END_TIMER3(timer_str, 5000000);
@@ -388,7 +389,8 @@ end_it:
 			error("Couldn't commit rollup of cluster %s",
 			      local_rollup->cluster_name);
 			rc = SLURM_ERROR;
-		}
+		} else
+			as_mysql_usage_cache_clear(local_rollup->cluster_name);
 	} else {
 		error("Cluster %s rollup failed", local_rollup->cluster_name);
 		if (mysql_db_rollback(&mysql_conn))
@@ -410,11 +412,161 @@ end_it:
 	return NULL;
 }
 
+/*
+ * A connection reading from StorageReadHost may see the replica lagging
+ * behind, what it reads must not be cached for everybody else.
+ */
+static bool _usage_cacheable(mysql_conn_t *mysql_conn)
+{
+	return !(mysql_conn->read_only && slurmdbd_conf->storage_read_host);
+}
+
+/*
+ * Add the records of summed usage (one row of USAGE_SUM_COUNT values per
+ * id and TRES) to usage_list.
+ * assoc_mgr locks need to be unlocked before coming here.
+ */
+enum {
+	USAGE_SUM_ID,
+	USAGE_SUM_TRES,
+	USAGE_SUM_ALLOC,
+	USAGE_SUM_COUNT
+};
+
+static void _add_summed_usage(uint64_t *values, uint32_t row_cnt,
+			      time_t start, List usage_list)
+{
+	assoc_mgr_lock_t locks = { NO_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
+				   READ_LOCK, NO_LOCK, NO_LOCK };
+	uint32_t i;
+
+	assoc_mgr_lock(&locks);
+	for (i = 0; i < row_cnt; i++) {
+		uint64_t *row = values + (i * USAGE_SUM_COUNT);
+		slurmdb_tres_rec_t *tres_rec;
+		slurmdb_accounting_rec_t *accounting_rec =
+			xmalloc(sizeof(slurmdb_accounting_rec_t));
+
+		accounting_rec->tres_rec.id = row[USAGE_SUM_TRES];
+		if ((tres_rec = list_find_first(
+			     assoc_mgr_tres_list, slurmdb_find_tres_in_list,
+			     &accounting_rec->tres_rec.id))) {
+			accounting_rec->tres_rec.name =
+				xstrdup(tres_rec->name);
+			accounting_rec->tres_rec.type =
+				xstrdup(tres_rec->type);
+		}
+
+		accounting_rec->id = row[USAGE_SUM_ID];
+		accounting_rec->period_start = start;
+		accounting_rec->alloc_secs = row[USAGE_SUM_ALLOC];
+
+		list_append(usage_list, accounting_rec);
+	}
+	assoc_mgr_unlock(&locks);
+}
+
+/*
+ * Get the usage of every association or wckey matching id_str summed over
+ * [start, end) per TRES, computed by the database and cached until the
+ * next rollup of the cluster.
+ * assoc_mgr locks need to be unlocked before coming here.
+ */
+static int _get_object_usage_summed(mysql_conn_t *mysql_conn,
+				    slurmdbd_msg_type_t type,
+				    char *my_usage_table, char *cluster_name,
+				    char *id_str, time_t start, time_t end,
+				    List *usage_list)
+{
+	MYSQL_RES *result = NULL;
+	MYSQL_ROW row;
+	char *query = NULL;
+	uint64_t *values = NULL;
+	uint32_t row_cnt = 0, i = 0;
+	usage_cache_t key = {
+		.cluster_name = cluster_name,
+		.col_cnt = USAGE_SUM_COUNT,
+		.end = end,
+		.id_str = id_str,
+		.start = start,
+		.table = my_usage_table,
+		.type = type,
+	};
+
+	if (!(*usage_list))
+		(*usage_list) = list_create(slurmdb_destroy_accounting_rec);
+
+	if (as_mysql_usage_cache_get(&key, &values, &row_cnt)) {
+		DB_DEBUG(DB_USAGE, mysql_conn->conn,
+			 "using %u cached summed usage rows of %s_%s",
+			 row_cnt, cluster_name, my_usage_table);
+		_add_summed_usage(values, row_cnt, start, *usage_list);
+		xfree(values);
+		return SLURM_SUCCESS;
+	}
+
+	switch (type) {
+	case DBD_GET_ASSOC_USAGE:
+		query = xstrdup_printf(
+			"select t3.id_assoc, t1.id_tres, sum(t1.alloc_secs) "
+			"from \"%s_%s\" as t1, "
+			"\"%s_%s\" as t2, \"%s_%s\" as t3 "
+			"where (t1.time_start < %ld && t1.time_start >= %ld) "
+			"&& t1.id=t2.id_assoc && (%s) && "
+			"t2.lft between t3.lft and t3.rgt "
+			"group by t3.id_assoc, t1.id_tres "
+			"order by t3.id_assoc, t1.id_tres;",
+			cluster_name, my_usage_table,
+			cluster_name, assoc_table, cluster_name, assoc_table,
+			end, start, id_str);
+		break;
+	case DBD_GET_WCKEY_USAGE:
+		query = xstrdup_printf(
+			"select id, id_tres, sum(alloc_secs) "
+			"from \"%s_%s\" "
+			"where (time_start < %ld && time_start >= %ld) "
+			"&& (%s) group by id, id_tres order by id, id_tres;",
+			cluster_name, my_usage_table, end, start, id_str);
+		break;
+	default:
+		error("Unknown usage type %d", type);
+		return SLURM_ERROR;
+		break;
+	}
+
+	DB_DEBUG(DB_USAGE, mysql_conn->conn, "query\n%s", query);
+	result = mysql_db_query_ret(mysql_conn, query, 0);
+	xfree(query);
+
+	if (!result)
+		return SLURM_ERROR;
+
+	row_cnt = mysql_num_rows(result);
+	values = xcalloc(row_cnt ? row_cnt : 1,
+			 sizeof(uint64_t) * USAGE_SUM_COUNT);
+	while ((row = mysql_fetch_row(result)) && (i < row_cnt)) {
+		uint64_t *vals = values + (i++ * USAGE_SUM_COUNT);
+
+		vals[USAGE_SUM_ID] = slurm_atoul(row[0]);
+		vals[USAGE_SUM_TRES] = slurm_atoul(row[1]);
+		vals[USAGE_SUM_ALLOC] = slurm_atoull(row[2]);
+	}
+	mysql_free_result(result);
+
+	if (_usage_cacheable(mysql_conn))
+		as_mysql_usage_cache_add(&key, values, i);
+	_add_summed_usage(values, i, start, *usage_list);
+	xfree(values);
+
+	return SLURM_SUCCESS;
+}
+
 /* assoc_mgr locks need to be unlocked before coming here */
 static int _get_object_usage(mysql_conn_t *mysql_conn,
 			     slurmdbd_msg_type_t type, char *my_usage_table,
 			     char *cluster_name, char *id_str,
-			     time_t start, time_t end, List *usage_list)
+			     time_t start, time_t end, uint16_t with_usage,
+			     List *usage_list)
 {
 	char *tmp = NULL;
 	int i = 0;
@@ -438,6 +590,12 @@ static int _get_object_usage(mysql_conn_t *mysql_conn,
 		USAGE_COUNT
 	};
 
+	if (with_usage & SLURMDB_USAGE_SUMMED)
+		return _get_object_usage_summed(mysql_conn, type,
+						my_usage_table, cluster_name,
+						id_str, start, end,
+						usage_list);
+
 	if (type == DBD_GET_WCKEY_USAGE)
 		usage_req_inx[0] = "t1.id";
 
@@ -513,11 +671,122 @@ static int _get_object_usage(mysql_conn_t *mysql_conn,
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Get the usage of a cluster over [start, end) as one record per TRES with
+ * the times summed and the average TRES count, cached until the next
+ * rollup of the cluster.
+ * assoc_mgr locks need to unlocked before you get here.
+ */
+static int _get_cluster_usage_summed(mysql_conn_t *mysql_conn,
+				     slurmdb_cluster_rec_t *cluster_rec,
+				     char *my_usage_table,
+				     time_t start, time_t end)
+{
+	MYSQL_RES *result = NULL;
+	MYSQL_ROW row;
+	char *query = NULL;
+	uint64_t *values = NULL;
+	uint32_t row_cnt = 0, i = 0, j;
+	assoc_mgr_lock_t locks = { NO_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
+				   READ_LOCK, NO_LOCK, NO_LOCK };
+	enum {
+		CLUSTER_SUM_TRES,
+		CLUSTER_SUM_ALLOC,
+		CLUSTER_SUM_DOWN,
+		CLUSTER_SUM_PDOWN,
+		CLUSTER_SUM_IDLE,
+		CLUSTER_SUM_RESV,
+		CLUSTER_SUM_OVER,
+		CLUSTER_SUM_CNT,
+		CLUSTER_SUM_COUNT
+	};
+	usage_cache_t key = {
+		.cluster_name = cluster_rec->name,
+		.col_cnt = CLUSTER_SUM_COUNT,
+		.end = end,
+		.start = start,
+		.table = my_usage_table,
+		.type = DBD_GET_CLUSTER_USAGE,
+	};
+
+	if (as_mysql_usage_cache_get(&key, &values, &row_cnt)) {
+		DB_DEBUG(DB_USAGE, mysql_conn->conn,
+			 "using %u cached summed usage rows of %s_%s",
+			 row_cnt, cluster_rec->name, my_usage_table);
+	} else {
+		/* Integer average of count as the client would compute it */
+		query = xstrdup_printf(
+			"select id_tres, sum(alloc_secs), sum(down_secs), "
+			"sum(pdown_secs), sum(idle_secs), sum(resv_secs), "
+			"sum(over_secs), sum(count) div count(*) "
+			"from \"%s_%s\" where (time_start < %ld "
+			"&& time_start >= %ld) group by id_tres",
+			cluster_rec->name, my_usage_table, end, start);
+
+		DB_DEBUG(DB_USAGE, mysql_conn->conn, "query\n%s", query);
+		if (!(result = mysql_db_query_ret(mysql_conn, query, 0))) {
+			xfree(query);
+			return SLURM_ERROR;
+		}
+		xfree(query);
+
+		row_cnt = mysql_num_rows(result);
+		values = xcalloc(row_cnt ? row_cnt : 1,
+				 sizeof(uint64_t) * CLUSTER_SUM_COUNT);
+		while ((row = mysql_fetch_row(result)) && (i < row_cnt)) {
+			uint64_t *vals = values + (i++ * CLUSTER_SUM_COUNT);
+
+			for (j = 0; j < CLUSTER_SUM_COUNT; j++)
+				vals[j] = slurm_atoull(row[j]);
+		}
+		mysql_free_result(result);
+		row_cnt = i;
+		if (_usage_cacheable(mysql_conn))
+			as_mysql_usage_cache_add(&key, values, row_cnt);
+	}
+
+	if (!cluster_rec->accounting_list)
+		cluster_rec->accounting_list =
+			list_create(slurmdb_destroy_cluster_accounting_rec);
+
+	assoc_mgr_lock(&locks);
+	for (i = 0; i < row_cnt; i++) {
+		uint64_t *vals = values + (i * CLUSTER_SUM_COUNT);
+		slurmdb_tres_rec_t *tres_rec;
+		slurmdb_cluster_accounting_rec_t *accounting_rec =
+			xmalloc(sizeof(slurmdb_cluster_accounting_rec_t));
+
+		accounting_rec->tres_rec.id = vals[CLUSTER_SUM_TRES];
+		accounting_rec->tres_rec.count = vals[CLUSTER_SUM_CNT];
+		if ((tres_rec = list_find_first(
+			     assoc_mgr_tres_list, slurmdb_find_tres_in_list,
+			     &accounting_rec->tres_rec.id))) {
+			accounting_rec->tres_rec.name =
+				xstrdup(tres_rec->name);
+			accounting_rec->tres_rec.type =
+				xstrdup(tres_rec->type);
+		}
+
+		accounting_rec->alloc_secs = vals[CLUSTER_SUM_ALLOC];
+		accounting_rec->down_secs = vals[CLUSTER_SUM_DOWN];
+		accounting_rec->pdown_secs = vals[CLUSTER_SUM_PDOWN];
+		accounting_rec->idle_secs = vals[CLUSTER_SUM_IDLE];
+		accounting_rec->over_secs = vals[CLUSTER_SUM_OVER];
+		accounting_rec->resv_secs = vals[CLUSTER_SUM_RESV];
+		accounting_rec->period_start = start;
+		list_append(cluster_rec->accounting_list, accounting_rec);
+	}
+	assoc_mgr_unlock(&locks);
+	xfree(values);
+
+	return SLURM_SUCCESS;
+}
+
 /* assoc_mgr locks need to unlocked before you get here */
 static int _get_cluster_usage(mysql_conn_t *mysql_conn, uid_t uid,
 			      slurmdb_cluster_rec_t *cluster_rec,
 			      slurmdbd_msg_type_t type,
-			      time_t start, time_t end)
+			      time_t start, time_t end, uint16_t with_usage)
 {
 	int rc = SLURM_SUCCESS;
 	int i=0;
@@ -563,6 +832,10 @@ static int _get_cluster_usage(mysql_conn_t *mysql_conn, uid_t uid,
 		return SLURM_ERROR;
 	}
 
+	if (with_usage & SLURMDB_USAGE_SUMMED)
+		return _get_cluster_usage_summed(mysql_conn, cluster_rec,
+						 my_usage_table, start, end);
+
 	xfree(tmp);
 	i=0;
 	xstrfmtcat(tmp, "%s", cluster_req_inx[i]);
@@ -625,7 +898,8 @@ static int _get_cluster_usage(mysql_conn_t *mysql_conn, uid_t uid,
 */
 extern int get_usage_for_list(mysql_conn_t *mysql_conn,
 			      slurmdbd_msg_type_t type, List object_list,
-			      char *cluster_name, time_t start, time_t end)
+			      char *cluster_name, time_t start, time_t end,
+			      uint16_t with_usage)
 {
 	int rc = SLURM_SUCCESS;
 	char *my_usage_table = NULL;
@@ -688,7 +962,7 @@ extern int get_usage_for_list(mysql_conn_t *mysql_conn,
 	}
 
 	if (_get_object_usage(mysql_conn, type, my_usage_table, cluster_name,
-			      id_str, start, end, &usage_list)
+			      id_str, start, end, with_usage, &usage_list)
 	    != SLURM_SUCCESS) {
 		xfree(id_str);
 		return SLURM_ERROR;
@@ -766,7 +1040,7 @@ extern int get_usage_for_list(mysql_conn_t *mysql_conn,
 /*   The assoc_mgr locks should be unlocked before coming here. */
 extern int as_mysql_get_usage(mysql_conn_t *mysql_conn, uid_t uid,
 			      void *in, slurmdbd_msg_type_t type,
-			      time_t start, time_t end)
+			      time_t start, time_t end, uint16_t with_usage)
 {
 	int rc = SLURM_SUCCESS;
 	int is_admin=1;
@@ -806,7 +1080,7 @@ extern int as_mysql_get_usage(mysql_conn_t *mysql_conn, uid_t uid,
 		break;
 	case DBD_GET_CLUSTER_USAGE:
 		rc = _get_cluster_usage(mysql_conn, uid, in,
-					type, start, end);
+					type, start, end, with_usage);
 		return rc;
 		break;
 	default:
@@ -878,7 +1152,7 @@ is_user:
 	}
 
 	_get_object_usage(mysql_conn, type, my_usage_table, cluster_name,
-			  id_str, start, end, my_list);
+			  id_str, start, end, with_usage, my_list);
 	xfree(id_str);
 
 	return rc;
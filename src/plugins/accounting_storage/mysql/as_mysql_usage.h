@@ -41,17 +41,25 @@
 #define _HAVE_MYSQL_USAGE_H
 
 #include "accounting_storage_mysql.h"
+#include "as_mysql_usage_cache.h"
 
 extern time_t global_last_rollup;
 extern pthread_mutex_t rollup_lock;
 extern pthread_mutex_t usage_rollup_lock;
 
+/*
+ * Fill in the accounting_list of the associations or wckeys in object_list.
+ * with_usage is the with_usage of the condition, with SLURMDB_USAGE_SUMMED
+ * there is one record per TRES summed over the time range.
+ */
 extern int get_usage_for_list(mysql_conn_t *mysql_conn,
 			      slurmdbd_msg_type_t type, List object_list,
-			      char *cluster_name, time_t start, time_t end);
+			      char *cluster_name, time_t start, time_t end,
+			      uint16_t with_usage);
 extern int as_mysql_get_usage(mysql_conn_t *mysql_conn, uid_t uid,
 			  void *in, slurmdbd_msg_type_t type,
-			  time_t start, time_t end);
+			  time_t start, time_t end, uint16_t with_usage);
+
 extern int as_mysql_roll_usage(mysql_conn_t *mysql_conn,
 			       time_t sent_start, time_t sent_end,
 			       uint16_t archive_data,
@@ -0,0 +1,196 @@
+/****************************************************************************\
+ *  as_mysql_usage_cache.c - cache of summed usage query results
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "as_mysql_usage_cache.h"
+
+static List usage_cache_list = NULL;	/* least recently used first */
+static pthread_mutex_t usage_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t usage_cache_gen = 0;	/* bumped by every clear */
+static uint32_t usage_cache_hits = 0;
+static uint32_t usage_cache_misses = 0;
+
+static void _destroy_usage_cache(void *object)
+{
+	usage_cache_t *cache = object;
+
+	if (cache) {
+		xfree(cache->cluster_name);
+		xfree(cache->id_str);
+		xfree(cache->table);
+		xfree(cache->values);
+		xfree(cache);
+	}
+}
+
+static int _find_usage_cache(void *x, void *key)
+{
+	usage_cache_t *cache = x, *want = key;
+
+	if ((cache->type == want->type) && (cache->start == want->start) &&
+	    (cache->end == want->end) &&
+	    !xstrcmp(cache->cluster_name, want->cluster_name) &&
+	    !xstrcmp(cache->table, want->table) &&
+	    !xstrcmp(cache->id_str, want->id_str))
+		return 1;
+	return 0;
+}
+
+static int _find_usage_cache_cluster(void *x, void *key)
+{
+	usage_cache_t *cache = x;
+
+	if (!key || !xstrcmp(cache->cluster_name, key))
+		return 1;
+	return 0;
+}
+
+extern bool as_mysql_usage_cache_get(usage_cache_t *key, uint64_t **values,
+				     uint32_t *row_cnt)
+{
+	usage_cache_t *cache = NULL;
+	size_t size;
+
+	slurm_mutex_lock(&usage_cache_lock);
+	if (usage_cache_list &&
+	    (cache = list_remove_first(usage_cache_list, _find_usage_cache,
+				       key))) {
+		size = sizeof(uint64_t) * cache->row_cnt * cache->col_cnt;
+		*values = xmalloc(size ? size : 1);
+		if (size)
+			memcpy(*values, cache->values, size);
+		*row_cnt = cache->row_cnt;
+		list_append(usage_cache_list, cache);
+		usage_cache_hits++;
+	} else {
+		key->gen = usage_cache_gen;
+		usage_cache_misses++;
+	}
+	slurm_mutex_unlock(&usage_cache_lock);
+
+	return (cache != NULL);
+}
+
+extern void as_mysql_usage_cache_add(usage_cache_t *key, uint64_t *values,
+				     uint32_t row_cnt)
+{
+	usage_cache_t *cache;
+	size_t size = sizeof(uint64_t) * row_cnt * key->col_cnt;
+
+	if (row_cnt > USAGE_CACHE_MAX_ROWS)
+		return;
+
+	cache = xmalloc(sizeof(usage_cache_t));
+	cache->cluster_name = xstrdup(key->cluster_name);
+	cache->col_cnt = key->col_cnt;
+	cache->end = key->end;
+	cache->id_str = xstrdup(key->id_str);
+	cache->row_cnt = row_cnt;
+	cache->start = key->start;
+	cache->table = xstrdup(key->table);
+	cache->type = key->type;
+	if (size) {
+		cache->values = xmalloc(size);
+		memcpy(cache->values, values, size);
+	}
+
+	slurm_mutex_lock(&usage_cache_lock);
+	if (key->gen != usage_cache_gen) {
+		/* Cleared while the query ran, it may have read old rows */
+		slurm_mutex_unlock(&usage_cache_lock);
+		_destroy_usage_cache(cache);
+		return;
+	}
+	if (!usage_cache_list)
+		usage_cache_list = list_create(_destroy_usage_cache);
+	/* Another connection may have just done the same query */
+	list_delete_all(usage_cache_list, _find_usage_cache, key);
+	while (list_count(usage_cache_list) >= USAGE_CACHE_MAX_ENTRIES)
+		_destroy_usage_cache(list_pop(usage_cache_list));
+	list_append(usage_cache_list, cache);
+	slurm_mutex_unlock(&usage_cache_lock);
+}
+
+extern void as_mysql_usage_cache_clear(char *cluster_name)
+{
+	int cnt = 0;
+
+	slurm_mutex_lock(&usage_cache_lock);
+	usage_cache_gen++;
+	if (usage_cache_list) {
+		cnt = list_delete_all(usage_cache_list,
+				      _find_usage_cache_cluster, cluster_name);
+		if (!cluster_name)
+			FREE_NULL_LIST(usage_cache_list);
+	}
+	if (cnt)
+		log_flag(DB_USAGE, "%s: dropped %d cached usage results of %s, %u hits %u misses so far",
+			 __func__, cnt, cluster_name ? cluster_name : "all clusters",
+			 usage_cache_hits, usage_cache_misses);
+	slurm_mutex_unlock(&usage_cache_lock);
+}
+
+extern void as_mysql_usage_cache_update(List update_list)
+{
+	slurmdb_update_object_t *object;
+	slurmdb_assoc_rec_t *assoc;
+	ListIterator itr, assoc_itr;
+
+	if (!update_list)
+		return;
+
+	itr = list_iterator_create(update_list);
+	while ((object = list_next(itr))) {
+		if (!object->objects ||
+		    ((object->type != SLURMDB_ADD_ASSOC) &&
+		     (object->type != SLURMDB_MODIFY_ASSOC) &&
+		     (object->type != SLURMDB_REMOVE_ASSOC)))
+			continue;
+		assoc_itr = list_iterator_create(object->objects);
+		while ((assoc = list_next(assoc_itr))) {
+			/* Nothing to match without the cluster, drop all */
+			as_mysql_usage_cache_clear(assoc->cluster);
+			if (!assoc->cluster)
+				break;
+		}
+		list_iterator_destroy(assoc_itr);
+	}
+	list_iterator_destroy(itr);
+}
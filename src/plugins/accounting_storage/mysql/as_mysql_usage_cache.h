@@ -0,0 +1,92 @@
+/****************************************************************************\
+ *  as_mysql_usage_cache.h - cache of summed usage query results
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _HAVE_AS_MYSQL_USAGE_CACHE_H
+#define _HAVE_AS_MYSQL_USAGE_CACHE_H
+
+#include "slurm/slurmdb.h"
+#include "src/common/slurmdbd_defs.h"
+
+/*
+ * Summed usage (SLURMDB_USAGE_SUMMED) is what sreport asks for, and it
+ * only changes when the usage tables are rolled up or the association
+ * hierarchy changes, so the rows of the last queries are kept. The key is
+ * everything the query depends on, the values are the numeric columns of
+ * the result.
+ */
+#define USAGE_CACHE_MAX_ENTRIES	128
+#define USAGE_CACHE_MAX_ROWS	100000	/* don't keep larger results */
+
+typedef struct {
+	char *cluster_name;
+	uint32_t col_cnt;
+	time_t end;
+	uint32_t gen;		/* cache generation the lookup missed in */
+	char *id_str;
+	uint32_t row_cnt;
+	time_t start;
+	char *table;
+	slurmdbd_msg_type_t type;
+	uint64_t *values;	/* row_cnt rows of col_cnt values */
+} usage_cache_t;
+
+/*
+ * Look up a cached result.
+ * IN/OUT key - what the query depends on, gen is set on a miss
+ * OUT values - xmalloc'ed copy of the cached values
+ * OUT row_cnt - rows in values
+ * RET true if found
+ */
+extern bool as_mysql_usage_cache_get(usage_cache_t *key, uint64_t **values,
+				     uint32_t *row_cnt);
+
+/*
+ * Remember a result, values are copied. Nothing is kept if the cache was
+ * cleared since the lookup of key missed, the result may predate that.
+ */
+extern void as_mysql_usage_cache_add(usage_cache_t *key, uint64_t *values,
+				     uint32_t row_cnt);
+
+/* Forget cached summed usage of a cluster, or of all clusters if NULL */
+extern void as_mysql_usage_cache_clear(char *cluster_name);
+
+/*
+ * Forget cached summed usage of the clusters whose associations were added,
+ * modified or removed (which includes changes of their lft and rgt)
+ * according to update_list, a list of slurmdb_update_object_t.
+ */
+extern void as_mysql_usage_cache_update(List update_list);
+
+#endif
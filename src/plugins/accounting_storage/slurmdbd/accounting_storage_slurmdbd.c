@@ -2908,6 +2908,83 @@ extern List jobacct_storage_p_get_jobs_cond(void *db_conn, uid_t uid,
 	return my_job_list;
 }
 
+typedef struct {
+	int (*part_cb)(List job_list, void *arg);
+	void *arg;
+} jobs_part_args_t;
+
+static int _got_jobs_part(persist_msg_t *part, void *arg)
+{
+	jobs_part_args_t *args = arg;
+	dbd_list_msg_t *got_msg = part->data;
+
+	if (!got_msg->my_list)
+		return SLURM_SUCCESS;
+	return (*(args->part_cb))(got_msg->my_list, args->arg);
+}
+
+/*
+ * get info from the storage a part at a time, slurmdbd sends the jobs as
+ * it reads them from the database
+ */
+extern int jobacct_storage_p_get_jobs_cond_stream(
+	void *db_conn, uid_t uid, slurmdb_job_cond_t *job_cond,
+	int (*part_cb)(List job_list, void *arg), void *arg)
+{
+	persist_msg_t req = {0}, resp = {0};
+	dbd_cond_msg_t get_msg;
+	jobs_part_args_t part_args = { .part_cb = part_cb, .arg = arg };
+	uint32_t flags = job_cond->flags;
+	int rc;
+
+	memset(&get_msg, 0, sizeof(dbd_cond_msg_t));
+
+	get_msg.cond = job_cond;
+	job_cond->flags |= JOBCOND_FLAG_STREAM;
+
+	req.msg_type = DBD_GET_JOBS_COND;
+	req.data = &get_msg;
+	rc = send_recv_slurmdbd_msg_parts(SLURM_PROTOCOL_VERSION, &req, &resp,
+					  DBD_GOT_JOBS_PART, _got_jobs_part,
+					  &part_args);
+	job_cond->flags = flags;
+
+	if (rc != SLURM_SUCCESS) {
+		error("DBD_GET_JOBS_COND failure: %s", slurm_strerror(rc));
+		if (resp.msg_type == PERSIST_RC)
+			slurm_persist_free_rc_msg(resp.data);
+		else if (resp.data)
+			slurmdbd_free_msg(&resp);
+	} else if (resp.msg_type == PERSIST_RC) {
+		persist_rc_msg_t *msg = resp.data;
+		if (msg->rc == SLURM_SUCCESS) {
+			info("%s", msg->comment);
+		} else {
+			rc = msg->rc;
+			slurm_seterrno(msg->rc);
+			error("%s", msg->comment);
+		}
+		slurm_persist_free_rc_msg(msg);
+	} else if (resp.msg_type != DBD_GOT_JOBS) {
+		error("response type not DBD_GOT_JOBS: %u",
+		      resp.msg_type);
+		rc = SLURM_ERROR;
+	} else {
+		/* Older slurmdbd, everything is in this message */
+		dbd_list_msg_t *got_msg = resp.data;
+		if (!got_msg->my_list) {
+			rc = got_msg->return_code;
+			slurm_seterrno(rc);
+			error("%s", slurm_strerror(rc));
+		} else if (list_count(got_msg->my_list)) {
+			rc = (*part_cb)(got_msg->my_list, arg);
+		}
+		slurmdbd_free_list_msg(got_msg);
+	}
+
+	return rc;
+}
+
 /*
  * Expire old info from the storage
  * Not applicable for any database
@@ -47,16 +47,31 @@
 #include "src/slurmctld/trigger_mgr.h"
 
 #include "slurmdbd_agent.h"
+#include "slurmdbd_spool.h"
 
 enum {
 	MAX_DBD_ACTION_DISCARD,
-	MAX_DBD_ACTION_EXIT
+	MAX_DBD_ACTION_EXIT,
+	MAX_DBD_ACTION_SPOOL
 };
 
 #define DBD_MAGIC		0xDEAD3219
 #define SLURMDBD_TIMEOUT	900	/* Seconds SlurmDBD for response */
 #define DEBUG_PRINT_MAX_MSG_TYPES 10
 #define MAX_DBD_DEFAULT_ACTION MAX_DBD_ACTION_DISCARD
+#define SPOOL_LOAD_LOW		1000	/* refill agent_list below this */
+#define SPOOL_LOAD_HIGH		2000	/* up to this many from the spool */
+#define AGENT_BATCH_CNT		1000	/* messages in one DBD_SEND_MULT_MSG */
+#define MAX_AGENT_CONNS		16
+
+typedef struct {
+	slurm_persist_conn_t *conn;
+	List msg_list;		/* messages in this shard, for packing */
+	Buf buffer;		/* packed DBD_SEND_MULT_MSG */
+	uint32_t ok_cnt;	/* leading messages slurmdbd processed */
+	int rc;
+	pthread_t tid;
+} agent_shard_t;
 
 static pthread_mutex_t agent_lock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t  agent_cond = PTHREAD_COND_INITIALIZER;
@@ -71,6 +86,12 @@ static pthread_mutex_t slurmdbd_lock = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t  slurmdbd_cond = PTHREAD_COND_INITIALIZER;
 
 static int max_dbd_msg_action = MAX_DBD_DEFAULT_ACTION;
+static bool spool_open = false;
+
+/* Extra connections used to drain a backlog, see _send_parallel() */
+static int agent_conn_cnt = 1;
+static slurm_persist_conn_t *agent_conns[MAX_AGENT_CONNS];
+static time_t agent_conn_fail_time = 0;
 
 static void _acct_full(void)
 {
@@ -125,6 +146,98 @@ static int _send_fini_msg(void)
 	return rc;
 }
 
+/****************************************************************************
+ * Functions to move messages on and off the agent queue
+ *
+ * Once messages go to the spool every new message follows them there, so the
+ * spool always holds the newest messages. The last slurmdbd_spool_inflight()
+ * messages of agent_list are the ones loaded back from the spool, they are
+ * acknowledged in the spool as they are dequeued. agent_lock must be held.
+ ****************************************************************************/
+static void _open_spool(bool create)
+{
+	char *spool_dir = NULL;
+
+	if (spool_open)
+		return;
+	xstrfmtcat(spool_dir, "%s/dbd.spool", slurm_conf.state_save_location);
+	if (slurmdbd_spool_open(spool_dir, create) == SLURM_SUCCESS)
+		spool_open = true;
+	xfree(spool_dir);
+}
+
+static void _close_spool(void)
+{
+	if (!spool_open)
+		return;
+	slurmdbd_spool_close();
+	spool_open = false;
+}
+
+/*
+ * Save the spool cursor and sync the records spooled since the last sync
+ * once enough of them piled up. Releases agent_lock, the sync runs without
+ * it so callers of send_slurmdbd_msg() are not held up by the disk.
+ */
+static void _sync_spool_unlock(void)
+{
+	int fd = -1;
+
+	if (spool_open)
+		fd = slurmdbd_spool_sync();
+	slurm_mutex_unlock(&agent_lock);
+	slurmdbd_spool_flush(fd);
+}
+
+/* Add a packed message to the queue, consumes buffer on success */
+static int _agent_enqueue(Buf buffer)
+{
+	uint32_t cnt = list_count(agent_list);
+
+	if (!spool_open && (max_dbd_msg_action == MAX_DBD_ACTION_SPOOL) &&
+	    (cnt >= slurm_conf.max_dbd_msgs))
+		_open_spool(true);
+
+	if (spool_open &&
+	    (slurmdbd_spool_unread() || slurmdbd_spool_inflight() ||
+	     (cnt >= slurm_conf.max_dbd_msgs))) {
+		if (slurmdbd_spool_append(buffer) != SLURM_SUCCESS)
+			return SLURM_ERROR;
+		free_buf(buffer);
+		return SLURM_SUCCESS;
+	}
+
+	if (list_enqueue(agent_list, buffer) == NULL)
+		fatal("list_enqueue: memory allocation failure");
+	return SLURM_SUCCESS;
+}
+
+/* Remove the oldest message from the queue once it was sent */
+static Buf _agent_dequeue(void)
+{
+	Buf buffer = list_dequeue(agent_list);
+
+	if (buffer && spool_open &&
+	    (list_count(agent_list) < slurmdbd_spool_inflight()))
+		slurmdbd_spool_ack();
+	return buffer;
+}
+
+/* Refill agent_list from the spool */
+static void _load_spool(void)
+{
+	Buf buffer;
+	int cnt = list_count(agent_list);
+
+	if (!spool_open || !slurmdbd_spool_unread() || (cnt > SPOOL_LOAD_LOW))
+		return;
+
+	while ((cnt < SPOOL_LOAD_HIGH) && (buffer = slurmdbd_spool_read())) {
+		list_enqueue(agent_list, buffer);
+		cnt++;
+	}
+}
+
 static int _unpack_return_code(uint16_t rpc_version, Buf buffer)
 {
 	uint16_t msg_type = -1;
@@ -134,7 +247,7 @@ static int _unpack_return_code(uint16_t rpc_version, Buf buffer)
 	int rc = SLURM_ERROR;
 
 	memset(&resp, 0, sizeof(persist_msg_t));
-	if ((rc = unpack_slurmdbd_msg(&resp, slurmdbd_conn->version, buffer))
+	if ((rc = unpack_slurmdbd_msg(&resp, rpc_version, buffer))
 	    != SLURM_SUCCESS) {
 		error("unpack message error");
 		return rc;
@@ -206,7 +319,12 @@ static int _get_return_code(void)
 	return rc;
 }
 
-static int _handle_mult_rc_ret(void)
+/*
+ * Read the reply to a DBD_SEND_MULT_MSG from conn
+ * ok_cnt OUT - number of leading messages that were processed
+ * RET return code of the first failed message or SLURM_SUCCESS
+ */
+static int _recv_mult_rc(slurm_persist_conn_t *conn, uint32_t *ok_cnt)
 {
 	Buf buffer;
 	uint16_t msg_type;
@@ -215,7 +333,8 @@ static int _handle_mult_rc_ret(void)
 	int rc = SLURM_ERROR;
 	Buf out_buf = NULL;
 
-	buffer = slurm_persist_recv_msg(slurmdbd_conn);
+	*ok_cnt = 0;
+	buffer = slurm_persist_recv_msg(conn);
 	if (buffer == NULL)
 		return rc;
 
@@ -223,39 +342,30 @@ static int _handle_mult_rc_ret(void)
 	switch (msg_type) {
 	case DBD_GOT_MULT_MSG:
 		if (slurmdbd_unpack_list_msg(
-			    &list_msg, slurmdbd_conn->version,
+			    &list_msg, conn->version,
 			    DBD_GOT_MULT_MSG, buffer)
 		    != SLURM_SUCCESS) {
 			error("unpack message error");
 			break;
 		}
 
-		slurm_mutex_lock(&agent_lock);
-		if (agent_list) {
+		{
 			ListIterator itr =
 				list_iterator_create(list_msg->my_list);
 			while ((out_buf = list_next(itr))) {
-				Buf b;
 				if ((rc = _unpack_return_code(
-					     slurmdbd_conn->version, out_buf))
+					     conn->version, out_buf))
 				    != SLURM_SUCCESS)
 					break;
-
-				if ((b = list_dequeue(agent_list))) {
-					free_buf(b);
-				} else {
-					error("DBD_GOT_MULT_MSG "
-					      "unpack message error");
-				}
+				(*ok_cnt)++;
 			}
 			list_iterator_destroy(itr);
 		}
-		slurm_mutex_unlock(&agent_lock);
 		slurmdbd_free_list_msg(list_msg);
 		break;
 	case PERSIST_RC:
 		if (slurm_persist_unpack_rc_msg(
-			    &msg, buffer, slurmdbd_conn->version)
+			    &msg, buffer, conn->version)
 		    == SLURM_SUCCESS) {
 			rc = msg->rc;
 			if (rc != SLURM_SUCCESS) {
@@ -294,6 +404,26 @@ unpack_error:
 	return rc;
 }
 
+static int _handle_mult_rc_ret(void)
+{
+	uint32_t ok_cnt;
+	int rc = _recv_mult_rc(slurmdbd_conn, &ok_cnt);
+	Buf b;
+
+	slurm_mutex_lock(&agent_lock);
+	if (agent_list) {
+		while (ok_cnt--) {
+			if ((b = _agent_dequeue()))
+				free_buf(b);
+			else
+				error("DBD_GOT_MULT_MSG unpack message error");
+		}
+	}
+	slurm_mutex_unlock(&agent_lock);
+
+	return rc;
+}
+
 /****************************************************************************
  * Functions for agent to manage queue of pending message for the Slurm DBD
  ****************************************************************************/
@@ -350,6 +480,7 @@ static void _load_dbd_state(void)
 {
 	char *dbd_fname = NULL;
 	Buf buffer;
+	List recovered_list = NULL;
 	int fd, recovered = 0;
 	uint16_t rpc_version = 0;
 
@@ -384,6 +515,7 @@ static void _load_dbd_state(void)
 			xfree(ver_str);
 		}
 
+		recovered_list = list_create(slurmdbd_free_buffer);
 		while (1) {
 			/* If the buffer was not the VER%d string it
 			   was an actual message so we don't want to
@@ -414,13 +546,22 @@ static void _load_dbd_state(void)
 				error("no buffer given");
 				continue;
 			}
-			if (!list_enqueue(agent_list, buffer))
+			if (!list_enqueue(recovered_list, buffer))
 				fatal("list_enqueue, no memory");
 			recovered++;
 			buffer = NULL;
 		}
 
 	end_it:
+		/*
+		 * dbd.messages is older than anything queued or spooled
+		 * since, so it goes ahead of all of it, never to the spool.
+		 */
+		if (recovered_list) {
+			list_transfer(recovered_list, agent_list);
+			list_transfer(agent_list, recovered_list);
+			FREE_NULL_LIST(recovered_list);
+		}
 		verbose("recovered %d pending RPCs", recovered);
 		(void) close(fd);
 	}
@@ -489,7 +630,10 @@ static void _save_dbd_state(void)
 		if (rc != SLURM_SUCCESS)
 			goto end_it;
 
-		while ((buffer = list_dequeue(agent_list))) {
+		/* Messages loaded from the spool are still in the spool */
+		while ((list_count(agent_list) >
+			slurmdbd_spool_inflight()) &&
+		       (buffer = list_dequeue(agent_list))) {
 			/*
 			 * We do not want to store registration messages. If an
 			 * admin puts in an incorrect cluster name we can get a
@@ -527,18 +671,19 @@ end_it:
 	xfree(dbd_fname);
 }
 
-/* Purge queued step records from the agent queue
+/* Purge queued step records from the agent queue, leaving alone the last
+ * "keep" records (loaded from the spool and still in it)
  * RET number of records purged */
-static int _purge_step_req(void)
+static int _purge_step_req(int keep)
 {
-	int purged = 0;
+	int purged = 0, left = list_count(agent_list) - keep;
 	ListIterator iter;
 	uint16_t msg_type;
 	uint32_t offset;
 	Buf buffer;
 
 	iter = list_iterator_create(agent_list);
-	while ((buffer = list_next(iter))) {
+	while ((left-- > 0) && (buffer = list_next(iter))) {
 		offset = get_buf_offset(buffer);
 		if (offset < 2)
 			continue;
@@ -556,18 +701,19 @@ static int _purge_step_req(void)
 	return purged;
 }
 
-/* Purge queued job start records from the agent queue
+/* Purge queued job start records from the agent queue, leaving alone the
+ * last "keep" records (loaded from the spool and still in it)
  * RET number of records purged */
-static int _purge_job_start_req(void)
+static int _purge_job_start_req(int keep)
 {
-	int purged = 0;
+	int purged = 0, left = list_count(agent_list) - keep;
 	ListIterator iter;
 	uint16_t msg_type;
 	uint32_t offset;
 	Buf buffer;
 
 	iter = list_iterator_create(agent_list);
-	while ((buffer = list_next(iter))) {
+	while ((left-- > 0) && (buffer = list_next(iter))) {
 		offset = get_buf_offset(buffer);
 		if (offset < 2)
 			continue;
@@ -586,6 +732,12 @@ static int _purge_job_start_req(void)
 
 static void _max_dbd_msg_action(uint32_t *msg_cnt)
 {
+	int keep = 0;
+
+	/* Messages past MaxDBDMsgs go to the spool */
+	if (max_dbd_msg_action == MAX_DBD_ACTION_SPOOL)
+		return;
+
 	if (max_dbd_msg_action == MAX_DBD_ACTION_EXIT) {
 		if (*msg_cnt < slurm_conf.max_dbd_msgs)
 			return;
@@ -595,11 +747,19 @@ static void _max_dbd_msg_action(uint32_t *msg_cnt)
 		      *msg_cnt);
 	}
 
-	/* MAX_DBD_ACTION_DISCARD */
+	/*
+	 * MAX_DBD_ACTION_DISCARD
+	 *
+	 * A spool left from before the action changed may still be drained,
+	 * messages loaded from it can only be removed in order as they are
+	 * acknowledged in the spool, so only purge the ones before them.
+	 */
+	if (spool_open)
+		keep = slurmdbd_spool_inflight();
 	if (*msg_cnt >= (slurm_conf.max_dbd_msgs - 1))
-		*msg_cnt -= _purge_step_req();
+		*msg_cnt -= _purge_step_req(keep);
 	if (*msg_cnt >= (slurm_conf.max_dbd_msgs - 1))
-		*msg_cnt -= _purge_job_start_req();
+		*msg_cnt -= _purge_job_start_req(keep);
 }
 
 /* Open a connection to the Slurm DBD and set slurmdbd_conn */
@@ -693,6 +853,256 @@ again:
 	}
 }
 
+/*
+ * Open the extra agent connections to the slurmdbd slurmdbd_conn is talking
+ * to. Called with slurmdbd_lock held.
+ * RET number of connections usable, including slurmdbd_conn
+ */
+static int _open_agent_conns(void)
+{
+	slurm_persist_conn_t *conn;
+	int i, cnt = 1;
+
+	for (i = 1; i < agent_conn_cnt; i++) {
+		if (!(conn = agent_conns[i])) {
+			conn = xmalloc(sizeof(slurm_persist_conn_t));
+			conn->flags = PERSIST_FLAG_DBD;
+			conn->persist_type = PERSIST_TYPE_DBD_AGENT;
+			conn->cluster_name = xstrdup(slurm_conf.cluster_name);
+			conn->shutdown = &slurmdbd_shutdown;
+			agent_conns[i] = conn;
+		}
+		if (conn->fd >= 0) {
+			cnt++;
+			continue;
+		}
+		if (difftime(time(NULL), agent_conn_fail_time) < 10)
+			continue;
+
+		conn->version = SLURM_PROTOCOL_VERSION;
+		conn->timeout = (slurm_conf.msg_timeout + 35) * 1000;
+		conn->rem_port = slurmdbd_conn->rem_port;
+		xfree(conn->rem_host);
+		conn->rem_host = xstrdup(slurmdbd_conn->rem_host);
+		if (slurm_persist_conn_open(conn) != SLURM_SUCCESS) {
+			slurm_persist_conn_close(conn);
+			agent_conn_fail_time = time(NULL);
+			continue;
+		}
+		conn->timeout = SLURMDBD_TIMEOUT * 1000;
+		cnt++;
+	}
+
+	return cnt;
+}
+
+static void _close_agent_conns(void)
+{
+	int i;
+
+	for (i = 1; i < MAX_AGENT_CONNS; i++) {
+		slurm_persist_conn_destroy(agent_conns[i]);
+		agent_conns[i] = NULL;
+	}
+}
+
+/*
+ * Find what a queued message can be sharded on.
+ * RET false if the message must be sent in order with everything else
+ */
+static bool _msg_shard_key(Buf buffer, uint32_t *key)
+{
+	persist_msg_t msg = {0};
+	uint32_t offset = get_buf_offset(buffer);
+	uint16_t msg_type;
+	bool rc = true;
+
+	if (offset < 2)
+		return false;
+	set_buf_offset(buffer, 0);
+	(void) unpack16(&msg_type, buffer);	/* checked by offset */
+
+	switch (msg_type) {
+	case DBD_JOB_START:
+	case DBD_JOB_COMPLETE:
+	case DBD_JOB_SUSPEND:
+	case DBD_STEP_START:
+	case DBD_STEP_COMPLETE:
+		break;
+	case DBD_NODE_STATE:
+		/* Node events only need to stay in order among themselves */
+		*key = 0;
+		set_buf_offset(buffer, offset);
+		return true;
+	default:
+		set_buf_offset(buffer, offset);
+		return false;
+	}
+
+	set_buf_offset(buffer, 0);
+	if (unpack_slurmdbd_msg(&msg, slurmdbd_conn->version, buffer) !=
+	    SLURM_SUCCESS) {
+		set_buf_offset(buffer, offset);
+		return false;
+	}
+	set_buf_offset(buffer, offset);
+
+	switch (msg.msg_type) {
+	case DBD_JOB_START:
+		*key = ((dbd_job_start_msg_t *) msg.data)->job_id;
+		break;
+	case DBD_JOB_COMPLETE:
+		*key = ((dbd_job_comp_msg_t *) msg.data)->job_id;
+		break;
+	case DBD_JOB_SUSPEND:
+		*key = ((dbd_job_suspend_msg_t *) msg.data)->job_id;
+		break;
+	case DBD_STEP_START:
+		*key = ((dbd_step_start_msg_t *) msg.data)->step_id.job_id;
+		break;
+	case DBD_STEP_COMPLETE:
+		*key = ((dbd_step_comp_msg_t *) msg.data)->step_id.job_id;
+		break;
+	default:
+		rc = false;
+	}
+	slurmdbd_free_msg(&msg);
+
+	return rc;
+}
+
+static void *_shard_send(void *x)
+{
+	agent_shard_t *shard = x;
+
+	if ((shard->rc = slurm_persist_send_msg(shard->conn, shard->buffer)) ==
+	    SLURM_SUCCESS)
+		shard->rc = _recv_mult_rc(shard->conn, &shard->ok_cnt);
+
+	return NULL;
+}
+
+/*
+ * Send the job records at the head of agent_list over several connections
+ * at once. Messages are sharded on job id so each job's records stay in
+ * order on one connection. Afterwards only the messages up to the first one
+ * that was not processed are dequeued, the rest is sent again later.
+ *
+ * Called with slurmdbd_lock and agent_lock held, agent_lock is released
+ * while sending.
+ * RET false if there wasn't enough to shard, nothing was sent then
+ */
+static bool _send_parallel(int *rc)
+{
+	agent_shard_t shards[MAX_AGENT_CONNS];
+	persist_msg_t list_req = {0};
+	dbd_list_msg_t list_msg = {0};
+	uint16_t *msg_shard;
+	uint32_t key, msg_cnt = 0, max_cnt, sent[MAX_AGENT_CONNS];
+	ListIterator itr;
+	Buf buffer;
+	int i, conn_cnt;
+	DEF_TIMERS;
+
+	slurm_mutex_unlock(&agent_lock);
+	conn_cnt = _open_agent_conns();
+	slurm_mutex_lock(&agent_lock);
+	if (conn_cnt < 2)
+		return false;
+
+	START_TIMER;
+	memset(shards, 0, sizeof(shards));
+	for (i = 0; i < conn_cnt; i++)
+		shards[i].msg_list = list_create(NULL);
+	max_cnt = conn_cnt * AGENT_BATCH_CNT;
+	msg_shard = xcalloc(max_cnt, sizeof(uint16_t));
+
+	itr = list_iterator_create(agent_list);
+	while ((msg_cnt < max_cnt) && (buffer = list_next(itr))) {
+		if (!_msg_shard_key(buffer, &key))
+			break;
+		i = key % conn_cnt;
+		if (list_count(shards[i].msg_list) >= AGENT_BATCH_CNT)
+			break;
+		list_enqueue(shards[i].msg_list, buffer);
+		msg_shard[msg_cnt++] = i;
+	}
+	list_iterator_destroy(itr);
+
+	if (msg_cnt <= AGENT_BATCH_CNT) {
+		/* One DBD_SEND_MULT_MSG will do */
+		for (i = 0; i < conn_cnt; i++)
+			FREE_NULL_LIST(shards[i].msg_list);
+		xfree(msg_shard);
+		return false;
+	}
+
+	list_req.msg_type = DBD_SEND_MULT_MSG;
+	list_req.data = &list_msg;
+	for (i = 0; i < conn_cnt; i++) {
+		if (list_count(shards[i].msg_list)) {
+			list_msg.my_list = shards[i].msg_list;
+			shards[i].buffer = pack_slurmdbd_msg(
+				&list_req, SLURM_PROTOCOL_VERSION);
+		}
+		FREE_NULL_LIST(shards[i].msg_list);
+	}
+	slurm_mutex_unlock(&agent_lock);
+
+	/* Connections that failed to open are at the end of agent_conns */
+	for (i = 0, key = 1; i < conn_cnt; i++) {
+		if (!i) {
+			shards[i].conn = slurmdbd_conn;
+			continue;
+		}
+		while (agent_conns[key]->fd < 0)
+			key++;
+		shards[i].conn = agent_conns[key++];
+	}
+	for (i = 1; i < conn_cnt; i++) {
+		if (shards[i].buffer)
+			slurm_thread_create(&shards[i].tid, _shard_send,
+					    &shards[i]);
+	}
+	if (shards[0].buffer)
+		(void) _shard_send(&shards[0]);
+	for (i = 1; i < conn_cnt; i++) {
+		if (shards[i].tid)
+			pthread_join(shards[i].tid, NULL);
+	}
+
+	*rc = SLURM_SUCCESS;
+	for (i = 0; i < conn_cnt; i++) {
+		free_buf(shards[i].buffer);
+		if (shards[i].rc == SLURM_SUCCESS)
+			continue;
+		if (*rc == SLURM_SUCCESS)
+			*rc = shards[i].rc;
+		/* Don't leave a late reply behind, reopen next time */
+		if (i)
+			slurm_persist_conn_close(shards[i].conn);
+	}
+
+	slurm_mutex_lock(&agent_lock);
+	memset(sent, 0, sizeof(sent));
+	for (key = 0; key < msg_cnt; key++) {
+		i = msg_shard[key];
+		if (sent[i] >= shards[i].ok_cnt)
+			break;
+		sent[i]++;
+	}
+	END_TIMER2("slurmdbd agent: parallel send");
+	log_flag(AGENT, "slurmdbd agent sent %u of %u messages over %d connections in %s",
+		 key, msg_cnt, conn_cnt, TIME_STR);
+	while (key--) {
+		if ((buffer = _agent_dequeue()))
+			free_buf(buffer);
+	}
+	xfree(msg_shard);
+
+	return true;
+}
+
 static void _sig_handler(int signal)
 {
 }
@@ -791,6 +1201,8 @@ static void *_agent(void *x)
 		}
 
 		slurm_mutex_lock(&agent_lock);
+		if (slurmdbd_conn->fd >= 0)
+			_load_spool();
 		cnt = list_count(agent_list);
 		if ((cnt == 0) || (slurmdbd_conn->fd < 0) ||
 		    (fail_time && (difftime(time(NULL), fail_time) < 10))) {
@@ -799,18 +1211,46 @@ static void *_agent(void *x)
 			END_TIMER2("slurmdbd agent: sleep");
 			log_flag(AGENT, "slurmdbd agent sleeping with agent_count=%d",
 				 list_count(agent_list));
-			abs_time.tv_sec  = time(NULL) + 10;
+			/* Wake up in time to sync what was spooled */
+			abs_time.tv_sec  = time(NULL) +
+				((spool_open && slurmdbd_spool_unsynced()) ?
+				 SPOOL_SYNC_TIME : 10);
 			abs_time.tv_nsec = 0;
 			slurm_cond_timedwait(&agent_cond, &agent_lock,
 					     &abs_time);
-			slurm_mutex_unlock(&agent_lock);
+			_sync_spool_unlock();
 			continue;
 		} else if (((cnt > 0) && ((cnt % 100) == 0)) ||
 		           (slurm_conf.debug_flags & DEBUG_FLAG_AGENT))
 			info("agent_count:%d", cnt);
+
+		if ((agent_conn_cnt > 1) && (cnt > AGENT_BATCH_CNT) &&
+		    (slurmdbd_conn->version >= SLURM_20_11_PROTOCOL_VERSION) &&
+		    _send_parallel(&rc)) {
+			if (rc == SLURM_SUCCESS) {
+				fail_time = 0;
+			} else {
+				fail_time = time(NULL);
+				if (slurm_conf.debug_flags & DEBUG_FLAG_AGENT) {
+					info("slurmdbd agent failed with rc:%d",
+					     rc);
+					_print_agent_list_msg_types();
+				}
+			}
+			slurm_mutex_unlock(&slurmdbd_lock);
+			_sync_spool_unlock();
+
+			slurm_mutex_lock(&assoc_cache_mutex);
+			if (slurmdbd_conn->fd >= 0 &&
+			    (running_cache != RUNNING_CACHE_STATE_NOTRUNNING))
+				slurm_cond_signal(&assoc_cache_cond);
+			slurm_mutex_unlock(&assoc_cache_mutex);
+			END_TIMER2("slurmdbd agent: full loop");
+			continue;
+		}
 		/* Leave item on the queue until processing complete */
 		if (agent_list) {
-			int handle_agent_count = 1000;
+			int handle_agent_count = AGENT_BATCH_CNT;
 			if (cnt > handle_agent_count) {
 				int agent_count = 0;
 				ListIterator agent_itr =
@@ -891,7 +1331,7 @@ static void *_agent(void *x)
 					FREE_NULL_LIST(list_msg.my_list);
 				list_msg.my_list = NULL;
 			} else
-				buffer = (Buf) list_dequeue(agent_list);
+				buffer = _agent_dequeue();
 
 			free_buf(buffer);
 			fail_time = 0;
@@ -912,12 +1352,15 @@ static void *_agent(void *x)
 				_print_agent_list_msg_types();
 			}
 		}
-		slurm_mutex_unlock(&agent_lock);
+		_sync_spool_unlock();
 		END_TIMER2("slurmdbd agent: full loop");
 	}
 
+	_close_agent_conns();
+
 	slurm_mutex_lock(&agent_lock);
 	_save_dbd_state();
+	_close_spool();
 
 	log_flag(AGENT, "slurmdbd agent ending with agent_count=%d",
 		 list_count(agent_list));
@@ -938,6 +1381,11 @@ static void _create_agent(void)
 	if (agent_list == NULL) {
 		agent_list = list_create(slurmdbd_free_buffer);
 		_load_dbd_state();
+		/*
+		 * The spool holds messages newer than dbd.messages. Open it
+		 * even when not spooling anymore to send what is left.
+		 */
+		_open_spool(max_dbd_msg_action == MAX_DBD_ACTION_SPOOL);
 	}
 
 	if (agent_tid == 0) {
@@ -1049,7 +1497,23 @@ extern int send_recv_slurmdbd_msg(uint16_t rpc_version,
 				  persist_msg_t *req,
 				  persist_msg_t *resp)
 {
-	int rc = SLURM_SUCCESS;
+	return send_recv_slurmdbd_msg_parts(rpc_version, req, resp,
+					    NO_VAL16, NULL, NULL);
+}
+
+/* Send an RPC to the SlurmDBD and hand each reply of type part_type to
+ * part_cb until a reply of any other type arrives, see slurmdbd_agent.h
+ * Returns SLURM_SUCCESS or an error code */
+extern int send_recv_slurmdbd_msg_parts(uint16_t rpc_version,
+					persist_msg_t *req,
+					persist_msg_t *resp,
+					uint16_t part_type,
+					int (*part_cb)(persist_msg_t *part,
+						       void *arg),
+					void *arg)
+{
+	int rc = SLURM_SUCCESS, part_rc = SLURM_SUCCESS;
+	uint32_t part_cnt = 0;
 	Buf buffer;
 	slurm_persist_conn_t *use_conn;
 
@@ -1093,6 +1557,7 @@ extern int send_recv_slurmdbd_msg(uint16_t rpc_version,
 		goto end_it;
 	}
 
+next_part:
 	buffer = slurm_persist_recv_msg(use_conn);
 	if (buffer == NULL) {
 		error("Getting response to message type: %s",
@@ -1102,18 +1567,29 @@ extern int send_recv_slurmdbd_msg(uint16_t rpc_version,
 	}
 
 	rc = unpack_slurmdbd_msg(resp, rpc_version, buffer);
+	free_buf(buffer);
+	if ((rc == SLURM_SUCCESS) && part_cb && (resp->msg_type == part_type)) {
+		part_cnt++;
+		if (part_rc == SLURM_SUCCESS)
+			part_rc = (*part_cb)(resp, arg);
+		slurmdbd_free_msg(resp);
+		memset(resp, 0, sizeof(*resp));
+		goto next_part;
+	}
 	/* check for the rc of the start job message */
 	if (rc == SLURM_SUCCESS && resp->msg_type == DBD_ID_RC)
 		rc = ((dbd_id_rc_msg_t *)resp->data)->return_code;
+	if (rc == SLURM_SUCCESS)
+		rc = part_rc;
 
-	free_buf(buffer);
 end_it:
 	slurm_cond_signal(&slurmdbd_cond);
 	slurm_mutex_unlock(&slurmdbd_lock);
 
-	log_flag(PROTOCOL, "msg_type:%s protocol_version:%hu return_code:%d response_msg_type:%s",
+	log_flag(PROTOCOL, "msg_type:%s protocol_version:%hu return_code:%d response_msg_type:%s parts:%u",
 		 slurmdbd_msg_type_2_str(req->msg_type, 1),
-		 rpc_version, rc, slurmdbd_msg_type_2_str(resp->msg_type, 1));
+		 rpc_version, rc, slurmdbd_msg_type_2_str(resp->msg_type, 1),
+		 part_cnt);
 
 	return rc;
 }
@@ -1213,6 +1689,8 @@ extern int send_slurmdbd_msg(uint16_t rpc_version, persist_msg_t *req)
 		}
 	}
 	cnt = list_count(agent_list);
+	if (spool_open)
+		cnt += slurmdbd_spool_unread();
 	if ((cnt >= (slurm_conf.max_dbd_msgs / 2)) &&
 	    (difftime(time(NULL), syslog_time) > 120)) {
 		/* Record critical error every 120 seconds */
@@ -1226,9 +1704,10 @@ extern int send_slurmdbd_msg(uint16_t rpc_version, persist_msg_t *req)
 	/* Handle action */
 	_max_dbd_msg_action(&cnt);
 
-	if (cnt < slurm_conf.max_dbd_msgs) {
-		if (list_enqueue(agent_list, buffer) == NULL)
-			fatal("list_enqueue: memory allocation failure");
+	if (((cnt < slurm_conf.max_dbd_msgs) ||
+	     (max_dbd_msg_action == MAX_DBD_ACTION_SPOOL)) &&
+	    (_agent_enqueue(buffer) == SLURM_SUCCESS)) {
+		;	/* queued or spooled */
 	} else {
 		error("agent queue is full (%u), discarding %s:%u request",
 		      cnt,
@@ -1255,7 +1734,15 @@ extern bool slurmdbd_conn_active(void)
 
 extern int slurmdbd_agent_queue_count(void)
 {
-	return list_count(agent_list);
+	int cnt;
+
+	slurm_mutex_lock(&agent_lock);
+	cnt = list_count(agent_list);
+	if (spool_open)
+		cnt += slurmdbd_spool_unread();
+	slurm_mutex_unlock(&agent_lock);
+
+	return cnt;
 }
 
 extern void slurmdbd_agent_config_setup(void)
@@ -1282,10 +1769,25 @@ extern void slurmdbd_agent_config_setup(void)
 			max_dbd_msg_action = MAX_DBD_ACTION_DISCARD;
 		else if (!xstrcasecmp(type, "exit"))
 			max_dbd_msg_action = MAX_DBD_ACTION_EXIT;
+		else if (!xstrcasecmp(type, "spool"))
+			max_dbd_msg_action = MAX_DBD_ACTION_SPOOL;
 		else
 			fatal("Unknown SlurmctldParameters option for max_dbd_msg_action '%s'",
 			      type);
 		xfree(type);
 	} else
 		max_dbd_msg_action = MAX_DBD_DEFAULT_ACTION;
+
+	/*                          0123456789012345 */
+	if ((tmp_ptr = xstrcasestr(slurm_conf.slurmctld_params,
+				   "dbd_agent_conns="))) {
+		int i = atoi(tmp_ptr + 16);
+		if ((i < 1) || (i > MAX_AGENT_CONNS)) {
+			error("SlurmctldParameters option dbd_agent_conns=%d out of range, using %d",
+			      i, MIN(MAX(i, 1), MAX_AGENT_CONNS));
+			i = MIN(MAX(i, 1), MAX_AGENT_CONNS);
+		}
+		agent_conn_cnt = i;
+	} else
+		agent_conn_cnt = 1;
 }
@@ -65,6 +65,19 @@ extern int send_recv_slurmdbd_msg(uint16_t rpc_version,
 				  persist_msg_t *req,
 				  persist_msg_t *resp);
 
+/* Same as send_recv_slurmdbd_msg(), but every reply of type part_type is
+ * handed to part_cb and freed, until a reply of any other type arrives.
+ * That last reply is returned in "resp". Once part_cb fails the remaining
+ * parts are read and dropped, its return code is returned.
+ * Returns SLURM_SUCCESS or an error code */
+extern int send_recv_slurmdbd_msg_parts(uint16_t rpc_version,
+					persist_msg_t *req,
+					persist_msg_t *resp,
+					uint16_t part_type,
+					int (*part_cb)(persist_msg_t *part,
+						       void *arg),
+					void *arg);
+
 /* Send an RPC to the SlurmDBD and wait for the return code reply.
  * The RPC will not be queued if an error occurs.
  * Returns SLURM_SUCCESS or an error code */
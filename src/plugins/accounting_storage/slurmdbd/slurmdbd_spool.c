@@ -0,0 +1,545 @@
+/****************************************************************************\
+ *  slurmdbd_spool.c - on-disk spool of messages pending for the SlurmDBD
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "src/common/slurm_xlator.h"
+
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+
+#include "src/common/fd.h"
+#include "src/common/xstring.h"
+
+#include "slurmdbd_spool.h"
+
+#define SPOOL_MAGIC		0xDEAD3219	/* same as dbd.messages */
+#define SPOOL_CURSOR_MAGIC	0x53504f4f
+#define SPOOL_SEG_SIZE		(64 * 1024 * 1024)
+#define SPOOL_REC_HDR		(2 * sizeof(uint32_t))	/* size + magic */
+#define SPOOL_REPLAY_LOG_CNT	10000
+
+typedef struct {
+	uint32_t magic;
+	uint32_t seg;
+	uint64_t offset;
+} spool_cursor_t;
+
+typedef struct {
+	uint32_t seg;		/* segment the record was read from */
+	uint64_t end;		/* offset just past the record */
+} spool_pos_t;
+
+static char *spool_dir = NULL;
+static int cursor_fd = -1;
+static bool cursor_dirty = false;
+
+static uint32_t ack_seg = 0;	/* first record not acknowledged */
+static uint64_t ack_off = 0;
+
+static uint32_t rd_seg = 0;	/* next record to read */
+static uint64_t rd_off = 0;
+static char *rd_map = NULL;
+static size_t rd_map_len = 0;
+
+static uint32_t wr_seg = 0;	/* segment appended to */
+static uint64_t wr_off = 0;
+static int wr_fd = -1;
+
+static uint32_t unsynced_cnt = 0;	/* appended since the last sync */
+static time_t unsynced_time = 0;	/* when the oldest was appended */
+
+static uint32_t unread_cnt = 0;
+static List inflight_list = NULL;	/* spool_pos_t of read records */
+
+static struct timeval replay_start;
+static uint32_t replay_cnt = 0;
+static uint64_t replay_bytes = 0;
+
+static char *_seg_name(uint32_t seg)
+{
+	return xstrdup_printf("%s/seg.%010u", spool_dir, seg);
+}
+
+static void _unmap_rd(void)
+{
+	if (rd_map)
+		(void) munmap(rd_map, rd_map_len);
+	rd_map = NULL;
+	rd_map_len = 0;
+}
+
+/* Map the whole segment read only, a segment being appended to is remapped
+ * once the reader catches up with what was mapped. */
+static int _map_seg(uint32_t seg, char **map, size_t *len)
+{
+	char *fname = _seg_name(seg);
+	struct stat st;
+	int fd;
+
+	*map = NULL;
+	*len = 0;
+	if ((fd = open(fname, O_RDONLY | O_CLOEXEC)) < 0) {
+		if (errno != ENOENT)
+			error("%s: open(%s): %m", __func__, fname);
+		xfree(fname);
+		return SLURM_ERROR;
+	}
+	if (fstat(fd, &st) < 0) {
+		error("%s: fstat(%s): %m", __func__, fname);
+		(void) close(fd);
+		xfree(fname);
+		return SLURM_ERROR;
+	}
+	if (st.st_size) {
+		*map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (*map == MAP_FAILED) {
+			error("%s: mmap(%s): %m", __func__, fname);
+			*map = NULL;
+			(void) close(fd);
+			xfree(fname);
+			return SLURM_ERROR;
+		}
+		*len = st.st_size;
+	}
+	(void) close(fd);
+	xfree(fname);
+	return SLURM_SUCCESS;
+}
+
+/* Return the size of the valid record at "off" in "map" or 0 if there is
+ * no complete record there. */
+static uint32_t _rec_size(char *map, size_t len, uint64_t off)
+{
+	uint32_t size, magic;
+
+	if ((off + SPOOL_REC_HDR) > len)
+		return 0;
+	memcpy(&size, map + off, sizeof(size));
+	if ((size > SPOOL_SEG_SIZE) || ((off + SPOOL_REC_HDR + size) > len))
+		return 0;
+	memcpy(&magic, map + off + sizeof(size) + size, sizeof(magic));
+	if (magic != SPOOL_MAGIC)
+		return 0;
+	return size;
+}
+
+/* Count the complete records in segment "seg" from "off" on.
+ * RET offset just past the last complete record */
+static uint64_t _scan_seg(uint32_t seg, uint64_t off, uint32_t *cnt)
+{
+	char *map;
+	size_t len;
+	uint32_t size;
+
+	if (_map_seg(seg, &map, &len) != SLURM_SUCCESS)
+		return off;
+	while ((size = _rec_size(map, len, off))) {
+		off += SPOOL_REC_HDR + size;
+		(*cnt)++;
+	}
+	if (off < len)
+		error("%s: segment %u has %"PRIu64" bytes of incomplete data at offset %"PRIu64,
+		      __func__, seg, (uint64_t) (len - off), off);
+	if (map)
+		(void) munmap(map, len);
+	return off;
+}
+
+/* Make sure the directory entry of a new segment is on disk */
+static void _sync_dir(void)
+{
+	int fd;
+
+	if ((fd = open(spool_dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) < 0) {
+		error("%s: open(%s): %m", __func__, spool_dir);
+		return;
+	}
+	if (fsync(fd) < 0)
+		error("%s: fsync(%s): %m", __func__, spool_dir);
+	(void) close(fd);
+}
+
+static int _open_wr_seg(bool trunc)
+{
+	char *fname = _seg_name(wr_seg);
+	int flags = O_WRONLY | O_CREAT | O_CLOEXEC;
+
+	if (wr_fd >= 0)
+		(void) close(wr_fd);
+	if (trunc)
+		flags |= O_TRUNC;
+	if ((wr_fd = open(fname, flags, 0600)) < 0) {
+		error("%s: open(%s): %m", __func__, fname);
+		xfree(fname);
+		return SLURM_ERROR;
+	}
+	/* Drop anything a crash left behind a partially written record */
+	if (!trunc && (ftruncate(wr_fd, wr_off) < 0))
+		error("%s: ftruncate(%s): %m", __func__, fname);
+	xfree(fname);
+	_sync_dir();
+	return SLURM_SUCCESS;
+}
+
+static void _remove_segs(uint32_t first, uint32_t last)
+{
+	char *fname;
+
+	for (uint32_t seg = first; seg < last; seg++) {
+		fname = _seg_name(seg);
+		if ((unlink(fname) < 0) && (errno != ENOENT))
+			error("%s: unlink(%s): %m", __func__, fname);
+		xfree(fname);
+	}
+}
+
+static void _write_cursor(void)
+{
+	spool_cursor_t cursor = {
+		.magic = SPOOL_CURSOR_MAGIC,
+		.seg = ack_seg,
+		.offset = ack_off,
+	};
+
+	if (cursor_fd < 0)
+		return;
+	if (pwrite(cursor_fd, &cursor, sizeof(cursor), 0) != sizeof(cursor))
+		error("%s: unable to save spool cursor: %m", __func__);
+	cursor_dirty = false;
+}
+
+/* Everything was acknowledged, start over with an empty segment */
+static void _spool_drained(void)
+{
+	struct timeval now;
+	double secs;
+
+	gettimeofday(&now, NULL);
+	secs = (now.tv_sec - replay_start.tv_sec) +
+		((now.tv_usec - replay_start.tv_usec) / 1000000.0);
+	if (replay_cnt >= SPOOL_REPLAY_LOG_CNT)
+		info("slurmdbd spool drained: replayed %u records (%"PRIu64" bytes) in %.1f seconds, %.0f records/sec",
+		     replay_cnt, replay_bytes, secs,
+		     (secs > 0) ? (replay_cnt / secs) : 0.0);
+	else
+		log_flag(AGENT, "slurmdbd spool drained: replayed %u records (%"PRIu64" bytes) in %.1f seconds",
+			 replay_cnt, replay_bytes, secs);
+	replay_cnt = 0;
+	replay_bytes = 0;
+
+	_unmap_rd();
+	_remove_segs(ack_seg, wr_seg + 1);
+	ack_seg = rd_seg = ++wr_seg;
+	ack_off = rd_off = wr_off = 0;
+	(void) _open_wr_seg(true);
+	_write_cursor();
+}
+
+extern int slurmdbd_spool_open(char *dir, bool create)
+{
+	spool_cursor_t cursor;
+	DIR *dp;
+	struct dirent *ent;
+	uint32_t seg, min_seg = NO_VAL, max_seg = 0;
+	char *fname;
+
+	if (spool_dir)
+		return SLURM_SUCCESS;
+
+	if (create && (mkdir(dir, 0700) < 0) && (errno != EEXIST)) {
+		error("%s: mkdir(%s): %m", __func__, dir);
+		return errno;
+	}
+	if (!(dp = opendir(dir))) {
+		if (errno != ENOENT)
+			error("%s: opendir(%s): %m", __func__, dir);
+		return errno;
+	}
+	while ((ent = readdir(dp))) {
+		if (sscanf(ent->d_name, "seg.%u", &seg) != 1)
+			continue;
+		min_seg = MIN(min_seg, seg);
+		max_seg = MAX(max_seg, seg);
+	}
+	closedir(dp);
+	spool_dir = xstrdup(dir);
+
+	fname = xstrdup_printf("%s/cursor", spool_dir);
+	if ((cursor_fd = open(fname, O_RDWR | O_CREAT | O_CLOEXEC, 0600)) < 0)
+		error("%s: open(%s): %m", __func__, fname);
+	xfree(fname);
+
+	if (min_seg == NO_VAL) {
+		/* Empty spool */
+		ack_seg = max_seg;
+		ack_off = 0;
+	} else if ((cursor_fd >= 0) &&
+		   (pread(cursor_fd, &cursor, sizeof(cursor), 0) ==
+		    sizeof(cursor)) &&
+		   (cursor.magic == SPOOL_CURSOR_MAGIC) &&
+		   (cursor.seg >= min_seg) && (cursor.seg <= max_seg)) {
+		ack_seg = cursor.seg;
+		ack_off = cursor.offset;
+	} else {
+		ack_seg = min_seg;
+		ack_off = 0;
+	}
+	_remove_segs(MIN(min_seg, ack_seg), ack_seg);
+
+	/* Count what is left and find the end of the last segment */
+	unread_cnt = 0;
+	wr_off = ack_off;
+	for (seg = ack_seg; seg <= max_seg; seg++)
+		wr_off = _scan_seg(seg, (seg == ack_seg) ? ack_off : 0,
+				   &unread_cnt);
+	wr_seg = MAX(ack_seg, max_seg);
+	rd_seg = ack_seg;
+	rd_off = ack_off;
+	inflight_list = list_create(xfree_ptr);
+
+	if (_open_wr_seg(false) != SLURM_SUCCESS) {
+		slurmdbd_spool_close();
+		return SLURM_ERROR;
+	}
+	_write_cursor();
+
+	if (unread_cnt)
+		info("slurmdbd spool %s has %u pending records",
+		     spool_dir, unread_cnt);
+	else
+		debug("slurmdbd spool %s opened", spool_dir);
+	return SLURM_SUCCESS;
+}
+
+extern void slurmdbd_spool_close(void)
+{
+	if (!spool_dir)
+		return;
+
+	_write_cursor();
+	if (cursor_fd >= 0)
+		(void) fsync_and_close(cursor_fd, "slurmdbd spool cursor");
+	if (wr_fd >= 0)
+		(void) fsync_and_close(wr_fd, "slurmdbd spool");
+	cursor_fd = wr_fd = -1;
+	unsynced_cnt = 0;
+	_unmap_rd();
+	FREE_NULL_LIST(inflight_list);
+	unread_cnt = 0;
+	xfree(spool_dir);
+}
+
+extern int slurmdbd_spool_append(Buf buffer)
+{
+	uint32_t size = get_buf_offset(buffer), magic = SPOOL_MAGIC;
+	struct iovec iov[3];
+	ssize_t wrote;
+
+	if (!spool_dir || (wr_fd < 0))
+		return SLURM_ERROR;
+
+	if (wr_off && ((wr_off + SPOOL_REC_HDR + size) > SPOOL_SEG_SIZE)) {
+		/* The old segment is complete, make sure it is on disk */
+		if (fsync(wr_fd) < 0)
+			error("%s: fsync: %m", __func__);
+		unsynced_cnt = 0;
+		wr_seg++;
+		wr_off = 0;
+		if (_open_wr_seg(true) != SLURM_SUCCESS)
+			return SLURM_ERROR;
+	}
+
+	iov[0].iov_base = &size;
+	iov[0].iov_len = sizeof(size);
+	iov[1].iov_base = get_buf_data(buffer);
+	iov[1].iov_len = size;
+	iov[2].iov_base = &magic;
+	iov[2].iov_len = sizeof(magic);
+
+	do {
+		wrote = pwritev(wr_fd, iov, 3, wr_off);
+	} while ((wrote < 0) && (errno == EINTR));
+
+	if (wrote != (SPOOL_REC_HDR + size)) {
+		if (wrote < 0)
+			error("%s: unable to spool message: %m", __func__);
+		else
+			error("%s: short write spooling message", __func__);
+		/* Don't leave a partial record behind */
+		if (ftruncate(wr_fd, wr_off) < 0)
+			error("%s: ftruncate: %m", __func__);
+		return SLURM_ERROR;
+	}
+
+	/* Synced by the agent in batches, see slurmdbd_spool_sync() */
+	if (!unsynced_cnt++)
+		unsynced_time = time(NULL);
+
+	wr_off += wrote;
+	unread_cnt++;
+	return SLURM_SUCCESS;
+}
+
+extern Buf slurmdbd_spool_read(void)
+{
+	spool_pos_t *pos;
+	uint32_t size;
+	Buf buffer;
+
+	while (unread_cnt) {
+		if ((rd_off + SPOOL_REC_HDR) > rd_map_len) {
+			/* Reached the end of what was mapped */
+			_unmap_rd();
+			if (_map_seg(rd_seg, &rd_map, &rd_map_len) !=
+			    SLURM_SUCCESS) {
+				rd_map = NULL;
+				rd_map_len = 0;
+			}
+		}
+
+		if ((size = _rec_size(rd_map, rd_map_len, rd_off)))
+			break;
+
+		if (rd_seg >= wr_seg) {
+			error("%s: %u spooled records lost", __func__,
+			      unread_cnt);
+			unread_cnt = 0;
+			return NULL;
+		}
+		if (rd_off < rd_map_len)
+			error("%s: skipping bad data at end of segment %u",
+			      __func__, rd_seg);
+		_unmap_rd();
+		rd_seg++;
+		rd_off = 0;
+	}
+	if (!unread_cnt)
+		return NULL;
+
+	if (!replay_cnt && !list_count(inflight_list))
+		gettimeofday(&replay_start, NULL);
+
+	buffer = init_buf(size);
+	memcpy(get_buf_data(buffer), rd_map + rd_off + sizeof(size), size);
+	set_buf_offset(buffer, size);
+	rd_off += SPOOL_REC_HDR + size;
+	unread_cnt--;
+
+	pos = xmalloc(sizeof(*pos));
+	pos->seg = rd_seg;
+	pos->end = rd_off;
+	list_enqueue(inflight_list, pos);
+
+	return buffer;
+}
+
+extern void slurmdbd_spool_ack(void)
+{
+	spool_pos_t *pos;
+	uint64_t size;
+
+	if (!inflight_list || !(pos = list_dequeue(inflight_list)))
+		return;
+
+	if (pos->seg != ack_seg) {
+		_remove_segs(ack_seg, pos->seg);
+		ack_off = 0;
+		size = pos->end;
+	} else
+		size = pos->end - ack_off;
+	ack_seg = pos->seg;
+	ack_off = pos->end;
+	xfree(pos);
+	cursor_dirty = true;
+
+	replay_cnt++;
+	replay_bytes += size;
+	if (!(replay_cnt % SPOOL_REPLAY_LOG_CNT))
+		log_flag(AGENT, "slurmdbd spool replayed %u records, %u pending",
+			 replay_cnt, unread_cnt + list_count(inflight_list));
+
+	if (!unread_cnt && !list_count(inflight_list))
+		_spool_drained();
+}
+
+extern int slurmdbd_spool_sync(void)
+{
+	int fd;
+
+	if (cursor_dirty)
+		_write_cursor();
+
+	if (!unsynced_cnt || (wr_fd < 0))
+		return -1;
+	if ((unsynced_cnt < SPOOL_SYNC_CNT) &&
+	    (difftime(time(NULL), unsynced_time) < SPOOL_SYNC_TIME))
+		return -1;
+
+	/* A duplicate, the segment may roll over while it is synced */
+	if ((fd = dup(wr_fd)) < 0) {
+		error("%s: dup: %m", __func__);
+		return -1;
+	}
+	unsynced_cnt = 0;
+	return fd;
+}
+
+extern void slurmdbd_spool_flush(int fd)
+{
+	if (fd < 0)
+		return;
+	if (fdatasync(fd) < 0)
+		error("%s: fdatasync: %m", __func__);
+	(void) close(fd);
+}
+
+extern uint32_t slurmdbd_spool_unsynced(void)
+{
+	return unsynced_cnt;
+}
+
+extern uint32_t slurmdbd_spool_unread(void)
+{
+	return unread_cnt;
+}
+
+extern uint32_t slurmdbd_spool_inflight(void)
+{
+	if (!inflight_list)
+		return 0;
+	return list_count(inflight_list);
+}
@@ -0,0 +1,101 @@
+/****************************************************************************\
+ *  slurmdbd_spool.h - on-disk spool of messages pending for the SlurmDBD
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _SLURMDBD_SPOOL_H
+#define _SLURMDBD_SPOOL_H
+
+#include "src/common/pack.h"
+
+#define SPOOL_SYNC_CNT	1000	/* sync after this many appended records */
+#define SPOOL_SYNC_TIME	1	/* or when the oldest is this many seconds old */
+
+/*
+ * The spool is a directory of append-only segment files holding packed
+ * messages in the same record format as dbd.messages. Records are read back
+ * in order through an mmap of the oldest segment. A cursor file remembers
+ * the first record not yet acknowledged by the SlurmDBD, so after a crash
+ * or restart reading starts over from there.
+ *
+ * Appended records are synced to disk in batches by the agent thread rather
+ * than one by one, so the callers of send_slurmdbd_msg() never wait for the
+ * disk. A crash of slurmctld loses nothing, the records are in the page
+ * cache, but a crash of the host loses the records appended since the last
+ * sync: at most SPOOL_SYNC_CNT records or SPOOL_SYNC_TIME seconds of them.
+ *
+ * Except for slurmdbd_spool_flush() none of these functions are thread safe,
+ * the caller must serialize them (the agent holds agent_lock).
+ */
+
+/* Open the spool in directory "dir", creating it if "create" is set.
+ * Returns SLURM_SUCCESS or an error code (ENOENT if the directory does not
+ * exist and create is not set) */
+extern int slurmdbd_spool_open(char *dir, bool create);
+
+/* Save the cursor, sync and close the spool. Records read but not yet
+ * acknowledged will be read again after the next open. */
+extern void slurmdbd_spool_close(void);
+
+/* Append a packed message to the spool, the buffer is not consumed. The
+ * record is only written, it reaches the disk with the next
+ * slurmdbd_spool_sync() that returns a descriptor or at close.
+ * Returns SLURM_SUCCESS or an error code */
+extern int slurmdbd_spool_append(Buf buffer);
+
+/* Return a copy of the next unread record or NULL if there is none */
+extern Buf slurmdbd_spool_read(void);
+
+/* Acknowledge the oldest record returned by slurmdbd_spool_read() */
+extern void slurmdbd_spool_ack(void);
+
+/* Write the cursor out if records were acknowledged since the last call.
+ * If SPOOL_SYNC_CNT records were appended since the last sync or the oldest
+ * of them SPOOL_SYNC_TIME seconds ago, return a descriptor to pass to
+ * slurmdbd_spool_flush(), otherwise -1. */
+extern int slurmdbd_spool_sync(void);
+
+/* fdatasync() and close a descriptor from slurmdbd_spool_sync(), meant to be
+ * called without holding agent_lock */
+extern void slurmdbd_spool_flush(int fd);
+
+/* Number of records appended but not synced yet */
+extern uint32_t slurmdbd_spool_unsynced(void);
+
+/* Number of records appended but not read yet */
+extern uint32_t slurmdbd_spool_unread(void);
+
+/* Number of records read but not acknowledged yet */
+extern uint32_t slurmdbd_spool_inflight(void);
+
+#endif
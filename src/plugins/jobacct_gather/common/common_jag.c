@@ -43,6 +43,7 @@
 #include <signal.h>
 #include <time.h>
 #include <ctype.h>
+#include <sys/resource.h>
 
 #include "src/common/slurm_xlator.h"
 #include "src/common/assoc_mgr.h"
@@ -78,6 +79,34 @@ static int my_pagesize = 0;
 static DIR  *slash_proc = NULL;
 static int energy_profile = ENERGY_DATA_NODE_ENERGY_UP;
 
+/*
+ * Per-PID polling state. Each sample is parsed into scratch_prec and only
+ * copied into the record kept in prec_list if every read succeeded, so a
+ * failed sample never leaves a half updated record behind.
+ */
+static jag_prec_t scratch_prec = {
+	.stat_fd = -1, .statm_fd = -1, .io_fd = -1
+};
+static uint32_t poll_seq = 0;
+static int cached_fds = 0;
+static int max_cached_fds = 0;
+
+/*
+ * What the last poll found for each pid of the proctrack container. While
+ * the container holds the same pids the records are used as they are and
+ * threads are not checked again, instead of looking every pid up in
+ * prec_list and opening /proc for every thread on each poll. A pid of the
+ * set that is reused without the set changing is picked up once it does.
+ */
+typedef struct {
+	pid_t pid;
+	jag_prec_t *prec;	/* record of the process, NULL if none yet */
+	bool lwp;		/* a thread, accounted with its process */
+} jag_pid_t;
+
+static jag_pid_t *last_pids = NULL;
+static int last_npids = 0;
+
 static int _find_prec(void *x, void *key)
 {
 	jag_prec_t *prec = (jag_prec_t *) x;
@@ -300,7 +329,7 @@ again:
 
 /* _get_process_data_line() - get line of data from /proc/<pid>/stat
  *
- * IN:	in - input file descriptor
+ * IN:	in - input file descriptor, read from offset 0 so it may be reused
  * OUT:	prec - the destination for the data
  *
  * RETVAL:	==0 - no valid data
@@ -322,7 +351,7 @@ static int _get_process_data_line(int in, jag_prec_t *prec) {
 	long unsigned f1, f2, f3, f4, f5, f6, f7, f8, f9, f10, f11, f12, f13;
 	int exit_signal, last_cpu;
 
-	num_read = read(in, sbuf, (sizeof(sbuf) - 1));
+	num_read = pread(in, sbuf, (sizeof(sbuf) - 1), 0);
 	if (num_read <= 0)
 		return 0;
 	sbuf[num_read] = '\0';
@@ -358,14 +387,6 @@ static int _get_process_data_line(int in, jag_prec_t *prec) {
 	if ((nvals < 37) || (rss < 0))
 		return 0;
 
-	/*
-	 * If current pid corresponds to a Light Weight Process (Thread POSIX)
-	 * or there was an error, skip it, we will only account the original
-	 * process (pid==tgid).
-	 */
-	if (_is_a_lwp(prec->pid))
-		return 0;
-
 	/* Copy the values that slurm records into our data structure */
 	prec->ppid  = ppid;
 
@@ -402,7 +423,7 @@ static int _get_process_memory_line(int in, jag_prec_t *prec)
 	int num_read, nvals;
 	long int size, rss, share, text, lib, data, dt;
 
-	num_read = read(in, sbuf, (sizeof(sbuf) - 1));
+	num_read = pread(in, sbuf, (sizeof(sbuf) - 1), 0);
 	if (num_read <= 0)
 		return 0;
 	sbuf[num_read] = '\0';
@@ -427,24 +448,6 @@ static int _get_process_memory_line(int in, jag_prec_t *prec)
 	return 1;
 }
 
-static int _remove_share_data(char *proc_stat_file, jag_prec_t *prec)
-{
-	FILE *statm_fp = NULL;
-	char proc_statm_file[256];	/* Allow ~20x extra length */
-	int rc = 0, fd;
-
-	snprintf(proc_statm_file, sizeof(proc_statm_file), "%sm",
-		 proc_stat_file);
-	if (!(statm_fp = fopen(proc_statm_file, "r")))
-		return rc;  /* Assume the process went away */
-	fd = fileno(statm_fp);
-	if (fcntl(fd, F_SETFD, FD_CLOEXEC) == -1)
-		error("%s: fcntl(%s): %m", __func__, proc_statm_file);
-	rc = _get_process_memory_line(fd, prec);
-	fclose(statm_fp);
-	return rc;
-}
-
 /* _get_process_io_data_line() - get line of data from /proc/<pid>/io
  *
  * IN:	in - input file descriptor
@@ -464,7 +467,7 @@ static int _get_process_io_data_line(int in, jag_prec_t *prec) {
 	int num_read, nvals;
 	uint64_t rchar, wchar;
 
-	num_read = read(in, sbuf, (sizeof(sbuf) - 1));
+	num_read = pread(in, sbuf, (sizeof(sbuf) - 1), 0);
 	if (num_read <= 0)
 		return 0;
 	sbuf[num_read] = '\0';
@@ -474,9 +477,6 @@ static int _get_process_io_data_line(int in, jag_prec_t *prec) {
 	if (nvals < 4)
 		return 0;
 
-	if (_is_a_lwp(prec->pid))
-		return 0;
-
 	/* keep real value here since we aren't doubles */
 	prec->tres_data[TRES_ARRAY_FS_DISK].size_read = rchar;
 	prec->tres_data[TRES_ARRAY_FS_DISK].size_write = wchar;
@@ -484,16 +484,124 @@ static int _get_process_io_data_line(int in, jag_prec_t *prec) {
 	return 1;
 }
 
-static void _handle_stats(char *proc_stat_file, char *proc_io_file,
-			  char *proc_smaps_file, jag_callbacks_t *callbacks,
-			  int tres_count)
+static int _proc_open(pid_t pid, const char *file)
+{
+	char path[256];	/* Allow ~20x extra length */
+
+	snprintf(path, sizeof(path), "/proc/%d/%s", pid, file);
+
+	/*
+	 * Close the file on exec() of user tasks. Use O_CLOEXEC rather than
+	 * fcntl() so a fork() of slurmstepd can never leak the descriptor to
+	 * a user task, this matters now that the descriptors stay open.
+	 */
+	return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+static void _proc_close(int *fd, bool cached)
+{
+	if (*fd < 0)
+		return;
+
+	(void) close(*fd);
+	*fd = -1;
+	if (cached)
+		cached_fds--;
+}
+
+static void _close_prec_fds(jag_prec_t *prec)
+{
+	_proc_close(&prec->stat_fd, true);
+	_proc_close(&prec->statm_fd, true);
+	_proc_close(&prec->io_fd, true);
+}
+
+/* Close the files of any process that left the proctrack container */
+static int _close_stale_fds(void *x, void *arg)
+{
+	jag_prec_t *prec = (jag_prec_t *) x;
+
+	if (prec->poll_seq != poll_seq)
+		_close_prec_fds(prec);
+
+	return 0;
+}
+
+/*
+ * Hand a freshly opened descriptor over to prec so it is reused on the next
+ * poll, or close it if caching is off or we are running short on descriptors.
+ */
+static void _cache_fd(int *fd, int *prec_fd, bool cache_fds)
+{
+	if (*fd < 0)
+		return;
+
+	if (cache_fds && (cached_fds < max_cached_fds)) {
+		*prec_fd = *fd;
+		*fd = -1;
+		cached_fds++;
+	} else
+		_proc_close(fd, false);
+}
+
+static void _reset_scratch_prec(int tres_count)
+{
+	int i;
+
+	if (scratch_prec.tres_count != tres_count) {
+		xrealloc(scratch_prec.tres_data,
+			 tres_count * sizeof(acct_gather_data_t));
+		scratch_prec.tres_count = tres_count;
+	}
+
+	/* Initialize read/writes */
+	for (i = 0; i < tres_count; i++) {
+		scratch_prec.tres_data[i].num_reads = INFINITE64;
+		scratch_prec.tres_data[i].num_writes = INFINITE64;
+		scratch_prec.tres_data[i].size_read = INFINITE64;
+		scratch_prec.tres_data[i].size_write = INFINITE64;
+	}
+}
+
+/* Copy a successful sample into the long lived record for the process */
+static void _update_prec(jag_prec_t *prec, jag_prec_t *sample)
+{
+	if (prec->tres_count != sample->tres_count) {
+		xrealloc(prec->tres_data,
+			 sample->tres_count * sizeof(acct_gather_data_t));
+		prec->tres_count = sample->tres_count;
+	}
+	memcpy(prec->tres_data, sample->tres_data,
+	       prec->tres_count * sizeof(acct_gather_data_t));
+
+	prec->pid = sample->pid;
+	prec->ppid = sample->ppid;
+	prec->usec = sample->usec;
+	prec->ssec = sample->ssec;
+	prec->last_cpu = sample->last_cpu;
+	prec->poll_seq = poll_seq;
+}
+
+/*
+ * Sample /proc/<pid>/{stat,statm,io,smaps} for one process.
+ *
+ * With cache_fds set (per-PID polling) the descriptors are kept in the
+ * process record and refreshed with pread() on later polls, and the record
+ * itself is reused, so a process that was already known costs no open() and
+ * no allocation. Scanning all of /proc (pgid plugins) would pin a descriptor
+ * for every process on the node, so there the files are closed again.
+ */
+static void _handle_stats(pid_t pid, jag_callbacks_t *callbacks,
+			  int tres_count, bool cache_fds, jag_pid_t *known)
 {
 	static int no_share_data = -1;
 	static int use_pss = -1;
-	FILE *stat_fp = NULL;
-	FILE *io_fp = NULL;
-	int fd, fd2, i;
-	jag_prec_t *prec = NULL;
+	int stat_fd = -1, statm_fd = -1, io_fd = -1;
+	bool retried = false;
+	jag_prec_t *prec = NULL, *sample = &scratch_prec;
+
+	if (known && known->lwp)
+		return;
 
 	if (no_share_data == -1) {
 		if (xstrcasestr(slurm_conf.job_acct_gather_params, "NoShare"))
@@ -507,24 +615,6 @@ static void _handle_stats(char *proc_stat_file, char *proc_io_file,
 			use_pss = 0;
 	}
 
-	if (!(stat_fp = fopen(proc_stat_file, "r")))
-		return;  /* Assume the process went away */
-	/*
-	 * Close the file on exec() of user tasks.
-	 *
-	 * NOTE: If we fork() slurmstepd after the
-	 * fopen() above and before the fcntl() below,
-	 * then the user task may have this extra file
-	 * open, which can cause problems for
-	 * checkpoint/restart, but this should be a very rare
-	 * problem in practice.
-	 */
-	fd = fileno(stat_fp);
-	if (fcntl(fd, F_SETFD, FD_CLOEXEC) == -1)
-		error("%s: fcntl(%s): %m", __func__, proc_stat_file);
-
-	prec = xmalloc(sizeof(jag_prec_t));
-
 	if (!tres_count) {
 		assoc_mgr_lock_t locks = {
 			NO_LOCK, NO_LOCK, NO_LOCK, NO_LOCK,
@@ -534,68 +624,110 @@ static void _handle_stats(char *proc_stat_file, char *proc_io_file,
 		assoc_mgr_unlock(&locks);
 	}
 
-	prec->tres_count = tres_count;
-	prec->tres_data = xmalloc(prec->tres_count *
-				  sizeof(acct_gather_data_t));
+	if (!known || !(prec = known->prec))
+		prec = list_find_first(prec_list, _find_prec, &pid);
 
-	/* Initialize read/writes */
-	for (i = 0; i < prec->tres_count; i++) {
-		prec->tres_data[i].num_reads = INFINITE64;
-		prec->tres_data[i].num_writes = INFINITE64;
-		prec->tres_data[i].size_read = INFINITE64;
-		prec->tres_data[i].size_write = INFINITE64;
-	}
+again:
+	_reset_scratch_prec(tres_count);
 
-	if (!_get_process_data_line(fd, prec)) {
-		fclose(stat_fp);
-		goto bail_out;
-	}
+	if (prec && (prec->stat_fd >= 0)) {
+		/*
+		 * A cached descriptor is pinned to the process it was opened
+		 * for, so it has already passed the LWP check below. If the
+		 * process has exited, the read fails and we retry by path in
+		 * case the pid has been reused.
+		 */
+		if (!_get_process_data_line(prec->stat_fd, sample)) {
+			_close_prec_fds(prec);
+			if (retried)
+				return;
+			retried = true;
+			goto again;
+		}
+	} else {
+		if ((stat_fd = _proc_open(pid, "stat")) < 0)
+			return;  /* Assume the process went away */
+
+		if (!_get_process_data_line(stat_fd, sample))
+			goto bail_out;
 
-	fclose(stat_fp);
+		/*
+		 * If current pid corresponds to a Light Weight Process (Thread
+		 * POSIX) or there was an error, skip it, we will only account
+		 * the original process (pid==tgid).
+		 */
+		if (_is_a_lwp(pid)) {
+			if (known)
+				known->lwp = true;
+			goto bail_out;
+		}
+	}
 
-	if (acct_gather_filesystem_g_get_data(prec->tres_data) < 0) {
+	if (acct_gather_filesystem_g_get_data(sample->tres_data) < 0) {
 		debug2("problem retrieving filesystem data");
 	}
 
-	if (acct_gather_interconnect_g_get_data(prec->tres_data) < 0) {
+	if (acct_gather_interconnect_g_get_data(sample->tres_data) < 0) {
 		debug2("problem retrieving interconnect data");
 	}
 
 	/* Remove shared data from rss */
-	if (no_share_data && !_remove_share_data(proc_stat_file, prec))
-		goto bail_out;
+	if (no_share_data) {
+		int fd;
+
+		if (prec && (prec->statm_fd >= 0))
+			fd = prec->statm_fd;
+		else if ((fd = statm_fd = _proc_open(pid, "statm")) < 0)
+			goto bail_out;  /* Assume the process went away */
+
+		if (!_get_process_memory_line(fd, sample))
+			goto bail_out;
+	}
 
 	/* Use PSS instead if RSS */
-	if (use_pss && _get_pss(proc_smaps_file, prec) == -1)
-		goto bail_out;
-
-	if ((io_fp = fopen(proc_io_file, "r"))) {
-		fd2 = fileno(io_fp);
-		if (fcntl(fd2, F_SETFD, FD_CLOEXEC) == -1)
-			error("%s: fcntl: %m", __func__);
-		if (!_get_process_io_data_line(fd2, prec)) {
-			fclose(io_fp);
+	if (use_pss) {
+		char proc_smaps_file[256];	/* Allow ~20x extra length */
+
+		snprintf(proc_smaps_file, sizeof(proc_smaps_file),
+			 "/proc/%d/smaps", pid);
+		if (_get_pss(proc_smaps_file, sample) == -1)
+			goto bail_out;
+	}
+
+	if (prec && (prec->io_fd >= 0)) {
+		if (!_get_process_io_data_line(prec->io_fd, sample))
+			goto bail_out;
+	} else if ((io_fd = _proc_open(pid, "io")) >= 0) {
+		if (!_get_process_io_data_line(io_fd, sample))
 			goto bail_out;
-		}
-		fclose(io_fp);
 	}
 
-	destroy_jag_prec(list_remove_first(prec_list, _find_prec, &prec->pid));
-	list_append(prec_list, prec);
+	if (!prec) {
+		prec = xmalloc(sizeof(jag_prec_t));
+		prec->stat_fd = -1;
+		prec->statm_fd = -1;
+		prec->io_fd = -1;
+		list_append(prec_list, prec);
+	}
+	_update_prec(prec, sample);
+	if (known)
+		known->prec = prec;
+
+	_cache_fd(&stat_fd, &prec->stat_fd, cache_fds);
+	_cache_fd(&statm_fd, &prec->statm_fd, cache_fds);
+	_cache_fd(&io_fd, &prec->io_fd, cache_fds);
 	return;
 
 bail_out:
-	xfree(prec->tres_data);
-	xfree(prec);
+	_proc_close(&stat_fd, false);
+	_proc_close(&statm_fd, false);
+	_proc_close(&io_fd, false);
 	return;
 }
 
 static List _get_precs(List task_list, bool pgid_plugin, uint64_t cont_id,
 		       jag_callbacks_t *callbacks)
 {
-	char	proc_stat_file[256];	/* Allow ~20x extra length */
-	char	proc_io_file[256];	/* Allow ~20x extra length */
-	char	proc_smaps_file[256];	/* Allow ~20x extra length */
 	static	int	slash_proc_open = 0;
 	int i;
 	struct jobacctinfo *jobacct = NULL;
@@ -604,9 +736,12 @@ static List _get_precs(List task_list, bool pgid_plugin, uint64_t cont_id,
 
 	jobacct = list_peek(task_list);
 
+	poll_seq++;
+
 	if (!pgid_plugin) {
 		pid_t *pids = NULL;
 		int npids = 0;
+		bool same_pids;
 		/* get only the processes in the proctrack container */
 		proctrack_g_get_pids(cont_id, &pids, &npids);
 		if (!npids) {
@@ -628,20 +763,42 @@ static List _get_precs(List task_list, bool pgid_plugin, uint64_t cont_id,
 			}
 
 			debug4("no pids in this container %"PRIu64"", cont_id);
+			xfree(last_pids);
+			last_npids = 0;
+			(void) list_for_each(prec_list, _close_stale_fds, NULL);
 			goto finished;
 		}
-		for (i = 0; i < npids; i++) {
-			snprintf(proc_stat_file, 256, "/proc/%d/stat", pids[i]);
-			snprintf(proc_io_file, 256, "/proc/%d/io", pids[i]);
-			snprintf(proc_smaps_file, 256, "/proc/%d/smaps", pids[i]);
-			_handle_stats(proc_stat_file, proc_io_file,
-				      proc_smaps_file, callbacks,
-				      jobacct ? jobacct->tres_count : 0);
+		same_pids = (npids == last_npids);
+		for (i = 0; same_pids && (i < npids); i++)
+			same_pids = (pids[i] == last_pids[i].pid);
+		if (!same_pids) {
+			xrecalloc(last_pids, npids, sizeof(jag_pid_t));
+			for (i = 0; i < npids; i++) {
+				last_pids[i].pid = pids[i];
+				last_pids[i].prec = NULL;
+				last_pids[i].lwp = false;
+			}
+			last_npids = npids;
 		}
 		xfree(pids);
+
+		for (i = 0; i < npids; i++) {
+			_handle_stats(last_pids[i].pid, callbacks,
+				      jobacct ? jobacct->tres_count : 0, true,
+				      &last_pids[i]);
+		}
+
+		/*
+		 * Records of processes that have ended are kept so their
+		 * usage is still accounted, but their files are not needed.
+		 * None ended if the container holds the same pids.
+		 */
+		if (!same_pids)
+			(void) list_for_each(prec_list, _close_stale_fds,
+					     NULL);
 	} else {
 		struct dirent *slash_proc_entry;
-		char  *iptr = NULL, *optr = NULL, *optr2 = NULL;
+		char *iptr = NULL;
 
 		if (slash_proc_open) {
 			rewinddir(slash_proc);
@@ -653,25 +810,13 @@ static List _get_precs(List task_list, bool pgid_plugin, uint64_t cont_id,
 			}
 			slash_proc_open=1;
 		}
-		strcpy(proc_stat_file, "/proc/");
-		strcpy(proc_io_file, "/proc/");
-		strcpy(proc_smaps_file, "/proc/");
 
 		while ((slash_proc_entry = readdir(slash_proc))) {
-
-			/* Save a few cyles by simulating
-			 * strcat(statFileName, slash_proc_entry->d_name);
-			 * strcat(statFileName, "/stat");
-			 * while checking for a numeric filename (which really
-			 * should be a pid). Then do the same for the
-			 * /proc/<pid>/io file name.
-			 */
-			optr = proc_stat_file + sizeof("/proc");
+			/* Only numeric filenames, which really should be pids */
 			iptr = slash_proc_entry->d_name;
 			i = 0;
 			do {
-				if ((*iptr < '0') ||
-				    ((*optr++ = *iptr++) > '9')) {
+				if ((*iptr < '0') || (*iptr++ > '9')) {
 					i = -1;
 					break;
 				}
@@ -679,54 +824,10 @@ static List _get_precs(List task_list, bool pgid_plugin, uint64_t cont_id,
 
 			if (i == -1)
 				continue;
-			iptr = (char*)"/stat";
-
-			do {
-				*optr++ = *iptr++;
-			} while (*iptr);
-			*optr = 0;
-
-			optr2 = proc_io_file + sizeof("/proc");
-			iptr = slash_proc_entry->d_name;
-			i = 0;
-			do {
-				if ((*iptr < '0') ||
-				    ((*optr2++ = *iptr++) > '9')) {
-					i = -1;
-					break;
-				}
-			} while (*iptr);
-			if (i == -1)
-				continue;
-			iptr = (char*)"/io";
-
-			do {
-				*optr2++ = *iptr++;
-			} while (*iptr);
-			*optr2 = 0;
 
-			optr2 = proc_smaps_file + sizeof("/proc");
-			iptr = slash_proc_entry->d_name;
-			i = 0;
-			do {
-				if ((*iptr < '0') ||
-				    ((*optr2++ = *iptr++) > '9')) {
-					i = -1;
-					break;
-				}
-			} while (*iptr);
-			if (i == -1)
-				continue;
-			iptr = (char*)"/smaps";
-
-			do {
-				*optr2++ = *iptr++;
-			} while (*iptr);
-			*optr2 = 0;
-
-			_handle_stats(proc_stat_file, proc_io_file,
-				      proc_smaps_file, callbacks,
-				      jobacct ? jobacct->tres_count : 0);
+			_handle_stats(atoi(slash_proc_entry->d_name), callbacks,
+				      jobacct ? jobacct->tres_count : 0, false,
+				      NULL);
 		}
 	}
 
@@ -853,6 +954,7 @@ static void _record_profile(struct jobacctinfo *jobacct)
 extern void jag_common_init(long in_hertz)
 {
 	uint32_t profile_opt;
+	struct rlimit rlim;
 
 	prec_list = list_create(destroy_jag_prec);
 
@@ -877,11 +979,24 @@ extern void jag_common_init(long in_hertz)
 	}
 
 	my_pagesize = getpagesize();
+
+	/*
+	 * Leave at least half of the descriptors to the rest of slurmstepd,
+	 * processes past that limit are sampled with open()/close() instead.
+	 */
+	if (!getrlimit(RLIMIT_NOFILE, &rlim) && (rlim.rlim_cur != RLIM_INFINITY))
+		max_cached_fds = rlim.rlim_cur / 2;
+	else
+		max_cached_fds = 512;
 }
 
 extern void jag_common_fini(void)
 {
 	FREE_NULL_LIST(prec_list);
+	xfree(last_pids);
+	last_npids = 0;
+	xfree(scratch_prec.tres_data);
+	scratch_prec.tres_count = 0;
 
 	if (slash_proc)
 		(void) closedir(slash_proc);
@@ -894,6 +1009,7 @@ extern void destroy_jag_prec(void *object)
 	if (!prec)
 		return;
 
+	_close_prec_fds(prec);
 	xfree(prec->tres_data);
 	xfree(prec);
 	return;
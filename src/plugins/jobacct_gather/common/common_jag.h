@@ -54,6 +54,14 @@ typedef struct jag_prec {	/* process record */
 	int     tres_count; /* count of tres in the tres_data */
 	acct_gather_data_t *tres_data; /* array of tres data */
 	double  usec; /* user cpu time: To normalize divide by system hertz */
+	/*
+	 * Per-PID polling keeps the /proc files of a process open between
+	 * samples and refreshes them with pread(). -1 when not cached.
+	 */
+	int	stat_fd;	/* /proc/<pid>/stat */
+	int	statm_fd;	/* /proc/<pid>/statm (NoShare only) */
+	int	io_fd;		/* /proc/<pid>/io */
+	uint32_t poll_seq;	/* last poll this process was seen in */
 } jag_prec_t;
 
 typedef struct jag_callbacks {
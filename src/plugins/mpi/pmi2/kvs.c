@@ -35,9 +35,14 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
+#include <fcntl.h>
 #include <stdlib.h>
+#include <sys/mman.h>
 #include <unistd.h>
 
+#include "src/common/slurm_xlator.h"
+#include "src/common/env.h"
+
 #include "kvs.h"
 #include "setup.h"
 #include "tree.h"
@@ -68,6 +73,11 @@ static int temp_kvs_size = 0;
 
 static int no_dup_keys = 0;
 
+/* node-local segment the tasks stage their KVS puts in */
+int shm_kvs_fd = -1;
+static void *shm_kvs = NULL;
+static size_t shm_kvs_size = 0;
+
 #define TASKS_PER_BUCKET 8
 #define TEMP_KVS_SIZE_INC 2048
 
@@ -138,26 +148,37 @@ temp_kvs_init(void)
 	return SLURM_SUCCESS;
 }
 
+/* append a pair in packstr() format, key_len and val_len including '\0' */
+static void
+_temp_kvs_append(const char *key, uint32_t key_len,
+		 const char *val, uint32_t val_len)
+{
+	uint32_t size, nl;
+
+	size = key_len + val_len + 2 * sizeof(uint32_t);
+	if (temp_kvs_cnt + size > temp_kvs_size) {
+		temp_kvs_size += MAX(size, TEMP_KVS_SIZE_INC);
+		xrealloc(temp_kvs_buf, temp_kvs_size);
+	}
+	nl = htonl(key_len);
+	memcpy(&temp_kvs_buf[temp_kvs_cnt], &nl, sizeof(nl));
+	temp_kvs_cnt += sizeof(nl);
+	memcpy(&temp_kvs_buf[temp_kvs_cnt], key, key_len);
+	temp_kvs_cnt += key_len;
+	nl = htonl(val_len);
+	memcpy(&temp_kvs_buf[temp_kvs_cnt], &nl, sizeof(nl));
+	temp_kvs_cnt += sizeof(nl);
+	memcpy(&temp_kvs_buf[temp_kvs_cnt], val, val_len);
+	temp_kvs_cnt += val_len;
+}
+
 extern int
 temp_kvs_add(char *key, char *val)
 {
-	Buf buf;
-	uint32_t size;
-
 	if ( key == NULL || val == NULL )
 		return SLURM_SUCCESS;
 
-	buf = init_buf(PMI2_MAX_KEYLEN + PMI2_MAX_VALLEN + 2 * sizeof(uint32_t));
-	packstr(key, buf);
-	packstr(val, buf);
-	size = get_buf_offset(buf);
-	if (temp_kvs_cnt + size > temp_kvs_size) {
-		temp_kvs_size += TEMP_KVS_SIZE_INC;
-		xrealloc(temp_kvs_buf, temp_kvs_size);
-	}
-	memcpy(&temp_kvs_buf[temp_kvs_cnt], get_buf_data(buf), size);
-	temp_kvs_cnt += size;
-	free_buf(buf);
+	_temp_kvs_append(key, strlen(key) + 1, val, strlen(val) + 1);
 
 	return SLURM_SUCCESS;
 }
@@ -231,6 +252,130 @@ temp_kvs_send(void)
 
 /**************************************************************/
 
+extern int
+shm_kvs_init(char ***env)
+{
+	static const char *dirs[] = { "/dev/shm", "/tmp", NULL };
+	pmi2_shm_hdr_t *hdr;
+	char *path = NULL;
+	int i;
+
+	shm_kvs_fini();
+
+	if (getenvp(*env, PMI2_SHM_DISABLE_ENV) || !job_info.ltasks)
+		return SLURM_SUCCESS;
+
+	shm_kvs_size = PMI2_SHM_HDR_SIZE +
+		(size_t) job_info.ltasks * PMI2_SHM_SLOT_SIZE;
+
+	/*
+	 * The segment is unlinked as soon as it is mapped. Tasks inherit
+	 * the descriptor, so nothing is left behind if the step dies.
+	 */
+	for (i = 0; dirs[i]; i++) {
+		xstrfmtcat(path, "%s/slurm.pmi2.%u.%u.XXXXXX", dirs[i],
+			   job_info.step_id.job_id, job_info.step_id.step_id);
+		shm_kvs_fd = mkstemp(path);
+		if (shm_kvs_fd >= 0) {
+			unlink(path);
+			if (!ftruncate(shm_kvs_fd, shm_kvs_size))
+				break;
+			close(shm_kvs_fd);
+			shm_kvs_fd = -1;
+		}
+		xfree(path);
+	}
+	xfree(path);
+	if (shm_kvs_fd < 0) {
+		verbose("mpi/pmi2: unable to create kvs segment, using socket puts: %m");
+		return SLURM_SUCCESS;
+	}
+
+	shm_kvs = mmap(NULL, shm_kvs_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		       shm_kvs_fd, 0);
+	if (shm_kvs == MAP_FAILED) {
+		verbose("mpi/pmi2: unable to map kvs segment, using socket puts: %m");
+		shm_kvs = NULL;
+		close(shm_kvs_fd);
+		shm_kvs_fd = -1;
+		return SLURM_SUCCESS;
+	}
+
+	hdr = shm_kvs;
+	hdr->version = PMI2_SHM_VERSION;
+	hdr->slot_cnt = job_info.ltasks;
+	hdr->slot_size = PMI2_SHM_SLOT_SIZE;
+	hdr->magic = PMI2_SHM_MAGIC;
+
+	debug("mpi/pmi2: kvs segment of %zu bytes for %d tasks",
+	      shm_kvs_size, job_info.ltasks);
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Move the pairs a task staged in its slot into the temp kvs. Called when
+ * the task's put or fence command arrives, the task does not touch its slot
+ * again until it gets the response.
+ */
+extern int
+shm_kvs_drain(int lrank)
+{
+	pmi2_shm_slot_t *slot;
+	char *key, *val, *p, *end;
+	uint32_t used, cnt = 0;
+
+	if (!shm_kvs || (lrank < 0) || (lrank >= job_info.ltasks))
+		return SLURM_SUCCESS;
+
+	slot = PMI2_SHM_SLOT(shm_kvs, lrank);
+	used = slot->used;
+	if (!used)
+		return SLURM_SUCCESS;
+	if (used > PMI2_SHM_DATA_SIZE) {
+		error("mpi/pmi2: invalid kvs slot size %u from task %d",
+		      used, job_info.gtids[lrank]);
+		slot->used = slot->count = 0;
+		return SLURM_ERROR;
+	}
+
+	/* the task owns this memory, trust nothing about its contents */
+	p = slot->data;
+	end = slot->data + used;
+	while (p < end) {
+		key = p;
+		if (!(p = memchr(key, '\0', end - key)))
+			break;
+		val = ++p;
+		if (!(p = memchr(val, '\0', end - val)))
+			break;
+		p++;
+		_temp_kvs_append(key, val - key, val, p - val);
+		cnt++;
+	}
+	if (p != end)
+		error("mpi/pmi2: truncated kvs pair in slot of task %d",
+		      job_info.gtids[lrank]);
+
+	debug3("mpi/pmi2: drained %u kvs pairs from task %d",
+	       cnt, job_info.gtids[lrank]);
+	slot->used = slot->count = 0;
+	return SLURM_SUCCESS;
+}
+
+extern void
+shm_kvs_fini(void)
+{
+	if (shm_kvs)
+		munmap(shm_kvs, shm_kvs_size);
+	shm_kvs = NULL;
+	shm_kvs_size = 0;
+	if (shm_kvs_fd >= 0)
+		close(shm_kvs_fd);
+	shm_kvs_fd = -1;
+}
+
+/**************************************************************/
+
 extern int
 kvs_init(void)
 {
@@ -54,6 +54,11 @@ extern int   temp_kvs_add(char *key, char *val);
 extern int   temp_kvs_merge(Buf buf);
 extern int   temp_kvs_send(void);
 
+extern int   shm_kvs_fd;
+extern int   shm_kvs_init(char ***env);
+extern int   shm_kvs_drain(int lrank);
+extern void  shm_kvs_fini(void);
+
 extern int   kvs_init(void);
 extern char *kvs_get(char *key);
 extern int   kvs_put(char *key, char *val);
@@ -49,6 +49,8 @@
 #include "setup.h"
 #include "agent.h"
 #include "spawn.h"
+#include "kvs.h"
+#include "pmi.h"
 
 /*
  * These variables are required by the generic plugin interface.  If they
@@ -119,6 +121,12 @@ int p_mpi_hook_slurmstepd_task (const mpi_plugin_task_info_t *job,
 	if (job_info.spawn_seq) { /* PMI1.1 needs this env-var */
 		env_array_overwrite_fmt(env, "PMI_SPAWNED", "%u", 1);
 	}
+	if (shm_kvs_fd >= 0) {
+		env_array_overwrite_fmt(env, PMI2_SHM_FD_ENV, "%d",
+					shm_kvs_fd);
+		env_array_overwrite_fmt(env, PMI2_SHM_RANK_ENV, "%u",
+					job->ltaskid);
+	}
 	/* close unused sockets in task */
 	close(tree_sock);
 	tree_sock = 0;
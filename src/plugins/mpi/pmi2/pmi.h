@@ -38,6 +38,8 @@
 #ifndef _PMI_H
 #define _PMI_H
 
+#include <inttypes.h>
+
 /***********************************************************\
  * PMI1 definitions
 \***********************************************************/
@@ -234,10 +236,43 @@
 #define PMI2_PPVAL_ENV          "SLURM_PMI2_PPVAL"
 #define SLURM_STEP_RESV_PORTS   "SLURM_STEP_RESV_PORTS"
 #define PMIX_RING_TREE_WIDTH_ENV "SLURM_PMIX_RING_WIDTH"
+#define PMI2_SHM_FD_ENV         "SLURM_PMI2_SHM_FD"
+#define PMI2_SHM_RANK_ENV       "SLURM_PMI2_SHM_RANK"
+#define PMI2_SHM_DISABLE_ENV    "SLURM_PMI2_SHM_DISABLE"
 /* old PMIv1 envs */
 #define PMI2_PMI_DEBUGGED_ENV   "PMI_DEBUG"
 #define PMI2_KVS_NO_DUP_KEYS_ENV "SLURM_PMI_KVS_NO_DUP_KEYS"
 
+/***********************************************************\
+ * Node-local KVS put segment
+ *
+ * libpmi2 appends "key\0value\0" pairs to the slot of its local
+ * rank instead of sending one KVS put command per pair. The slot is
+ * drained by slurmstepd when the task's fence command arrives. The
+ * same layout is defined in contribs/pmi2/pmi2_util.h.
+\***********************************************************/
+#define PMI2_SHM_MAGIC          0x504d4932	/* "PMI2" */
+#define PMI2_SHM_VERSION        1
+#define PMI2_SHM_HDR_SIZE       64
+#define PMI2_SHM_SLOT_SIZE      (64 * 1024)
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t slot_cnt;
+	uint32_t slot_size;
+} pmi2_shm_hdr_t;
+
+typedef struct {
+	uint32_t used;		/* bytes of key/value pairs in data */
+	uint32_t count;		/* number of key/value pairs in data */
+	char data[];
+} pmi2_shm_slot_t;
+
+#define PMI2_SHM_SLOT(base, i)						\
+	((pmi2_shm_slot_t *)((char *)(base) + PMI2_SHM_HDR_SIZE +	\
+			     (size_t)(i) * PMI2_SHM_SLOT_SIZE))
+#define PMI2_SHM_DATA_SIZE (PMI2_SHM_SLOT_SIZE - sizeof(pmi2_shm_slot_t))
 
 extern int handle_pmi1_cmd(int fd, int lrank);
 extern int handle_pmi2_cmd(int fd, int lrank);
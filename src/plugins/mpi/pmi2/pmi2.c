@@ -269,6 +269,11 @@ _handle_kvs_put(int fd, int lrank, client_req_t *req)
 	client_req_get_str(req, KEY_KEY, &key);
 	client_req_get_str(req, VALUE_KEY, &val);
 
+	/*
+	 * pairs the task staged before this one go first, so the last put of
+	 * a key still wins
+	 */
+	shm_kvs_drain(lrank);
 	/* no need to add k-v to hash. just get it ready to be up-forward */
 	rc = temp_kvs_add(key, val);
 	xfree(key);
@@ -290,6 +295,8 @@ _handle_kvs_fence(int fd, int lrank, client_req_t *req)
 
 	debug3("mpi/pmi2: in _handle_kvs_fence, from task %d",
 	       job_info.gtids[lrank]);
+	/* pick up the puts the task staged in its kvs segment slot */
+	shm_kvs_drain(lrank);
 	if (tasks_to_wait == 0 && children_to_wait == 0) {
 		tasks_to_wait = job_info.ltasks;
 		children_to_wait = tree_info.num_children;
@@ -367,6 +367,10 @@ _setup_stepd_kvs(char ***env)
 	if (rc != SLURM_SUCCESS)
 		return rc;
 
+	rc = shm_kvs_init(env);
+	if (rc != SLURM_SUCCESS)
+		return rc;
+
 	/* preput */
 	p = getenvp(*env, PMI2_PREPUT_CNT_ENV);
 	if (p) {
@@ -437,6 +441,7 @@ pmi2_cleanup_stepd(void)
 {
 	close(tree_sock);
 	_remove_tree_sock();
+	shm_kvs_fini();
 }
 /**************************************************************/
 
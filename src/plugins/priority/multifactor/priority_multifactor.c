@@ -64,6 +64,7 @@
 #include "src/common/slurm_mcs.h"
 #include "src/common/slurm_priority.h"
 #include "src/common/slurm_time.h"
+#include "src/common/timers.h"
 #include "src/common/xstring.h"
 #include "src/common/gres.h"
 
@@ -84,6 +85,8 @@ extern void *acct_db_conn  __attribute__((weak_import));
 extern uint32_t cluster_cpus __attribute__((weak_import));
 extern List job_list  __attribute__((weak_import));
 extern time_t last_job_update __attribute__((weak_import));
+extern time_t last_part_update __attribute__((weak_import));
+extern diag_stats_t slurmctld_diag_stats __attribute__((weak_import));
 extern slurm_conf_t slurm_conf __attribute__((weak_import));
 extern int slurmctld_tres_cnt __attribute__((weak_import));
 extern uint16_t accounting_enforce __attribute__((weak_import));
@@ -92,6 +95,8 @@ void *acct_db_conn = NULL;
 uint32_t cluster_cpus = NO_VAL;
 List job_list = NULL;
 time_t last_job_update = (time_t) 0;
+time_t last_part_update = (time_t) 0;
+diag_stats_t slurmctld_diag_stats;
 slurm_conf_t slurm_conf;
 int slurmctld_tres_cnt = 0;
 uint16_t accounting_enforce = 0;
@@ -146,6 +151,11 @@ static double  *weight_tres; /* tres weights */
 static uint32_t flags;       /* Priority Flags */
 static time_t g_last_ran = 0; /* when the last poll ran */
 static double decay_factor = 1; /* The decay factor when decaying time. */
+static bool usage_changed = true; /* usage added since the association tree
+				   * was last normalized */
+static uint32_t norm_tree_gen = NO_VAL; /* g_assoc_tree_gen last normalized */
+static uint32_t jobs_moved = 0; /* jobs with new factors this decay cycle */
+static uint32_t jobs_same = 0;  /* jobs with unchanged factors this cycle */
 
 /* variables defined in priority_multifactor.h */
 
@@ -229,6 +239,7 @@ static int _reset_usage(void)
 
 	xassert(assoc_mgr_assoc_list);
 
+	usage_changed = true;
 	itr = list_iterator_create(assoc_mgr_assoc_list);
 	/* We want to do this to all associations including root.
 	 * All usage_raws are calculated from the bottom up.
@@ -502,12 +513,45 @@ static double _get_tres_prio_weighted(double *tres_factors)
 	return tmp_tres;
 }
 
-/* Returns the priority after applying the weight factors */
+/* Return true if the weighted factors of a job differ from prev_factors */
+static bool _factors_moved(priority_factors_object_t *prev_factors,
+			   double *prev_tres,
+			   priority_factors_object_t *factors)
+{
+	if ((prev_factors->priority_age != factors->priority_age) ||
+	    (prev_factors->priority_assoc != factors->priority_assoc) ||
+	    (prev_factors->priority_fs != factors->priority_fs) ||
+	    (prev_factors->priority_js != factors->priority_js) ||
+	    (prev_factors->priority_part != factors->priority_part) ||
+	    (prev_factors->priority_qos != factors->priority_qos) ||
+	    (prev_factors->priority_site != factors->priority_site) ||
+	    (prev_factors->nice != factors->nice))
+		return true;
+
+	if (!factors->priority_tres)
+		return (prev_factors->priority_tres != NULL);
+	if (!prev_factors->priority_tres ||
+	    (prev_factors->tres_cnt != factors->tres_cnt))
+		return true;
+
+	return memcmp(prev_tres, factors->priority_tres,
+		      sizeof(double) * factors->tres_cnt);
+}
+
+/*
+ * Returns the priority after applying the weight factors
+ * OUT moved - if not NULL, set to false if the weighted factors of the job
+ *	are the same as the ones it was last given. The per partition
+ *	priorities are then left as they are unless a partition changed since
+ *	the last decay cycle.
+ */
 static uint32_t _get_priority_internal(time_t start_time,
-				       job_record_t *job_ptr)
+				       job_record_t *job_ptr, bool *moved)
 {
 	double priority	= 0.0;
-	priority_factors_object_t pre_factors;
+	priority_factors_object_t pre_factors, prev_factors;
+	double prev_tres[slurmctld_tres_cnt];
+	bool have_prev = false;
 	uint64_t tmp_64;
 	double tmp_tres = 0.0;
 	char *multi_part_str = NULL;
@@ -535,6 +579,19 @@ static uint32_t _get_priority_internal(time_t start_time,
 		return 0;
 	}
 
+	if (moved) {
+		*moved = true;
+		if (job_ptr->prio_factors) {
+			memcpy(&prev_factors, job_ptr->prio_factors,
+			       sizeof(priority_factors_object_t));
+			if (prev_factors.priority_tres &&
+			    (prev_factors.tres_cnt == slurmctld_tres_cnt))
+				memcpy(prev_tres, prev_factors.priority_tres,
+				       sizeof(double) * slurmctld_tres_cnt);
+			have_prev = true;
+		}
+	}
+
 	set_priority_factors(start_time, job_ptr);
 
 	if (slurm_conf.debug_flags & DEBUG_FLAG_PRIO) {
@@ -563,6 +620,10 @@ static uint32_t _get_priority_internal(time_t start_time,
 		tmp_tres = _get_tres_prio_weighted(tres_factors);
 	}
 
+	if (have_prev &&
+	    !_factors_moved(&prev_factors, prev_tres, job_ptr->prio_factors))
+		*moved = false;
+
 	priority = job_ptr->prio_factors->priority_age
 		+ job_ptr->prio_factors->priority_assoc
 		+ job_ptr->prio_factors->priority_fs
@@ -587,7 +648,14 @@ static uint32_t _get_priority_internal(time_t start_time,
 		priority = (double) tmp_64;
 	}
 
-	if (job_ptr->part_ptr_list) {
+	/*
+	 * The per partition priorities only depend on the factors above and
+	 * on the partitions, so they can be kept when neither changed since
+	 * the last time they were calculated.
+	 */
+	if (job_ptr->part_ptr_list &&
+	    (!moved || *moved || !job_ptr->priority_array ||
+	     (last_part_update >= g_last_ran))) {
 		part_record_t *part_ptr;
 		double priority_part;
 		ListIterator part_iterator;
@@ -1147,6 +1215,8 @@ static int _apply_new_usage(job_record_t *job_ptr, time_t start_period,
 	 * can keep track of how much usage
 	 * has occured on the entire system
 	 * and use that to normalize against. */
+	if (assoc && real_decay)
+		usage_changed = true;
 	while (assoc) {
 		assoc->usage->grp_used_wall += run_decay;
 		assoc->usage->usage_raw += (long double)real_decay;
@@ -1190,6 +1260,8 @@ static void *_decay_thread(void *no_data)
 	double run_delta = 0.0, real_decay = 0.0;
 	struct timeval tvnow;
 	struct timespec abs;
+	bool force_norm = true;
+	DEF_TIMERS;
 
 	/* Write lock on jobs, read lock on nodes and partitions */
 	slurmctld_lock_t job_write_lock =
@@ -1260,6 +1332,7 @@ static void *_decay_thread(void *no_data)
 
 		slurm_mutex_lock(&decay_lock);
 		running_decay = 1;
+		START_TIMER;
 
 		/* If reconfig is called handle all that happens
 		   outside of the loop here */
@@ -1277,6 +1350,7 @@ static void *_decay_thread(void *no_data)
 			else
 				decay_factor = 1;
 
+			force_norm = true;
 			reconfig = 0;
 		}
 
@@ -1308,12 +1382,29 @@ static void *_decay_thread(void *no_data)
 			}
 		}
 
-		/* Calculate all the normalized usage unless this is Fair Tree;
-		 * it handles these calculations during its tree traversal */
+		/*
+		 * Calculate all the normalized usage unless this is Fair Tree;
+		 * it handles these calculations during its tree traversal.
+		 * Usage is normalized against the root association, so new
+		 * usage anywhere moves every association's normalized usage.
+		 * Decay scales all of them alike and leaves it as it is, so
+		 * the tree only needs a new pass if usage was added or reset
+		 * or the associations changed since the last one.
+		 */
 		if (!(flags & PRIORITY_FLAGS_FAIR_TREE)) {
 			assoc_mgr_lock(&locks);
-			_set_children_usage_efctv(
-				assoc_mgr_root_assoc->usage->children_list);
+			if (force_norm || usage_changed ||
+			    (norm_tree_gen != g_assoc_tree_gen)) {
+				_set_children_usage_efctv(
+					assoc_mgr_root_assoc->
+					usage->children_list);
+				usage_changed = false;
+				norm_tree_gen = g_assoc_tree_gen;
+				force_norm = false;
+				slurmctld_diag_stats.prio_norm_counter++;
+			} else
+				log_flag(PRIO, "%s: association usage unchanged, keeping normalized usage",
+					 __func__);
 			assoc_mgr_unlock(&locks);
 		}
 
@@ -1359,13 +1450,30 @@ static void *_decay_thread(void *no_data)
 		unlock_slurmctld(job_write_lock);
 
 	get_usage:
-		if (flags & PRIORITY_FLAGS_FAIR_TREE)
+		if (flags & PRIORITY_FLAGS_FAIR_TREE) {
 			fair_tree_decay(job_list, start_time);
+			slurmctld_diag_stats.prio_norm_counter++;
+		}
 
 		g_last_ran = start_time;
 
 		_write_last_decay_ran(g_last_ran, last_reset);
 
+		END_TIMER;
+		slurmctld_diag_stats.prio_cycle_counter++;
+		slurmctld_diag_stats.prio_cycle_last = DELTA_TIMER;
+		slurmctld_diag_stats.prio_cycle_sum += DELTA_TIMER;
+		if (slurmctld_diag_stats.prio_cycle_last >
+		    slurmctld_diag_stats.prio_cycle_max) {
+			slurmctld_diag_stats.prio_cycle_max =
+				slurmctld_diag_stats.prio_cycle_last;
+		}
+		slurmctld_diag_stats.prio_last_jobs_moved = jobs_moved;
+		slurmctld_diag_stats.prio_last_jobs_same = jobs_same;
+		log_flag(PRIO, "%s: cycle took %s, %u jobs with changed and %u with unchanged factors",
+			 __func__, TIME_STR, jobs_moved, jobs_same);
+		jobs_moved = jobs_same = 0;
+
 		running_decay = 0;
 
 		/* Sleep until the next time. */
@@ -1794,7 +1902,7 @@ extern uint32_t priority_p_set(uint32_t last_prio, job_record_t *job_ptr)
 	 */
 	site_factor_g_set(job_ptr);
 
-	priority = _get_priority_internal(time(NULL), job_ptr);
+	priority = _get_priority_internal(time(NULL), job_ptr, NULL);
 
 	debug2("initial priority for job %u is %u", job_ptr->job_id, priority);
 
@@ -2005,6 +2113,7 @@ extern int decay_apply_weighted_factors(job_record_t *job_ptr,
 					time_t *start_time_ptr)
 {
 	uint32_t new_prio;
+	bool moved;
 
 	/* Always return SUCCESS so that list_for_each will
 	 * continue processing list of jobs. */
@@ -2019,9 +2128,16 @@ extern int decay_apply_weighted_factors(job_record_t *job_ptr,
 	     !(flags & PRIORITY_FLAGS_CALCULATE_RUNNING)))
 		return SLURM_SUCCESS;
 
-	new_prio = _get_priority_internal(*start_time_ptr, job_ptr);
-	if (((flags & PRIORITY_FLAGS_INCR_ONLY) == 0) ||
-	    (job_ptr->priority < new_prio)) {
+	new_prio = _get_priority_internal(*start_time_ptr, job_ptr, &moved);
+	if (moved)
+		jobs_moved++;
+	else
+		jobs_same++;
+
+	/* Only flag the job list as changed if the priority really did */
+	if ((job_ptr->priority != new_prio) &&
+	    (((flags & PRIORITY_FLAGS_INCR_ONLY) == 0) ||
+	     (job_ptr->priority < new_prio))) {
 		job_ptr->priority = new_prio;
 		last_job_update = time(NULL);
 	}
@@ -2042,6 +2158,21 @@ extern void set_priority_factors(time_t start_time, job_record_t *job_ptr)
 	if (!job_ptr->prio_factors) {
 		job_ptr->prio_factors =
 			xmalloc(sizeof(priority_factors_object_t));
+	} else if (weight_tres && job_ptr->prio_factors->priority_tres &&
+		   (job_ptr->prio_factors->tres_cnt == slurmctld_tres_cnt)) {
+		/* Reuse the TRES arrays, this is called for every job on
+		 * every decay cycle */
+		double *priority_tres = job_ptr->prio_factors->priority_tres;
+		double *tres_weights = job_ptr->prio_factors->tres_weights;
+
+		memset(job_ptr->prio_factors, 0,
+		       sizeof(priority_factors_object_t));
+		memset(priority_tres, 0, sizeof(double) * slurmctld_tres_cnt);
+		memcpy(tres_weights, weight_tres,
+		       sizeof(double) * slurmctld_tres_cnt);
+		job_ptr->prio_factors->priority_tres = priority_tres;
+		job_ptr->prio_factors->tres_weights = tres_weights;
+		job_ptr->prio_factors->tres_cnt = slurmctld_tres_cnt;
 	} else {
 		xfree(job_ptr->prio_factors->tres_weights);
 		xfree(job_ptr->prio_factors->priority_tres);
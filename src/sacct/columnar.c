@@ -0,0 +1,531 @@
+/*****************************************************************************\
+ *  columnar.c - binary columnar output for sacct
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+/*
+ * Layout of the --columnar output. All integers are unsigned and big endian
+ * (as written by pack32()/pack64()). A string is a uint32_t length including
+ * the terminating NUL followed by the characters and the NUL, a length of 0
+ * is a NULL string (as written by packstr()).
+ *
+ *	char[8]		magic "SACCTCOL"
+ *	uint16_t	format version (COLUMNAR_VERSION)
+ *	uint32_t	TRES count, then for each TRES:
+ *			  uint32_t id, string type, string name
+ *	uint32_t	column count, then for each column:
+ *			  string name, uint8_t type (column_type_t):
+ *			  1 uint32_t, 2 uint64_t, 3 string
+ *	row groups, each:
+ *	  uint32_t	row count, 0 ends the stream
+ *	  for each column in header order:
+ *	    uint32_t	size in bytes of the values that follow
+ *	    values	row count values of the column type
+ *
+ * There is one row per job and one per step. Columns describing the job
+ * (e.g. Account or Submit) are repeated on its step rows. Values are the
+ * raw values of the database records: times are seconds since the epoch,
+ * unset numbers are NO_VAL or NO_VAL64, state and exit code are the
+ * numeric codes and TRES columns keep the "<id>=<count>,..." form, ids
+ * being those of the TRES table in the header. The *NodeID TRES columns
+ * count into NodeList.
+ *
+ * contribs/sacct_columnar.py is a reference decoder.
+ */
+
+#include <arpa/inet.h>
+
+#include "src/common/pack.h"
+#include "sacct.h"
+
+#define COLUMNAR_MAGIC "SACCTCOL"
+#define COLUMNAR_VERSION 1
+
+/* bound the memory used when the jobs did not come in parts */
+#define COLUMNAR_MAX_ROWS 65536
+
+/* written in the header, do not renumber */
+typedef enum {
+	COLUMN_UINT32 = 1,
+	COLUMN_UINT64 = 2,
+	COLUMN_STRING = 3,
+} column_type_t;
+
+typedef enum {
+	COL_ROW_TYPE, /* 0 job, 1 step */
+	COL_JOBID,
+	COL_ARRAY_JOBID,
+	COL_ARRAY_TASKID,
+	COL_HET_JOBID,
+	COL_HET_JOB_OFFSET,
+	COL_STEPID,
+	COL_STEP_HET_COMP,
+	COL_CLUSTER,
+	COL_PARTITION,
+	COL_ACCOUNT,
+	COL_USER,
+	COL_UID,
+	COL_GID,
+	COL_WCKEY,
+	COL_QOSID,
+	COL_PRIORITY,
+	COL_JOBNAME,
+	COL_STATE,
+	COL_EXITCODE,
+	COL_DERIVED_EC,
+	COL_SUBMIT,
+	COL_ELIGIBLE,
+	COL_START,
+	COL_END,
+	COL_ELAPSED,
+	COL_SUSPENDED,
+	COL_TIMELIMIT,
+	COL_REQ_CPUS,
+	COL_REQ_MEM,
+	COL_NNODES,
+	COL_NTASKS,
+	COL_NODELIST,
+	COL_TOTAL_CPU_SEC,
+	COL_TOTAL_CPU_USEC,
+	COL_USER_CPU_SEC,
+	COL_USER_CPU_USEC,
+	COL_SYSTEM_CPU_SEC,
+	COL_SYSTEM_CPU_USEC,
+	COL_CONSUMED_ENERGY,
+	COL_TRES_REQ,
+	COL_TRES_ALLOC,
+	COL_TRES_IN_AVE,
+	COL_TRES_IN_MAX,
+	COL_TRES_IN_MAX_NODEID,
+	COL_TRES_IN_MAX_TASKID,
+	COL_TRES_IN_MIN,
+	COL_TRES_IN_MIN_NODEID,
+	COL_TRES_IN_MIN_TASKID,
+	COL_TRES_IN_TOT,
+	COL_TRES_OUT_AVE,
+	COL_TRES_OUT_MAX,
+	COL_TRES_OUT_MAX_NODEID,
+	COL_TRES_OUT_MAX_TASKID,
+	COL_TRES_OUT_MIN,
+	COL_TRES_OUT_MIN_NODEID,
+	COL_TRES_OUT_MIN_TASKID,
+	COL_TRES_OUT_TOT,
+	COL_COUNT
+} column_t;
+
+static const struct {
+	char *name;
+	column_type_t type;
+} columns[COL_COUNT] = {
+	[COL_ROW_TYPE] = { "RowType", COLUMN_UINT32 },
+	[COL_JOBID] = { "JobID", COLUMN_UINT32 },
+	[COL_ARRAY_JOBID] = { "ArrayJobID", COLUMN_UINT32 },
+	[COL_ARRAY_TASKID] = { "ArrayTaskID", COLUMN_UINT32 },
+	[COL_HET_JOBID] = { "HetJobID", COLUMN_UINT32 },
+	[COL_HET_JOB_OFFSET] = { "HetJobOffset", COLUMN_UINT32 },
+	[COL_STEPID] = { "StepID", COLUMN_UINT32 },
+	[COL_STEP_HET_COMP] = { "StepHetComp", COLUMN_UINT32 },
+	[COL_CLUSTER] = { "Cluster", COLUMN_STRING },
+	[COL_PARTITION] = { "Partition", COLUMN_STRING },
+	[COL_ACCOUNT] = { "Account", COLUMN_STRING },
+	[COL_USER] = { "User", COLUMN_STRING },
+	[COL_UID] = { "UID", COLUMN_UINT32 },
+	[COL_GID] = { "GID", COLUMN_UINT32 },
+	[COL_WCKEY] = { "WCKey", COLUMN_STRING },
+	[COL_QOSID] = { "QOSID", COLUMN_UINT32 },
+	[COL_PRIORITY] = { "Priority", COLUMN_UINT32 },
+	[COL_JOBNAME] = { "JobName", COLUMN_STRING },
+	[COL_STATE] = { "State", COLUMN_UINT32 },
+	[COL_EXITCODE] = { "ExitCode", COLUMN_UINT32 },
+	[COL_DERIVED_EC] = { "DerivedExitCode", COLUMN_UINT32 },
+	[COL_SUBMIT] = { "Submit", COLUMN_UINT64 },
+	[COL_ELIGIBLE] = { "Eligible", COLUMN_UINT64 },
+	[COL_START] = { "Start", COLUMN_UINT64 },
+	[COL_END] = { "End", COLUMN_UINT64 },
+	[COL_ELAPSED] = { "Elapsed", COLUMN_UINT32 },
+	[COL_SUSPENDED] = { "Suspended", COLUMN_UINT32 },
+	[COL_TIMELIMIT] = { "Timelimit", COLUMN_UINT32 },
+	[COL_REQ_CPUS] = { "ReqCPUS", COLUMN_UINT32 },
+	[COL_REQ_MEM] = { "ReqMem", COLUMN_UINT64 },
+	[COL_NNODES] = { "NNodes", COLUMN_UINT32 },
+	[COL_NTASKS] = { "NTasks", COLUMN_UINT32 },
+	[COL_NODELIST] = { "NodeList", COLUMN_STRING },
+	[COL_TOTAL_CPU_SEC] = { "TotalCPUSec", COLUMN_UINT32 },
+	[COL_TOTAL_CPU_USEC] = { "TotalCPUUsec", COLUMN_UINT32 },
+	[COL_USER_CPU_SEC] = { "UserCPUSec", COLUMN_UINT32 },
+	[COL_USER_CPU_USEC] = { "UserCPUUsec", COLUMN_UINT32 },
+	[COL_SYSTEM_CPU_SEC] = { "SystemCPUSec", COLUMN_UINT32 },
+	[COL_SYSTEM_CPU_USEC] = { "SystemCPUUsec", COLUMN_UINT32 },
+	[COL_CONSUMED_ENERGY] = { "ConsumedEnergy", COLUMN_UINT64 },
+	[COL_TRES_REQ] = { "ReqTRES", COLUMN_STRING },
+	[COL_TRES_ALLOC] = { "AllocTRES", COLUMN_STRING },
+	[COL_TRES_IN_AVE] = { "TRESUsageInAve", COLUMN_STRING },
+	[COL_TRES_IN_MAX] = { "TRESUsageInMax", COLUMN_STRING },
+	[COL_TRES_IN_MAX_NODEID] = { "TRESUsageInMaxNodeID", COLUMN_STRING },
+	[COL_TRES_IN_MAX_TASKID] = { "TRESUsageInMaxTaskID", COLUMN_STRING },
+	[COL_TRES_IN_MIN] = { "TRESUsageInMin", COLUMN_STRING },
+	[COL_TRES_IN_MIN_NODEID] = { "TRESUsageInMinNodeID", COLUMN_STRING },
+	[COL_TRES_IN_MIN_TASKID] = { "TRESUsageInMinTaskID", COLUMN_STRING },
+	[COL_TRES_IN_TOT] = { "TRESUsageInTot", COLUMN_STRING },
+	[COL_TRES_OUT_AVE] = { "TRESUsageOutAve", COLUMN_STRING },
+	[COL_TRES_OUT_MAX] = { "TRESUsageOutMax", COLUMN_STRING },
+	[COL_TRES_OUT_MAX_NODEID] = { "TRESUsageOutMaxNodeID", COLUMN_STRING },
+	[COL_TRES_OUT_MAX_TASKID] = { "TRESUsageOutMaxTaskID", COLUMN_STRING },
+	[COL_TRES_OUT_MIN] = { "TRESUsageOutMin", COLUMN_STRING },
+	[COL_TRES_OUT_MIN_NODEID] = { "TRESUsageOutMinNodeID", COLUMN_STRING },
+	[COL_TRES_OUT_MIN_TASKID] = { "TRESUsageOutMinTaskID", COLUMN_STRING },
+	[COL_TRES_OUT_TOT] = { "TRESUsageOutTot", COLUMN_STRING },
+};
+
+/* values of the current row group, one buffer per column */
+static Buf column_bufs[COL_COUNT];
+static uint32_t row_count = 0;
+
+static void _write_buf(Buf buffer)
+{
+	if (fwrite(get_buf_data(buffer), get_buf_offset(buffer), 1, stdout)
+	    != 1)
+		fatal("%s: unable to write output: %m", __func__);
+}
+
+static void _write_uint32(uint32_t value)
+{
+	value = htonl(value);
+	if (fwrite(&value, sizeof(value), 1, stdout) != 1)
+		fatal("%s: unable to write output: %m", __func__);
+}
+
+static int _pack_tres(void *x, void *arg)
+{
+	slurmdb_tres_rec_t *tres = x;
+	Buf buffer = arg;
+
+	pack32(tres->id, buffer);
+	packstr(tres->type, buffer);
+	packstr(tres->name, buffer);
+
+	return 0;
+}
+
+/* packstr() is a macro that does not take expressions as its string */
+static void _pack_str(char *str, Buf buffer)
+{
+	packstr(str, buffer);
+}
+
+/* Add one row for a job (step == NULL) or one of its steps */
+static void _add_row(slurmdb_job_rec_t *job, slurmdb_step_rec_t *step)
+{
+	static slurmdb_stats_t no_stats; /* usage unknown */
+	slurmdb_stats_t *stats = &no_stats;
+	slurmdb_step_rec_t *first_step = NULL;
+	struct passwd *pw = NULL;
+
+	if (step) {
+		stats = &step->stats;
+	} else if (!job->track_steps &&
+		   (first_step = job->first_step_ptr)) {
+		/* same as print_fields(), only then is usage known */
+		stats = &job->stats;
+	}
+
+	for (int i = 0; i < COL_COUNT; i++) {
+		Buf buffer = column_bufs[i];
+
+		switch (i) {
+		case COL_ROW_TYPE:
+			pack32(step ? 1 : 0, buffer);
+			break;
+		case COL_JOBID:
+			pack32(job->jobid, buffer);
+			break;
+		case COL_ARRAY_JOBID:
+			pack32(job->array_job_id, buffer);
+			break;
+		case COL_ARRAY_TASKID:
+			pack32(job->array_task_id, buffer);
+			break;
+		case COL_HET_JOBID:
+			pack32(job->het_job_id, buffer);
+			break;
+		case COL_HET_JOB_OFFSET:
+			pack32(job->het_job_offset, buffer);
+			break;
+		case COL_STEPID:
+			pack32(step ? step->step_id.step_id : NO_VAL, buffer);
+			break;
+		case COL_STEP_HET_COMP:
+			pack32(step ? step->step_id.step_het_comp : NO_VAL,
+			       buffer);
+			break;
+		case COL_CLUSTER:
+			_pack_str(job->cluster, buffer);
+			break;
+		case COL_PARTITION:
+			_pack_str(job->partition, buffer);
+			break;
+		case COL_ACCOUNT:
+			_pack_str(job->account, buffer);
+			break;
+		case COL_USER:
+			_pack_str(job->user, buffer);
+			break;
+		case COL_UID:
+			if (params.use_local_uid && job->user &&
+			    (pw = getpwnam(job->user)))
+				pack32(pw->pw_uid, buffer);
+			else
+				pack32(job->uid, buffer);
+			break;
+		case COL_GID:
+			pack32(job->gid, buffer);
+			break;
+		case COL_WCKEY:
+			_pack_str(job->wckey, buffer);
+			break;
+		case COL_QOSID:
+			pack32(job->qosid, buffer);
+			break;
+		case COL_PRIORITY:
+			pack32(job->priority, buffer);
+			break;
+		case COL_JOBNAME:
+			_pack_str(step ? step->stepname : job->jobname, buffer);
+			break;
+		case COL_STATE:
+			pack32(step ? step->state : job->state, buffer);
+			break;
+		case COL_EXITCODE:
+			pack32(step ? step->exitcode : job->exitcode, buffer);
+			break;
+		case COL_DERIVED_EC:
+			pack32(job->derived_ec, buffer);
+			break;
+		case COL_SUBMIT:
+			pack64(job->submit, buffer);
+			break;
+		case COL_ELIGIBLE:
+			pack64(job->eligible, buffer);
+			break;
+		case COL_START:
+			pack64(step ? step->start : job->start, buffer);
+			break;
+		case COL_END:
+			pack64(step ? step->end : job->end, buffer);
+			break;
+		case COL_ELAPSED:
+			pack32(step ? step->elapsed : job->elapsed, buffer);
+			break;
+		case COL_SUSPENDED:
+			pack32(step ? step->suspended : job->suspended,
+			       buffer);
+			break;
+		case COL_TIMELIMIT:
+			pack32(job->timelimit, buffer);
+			break;
+		case COL_REQ_CPUS:
+			pack32(job->req_cpus, buffer);
+			break;
+		case COL_REQ_MEM:
+			pack64(job->req_mem, buffer);
+			break;
+		case COL_NNODES:
+			pack32(step ? step->nnodes : job->alloc_nodes, buffer);
+			break;
+		case COL_NTASKS:
+			if (step)
+				pack32(step->ntasks, buffer);
+			else if (first_step)
+				pack32(first_step->ntasks, buffer);
+			else
+				pack32(NO_VAL, buffer);
+			break;
+		case COL_NODELIST:
+			_pack_str(step ? step->nodes : job->nodes, buffer);
+			break;
+		case COL_TOTAL_CPU_SEC:
+			pack32(step ? step->tot_cpu_sec : job->tot_cpu_sec,
+			       buffer);
+			break;
+		case COL_TOTAL_CPU_USEC:
+			pack32(step ? step->tot_cpu_usec : job->tot_cpu_usec,
+			       buffer);
+			break;
+		case COL_USER_CPU_SEC:
+			pack32(step ? step->user_cpu_sec : job->user_cpu_sec,
+			       buffer);
+			break;
+		case COL_USER_CPU_USEC:
+			pack32(step ? step->user_cpu_usec :
+			       job->user_cpu_usec, buffer);
+			break;
+		case COL_SYSTEM_CPU_SEC:
+			pack32(step ? step->sys_cpu_sec : job->sys_cpu_sec,
+			       buffer);
+			break;
+		case COL_SYSTEM_CPU_USEC:
+			pack32(step ? step->sys_cpu_usec : job->sys_cpu_usec,
+			       buffer);
+			break;
+		case COL_CONSUMED_ENERGY:
+			pack64((stats != &no_stats) ? stats->consumed_energy :
+			       NO_VAL64, buffer);
+			break;
+		case COL_TRES_REQ:
+			_pack_str(job->tres_req_str, buffer);
+			break;
+		case COL_TRES_ALLOC:
+			_pack_str(step ? step->tres_alloc_str :
+				  job->tres_alloc_str, buffer);
+			break;
+		case COL_TRES_IN_AVE:
+			_pack_str(stats->tres_usage_in_ave, buffer);
+			break;
+		case COL_TRES_IN_MAX:
+			_pack_str(stats->tres_usage_in_max, buffer);
+			break;
+		case COL_TRES_IN_MAX_NODEID:
+			_pack_str(stats->tres_usage_in_max_nodeid, buffer);
+			break;
+		case COL_TRES_IN_MAX_TASKID:
+			_pack_str(stats->tres_usage_in_max_taskid, buffer);
+			break;
+		case COL_TRES_IN_MIN:
+			_pack_str(stats->tres_usage_in_min, buffer);
+			break;
+		case COL_TRES_IN_MIN_NODEID:
+			_pack_str(stats->tres_usage_in_min_nodeid, buffer);
+			break;
+		case COL_TRES_IN_MIN_TASKID:
+			_pack_str(stats->tres_usage_in_min_taskid, buffer);
+			break;
+		case COL_TRES_IN_TOT:
+			_pack_str(stats->tres_usage_in_tot, buffer);
+			break;
+		case COL_TRES_OUT_AVE:
+			_pack_str(stats->tres_usage_out_ave, buffer);
+			break;
+		case COL_TRES_OUT_MAX:
+			_pack_str(stats->tres_usage_out_max, buffer);
+			break;
+		case COL_TRES_OUT_MAX_NODEID:
+			_pack_str(stats->tres_usage_out_max_nodeid, buffer);
+			break;
+		case COL_TRES_OUT_MAX_TASKID:
+			_pack_str(stats->tres_usage_out_max_taskid, buffer);
+			break;
+		case COL_TRES_OUT_MIN:
+			_pack_str(stats->tres_usage_out_min, buffer);
+			break;
+		case COL_TRES_OUT_MIN_NODEID:
+			_pack_str(stats->tres_usage_out_min_nodeid, buffer);
+			break;
+		case COL_TRES_OUT_MIN_TASKID:
+			_pack_str(stats->tres_usage_out_min_taskid, buffer);
+			break;
+		case COL_TRES_OUT_TOT:
+			_pack_str(stats->tres_usage_out_tot, buffer);
+			break;
+		default:
+			fatal_abort("%s: unknown column %d", __func__, i);
+		}
+	}
+
+	if (++row_count >= COLUMNAR_MAX_ROWS)
+		columnar_flush();
+}
+
+extern void columnar_begin(void)
+{
+	Buf buffer = init_buf(BUF_SIZE);
+
+	if (!g_tres_list) {
+		slurmdb_tres_cond_t tres_cond;
+		memset(&tres_cond, 0, sizeof(slurmdb_tres_cond_t));
+		tres_cond.with_deleted = 1;
+		g_tres_list = slurmdb_tres_get(acct_db_conn, &tres_cond);
+	}
+
+	packmem_array((char *) COLUMNAR_MAGIC, strlen(COLUMNAR_MAGIC), buffer);
+	pack16(COLUMNAR_VERSION, buffer);
+
+	if (g_tres_list) {
+		pack32(list_count(g_tres_list), buffer);
+		list_for_each(g_tres_list, _pack_tres, buffer);
+	} else
+		pack32(0, buffer);
+
+	pack32(COL_COUNT, buffer);
+	for (int i = 0; i < COL_COUNT; i++) {
+		_pack_str(columns[i].name, buffer);
+		pack8(columns[i].type, buffer);
+		column_bufs[i] = init_buf(BUF_SIZE);
+	}
+
+	_write_buf(buffer);
+	free_buf(buffer);
+}
+
+extern void columnar_add(type_t type, void *object)
+{
+	if (type == JOB) {
+		_add_row(object, NULL);
+	} else if (type == JOBSTEP) {
+		slurmdb_step_rec_t *step = object;
+
+		_add_row(step->job_ptr, step);
+	}
+}
+
+extern void columnar_flush(void)
+{
+	if (!row_count)
+		return;
+
+	_write_uint32(row_count);
+	for (int i = 0; i < COL_COUNT; i++) {
+		_write_uint32(get_buf_offset(column_bufs[i]));
+		_write_buf(column_bufs[i]);
+		set_buf_offset(column_bufs[i], 0);
+	}
+	row_count = 0;
+}
+
+extern void columnar_end(void)
+{
+	columnar_flush();
+	_write_uint32(0);
+
+	for (int i = 0; i < COL_COUNT; i++)
+		FREE_NULL_BUFFER(column_bufs[i]);
+}
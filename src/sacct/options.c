@@ -55,12 +55,14 @@
 #define OPT_LONG_FEDR      0x105
 #define OPT_LONG_WHETJOB   0x106
 #define OPT_LONG_LOCAL_UID 0x107
+#define OPT_LONG_COLUMNAR  0x108
 
 #define JOB_HASH_SIZE 1000
 
 static void _help_fields_msg(void);
 static void _help_msg(void);
 static void _init_params(void);
+static void _list_jobs(List job_list);
 static void _usage(void);
 
 List selected_parts = NULL;
@@ -331,6 +333,9 @@ sacct [<OPTION>]                                                            \n \
      -b, --brief:                                                           \n\
 	           Equivalent to '--format=jobstep,state,error'.            \n\
      -c, --completion: Use job completion instead of accounting data.       \n\
+         --columnar:                                                        \n\
+	           Write the raw job and step records in a binary columnar  \n\
+	           format instead of text, see the sacct man page.          \n\
          --delimiter:                                                       \n\
 	           ASCII characters used to separate the fields when        \n\
 	           specifying the  -p  or  -P options. The default delimiter\n\
@@ -596,40 +601,17 @@ static void _remove_duplicate_fed_jobs(List jobs)
 	xfree(hash_job);
 }
 
-extern int get_data(void)
+/* Add the usage of the completed steps of each job to the job */
+static void _aggregate_steps(List job_list)
 {
 	slurmdb_job_rec_t *job = NULL;
 	slurmdb_step_rec_t *step = NULL;
 	ListIterator itr = NULL;
 	ListIterator itr_step = NULL;
-	slurmdb_job_cond_t *job_cond = params.job_cond;
 	int cnt;
 	char *tmp_usage;
 
-	if (params.opt_completion) {
-		jobs = slurmdb_jobcomp_jobs_get(job_cond);
-		return SLURM_SUCCESS;
-	} else {
-		jobs = slurmdb_jobs_get(acct_db_conn, job_cond);
-	}
-
-	if (!jobs)
-		return SLURM_ERROR;
-
-	/*
-	 * Remove duplicate federated jobs. The db will remove duplicates for
-	 * one cluster but not when jobs for multiple clusters are requested.
-	 * Remove the current job if there were jobs with the same id submitted
-	 * in the future.
-	 * Else sort the jobs to order the jobs so the last task of arrays don't
-	 * appear to run before any of the other tasks.
-	 */
-	if (params.cluster_name && !(job_cond->flags & JOBCOND_FLAG_DUP))
-		_remove_duplicate_fed_jobs(jobs);
-	else
-		list_sort(jobs, _sort_desc_submit_time);
-
-	itr = list_iterator_create(jobs);
+	itr = list_iterator_create(job_list);
 	while ((job = list_next(itr))) {
 
 		if (!job->steps || !(cnt = list_count(job->steps)))
@@ -669,6 +651,62 @@ extern int get_data(void)
 		list_iterator_destroy(itr_step);
 	}
 	list_iterator_destroy(itr);
+}
+
+/*
+ * Print each part of the jobs as slurmdbd sends it. The parts cover
+ * consecutive ranges of submit time, so sorting each part gives the same
+ * order as sorting the whole list.
+ */
+static int _list_jobs_part(List job_list, void *arg)
+{
+	list_sort(job_list, _sort_desc_submit_time);
+	_aggregate_steps(job_list);
+	_list_jobs(job_list);
+	list_flush(job_list);
+
+	return SLURM_SUCCESS;
+}
+
+extern int get_data(void)
+{
+	slurmdb_job_cond_t *job_cond = params.job_cond;
+
+	if (params.opt_completion) {
+		jobs = slurmdb_jobcomp_jobs_get(job_cond);
+		return SLURM_SUCCESS;
+	}
+
+	/*
+	 * Unless duplicates need to be removed or the jobs of several
+	 * clusters sorted together, print them as they arrive rather than
+	 * holding all of them.
+	 */
+	if (!params.cluster_name &&
+	    (!job_cond->cluster_list ||
+	     (list_count(job_cond->cluster_list) <= 1)))
+		return slurmdb_jobs_get_stream(acct_db_conn, job_cond,
+					       _list_jobs_part, NULL);
+
+	jobs = slurmdb_jobs_get(acct_db_conn, job_cond);
+
+	if (!jobs)
+		return SLURM_ERROR;
+
+	/*
+	 * Remove duplicate federated jobs. The db will remove duplicates for
+	 * one cluster but not when jobs for multiple clusters are requested.
+	 * Remove the current job if there were jobs with the same id submitted
+	 * in the future.
+	 * Else sort the jobs to order the jobs so the last task of arrays don't
+	 * appear to run before any of the other tasks.
+	 */
+	if (params.cluster_name && !(job_cond->flags & JOBCOND_FLAG_DUP))
+		_remove_duplicate_fed_jobs(jobs);
+	else
+		list_sort(jobs, _sort_desc_submit_time);
+
+	_aggregate_steps(jobs);
 
 	return SLURM_SUCCESS;
 }
@@ -697,6 +735,7 @@ extern void parse_command_line(int argc, char **argv)
                 {"allocations",    no_argument,       0,    'X'},
                 {"brief",          no_argument,       0,    'b'},
                 {"completion",     no_argument,       0,    'c'},
+                {"columnar",       no_argument,       0,    OPT_LONG_COLUMNAR},
                 {"constraints",    required_argument, 0,    'C'},
                 {"delimiter",      required_argument, 0,    OPT_LONG_DELIMITER},
                 {"duplicates",     no_argument,       0,    'D'},
@@ -887,6 +926,9 @@ extern void parse_command_line(int argc, char **argv)
 		case 'l':
 			long_output = true;
 			break;
+		case OPT_LONG_COLUMNAR:
+			params.opt_columnar = true;
+			break;
 		case OPT_LONG_FEDR:
 			params.opt_federation = true;
 			all_clusters = false;
@@ -1112,6 +1154,12 @@ extern void parse_command_line(int argc, char **argv)
 	      job_cond->flags & JOBCOND_FLAG_WHOLE_HETJOB ? "yes" :
 	      (job_cond->flags & JOBCOND_FLAG_NO_WHOLE_HETJOB ? "no" : 0));
 
+	if (params.opt_columnar && params.opt_completion) {
+		fprintf(stderr,
+			"--columnar can not be used with --completion\n");
+		exit(1);
+	}
+
 	if (params.opt_completion) {
 		slurmdb_jobcomp_init(params.opt_filein);
 
@@ -1419,15 +1467,15 @@ static inline bool _test_local_job(uint32_t job_id)
 	return false;
 }
 
-/* do_list() -- List the assembled data
- *
- * In:	Nothing explicit.
- * Out:	void.
- *
- * At this point, we have already selected the desired data,
- * so we just need to print it for the user.
- */
-extern void do_list(void)
+static void _print_rec(type_t type, void *object)
+{
+	if (params.opt_columnar)
+		columnar_add(type, object);
+	else
+		print_fields(type, object);
+}
+
+static void _list_jobs(List job_list)
 {
 	ListIterator itr = NULL;
 	ListIterator itr_step = NULL;
@@ -1435,10 +1483,7 @@ extern void do_list(void)
 	slurmdb_step_rec_t *step = NULL;
 	slurmdb_job_cond_t *job_cond = params.job_cond;
 
-	if (!jobs)
-		return;
-
-	itr = list_iterator_create(jobs);
+	itr = list_iterator_create(job_list);
 	while ((job = list_next(itr))) {
 		if ((params.cluster_name) &&
 		    _test_local_job(job->jobid) &&
@@ -1446,7 +1491,7 @@ extern void do_list(void)
 			continue;
 
 		if (job->show_full)
-			print_fields(JOB, job);
+			_print_rec(JOB, job);
 
 		if (!(job_cond->flags & JOBCOND_FLAG_NO_STEP)
 		    && (job->track_steps || !job->show_full)) {
@@ -1454,12 +1499,33 @@ extern void do_list(void)
 			while ((step = list_next(itr_step))) {
 				if (step->end == 0)
 					step->end = job->end;
-				print_fields(JOBSTEP, step);
+				_print_rec(JOBSTEP, step);
 			}
 			list_iterator_destroy(itr_step);
 		}
 	}
 	list_iterator_destroy(itr);
+
+	/* each part of the jobs becomes a row group */
+	if (params.opt_columnar)
+		columnar_flush();
+}
+
+/* do_list() -- List the assembled data
+ *
+ * In:	Nothing explicit.
+ * Out:	void.
+ *
+ * At this point, we have already selected the desired data,
+ * so we just need to print it for the user. Jobs get_data() printed
+ * as they arrived are not in the list.
+ */
+extern void do_list(void)
+{
+	if (!jobs)
+		return;
+
+	_list_jobs(jobs);
 }
 
 /* do_list_completion() -- List the assembled data
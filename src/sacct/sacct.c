@@ -179,13 +179,26 @@ int main(int argc, char **argv)
 
 	switch (op) {
 	case SACCT_LIST:
-		print_fields_header(print_fields_list);
-		if (get_data() == SLURM_ERROR)
-			exit(errno);
+		if (params.opt_columnar)
+			columnar_begin();
+		else
+			print_fields_header(print_fields_list);
+		/*
+		 * When streaming, part of the jobs may have been printed
+		 * already, any error still has to fail the command.
+		 */
+		if ((rc = get_data()) != SLURM_SUCCESS) {
+			if (rc != SLURM_ERROR)
+				error("Unable to get the jobs: %s",
+				      slurm_strerror(rc));
+			exit(errno ? errno : 1);
+		}
 		if (params.opt_completion)
 			do_list_completion();
 		else
 			do_list();
+		if (params.opt_columnar)
+			columnar_end();
 		break;
 	case SACCT_HELP:
 		do_help();
@@ -198,6 +198,7 @@ typedef struct {
 	char *cluster_name;	/* Set if in federated cluster */
 	uint32_t convert_flags;	/* --noconvert */
 	slurmdb_job_cond_t *job_cond;
+	bool opt_columnar;	/* --columnar */
 	int opt_completion;	/* --completion */
 	bool opt_federation;	/* --federation */
 	char *opt_field_list;	/* --fields= */
@@ -220,6 +221,13 @@ extern ListIterator print_fields_itr;
 extern int field_count;
 extern List g_qos_list;
 extern List g_tres_list;
+extern void *acct_db_conn;
+
+/* columnar.c */
+void columnar_begin(void);
+void columnar_add(type_t type, void *object);
+void columnar_flush(void);
+void columnar_end(void);
 
 /* process.c */
 void aggregate_stats(slurmdb_stats_t *dest, slurmdb_stats_t *from);
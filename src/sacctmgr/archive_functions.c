@@ -42,6 +42,7 @@
 
 #include "src/sacctmgr/sacctmgr.h"
 #include <sys/param.h>		/* MAXPATHLEN */
+#include "src/common/archive_col.h"
 #include "src/common/proc_args.h"
 #include "src/common/util-net.h"
 
@@ -494,9 +495,15 @@ extern int sacctmgr_archive_load(int argc, char **argv)
 					make_full_path(arch_rec->archive_file);
 				xfree(file);
 			}
+		} else if (!xstrncasecmp(argv[i], "End",
+					 MAX(command_len, 1))) {
+			arch_rec->time_end = parse_time(argv[i]+end, 1);
 		} else if (!xstrncasecmp(argv[i], "Insert",
 					 MAX(command_len, 2))) {
 			arch_rec->insert = strip_quotes(argv[i]+end, NULL, 1);
+		} else if (!xstrncasecmp(argv[i], "Start",
+					 MAX(command_len, 1))) {
+			arch_rec->time_start = parse_time(argv[i]+end, 1);
 		} else {
 			exit_code = 1;
 			fprintf(stderr, " Unknown option: %s\n", argv[i]);
@@ -531,3 +538,155 @@ extern int sacctmgr_archive_load(int argc, char **argv)
 
 	return rc;
 }
+
+/*
+ * Print the records of a columnar archive file without going through the
+ * slurmdbd, the column names are those of the database table.
+ */
+extern int sacctmgr_archive_read(int argc, char **argv)
+{
+	char *file = NULL, *format = NULL, *tmp_char, *name;
+	time_t time_start = 0, time_end = 0;
+	archive_col_reader_t *reader;
+	archive_col_hdr_t *hdr;
+	List format_list, print_fields_list;
+	ListIterator itr;
+	print_field_t *field;
+	Buf buffer;
+	char **row;
+	uint32_t *col_inx;
+	int i, field_count, command_len = 0, rc = SLURM_SUCCESS;
+
+	for (i = 0; i < argc; i++) {
+		int end = parse_option_end(argv[i]);
+		if (!end)
+			command_len=strlen(argv[i]);
+		else {
+			command_len=end-1;
+			if (argv[i][end] == '=') {
+				end++;
+			}
+		}
+
+		if (!end
+		   || !xstrncasecmp(argv[i], "File", MAX(command_len, 1))) {
+			xfree(file);
+			file = strip_quotes(argv[i]+end, NULL, 0);
+		} else if (!xstrncasecmp(argv[i], "End",
+					 MAX(command_len, 1))) {
+			time_end = parse_time(argv[i]+end, 1);
+		} else if (!xstrncasecmp(argv[i], "Format",
+					 MAX(command_len, 1))) {
+			xfree(format);
+			format = strip_quotes(argv[i]+end, NULL, 0);
+		} else if (!xstrncasecmp(argv[i], "Start",
+					 MAX(command_len, 1))) {
+			time_start = parse_time(argv[i]+end, 1);
+		} else {
+			exit_code = 1;
+			fprintf(stderr, " Unknown option: %s\n", argv[i]);
+		}
+	}
+
+	if (!exit_code && !file) {
+		exit_code = 1;
+		fprintf(stderr, " You need to specify an archive File=\n");
+	}
+	if (exit_code) {
+		xfree(file);
+		xfree(format);
+		return SLURM_ERROR;
+	}
+
+	if (!(buffer = create_mmap_buf(file))) {
+		exit_code = 1;
+		fprintf(stderr, " Unable to read archive file %s: %m\n", file);
+		xfree(file);
+		xfree(format);
+		return SLURM_ERROR;
+	}
+	if (!archive_col_detect(buffer)) {
+		exit_code = 1;
+		fprintf(stderr, " %s is not a columnar archive file, it can only be loaded into the database.\n",
+			file);
+		rc = SLURM_ERROR;
+		goto end_it;
+	}
+	if (!(reader = archive_col_reader_create(buffer, time_start,
+						 time_end))) {
+		exit_code = 1;
+		fprintf(stderr, " Unable to read archive file %s\n", file);
+		rc = SLURM_ERROR;
+		goto end_it;
+	}
+	hdr = archive_col_reader_hdr(reader);
+
+	/* Default to all the columns of the table */
+	format_list = list_create(xfree_ptr);
+	if (format)
+		slurm_addto_char_list(format_list, format);
+	else
+		for (i = 0; i < hdr->col_cnt; i++)
+			slurm_addto_char_list(format_list, hdr->col_names[i]);
+
+	print_fields_list = list_create(destroy_print_field);
+	col_inx = xcalloc(list_count(format_list), sizeof(uint32_t));
+	itr = list_iterator_create(format_list);
+	while ((name = list_next(itr))) {
+		int width = 0;
+
+		if ((tmp_char = strstr(name, "%"))) {
+			width = atoi(tmp_char + 1);
+			tmp_char[0] = '\0';
+		}
+		for (i = 0; i < hdr->col_cnt; i++) {
+			if (!xstrcasecmp(name, hdr->col_names[i]))
+				break;
+		}
+		if (i >= hdr->col_cnt) {
+			exit_code = 1;
+			fprintf(stderr, " Unknown field '%s'\n", name);
+			continue;
+		}
+		col_inx[list_count(print_fields_list)] = i;
+		field = xmalloc(sizeof(print_field_t));
+		field->name = xstrdup(hdr->col_names[i]);
+		field->len = width ? width : MAX(strlen(field->name), 10);
+		field->print_routine = print_fields_str;
+		list_append(print_fields_list, field);
+	}
+	list_iterator_destroy(itr);
+	FREE_NULL_LIST(format_list);
+
+	if (exit_code) {
+		rc = SLURM_ERROR;
+		goto end_fields;
+	}
+
+	print_fields_header(print_fields_list);
+	field_count = list_count(print_fields_list);
+	itr = list_iterator_create(print_fields_list);
+	while ((archive_col_next_row(reader, &row) == SLURM_SUCCESS) && row) {
+		int curr_inx = 0;
+
+		while ((field = list_next(itr))) {
+			field->print_routine(field, row[col_inx[curr_inx]],
+					     (curr_inx + 1 == field_count));
+			curr_inx++;
+		}
+		list_iterator_reset(itr);
+		printf("\n");
+	}
+	list_iterator_destroy(itr);
+
+end_fields:
+	FREE_NULL_LIST(print_fields_list);
+	xfree(col_inx);
+	archive_col_reader_destroy(reader);
+end_it:
+	free_buf(buffer);
+	xfree(file);
+	xfree(format);
+
+	return rc;
+}
@@ -286,6 +286,13 @@ extern int sacctmgr_list_stats(int argc, char **argv)
 				}
 				printf("%-5s", rollup_interval_to_string(i));
 				_print_rollup_stats(rollup_stats, i);
+				if (i != DBD_ROLLUP_HOUR)
+					continue;
+				for (int j = 0; j < DBD_ROLLUP_PHASE_COUNT;
+				     j++)
+					printf("\t  %-13s %"PRIu64"\n",
+					       rollup_phase_to_string(j),
+					       rollup_stats->phase_time[j]);
 			}
 		}
 		list_iterator_destroy(itr);
@@ -592,6 +592,15 @@ static void _archive_it(int argc, char **argv)
 	int error_code = SLURM_SUCCESS;
 	int command_len = 0;
 
+	/* Reading an archive file does not need the database */
+	if (argv[0] && !xstrncasecmp(argv[0], "read",
+				     MAX(strlen(argv[0]), 1))) {
+		if (sacctmgr_archive_read((argc - 1), &argv[1]) !=
+		    SLURM_SUCCESS)
+			exit_code = 1;
+		return;
+	}
+
 	if (!have_db_conn) {
 		exit_code = 1;
 		return;
@@ -620,7 +629,7 @@ static void _archive_it(int argc, char **argv)
 		exit_code = 1;
 		fprintf(stderr, "No valid entity in archive command\n");
 		fprintf(stderr, "Input line must include, ");
-		fprintf(stderr, "\"Dump\", or \"load\"\n");
+		fprintf(stderr, "\"Dump\", \"load\" or \"read\"\n");
 	}
 
 	if (error_code != SLURM_SUCCESS) {
@@ -899,9 +908,9 @@ sacctmgr [<OPTION>] [<COMMAND>]                                            \n\
                                                                            \n\
   Valid <COMMAND> values are:                                              \n\
      add <ENTITY> <SPECS>     add entity                                   \n\
-     archive <DUMP/LOAD> <SPECS>                                           \n\
-                              Archive past jobs and/or steps, or load them \n\
-                              back into the databse.                       \n\
+     archive <DUMP/LOAD/READ> <SPECS>                                      \n\
+                              Archive past jobs and/or steps, load them    \n\
+                              back into the databse, or print an archive.  \n\
      associations             when using show/list will list the           \n\
                               associations associated with the entity.     \n\
      clear stats              clear server statistics                      \n\
@@ -1080,7 +1089,9 @@ sacctmgr [<OPTION>] [<COMMAND>]                                            \n\
                             PurgeStepAfter=, PurgeSuspendAfter=,           \n\
                             Script=, Steps, and Suspend                    \n\
                                                                            \n\
-       archive load       - File=, or Insert=                              \n\
+       archive load       - End=, File=, Insert=, and Start=               \n\
+                                                                           \n\
+       archive read       - End=, File=, Format=, and Start=               \n\
                                                                            \n\
   Format options are different for listing each entity pair.               \n\
                                                                            \n\
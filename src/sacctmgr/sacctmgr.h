@@ -287,6 +287,7 @@ extern int sacctmgr_dump_cluster(int argc, char **argv);
 
 extern int sacctmgr_archive_dump(int argc, char **argv);
 extern int sacctmgr_archive_load(int argc, char **argv);
+extern int sacctmgr_archive_read(int argc, char **argv);
 
 /* common.c */
 extern int parse_option_end(char *option);
@@ -193,6 +193,21 @@ static int _print_stats(void)
 		       buf->bf_table_size_sum / buf->bf_cycle_counter);
 	}
 
+	printf("\nPriority recalculation stats\n");
+	printf("\tTotal cycles: %u\n", buf->prio_cycle_counter);
+	printf("\tLast cycle: %u\n", buf->prio_cycle_last);
+	printf("\tMax cycle:  %u\n", buf->prio_cycle_max);
+	if (buf->prio_cycle_counter > 0) {
+		printf("\tMean cycle: %"PRIu64"\n",
+		       buf->prio_cycle_sum / buf->prio_cycle_counter);
+	}
+	printf("\tFairshare tree normalizations: %u\n",
+	       buf->prio_norm_counter);
+	printf("\tLast cycle jobs with changed factors: %u\n",
+	       buf->prio_last_jobs_moved);
+	printf("\tLast cycle jobs with unchanged factors: %u\n",
+	       buf->prio_last_jobs_same);
+
 	printf("\nLatency for 1000 calls to gettimeofday(): %d microseconds\n",
 	       buf->gettimeofday_latency);
 
@@ -318,6 +318,84 @@ static int _load_resv(reserve_info_msg_t **reserv_pptr, bool clear_old)
 	return SLURM_SUCCESS;
 }
 
+/*
+ * _build_state_filter - node states for node_info_filter_t that are matched
+ *	by every node _filter_out() keeps for params.state_list
+ * RET list of uint32_t * or NULL to not filter by state
+ */
+static List _build_state_filter(void)
+{
+	List states;
+	ListIterator iter;
+	int *node_state;
+
+	if (!params.state_list)
+		return NULL;
+
+	states = list_create(xfree_ptr);
+	iter = list_iterator_create(params.state_list);
+	while ((node_state = list_next(iter))) {
+		uint32_t *state;
+
+		if ((*node_state == NODE_STATE_ALLOCATED) ||
+		    (*node_state == NODE_STATE_MIXED)) {
+			/* Set here from allocated CPUs, not by slurmctld */
+			if (params.state_list_and)
+				continue;
+			FREE_NULL_LIST(states);
+			break;
+		}
+
+		state = xmalloc(sizeof(*state));
+		if (*node_state & NODE_STATE_DRAIN) /* DRAINING and DRAINED */
+			*state = NODE_STATE_DRAIN;
+		else
+			*state = *node_state;
+		list_append(states, state);
+	}
+	list_iterator_destroy(iter);
+
+	if (states && !list_count(states))
+		FREE_NULL_LIST(states);
+
+	return states;
+}
+
+/*
+ * _build_node_filter - build filter for slurm_load_node_filter(). slurmctld
+ *	sends a superset of the nodes _filter_out() keeps and leaves out the
+ *	strings that are neither printed nor sorted by.
+ */
+static node_info_filter_t *_build_node_filter(void)
+{
+	node_info_filter_t *filter = xmalloc(sizeof(*filter));
+	struct sinfo_match_flags *flags = &params.match_flags;
+	char *sort = params.sort;
+
+	filter->nodes = params.nodes;
+	filter->partitions = params.part_list;
+	filter->states = _build_state_filter();
+
+	filter->skip_fields = NODE_FIELD_OS | NODE_FIELD_MCS_LABEL |
+			      NODE_FIELD_CPU_SPEC | NODE_FIELD_TRES |
+			      NODE_FIELD_ENERGY;
+	if (!flags->hostnames_flag)
+		filter->skip_fields |= NODE_FIELD_HOSTNAME;
+	if (!flags->node_addr_flag)
+		filter->skip_fields |= NODE_FIELD_ADDR;
+	if (!flags->version_flag)
+		filter->skip_fields |= NODE_FIELD_VERSION;
+	if (!flags->features_flag && !flags->features_act_flag &&
+	    !xstrchr(sort, 'f') && !xstrchr(sort, 'b'))
+		filter->skip_fields |= NODE_FIELD_FEATURES;
+	if (!flags->gres_flag && !flags->gres_used_flag)
+		filter->skip_fields |= NODE_FIELD_GRES;
+	if (!flags->reason_flag && !xstrchr(sort, 'E'))
+		filter->skip_fields |= NODE_FIELD_REASON;
+
+	return filter;
+}
+
 /*
  * _query_server - download the current server state
  * clear_old IN - If set, then always replace old data, needed when going
@@ -328,6 +406,7 @@ static List _query_server(bool clear_old)
 {
 	static partition_info_msg_t *old_part_ptr = NULL, *new_part_ptr;
 	static node_info_msg_t *old_node_ptr = NULL, *new_node_ptr;
+	static node_info_filter_t *filter = NULL;
 	int error_code;
 	uint16_t show_flags = 0;
 	int cc;
@@ -362,6 +441,9 @@ static List _query_server(bool clear_old)
 	if (params.match_flags.gres_used_flag)
 		show_flags |= SHOW_DETAIL;
 
+	if (!filter && !params.node_name_single)
+		filter = _build_node_filter();
+
 	if (old_node_ptr) {
 		if (clear_old)
 			old_node_ptr->last_update = 0;
@@ -370,8 +452,9 @@ static List _query_server(bool clear_old)
 							    params.nodes,
 							    show_flags);
 		} else {
-			error_code = slurm_load_node(old_node_ptr->last_update,
-						     &new_node_ptr, show_flags);
+			error_code = slurm_load_node_filter(
+				old_node_ptr->last_update, &new_node_ptr,
+				show_flags, filter);
 		}
 		if (error_code == SLURM_SUCCESS)
 			slurm_free_node_info_msg(old_node_ptr);
@@ -383,8 +466,9 @@ static List _query_server(bool clear_old)
 		error_code = slurm_load_node_single(&new_node_ptr, params.nodes,
 						    show_flags);
 	} else {
-		error_code = slurm_load_node((time_t) NULL, &new_node_ptr,
-					     show_flags);
+		error_code = slurm_load_node_filter((time_t) NULL,
+						    &new_node_ptr, show_flags,
+						    filter);
 	}
 	if (error_code) {
 		slurm_perror("slurm_load_node");
@@ -105,6 +105,7 @@
 #define RPC_PACK_MAX_AGE	30	/* Rebuild data over 30 seconds old */
 #define DUMP_RPC_COUNT 		25
 #define HOSTLIST_MAX_SIZE 	80
+#define MAX_BATCH_LAUNCH_MULT	1024	/* max jobs per batched launch RPC */
 
 typedef enum {
 	DSH_NEW,        /* Request not yet started */
@@ -177,6 +178,9 @@ typedef struct mail_info {
 static void _agent_defer(void);
 static void _agent_retry(int min_wait, bool wait_too);
 static int  _batch_launch_defer(queued_request_t *queued_req_ptr);
+static void _batch_launch_list_complete(List launch_list, bool requeue,
+					uint32_t job_return_code);
+static agent_arg_t *_batch_launch_merge(agent_arg_t *agent_arg_ptr);
 static void _reboot_from_ctld(agent_arg_t *agent_arg_ptr);
 static int  _signal_defer(queued_request_t *queued_req_ptr);
 static inline int _comm_err(char *node_name, slurm_msg_type_t msg_type);
@@ -729,6 +733,19 @@ static void _notify_slurmctld_nodes(agent_info_t *agent_ptr,
 			job_complete(job_id, slurm_conf.slurm_user_id,
 				     true, false, 0);
 			unlock_slurmctld(job_write_lock);
+		} else if (agent_ptr->msg_type ==
+			   REQUEST_BATCH_JOB_LAUNCH_MULT) {
+			/* Requeue every job of the batch */
+			List launch_list = *agent_ptr->msg_args_pptr;
+			/* Locks: Write job, write node, read federation */
+			slurmctld_lock_t job_write_lock =
+				{ .job  = WRITE_LOCK,
+				  .node = WRITE_LOCK,
+				  .fed  = READ_LOCK };
+
+			lock_slurmctld(job_write_lock);
+			_batch_launch_list_complete(launch_list, true, 0);
+			unlock_slurmctld(job_write_lock);
 		}
 	}
 	if (retry_cnt && agent_ptr->retry)
@@ -1035,6 +1052,20 @@ static void *_thread_per_group_rpc(void *args)
 			             false, false, _wif_status());
 			unlock_slurmctld(job_write_lock);
 			continue;
+		} else if ((msg_type == REQUEST_BATCH_JOB_LAUNCH_MULT) &&
+			   (rc != SLURM_SUCCESS) &&
+			   (ret_data_info->type != RESPONSE_FORWARD_FAILED)) {
+			List launch_list = task_ptr->msg_args_ptr;
+			info("Killing %d non-startable batch jobs on %s: %s",
+			     list_count(launch_list), ret_data_info->node_name,
+			     slurm_strerror(rc));
+			thread_state = DSH_DONE;
+			ret_data_info->err = thread_state;
+			lock_slurmctld(job_write_lock);
+			_batch_launch_list_complete(launch_list, false,
+						    _wif_status());
+			unlock_slurmctld(job_write_lock);
+			continue;
 		} else if ((msg_type == RESPONSE_RESOURCE_ALLOCATION) &&
 			   (rc == SLURM_COMMUNICATIONS_CONNECTION_ERROR)) {
 			/* Communication issue to srun that launched the job
@@ -1643,6 +1674,13 @@ static void _agent_retry(int min_wait, bool mail_too)
 		}
 		list_iterator_destroy(retry_iter);
 	}
+	/* Only merge into a fresh launch, never into one being retried */
+	if (queued_req_ptr && queued_req_ptr->agent_arg_ptr &&
+	    (queued_req_ptr->last_attempt == 0) &&
+	    (queued_req_ptr->agent_arg_ptr->msg_type ==
+	     REQUEST_BATCH_JOB_LAUNCH))
+		queued_req_ptr->agent_arg_ptr =
+			_batch_launch_merge(queued_req_ptr->agent_arg_ptr);
 	slurm_mutex_unlock(&retry_mutex);
 
 	if (queued_req_ptr) {
@@ -1786,6 +1824,10 @@ static void _purge_agent_args(agent_arg_t *agent_arg_ptr)
 	if (agent_arg_ptr->msg_args) {
 		if (agent_arg_ptr->msg_type == REQUEST_BATCH_JOB_LAUNCH) {
 			slurm_free_job_launch_msg(agent_arg_ptr->msg_args);
+		} else if (agent_arg_ptr->msg_type ==
+			   REQUEST_BATCH_JOB_LAUNCH_MULT) {
+			List launch_list = agent_arg_ptr->msg_args;
+			FREE_NULL_LIST(launch_list);
 		} else if (agent_arg_ptr->msg_type ==
 				RESPONSE_RESOURCE_ALLOCATION) {
 			resource_allocation_response_msg_t *alloc_msg =
@@ -2100,6 +2142,121 @@ extern void mail_job_info(job_record_t *job_ptr, uint16_t mail_type)
 	return;
 }
 
+/*
+ * Complete every job of a failed REQUEST_BATCH_JOB_LAUNCH_MULT
+ * NOTE: Caller must hold the job write lock
+ */
+static void _batch_launch_list_complete(List launch_list, bool requeue,
+					uint32_t job_return_code)
+{
+	batch_job_launch_msg_t *launch_msg_ptr;
+	ListIterator itr;
+
+	itr = list_iterator_create(launch_list);
+	while ((launch_msg_ptr = list_next(itr))) {
+		job_complete(launch_msg_ptr->job_id, slurm_conf.slurm_user_id,
+			     requeue, false, job_return_code);
+	}
+	list_iterator_destroy(itr);
+}
+
+static int _batch_launch_mult_cnt(void)
+{
+	static time_t sched_update = 0;
+	static int mult_cnt = 0;
+	char *tmp_ptr;
+
+	if (sched_update != slurm_conf.last_update) {
+		mult_cnt = 0;
+		if ((tmp_ptr = xstrcasestr(slurm_conf.sched_params,
+					   "batch_launch_mult="))) {
+			mult_cnt = atoi(tmp_ptr + 18);
+			if ((mult_cnt < 0) ||
+			    (mult_cnt > MAX_BATCH_LAUNCH_MULT)) {
+				error("Invalid batch_launch_mult: %d",
+				      mult_cnt);
+				mult_cnt = 0;
+			}
+		}
+		sched_update = slurm_conf.last_update;
+	}
+
+	return mult_cnt;
+}
+
+/*
+ * Merge never tried batch launch requests for the same node into a single
+ * REQUEST_BATCH_JOB_LAUNCH_MULT, so that starting many short jobs (e.g. job
+ * arrays) on a node costs one RPC rather than one per job.
+ * Enabled with SchedulerParameters=batch_launch_mult=<max_jobs_per_rpc>.
+ * NOTE: Caller must hold retry_mutex
+ * IN agent_arg_ptr - never tried REQUEST_BATCH_JOB_LAUNCH just taken from
+ *	retry_list
+ * RET agent_arg_ptr if nothing could be merged, otherwise a new
+ *	REQUEST_BATCH_JOB_LAUNCH_MULT request replacing it
+ */
+static agent_arg_t *_batch_launch_merge(agent_arg_t *agent_arg_ptr)
+{
+	queued_request_t *queued_req_ptr;
+	agent_arg_t *merge_arg_ptr, *mult_arg_ptr;
+	ListIterator retry_iter;
+	List launch_list = NULL;
+	char *hostname;
+	int max_cnt, cnt = 1;
+
+	if (!retry_list ||
+	    (agent_arg_ptr->protocol_version < SLURM_20_11_PROTOCOL_VERSION) ||
+	    ((max_cnt = _batch_launch_mult_cnt()) < 2))
+		return agent_arg_ptr;
+
+	if (!(hostname = hostlist_nth(agent_arg_ptr->hostlist, 0)))
+		return agent_arg_ptr;
+
+	retry_iter = list_iterator_create(retry_list);
+	while ((cnt < max_cnt) && (queued_req_ptr = list_next(retry_iter))) {
+		merge_arg_ptr = queued_req_ptr->agent_arg_ptr;
+		if ((queued_req_ptr->last_attempt != 0) ||
+		    (merge_arg_ptr->msg_type != REQUEST_BATCH_JOB_LAUNCH) ||
+		    (merge_arg_ptr->protocol_version !=
+		     agent_arg_ptr->protocol_version) ||
+		    (hostlist_find(merge_arg_ptr->hostlist, hostname) < 0))
+			continue;
+
+		if (!launch_list) {
+			launch_list =
+				list_create(slurm_free_job_launch_msg_list);
+			list_append(launch_list, agent_arg_ptr->msg_args);
+			agent_arg_ptr->msg_args = NULL;
+		}
+		list_append(launch_list, merge_arg_ptr->msg_args);
+		merge_arg_ptr->msg_args = NULL;
+		list_delete_item(retry_iter);	/* purges merge_arg_ptr */
+		cnt++;
+	}
+	list_iterator_destroy(retry_iter);
+
+	if (!launch_list) {
+		free(hostname);
+		return agent_arg_ptr;
+	}
+
+	log_flag(AGENT, "%s: merged %d batch job launch requests for node %s",
+		 __func__, cnt, hostname);
+	free(hostname);
+
+	mult_arg_ptr = xmalloc(sizeof(agent_arg_t));
+	mult_arg_ptr->protocol_version = agent_arg_ptr->protocol_version;
+	mult_arg_ptr->node_count = 1;
+	mult_arg_ptr->retry = 0;
+	mult_arg_ptr->hostlist = agent_arg_ptr->hostlist;
+	agent_arg_ptr->hostlist = NULL;
+	mult_arg_ptr->msg_type = REQUEST_BATCH_JOB_LAUNCH_MULT;
+	mult_arg_ptr->msg_args = launch_list;
+	_purge_agent_args(agent_arg_ptr);
+
+	return mult_arg_ptr;
+}
+
 /* Test if a batch launch request should be defered
  * RET -1: abort the request, pending job cancelled
  *      0: execute the request now
@@ -2124,7 +2124,7 @@ extern int _handle_fed_send_job_sync(fed_job_update_info_t *job_update_info)
 	sync_time = time(NULL);
 	jobids = _get_sync_jobid_list(sibling->fed.id, sync_time);
 	pack_spec_jobs(&dump, &dump_size, jobids, SHOW_ALL,
-	               slurm_conf.slurm_user_id, NO_VAL,
+	               slurm_conf.slurm_user_id, NO_VAL, NULL,
 	               sibling->rpc_version);
 	FREE_NULL_LIST(jobids);
 
@@ -137,6 +137,8 @@ typedef struct {
 
 typedef struct {
 	Buf       buffer;
+	job_info_filter_t *filter;
+	bitstr_t *filter_nodes;
 	uint32_t  filter_uid;
 	uint32_t *jobs_packed;
 	uint16_t  protocol_version;
@@ -144,6 +146,7 @@ typedef struct {
 	uid_t     uid;
 } _foreach_pack_job_info_t;
 
+
 typedef struct {
 	bitstr_t *node_map;
 	int rc;
@@ -218,10 +221,12 @@ static void _notify_srun_missing_step(job_record_t *job_ptr, int node_inx,
 static Buf  _open_job_state_file(char **state_file);
 static time_t _get_last_job_state_write_time(void);
 static void _pack_default_job_details(job_record_t *job_ptr, Buf buffer,
-				      uint16_t protocol_version);
+				      uint16_t protocol_version,
+				      uint32_t skip_fields);
 static void _pack_pending_job_details(struct job_details *detail_ptr,
 				      Buf buffer,
-				      uint16_t protocol_version);
+				      uint16_t protocol_version,
+				      uint32_t skip_fields);
 static bool _parse_array_tok(char *tok, bitstr_t *array_bitmap, uint32_t max);
 static void _purge_missing_jobs(int node_inx, time_t now);
 static int  _read_data_array_from_file(int fd, char *file_name, char ***data,
@@ -9638,6 +9643,133 @@ static bool _hide_job(job_record_t *job_ptr, uid_t uid, uint16_t show_flags)
 	return false;
 }
 
+static int _find_str_case(void *x, void *key)
+{
+	return !xstrcasecmp(x, key);
+}
+
+static int _find_part_name(void *x, void *key)
+{
+	char *tmp, *tok, *save_ptr = NULL;
+	int rc = 0;
+
+	if (!key)
+		return 0;
+
+	/* Pending jobs may have been submitted to several partitions */
+	tmp = xstrdup(key);
+	tok = strtok_r(tmp, ",", &save_ptr);
+	while (tok && !rc) {
+		rc = !xstrcmp(x, tok);
+		tok = strtok_r(NULL, ",", &save_ptr);
+	}
+	xfree(tmp);
+
+	return rc;
+}
+
+static int _find_job_state(void *x, void *key)
+{
+	uint32_t state = *(uint32_t *) x, job_state = *(uint32_t *) key;
+
+	if (state & JOB_STATE_FLAGS)
+		return ((job_state & state) != 0);
+	return ((job_state & JOB_STATE_BASE) == state);
+}
+
+static int _find_uint32(void *x, void *key)
+{
+	return (*(uint32_t *) x == *(uint32_t *) key);
+}
+
+/*
+ * Test if job matches filter of REQUEST_JOB_INFO_FILTER. Clients filter the
+ * jobs again so this must never reject a job they would show.
+ */
+static bool _match_job_filter(job_record_t *job_ptr,
+			      _foreach_pack_job_info_t *pack_info)
+{
+	job_info_filter_t *filter = pack_info->filter;
+	char *part_name;
+	bitstr_t *node_bitmap;
+
+	if (filter->user_ids &&
+	    !list_find_first(filter->user_ids, _find_uint32,
+			     &job_ptr->user_id))
+		return false;
+
+	if (filter->states &&
+	    !list_find_first(filter->states, _find_job_state,
+			     &job_ptr->job_state))
+		return false;
+
+	if (filter->accounts &&
+	    (!job_ptr->account ||
+	     !list_find_first(filter->accounts, _find_str_case,
+			      job_ptr->account)))
+		return false;
+
+	if (filter->names &&
+	    (!job_ptr->name ||
+	     !list_find_first(filter->names, _find_str_case, job_ptr->name)))
+		return false;
+
+	if (filter->partitions) {
+		if (!IS_JOB_PENDING(job_ptr) && job_ptr->part_ptr)
+			part_name = job_ptr->part_ptr->name;
+		else
+			part_name = job_ptr->partition;
+		if (!list_find_first(filter->partitions, _find_part_name,
+				     part_name))
+			return false;
+	}
+
+	if (filter->qos && job_ptr->qos_ptr) {
+		assoc_mgr_lock_t locks = { .qos = READ_LOCK };
+		bool match;
+
+		assoc_mgr_lock(&locks);
+		match = list_find_first(filter->qos, _find_str_case,
+					job_ptr->qos_ptr->name);
+		assoc_mgr_unlock(&locks);
+		if (!match)
+			return false;
+	}
+
+	if (filter->reservation &&
+	    xstrcmp(filter->reservation, job_ptr->resv_name))
+		return false;
+
+	if (pack_info->filter_nodes) {
+		if (IS_JOB_COMPLETING(job_ptr))
+			node_bitmap = job_ptr->node_bitmap_cg;
+		else
+			node_bitmap = job_ptr->node_bitmap;
+		if (!node_bitmap ||
+		    !bit_overlap_any(node_bitmap, pack_info->filter_nodes))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Build bitmap of nodes in filter. Jobs are not filtered by node if any of
+ * the names is unknown as clients may still match them.
+ */
+static void _set_filter_nodes(_foreach_pack_job_info_t *pack_info)
+{
+	if (!pack_info->filter || !pack_info->filter->nodes)
+		return;
+
+	if (node_name2bitmap(pack_info->filter->nodes, false,
+			     &pack_info->filter_nodes)) {
+		debug2("%s: ignoring invalid node filter %s",
+		       __func__, pack_info->filter->nodes);
+		FREE_NULL_BITMAP(pack_info->filter_nodes);
+	}
+}
+
 static int _pack_job(void *object, void *arg)
 {
 	job_record_t *job_ptr = (job_record_t *)object;
@@ -9657,8 +9789,12 @@ static int _pack_job(void *object, void *arg)
 	if (_hide_job(job_ptr, pack_info->uid, pack_info->show_flags))
 		return SLURM_SUCCESS;
 
+	if (pack_info->filter && !_match_job_filter(job_ptr, pack_info))
+		return SLURM_SUCCESS;
+
 	pack_job(job_ptr, pack_info->show_flags, pack_info->buffer,
-		 pack_info->protocol_version, pack_info->uid);
+		 pack_info->protocol_version, pack_info->uid,
+		 (pack_info->filter ? pack_info->filter->skip_fields : 0));
 
 	(*pack_info->jobs_packed)++;
 
@@ -9685,6 +9821,7 @@ static int _foreach_pack_jobid(void *object, void *arg)
  * IN show_flags - job filtering options
  * IN uid - uid of user making request (for partition filtering)
  * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * IN filter - pack only jobs matching filter if not NULL
  * global: job_list - global list of job records
  * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
  * NOTE: change _unpack_job_desc_msg() in common/slurm_protocol_pack.c
@@ -9692,7 +9829,7 @@ static int _foreach_pack_jobid(void *object, void *arg)
  */
 extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 			  uint16_t show_flags, uid_t uid, uint32_t filter_uid,
-			  uint16_t protocol_version)
+			  job_info_filter_t *filter, uint16_t protocol_version)
 {
 	uint32_t jobs_packed = 0, tmp_offset;
 	_foreach_pack_job_info_t pack_info = {0};
@@ -9710,13 +9847,16 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 
 	/* write individual job records */
 	pack_info.buffer           = buffer;
+	pack_info.filter           = filter;
 	pack_info.filter_uid       = filter_uid;
 	pack_info.jobs_packed      = &jobs_packed;
 	pack_info.protocol_version = protocol_version;
 	pack_info.show_flags       = show_flags;
 	pack_info.uid              = uid;
+	_set_filter_nodes(&pack_info);
 
 	list_for_each(job_list, _pack_job, &pack_info);
+	FREE_NULL_BITMAP(pack_info.filter_nodes);
 
 	/* put the real record count in the message body header */
 	tmp_offset = get_buf_offset(buffer);
@@ -9737,6 +9877,7 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
  * IN job_ids - list of job_ids to pack
  * IN uid - uid of user making request (for partition filtering)
  * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * IN filter - pack only jobs matching filter if not NULL
  * global: job_list - global list of job records
  * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
  * NOTE: change _unpack_job_desc_msg() in common/slurm_protocol_pack.c
@@ -9744,6 +9885,7 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
  */
 extern void pack_spec_jobs(char **buffer_ptr, int *buffer_size, List job_ids,
 			   uint16_t show_flags, uid_t uid, uint32_t filter_uid,
+			   job_info_filter_t *filter,
 			   uint16_t protocol_version)
 {
 	uint32_t jobs_packed = 0, tmp_offset;
@@ -9764,13 +9906,16 @@ extern void pack_spec_jobs(char **buffer_ptr, int *buffer_size, List job_ids,
 
 	/* write individual job records */
 	pack_info.buffer           = buffer;
+	pack_info.filter           = filter;
 	pack_info.filter_uid       = filter_uid;
 	pack_info.jobs_packed      = &jobs_packed;
 	pack_info.protocol_version = protocol_version;
 	pack_info.show_flags       = show_flags;
 	pack_info.uid              = uid;
+	_set_filter_nodes(&pack_info);
 
 	list_for_each(job_ids, _foreach_pack_jobid, &pack_info);
+	FREE_NULL_BITMAP(pack_info.filter_nodes);
 
 	/* put the real record count in the message body header */
 	tmp_offset = get_buf_offset(buffer);
@@ -9793,7 +9938,7 @@ static int _pack_het_job(job_record_t *job_ptr, uint16_t show_flags,
 	while ((het_job_ptr = list_next(iter))) {
 		if (het_job_ptr->het_job_id == job_ptr->het_job_id) {
 			pack_job(het_job_ptr, show_flags, buffer,
-				 protocol_version, uid);
+				 protocol_version, uid, 0);
 			job_cnt++;
 		} else {
 			error("%s: Bad het_job_list for %pJ",
@@ -9848,7 +9993,7 @@ extern int pack_one_job(char **buffer_ptr, int *buffer_size,
 		/* Pack regular (not array) job */
 		if (!_hide_job(job_ptr, uid, show_flags)) {
 			pack_job(job_ptr, show_flags, buffer, protocol_version,
-				 uid);
+				 uid, 0);
 			jobs_packed++;
 		}
 	} else {
@@ -9859,7 +10004,7 @@ extern int pack_one_job(char **buffer_ptr, int *buffer_size,
 			packed_head = true;
 			if (!_hide_job(job_ptr, uid, show_flags)) {
 				pack_job(job_ptr, show_flags, buffer,
-					 protocol_version, uid);
+					 protocol_version, uid, 0);
 				jobs_packed++;
 			}
 		}
@@ -9872,7 +10017,7 @@ extern int pack_one_job(char **buffer_ptr, int *buffer_size,
 				if (_hide_job(job_ptr, uid, show_flags))
 					break;
 				pack_job(job_ptr, show_flags, buffer,
-					 protocol_version, uid);
+					 protocol_version, uid, 0);
 				jobs_packed++;
 			}
 			job_ptr = job_ptr->job_array_next_j;
@@ -9896,6 +10041,12 @@ extern int pack_one_job(char **buffer_ptr, int *buffer_size,
 	return SLURM_SUCCESS;
 }
 
+/* Return value unless its JOB_FIELD_* group is in skip_fields */
+static char *_skip_field(uint32_t skip_fields, uint32_t field, char *value)
+{
+	return ((skip_fields & field) ? NULL : value);
+}
+
 static void _pack_job_gres(job_record_t *dump_job_ptr, Buf buffer,
 			   uint16_t protocol_version)
 {
@@ -9917,11 +10068,12 @@ static void _pack_job_gres(job_record_t *dump_job_ptr, Buf buffer,
  * IN/OUT buffer - buffer in which data is placed, pointers automatically
  *	updated
  * IN uid - user requesting the data
+ * IN skip_fields - JOB_FIELD_* to pack empty
  * NOTE: change _unpack_job_info_members() in common/slurm_protocol_pack.c
  *	  whenever the data format changes
  */
 void pack_job(job_record_t *dump_job_ptr, uint16_t show_flags, Buf buffer,
-	      uint16_t protocol_version, uid_t uid)
+	      uint16_t protocol_version, uid_t uid, uint32_t skip_fields)
 {
 	struct job_details *detail_ptr;
 	time_t accrue_time = 0, begin_time = 0, start_time = 0, end_time = 0;
@@ -10039,22 +10191,27 @@ void pack_job(job_record_t *dump_job_ptr, uint16_t show_flags, Buf buffer,
 			xfree(nodelist);
 		}
 
-		packstr(dump_job_ptr->sched_nodes, buffer);
+		packstr(_skip_field(skip_fields, JOB_FIELD_SCHED_NODES,
+				    dump_job_ptr->sched_nodes), buffer);
 
 		if (!IS_JOB_PENDING(dump_job_ptr) && dump_job_ptr->part_ptr)
 			packstr(dump_job_ptr->part_ptr->name, buffer);
 		else
 			packstr(dump_job_ptr->partition, buffer);
 		packstr(dump_job_ptr->account, buffer);
-		packstr(dump_job_ptr->admin_comment, buffer);
+		packstr(_skip_field(skip_fields, JOB_FIELD_COMMENT,
+				    dump_job_ptr->admin_comment), buffer);
 		pack32(dump_job_ptr->site_factor, buffer);
 		packstr(dump_job_ptr->network, buffer);
-		packstr(dump_job_ptr->comment, buffer);
-		packstr(dump_job_ptr->batch_features, buffer);
+		packstr(_skip_field(skip_fields, JOB_FIELD_COMMENT,
+				    dump_job_ptr->comment), buffer);
+		packstr(_skip_field(skip_fields, JOB_FIELD_FEATURES,
+				    dump_job_ptr->batch_features), buffer);
 		packstr(dump_job_ptr->batch_host, buffer);
 		packstr(dump_job_ptr->burst_buffer, buffer);
 		packstr(dump_job_ptr->burst_buffer_state, buffer);
-		packstr(dump_job_ptr->system_comment, buffer);
+		packstr(_skip_field(skip_fields, JOB_FIELD_COMMENT,
+				    dump_job_ptr->system_comment), buffer);
 
 		assoc_mgr_lock(&locks);
 		if (dump_job_ptr->qos_ptr)
@@ -10087,7 +10244,8 @@ void pack_job(job_record_t *dump_job_ptr, uint16_t show_flags, Buf buffer,
 		pack32(dump_job_ptr->exit_code, buffer);
 		pack32(dump_job_ptr->derived_ec, buffer);
 
-		packstr(dump_job_ptr->gres_used, buffer);
+		packstr(_skip_field(skip_fields, JOB_FIELD_GRES,
+				    dump_job_ptr->gres_used), buffer);
 		if (show_flags & SHOW_DETAIL) {
 			pack_job_resources(dump_job_ptr->job_resrcs, buffer,
 					   protocol_version);
@@ -10104,7 +10262,9 @@ void pack_job(job_record_t *dump_job_ptr, uint16_t show_flags, Buf buffer,
 		pack32(dump_job_ptr->wait4switch, buffer);
 
 		packstr(dump_job_ptr->alloc_node, buffer);
-		if (!IS_JOB_COMPLETING(dump_job_ptr))
+		if (skip_fields & JOB_FIELD_NODE_INX)
+			pack_bit_str_hex(NULL, buffer);
+		else if (!IS_JOB_COMPLETING(dump_job_ptr))
 			pack_bit_str_hex(dump_job_ptr->node_bitmap, buffer);
 		else
 			pack_bit_str_hex(dump_job_ptr->node_bitmap_cg, buffer);
@@ -10114,22 +10274,27 @@ void pack_job(job_record_t *dump_job_ptr, uint16_t show_flags, Buf buffer,
 
 		/* A few details are always dumped here */
 		_pack_default_job_details(dump_job_ptr, buffer,
-					  protocol_version);
+					  protocol_version, skip_fields);
 
 		/* other job details are only dumped until the job starts
 		 * running (at which time they become meaningless) */
 		if (detail_ptr)
 			_pack_pending_job_details(detail_ptr, buffer,
-						  protocol_version);
+						  protocol_version,
+						  skip_fields);
 		else
 			_pack_pending_job_details(NULL, buffer,
-						  protocol_version);
+						  protocol_version,
+						  skip_fields);
 		pack32(dump_job_ptr->bit_flags, buffer);
-		packstr(dump_job_ptr->tres_fmt_alloc_str, buffer);
-		packstr(dump_job_ptr->tres_fmt_req_str, buffer);
+		packstr(_skip_field(skip_fields, JOB_FIELD_TRES,
+				    dump_job_ptr->tres_fmt_alloc_str), buffer);
+		packstr(_skip_field(skip_fields, JOB_FIELD_TRES,
+				    dump_job_ptr->tres_fmt_req_str), buffer);
 		pack16(dump_job_ptr->start_protocol_ver, buffer);
 
-		if (dump_job_ptr->fed_details) {
+		if (dump_job_ptr->fed_details &&
+		    !(skip_fields & JOB_FIELD_FED)) {
 			packstr(dump_job_ptr->fed_details->origin_str, buffer);
 			pack64(dump_job_ptr->fed_details->siblings_active,
 			       buffer);
@@ -10147,17 +10312,23 @@ void pack_job(job_record_t *dump_job_ptr, uint16_t show_flags, Buf buffer,
 			packnull(buffer);
 		}
 
-		packstr(dump_job_ptr->cpus_per_tres, buffer);
-		packstr(dump_job_ptr->mem_per_tres, buffer);
-		packstr(dump_job_ptr->tres_bind, buffer);
-		packstr(dump_job_ptr->tres_freq, buffer);
-		packstr(dump_job_ptr->tres_per_job, buffer);
-		packstr(dump_job_ptr->tres_per_node, buffer);
-		packstr(dump_job_ptr->tres_per_socket, buffer);
-		packstr(dump_job_ptr->tres_per_task, buffer);
+		if (skip_fields & JOB_FIELD_TRES) {
+			for (int i = 0; i < 8; i++)
+				packnull(buffer);
+		} else {
+			packstr(dump_job_ptr->cpus_per_tres, buffer);
+			packstr(dump_job_ptr->mem_per_tres, buffer);
+			packstr(dump_job_ptr->tres_bind, buffer);
+			packstr(dump_job_ptr->tres_freq, buffer);
+			packstr(dump_job_ptr->tres_per_job, buffer);
+			packstr(dump_job_ptr->tres_per_node, buffer);
+			packstr(dump_job_ptr->tres_per_socket, buffer);
+			packstr(dump_job_ptr->tres_per_task, buffer);
+		}
 
 		pack16(dump_job_ptr->mail_type, buffer);
-		packstr(dump_job_ptr->mail_user, buffer);
+		packstr(_skip_field(skip_fields, JOB_FIELD_MAIL,
+				    dump_job_ptr->mail_user), buffer);
 	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		detail_ptr = dump_job_ptr->details;
 		pack32(dump_job_ptr->array_job_id, buffer);
@@ -10342,16 +10513,16 @@ void pack_job(job_record_t *dump_job_ptr, uint16_t show_flags, Buf buffer,
 
 		/* A few details are always dumped here */
 		_pack_default_job_details(dump_job_ptr, buffer,
-					  protocol_version);
+					  protocol_version, 0);
 
 		/* other job details are only dumped until the job starts
 		 * running (at which time they become meaningless) */
 		if (detail_ptr)
 			_pack_pending_job_details(detail_ptr, buffer,
-						  protocol_version);
+						  protocol_version, 0);
 		else
 			_pack_pending_job_details(NULL, buffer,
-						  protocol_version);
+						  protocol_version, 0);
 		pack32(dump_job_ptr->bit_flags, buffer);
 		packstr(dump_job_ptr->tres_fmt_alloc_str, buffer);
 		packstr(dump_job_ptr->tres_fmt_req_str, buffer);
@@ -10417,7 +10588,8 @@ static void _find_node_config(int *cpu_cnt_ptr, int *core_cnt_ptr)
 
 /* pack default job details for "get_job_info" RPC */
 static void _pack_default_job_details(job_record_t *job_ptr, Buf buffer,
-				      uint16_t protocol_version)
+				      uint16_t protocol_version,
+				      uint32_t skip_fields)
 {
 	int max_cpu_cnt = -1, max_core_cnt = -1;
 	int i;
@@ -10457,12 +10629,18 @@ static void _pack_default_job_details(job_record_t *job_ptr, Buf buffer,
 
 	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		if (detail_ptr) {
-			packstr(detail_ptr->features,   buffer);
-			packstr(detail_ptr->cluster_features, buffer);
-			packstr(detail_ptr->work_dir,   buffer);
-			packstr(detail_ptr->dependency, buffer);
+			packstr(_skip_field(skip_fields, JOB_FIELD_FEATURES,
+					    detail_ptr->features), buffer);
+			packstr(_skip_field(skip_fields, JOB_FIELD_FEATURES,
+					    detail_ptr->cluster_features),
+				buffer);
+			packstr(_skip_field(skip_fields, JOB_FIELD_WORK_DIR,
+					    detail_ptr->work_dir), buffer);
+			packstr(_skip_field(skip_fields, JOB_FIELD_DEPENDENCY,
+					    detail_ptr->dependency), buffer);
 
-			if (detail_ptr->argv) {
+			if (detail_ptr->argv &&
+			    !(skip_fields & JOB_FIELD_COMMAND)) {
 				char *cmd_line = NULL, *pos = NULL;
 				for (i = 0; detail_ptr->argv[i]; i++) {
 					xstrfmtcatat(cmd_line, &pos, "%s%s",
@@ -10603,7 +10781,8 @@ static void _pack_default_job_details(job_record_t *job_ptr, Buf buffer,
 
 /* pack pending job details for "get_job_info" RPC */
 static void _pack_pending_job_details(struct job_details *detail_ptr,
-				      Buf buffer, uint16_t protocol_version)
+				      Buf buffer, uint16_t protocol_version,
+				      uint32_t skip_fields)
 {
 	if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		if (detail_ptr) {
@@ -10615,14 +10794,29 @@ static void _pack_pending_job_details(struct job_details *detail_ptr,
 			pack64(detail_ptr->pn_min_memory, buffer);
 			pack32(detail_ptr->pn_min_tmp_disk, buffer);
 
-			packstr(detail_ptr->req_nodes, buffer);
-			pack_bit_str_hex(detail_ptr->req_node_bitmap, buffer);
-			packstr(detail_ptr->exc_nodes, buffer);
-			pack_bit_str_hex(detail_ptr->exc_node_bitmap, buffer);
+			if (skip_fields & JOB_FIELD_REQ_NODES) {
+				packnull(buffer);
+				pack_bit_str_hex(NULL, buffer);
+			} else {
+				packstr(detail_ptr->req_nodes, buffer);
+				pack_bit_str_hex(detail_ptr->req_node_bitmap,
+						 buffer);
+			}
+			if (skip_fields & JOB_FIELD_EXC_NODES) {
+				packnull(buffer);
+				pack_bit_str_hex(NULL, buffer);
+			} else {
+				packstr(detail_ptr->exc_nodes, buffer);
+				pack_bit_str_hex(detail_ptr->exc_node_bitmap,
+						 buffer);
+			}
 
-			packstr(detail_ptr->std_err, buffer);
-			packstr(detail_ptr->std_in, buffer);
-			packstr(detail_ptr->std_out, buffer);
+			packstr(_skip_field(skip_fields, JOB_FIELD_STD_IO,
+					    detail_ptr->std_err), buffer);
+			packstr(_skip_field(skip_fields, JOB_FIELD_STD_IO,
+					    detail_ptr->std_in), buffer);
+			packstr(_skip_field(skip_fields, JOB_FIELD_STD_IO,
+					    detail_ptr->std_out), buffer);
 
 			pack_multi_core_data(detail_ptr->mc_ptr, buffer,
 					     protocol_version);
@@ -118,7 +118,8 @@ static void 	_make_node_down(node_record_t *node_ptr,
 static bool	_node_is_hidden(node_record_t *node_ptr, uid_t uid);
 static Buf	_open_node_state_file(char **state_file);
 static void 	_pack_node(node_record_t *dump_node_ptr, Buf buffer,
-			   uint16_t protocol_version, uint16_t show_flags);
+			   uint16_t protocol_version, uint16_t show_flags,
+			   uint32_t skip_fields);
 static void	_sync_bitmaps(node_record_t *node_ptr, int job_count);
 static void	_update_config_ptr(bitstr_t *bitmap,
 				   config_record_t *config_ptr);
@@ -735,6 +736,51 @@ static bool _node_is_hidden(node_record_t *node_ptr, uid_t uid)
 	return true;
 }
 
+static int _find_node_part(void *x, void *key)
+{
+	char *part_name = x;
+	node_record_t *node_ptr = key;
+
+	for (int i = 0; i < node_ptr->part_cnt; i++) {
+		part_record_t *part_ptr = node_ptr->part_pptr[i];
+
+		if (!xstrcmp(part_ptr->name, part_name))
+			return 1;
+	}
+
+	return 0;
+}
+
+static int _find_node_state(void *x, void *key)
+{
+	uint32_t state = *(uint32_t *) x;
+	node_record_t *node_ptr = key;
+
+	if (state & NODE_STATE_FLAGS)
+		return ((node_ptr->node_state & state) ? 1 : 0);
+
+	return ((node_ptr->node_state & NODE_STATE_BASE) == state);
+}
+
+/* Return true if node matches everything given in filter */
+static bool _match_node_filter(node_record_t *node_ptr, int node_inx,
+			       node_info_filter_t *filter,
+			       bitstr_t *filter_nodes)
+{
+	if (filter_nodes && !bit_test(filter_nodes, node_inx))
+		return false;
+
+	if (filter->partitions &&
+	    !list_find_first(filter->partitions, _find_node_part, node_ptr))
+		return false;
+
+	if (filter->states &&
+	    !list_find_first(filter->states, _find_node_state, node_ptr))
+		return false;
+
+	return true;
+}
+
 /*
  * pack_all_node - dump all configuration and node information for all nodes
  *	in machine independent form (for network transmission)
@@ -742,6 +788,7 @@ static bool _node_is_hidden(node_record_t *node_ptr, uid_t uid)
  * OUT buffer_size - set to size of the buffer in bytes
  * IN show_flags - node filtering options
  * IN uid - uid of user making request (for partition filtering)
+ * IN filter - nodes to fill in and fields to skip, NULL for everything
  * IN protocol_version - slurm protocol version of client
  * global: node_record_table_ptr - pointer to global node table
  * NOTE: the caller must xfree the buffer at *buffer_ptr
@@ -749,13 +796,15 @@ static bool _node_is_hidden(node_record_t *node_ptr, uid_t uid)
  */
 extern void pack_all_node (char **buffer_ptr, int *buffer_size,
 			   uint16_t show_flags, uid_t uid,
+			   node_info_filter_t *filter,
 			   uint16_t protocol_version)
 {
 	int inx;
-	uint32_t nodes_packed, tmp_offset;
+	uint32_t nodes_packed, tmp_offset, skip_fields = 0;
 	Buf buffer;
 	time_t now = time(NULL);
 	node_record_t *node_ptr = node_record_table_ptr;
+	bitstr_t *filter_nodes = NULL;
 	bool hidden;
 
 	xassert(verify_lock(CONF_LOCK, READ_LOCK));
@@ -764,6 +813,16 @@ extern void pack_all_node (char **buffer_ptr, int *buffer_size,
 	buffer_ptr[0] = NULL;
 	*buffer_size = 0;
 
+	if (filter) {
+		skip_fields = filter->skip_fields;
+		if (filter->nodes &&
+		    node_name2bitmap(filter->nodes, false, &filter_nodes)) {
+			debug2("%s: ignoring invalid node filter %s",
+			       __func__, filter->nodes);
+			FREE_NULL_BITMAP(filter_nodes);
+		}
+	}
+
 	buffer = init_buf (BUF_SIZE*16);
 	nodes_packed = 0;
 
@@ -799,11 +858,20 @@ extern void pack_all_node (char **buffer_ptr, int *buffer_size,
 				char *orig_name = node_ptr->name;
 				node_ptr->name = NULL;
 				_pack_node(node_ptr, buffer, protocol_version,
-				           show_flags);
+				           show_flags, skip_fields);
+				node_ptr->name = orig_name;
+			} else if (filter &&
+				   !_match_node_filter(node_ptr, inx, filter,
+						       filter_nodes)) {
+				/* Same as hidden but without any strings */
+				char *orig_name = node_ptr->name;
+				node_ptr->name = NULL;
+				_pack_node(node_ptr, buffer, protocol_version,
+					   show_flags, INFINITE);
 				node_ptr->name = orig_name;
 			} else {
 				_pack_node(node_ptr, buffer, protocol_version,
-					   show_flags);
+					   show_flags, skip_fields);
 			}
 			nodes_packed++;
 		}
@@ -811,6 +879,7 @@ extern void pack_all_node (char **buffer_ptr, int *buffer_size,
 		error("select_g_select_jobinfo_pack: protocol_version "
 		      "%hu not supported", protocol_version);
 	}
+	FREE_NULL_BITMAP(filter_nodes);
 
 	tmp_offset = get_buf_offset (buffer);
 	set_buf_offset (buffer, 0);
@@ -881,7 +950,7 @@ extern void pack_one_node (char **buffer_ptr, int *buffer_size,
 
 			if (!hidden) {
 				_pack_node(node_ptr, buffer, protocol_version,
-					   show_flags);
+					   show_flags, 0);
 				nodes_packed++;
 			}
 		}
@@ -899,6 +968,12 @@ extern void pack_one_node (char **buffer_ptr, int *buffer_size,
 	buffer_ptr[0] = xfer_buf_data (buffer);
 }
 
+/* Return value unless its NODE_FIELD_* group is in skip_fields */
+static char *_skip_field(uint32_t skip_fields, uint32_t field, char *value)
+{
+	return ((skip_fields & field) ? NULL : value);
+}
+
 /*
  * _pack_node - dump all configuration information about a specific node in
  *	machine independent form (for network transmission)
@@ -906,26 +981,32 @@ extern void pack_one_node (char **buffer_ptr, int *buffer_size,
  * IN/OUT buffer - buffer where data is placed, pointers automatically updated
  * IN protocol_version - slurm protocol version of client
  * IN show_flags -
+ * IN skip_fields - NODE_FIELD_* to pack empty
  * NOTE: if you make any changes here be sure to make the corresponding changes
  * 	to _unpack_node_info_members() in common/slurm_protocol_pack.c
  */
 static void _pack_node(node_record_t *dump_node_ptr, Buf buffer,
-		       uint16_t protocol_version, uint16_t show_flags)
+		       uint16_t protocol_version, uint16_t show_flags,
+		       uint32_t skip_fields)
 {
-	char *gres_drain = NULL, *gres_used = NULL;
+	char *gres_drain = NULL, *gres_used = NULL, *gres;
 
 	xassert(verify_lock(CONF_LOCK, READ_LOCK));
 
 
 	if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
 		packstr(dump_node_ptr->name, buffer);
-		packstr(dump_node_ptr->node_hostname, buffer);
-		packstr(dump_node_ptr->comm_name, buffer);
-		packstr(dump_node_ptr->bcast_address, buffer);
+		packstr(_skip_field(skip_fields, NODE_FIELD_HOSTNAME,
+				    dump_node_ptr->node_hostname), buffer);
+		packstr(_skip_field(skip_fields, NODE_FIELD_ADDR,
+				    dump_node_ptr->comm_name), buffer);
+		packstr(_skip_field(skip_fields, NODE_FIELD_ADDR,
+				    dump_node_ptr->bcast_address), buffer);
 		pack16(dump_node_ptr->port, buffer);
 		pack32(dump_node_ptr->next_state, buffer);
 		pack32(dump_node_ptr->node_state, buffer);
-		packstr(dump_node_ptr->version, buffer);
+		packstr(_skip_field(skip_fields, NODE_FIELD_VERSION,
+				    dump_node_ptr->version), buffer);
 
 		/* Only data from config_record used for scheduling */
 		pack16(dump_node_ptr->config_ptr->cpus, buffer);
@@ -936,12 +1017,14 @@ static void _pack_node(node_record_t *dump_node_ptr, Buf buffer,
 		pack64(dump_node_ptr->config_ptr->real_memory, buffer);
 		pack32(dump_node_ptr->config_ptr->tmp_disk, buffer);
 
-		packstr(dump_node_ptr->mcs_label, buffer);
+		packstr(_skip_field(skip_fields, NODE_FIELD_MCS_LABEL,
+				    dump_node_ptr->mcs_label), buffer);
 		pack32(dump_node_ptr->owner, buffer);
 		pack16(dump_node_ptr->core_spec_cnt, buffer);
 		pack32(dump_node_ptr->cpu_bind, buffer);
 		pack64(dump_node_ptr->mem_spec_limit, buffer);
-		packstr(dump_node_ptr->cpu_spec_list, buffer);
+		packstr(_skip_field(skip_fields, NODE_FIELD_CPU_SPEC,
+				    dump_node_ptr->cpu_spec_list), buffer);
 
 		pack32(dump_node_ptr->cpu_load, buffer);
 		pack64(dump_node_ptr->free_mem, buffer);
@@ -955,16 +1038,22 @@ static void _pack_node(node_record_t *dump_node_ptr, Buf buffer,
 		select_g_select_nodeinfo_pack(dump_node_ptr->select_nodeinfo,
 					      buffer, protocol_version);
 
-		packstr(dump_node_ptr->arch, buffer);
-		packstr(dump_node_ptr->features, buffer);
-		packstr(dump_node_ptr->features_act, buffer);
+		packstr(_skip_field(skip_fields, NODE_FIELD_OS,
+				    dump_node_ptr->arch), buffer);
+		packstr(_skip_field(skip_fields, NODE_FIELD_FEATURES,
+				    dump_node_ptr->features), buffer);
+		packstr(_skip_field(skip_fields, NODE_FIELD_FEATURES,
+				    dump_node_ptr->features_act), buffer);
 		if (dump_node_ptr->gres)
-			packstr(dump_node_ptr->gres, buffer);
+			gres = dump_node_ptr->gres;
 		else
-			packstr(dump_node_ptr->config_ptr->gres, buffer);
+			gres = dump_node_ptr->config_ptr->gres;
+		packstr(_skip_field(skip_fields, NODE_FIELD_GRES, gres),
+			buffer);
 
 		/* Gathering GRES details is slow, so don't by default */
-		if (show_flags & SHOW_DETAIL) {
+		if ((show_flags & SHOW_DETAIL) &&
+		    !(skip_fields & NODE_FIELD_GRES)) {
 			gres_drain =
 				gres_get_node_drain(dump_node_ptr->gres_list);
 			gres_used  =
@@ -975,16 +1064,26 @@ static void _pack_node(node_record_t *dump_node_ptr, Buf buffer,
 		xfree(gres_drain);
 		xfree(gres_used);
 
-		packstr(dump_node_ptr->os, buffer);
-		packstr(dump_node_ptr->reason, buffer);
-		acct_gather_energy_pack(dump_node_ptr->energy, buffer,
-					protocol_version);
-		ext_sensors_data_pack(dump_node_ptr->ext_sensors, buffer,
-				      protocol_version);
-		power_mgmt_data_pack(dump_node_ptr->power, buffer,
-				     protocol_version);
+		packstr(_skip_field(skip_fields, NODE_FIELD_OS,
+				    dump_node_ptr->os), buffer);
+		packstr(_skip_field(skip_fields, NODE_FIELD_REASON,
+				    dump_node_ptr->reason), buffer);
+		if (skip_fields & NODE_FIELD_ENERGY) {
+			acct_gather_energy_pack(NULL, buffer,
+						protocol_version);
+			ext_sensors_data_pack(NULL, buffer, protocol_version);
+			power_mgmt_data_pack(NULL, buffer, protocol_version);
+		} else {
+			acct_gather_energy_pack(dump_node_ptr->energy, buffer,
+						protocol_version);
+			ext_sensors_data_pack(dump_node_ptr->ext_sensors,
+					      buffer, protocol_version);
+			power_mgmt_data_pack(dump_node_ptr->power, buffer,
+					     protocol_version);
+		}
 
-		packstr(dump_node_ptr->tres_fmt_str, buffer);
+		packstr(_skip_field(skip_fields, NODE_FIELD_TRES,
+				    dump_node_ptr->tres_fmt_str), buffer);
 	} else if (protocol_version >= SLURM_20_02_PROTOCOL_VERSION) {
 		packstr(dump_node_ptr->name, buffer);
 		packstr(dump_node_ptr->node_hostname, buffer);
@@ -1477,6 +1477,11 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 	slurmctld_lock_t job_read_lock = {
 		READ_LOCK, READ_LOCK, NO_LOCK, READ_LOCK, READ_LOCK };
 	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred);
+	job_info_filter_t *filter = job_info_request_msg->filter;
+
+	/* Filtering by node needs the node table */
+	if (filter && filter->nodes)
+		job_read_lock.node = READ_LOCK;
 
 	START_TIMER;
 	lock_slurmctld(job_read_lock);
@@ -1490,11 +1495,11 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 			pack_spec_jobs(&dump, &dump_size,
 				       job_info_request_msg->job_ids,
 				       job_info_request_msg->show_flags, uid,
-				       NO_VAL, msg->protocol_version);
+				       NO_VAL, filter, msg->protocol_version);
 		} else {
 			pack_all_jobs(&dump, &dump_size,
 				      job_info_request_msg->show_flags, uid,
-				      NO_VAL, msg->protocol_version);
+				      NO_VAL, filter, msg->protocol_version);
 		}
 		unlock_slurmctld(job_read_lock);
 		END_TIMER2("_slurm_rpc_dump_jobs");
@@ -1530,7 +1535,8 @@ static void _slurm_rpc_dump_jobs_user(slurm_msg_t * msg)
 	START_TIMER;
 	lock_slurmctld(job_read_lock);
 	pack_all_jobs(&dump, &dump_size, job_info_request_msg->show_flags, uid,
-		      job_info_request_msg->user_id, msg->protocol_version);
+		      job_info_request_msg->user_id, NULL,
+		      msg->protocol_version);
 	unlock_slurmctld(job_read_lock);
 	END_TIMER2("_slurm_rpc_dump_job_user");
 #if 0
@@ -1757,7 +1763,8 @@ static void _slurm_rpc_dump_nodes(slurm_msg_t * msg)
 		slurm_send_rc_msg(msg, SLURM_NO_CHANGE_IN_DATA);
 	} else {
 		pack_all_node(&dump, &dump_size, node_req_msg->show_flags,
-			      uid, msg->protocol_version);
+			      uid, node_req_msg->filter,
+			      msg->protocol_version);
 		unlock_slurmctld(node_write_lock);
 		END_TIMER2("_slurm_rpc_dump_nodes");
 #if 0
@@ -6019,6 +6026,7 @@ void slurmctld_req(slurm_msg_t *msg)
 		_slurm_rpc_dump_conf(msg);
 		break;
 	case REQUEST_JOB_INFO:
+	case REQUEST_JOB_INFO_FILTER:
 		_slurm_rpc_dump_jobs(msg);
 		break;
 	case REQUEST_JOB_USER_INFO:
@@ -6046,6 +6054,7 @@ void slurmctld_req(slurm_msg_t *msg)
 		_slurm_rpc_dump_front_end(msg);
 		break;
 	case REQUEST_NODE_INFO:
+	case REQUEST_NODE_INFO_FILTER:
 		_slurm_rpc_dump_nodes(msg);
 		break;
 	case REQUEST_NODE_INFO_SINGLE:
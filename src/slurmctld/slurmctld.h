@@ -193,6 +193,14 @@ typedef struct diag_stats {
 	uint32_t bf_table_size_sum;
 	time_t   bf_when_last_cycle;
 
+	uint32_t prio_cycle_counter;
+	uint32_t prio_cycle_last;
+	uint32_t prio_cycle_max;
+	uint64_t prio_cycle_sum;
+	uint32_t prio_last_jobs_moved;
+	uint32_t prio_last_jobs_same;
+	uint32_t prio_norm_counter;
+
 	uint32_t latency;
 } diag_stats_t;
 
@@ -1925,6 +1933,7 @@ extern int num_pending_job_array_tasks(uint32_t array_job_id);
  * IN show_flags - job filtering options
  * IN uid - uid of user making request (for partition filtering)
  * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * IN filter - pack only jobs matching filter if not NULL
  * IN protocol_version - slurm protocol version of client
  * global: job_list - global list of job records
  * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
@@ -1933,7 +1942,7 @@ extern int num_pending_job_array_tasks(uint32_t array_job_id);
  */
 extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 			  uint16_t show_flags, uid_t uid, uint32_t filter_uid,
-			  uint16_t protocol_version);
+			  job_info_filter_t *filter, uint16_t protocol_version);
 
 /*
  * pack_spec_jobs - dump job information for specified jobs in
@@ -1944,6 +1953,7 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
  * IN job_ids - list of job_ids to pack
  * IN uid - uid of user making request (for partition filtering)
  * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * IN filter - pack only jobs matching filter if not NULL
  * global: job_list - global list of job records
  * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
  * NOTE: change _unpack_job_desc_msg() in common/slurm_protocol_pack.c
@@ -1951,6 +1961,7 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
  */
 extern void pack_spec_jobs(char **buffer_ptr, int *buffer_size, List job_ids,
 			   uint16_t show_flags, uid_t uid, uint32_t filter_uid,
+			   job_info_filter_t *filter,
 			   uint16_t protocol_version);
 
 /*
@@ -1960,6 +1971,7 @@ extern void pack_spec_jobs(char **buffer_ptr, int *buffer_size, List job_ids,
  * OUT buffer_size - set to size of the buffer in bytes
  * IN show_flags - node filtering options
  * IN uid - uid of user making request (for partition filtering)
+ * IN filter - nodes to fill in and fields to skip, NULL for everything
  * IN protocol_version - slurm protocol version of client
  * global: node_record_table_ptr - pointer to global node table
  * NOTE: the caller must xfree the buffer at *buffer_ptr
@@ -1968,6 +1980,7 @@ extern void pack_spec_jobs(char **buffer_ptr, int *buffer_size, List job_ids,
  */
 extern void pack_all_node (char **buffer_ptr, int *buffer_size,
 			   uint16_t show_flags, uid_t uid,
+			   node_info_filter_t *filter,
 			   uint16_t protocol_version);
 
 /* Pack all scheduling statistics */
@@ -2013,11 +2026,13 @@ extern void pack_all_part(char **buffer_ptr, int *buffer_size,
  * IN/OUT buffer - buffer in which data is placed, pointers automatically
  *	updated
  * IN uid - user requesting the data
+ * IN skip_fields - JOB_FIELD_* to pack empty
  * NOTE: change _unpack_job_desc_msg() in common/slurm_protocol_pack.c
  *	  whenever the data format changes
  */
 extern void pack_job(job_record_t *dump_job_ptr, uint16_t show_flags,
-		     Buf buffer, uint16_t protocol_version, uid_t uid);
+		     Buf buffer, uint16_t protocol_version, uid_t uid,
+		     uint32_t skip_fields);
 
 /*
  * pack_part - dump all configuration information about a specific partition
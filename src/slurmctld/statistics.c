@@ -140,6 +140,23 @@ extern void pack_all_stat(int resp, char **buffer_ptr, int *buffer_size,
 			pack32(slurmctld_diag_stats.bf_active, buffer);
 			pack32(slurmctld_diag_stats.backfilled_het_jobs,
 			       buffer);
+
+			if (protocol_version >= SLURM_20_11_PROTOCOL_VERSION) {
+				pack32(slurmctld_diag_stats.prio_cycle_counter,
+				       buffer);
+				pack64(slurmctld_diag_stats.prio_cycle_sum,
+				       buffer);
+				pack32(slurmctld_diag_stats.prio_cycle_last,
+				       buffer);
+				pack32(slurmctld_diag_stats.prio_cycle_max,
+				       buffer);
+				pack32(slurmctld_diag_stats.prio_last_jobs_moved,
+				       buffer);
+				pack32(slurmctld_diag_stats.prio_last_jobs_same,
+				       buffer);
+				pack32(slurmctld_diag_stats.prio_norm_counter,
+				       buffer);
+			}
 		}
 	} else if (protocol_version >= SLURM_MIN_PROTOCOL_VERSION) {
 		parts_packed = resp;
@@ -246,6 +263,10 @@ extern void reset_stats(int level)
 	slurmctld_diag_stats.bf_cycle_max = 0;
 	slurmctld_diag_stats.bf_last_depth = 0;
 	slurmctld_diag_stats.bf_last_depth_try = 0;
+	slurmctld_diag_stats.prio_cycle_counter = 0;
+	slurmctld_diag_stats.prio_cycle_sum = 0;
+	slurmctld_diag_stats.prio_cycle_max = 0;
+	slurmctld_diag_stats.prio_norm_counter = 0;
 
 	last_proc_req_start = time(NULL);
 }
@@ -54,7 +54,8 @@
 typedef enum slurmd_step_tupe {
 	LAUNCH_BATCH_JOB = 0,
 	LAUNCH_TASKS,
-	DEFUNCT_SPAWN_TASKS /* DEFUNCT */
+	DEFUNCT_SPAWN_TASKS, /* DEFUNCT */
+	LAUNCH_POOLED	/* idle in slurmd's pool until sent a step type */
 } slurmd_step_type_t;
 
 /*
@@ -39,6 +39,8 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
 \*****************************************************************************/
 
+#define _GNU_SOURCE	/* pipe2() */
+
 #include "config.h"
 
 #include <ctype.h>
@@ -89,6 +91,7 @@
 #include "src/common/slurm_protocol_api.h"
 #include "src/common/slurm_protocol_interface.h"
 #include "src/common/stepd_api.h"
+#include "src/common/timers.h"
 #include "src/common/uid.h"
 #include "src/common/util-net.h"
 #include "src/common/xcgroup_read_config.h"
@@ -99,6 +102,7 @@
 
 #include "src/slurmd/slurmd/get_mach_stat.h"
 #include "src/slurmd/slurmd/slurmd.h"
+#include "src/slurmd/slurmd/req.h"
 
 #include "src/slurmd/common/fname.h"
 #include "src/slurmd/common/job_container_plugin.h"
@@ -120,6 +124,8 @@
 #define MAX_CPU_CNT 1024
 #define MAX_NUMA_CNT 128
 
+#define MAX_STEPD_POOL 128	/* upper bound of slurmstepd_pool=# */
+
 typedef struct {
 	uint64_t job_mem;
 	slurm_step_id_t step_id;
@@ -154,6 +160,7 @@ static int  _terminate_all_steps(uint32_t jobid, bool batch);
 static void _rpc_launch_tasks(slurm_msg_t *);
 static void _rpc_abort_job(slurm_msg_t *);
 static void _rpc_batch_job(slurm_msg_t *msg);
+static void _rpc_batch_job_mult(slurm_msg_t *msg);
 static void _rpc_prolog(slurm_msg_t *msg);
 static void _rpc_job_notify(slurm_msg_t *);
 static void _rpc_signal_tasks(slurm_msg_t *);
@@ -254,6 +261,26 @@ static List file_bcast_list = NULL;
 
 static pthread_mutex_t waiter_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/*
+ * Pool of idle slurmstepd processes, see LaunchParameters=slurmstepd_pool.
+ * Each has already received the node configuration and loaded its plugins,
+ * and is blocked reading the step portion of its initialization data.
+ */
+typedef struct {
+	int to_stepd;		/* write end of the slurmstepd's stdin */
+	int to_slurmd;		/* read end of the slurmstepd's stdout */
+} stepd_pool_ent_t;
+
+static pthread_mutex_t stepd_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static List stepd_pool = NULL;
+static uint32_t stepd_pool_gen = 0;	/* bumped when the pool is flushed */
+static bool stepd_pool_refilling = false;
+
+/* slurmstepd launch latency, indexed by whether the pool was used */
+static uint32_t stepd_launch_cnt[2] = {0, 0};
+static uint64_t stepd_launch_usec[2] = {0, 0};
+static uint64_t stepd_launch_max[2] = {0, 0};
+
 void
 slurmd_req(slurm_msg_t *msg)
 {
@@ -269,6 +296,7 @@ slurmd_req(slurm_msg_t *msg)
 			job_limits_loaded = false;
 		}
 		slurm_mutex_unlock(&job_limits_mutex);
+		stepd_pool_flush();
 		return;
 	}
 
@@ -282,6 +310,10 @@ slurmd_req(slurm_msg_t *msg)
 		_rpc_batch_job(msg);
 		last_slurmctld_msg = time(NULL);
 		break;
+	case REQUEST_BATCH_JOB_LAUNCH_MULT:
+		_rpc_batch_job_mult(msg);
+		last_slurmctld_msg = time(NULL);
+		break;
 	case REQUEST_LAUNCH_TASKS:
 		_rpc_launch_tasks(msg);
 		break;
@@ -429,6 +461,51 @@ rwfail:
 	return (-1);
 }
 
+/*
+ * Send the node configuration portion of the slurmstepd initialization data.
+ * IN pooled - if true the slurmstepd preloads its plugins and then idles
+ *	until _send_slurmstepd_init() hands it a step
+ */
+static int _send_slurmstepd_conf(int fd, bool pooled)
+{
+	int len, type = LAUNCH_POOLED;
+
+	/* send conf over to slurmstepd */
+	if (send_slurmd_conf_lite(fd, conf) < 0)
+		goto rwfail;
+
+	/* send cgroup conf over to slurmstepd */
+	if (xcgroup_write_conf(fd) < 0)
+		goto rwfail;
+
+	/* send acct_gather.conf over to slurmstepd */
+	if (acct_gather_write_conf(fd) < 0)
+		goto rwfail;
+
+	if (!pooled)
+		return 0;
+
+	/*
+	 * A pooled slurmstepd gets LAUNCH_POOLED where the step type would
+	 * go, and the node name for its plugins. The step type and the rest
+	 * of the data follow in the usual order once it is handed a step.
+	 */
+	safe_write(fd, &type, sizeof(int));
+	len = strlen(conf->node_name) + 1;
+	safe_write(fd, &len, sizeof(int));
+	safe_write(fd, conf->node_name, len);
+
+	return 0;
+
+rwfail:
+	error("%s failed", __func__);
+	return errno ? errno : SLURM_ERROR;
+}
+
+/*
+ * Send the step portion of the slurmstepd initialization data, which follows
+ * the node configuration sent by _send_slurmstepd_conf().
+ */
 static int
 _send_slurmstepd_init(int fd, int type, void *req,
 		      slurm_addr_t *cli, slurm_addr_t *self,
@@ -445,18 +522,6 @@ _send_slurmstepd_init(int fd, int type, void *req,
 
 	slurm_msg_t_init(&msg);
 
-	/* send conf over to slurmstepd */
-	if (send_slurmd_conf_lite(fd, conf) < 0)
-		goto rwfail;
-
-	/* send cgroup conf over to slurmstepd */
-	if (xcgroup_write_conf(fd) < 0)
-		goto rwfail;
-
-	/* send acct_gather.conf over to slurmstepd */
-	if (acct_gather_write_conf(fd) < 0)
-		goto rwfail;
-
 	/* send type over to slurmstepd */
 	safe_write(fd, &type, sizeof(int));
 
@@ -629,33 +694,182 @@ rwfail:
 
 
 /*
- * Fork and exec the slurmstepd, then send the slurmstepd its
- * initialization data.  Then wait for slurmstepd to send an "ok"
- * message before returning.  When the "ok" message is received,
- * the slurmstepd has created and begun listening on its unix
- * domain socket.
- *
- * Note that this code forks twice and it is the grandchild that
- * becomes the slurmstepd process, so the slurmstepd's parent process
- * will be init, not slurmd.
+ * Exec the slurmstepd in a newly forked child of slurmd. The child forks
+ * again and it is the grandchild that becomes the slurmstepd process, so
+ * the slurmstepd's parent process will be init, not slurmd.
+ * Never returns.
  */
-static int
-_forkexec_slurmstepd(uint16_t type, void *req,
-		     slurm_addr_t *cli, slurm_addr_t *self,
-		     const hostset_t step_hset, uint16_t protocol_version)
+static void _exec_slurmstepd(uint16_t type, void *req, int to_stepd[2],
+			     int to_slurmd[2])
+{
+#if (SLURMSTEPD_MEMCHECK == 1)
+	/* memcheck test of slurmstepd, option #1 */
+	char *const argv[3] = {"memcheck",
+			       (char *)conf->stepd_loc, NULL};
+#elif (SLURMSTEPD_MEMCHECK == 2)
+	/* valgrind test of slurmstepd, option #2 */
+	uint32_t job_id = 0, step_id = 0;
+	char log_file[256];
+	char *const argv[13] = {"valgrind", "--tool=memcheck",
+				"--error-limit=no",
+				"--leak-check=summary",
+				"--show-reachable=yes",
+				"--max-stackframe=16777216",
+				"--num-callers=20",
+				"--child-silent-after-fork=yes",
+				"--track-origins=yes",
+				log_file, (char *)conf->stepd_loc,
+				NULL};
+	if (type == LAUNCH_BATCH_JOB) {
+		job_id = ((batch_job_launch_msg_t *)req)->job_id;
+		step_id = SLURM_BATCH_SCRIPT;
+	} else if (type == LAUNCH_TASKS) {
+		job_id = ((launch_tasks_request_msg_t *)req)->step_id.job_id;
+		step_id = ((launch_tasks_request_msg_t *)req)->step_id.step_id;
+	}
+	snprintf(log_file, sizeof(log_file),
+		 "--log-file=/tmp/slurmstepd_valgrind_%u.%u",
+		 job_id, step_id);
+#elif (SLURMSTEPD_MEMCHECK == 3)
+	/* valgrind/drd test of slurmstepd, option #3 */
+	uint32_t job_id = 0, step_id = 0;
+	char log_file[256];
+	char *const argv[10] = {"valgrind", "--tool=drd",
+				"--error-limit=no",
+				"--max-stackframe=16777216",
+				"--num-callers=20",
+				"--child-silent-after-fork=yes",
+				log_file, (char *)conf->stepd_loc,
+				NULL};
+	if (type == LAUNCH_BATCH_JOB) {
+		job_id = ((batch_job_launch_msg_t *)req)->job_id;
+		step_id = SLURM_BATCH_SCRIPT;
+	} else if (type == LAUNCH_TASKS) {
+		job_id = ((launch_tasks_request_msg_t *)req)->step_id.job_id;
+		step_id = ((launch_tasks_request_msg_t *)req)->step_id.step_id;
+	}
+	snprintf(log_file, sizeof(log_file),
+		 "--log-file=/tmp/slurmstepd_valgrind_%u.%u",
+		 job_id, step_id);
+#elif (SLURMSTEPD_MEMCHECK == 4)
+	/* valgrind/helgrind test of slurmstepd, option #4 */
+	uint32_t job_id = 0, step_id = 0;
+	char log_file[256];
+	char *const argv[10] = {"valgrind", "--tool=helgrind",
+				"--error-limit=no",
+				"--max-stackframe=16777216",
+				"--num-callers=20",
+				"--child-silent-after-fork=yes",
+				log_file, (char *)conf->stepd_loc,
+				NULL};
+	if (type == LAUNCH_BATCH_JOB) {
+		job_id = ((batch_job_launch_msg_t *)req)->job_id;
+		step_id = SLURM_BATCH_SCRIPT;
+	} else if (type == LAUNCH_TASKS) {
+		job_id = ((launch_tasks_request_msg_t *)req)->step_id.job_id;
+		step_id = ((launch_tasks_request_msg_t *)req)->step_id.step_id;
+	}
+	snprintf(log_file, sizeof(log_file),
+		 "--log-file=/tmp/slurmstepd_valgrind_%u.%u",
+		 job_id, step_id);
+#else
+	/* no memory checking, default */
+	char *const argv[2] = { (char *)conf->stepd_loc, NULL};
+#endif
+	pid_t pid;
+	int i;
+	int failed = 0;
+
+	/*
+	 * Child forks and exits
+	 */
+	if (setsid() < 0) {
+		error("%s: setsid: %m", __func__);
+		failed = 1;
+	}
+	if ((pid = fork()) < 0) {
+		error("%s: Unable to fork grandchild: %m", __func__);
+		failed = 2;
+	} else if (pid > 0) { /* child */
+		_exit(0);
+	}
+
+	/*
+	 * Just in case we (or someone we are linking to)
+	 * opened a file and didn't do a close on exec.  This
+	 * is needed mostly to protect us against libs we link
+	 * to that don't set the flag as we should already be
+	 * setting it for those that we open.  The number 256
+	 * is an arbitrary number based off test7.9.
+	 */
+	for (i=3; i<256; i++) {
+		(void) fcntl(i, F_SETFD, FD_CLOEXEC);
+	}
+
+	/*
+	 * Grandchild exec's the slurmstepd
+	 *
+	 * If the slurmd is being shutdown/restarted before
+	 * the pipe happens the old conf->lfd could be reused
+	 * and if we close it the dup2 below will fail.
+	 */
+	if ((to_stepd[0] != conf->lfd)
+	    && (to_slurmd[1] != conf->lfd))
+		close(conf->lfd);
+
+	if (close(to_stepd[1]) < 0)
+		error("close write to_stepd in grandchild: %m");
+	if (close(to_slurmd[0]) < 0)
+		error("close read to_slurmd in parent: %m");
+
+	(void) close(STDIN_FILENO); /* ignore return */
+	if (dup2(to_stepd[0], STDIN_FILENO) == -1) {
+		error("dup2 over STDIN_FILENO: %m");
+		_exit(1);
+	}
+	fd_set_close_on_exec(to_stepd[0]);
+	(void) close(STDOUT_FILENO); /* ignore return */
+	if (dup2(to_slurmd[1], STDOUT_FILENO) == -1) {
+		error("dup2 over STDOUT_FILENO: %m");
+		_exit(1);
+	}
+	fd_set_close_on_exec(to_slurmd[1]);
+	(void) close(STDERR_FILENO); /* ignore return */
+	if (dup2(devnull, STDERR_FILENO) == -1) {
+		error("dup2 /dev/null to STDERR_FILENO: %m");
+		_exit(1);
+	}
+	fd_set_noclose_on_exec(STDERR_FILENO);
+	log_fini();
+	if (!failed) {
+		execvp(argv[0], argv);
+		error("exec of slurmstepd failed: %m");
+	}
+	_exit(2);
+}
+
+/*
+ * Fork and exec a slurmstepd.
+ * OUT to_stepd_fd - write end of the slurmstepd's stdin
+ * OUT to_slurmd_fd - read end of the slurmstepd's stdout
+ * RET pid of the intermediate child to be reaped or -1 on error
+ */
+static pid_t _fork_slurmstepd(uint16_t type, void *req, int *to_stepd_fd,
+			      int *to_slurmd_fd)
 {
 	pid_t pid;
 	int to_stepd[2] = {-1, -1};
 	int to_slurmd[2] = {-1, -1};
 
-	if (pipe(to_stepd) < 0 || pipe(to_slurmd) < 0) {
+	/*
+	 * Close on exec from the start so a concurrent fork and exec in
+	 * another thread can not inherit them. dup2() in the grandchild
+	 * clears the flag on the copies made for slurmstepd.
+	 */
+	if ((pipe2(to_stepd, O_CLOEXEC) < 0) ||
+	    (pipe2(to_slurmd, O_CLOEXEC) < 0)) {
 		error("%s: pipe failed: %m", __func__);
-		return SLURM_ERROR;
-	}
-
-	if (_add_starting_step(type, req)) {
-		error("%s: failed in _add_starting_step: %m", __func__);
-		return SLURM_ERROR;
+		return -1;
 	}
 
 	if ((pid = fork()) < 0) {
@@ -664,220 +878,309 @@ _forkexec_slurmstepd(uint16_t type, void *req,
 		close(to_stepd[1]);
 		close(to_slurmd[0]);
 		close(to_slurmd[1]);
-		_remove_starting_step(type, req);
-		return SLURM_ERROR;
-	} else if (pid > 0) {
-		int rc = SLURM_SUCCESS;
-#if (SLURMSTEPD_MEMCHECK == 0)
-		int i;
-		time_t start_time = time(NULL);
-#endif
-		/*
-		 * Parent sends initialization data to the slurmstepd
-		 * over the to_stepd pipe, and waits for the return code
-		 * reply on the to_slurmd pipe.
-		 */
-		if (close(to_stepd[0]) < 0)
-			error("Unable to close read to_stepd in parent: %m");
-		if (close(to_slurmd[1]) < 0)
-			error("Unable to close write to_slurmd in parent: %m");
+		return -1;
+	} else if (pid == 0)
+		_exec_slurmstepd(type, req, to_stepd, to_slurmd);
 
-		if ((rc = _send_slurmstepd_init(to_stepd[1], type,
-						req, cli, self,
-						step_hset,
-						protocol_version)) != 0) {
-			error("Unable to init slurmstepd");
-			goto done;
-		}
+	/*
+	 * Parent sends initialization data to the slurmstepd
+	 * over the to_stepd pipe, and waits for the return code
+	 * reply on the to_slurmd pipe.
+	 */
+	if (close(to_stepd[0]) < 0)
+		error("Unable to close read to_stepd in parent: %m");
+	if (close(to_slurmd[1]) < 0)
+		error("Unable to close write to_slurmd in parent: %m");
+
+	*to_stepd_fd = to_stepd[1];
+	*to_slurmd_fd = to_slurmd[0];
+	return pid;
+}
 
-		/* If running under valgrind/memcheck, this pipe doesn't work
-		 * correctly so just skip it. */
+static void _stepd_pool_ent_free(void *x)
+{
+	stepd_pool_ent_t *ent = (stepd_pool_ent_t *) x;
+
+	if (ent) {
+		(void) close(ent->to_stepd);
+		(void) close(ent->to_slurmd);
+		xfree(ent);
+	}
+}
+
+/* Return the configured slurmstepd pool size, zero if disabled */
+static int _stepd_pool_size(void)
+{
 #if (SLURMSTEPD_MEMCHECK == 0)
-		i = read(to_slurmd[0], &rc, sizeof(int));
-		if (i < 0) {
-			error("%s: Can not read return code from slurmstepd "
-			      "got %d: %m", __func__, i);
-			rc = SLURM_ERROR;
-		} else if (i != sizeof(int)) {
-			error("%s: slurmstepd failed to send return code "
-			      "got %d: %m", __func__, i);
-			rc = SLURM_ERROR;
-		} else {
-			int delta_time = time(NULL) - start_time;
-			int cc;
-			if (delta_time > 5) {
-				info("Warning: slurmstepd startup took %d sec, "
-				     "possible file system problem or full "
-				     "memory", delta_time);
-			}
-			if (rc != SLURM_SUCCESS)
-				error("slurmstepd return code %d", rc);
-
-			cc = SLURM_SUCCESS;
-			cc = write(to_stepd[1], &cc, sizeof(int));
-			if (cc != sizeof(int)) {
-				error("%s: failed to send ack to stepd %d: %m",
-				      __func__, cc);
-			}
+	char *tmp_ptr;
+	int size;
+
+	if ((tmp_ptr = xstrcasestr(slurm_conf.launch_params,
+				   "slurmstepd_pool="))) {
+		size = atoi(tmp_ptr + 16);
+		if ((size < 0) || (size > MAX_STEPD_POOL)) {
+			error("Invalid LaunchParameters slurmstepd_pool=%d, limit is %d",
+			      size, MAX_STEPD_POOL);
+			size = MAX(0, MIN(size, MAX_STEPD_POOL));
 		}
+		return size;
+	}
 #endif
-	done:
-		if (_remove_starting_step(type, req))
-			error("Error cleaning up starting_step list");
-
-		/* Reap child */
-		if (waitpid(pid, NULL, 0) < 0)
-			error("Unable to reap slurmd child process");
-		if (close(to_stepd[1]) < 0)
-			error("close write to_stepd in parent: %m");
-		if (close(to_slurmd[0]) < 0)
-			error("close read to_slurmd in parent: %m");
-		return rc;
-	} else {
-#if (SLURMSTEPD_MEMCHECK == 1)
-		/* memcheck test of slurmstepd, option #1 */
-		char *const argv[3] = {"memcheck",
-				       (char *)conf->stepd_loc, NULL};
-#elif (SLURMSTEPD_MEMCHECK == 2)
-		/* valgrind test of slurmstepd, option #2 */
-		uint32_t job_id = 0, step_id = 0;
-		char log_file[256];
-		char *const argv[13] = {"valgrind", "--tool=memcheck",
-					"--error-limit=no",
-					"--leak-check=summary",
-					"--show-reachable=yes",
-					"--max-stackframe=16777216",
-					"--num-callers=20",
-					"--child-silent-after-fork=yes",
-					"--track-origins=yes",
-					log_file, (char *)conf->stepd_loc,
-					NULL};
-		if (type == LAUNCH_BATCH_JOB) {
-			job_id = ((batch_job_launch_msg_t *)req)->job_id;
-			step_id = SLURM_BATCH_SCRIPT;
-		} else if (type == LAUNCH_TASKS) {
-			job_id = ((launch_tasks_request_msg_t *)req)->step_id.job_id;
-			step_id = ((launch_tasks_request_msg_t *)req)->step_id.step_id;
+	return 0;
+}
+
+/*
+ * Spawn one idle slurmstepd and send it the node configuration.
+ * RET the new pool entry or NULL on error
+ */
+static stepd_pool_ent_t *_stepd_pool_spawn(void)
+{
+	stepd_pool_ent_t *ent;
+	pid_t pid;
+	int to_stepd, to_slurmd;
+
+	if ((pid = _fork_slurmstepd(0, NULL, &to_stepd, &to_slurmd)) < 0)
+		return NULL;
+
+	/* Reap child */
+	if (waitpid(pid, NULL, 0) < 0)
+		error("Unable to reap slurmd child process");
+
+	ent = xmalloc(sizeof(*ent));
+	ent->to_stepd = to_stepd;
+	ent->to_slurmd = to_slurmd;
+
+	if (_send_slurmstepd_conf(to_stepd, true)) {
+		error("%s: Unable to init pooled slurmstepd", __func__);
+		_stepd_pool_ent_free(ent);
+		return NULL;
+	}
+
+	return ent;
+}
+
+static void *_stepd_pool_refill_thread(void *arg)
+{
+	stepd_pool_ent_t *ent;
+	uint32_t gen;
+	int size;
+
+	while (true) {
+		slurm_mutex_lock(&stepd_pool_mutex);
+		size = _stepd_pool_size();
+		if (!stepd_pool || (list_count(stepd_pool) >= size)) {
+			stepd_pool_refilling = false;
+			slurm_mutex_unlock(&stepd_pool_mutex);
+			break;
 		}
-		snprintf(log_file, sizeof(log_file),
-			 "--log-file=/tmp/slurmstepd_valgrind_%u.%u",
-			 job_id, step_id);
-#elif (SLURMSTEPD_MEMCHECK == 3)
-		/* valgrind/drd test of slurmstepd, option #3 */
-		uint32_t job_id = 0, step_id = 0;
-		char log_file[256];
-		char *const argv[10] = {"valgrind", "--tool=drd",
-					"--error-limit=no",
-					"--max-stackframe=16777216",
-					"--num-callers=20",
-					"--child-silent-after-fork=yes",
-					log_file, (char *)conf->stepd_loc,
-					NULL};
-		if (type == LAUNCH_BATCH_JOB) {
-			job_id = ((batch_job_launch_msg_t *)req)->job_id;
-			step_id = SLURM_BATCH_SCRIPT;
-		} else if (type == LAUNCH_TASKS) {
-			job_id = ((launch_tasks_request_msg_t *)req)->step_id.job_id;
-			step_id = ((launch_tasks_request_msg_t *)req)->step_id.step_id;
+		gen = stepd_pool_gen;
+		slurm_mutex_unlock(&stepd_pool_mutex);
+
+		if (!(ent = _stepd_pool_spawn())) {
+			slurm_mutex_lock(&stepd_pool_mutex);
+			stepd_pool_refilling = false;
+			slurm_mutex_unlock(&stepd_pool_mutex);
+			break;
 		}
-		snprintf(log_file, sizeof(log_file),
-			 "--log-file=/tmp/slurmstepd_valgrind_%u.%u",
-			 job_id, step_id);
-#elif (SLURMSTEPD_MEMCHECK == 4)
-		/* valgrind/helgrind test of slurmstepd, option #4 */
-		uint32_t job_id = 0, step_id = 0;
-		char log_file[256];
-		char *const argv[10] = {"valgrind", "--tool=helgrind",
-					"--error-limit=no",
-					"--max-stackframe=16777216",
-					"--num-callers=20",
-					"--child-silent-after-fork=yes",
-					log_file, (char *)conf->stepd_loc,
-					NULL};
-		if (type == LAUNCH_BATCH_JOB) {
-			job_id = ((batch_job_launch_msg_t *)req)->job_id;
-			step_id = SLURM_BATCH_SCRIPT;
-		} else if (type == LAUNCH_TASKS) {
-			job_id = ((launch_tasks_request_msg_t *)req)->step_id.job_id;
-			step_id = ((launch_tasks_request_msg_t *)req)->step_id.step_id;
+
+		slurm_mutex_lock(&stepd_pool_mutex);
+		if (stepd_pool && (gen == stepd_pool_gen)) {
+			list_append(stepd_pool, ent);
+			ent = NULL;
 		}
-		snprintf(log_file, sizeof(log_file),
-			 "--log-file=/tmp/slurmstepd_valgrind_%u.%u",
-			 job_id, step_id);
-#else
-		/* no memory checking, default */
-		char *const argv[2] = { (char *)conf->stepd_loc, NULL};
-#endif
-		int i;
-		int failed = 0;
+		slurm_mutex_unlock(&stepd_pool_mutex);
+
+		/* Spawned with a configuration that has since been flushed */
+		_stepd_pool_ent_free(ent);
+	}
 
+	return NULL;
+}
+
+/*
+ * Take an idle slurmstepd from the pool.
+ * RET true if one was found, with its pipes in to_stepd and to_slurmd
+ */
+static bool _stepd_pool_get(int *to_stepd, int *to_slurmd)
+{
+	stepd_pool_ent_t *ent;
+	struct pollfd pfd;
+	bool found = false;
+
+	slurm_mutex_lock(&stepd_pool_mutex);
+	while (stepd_pool && (ent = list_pop(stepd_pool))) {
 		/*
-		 * Child forks and exits
+		 * An idle slurmstepd never writes to slurmd, so any event on
+		 * this pipe means it has exited.
 		 */
-		if (setsid() < 0) {
-			error("%s: setsid: %m", __func__);
-			failed = 1;
+		pfd.fd = ent->to_slurmd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, 0) != 0) {
+			debug("%s: discarding exited slurmstepd", __func__);
+			_stepd_pool_ent_free(ent);
+			continue;
 		}
-		if ((pid = fork()) < 0) {
-			error("%s: Unable to fork grandchild: %m", __func__);
-			failed = 2;
-		} else if (pid > 0) { /* child */
-			_exit(0);
+		*to_stepd = ent->to_stepd;
+		*to_slurmd = ent->to_slurmd;
+		xfree(ent);
+		found = true;
+		break;
+	}
+	slurm_mutex_unlock(&stepd_pool_mutex);
+
+	return found;
+}
+
+extern void stepd_pool_refill(void)
+{
+	/* Nothing can be sent to a slurmstepd until we are registered */
+	if (!assoc_mgr_tres_list)
+		return;
+
+	slurm_mutex_lock(&stepd_pool_mutex);
+	if (!stepd_pool_refilling && (_stepd_pool_size() > 0)) {
+		if (!stepd_pool)
+			stepd_pool = list_create(_stepd_pool_ent_free);
+		if (list_count(stepd_pool) < _stepd_pool_size()) {
+			stepd_pool_refilling = true;
+			slurm_thread_create_detached(NULL,
+						     _stepd_pool_refill_thread,
+						     NULL);
 		}
+	}
+	slurm_mutex_unlock(&stepd_pool_mutex);
+}
 
-		/*
-		 * Just in case we (or someone we are linking to)
-		 * opened a file and didn't do a close on exec.  This
-		 * is needed mostly to protect us against libs we link
-		 * to that don't set the flag as we should already be
-		 * setting it for those that we open.  The number 256
-		 * is an arbitrary number based off test7.9.
-		 */
-		for (i=3; i<256; i++) {
-			(void) fcntl(i, F_SETFD, FD_CLOEXEC);
+extern void stepd_pool_flush(void)
+{
+	slurm_mutex_lock(&stepd_pool_mutex);
+	stepd_pool_gen++;
+	if (stepd_pool)
+		list_flush(stepd_pool);
+	slurm_mutex_unlock(&stepd_pool_mutex);
+}
+
+static void _stepd_launch_stats(bool pooled, uint64_t usec)
+{
+	slurm_mutex_lock(&stepd_pool_mutex);
+	stepd_launch_cnt[pooled]++;
+	stepd_launch_usec[pooled] += usec;
+	stepd_launch_max[pooled] = MAX(stepd_launch_max[pooled], usec);
+	slurm_mutex_unlock(&stepd_pool_mutex);
+}
+
+/*
+ * Fork and exec the slurmstepd, or take an idle one from the pool, then
+ * send the slurmstepd its initialization data.  Then wait for slurmstepd
+ * to send an "ok" message before returning.  When the "ok" message is
+ * received, the slurmstepd has created and begun listening on its unix
+ * domain socket.
+ */
+static int
+_forkexec_slurmstepd(uint16_t type, void *req,
+		     slurm_addr_t *cli, slurm_addr_t *self,
+		     const hostset_t step_hset, uint16_t protocol_version)
+{
+	pid_t pid = -1;
+	int to_stepd = -1, to_slurmd = -1;
+	int rc = SLURM_SUCCESS;
+	bool pooled = false;
+#if (SLURMSTEPD_MEMCHECK == 0)
+	int i;
+	time_t start_time = time(NULL);
+#endif
+	DEF_TIMERS;
+
+	START_TIMER;
+	if (_add_starting_step(type, req)) {
+		error("%s: failed in _add_starting_step: %m", __func__);
+		return SLURM_ERROR;
+	}
+
+	if (_stepd_pool_get(&to_stepd, &to_slurmd)) {
+		pooled = true;
+		if (_send_slurmstepd_init(to_stepd, type, req, cli, self,
+					  step_hset, protocol_version)) {
+			error("%s: Unable to hand step to pooled slurmstepd, forking a new one",
+			      __func__);
+			(void) close(to_stepd);
+			(void) close(to_slurmd);
+			pooled = false;
 		}
+	}
 
-		/*
-		 * Grandchild exec's the slurmstepd
-		 *
-		 * If the slurmd is being shutdown/restarted before
-		 * the pipe happens the old conf->lfd could be reused
-		 * and if we close it the dup2 below will fail.
-		 */
-		if ((to_stepd[0] != conf->lfd)
-		    && (to_slurmd[1] != conf->lfd))
-			close(conf->lfd);
-
-		if (close(to_stepd[1]) < 0)
-			error("close write to_stepd in grandchild: %m");
-		if (close(to_slurmd[0]) < 0)
-			error("close read to_slurmd in parent: %m");
-
-		(void) close(STDIN_FILENO); /* ignore return */
-		if (dup2(to_stepd[0], STDIN_FILENO) == -1) {
-			error("dup2 over STDIN_FILENO: %m");
-			_exit(1);
+	if (!pooled) {
+		if ((pid = _fork_slurmstepd(type, req, &to_stepd,
+					    &to_slurmd)) < 0) {
+			_remove_starting_step(type, req);
+			return SLURM_ERROR;
 		}
-		fd_set_close_on_exec(to_stepd[0]);
-		(void) close(STDOUT_FILENO); /* ignore return */
-		if (dup2(to_slurmd[1], STDOUT_FILENO) == -1) {
-			error("dup2 over STDOUT_FILENO: %m");
-			_exit(1);
+
+		if ((rc = _send_slurmstepd_conf(to_stepd, false)) ||
+		    (rc = _send_slurmstepd_init(to_stepd, type,
+						req, cli, self,
+						step_hset,
+						protocol_version))) {
+			error("Unable to init slurmstepd");
+			goto done;
 		}
-		fd_set_close_on_exec(to_slurmd[1]);
-		(void) close(STDERR_FILENO); /* ignore return */
-		if (dup2(devnull, STDERR_FILENO) == -1) {
-			error("dup2 /dev/null to STDERR_FILENO: %m");
-			_exit(1);
+	}
+
+	/* If running under valgrind/memcheck, this pipe doesn't work
+	 * correctly so just skip it. */
+#if (SLURMSTEPD_MEMCHECK == 0)
+	i = read(to_slurmd, &rc, sizeof(int));
+	if (i < 0) {
+		error("%s: Can not read return code from slurmstepd "
+		      "got %d: %m", __func__, i);
+		rc = SLURM_ERROR;
+	} else if (i != sizeof(int)) {
+		error("%s: slurmstepd failed to send return code "
+		      "got %d: %m", __func__, i);
+		rc = SLURM_ERROR;
+	} else {
+		int delta_time = time(NULL) - start_time;
+		int cc;
+		if (delta_time > 5) {
+			info("Warning: slurmstepd startup took %d sec, "
+			     "possible file system problem or full "
+			     "memory", delta_time);
 		}
-		fd_set_noclose_on_exec(STDERR_FILENO);
-		log_fini();
-		if (!failed) {
-			execvp(argv[0], argv);
-			error("exec of slurmstepd failed: %m");
+		if (rc != SLURM_SUCCESS)
+			error("slurmstepd return code %d", rc);
+
+		cc = SLURM_SUCCESS;
+		cc = write(to_stepd, &cc, sizeof(int));
+		if (cc != sizeof(int)) {
+			error("%s: failed to send ack to stepd %d: %m",
+			      __func__, cc);
 		}
-		_exit(2);
 	}
+#endif
+done:
+	if (_remove_starting_step(type, req))
+		error("Error cleaning up starting_step list");
+
+	/* Reap child */
+	if ((pid > 0) && (waitpid(pid, NULL, 0) < 0))
+		error("Unable to reap slurmd child process");
+	if (close(to_stepd) < 0)
+		error("close write to_stepd in parent: %m");
+	if (close(to_slurmd) < 0)
+		error("close read to_slurmd in parent: %m");
+
+	END_TIMER;
+	if (rc == SLURM_SUCCESS) {
+		_stepd_launch_stats(pooled, DELTA_TIMER);
+		debug2("%s: slurmstepd %s in %ld usec", __func__,
+		       pooled ? "taken from pool" : "forked", DELTA_TIMER);
+	}
+
+	if (pooled)
+		stepd_pool_refill();
+
+	return rc;
 }
 
 static void _setup_x11_display(uint32_t job_id, uint32_t step_id_in,
@@ -1765,13 +2068,12 @@ _get_user_env(batch_job_launch_msg_t *req)
  * value from the job credential to be certain it has not been
  * altered by the user */
 static void
-_set_batch_job_limits(slurm_msg_t *msg)
+_set_batch_job_limits(batch_job_launch_msg_t *req)
 {
 	int i;
 	uint32_t alloc_lps = 0, last_bit = 0;
 	bool cpu_log = slurm_conf.debug_flags & DEBUG_FLAG_CPU_BIND;
 	slurm_cred_arg_t arg;
-	batch_job_launch_msg_t *req = (batch_job_launch_msg_t *)msg->data;
 
 	if (slurm_cred_get_args(req->cred, &arg) != SLURM_SUCCESS)
 		return;
@@ -2290,14 +2592,21 @@ notify_result:
 	}
 }
 
-static void _rpc_batch_job(slurm_msg_t *msg)
+/*
+ * Launch one batch job.
+ * IN req - the launch request
+ * IN cli - address the request came from
+ * IN req_uid - uid that sent the request
+ * IN msg - the REQUEST_BATCH_JOB_LAUNCH to reply to, or NULL if the reply
+ *	    was already sent for the whole REQUEST_BATCH_JOB_LAUNCH_MULT, in
+ *	    which case every failure is reported with _launch_job_fail()
+ */
+static void _launch_batch_job(batch_job_launch_msg_t *req, slurm_addr_t *cli,
+			      uid_t req_uid, slurm_msg_t *msg)
 {
-	batch_job_launch_msg_t *req = (batch_job_launch_msg_t *)msg->data;
 	bool     first_job_run;
 	int      rc = SLURM_SUCCESS, node_id = 0;
-	bool	 replied = false, revoked;
-	slurm_addr_t *cli = &msg->orig_addr;
-	uid_t req_uid = g_slurm_auth_get_uid(msg->auth_cred);
+	bool	 replied = (msg == NULL), revoked;
 
 	if (!_slurm_authorized_user(req_uid)) {
 		error("Security violation, batch launch RPC from uid %d",
@@ -2310,7 +2619,8 @@ static void _rpc_batch_job(slurm_msg_t *msg)
 		error("Job %u already running, do not launch second copy",
 		      req->job_id);
 		rc = ESLURM_DUPLICATE_JOB_ID;	/* job already running */
-		_launch_job_fail(req->job_id, rc);
+		if (!replied)	/* else done: below reports it */
+			_launch_job_fail(req->job_id, rc);
 		goto done;
 	}
 
@@ -2341,17 +2651,19 @@ static void _rpc_batch_job(slurm_msg_t *msg)
 	 * for Moab (see --get-user-env), which could also be slow.
 	 * Just reply now and send a separate kill job request if the
 	 * prolog or launch fail. */
-	replied = true;
-	if (slurm_send_rc_msg(msg, rc) < 1) {
-		/* The slurmctld is no longer waiting for a reply.
-		 * This typically indicates that the slurmd was
-		 * blocked from memory and/or CPUs and the slurmctld
-		 * has requeued the batch job request. */
-		error("Could not confirm batch launch for job %u, "
-		      "aborting request", req->job_id);
-		rc = SLURM_COMMUNICATIONS_SEND_ERROR;
-		slurm_mutex_unlock(&prolog_mutex);
-		goto done;
+	if (!replied) {
+		replied = true;
+		if (slurm_send_rc_msg(msg, rc) < 1) {
+			/* The slurmctld is no longer waiting for a reply.
+			 * This typically indicates that the slurmd was
+			 * blocked from memory and/or CPUs and the slurmctld
+			 * has requeued the batch job request. */
+			error("Could not confirm batch launch for job %u, "
+			      "aborting request", req->job_id);
+			rc = SLURM_COMMUNICATIONS_SEND_ERROR;
+			slurm_mutex_unlock(&prolog_mutex);
+			goto done;
+		}
 	}
 
 	if (slurm_conf.prolog_flags & PROLOG_FLAG_ALLOC) {
@@ -2469,7 +2781,7 @@ static void _rpc_batch_job(slurm_msg_t *msg)
 			goto done;
 		}
 	}
-	_set_batch_job_limits(msg);
+	_set_batch_job_limits(req);
 
 	/* Since job could have been killed while the prolog was
 	 * running (especially on BlueGene, which can take minutes
@@ -2548,6 +2860,76 @@ done:
 	}
 }
 
+static void _rpc_batch_job(slurm_msg_t *msg)
+{
+	uid_t req_uid = g_slurm_auth_get_uid(msg->auth_cred);
+
+	_launch_batch_job((batch_job_launch_msg_t *) msg->data,
+			  &msg->orig_addr, req_uid, msg);
+}
+
+typedef struct {
+	slurm_addr_t cli;
+	batch_job_launch_msg_t *req;
+	uid_t req_uid;
+} batch_launch_args_t;
+
+static void *_batch_launch_thread(void *arg)
+{
+	batch_launch_args_t *args = (batch_launch_args_t *) arg;
+
+	_launch_batch_job(args->req, &args->cli, args->req_uid, NULL);
+
+	slurm_free_job_launch_msg(args->req);
+	xfree(args);
+	return NULL;
+}
+
+/*
+ * Launch many batch jobs sent by slurmctld in a single RPC. The RPC is
+ * authenticated and acknowledged once, then each job goes through the same
+ * path as REQUEST_BATCH_JOB_LAUNCH in its own thread so that slow prologs do
+ * not hold up the rest of the batch. Until the acknowledgement is sent the
+ * slurmctld owns the failure of the whole batch, after it each job reports
+ * its own.
+ */
+static void _rpc_batch_job_mult(slurm_msg_t *msg)
+{
+	List launch_list = (List) msg->data;
+	batch_job_launch_msg_t *req;
+	batch_launch_args_t *args;
+	uid_t req_uid = g_slurm_auth_get_uid(msg->auth_cred);
+	int rc = SLURM_SUCCESS;
+
+	if (!_slurm_authorized_user(req_uid)) {
+		error("Security violation, batch launch RPC from uid %d",
+		      req_uid);
+		rc = ESLURM_USER_ID_MISSING;  /* or bad in this case */
+	}
+
+	if (slurm_send_rc_msg(msg, rc) < 1) {
+		/*
+		 * The slurmctld got no reply, so it requeues every job of
+		 * the batch itself. Don't launch or fail any of them here.
+		 */
+		error("Could not confirm launch of %d batch jobs, aborting request",
+		      launch_list ? list_count(launch_list) : 0);
+		return;
+	}
+
+	if ((rc != SLURM_SUCCESS) || !launch_list)
+		return;
+
+	debug("%s: launching %d batch jobs", __func__, list_count(launch_list));
+	while ((req = list_pop(launch_list))) {
+		args = xmalloc(sizeof(*args));
+		memcpy(&args->cli, &msg->orig_addr, sizeof(slurm_addr_t));
+		args->req = req;
+		args->req_uid = req_uid;
+		slurm_thread_create_detached(NULL, _batch_launch_thread, args);
+	}
+}
+
 /*
  * Send notification message to batch job
  */
@@ -3517,6 +3899,17 @@ static void _rpc_daemon_status(slurm_msg_t *msg)
 	resp->slurmd_logfile     = xstrdup(conf->logfile);
 	resp->version            = xstrdup(SLURM_VERSION_STRING);
 
+	slurm_mutex_lock(&stepd_pool_mutex);
+	resp->stepd_pool_size    = _stepd_pool_size();
+	resp->stepd_pool_idle    = stepd_pool ? list_count(stepd_pool) : 0;
+	resp->stepd_fork_cnt     = stepd_launch_cnt[0];
+	resp->stepd_fork_usec    = stepd_launch_usec[0];
+	resp->stepd_fork_max     = stepd_launch_max[0];
+	resp->stepd_pool_cnt     = stepd_launch_cnt[1];
+	resp->stepd_pool_usec    = stepd_launch_usec[1];
+	resp->stepd_pool_max     = stepd_launch_max[1];
+	slurm_mutex_unlock(&stepd_pool_mutex);
+
 	slurm_msg_t_copy(&resp_msg, msg);
 	resp_msg.msg_type = RESPONSE_SLURMD_STATUS;
 	resp_msg.data     = resp;
@@ -54,6 +54,18 @@ void slurmd_req(slurm_msg_t *msg);
  */
 extern int send_slurmd_conf_lite(int fd, slurmd_conf_t *cf);
 
+/*
+ * Start filling the pool of idle slurmstepd processes up to the size set by
+ * LaunchParameters=slurmstepd_pool, if not already full.
+ */
+extern void stepd_pool_refill(void);
+
+/*
+ * Release all idle slurmstepd processes, e.g. after the configuration they
+ * were given has changed.
+ */
+extern void stepd_pool_flush(void);
+
 void gids_cache_purge(void);
 
 /* Add record for every launched job so we know they are ready for suspend */
@@ -638,6 +638,9 @@ static void _handle_node_reg_resp(slurm_msg_t *resp_msg)
 			xfree(conf->node_name);
 			conf->node_name = resp->node_name;
 		}
+
+		/* We can now hand the configuration to idle slurmstepds */
+		stepd_pool_refill();
 	}
 }
 
@@ -1096,6 +1099,10 @@ _reconfigure(void)
 	List gres_list = NULL;
 
 	_reconfig = 0;
+
+	/* Idle slurmstepds hold the old configuration */
+	stepd_pool_flush();
+
 	slurm_conf_reinit(conf->conffile);
 	xcgroup_reconfig_slurm_cgroup_conf();
 	_read_config();
@@ -1162,6 +1169,8 @@ _reconfigure(void)
 	/* reconfigure energy */
 	acct_gather_energy_g_set_data(ENERGY_DATA_RECONFIG, NULL);
 
+	stepd_pool_refill();
+
 	/*
 	 * XXX: reopen slurmd port?
 	 */
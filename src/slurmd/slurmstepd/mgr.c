@@ -1150,6 +1150,34 @@ fail1:
 	return rc;
 }
 
+/*
+ * Load the plugins used by job_manager(). Every init call here returns
+ * immediately once its plugin is loaded, so a pooled slurmstepd calls this
+ * before it is handed a step and job_manager() calls it again afterwards.
+ */
+extern int mgr_init_plugins(void)
+{
+	/*
+	 * Run acct_gather_conf_init() now so we don't drop permissions on any
+	 * of the gather plugins.
+	 * Preload all plugins afterwards to avoid plugin changes
+	 * (i.e. due to a Slurm upgrade) after the process starts.
+	 */
+	if ((acct_gather_conf_init() != SLURM_SUCCESS)          ||
+	    (core_spec_g_init() != SLURM_SUCCESS)		||
+	    (switch_init(1) != SLURM_SUCCESS)			||
+	    (slurm_proctrack_init() != SLURM_SUCCESS)		||
+	    (slurmd_task_init() != SLURM_SUCCESS)		||
+	    (jobacct_gather_init() != SLURM_SUCCESS)		||
+	    (acct_gather_profile_init() != SLURM_SUCCESS)	||
+	    (slurm_cred_init() != SLURM_SUCCESS)		||
+	    (job_container_init() != SLURM_SUCCESS)		||
+	    (gres_plugin_init() != SLURM_SUCCESS))
+		return SLURM_ERROR;
+
+	return SLURM_SUCCESS;
+}
+
 /*
  * Executes the functions of the slurmd job manager process,
  * which runs as root and performs shared memory and interconnect
@@ -1173,22 +1201,7 @@ job_manager(stepd_step_rec_t *job)
 		debug ("Unable to set dumpable to 1");
 #endif /* PR_SET_DUMPABLE */
 
-	/*
-	 * Run acct_gather_conf_init() now so we don't drop permissions on any
-	 * of the gather plugins.
-	 * Preload all plugins afterwards to avoid plugin changes
-	 * (i.e. due to a Slurm upgrade) after the process starts.
-	 */
-	if ((acct_gather_conf_init() != SLURM_SUCCESS)          ||
-	    (core_spec_g_init() != SLURM_SUCCESS)		||
-	    (switch_init(1) != SLURM_SUCCESS)			||
-	    (slurm_proctrack_init() != SLURM_SUCCESS)		||
-	    (slurmd_task_init() != SLURM_SUCCESS)		||
-	    (jobacct_gather_init() != SLURM_SUCCESS)		||
-	    (acct_gather_profile_init() != SLURM_SUCCESS)	||
-	    (slurm_cred_init() != SLURM_SUCCESS)		||
-	    (job_container_init() != SLURM_SUCCESS)		||
-	    (gres_plugin_init() != SLURM_SUCCESS)) {
+	if (mgr_init_plugins() != SLURM_SUCCESS) {
 		rc = SLURM_PLUGIN_NAME_INVALID;
 		goto fail1;
 	}
@@ -78,6 +78,12 @@ void mgr_launch_batch_job_cleanup(stepd_step_rec_t *job, int rc);
  */
 int job_manager(stepd_step_rec_t *job);
 
+/*
+ * Load the plugins used by job_manager() ahead of time.
+ * Returns SLURM_SUCCESS or SLURM_ERROR if any plugin fails to load.
+ */
+extern int mgr_init_plugins(void);
+
 /*
  * Register passwd entries so that we do not need to call initgroups(2)
  * frequently.
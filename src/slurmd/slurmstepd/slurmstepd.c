@@ -495,6 +495,68 @@ static void _set_job_log_prefix(slurm_step_id_t *step_id)
 	log_set_fpfx(&buf);
 }
 
+/*
+ *  This function handles the node configuration sent by
+ *  _send_slurmstepd_conf() in src/slurmd/slurmd/req.c.
+ */
+static void _init_conf_from_slurmd(int sock)
+{
+	/* receive conf from slurmd */
+	if (!(conf = read_slurmd_conf_lite(sock)))
+		fatal("Failed to read conf from slurmd");
+
+	/* receive cgroup conf from slurmd */
+	if (xcgroup_read_conf(sock) != SLURM_SUCCESS)
+		fatal("Failed to read cgroup conf from slurmd");
+
+	/* receive acct_gather conf from slurmd */
+	if (acct_gather_read_conf(sock) != SLURM_SUCCESS)
+		fatal("Failed to read acct_gather conf from slurmd");
+}
+
+/*
+ *  Wait in the slurmd's pool of idle slurmstepd processes. Reads the node
+ *  name sent with LAUNCH_POOLED, preloads the plugins and then blocks until
+ *  slurmd hands over a step.
+ *  OUT step_type - type of the step handed over
+ */
+static void _wait_in_pool(int sock, int *step_type)
+{
+	ssize_t rc;
+	int len;
+
+	safe_read(sock, &len, sizeof(int));
+	conf->node_name = xmalloc(len);
+	safe_read(sock, conf->node_name, len);
+
+	setproctitle("[pool]");
+
+	/*
+	 * Load plugins now so that work is off the launch path. On failure
+	 * job_manager() retries the load and reports the error for the step.
+	 */
+	if (mgr_init_plugins() != SLURM_SUCCESS)
+		error("%s: unable to preload plugins", __func__);
+
+	/*
+	 * Idle until slurmd hands us a step. slurmd closes the pipe to
+	 * release a pooled slurmstepd on reconfigure or shutdown.
+	 */
+	while (((rc = read(sock, step_type, sizeof(int))) < 0) &&
+	       (errno == EINTR))
+		;
+	if (rc == 0) {
+		debug("%s: released from slurmstepd pool", __func__);
+		exit(0);
+	}
+	if (rc == sizeof(int))
+		return;
+
+rwfail:
+	fatal("Error reading initialization data from slurmd");
+	exit(1);
+}
+
 /*
  *  This function handles the initialization information from slurmd
  *  sent by _send_slurmstepd_init() in src/slurmd/slurmd/req.c.
@@ -517,20 +579,13 @@ _init_from_slurmd(int sock, char **argv,
 		.step_het_comp = NO_VAL,
 	};
 
-	/* receive conf from slurmd */
-	if (!(conf = read_slurmd_conf_lite(sock)))
-		fatal("Failed to read conf from slurmd");
-
-	/* receive cgroup conf from slurmd */
-	if (xcgroup_read_conf(sock) != SLURM_SUCCESS)
-		fatal("Failed to read cgroup conf from slurmd");
-
-	/* receive acct_gather conf from slurmd */
-	if (acct_gather_read_conf(sock) != SLURM_SUCCESS)
-		fatal("Failed to read acct_gather conf from slurmd");
+	/* receive node configuration from slurmd */
+	_init_conf_from_slurmd(sock);
 
 	/* receive job type from slurmd */
 	safe_read(sock, &step_type, sizeof(int));
+	if (step_type == LAUNCH_POOLED)
+		_wait_in_pool(sock, &step_type);
 	debug3("step_type = %d", step_type);
 
 	/* receive reverse-tree info from slurmd */
@@ -636,6 +691,7 @@ _init_from_slurmd(int sock, char **argv,
 	 * Dynamic Future node mapping.
 	 */
 	safe_read(sock, &len, sizeof(int));
+	xfree(conf->node_name);
 	conf->node_name = xmalloc(len);
 	safe_read(sock, conf->node_name, len);
 
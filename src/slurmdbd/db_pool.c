@@ -0,0 +1,144 @@
+/*****************************************************************************\
+ *  db_pool.c - database connections shared by user queries
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/slurm_accounting_storage.h"
+#include "src/common/slurm_persist_conn.h"
+#include "src/common/timers.h"
+#include "src/common/xmalloc.h"
+#include "src/slurmdbd/db_pool.h"
+#include "src/slurmdbd/read_config.h"
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_cond = PTHREAD_COND_INITIALIZER;
+static List idle_list = NULL;	/* connections not in use */
+static int open_cnt = 0;	/* connections opened, idle or in use */
+static int pool_size = 0;
+static uint32_t wait_cnt = 0;	/* gets that had to wait */
+
+static void _close_conn(void *x)
+{
+	void *db_conn = x;
+
+	acct_storage_g_close_connection(&db_conn);
+}
+
+extern void db_pool_init(void)
+{
+	slurm_mutex_lock(&pool_lock);
+	pool_size = slurmdbd_conf->read_pool_size;
+	if (pool_size && !idle_list)
+		idle_list = list_create(_close_conn);
+	slurm_mutex_unlock(&pool_lock);
+
+	if (pool_size)
+		verbose("%s: up to %d pooled database connections for queries%s%s",
+			__func__, pool_size,
+			slurmdbd_conf->storage_read_host ? " on " : "",
+			slurmdbd_conf->storage_read_host ?
+			slurmdbd_conf->storage_read_host : "");
+}
+
+extern void db_pool_fini(void)
+{
+	slurm_mutex_lock(&pool_lock);
+	if (open_cnt != (idle_list ? list_count(idle_list) : 0))
+		error("%s: %d pooled connections still in use", __func__,
+		      open_cnt - (idle_list ? list_count(idle_list) : 0));
+	if (wait_cnt)
+		debug("%s: %u queries waited for a pooled connection",
+		      __func__, wait_cnt);
+	FREE_NULL_LIST(idle_list);
+	open_cnt = 0;
+	pool_size = 0;
+	wait_cnt = 0;
+	slurm_mutex_unlock(&pool_lock);
+}
+
+extern bool db_pool_enabled(void)
+{
+	bool enabled;
+
+	slurm_mutex_lock(&pool_lock);
+	enabled = (pool_size > 0);
+	slurm_mutex_unlock(&pool_lock);
+
+	return enabled;
+}
+
+extern void *db_pool_get_read_conn(void)
+{
+	void *db_conn = NULL;
+	uint16_t flags = PERSIST_FLAG_READ_ONLY;
+	bool waited = false;
+	DEF_TIMERS;
+
+	START_TIMER;
+	slurm_mutex_lock(&pool_lock);
+	while (idle_list && !(db_conn = list_pop(idle_list)) &&
+	       (open_cnt >= pool_size)) {
+		waited = true;
+		slurm_cond_wait(&pool_cond, &pool_lock);
+	}
+	if (!db_conn)
+		open_cnt++;
+	if (waited)
+		wait_cnt++;
+	slurm_mutex_unlock(&pool_lock);
+
+	/* Autocommit, so every query sees what has been committed since */
+	if (!db_conn)
+		db_conn = acct_storage_g_get_connection(0, &flags, false, NULL);
+
+	END_TIMER;
+	if (waited)
+		debug2("%s: waited %s for a pooled connection",
+		       __func__, TIME_STR);
+
+	return db_conn;
+}
+
+extern void db_pool_put_read_conn(void *db_conn)
+{
+	slurm_mutex_lock(&pool_lock);
+	if (idle_list)
+		list_push(idle_list, db_conn);
+	else
+		acct_storage_g_close_connection(&db_conn);
+	slurm_cond_signal(&pool_cond);
+	slurm_mutex_unlock(&pool_lock);
+}
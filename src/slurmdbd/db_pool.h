@@ -0,0 +1,67 @@
+/*****************************************************************************\
+ *  db_pool.h - database connections shared by user queries
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef _DB_POOL_H
+#define _DB_POOL_H
+
+#include <stdbool.h>
+
+/*
+ * Queries from users (sacct, sreport, sacctmgr list ...) run on a pool of
+ * at most ReadPoolSize database connections instead of the connection of
+ * the client, pointed at StorageReadHost if there is one. A burst of big
+ * user queries then waits for a pooled connection rather than competing
+ * with the slurmctld connections, which always use their own.
+ */
+
+/* Set up the pool if slurmdbd.conf asks for one */
+extern void db_pool_init(void);
+
+/* Close all pooled connections, none may be in use anymore */
+extern void db_pool_fini(void);
+
+/* Return true if queries should be run on pooled connections */
+extern bool db_pool_enabled(void);
+
+/*
+ * Get a pooled connection, waiting for one to be returned if the pool is
+ * at ReadPoolSize. Must be given back with db_pool_put_read_conn().
+ */
+extern void *db_pool_get_read_conn(void);
+
+/* Return a connection gotten from db_pool_get_read_conn() */
+extern void db_pool_put_read_conn(void *db_conn);
+
+#endif /* !_DB_POOL_H */
@@ -57,6 +57,7 @@
 #include "src/common/timers.h"
 #include "src/common/uid.h"
 #include "src/common/xstring.h"
+#include "src/slurmdbd/db_pool.h"
 #include "src/slurmdbd/read_config.h"
 #include "src/slurmdbd/rpc_mgr.h"
 #include "src/slurmdbd/proc_req.h"
@@ -64,6 +65,9 @@
 #include "src/slurmctld/slurmctld.h"
 
 /* Local functions */
+static bool  _is_query(uint16_t msg_type);
+static bool  _use_read_pool(slurmdbd_conn_t *slurmdbd_conn, uint16_t msg_type,
+			    uint32_t uid);
 static bool  _validate_slurm_user(uint32_t uid);
 static bool  _validate_super_user(uint32_t uid, slurmdbd_conn_t *slurmdbd_conn);
 static bool  _validate_operator(uint32_t uid, slurmdbd_conn_t *slurmdbd_conn);
@@ -263,10 +267,16 @@ proc_req(void *conn, persist_msg_t *msg,
 	int rc = SLURM_SUCCESS;
 	char *comment = NULL;
 	slurmdb_rpc_obj_t *rpc_obj;
+	void *own_db_conn = NULL;
 
 	DEF_TIMERS;
 	START_TIMER;
 
+	if (_use_read_pool(slurmdbd_conn, msg->msg_type, *uid)) {
+		own_db_conn = slurmdbd_conn->db_conn;
+		slurmdbd_conn->db_conn = db_pool_get_read_conn();
+	}
+
 	switch (msg->msg_type) {
 	case REQUEST_PERSIST_INIT:
 		rc = _unpack_persist_init(
@@ -552,18 +562,49 @@ proc_req(void *conn, persist_msg_t *msg,
 		break;
 	}
 
+	if (own_db_conn) {
+		db_pool_put_read_conn(slurmdbd_conn->db_conn);
+		slurmdbd_conn->db_conn = own_db_conn;
+	} else if (msg->msg_type == DBD_FINI) {
+		slurmdbd_conn->uncommitted = false;
+	} else if (!_is_query(msg->msg_type) &&
+		   (msg->msg_type != REQUEST_PERSIST_INIT) &&
+		   (msg->msg_type != DBD_GET_CONFIG) &&
+		   (msg->msg_type != DBD_GET_STATS)) {
+		slurmdbd_conn->uncommitted = true;
+	}
+
 	if (rc == ESLURM_ACCESS_DENIED)
 		error("CONN:%u Security violation, %s",
 		      slurmdbd_conn->conn->fd,
 		      slurmdbd_msg_type_2_str(msg->msg_type, 1));
-	else if (slurmdbd_conn->conn->rem_port
-		 && !slurmdbd_conf->commit_delay) {
+	else if (((slurmdbd_conn->conn->rem_port
+		   && !slurmdbd_conf->commit_delay)
+		  || slurmdbd_conn->agent_conn)
+		 && !slurmdbd_conn->in_mult_msg
+		 && (msg->msg_type != DBD_SEND_MULT_MSG)) {
 		/* If we are dealing with the slurmctld do the
 		   commit (SUCCESS or NOT) afterwards since we
 		   do transactions for performance reasons.
 		   (don't ever use autocommit with innodb)
+		   Agent connections aren't registered, so CommitDelay
+		   doesn't get to them.
+		   The storage plugin may defer statements until the
+		   commit, so don't ack the message if it failed, the
+		   sender will try again.
 		*/
-		acct_storage_g_commit(slurmdbd_conn->db_conn, 1);
+		if ((acct_storage_g_commit(slurmdbd_conn->db_conn, 1) !=
+		     SLURM_SUCCESS) && (rc == SLURM_SUCCESS) &&
+		    !_is_query(msg->msg_type)) {
+			comment = "Commit failed";
+			error("CONN:%u %s for %s", slurmdbd_conn->conn->fd,
+			      comment, slurmdbd_msg_type_2_str(msg->msg_type, 1));
+			rc = SLURM_ERROR;
+			free_buf(*out_buffer);
+			*out_buffer = slurm_persist_make_rc_msg(
+				slurmdbd_conn->conn, rc, comment,
+				msg->msg_type);
+		}
 	}
 
 	END_TIMER;
@@ -595,6 +636,52 @@ proc_req(void *conn, persist_msg_t *msg,
 	return rc;
 }
 
+/* Return true if the RPC only reads from the database */
+static bool _is_query(uint16_t msg_type)
+{
+	switch (msg_type) {
+	case DBD_GET_ACCOUNTS:
+	case DBD_GET_ASSOCS:
+	case DBD_GET_ASSOC_USAGE:
+	case DBD_GET_CLUSTERS:
+	case DBD_GET_CLUSTER_USAGE:
+	case DBD_GET_EVENTS:
+	case DBD_GET_FEDERATIONS:
+	case DBD_GET_JOBS_COND:
+	case DBD_GET_PROBS:
+	case DBD_GET_QOS:
+	case DBD_GET_RES:
+	case DBD_GET_RESVS:
+	case DBD_GET_TRES:
+	case DBD_GET_TXN:
+	case DBD_GET_USERS:
+	case DBD_GET_WCKEYS:
+	case DBD_GET_WCKEY_USAGE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/*
+ * Return true if the RPC should run on a pooled connection. Only user
+ * queries do, the slurmctld keeps its own connection so it never waits
+ * behind them, and a client with uncommitted changes has to see them.
+ * Pooled connections have no cluster name, so queries that default to the
+ * cluster of the client (reservations) stay on the connection of the client.
+ */
+static bool _use_read_pool(slurmdbd_conn_t *slurmdbd_conn, uint16_t msg_type,
+			   uint32_t uid)
+{
+	if (!slurmdbd_conn->db_conn || !_is_query(msg_type) ||
+	    (msg_type == DBD_GET_RESVS) || !db_pool_enabled())
+		return false;
+	if (slurmdbd_conn->conn->rem_port || slurmdbd_conn->agent_conn ||
+	    slurmdbd_conn->uncommitted || _validate_slurm_user(uid))
+		return false;
+	return true;
+}
+
 /*
  * _validate_slurm_user - validate that the uid is authorized to see
  *      privileged data (either user root or SlurmUser)
@@ -717,6 +804,8 @@ static int _handle_init_msg(slurmdbd_conn_t *slurmdbd_conn,
 	      slurmdbd_conn->conn->rem_host, slurmdbd_conn->conn->fd);
 
 	slurmdbd_conn->conn->cluster_name = xstrdup(init_msg->cluster_name);
+	if (init_msg->persist_type == PERSIST_TYPE_DBD_AGENT)
+		slurmdbd_conn->agent_conn = true;
 
 	/* When dealing with rollbacks it turns out it is much faster
 	   to do the commit once or once in a while instead of
@@ -1179,7 +1268,7 @@ end_it:
 		slurmdbd_conn->tres_str = cluster_tres_msg->tres_str;
 		cluster_tres_msg->tres_str = NULL;
 	}
-	if (!slurmdbd_conn->conn->rem_port) {
+	if (!slurmdbd_conn->conn->rem_port && !slurmdbd_conn->agent_conn) {
 		debug3("DBD_CLUSTER_TRES: cluster not registered");
 		slurmdbd_conn->conn->rem_port =
 			clusteracct_storage_g_register_disconn_ctld(
@@ -1421,6 +1510,76 @@ static int _get_events(slurmdbd_conn_t *slurmdbd_conn,
 	return rc;
 }
 
+typedef struct {
+	slurmdbd_conn_t *slurmdbd_conn;
+	uint32_t job_cnt;
+	uint32_t part_cnt;
+} jobs_stream_t;
+
+/* Send one part of a streamed DBD_GET_JOBS_COND response */
+static int _send_jobs_part(List job_list, void *arg)
+{
+	jobs_stream_t *stream = arg;
+	dbd_list_msg_t list_msg = { NULL };
+	Buf buffer;
+	int rc;
+
+	list_msg.my_list = job_list;
+	buffer = init_buf(BUF_SIZE);
+	pack16((uint16_t) DBD_GOT_JOBS_PART, buffer);
+	slurmdbd_pack_list_msg(&list_msg, stream->slurmdbd_conn->conn->version,
+			       DBD_GOT_JOBS_PART, buffer);
+	rc = slurm_persist_send_msg(stream->slurmdbd_conn->conn, buffer);
+	free_buf(buffer);
+
+	if (rc != SLURM_SUCCESS) {
+		error("DBD_GET_JOBS_COND: unable to send part %u to %s: %s",
+		      stream->part_cnt, stream->slurmdbd_conn->conn->rem_host,
+		      slurm_strerror(rc));
+		return rc;
+	}
+	stream->job_cnt += list_count(job_list);
+	stream->part_cnt++;
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Hand the jobs to the client as the storage plugin reads them. The last
+ * message is an empty DBD_GOT_JOBS, or an rc message on error.
+ */
+static int _get_jobs_cond_stream(slurmdbd_conn_t *slurmdbd_conn,
+				 slurmdb_job_cond_t *job_cond,
+				 Buf *out_buffer, uint32_t *uid)
+{
+	jobs_stream_t stream = { .slurmdbd_conn = slurmdbd_conn };
+	dbd_list_msg_t list_msg = { NULL };
+	int rc;
+
+	rc = jobacct_storage_g_get_jobs_cond_stream(
+		slurmdbd_conn->db_conn, *uid, job_cond,
+		_send_jobs_part, &stream);
+
+	debug2("DBD_GET_JOBS_COND: sent %u jobs in %u parts",
+	       stream.job_cnt, stream.part_cnt);
+
+	if (rc != SLURM_SUCCESS) {
+		*out_buffer = slurm_persist_make_rc_msg(slurmdbd_conn->conn,
+							rc, slurm_strerror(rc),
+							DBD_GET_JOBS_COND);
+		return SLURM_ERROR;
+	}
+
+	list_msg.my_list = list_create(NULL);
+	*out_buffer = init_buf(1024);
+	pack16((uint16_t) DBD_GOT_JOBS, *out_buffer);
+	slurmdbd_pack_list_msg(&list_msg, slurmdbd_conn->conn->version,
+			       DBD_GOT_JOBS, *out_buffer);
+	FREE_NULL_LIST(list_msg.my_list);
+
+	return SLURM_SUCCESS;
+}
+
 static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn,
 			  persist_msg_t *msg, Buf *out_buffer, uint32_t *uid)
 {
@@ -1465,6 +1624,11 @@ static int _get_jobs_cond(slurmdbd_conn_t *slurmdbd_conn,
 		}
 	}
 
+	if ((job_cond->flags & JOBCOND_FLAG_STREAM) &&
+	    (slurmdbd_conn->conn->version >= SLURM_20_11_PROTOCOL_VERSION))
+		return _get_jobs_cond_stream(slurmdbd_conn, job_cond,
+					     out_buffer, uid);
+
 	list_msg.my_list = jobacct_storage_g_get_jobs_cond(
 		slurmdbd_conn->db_conn, *uid, job_cond);
 
@@ -1913,7 +2077,7 @@ static int  _job_complete(slurmdbd_conn_t *slurmdbd_conn,
 	/* just in case this gets set we need to clear it */
 	xfree(job.wckey);
 
-	if (!slurmdbd_conn->conn->rem_port) {
+	if (!slurmdbd_conn->conn->rem_port && !slurmdbd_conn->agent_conn) {
 		debug3("DBD_JOB_COMPLETE: cluster not registered");
 		slurmdbd_conn->conn->rem_port =
 			clusteracct_storage_g_register_disconn_ctld(
@@ -2665,7 +2829,7 @@ static void _process_job_start(slurmdbd_conn_t *slurmdbd_conn,
 	if (!job_start_msg->wckey)
 		xfree(job.wckey);
 
-	if (!slurmdbd_conn->conn->rem_port) {
+	if (!slurmdbd_conn->conn->rem_port && !slurmdbd_conn->agent_conn) {
 		debug3("DBD_JOB_START: cluster not registered");
 		slurmdbd_conn->conn->rem_port =
 			clusteracct_storage_g_register_disconn_ctld(
@@ -3365,6 +3529,7 @@ static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 
 	list_msg.my_list = list_create(slurmdbd_free_buffer);
 	/* START_TIMER; */
+	slurmdbd_conn->in_mult_msg = true;
 	itr = list_iterator_create(get_msg->my_list);
 	while ((req_buf = list_next(itr))) {
 		persist_msg_t sub_msg;
@@ -3387,6 +3552,25 @@ static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 			break;
 	}
 	list_iterator_destroy(itr);
+	slurmdbd_conn->in_mult_msg = false;
+
+	/*
+	 * Commit the whole batch at once.  Statements the storage plugin
+	 * deferred are only sent now, so if that fails have slurmctld send
+	 * the batch again.
+	 */
+	if (((slurmdbd_conn->conn->rem_port && !slurmdbd_conf->commit_delay) ||
+	     slurmdbd_conn->agent_conn) &&
+	    (acct_storage_g_commit(slurmdbd_conn->db_conn, 1) !=
+	     SLURM_SUCCESS)) {
+		comment = "DBD_SEND_MULT_MSG commit failed";
+		error("CONN:%u %s", slurmdbd_conn->conn->fd, comment);
+		FREE_NULL_LIST(list_msg.my_list);
+		*out_buffer = slurm_persist_make_rc_msg(slurmdbd_conn->conn,
+							SLURM_ERROR, comment,
+							DBD_SEND_MULT_MSG);
+		return SLURM_ERROR;
+	}
 	/* END_TIMER; */
 	/* info("%d multi took %s", list_count(get_msg->my_list), TIME_STR); */
 
@@ -3452,7 +3636,7 @@ static int  _step_complete(slurmdbd_conn_t *slurmdbd_conn,
 	/* just in case this gets set we need to clear it */
 	xfree(job.wckey);
 
-	if (!slurmdbd_conn->conn->rem_port) {
+	if (!slurmdbd_conn->conn->rem_port && !slurmdbd_conn->agent_conn) {
 		debug3("DBD_STEP_COMPLETE: cluster not registered");
 		slurmdbd_conn->conn->rem_port =
 			clusteracct_storage_g_register_disconn_ctld(
@@ -3530,7 +3714,7 @@ static int  _step_start(slurmdbd_conn_t *slurmdbd_conn,
 	/* just in case this gets set we need to clear it */
 	xfree(job.wckey);
 
-	if (!slurmdbd_conn->conn->rem_port) {
+	if (!slurmdbd_conn->conn->rem_port && !slurmdbd_conn->agent_conn) {
 		debug3("DBD_STEP_START: cluster not registered");
 		slurmdbd_conn->conn->rem_port =
 			clusteracct_storage_g_register_disconn_ctld(
@@ -46,6 +46,11 @@
 typedef struct {
 	slurm_persist_conn_t *conn;
 	void *db_conn; /* database connection */
+	bool agent_conn; /* extra connection draining the slurmctld agent queue,
+			  * not the one the cluster registered on */
+	bool in_mult_msg; /* commit once at the end of DBD_SEND_MULT_MSG */
+	bool uncommitted; /* db_conn may hold changes not committed yet, so
+			   * queries can't go to a pooled connection */
 	char *tres_str;
 } slurmdbd_conn_t;
 
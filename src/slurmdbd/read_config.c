@@ -87,6 +87,7 @@ static void _clear_slurmdbd_conf(void)
 	free_slurm_conf(&slurm_conf, 0);
 
 	if (slurmdbd_conf) {
+		slurmdbd_conf->archive_columnar = false;
 		xfree(slurmdbd_conf->archive_dir);
 		xfree(slurmdbd_conf->archive_script);
 		slurmdbd_conf->commit_delay = 0;
@@ -107,7 +108,10 @@ static void _clear_slurmdbd_conf(void)
 		slurmdbd_conf->purge_suspend = 0;
 		slurmdbd_conf->purge_txn = 0;
 		slurmdbd_conf->purge_usage = 0;
+		slurmdbd_conf->read_pool_size = 0;
+		slurmdbd_conf->rollup_threads = 0;
 		xfree(slurmdbd_conf->storage_loc);
+		xfree(slurmdbd_conf->storage_read_host);
 		slurmdbd_conf->track_wckey = 0;
 		slurmdbd_conf->track_ctld = 0;
 	}
@@ -175,6 +179,7 @@ extern int read_slurmdbd_conf(void)
 		{"StorageParameters", S_P_STRING},
 		{"StoragePass", S_P_STRING},
 		{"StoragePort", S_P_UINT16},
+		{"StorageReadHost", S_P_STRING},
 		{"StorageType", S_P_STRING},
 		{"StorageUser", S_P_STRING},
 		{"TCPTimeout", S_P_UINT16},
@@ -332,10 +337,33 @@ extern int read_slurmdbd_conf(void)
 
 		s_p_get_string(&slurmdbd_conf->parameters, "Parameters", tbl);
 		if (slurmdbd_conf->parameters) {
+			char *tmp_ptr;
+			if (xstrcasestr(slurmdbd_conf->parameters,
+					"ArchiveColumnar"))
+				slurmdbd_conf->archive_columnar = true;
 			if (xstrcasestr(slurmdbd_conf->parameters,
 					"PreserveCaseUser"))
 				slurmdbd_conf->persist_conn_rc_flags |=
 					PERSIST_FLAG_P_USER_CASE;
+			if ((tmp_ptr = xstrcasestr(slurmdbd_conf->parameters,
+						   "ReadPoolSize="))) {
+				int size = atoi(tmp_ptr + 13);
+				if ((size < 0) || (size > 256))
+					error("Invalid ReadPoolSize=%d, ignoring",
+					      size);
+				else
+					slurmdbd_conf->read_pool_size = size;
+			}
+			if ((tmp_ptr = xstrcasestr(slurmdbd_conf->parameters,
+						   "RollupThreads="))) {
+				int threads = atoi(tmp_ptr + 14);
+				if ((threads < 1) || (threads > 64))
+					error("Invalid RollupThreads=%d, ignoring",
+					      threads);
+				else
+					slurmdbd_conf->rollup_threads =
+						threads;
+			}
 		}
 
 		s_p_get_string(&slurmdbd_conf->pid_file, "PidFile", tbl);
@@ -526,6 +554,13 @@ extern int read_slurmdbd_conf(void)
 			       "StoragePass", tbl);
 		s_p_get_uint16(&slurm_conf.accounting_storage_port,
 		               "StoragePort", tbl);
+		s_p_get_string(&slurmdbd_conf->storage_read_host,
+			       "StorageReadHost", tbl);
+		/* A replica is only used by pooled queries */
+		if (slurmdbd_conf->storage_read_host &&
+		    !xstrcasestr(slurmdbd_conf->parameters, "ReadPoolSize="))
+			slurmdbd_conf->read_pool_size =
+				DEFAULT_SLURMDBD_READ_POOL_SIZE;
 		s_p_get_string(&slurm_conf.accounting_storage_type,
 		               "StorageType", tbl);
 		s_p_get_string(&slurm_conf.accounting_storage_user,
@@ -739,6 +774,7 @@ extern void log_config(void)
 	/* debug2("StoragePass       = %s",
 	       slurm_conf.accounting_storage_pass); */
 	debug2("StoragePort       = %u", slurm_conf.accounting_storage_port);
+	debug2("StorageReadHost   = %s", slurmdbd_conf->storage_read_host);
 	debug2("StorageType       = %s", slurm_conf.accounting_storage_type);
 	debug2("StorageUser       = %s", slurm_conf.accounting_storage_user);
 
@@ -1044,6 +1080,11 @@ extern List dump_config(void)
 	                                 slurm_conf.accounting_storage_port);
 	list_append(my_list, key_pair);
 
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("StorageReadHost");
+	key_pair->value = xstrdup(slurmdbd_conf->storage_read_host);
+	list_append(my_list, key_pair);
+
 	key_pair = xmalloc(sizeof(config_key_pair_t));
 	key_pair->name = xstrdup("StorageType");
 	key_pair->value = xstrdup(slurm_conf.accounting_storage_type);
@@ -50,12 +50,15 @@
 //#define DEFAULT_SLURMDBD_JOB_PURGE	12
 #define DEFAULT_SLURMDBD_PIDFILE	"/var/run/slurmdbd.pid"
 #define DEFAULT_SLURMDBD_ARCHIVE_DIR	"/tmp"
+#define DEFAULT_SLURMDBD_READ_POOL_SIZE	8
 //#define DEFAULT_SLURMDBD_STEP_PURGE	1
 
 /* SlurmDBD configuration parameters */
 typedef struct {
 	char *		archive_dir;    /* location to locally store
 					 * data if not using a script   */
+	bool		archive_columnar; /* write columnar, compressed
+					   * archive files		*/
 	char *		archive_script;	/* script to archive old data	*/
 	uint16_t        commit_delay;   /* On busy systems delay
 					 * commits from slurmctld this
@@ -88,7 +91,13 @@ typedef struct {
 					 * than this in months or days	*/
 	uint32_t        purge_usage;    /* purge usage data older
 					 * than this in months or days	*/
+	uint16_t	read_pool_size;	/* database connections shared by
+					 * user queries, 0 if not pooled */
+	uint16_t	rollup_threads;	/* hours of an hourly rollup to
+					 * work on at once per cluster	*/
 	char *		storage_loc;	/* database name		*/
+	char *		storage_read_host; /* database replica to run
+					    * pooled queries against	*/
 	uint16_t	syslog_debug;	/* output to both logfile and syslog*/
 	uint16_t        track_wckey;    /* Whether or not to track wckey*/
 	uint16_t        track_ctld;     /* Whether or not track when a
@@ -68,6 +68,7 @@
 #include "src/common/xstring.h"
 
 #include "src/slurmdbd/read_config.h"
+#include "src/slurmdbd/db_pool.h"
 #include "src/slurmdbd/rpc_mgr.h"
 #include "src/slurmdbd/proc_req.h"
 #include "src/slurmdbd/backup.h"
@@ -169,6 +170,7 @@ int main(int argc, char **argv)
 		_set_work_dir();
 	log_config();
 	init_dbd_stats();
+	db_pool_init();
 
 #ifdef PR_SET_DUMPABLE
 	if (prctl(PR_SET_DUMPABLE, 1) < 0)
@@ -317,6 +319,7 @@ end_it:
 	}
 
 	assoc_mgr_fini(0);
+	db_pool_fini();
 	slurm_acct_storage_fini();
 	slurm_auth_fini();
 	log_fini();
@@ -330,6 +333,7 @@ end_it:
 extern void reconfig(void)
 {
 	read_slurmdbd_conf();
+	db_pool_init();
 	assoc_mgr_set_missing_uids();
 	acct_storage_g_reconfig(NULL, 0);
 	_update_logging(false);
@@ -388,6 +392,9 @@ extern void handle_rollup_stats(List rollup_stats_list,
 			rpc_rollup_stats->timestamp[i] =
 				rollup_stats->timestamp[i];
 		}
+		for (int i = 0; i < DBD_ROLLUP_PHASE_COUNT; i++)
+			rpc_rollup_stats->phase_time[i] +=
+				rollup_stats->phase_time[i];
 	}
 	list_iterator_destroy(itr);
 
@@ -40,7 +40,13 @@
 #include <netdb.h>
 #include <poll.h>
 #include <signal.h>
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#else
+#error "the slurmrestd connection manager requires epoll"
+#endif
 #include <sys/ioctl.h>
+#include <sys/resource.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -69,14 +75,22 @@
 #define MAGIC_WRAP_WORK 0xD231444A
 /* Default buffer to 1 page */
 #define BUFFER_START_SIZE 4096
-#define MAX_OPEN_CONNECTIONS 124
+/* always allow this many connections regardless of the open file limit */
+#define MIN_OPEN_CONNECTIONS 124
+/* file descriptors left for everything but connections */
+#define RESERVED_FDS 64
+/* most events to handle per call to epoll_wait() */
+#define MAX_EPOLL_EVENTS 64
+/* most output to queue per connection before writers wait on the client */
+#define MAX_OUT_QUEUE (4 * 1024 * 1024)
 
 /*
  * there can only be 1 SIGINT handler, so we are using a mutex to protect
- * the sigint_fd for changes.
+ * the sigint_fd and running_mgr for changes.
  */
 pthread_mutex_t sigint_mutex = PTHREAD_MUTEX_INITIALIZER;
 int sigint_fd[2] = { -1, -1 };
+static con_mgr_t *running_mgr = NULL;
 
 static int _close_con_for_each(void *x, void *arg);
 static void _listen_accept(void *x);
@@ -85,9 +99,6 @@ static inline void _add_con_work(bool locked, con_mgr_fd_t *con,
 				 work_func_t func, void *arg, const char *tag);
 static void _wrap_on_data(void *x);
 
-typedef void (*on_poll_event_t)(con_mgr_t *mgr, int fd, con_mgr_fd_t *con,
-				short revents);
-
 typedef struct {
 	int magic;
 	con_mgr_fd_t *con;
@@ -96,29 +107,10 @@ typedef struct {
 	const char *tag;
 } wrap_work_arg_t;
 
-/* simple struct to keep track of fds */
-typedef struct {
-	con_mgr_t *mgr;
-	struct pollfd *fds;
-	int nfds;
-} poll_args_t;
-
-#ifndef NDEBUG
 static int _find_by_ptr(void *x, void *key)
 {
 	return (x == key);
 }
-#endif /*!NDEBUG */
-
-/*
- * Find by matching fd to connection
- */
-static int _find_by_fd(void *x, void *key)
-{
-	con_mgr_fd_t *con = x;
-	int fd = *(int *)key;
-	return (con->input_fd == fd) || (con->output_fd == fd);
-}
 
 static inline void _check_magic_mgr(con_mgr_t *mgr)
 {
@@ -210,13 +202,30 @@ try_again:
 	}
 }
 
+/*
+ * Watch pipe with epoll. Pipes are level triggered and stay in epoll set for
+ * the life of the mgr. They are told apart from connections by the pointer.
+ */
+static void _watch_pipe(con_mgr_t *mgr, int *fd)
+{
+	struct epoll_event ev = {
+		.events = EPOLLIN,
+		.data.ptr = fd,
+	};
+
+	if (epoll_ctl(mgr->epoll_fd, EPOLL_CTL_ADD, *fd, &ev))
+		fatal("%s: unable to watch pipe: %m", __func__);
+}
+
 extern con_mgr_t *init_con_mgr(int thread_count)
 {
 	con_mgr_t *mgr = xmalloc(sizeof(*mgr));
+	struct rlimit rlim;
 
 	mgr->magic = MAGIC_CON_MGR;
 	mgr->connections = list_create(NULL);
 	mgr->listen = list_create(NULL);
+	mgr->inspect = list_create(NULL);
 
 	slurm_mutex_init(&mgr->mutex);
 	slurm_cond_init(&mgr->cond, NULL);
@@ -235,6 +244,24 @@ extern con_mgr_t *init_con_mgr(int thread_count)
 	fd_set_blocking(mgr->sigint_fd[0]);
 	fd_set_blocking(mgr->sigint_fd[1]);
 
+	if ((mgr->epoll_fd = epoll_create1(EPOLL_CLOEXEC)) == -1)
+		fatal("%s: unable to create epoll fd: %m", __func__);
+
+	_watch_pipe(mgr, &mgr->event_fd[0]);
+	_watch_pipe(mgr, &mgr->sigint_fd[0]);
+
+	/* each connection holds a file descriptor */
+	mgr->max_connections = MIN_OPEN_CONNECTIONS;
+	if (getrlimit(RLIMIT_NOFILE, &rlim))
+		error("%s: unable to get open file limit: %m", __func__);
+	else if (rlim.rlim_cur == RLIM_INFINITY)
+		mgr->max_connections = INT_MAX;
+	else if (rlim.rlim_cur > (MIN_OPEN_CONNECTIONS + RESERVED_FDS))
+		mgr->max_connections = rlim.rlim_cur - RESERVED_FDS;
+
+	log_flag(NET, "%s: accepting up to %d connections",
+		 __func__, mgr->max_connections);
+
 	_check_magic_mgr(mgr);
 
 	return mgr;
@@ -249,22 +276,28 @@ static void _signal_change(con_mgr_t *mgr, bool locked)
 
 	_check_magic_mgr(mgr);
 
-	log_flag(NET, "%s: sending", __func__);
+	if (!locked)
+		slurm_mutex_lock(&mgr->mutex);
 
+	/* one unread byte is enough to wake up _watch() */
+	if (!mgr->event_signaled) {
+		log_flag(NET, "%s: sending", __func__);
+		mgr->event_signaled = true;
 try_again:
-	/* send 1 byte of trash */
-	if (write(mgr->event_fd[1], buf, 1) != 1) {
-		if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
-			log_flag(NET, "%s: trying again: %m", __func__);
-			goto try_again;
-		}
+		/* send 1 byte of trash */
+		if (write(mgr->event_fd[1], buf, 1) != 1) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK ||
+			    errno == EINTR) {
+				log_flag(NET, "%s: trying again: %m",
+					 __func__);
+				goto try_again;
+			}
 
-		fatal("%s: unable to signal connection manager: %m", __func__);
+			fatal("%s: unable to signal connection manager: %m",
+			      __func__);
+		}
 	}
 
-	if (!locked)
-		slurm_mutex_lock(&mgr->mutex);
-
 	slurm_cond_broadcast(&mgr->cond);
 
 	if (!locked)
@@ -282,7 +315,7 @@ static void _close_all_connections(void *x)
 	list_for_each(mgr->connections, _close_con_for_each, NULL);
 	list_for_each(mgr->listen, _close_con_for_each, NULL);
 
-	/* break out of any poll() calls */
+	/* break out of epoll_wait() */
 	_signal_change(mgr, true);
 
 	slurm_mutex_unlock(&mgr->mutex);
@@ -309,14 +342,13 @@ extern void free_con_mgr(con_mgr_t *mgr)
 	 * It should be safe to shutdown the mgr.
 	 */
 	xassert(mgr->shutdown);
-	xassert(!mgr->poll_active);
-	xassert(!mgr->listen_active);
-	xassert(!mgr->inspecting);
 
 	xassert(list_is_empty(mgr->connections));
 	xassert(list_is_empty(mgr->listen));
+	xassert(list_is_empty(mgr->inspect));
 	FREE_NULL_LIST(mgr->connections);
 	FREE_NULL_LIST(mgr->listen);
+	FREE_NULL_LIST(mgr->inspect);
 
 	slurm_mutex_destroy(&mgr->mutex);
 	slurm_cond_destroy(&mgr->cond);
@@ -327,10 +359,27 @@ extern void free_con_mgr(con_mgr_t *mgr)
 	if (close(mgr->sigint_fd[0]) || close(mgr->sigint_fd[1]))
 		error("%s: unable to close sigint_fd: %m", __func__);
 
+	if (close(mgr->epoll_fd))
+		error("%s: unable to close epoll_fd: %m", __func__);
+
 	mgr->magic = ~MAGIC_CON_MGR;
 	xfree(mgr);
 }
 
+/*
+ * Have _watch() inspect connection state after an event or a change.
+ * mgr mutex must be locked.
+ */
+static void _queue_inspect(con_mgr_fd_t *con)
+{
+	if (con->inspect)
+		return;
+
+	con->inspect = true;
+	list_append(con->mgr->inspect, con);
+	_signal_change(con->mgr, true);
+}
+
 /*
  * Stop reading from connection but write out the remaining buffer and finish
  * any queued work
@@ -380,6 +429,8 @@ static void _close_con(bool locked, con_mgr_fd_t *con)
 
 	/* forget the now invalid FD */
 	con->input_fd = -1;
+
+	_queue_inspect(con);
 cleanup:
 	if (!locked)
 		slurm_mutex_unlock(&con->mgr->mutex);
@@ -424,6 +475,8 @@ static inline con_mgr_fd_t *
 		/* save socket type to avoid calling fstat() again */
 		.is_socket = (addr && S_ISSOCK(fbuf.st_mode)),
 		.is_listen = is_listen,
+		/* nothing has been written yet */
+		.can_write = !is_listen,
 		.mgr = mgr,
 		.work = list_create(NULL),
 	};
@@ -505,10 +558,13 @@ static inline con_mgr_fd_t *
 		 __func__, con->name, input_fd, output_fd);
 
 	slurm_mutex_lock(&mgr->mutex);
-	if (is_listen)
+	if (is_listen) {
 		list_append(mgr->listen, con);
-	else
+	} else {
 		list_append(mgr->connections, con);
+		mgr->connections_total++;
+	}
+	_queue_inspect(con);
 	slurm_mutex_unlock(&mgr->mutex);
 
 	_check_magic_fd(con);
@@ -571,7 +627,7 @@ static void _wrap_work(void *x)
 	xassert(con->has_work);
 	con->has_work = false;
 
-	_signal_change(mgr, true);
+	_queue_inspect(con);
 	slurm_mutex_unlock(&mgr->mutex);
 
 	args->magic = ~MAGIC_WRAP_WORK;
@@ -602,8 +658,6 @@ static inline void _add_con_work_args(bool locked, con_mgr_fd_t *con,
 		list_append(con->work, args);
 	}
 
-	_signal_change(con->mgr, true);
-
 	if (!locked)
 		slurm_mutex_unlock(&con->mgr->mutex);
 }
@@ -692,9 +746,12 @@ static void _handle_read(void *x)
 	}
 }
 
-static void _handle_write(void *x)
+/*
+ * Write as much of the outgoing buffer as the fd will take without blocking
+ * RET SLURM_SUCCESS or error if the connection was closed
+ */
+static int _write_fd(con_mgr_fd_t *con)
 {
-	con_mgr_fd_t *con = x;
 	ssize_t wrote;
 
 	_check_magic_fd(con);
@@ -703,7 +760,7 @@ static void _handle_write(void *x)
 	if (get_buf_offset(con->out) == 0) {
 		log_flag(NET, "%s: [%s] skipping attempt to write 0 bytes",
 			 __func__, con->name);
-		return;
+		return SLURM_SUCCESS;
 	}
 
 	log_flag(NET, "%s: [%s] attempting to write %u bytes to fd %u",
@@ -724,17 +781,17 @@ static void _handle_write(void *x)
 		if (errno == EAGAIN || errno == EWOULDBLOCK) {
 			log_flag(NET, "%s: [%s] retry write: %m",
 				 __func__, con->name);
-			return;
+			return SLURM_SUCCESS;
 		}
 
 		error("%s: [%s] error while write: %m", __func__, con->name);
 		/* drop outbound data on the floor */
 		set_buf_offset(con->out, 0);
 		_close_con(false, con);
-		return;
+		return SLURM_COMMUNICATIONS_SEND_ERROR;
 	} else if (wrote == 0) {
 		log_flag(NET, "%s: [%s] write 0 bytes", __func__, con->name);
-		return;
+		return SLURM_SUCCESS;
 	}
 
 	log_flag(NET, "%s: [%s] wrote %zu/%u bytes",
@@ -755,6 +812,19 @@ static void _handle_write(void *x)
 		set_buf_offset(con->out, (get_buf_offset(con->out) - wrote));
 	} else
 		set_buf_offset(con->out, 0);
+
+	return SLURM_SUCCESS;
+}
+
+static void _handle_write(void *x)
+{
+	con_mgr_fd_t *con = x;
+	int rc = _write_fd(con);
+
+	slurm_mutex_lock(&con->mgr->mutex);
+	/* only wait on epoll once the kernel will not take any more */
+	con->can_write = !rc && !get_buf_offset(con->out);
+	slurm_mutex_unlock(&con->mgr->mutex);
 }
 
 static void _wrap_on_data(void *x)
@@ -937,43 +1007,102 @@ extern int con_mgr_process_fd_unix_listen(con_mgr_t *mgr, int fd,
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Ask epoll to report once fd is ready for events. Connections are always
+ * watched with EPOLLONESHOT so an event is only handed out once and the
+ * connection is not watched again until it has been inspected.
+ * mgr mutex must be locked.
+ *
+ * IN con connection to watch
+ * IN fd file descriptor of connection to watch
+ * IN events EPOLLIN and/or EPOLLOUT
+ * IN/OUT registered true if fd is already in the epoll set
+ */
+static void _watch_fd(con_mgr_fd_t *con, int fd, uint32_t events,
+		      bool *registered)
+{
+	struct epoll_event ev = {
+		.events = (events | EPOLLONESHOT),
+		.data.ptr = con,
+	};
+	int op = (*registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD);
+
+	if (!epoll_ctl(con->mgr->epoll_fd, op, fd, &ev)) {
+		*registered = true;
+		return;
+	}
+
+	if (errno == EPERM) {
+		/* regular files can not be watched but never block */
+		log_flag(NET, "%s: [%s] fd %d can not be watched: %m",
+			 __func__, con->name, fd);
+
+		if (events & EPOLLIN)
+			con->can_read = true;
+		if (events & EPOLLOUT)
+			con->can_write = true;
+
+		_queue_inspect(con);
+		return;
+	}
+
+	error("%s: [%s] unable to watch fd %d: %m", __func__, con->name, fd);
+
+	/* connection is idle: drop outbound data on the floor */
+	if (con->out)
+		set_buf_offset(con->out, 0);
+	_close_con(true, con);
+}
+
+/* Remove fd from epoll set. mgr mutex must be locked. */
+static void _unwatch_fd(con_mgr_fd_t *con, int fd, bool *registered)
+{
+	if (!*registered)
+		return;
+
+	if (epoll_ctl(con->mgr->epoll_fd, EPOLL_CTL_DEL, fd, NULL))
+		log_flag(NET, "%s: [%s] unable to unwatch fd %d: %m",
+			 __func__, con->name, fd);
+
+	*registered = false;
+}
+
 /*
  * Event on a processing socket.
  * mgr must be locked.
  */
-static inline void _handle_poll_event(con_mgr_t *mgr, int fd, con_mgr_fd_t *con,
-				      short revents)
+static inline void _handle_event(con_mgr_t *mgr, con_mgr_fd_t *con,
+				 uint32_t events)
 {
-	if (fd == con->input_fd)
-		con->can_read = revents & POLLIN || revents & POLLHUP;
-	if (fd == con->output_fd)
-		con->can_write = revents & POLLOUT;
-
-	if (revents & POLLNVAL) {
-		error("%s: [%s] connection invalid", __func__, con->name);
-		goto close;
-	}
-	if (revents & POLLERR) {
+	/* read() will find out about any hang up */
+	if (events & (EPOLLIN | EPOLLHUP))
+		con->can_read = true;
+	if (events & EPOLLOUT)
+		con->can_write = true;
+
+	if (events & EPOLLERR) {
 		int err = SLURM_ERROR;
 
 		if (con->is_socket)
 			/* connection may have got RST */
-			fd_get_socket_error(con->input_fd, &err);
+			fd_get_socket_error(con->output_fd, &err);
 
 		error("%s: [%s] poll error: %s",
 		      __func__, con->name, slurm_strerror(err));
 
-		goto close;
+		con->can_read = false;
+		con->can_write = false;
+		/* nothing more can be written */
+		if (!con->has_work)
+			set_buf_offset(con->out, 0);
+		_close_con(true, con);
 	}
 
-	log_flag(NET, "%s: [%s] fd=%u can_read=%s can_write=%s",
-		 __func__, con->name, fd, (con->can_read ? "T" : "F"),
+	log_flag(NET, "%s: [%s] can_read=%s can_write=%s",
+		 __func__, con->name, (con->can_read ? "T" : "F"),
 		 (con->can_write ? "T" : "F"));
-	return;
-close:
-	con->can_read = false;
-	con->can_write = false;
-	_close_con(true, con);
+
+	_queue_inspect(con);
 }
 
 /*
@@ -1030,11 +1159,14 @@ static int _handle_connection(void *x, void *arg)
 			_add_con_work(true, con, _handle_write, con,
 				      "_handle_write");
 		} else {
-			/* must wait until poll allows write of this socket */
+			/* must wait until epoll allows write of this socket */
 			log_flag(NET, "%s: [%s] waiting to write %u bytes",
 				 __func__, con->name, get_buf_offset(con->out));
+			_watch_fd(con, con->output_fd, EPOLLOUT,
+				  ((con->input_fd == con->output_fd) ?
+				   &con->epoll_in : &con->epoll_out));
 		}
-		return SLURM_SUCCESS;
+		return 0;
 	}
 
 	/* read as much data as possible before processing */
@@ -1043,6 +1175,8 @@ static int _handle_connection(void *x, void *arg)
 		log_flag(NET, "%s: [%s] queuing read", __func__, con->name);
 		/* reset if data has already been tried if about to read data */
 		con->on_data_tried = false;
+		/* epoll must tell us when there is more */
+		con->can_read = false;
 		_add_con_work(true, con, _handle_read, con, "_handle_read");
 		return 0;
 	}
@@ -1058,8 +1192,20 @@ static int _handle_connection(void *x, void *arg)
 
 	if (!con->read_eof) {
 		xassert(con->input_fd != -1);
-		/* must wait until poll allows read from this socket */
+
+		if (con->is_listen &&
+		    (list_count(mgr->connections) >= mgr->max_connections)) {
+			log_flag(NET, "%s: [%s] deferring accepting new connections until count is below max: %u/%u",
+				 __func__, con->name,
+				 list_count(mgr->connections),
+				 mgr->max_connections);
+			mgr->listen_deferred = true;
+			return 0;
+		}
+
+		/* must wait until epoll allows read from this socket */
 		log_flag(NET, "%s: [%s] waiting to read", __func__, con->name);
+		_watch_fd(con, con->input_fd, EPOLLIN, &con->epoll_in);
 		return 0;
 	}
 
@@ -1088,6 +1234,16 @@ static int _handle_connection(void *x, void *arg)
 	log_flag(NET, "%s: [%s] closing connection input_fd=%d output_fd=%d",
 		 __func__, con->name, con->input_fd, con->output_fd);
 
+	/* input_fd was already closed or shutdown by _close_con() */
+	if (con->input_fd != -1)
+		_unwatch_fd(con, con->input_fd, &con->epoll_in);
+	if (con->output_fd != -1) {
+		if (con->output_fd == con->input_fd)
+			_unwatch_fd(con, con->output_fd, &con->epoll_in);
+		else
+			_unwatch_fd(con, con->output_fd, &con->epoll_out);
+	}
+
 	/* close any open file descriptors */
 	if (con->input_fd != -1) {
 		if (close(con->input_fd) == -1)
@@ -1111,12 +1267,6 @@ static int _handle_connection(void *x, void *arg)
 
 	log_flag(NET, "%s: [%s] closed connection", __func__, con->name);
 
-	/* have a thread free all the memory */
-	xassert(list_is_empty(con->work));
-	xassert(!con->has_work);
-	workq_add_work(mgr->workq, _connection_fd_delete, con,
-		       "_connection_fd_delete");
-
 	/* remove this connection */
 	return 1;
 }
@@ -1132,437 +1282,166 @@ static int _close_con_for_each(void *x, void *arg)
 	return 1;
 }
 
+/* NOTE: must hold mgr->mutex */
+static int _queue_inspect_for_each(void *x, void *arg)
+{
+	_queue_inspect(x);
+	return 1;
+}
+
 /*
- * Inspect all connection states and apply actions required
+ * Forget connection that has been closed and have a thread free it.
+ * NOTE: must hold mgr->mutex
  */
-static void _inspect_connections(void *x)
+static void _remove_connection(con_mgr_t *mgr, con_mgr_fd_t *con)
 {
-	con_mgr_t *mgr = x;
-	_check_magic_mgr(mgr);
+	List list = (con->is_listen ? mgr->listen : mgr->connections);
 
-	slurm_mutex_lock(&mgr->mutex);
-	list_delete_all(mgr->connections, _handle_connection, NULL);
-	mgr->inspecting = false;
-	slurm_cond_broadcast(&mgr->cond);
-	slurm_mutex_unlock(&mgr->mutex);
+	if (!list_remove_first(list, _find_by_ptr, con))
+		fatal_abort("%s: [%s] unknown connection", __func__, con->name);
+
+	/* have a thread free all the memory */
+	xassert(list_is_empty(con->work));
+	xassert(!con->has_work);
+	xassert(!con->inspect);
+	workq_add_work(mgr->workq, _connection_fd_delete, con,
+		       "_connection_fd_delete");
+
+	if (mgr->listen_deferred &&
+	    (list_count(mgr->connections) < mgr->max_connections)) {
+		log_flag(NET, "%s: resuming accepting new connections",
+			 __func__);
+		mgr->listen_deferred = false;
+		list_for_each(mgr->listen, _queue_inspect_for_each, NULL);
+	}
 }
 
 /*
  * Event on a listen only socket
  * mgr must be locked.
  */
-static inline void _handle_listen_event(con_mgr_t *mgr, int fd,
-					con_mgr_fd_t *con, short revents)
+static inline void _handle_listen_event(con_mgr_t *mgr, con_mgr_fd_t *con,
+					uint32_t events)
 {
-	if (revents & POLLHUP) {
+	if (events & EPOLLHUP) {
 		/* how can a listening socket hang up? */
 		error("%s: [%s] listen received POLLHUP", __func__, con->name);
-	} else if (revents & POLLNVAL) {
-		error("%s: [%s] listen connection invalid",
-		      __func__, con->name);
-	} else if (revents & POLLERR) {
+	} else if (events & EPOLLERR) {
 		int err = SLURM_ERROR;
 		fd_get_socket_error(con->input_fd, &err);
 		error("%s: [%s] listen poll error: %s",
 		      __func__, con->name, slurm_strerror(err));
-	} else if (revents & POLLIN) {
+	} else if (events & EPOLLIN) {
 		log_flag(NET, "%s: [%s] listen has incoming connection",
 			 __func__, con->name);
 		_add_con_work(true, con, _listen_accept, con, "_listen_accept");
 		return;
 	} else /* should never happen */
-		log_flag(NET, "%s: [%s] listen unexpected revents: 0x%04"PRIx16,
-			 __func__, con->name, revents);
+		log_flag(NET, "%s: [%s] listen unexpected events: 0x%04"PRIx32,
+			 __func__, con->name, events);
 
 	_close_con(true, con);
 }
 
-static void _handle_event_pipe(con_mgr_t *mgr, const struct pollfd *fds_ptr,
-			       const char *tag, const char *name)
-{
-	if (slurm_conf.debug_flags & DEBUG_FLAG_NET) {
-		char *flags = poll_revents_to_str(fds_ptr->revents);
-
-		log_flag(NET, "%s: [%s] signal pipe %s flags:%s",
-			 __func__, tag, name, flags);
-
-		/* _watch() will actually read the input */
-
-		xfree(flags);
-	}
-}
-
 /*
- * Handle poll and events
- *
- * NOTE: mgr mutex must not be locked but will be locked upon return
+ * Read out wake up bytes from pipe
+ * RET number of bytes read
  */
-static inline void _poll(con_mgr_t *mgr, poll_args_t *args, List fds,
-			 on_poll_event_t on_poll, const char *tag)
+static int _read_pipe(int fd, const char *name)
 {
-	int rc = SLURM_SUCCESS;
-	struct pollfd *fds_ptr = NULL;
-	con_mgr_fd_t *con;
-
-	rc = poll(args->fds, args->nfds, -1);
-	if (rc == -1)
-		fatal("%s: [%s] unable to poll listening sockets: %m",
-		      __func__, tag);
-
-	slurm_mutex_lock(&mgr->mutex);
-
-	if (rc == 0) {
-		log_flag(NET, "%s: [%s] poll timed out", __func__, tag);
-		return;
-	}
-
-	fds_ptr = args->fds;
-	for (int i = 0; i < args->nfds; i++, fds_ptr++) {
-		if (!fds_ptr->revents)
-			continue;
-
-		if (fds_ptr->fd == mgr->sigint_fd[0]) {
-			if (!mgr->shutdown)
-				info("%s: [%s] caught SIGINT. Shutting down.",
-				     __func__, tag);
-			mgr->shutdown = true;
-			_handle_event_pipe(mgr, fds_ptr, tag, "SIGINT");
-			_signal_change(mgr, true);
-		}
+	char buf[100];
+	int event_read = read(fd, buf, sizeof(buf));
+
+	if (event_read > 0) {
+		log_flag(NET, "%s: detected %u events from %s",
+			 __func__, event_read, name);
+	} else if (event_read == 0)
+		log_flag(NET, "%s: nothing to read from %s", __func__, name);
+	else if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+		log_flag(NET, "%s: try again on read of %s: %m",
+			 __func__, name);
+	else
+		fatal("%s: unable to read from %s: %m", __func__, name);
 
-		if (fds_ptr->fd == mgr->event_fd[0])
-			_handle_event_pipe(mgr, fds_ptr, tag, "CHANGE_EVENT");
-		else if ((con = list_find_first(fds, _find_by_fd,
-						&fds_ptr->fd))) {
-			if (slurm_conf.debug_flags & DEBUG_FLAG_NET) {
-				char *flags = poll_revents_to_str(
-					fds_ptr->revents);
-				log_flag(NET, "%s: [%s->%s] poll event detect flags:%s",
-					 __func__, tag, con->name, flags);
-				xfree(flags);
-			}
-			on_poll(mgr, fds_ptr->fd, con, fds_ptr->revents);
-			/*
-			 * signal that something might have happened and to
-			 * restart listening
-			 * */
-			_signal_change(mgr, true);
-		} else
-			/* FD probably got closed between poll start and now */
-			log_flag(NET, "%s: [%s] unable to find connection for fd=%u",
-				 __func__, tag, fds_ptr->fd);
-	}
+	return event_read;
 }
 
 /*
- * Poll all processing connections sockets and
- * signal_fd and event_fd.
+ * Watch all connections and listeners with epoll. Only connections that had
+ * an event or finished their work get inspected, instead of walking every
+ * connection for every event.
  */
-static void _poll_connections(void *x)
+static inline int _watch(con_mgr_t *mgr)
 {
-	poll_args_t *args = x;
-	con_mgr_t *mgr = args->mgr;
-	struct pollfd *fds_ptr = NULL;
+	struct epoll_event events[MAX_EPOLL_EVENTS];
 	con_mgr_fd_t *con;
-	int count;
-	ListIterator itr;
+	bool closing = false;
+	int nfds;
 
 	_check_magic_mgr(mgr);
-
-	slurm_mutex_lock(&mgr->mutex);
-
-	/* grab counts once */
-	count = list_count(mgr->connections);
-
-	slurm_mutex_unlock(&mgr->mutex);
-
-	xrecalloc(args->fds, ((count * 2) + 2), sizeof(*args->fds));
-	fds_ptr = args->fds;
-	args->nfds = 0;
-
 	slurm_mutex_lock(&mgr->mutex);
 
-	if (count < list_count(mgr->connections)) {
-		/*
-		 * something changed while calling recalloc.
-		 * this is a poor man's RCU lock.
-		 */
-		log_flag(NET, "%s: connection count increased while allocating fds",
-			 __func__);
-		goto cleanup;
-	}
-
-	/* Add signal fd */
-	fds_ptr->fd = mgr->sigint_fd[0];
-	fds_ptr->events = POLLIN;
-	fds_ptr++;
-	args->nfds++;
-
-	/* Add event fd */
-	fds_ptr->fd = mgr->event_fd[0];
-	fds_ptr->events = POLLIN;
-	fds_ptr++;
-	args->nfds++;
-
-	/*
-	 * populate sockets with !has_work
-	 */
-	itr = list_iterator_create(mgr->connections);
-	while ((con = list_next(itr))) {
-		_check_magic_fd(con);
-
-		if (con->has_work || con->output_fd == -1 ||
-		    con->input_fd == -1)
-			continue;
-
-		log_flag(NET, "%s: [%s] poll read_eof=%s input=%u output=%u",
-			 __func__, con->name, (con->read_eof ? "T" : "F"),
-			 get_buf_offset(con->in), get_buf_offset(con->out));
-
-		if (con->input_fd == con->output_fd) {
-			/* if fd is same, only poll it */
-			fds_ptr->fd = con->input_fd;
-
-			fds_ptr->events = POLLIN;
-			if (get_buf_offset(con->out))
-				fds_ptr->events |= POLLOUT;
-
-			fds_ptr++;
-			args->nfds++;
-		} else {
-			/*
-			 * Account for fd being different
-			 * for input and output.
-			 */
-			if (con->input_fd != -1) {
-				fds_ptr->fd = con->input_fd;
-				fds_ptr->events = POLLIN;
-				fds_ptr++;
-				args->nfds++;
-			}
-
-			if (get_buf_offset(con->out)) {
-				fds_ptr->fd = con->output_fd;
-				fds_ptr->events = POLLOUT;
-				fds_ptr++;
-				args->nfds++;
-			}
+	while (true) {
+		if (mgr->shutdown && !closing) {
+			list_for_each(mgr->connections, _close_con_for_each,
+				      NULL);
+			list_for_each(mgr->listen, _close_con_for_each, NULL);
+			closing = true;
 		}
-	}
-	list_iterator_destroy(itr);
-
-	xassert(args->nfds >= 2);
-	xassert(args->nfds <= ((count * 2) + 2));
-	slurm_mutex_unlock(&mgr->mutex);
-
-	log_flag(NET, "%s: polling %u file descriptors for %u connections",
-		 __func__, args->nfds, count);
 
-	_poll(mgr, args, mgr->connections, &_handle_poll_event, __func__);
-cleanup:
-	mgr->poll_active = false;
-	/* notify _watch it can run but don't send signal to event PIPE*/
-	slurm_cond_broadcast(&mgr->cond);
-	slurm_mutex_unlock(&mgr->mutex);
+		while ((con = list_pop(mgr->inspect))) {
+			_check_magic_fd(con);
+			con->inspect = false;
 
-	log_flag(NET, "%s: poll done", __func__);
-}
-
-/*
- * Poll all listening sockets
- */
-static void _listen(void *x)
-{
-	poll_args_t *args = x;
-	con_mgr_t *mgr = args->mgr;
-	struct pollfd *fds_ptr = NULL;
-	con_mgr_fd_t *con;
-	int count;
-	ListIterator itr;
-
-	_check_magic_mgr(mgr);
-
-	slurm_mutex_lock(&mgr->mutex);
-	xassert(mgr->listen_active);
-
-	/* grab counts once */
-	count = list_count(mgr->listen);
-
-	log_flag(NET, "%s: listeners=%u", __func__, count);
-
-	if (count == 0) {
-		/* nothing to do here */
-		log_flag(NET, "%s: no listeners found", __func__);
-		goto cleanup;
-	}
-
-	xrecalloc(args->fds, (count + 2), sizeof(*args->fds));
-	fds_ptr = args->fds;
-	args->nfds = 0;
-
-	/* Add signal fd */
-	fds_ptr->fd = mgr->sigint_fd[0];
-	fds_ptr->events = POLLIN;
-	fds_ptr++;
-	args->nfds++;
-
-	/* Add event fd */
-	fds_ptr->fd = mgr->event_fd[0];
-	fds_ptr->events = POLLIN;
-	fds_ptr++;
-	args->nfds++;
-
-	/* populate listening sockets */
-	itr = list_iterator_create(mgr->listen);
-	while ((con = list_next(itr))) {
-		_check_magic_fd(con);
-
-		/* already accept queued or listener already closed */
-		if (con->has_work || con->read_eof)
-			continue;
-
-		fds_ptr->fd = con->input_fd;
-		fds_ptr->events = POLLIN;
-
-		log_flag(NET, "%s: [%s] listening", __func__, con->name);
-
-		fds_ptr++;
-		args->nfds++;
-	}
-	list_iterator_destroy(itr);
-
-	if (args->nfds == 2) {
-		log_flag(NET, "%s: deferring listen due to all sockets are queued to call accept or closed",
-			 __func__);
-		goto cleanup;
-	}
-
-	xassert(args->nfds <= ((count * 2) + 2));
-	xassert(args->nfds);
-	slurm_mutex_unlock(&mgr->mutex);
-
-	log_flag(NET, "%s: polling %u/%u file descriptors",
-		 __func__, args->nfds, (count + 2));
-
-	_poll(mgr, args, mgr->listen, &_handle_listen_event, __func__);
-cleanup:
-	mgr->listen_active = false;
-	_signal_change(mgr, true);
-	slurm_mutex_unlock(&mgr->mutex);
-}
+			if (_handle_connection(con, NULL))
+				_remove_connection(mgr, con);
+		}
 
-/*
- * Poll all sockets non-listen connections
- */
-static inline int _watch(con_mgr_t *mgr)
-{
-	poll_args_t *listen_args = NULL;
-	poll_args_t *poll_args = NULL;
-	int count, event_read;
-	char buf[100]; /* buffer for event_read */
-	bool work; /* is there any work to do? */
+		log_flag(NET, "%s: connections=%u listen=%u",
+			 __func__, list_count(mgr->connections),
+			 list_count(mgr->listen));
 
-watch:
-	_check_magic_mgr(mgr);
-	slurm_mutex_lock(&mgr->mutex);
+		if (list_is_empty(mgr->connections) &&
+		    list_is_empty(mgr->listen))
+			/* nothing to do! */
+			break;
 
-	if (mgr->shutdown) {
 		slurm_mutex_unlock(&mgr->mutex);
-		_close_all_connections(mgr);
+		nfds = epoll_wait(mgr->epoll_fd, events, MAX_EPOLL_EVENTS, -1);
 		slurm_mutex_lock(&mgr->mutex);
-	}
-
-	/* grab counts once */
-	count = list_count(mgr->connections);
-
-	log_flag(NET, "%s: starting connections=%u listen=%u",
-		 __func__, count, list_count(mgr->listen));
-
-	if (!mgr->poll_active && !mgr->listen_active) {
-		/* only clear event pipe once both polls are done */
-		event_read = read(mgr->event_fd[0], buf, sizeof(buf));
-		if (event_read > 0) {
-			log_flag(NET, "%s: detected %u events from event fd",
-				 __func__, event_read);
-		} else if (event_read == 0)
-			log_flag(NET, "%s: nothing to read from event fd", __func__);
-		else if (errno == EAGAIN || errno == EWOULDBLOCK ||
-			 errno == EINTR)
-			log_flag(NET, "%s: try again on read of event fd: %m",
-				 __func__);
-		else
-			fatal("%s: unable to read from event fd: %m", __func__);
-	}
-
-	work = false;
 
-	/* start listen thread if needed */
-	if (!list_is_empty(mgr->listen)) {
-		if (!listen_args) {
-			listen_args = xmalloc(sizeof(*listen_args));
-			listen_args->mgr = mgr;
+		if (nfds == -1) {
+			if (errno == EINTR)
+				continue;
+			fatal("%s: unable to wait on connections: %m",
+			      __func__);
 		}
 
-		/* run any queued work */
-		list_delete_all(mgr->listen, _handle_connection, NULL);
-
-		if (!mgr->listen_active) {
-			/* only try to listen if number connections is below limit */
-			if (count >= MAX_OPEN_CONNECTIONS)
-				log_flag(NET, "%s: deferring accepting new connections until count is below max: %u/%u",
-					 __func__, count, MAX_OPEN_CONNECTIONS);
-			else { /* request a listen thread to run */
-				log_flag(NET, "%s: queuing up listen", __func__);
-				mgr->listen_active = true;
-				workq_add_work(mgr->workq, _listen, listen_args,
-					       "_listen");
+		for (int i = 0; i < nfds; i++) {
+			void *ptr = events[i].data.ptr;
+
+			if (ptr == &mgr->sigint_fd[0]) {
+				_read_pipe(mgr->sigint_fd[0], "SIGINT fd");
+				if (!mgr->shutdown)
+					info("%s: caught SIGINT. Shutting down.",
+					     __func__);
+				mgr->shutdown = true;
+			} else if (ptr == &mgr->event_fd[0]) {
+				mgr->event_signaled = false;
+				_read_pipe(mgr->event_fd[0], "event fd");
+			} else if (((con_mgr_fd_t *) ptr)->is_listen) {
+				_handle_listen_event(mgr, ptr,
+						     events[i].events);
+			} else {
+				_handle_event(mgr, ptr, events[i].events);
 			}
-		} else
-			log_flag(NET, "%s: listeners active already", __func__);
-
-		work = true;
-	}
-
-	/* start poll thread if needed */
-	if (count) {
-		if (!poll_args) {
-			poll_args = xmalloc(sizeof(*poll_args));
-			poll_args->mgr = mgr;
-		}
-
-		if (!mgr->inspecting) {
-			mgr->inspecting = true;
-			workq_add_work(mgr->workq, _inspect_connections, mgr,
-				       "_inspect_connections");
 		}
-
-		if (!mgr->poll_active) {
-			/* request a listen thread to run */
-			log_flag(NET, "%s: queuing up poll", __func__);
-			mgr->poll_active = true;
-			workq_add_work(mgr->workq, _poll_connections, poll_args,
-				       "_poll_connections");
-		} else
-			log_flag(NET, "%s: poll active already", __func__);
-
-		work = true;
 	}
 
-	if (!work)
-		/* nothing to do! */
-		goto cleanup;
-
-	/* wait until something happens */
-	slurm_cond_wait(&mgr->cond, &mgr->mutex);
-	slurm_mutex_unlock(&mgr->mutex);
-
-	goto watch;
-
-cleanup:
-	_signal_change(mgr, true);
+	mgr->shutdown = true;
+	slurm_cond_broadcast(&mgr->cond);
 	slurm_mutex_unlock(&mgr->mutex);
 
-	mgr->shutdown = true;
 	log_flag(NET, "%s: cleaning up", __func__);
 
 	log_flag(NET, "%s: begin waiting for all workers", __func__);
@@ -1570,16 +1449,6 @@ cleanup:
 	quiesce_workq(mgr->workq);
 	log_flag(NET, "%s: end waiting for all workers", __func__);
 
-	if (poll_args) {
-		xfree(poll_args->fds);
-		xfree(poll_args);
-	}
-
-	if (listen_args) {
-		xfree(listen_args->fds);
-		xfree(listen_args);
-	}
-
 	return SLURM_SUCCESS;
 }
 
@@ -1594,8 +1463,10 @@ extern int con_mgr_run(con_mgr_t *mgr)
 	//TODO: allow for multiple conmgrs to run at once
 	xassert(sigint_fd[0] == -1);
 	xassert(sigint_fd[1] == -1);
+	xassert(!running_mgr);
 	sigint_fd[0] = mgr->sigint_fd[0];
 	sigint_fd[1] = mgr->sigint_fd[1];
+	running_mgr = mgr;
 	slurm_mutex_unlock(&sigint_mutex);
 
 	/*
@@ -1613,6 +1484,7 @@ extern int con_mgr_run(con_mgr_t *mgr)
 	slurm_mutex_lock(&sigint_mutex);
 	sigint_fd[0] = -1;
 	sigint_fd[1] = -1;
+	running_mgr = NULL;
 	slurm_mutex_unlock(&sigint_mutex);
 
 	return rc;
@@ -1689,6 +1561,21 @@ static void _listen_accept(void *x)
 extern int con_mgr_queue_write_fd(con_mgr_fd_t *con, const void *buffer,
 				  const size_t bytes)
 {
+	/*
+	 * Make the writer wait on a slow client instead of queuing without
+	 * bound
+	 */
+	if (get_buf_offset(con->out) &&
+	    ((get_buf_offset(con->out) + bytes) > MAX_OUT_QUEUE)) {
+		int rc;
+
+		log_flag(NET, "%s: [%s] waiting on %u queued bytes to be written",
+			 __func__, con->name, get_buf_offset(con->out));
+
+		if ((rc = con_mgr_flush_write_fd(con)))
+			return rc;
+	}
+
 	/* Grow buffer as needed to handle the outgoing data */
 	if (remaining_buf(con->out) < bytes) {
 		int need = bytes - remaining_buf(con->out);
@@ -1713,6 +1600,44 @@ extern int con_mgr_queue_write_fd(con_mgr_fd_t *con, const void *buffer,
 	return SLURM_SUCCESS;
 }
 
+extern int con_mgr_flush_write_fd(con_mgr_fd_t *con)
+{
+	int rc = SLURM_SUCCESS;
+	int timeout = slurm_conf.msg_timeout * 1000;
+
+	_check_magic_fd(con);
+
+	while (!rc && get_buf_offset(con->out)) {
+		struct pollfd pfd = {
+			.fd = con->output_fd,
+			.events = POLLOUT,
+		};
+		int prc;
+
+		if (con->output_fd == -1)
+			return SLURM_COMMUNICATIONS_SEND_ERROR;
+
+		if ((prc = poll(&pfd, 1, timeout)) == -1) {
+			if (errno == EINTR)
+				continue;
+			error("%s: [%s] poll failed: %m", __func__, con->name);
+			rc = SLURM_COMMUNICATIONS_SEND_ERROR;
+		} else if (!prc) {
+			error("%s: [%s] timed out writing %u bytes",
+			      __func__, con->name, get_buf_offset(con->out));
+			rc = SLURM_COMMUNICATIONS_SEND_ERROR;
+		} else if (pfd.revents & (POLLERR | POLLNVAL)) {
+			error("%s: [%s] connection error while writing",
+			      __func__, con->name);
+			rc = SLURM_COMMUNICATIONS_SEND_ERROR;
+		} else {
+			rc = _write_fd(con);
+		}
+	}
+
+	return rc;
+}
+
 typedef struct {
 	con_mgr_events_t events;
 	con_mgr_t *mgr;
@@ -1844,3 +1769,63 @@ extern int con_mgr_create_sockets(con_mgr_t *mgr, List hostports,
 
 	return rc;
 }
+
+extern void con_mgr_add_request_time(con_mgr_fd_t *con, uint64_t usec)
+{
+	con_mgr_t *mgr = con->mgr;
+	uint64_t bound = 1000;
+	int i;
+
+	for (i = 0; (i < (CON_MGR_LATENCY_BUCKETS - 1)) && (usec >= bound); i++)
+		bound *= 10;
+
+	slurm_mutex_lock(&mgr->mutex);
+	mgr->requests++;
+	mgr->request_time_sum += usec;
+	mgr->request_time_max = MAX(mgr->request_time_max, usec);
+	mgr->request_latency[i]++;
+	slurm_mutex_unlock(&mgr->mutex);
+}
+
+static int _sum_con_work(void *x, void *arg)
+{
+	con_mgr_fd_t *con = x;
+	uint32_t *count = arg;
+
+	*count += list_count(con->work);
+	return 1;
+}
+
+extern int con_mgr_get_stats(con_mgr_stats_t *stats)
+{
+	con_mgr_t *mgr;
+
+	memset(stats, 0, sizeof(*stats));
+
+	slurm_mutex_lock(&sigint_mutex);
+	if (!(mgr = running_mgr)) {
+		slurm_mutex_unlock(&sigint_mutex);
+		return SLURM_ERROR;
+	}
+
+	slurm_mutex_lock(&mgr->mutex);
+	stats->connections = list_count(mgr->connections);
+	stats->connections_total = mgr->connections_total;
+	stats->listeners = list_count(mgr->listen);
+	stats->max_connections = mgr->max_connections;
+	stats->inspect_queued = list_count(mgr->inspect);
+	list_for_each(mgr->connections, _sum_con_work,
+		      &stats->con_work_queued);
+	stats->requests = mgr->requests;
+	stats->request_time_sum = mgr->request_time_sum;
+	stats->request_time_max = mgr->request_time_max;
+	memcpy(stats->request_latency, mgr->request_latency,
+	       sizeof(stats->request_latency));
+	slurm_mutex_unlock(&mgr->mutex);
+
+	stats->work_active = workq_get_active(mgr->workq);
+	stats->work_queued = workq_get_queued(mgr->workq);
+	slurm_mutex_unlock(&sigint_mutex);
+
+	return SLURM_SUCCESS;
+}
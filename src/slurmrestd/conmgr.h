@@ -55,6 +55,12 @@
 typedef struct con_mgr_fd_s con_mgr_fd_t;
 typedef struct con_mgr_s con_mgr_t;
 
+/*
+ * Request latency histogram buckets:
+ *	<1ms, <10ms, <100ms, <1s, <10s, >=10s
+ */
+#define CON_MGR_LATENCY_BUCKETS 6
+
 /*
  * Call back for new connection for setup
  *
@@ -120,10 +126,16 @@ struct con_mgr_fd_s {
 	char *unix_socket;
 	/* this is a listen only socket */
 	bool is_listen;
-	/* poll has indicated write is possible */
+	/* write is possible without blocking */
 	bool can_write;
-	/* poll has indicated read is possible */
+	/* epoll has indicated read is possible */
 	bool can_read;
+	/* input_fd is in mgr->epoll_fd */
+	bool epoll_in;
+	/* output_fd is in mgr->epoll_fd (when different than input_fd) */
+	bool epoll_out;
+	/* connection is queued in mgr->inspect */
+	bool inspect;
 	/* has this connection received read EOF */
 	bool read_eof;
 	/* has this connection called on_connection */
@@ -170,25 +182,35 @@ struct con_mgr_s {
 	 * */
 	List listen;
 	/*
-	 * True if there is a thread for listen queued or running
-	 */
-	bool listen_active;
-	/*
-	 * True if there is a thread for poll queued or running
+	 * connections that need their state inspected after an event or
+	 * after their work completed
+	 * type: con_mgr_fd_t
 	 */
-	bool poll_active;
+	List inspect;
 	/*
 	 * Is trying to shutdown?
 	 */
 	bool shutdown;
 	/* thread pool */
 	workq_t *workq;
-	/* will inspect connections (not listeners */
-	bool inspecting;
-	/* Event PIPE used to break out of poll */
+	/* epoll set of all connections waiting on IO */
+	int epoll_fd;
+	/* Event PIPE used to break out of epoll_wait() */
 	int event_fd[2];
+	/* change already signaled on event_fd */
+	bool event_signaled;
 	/* Signal PIPE to catch SIGINT */
 	int sigint_fd[2];
+	/* maximum number of connections before accept() is deferred */
+	int max_connections;
+	/* listeners are not being watched due to max_connections */
+	bool listen_deferred;
+	/* statistics (see con_mgr_get_stats()) */
+	uint64_t connections_total;
+	uint64_t requests;
+	uint64_t request_time_sum;
+	uint64_t request_time_max;
+	uint64_t request_latency[CON_MGR_LATENCY_BUCKETS];
 
 	pthread_mutex_t mutex;
 	/* called after events or changes to wake up _watch */
@@ -249,6 +271,7 @@ extern int con_mgr_process_fd_unix_listen(con_mgr_t *mgr, int fd,
 
 /*
  * Write binary data to connection (from callback).
+ * Once too much is queued, blocks until the client has caught up.
  * NOTE: only call from within a callback
  * IN con connection manager connection struct
  * IN buffer pointer to buffer
@@ -258,6 +281,46 @@ extern int con_mgr_process_fd_unix_listen(con_mgr_t *mgr, int fd,
 extern int con_mgr_queue_write_fd(con_mgr_fd_t *con, const void *buffer,
 				  const size_t bytes);
 
+/*
+ * Write out everything queued for connection now instead of waiting for the
+ * callback to return. Blocks until all of it was written, the connection
+ * failed or MessageTimeout passed.
+ * NOTE: only call from within a callback
+ * IN con connection manager connection struct
+ * RET SLURM_SUCCESS or error
+ */
+extern int con_mgr_flush_write_fd(con_mgr_fd_t *con);
+
+/*
+ * Record how long a request on connection took to process
+ * IN con connection of request
+ * IN usec microseconds to process request
+ */
+extern void con_mgr_add_request_time(con_mgr_fd_t *con, uint64_t usec);
+
+typedef struct {
+	uint32_t connections; /* open connections */
+	uint64_t connections_total; /* connections accepted since start */
+	uint32_t listeners; /* sockets listening for new connections */
+	uint32_t max_connections; /* connections before accept() waits */
+	uint32_t work_active; /* threads running work */
+	uint32_t work_queued; /* work waiting on a thread */
+	uint32_t con_work_queued; /* work waiting on its connection */
+	uint32_t inspect_queued; /* connections waiting to be inspected */
+	uint64_t requests; /* requests processed */
+	uint64_t request_time_sum; /* usec spent processing requests */
+	uint64_t request_time_max; /* usec of slowest request */
+	/* request counts by latency: <1ms, <10ms, ... >=10s */
+	uint64_t request_latency[CON_MGR_LATENCY_BUCKETS];
+} con_mgr_stats_t;
+
+/*
+ * Get statistics of the running connection manager
+ * OUT stats populated with current statistics
+ * RET SLURM_SUCCESS or error if no connection manager is running
+ */
+extern int con_mgr_get_stats(con_mgr_stats_t *stats);
+
 /*
  * create sockets based on requested SOCKET_LISTEN
  * IN  mgr assigned connection manager
@@ -57,6 +57,9 @@
 
 #define CRLF "\r\n"
 #define MAGIC 0xDFAFFEEF
+#define MAGIC_STREAM 0xDFA1FE42
+/* bodies larger than this are sent in chunks of this size */
+#define HTTP_STREAM_CHUNK_BYTES (64 * 1024)
 
 /* return magic number 2 to close the connection */
 #define HTTP_PARSER_RETURN_ERROR 1
@@ -407,12 +410,11 @@ static int _write_fmt_num_header(con_mgr_fd_t *con, const char *name,
 	return rc;
 }
 
-extern int send_http_response(const send_http_response_args_t *args)
+/* Write status line and any requested headers */
+static int _write_response_head(const send_http_response_args_t *args)
 {
 	char *buffer = NULL;
 	int rc = SLURM_SUCCESS;
-	xassert(args->status_code != HTTP_STATUS_NONE);
-	xassert(args->body_length == 0 || (args->body_length && args->body));
 
 	/* send rfc2616 response */
 	xstrfmtcat(buffer, "HTTP/%d.%d %d %s"CRLF,
@@ -435,11 +437,20 @@ extern int send_http_response(const send_http_response_args_t *args)
 				break;
 		}
 		list_iterator_destroy(itr);
-
-		if (rc)
-			return rc;
 	}
 
+	return rc;
+}
+
+extern int send_http_response(const send_http_response_args_t *args)
+{
+	int rc = SLURM_SUCCESS;
+	xassert(args->status_code != HTTP_STATUS_NONE);
+	xassert(args->body_length == 0 || (args->body_length && args->body));
+
+	if ((rc = _write_response_head(args)))
+		return rc;
+
 	if (args->body && args->body_length) {
 		if ((rc = _write_fmt_num_header(args->con, "Content-Length",
 						args->body_length)))
@@ -461,11 +472,156 @@ extern int send_http_response(const send_http_response_args_t *args)
 		if ((rc = con_mgr_queue_write_fd(args->con, args->body,
 						 args->body_length)))
 			return rc;
+	} else {
+		/* 1xx, 204 and 304 responses never have a body */
+		if ((args->status_code >= 200) &&
+		    (args->status_code != HTTP_STATUS_CODE_SUCCESS_NO_CONTENT) &&
+		    (args->status_code !=
+		     HTTP_STATUS_CODE_REDIRECT_NOT_MODIFIED) &&
+		    (rc = _write_fmt_num_header(args->con, "Content-Length",
+						0)))
+			return rc;
+
+		/* end of headers */
+		rc = con_mgr_queue_write_fd(args->con, CRLF, strlen(CRLF));
 	}
 
 	return rc;
 }
 
+struct http_stream {
+	int magic;
+	send_http_response_args_t args;
+	bool can_chunk; /* client understands chunked transfer encoding */
+	bool chunked; /* headers sent and body is being sent in chunks */
+	int rc;
+	char *buf;
+	size_t len;
+	size_t size;
+};
+
+extern http_stream_t *http_stream_start(const send_http_response_args_t *args)
+{
+	http_stream_t *stream = xmalloc(sizeof(*stream));
+
+	xassert(args->status_code != HTTP_STATUS_NONE);
+
+	stream->magic = MAGIC_STREAM;
+	stream->args = *args;
+	stream->args.body = NULL;
+	stream->args.body_length = 0;
+	/* chunked transfer encoding was added in HTTP/1.1 */
+	stream->can_chunk = (args->http_major > 1) ||
+			    ((args->http_major == 1) && (args->http_minor >= 1));
+	stream->size = HTTP_STREAM_CHUNK_BYTES;
+	/* extra byte to always be able to terminate the body */
+	stream->buf = xmalloc(stream->size + 1);
+
+	return stream;
+}
+
+/* Send the buffered body as the next chunk and wait for it to go out */
+static int _send_chunk(http_stream_t *stream)
+{
+	con_mgr_fd_t *con = stream->args.con;
+	char size[32];
+	int rc;
+
+	if (!stream->chunked) {
+		if ((rc = _write_response_head(&stream->args)))
+			return rc;
+		if ((rc = _write_fmt_header(con, "Transfer-Encoding",
+					    "chunked")))
+			return rc;
+		if (stream->args.body_encoding &&
+		    (rc = _write_fmt_header(con, "Content-Type",
+					    stream->args.body_encoding)))
+			return rc;
+		if ((rc = con_mgr_queue_write_fd(con, CRLF, strlen(CRLF))))
+			return rc;
+
+		stream->chunked = true;
+	}
+
+	snprintf(size, sizeof(size), "%zx"CRLF, stream->len);
+
+	if ((rc = con_mgr_queue_write_fd(con, size, strlen(size))) ||
+	    (rc = con_mgr_queue_write_fd(con, stream->buf, stream->len)) ||
+	    (rc = con_mgr_queue_write_fd(con, CRLF, strlen(CRLF))))
+		return rc;
+
+	debug5("%s: [%s] sending %zu byte chunk",
+	       __func__, con->name, stream->len);
+
+	stream->len = 0;
+
+	return con_mgr_flush_write_fd(con);
+}
+
+extern int http_stream_write(void *arg, const char *buf, size_t len)
+{
+	http_stream_t *stream = arg;
+
+	xassert(stream->magic == MAGIC_STREAM);
+
+	while (!stream->rc && len) {
+		size_t bytes;
+
+		if (stream->len == stream->size) {
+			if (stream->can_chunk) {
+				stream->rc = _send_chunk(stream);
+				continue;
+			}
+
+			/* HTTP/1.0 needs the whole body for Content-Length */
+			stream->size *= 2;
+			xrealloc(stream->buf, stream->size + 1);
+		}
+
+		bytes = MIN(len, (stream->size - stream->len));
+		memcpy(stream->buf + stream->len, buf, bytes);
+		stream->len += bytes;
+		buf += bytes;
+		len -= bytes;
+	}
+
+	return stream->rc;
+}
+
+extern int http_stream_fini(http_stream_t *stream, int rc)
+{
+	xassert(stream->magic == MAGIC_STREAM);
+
+	if (!rc)
+		rc = stream->rc;
+
+	if (rc) {
+		debug("%s: [%s] abandoning response: %s",
+		      __func__, stream->args.con->name, slurm_strerror(rc));
+	} else if (stream->chunked) {
+		static const char last_chunk[] = "0"CRLF CRLF;
+
+		if (stream->len)
+			rc = _send_chunk(stream);
+		if (!rc)
+			rc = con_mgr_queue_write_fd(stream->args.con,
+						    last_chunk,
+						    strlen(last_chunk));
+	} else {
+		/* body fit in one chunk: send as a normal response */
+		stream->buf[stream->len] = '\0';
+		stream->args.body = stream->buf;
+		stream->args.body_length = stream->len;
+		rc = send_http_response(&stream->args);
+	}
+
+	stream->magic = ~MAGIC_STREAM;
+	xfree(stream->buf);
+	xfree(stream);
+
+	return rc;
+}
+
 static int _send_reject(const http_parser *parser,
 			http_status_code_t status_code)
 {
@@ -217,6 +217,37 @@ typedef struct {
  */
 extern int send_http_response(const send_http_response_args_t *args);
 
+typedef struct http_stream http_stream_t;
+
+/*
+ * Start HTTP response with a body given in pieces to http_stream_write().
+ * Bodies that fit in one chunk are sent with Content-Length just like
+ * send_http_response(). Larger bodies are sent to HTTP/1.1 clients using
+ * chunked transfer encoding, writing each chunk out to the client before
+ * filling the next one so the memory held per response stays bounded.
+ * IN args arguments of response (body and body_length are ignored)
+ * RET stream (must call http_stream_fini())
+ */
+extern http_stream_t *http_stream_start(const send_http_response_args_t *args);
+
+/*
+ * Add to body of response
+ * IN arg stream from http_stream_start()
+ * IN buf body bytes to add
+ * IN len number of bytes in buf
+ * RET SLURM_SUCCESS or error
+ */
+extern int http_stream_write(void *arg, const char *buf, size_t len);
+
+/*
+ * Finish sending response and free stream
+ * IN stream stream to finish
+ * IN rc SLURM_SUCCESS if body is complete or error to abandon response
+ * RET SLURM_SUCCESS or error (response was not completely sent and the
+ *	connection must be closed)
+ */
+extern int http_stream_fini(http_stream_t *stream, int rc);
+
 typedef struct {
 	const char *host;
 	const char *port; /* port as string for later parsing */
@@ -174,6 +174,9 @@ extern data_t *parse_url_query(const char *query, bool convert_types)
 		case '+': /* rfc1866 only */
 			xstrcatchar(buffer, ' ');
 			break;
+		case ',': /* rfc3986 sub-delim used for lists of values */
+			xstrcatchar(buffer, *ptr);
+			break;
 		case ';': /* rfc1866 requests ';' treated like '&' */
 		case '&': /* rfc1866 only */
 			rc = _handle_new_key_char(d, &key, &buffer,
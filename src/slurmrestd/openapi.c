@@ -47,6 +47,7 @@
 #include "src/common/ref.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
+#include "src/common/xhash.h"
 #include "src/common/xstring.h"
 
 #include "src/slurmrestd/http.h"
@@ -60,7 +61,6 @@ decl_static_data(openapi_json);
 #define MAGIC_PATH 0x1111beef
 
 static pthread_rwlock_t paths_lock = PTHREAD_RWLOCK_INITIALIZER;
-static List paths = NULL;
 static int path_tag_counter = 0;
 static data_t **spec = NULL;
 
@@ -176,15 +176,24 @@ typedef struct {
 	parameter_type_t parameter;
 } entry_t;
 
-typedef struct {
-	entry_t *entries;
-	http_request_method_t method;
-} entry_method_t;
+/*
+ * Registered paths are compiled into a trie of path entries. Children
+ * matching a string are hashed by the string while children matching a
+ * parameter are tried in the order they were added, so finding the tag of a
+ * path only depends on the depth of the path and not on how many paths are
+ * registered.
+ */
+typedef struct path_node_s {
+	int magic;
+	char *entry; /* string to match or parameter name */
+	entry_type_t type;
+	parameter_type_t parameter;
+	int tag; /* tag of path ending at this node or -1 */
+	xhash_t *strings; /* children matching a string */
+	List params; /* children matching a parameter */
+} path_node_t;
 
-typedef struct {
-	entry_method_t *methods;
-	int tag;
-} path_t;
+static path_node_t *paths = NULL; /* root of trie */
 
 static entry_t *_parse_openapi_path(const char *str_path)
 {
@@ -416,13 +425,104 @@ static const data_t *_find_spec_path(const char *str_path)
 	return args.found;
 }
 
+static void _free_path_node(void *x)
+{
+	path_node_t *node = x;
+
+	if (!node)
+		return;
+
+	xassert(node->magic == MAGIC_PATH);
+
+	debug5("%s: remove path entry:%s type:%s tag:%d",
+	       __func__, node->entry, _get_entry_type_string(node->type),
+	       node->tag);
+
+	xhash_free(node->strings);
+	FREE_NULL_LIST(node->params);
+	node->magic = ~MAGIC_PATH;
+	xfree(node->entry);
+	xfree(node);
+}
+
+static void _path_node_id(void *item, const char **key, uint32_t *key_len)
+{
+	path_node_t *node = item;
+
+	xassert(node->magic == MAGIC_PATH);
+
+	*key = node->entry;
+	*key_len = strlen(node->entry);
+}
+
+static path_node_t *_new_path_node(const entry_t *entry)
+{
+	path_node_t *node = xmalloc(sizeof(*node));
+
+	node->magic = MAGIC_PATH;
+	node->tag = -1;
+
+	if (entry) {
+		node->entry = xstrdup((entry->type ==
+				       OPENAPI_PATH_ENTRY_MATCH_PARAMETER) ?
+				      entry->name : entry->entry);
+		node->type = entry->type;
+		node->parameter = entry->parameter;
+	}
+
+	return node;
+}
+
+static int _find_param_node(void *x, void *key)
+{
+	path_node_t *node = x;
+	entry_t *entry = key;
+
+	return ((node->parameter == entry->parameter) &&
+		!xstrcmp(node->entry, entry->name));
+}
+
+/* Add path entries to trie and return node where they end */
+static path_node_t *_add_path_entries(entry_t *entries)
+{
+	path_node_t *node = paths;
+
+	for (entry_t *entry = entries; entry->type; entry++) {
+		path_node_t *child;
+
+		if (entry->type == OPENAPI_PATH_ENTRY_MATCH_STRING) {
+			if (!node->strings)
+				node->strings = xhash_init(_path_node_id,
+							   _free_path_node);
+
+			if (!(child = xhash_get_str(node->strings,
+						    entry->entry))) {
+				child = _new_path_node(entry);
+				xhash_add(node->strings, child);
+			}
+		} else {
+			if (!node->params)
+				node->params = list_create(_free_path_node);
+
+			if (!(child = list_find_first(node->params,
+						      _find_param_node,
+						      entry))) {
+				child = _new_path_node(entry);
+				list_append(node->params, child);
+			}
+		}
+
+		node = child;
+	}
+
+	return node;
+}
+
 typedef struct {
-	entry_method_t *method;
 	entry_t *entries;
-	path_t *path;
+	List ends; /* path_node_t where each method's path ends */
 } populate_methods_t;
 
-
 static data_for_each_cmd_t _populate_parameters(const data_t *data, void *arg)
 {
 	populate_methods_t *args = arg;
@@ -461,12 +561,12 @@ static data_for_each_cmd_t _populate_methods(const char *key,
 {
 	populate_methods_t *args = arg;
 	populate_methods_t nargs = *args;
-	entry_method_t *method = args->method;
 	const data_t *para;
 	int count = 0;
 	entry_t *entry;
+	data_for_each_cmd_t rc = DATA_FOR_EACH_CONT;
 
-	if ((method->method = get_http_method(key)) == HTTP_REQUEST_INVALID)
+	if (get_http_method(key) == HTTP_REQUEST_INVALID)
 		/* Ignore none HTTP method dictionary keys */
 		return DATA_FOR_EACH_CONT;
 
@@ -477,49 +577,60 @@ static data_for_each_cmd_t _populate_methods(const char *key,
 	for (entry = args->entries; entry->type; entry++)
 		count++;
 
-	if (!method->entries) {
-		/* only add entries on first method parse */
-		method->entries = xcalloc((count + 1), sizeof(entry_t));
-		/* count is already bounded */
-		memcpy(method->entries, args->entries,
-		       (count * sizeof(entry_t)));
-	}
-
-	/* clone over any strings */
-	for (entry = method->entries; entry->type; entry++) {
-		entry->entry = xstrdup(entry->entry);
-		entry->name = xstrdup(entry->name);
-	}
-	/* point to new entries clone */
-	nargs.entries = method->entries;
+	/* each method may give its parameters different types */
+	nargs.entries = xcalloc((count + 1), sizeof(entry_t));
+	/* count is already bounded */
+	memcpy(nargs.entries, args->entries, (count * sizeof(entry_t)));
 
 	para = data_key_get_const(data, "parameters");
-	if (!para)
-		return DATA_FOR_EACH_CONT;
-	if (data_get_type(para) != DATA_TYPE_LIST)
-		return DATA_FOR_EACH_FAIL;
-	if (data_list_for_each_const(para, _populate_parameters, &nargs) < 0)
-		return DATA_FOR_EACH_FAIL;
-
-	/* increment to next method entry */
-	args->method++;
+	if (para &&
+	    ((data_get_type(para) != DATA_TYPE_LIST) ||
+	     (data_list_for_each_const(para, _populate_parameters,
+				       &nargs) < 0))) {
+		rc = DATA_FOR_EACH_FAIL;
+		goto cleanup;
+	}
 
 	if (get_log_level() >= LOG_LEVEL_DEBUG5)
-		for (entry = method->entries; entry->type; entry++) {
-			debug5("%s: add method:%s for path tag:%d entry:%s name:%s parameter:%s entry_type:%s",
-			       __func__, key, args->path->tag, entry->entry,
-			       entry->name,
+		for (entry = nargs.entries; entry->type; entry++) {
+			debug5("%s: add method:%s entry:%s name:%s parameter:%s entry_type:%s",
+			       __func__, key, entry->entry, entry->name,
 			       _get_parameter_type_string(entry->parameter),
 			       _get_entry_type_string(entry->type));
 		}
 
-	return DATA_FOR_EACH_CONT;
+	list_append(args->ends, _add_path_entries(nargs.entries));
+
+cleanup:
+	/* strings still belong to args->entries */
+	xfree(nargs.entries);
+	return rc;
+}
+
+static int _find_tagged_node(void *x, void *key)
+{
+	return (((path_node_t *) x)->tag != -1);
+}
+
+static int _set_node_tag(void *x, void *arg)
+{
+	path_node_t *node = x;
+	int tag = *(int *) arg;
+
+	if (node->tag == -1)
+		node->tag = tag;
+	else if (node->tag != tag)
+		debug("%s: path already has tag %d instead of %d",
+		      __func__, node->tag, tag);
+
+	return 0;
 }
 
 extern int register_path_tag(const char *str_path)
 {
-	path_t *path = NULL;
+	int tag = -1;
 	const data_t *spec_entry;
+	path_node_t *node;
 	populate_methods_t args = {0};
 	entry_t *entries = _parse_openapi_path(str_path);
 
@@ -528,43 +639,85 @@ extern int register_path_tag(const char *str_path)
 
 	spec_entry = _find_spec_path(str_path);
 	if (!spec_entry)
-		return -1;
+		goto cleanup;
 
 	if (data_get_type(spec_entry) != DATA_TYPE_DICT)
-		return -1;
+		goto cleanup;
 
-	path = xmalloc(sizeof(*path));
-	path->tag = path_tag_counter++;
-	path->methods = xcalloc((data_get_dict_length(spec_entry) + 1),
-				sizeof(*path->methods));
-
-	args.method = path->methods;
 	args.entries = entries;
-	args.path = path;
+	args.ends = list_create(NULL);
 	if (data_dict_for_each_const(spec_entry, _populate_methods, &args) < 0)
 		fatal_abort("%s: failed", __func__);
 
+	/* same path registered again gets the same tag */
+	if ((node = list_find_first(args.ends, _find_tagged_node, NULL)))
+		tag = node->tag;
+	else
+		tag = path_tag_counter++;
+
+	list_for_each(args.ends, _set_node_tag, &tag);
+	FREE_NULL_LIST(args.ends);
+
+	debug5("%s: path %s has tag %d", __func__, str_path, tag);
+
+cleanup:
 	for (entry_t *entry = entries; entry->type; entry++) {
 		xfree(entry->entry);
 		xfree(entry->name);
 	}
 	xfree(entries);
-	list_append(paths, path);
 
-	return path->tag;
+	return tag;
 }
 
-static int _rm_path_by_tag(void *x, void *tptr)
+/* Remove tag below node. RET true if node is no longer needed */
+static bool _rm_path_tag(path_node_t *node, int tag);
+
+static void _rm_path_tag_strings(void *x, void *arg)
 {
-	path_t *path = (path_t *)x;
-	const int tag = *(int*)tptr;
+	path_node_t *node = x;
+	List unused = ((void **) arg)[1];
 
-	if (path->tag != tag)
-		return 0;
+	if (_rm_path_tag(node, *(int *) ((void **) arg)[0]))
+		list_append(unused, node->entry);
+}
+
+static int _rm_path_tag_params(void *x, void *arg)
+{
+	return _rm_path_tag(x, *(int *) arg);
+}
+
+static bool _rm_path_tag(path_node_t *node, int tag)
+{
+	if (node->tag == tag) {
+		debug5("%s: removing tag %d", __func__, node->tag);
+		node->tag = -1;
+	}
+
+	if (node->strings) {
+		List unused = list_create(NULL);
+		void *args[2] = { &tag, unused };
+		char *entry;
+
+		xhash_walk(node->strings, _rm_path_tag_strings, args);
+
+		/* xhash can not be changed while walking it */
+		while ((entry = list_pop(unused)))
+			xhash_delete_str(node->strings, entry);
+		FREE_NULL_LIST(unused);
+
+		if (!xhash_count(node->strings))
+			xhash_free(node->strings);
+	}
 
-	debug5("%s: removing tag %d", __func__, path->tag);
+	if (node->params) {
+		list_delete_all(node->params, _rm_path_tag_params, &tag);
 
-	return 1;
+		if (list_is_empty(node->params))
+			FREE_NULL_LIST(node->params);
+	}
+
+	return ((node->tag == -1) && !node->strings && !node->params);
 }
 
 extern void unregister_path_tag(int tag)
@@ -572,39 +725,29 @@ extern void unregister_path_tag(int tag)
 	slurm_rwlock_wrlock(&paths_lock);
 
 	if (paths)
-		list_delete_all(paths, _rm_path_by_tag, &tag);
+		(void) _rm_path_tag(paths, tag);
 
 	slurm_rwlock_unlock(&paths_lock);
 }
 
-typedef struct {
-	bool matched;
-	const data_t *dpath;
-	path_t *path;
-	data_t *params;
-	http_request_method_t method;
-	entry_t *entry;
-} match_path_from_data_t;
-
 /*
  * Check if the entry matches based on the OAS type
  * and if it does, then add that matched parameter
  */
-static bool _match_param(const data_t *data, match_path_from_data_t *args)
+static bool _match_param(const data_t *data, const path_node_t *node,
+			 data_t *params)
 {
 	bool matched = false;
-	entry_t *entry = args->entry;
-	data_t *params = args->params;
 	data_t *match = data_new();
 
 	data_copy(match, data);
 
-	switch (entry->parameter) {
+	switch (node->parameter) {
 	case OPENAPI_TYPE_NUMBER:
 	{
 		if (data_convert_type(match, DATA_TYPE_FLOAT) ==
 		    DATA_TYPE_FLOAT) {
-			data_set_float(data_key_set(params, entry->name),
+			data_set_float(data_key_set(params, node->entry),
 				       data_get_float(match));
 			matched = true;
 		}
@@ -614,7 +757,7 @@ static bool _match_param(const data_t *data, match_path_from_data_t *args)
 	{
 		if (data_convert_type(match, DATA_TYPE_INT_64) ==
 		    DATA_TYPE_INT_64) {
-			data_set_int(data_key_set(params, entry->name),
+			data_set_int(data_key_set(params, node->entry),
 				     data_get_int(match));
 			matched = true;
 		}
@@ -622,13 +765,13 @@ static bool _match_param(const data_t *data, match_path_from_data_t *args)
 	}
 	default: /* assume string */
 		debug("%s: unknown parameter type %s",
-		      __func__, _get_parameter_type_string(entry->parameter));
+		      __func__, _get_parameter_type_string(node->parameter));
 		/* fall through */
 	case OPENAPI_TYPE_STRING:
 	{
 		if (data_convert_type(match, DATA_TYPE_STRING) ==
 		    DATA_TYPE_STRING) {
-			data_set_string(data_key_set(params, entry->name),
+			data_set_string(data_key_set(params, node->entry),
 					data_get_string(match));
 			matched = true;
 		}
@@ -641,8 +784,8 @@ static bool _match_param(const data_t *data, match_path_from_data_t *args)
 		data_get_string_converted(data, &str);
 
 		debug5("%s: parameter %s[%s]->%s[%s] result=%s",
-		       __func__, entry->name,
-		       _get_parameter_type_string(entry->parameter),
+		       __func__, node->entry,
+		       _get_parameter_type_string(node->parameter),
 		       str, data_type_to_string(data_get_type(data)),
 		       (matched ? "matched" : "failed"));
 
@@ -653,92 +796,90 @@ static bool _match_param(const data_t *data, match_path_from_data_t *args)
 	return matched;
 }
 
-static data_for_each_cmd_t _match_path(const data_t *data, void *y)
+/*
+ * Find tag of the path ending below node matching the remaining entries.
+ * Strings are matched before parameters.
+ * RET tag or -1 if not found
+ */
+static int _match_path(const path_node_t *node, const data_t **entries,
+		       int count, data_t *params)
 {
-	match_path_from_data_t *args = y;
-	entry_t *entry = args->entry;
-	args->matched = false;
+	const data_t *data;
+	path_node_t *child;
+	ListIterator itr;
+	int tag = -1;
 
-	if (!entry->type)
-		return DATA_FOR_EACH_FAIL;
+	if (!count)
+		return node->tag;
+
+	data = entries[0];
 
-	if (entry->type == OPENAPI_PATH_ENTRY_MATCH_STRING) {
-		bool match;
+	if (node->strings && (data_get_type(data) == DATA_TYPE_STRING) &&
+	    (child = xhash_get_str(node->strings,
+				   data_get_string_const(data)))) {
+		debug5("%s: string match %s", __func__, child->entry);
 
-		if (data_get_type(data) != DATA_TYPE_STRING)
-			return DATA_FOR_EACH_FAIL;
+		if ((tag = _match_path(child, (entries + 1), (count - 1),
+				       params)) != -1)
+			return tag;
+	}
 
-		match = !xstrcmp(data_get_string_const(data), entry->entry);
+	if (!node->params)
+		return -1;
 
-		debug5("%s: string attempt match %s to %s: %s",
-		       __func__, entry->entry, data_get_string_const(data),
-		       (match ? "SUCCESS" : "FAILURE"));
+	itr = list_iterator_create(node->params);
+	while ((tag == -1) && (child = list_next(itr))) {
+		if (!_match_param(data, child, params))
+			continue;
 
-		if (!match)
-			return DATA_FOR_EACH_FAIL;
-	} else if (entry->type == OPENAPI_PATH_ENTRY_MATCH_PARAMETER) {
-		if (!_match_param(data, args))
-			return DATA_FOR_EACH_FAIL;
-	} else
-		fatal_abort("%s: unknown OAS path entry match type",
-			    __func__);
+		if ((tag = _match_path(child, (entries + 1), (count - 1),
+				       params)) == -1)
+			/* parameter is not part of the path after all */
+			data_key_unset(params, child->entry);
+	}
+	list_iterator_destroy(itr);
 
-	args->entry++;
-	args->matched = true;
-	return DATA_FOR_EACH_CONT;
+	return tag;
 }
 
-static int _match_path_from_data(void *x, void *key)
+static data_for_each_cmd_t _collect_entries(const data_t *data, void *arg)
 {
-	match_path_from_data_t *args = key;
-	path_t *path = x;
-	entry_method_t *method;
+	const data_t ***entry = arg;
 
-	args->path = path;
-	for (method = path->methods; method->entries; method++) {
-		args->entry = method->entries;
-		data_list_for_each_const(args->dpath, _match_path, args);
+	**entry = data;
+	(*entry)++;
 
-		if (args->matched)
-			break;
-	}
-
-	if (get_log_level() >= LOG_LEVEL_DEBUG5) {
-		char *str_path = dump_json(args->dpath,
-					   DUMP_JSON_FLAGS_COMPACT);
-		if (args->matched)
-			debug5("%s: match successful for tag %d to %s(0x%"PRIXPTR")",
-			       __func__, args->path->tag, str_path,
-			       (uintptr_t) args->dpath);
-		else
-			debug5("%s: match failed for tag %d to %s(0x%"PRIXPTR")",
-			       __func__, args->path->tag, str_path,
-			       (uintptr_t) args->dpath);
-		xfree(str_path);
-	}
-
-	return (args->matched ? 1 : 0);
+	return DATA_FOR_EACH_CONT;
 }
 
 extern int find_path_tag(const data_t *dpath, data_t *params,
 			 http_request_method_t method)
 {
-	path_t *path;
 	int tag = -1;
-	match_path_from_data_t args = {
-		.params = params,
-		.dpath = dpath,
-	};
+	const data_t **entries, **entry;
+	int count;
 
 	xassert(data_get_type(params) == DATA_TYPE_DICT);
-	slurm_rwlock_rdlock(&paths_lock);
 
-	path = list_find_first(paths, _match_path_from_data, &args);
-	if (path)
-		tag = path->tag;
+	if ((data_get_type(dpath) != DATA_TYPE_LIST) ||
+	    !(count = data_get_list_length(dpath)))
+		return -1;
+
+	entry = entries = xcalloc(count, sizeof(*entries));
+	(void) data_list_for_each_const(dpath, _collect_entries, &entry);
 
+	slurm_rwlock_rdlock(&paths_lock);
+	if (paths)
+		tag = _match_path(paths, entries, count, params);
 	slurm_rwlock_unlock(&paths_lock);
 
+	if (get_log_level() >= LOG_LEVEL_DEBUG5) {
+		char *str_path = dump_json(dpath, DUMP_JSON_FLAGS_COMPACT);
+		debug5("%s: %s matched tag %d", __func__, str_path, tag);
+		xfree(str_path);
+	}
+
+	xfree(entries);
 	return tag;
 }
 
@@ -747,43 +888,6 @@ extern const data_t *get_openapi_specification(void)
 	return spec[0];
 }
 
-static void _list_delete_path_t(void *x)
-{
-	entry_method_t *method;
-
-	if (!x)
-		return;
-
-	path_t *path = x;
-	xassert(path->tag != -1);
-	method = path->methods;
-
-	while (method->method) {
-		entry_t *entry = method->entries;
-
-		debug5("%s: remove path tag:%d method:%s",
-		       __func__, path->tag,
-		       get_http_method_string(method->method));
-
-		while (entry->type) {
-			debug5("%s: remove path tag:%d method:%s entry:%s name:%s",
-			       __func__, path->tag,
-			       get_http_method_string(method->method),
-			       entry->entry, entry->name);
-
-			xfree(entry->entry);
-			xfree(entry->name);
-			entry++;
-		}
-
-		xfree(method->entries);
-		method++;
-	}
-
-	xfree(path->methods);
-	xfree(path);
-}
-
 static int _op_handler_openapi(const char *context_id,
 			       http_request_method_t method,
 			       data_t *parameters, data_t *query,
@@ -805,7 +909,7 @@ extern int init_openapi(const plugin_handle_t *plugin_handles,
 	if (spec)
 		fatal_abort("%s called twice", __func__);
 
-	paths = list_create(_list_delete_path_t);
+	paths = _new_path_node(NULL);
 
 	/* Load OpenAPI plugins */
 	xassert(g_context_cnt == -1);
@@ -868,7 +972,8 @@ extern void destroy_openapi(void)
 	xfree(g_context);
 	g_context_cnt = -1;
 
-	FREE_NULL_LIST(paths);
+	_free_path_node(paths);
+	paths = NULL;
 
 	for (size_t i = 0; spec[i]; i++)
 		FREE_NULL_DATA(spec[i]);
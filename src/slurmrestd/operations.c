@@ -42,6 +42,7 @@
 
 #include "src/common/list.h"
 #include "src/common/log.h"
+#include "src/common/timers.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
@@ -55,9 +56,54 @@
 #include "src/slurmrestd/xyaml.h"
 
 static pthread_rwlock_t paths_lock = PTHREAD_RWLOCK_INITIALIZER;
-static List paths = NULL;
 
 #define MAGIC 0xDFFEAAAE
+#define MAGIC_RESPONSE 0xDFFEAAAF
+
+/* limits of the response cache */
+#define MAX_CACHED_RESPONSES 64
+#define MAX_CACHED_BYTES (256 * 1024 * 1024)
+#define MAX_CACHED_BODY (64 * 1024 * 1024)
+
+typedef struct {
+	int magic;
+	/* content type, user, path and query of request */
+	char *key;
+	char *etag;
+	uint64_t version;
+	char *body;
+	size_t body_length;
+	time_t last_used;
+	/* requests sending body plus one while in responses */
+	int refs;
+} cached_response_t;
+
+/* response cache state of the request being handled by this thread */
+typedef struct {
+	char *key;
+	/* If-None-Match header from client or NULL */
+	const char *if_none_match;
+	/* ETag of response once handler gave a version */
+	char *etag;
+	uint64_t version;
+	/* client already has the response */
+	bool not_modified;
+	/* cached response to send (holds reference) */
+	cached_response_t *hit;
+	/* copy of body as it is rendered for the cache */
+	http_stream_t *stream;
+	char *body;
+	size_t body_length;
+	size_t body_size;
+	bool body_too_large;
+} request_cache_t;
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static List responses = NULL; /* list of cached_response_t */
+static size_t cached_bytes = 0;
+/* included in every ETag to not match anything from another slurmrestd */
+static time_t start_time = 0;
+static __thread request_cache_t *cache_req = NULL;
 
 typedef struct {
 	int magic;
@@ -69,6 +115,10 @@ typedef struct {
 	int callback_tag;
 } path_t;
 
+/* bound paths indexed by tag from register_path_tag() */
+static path_t **paths = NULL;
+static int paths_count = 0;
+
 static void _check_path_magic(const path_t *path)
 {
 	xassert(path->magic == MAGIC);
@@ -89,16 +139,58 @@ static void _free_path(void *x)
 	xfree(path);
 }
 
-extern int init_operations(void)
+/* Drop reference to cached response. cache_mutex must be held. */
+static void _release_response(cached_response_t *resp)
 {
-	slurm_rwlock_wrlock(&paths_lock);
+	xassert(resp->magic == MAGIC_RESPONSE);
+	xassert(resp->refs > 0);
 
-	if (paths)
-		fatal_abort("%s called twice", __func__);
+	if (--resp->refs)
+		return;
 
-	paths = list_create(_free_path);
+	resp->magic = ~MAGIC_RESPONSE;
+	xfree(resp->key);
+	xfree(resp->etag);
+	xfree(resp->body);
+	xfree(resp);
+}
 
-	slurm_rwlock_unlock(&paths_lock);
+/* List destructor of responses. cache_mutex must be held. */
+static void _uncache_response(void *x)
+{
+	cached_response_t *resp = x;
+
+	cached_bytes -= resp->body_length;
+	_release_response(resp);
+}
+
+static int _find_response(void *x, void *key)
+{
+	cached_response_t *resp = x;
+
+	xassert(resp->magic == MAGIC_RESPONSE);
+
+	return !xstrcmp(resp->key, key);
+}
+
+static int _find_oldest_response(void *x, void *arg)
+{
+	cached_response_t *resp = x, **oldest = arg;
+
+	if (!*oldest || (resp->last_used < (*oldest)->last_used))
+		*oldest = resp;
+
+	return 0;
+}
+
+extern int init_operations(void)
+{
+	slurm_mutex_lock(&cache_mutex);
+	if (responses)
+		fatal_abort("%s called twice", __func__);
+	responses = list_create(_uncache_response);
+	start_time = time(NULL);
+	slurm_mutex_unlock(&cache_mutex);
 
 	return SLURM_SUCCESS;
 }
@@ -107,22 +199,30 @@ extern void destroy_operations(void)
 {
 	slurm_rwlock_wrlock(&paths_lock);
 
-	FREE_NULL_LIST(paths);
+	for (int i = 0; i < paths_count; i++)
+		_free_path(paths[i]);
+	xfree(paths);
+	paths_count = 0;
 
 	slurm_rwlock_unlock(&paths_lock);
+
+	slurm_mutex_lock(&cache_mutex);
+	FREE_NULL_LIST(responses);
+	slurm_mutex_unlock(&cache_mutex);
 }
 
-static int _match_path_key(void *x, void *ptr)
+/* RET path bound to tag or NULL. paths_lock must be held. */
+static path_t *_get_path(int tag)
 {
-	path_t *path = (path_t *)x;
-	int tag = *(int *) ptr;
+	path_t *path;
+
+	if ((tag < 0) || (tag >= paths_count) || !(path = paths[tag]))
+		return NULL;
 
 	_check_path_magic(path);
+	xassert(path->tag == tag);
 
-	if (path->tag == tag)
-		return 1;
-	else
-		return 0;
+	return path;
 }
 
 extern int bind_operation_handler(const char *str_path,
@@ -142,16 +242,23 @@ extern int bind_operation_handler(const char *str_path,
 		fatal_abort("%s: failure registering OpenAPI for path: %s",
 			    __func__, str_path);
 
-	if ((path = list_find_first(paths, _match_path_key, &path_tag)))
+	if ((path = _get_path(path_tag)))
 		goto exists;
 
 	/* add new path */
 	debug4("%s: new path %s with tag %d", __func__, str_path, path_tag);
 
+	if (path_tag >= paths_count) {
+		int count = MAX((path_tag + 1), (paths_count * 2));
+
+		xrecalloc(paths, count, sizeof(*paths));
+		paths_count = count;
+	}
+
 	path = xmalloc(sizeof(*path));
 	path->magic = MAGIC;
 	path->tag = path_tag;
-	list_append(paths, path);
+	paths[path_tag] = path;
 
 exists:
 	path->callback = callback;
@@ -162,29 +269,23 @@ exists:
 	return SLURM_SUCCESS;
 }
 
-static int _rm_path_callback(void *x, void *ptr)
+extern int unbind_operation_handler(operation_handler_t callback)
 {
-	path_t *path = (path_t *)x;
-	operation_handler_t callback = ptr;
-
-	_check_path_magic(path);
-
-	if (path->callback != callback)
-		return 0;
+	slurm_rwlock_wrlock(&paths_lock);
 
-	debug5("%s: removing tag %d for callback %"PRIxPTR,
-	       __func__, path->tag, (uintptr_t) callback);
-	unregister_path_tag(path->tag);
+	for (int i = 0; i < paths_count; i++) {
+		path_t *path = _get_path(i);
 
-	return 1;
-}
+		if (!path || (path->callback != callback))
+			continue;
 
-extern int unbind_operation_handler(operation_handler_t callback)
-{
-	slurm_rwlock_wrlock(&paths_lock);
+		debug5("%s: removing tag %d for callback %"PRIxPTR,
+		       __func__, path->tag, (uintptr_t) callback);
+		unregister_path_tag(path->tag);
 
-	if (paths)
-		list_delete_all(paths, _rm_path_callback, callback);
+		_free_path(path);
+		paths[i] = NULL;
+	}
 
 	slurm_rwlock_unlock(&paths_lock);
 	return SLURM_ERROR;
@@ -264,7 +365,7 @@ static int _get_query(on_http_request_args_t *args, data_t **query,
 		fatal_abort("%s: unknown read mime type", __func__);
 	}
 
-	if (!query)
+	if (!*query)
 		return _operations_router_reject(
 			args, "Unable to parse query.",
 			HTTP_STATUS_CODE_ERROR_BAD_REQUEST);
@@ -334,53 +435,253 @@ static int _resolve_mime(on_http_request_args_t *args, mime_types_t *read_mime,
 	return SLURM_SUCCESS;
 }
 
+extern bool operations_response_cached(uint64_t version)
+{
+	request_cache_t *req = cache_req;
+	cached_response_t *resp;
+	uint32_t hash = 2166136261U;
+
+	/* only GET requests are cached */
+	if (!req)
+		return false;
+
+	xassert(!req->etag);
+
+	/* FNV-1a of key to tell apart responses of different requests */
+	for (const char *p = req->key; *p; p++)
+		hash = (hash ^ (uint8_t) *p) * 16777619U;
+
+	req->version = version;
+	req->etag = xstrdup_printf("\"%"PRIx64"-%08x-%"PRIx64"\"",
+				   (uint64_t) start_time, hash, version);
+
+	if (req->if_none_match &&
+	    (!xstrcmp(req->if_none_match, "*") ||
+	     xstrstr(req->if_none_match, req->etag))) {
+		req->not_modified = true;
+		return true;
+	}
+
+	slurm_mutex_lock(&cache_mutex);
+	if ((resp = list_find_first(responses, _find_response, req->key)) &&
+	    (resp->version == version)) {
+		resp->refs++;
+		resp->last_used = time(NULL);
+		req->hit = resp;
+	}
+	slurm_mutex_unlock(&cache_mutex);
+
+	return (req->hit != NULL);
+}
+
+/* Send response body to client and keep a copy for the cache */
+static int _write_cached(void *arg, const char *buf, size_t len)
+{
+	request_cache_t *req = arg;
+
+	if (req->body_too_large) {
+		/* not caching */
+	} else if ((req->body_length + len) > MAX_CACHED_BODY) {
+		debug3("%s: not caching response over %u bytes",
+		       __func__, MAX_CACHED_BODY);
+		req->body_too_large = true;
+		xfree(req->body);
+	} else {
+		if ((req->body_length + len) > req->body_size) {
+			req->body_size = MAX((req->body_size * 2),
+					     (req->body_length + len));
+			xrealloc_nz(req->body, req->body_size);
+		}
+
+		memcpy((req->body + req->body_length), buf, len);
+		req->body_length += len;
+	}
+
+	return http_stream_write(req->stream, buf, len);
+}
+
+/* Add rendered body of request to the cache */
+static void _cache_response(request_cache_t *req)
+{
+	cached_response_t *resp, *old;
+
+	slurm_mutex_lock(&cache_mutex);
+
+	if ((old = list_find_first(responses, _find_response, req->key))) {
+		if (old->version > req->version) {
+			/* raced with a request that got newer data */
+			slurm_mutex_unlock(&cache_mutex);
+			return;
+		}
+
+		list_delete_ptr(responses, old);
+	}
+
+	while ((list_count(responses) >= MAX_CACHED_RESPONSES) ||
+	       (list_count(responses) &&
+		((cached_bytes + req->body_length) > MAX_CACHED_BYTES))) {
+		cached_response_t *oldest = NULL;
+
+		list_for_each(responses, _find_oldest_response, &oldest);
+		list_delete_ptr(responses, oldest);
+	}
+
+	resp = xmalloc(sizeof(*resp));
+	resp->magic = MAGIC_RESPONSE;
+	resp->key = xstrdup(req->key);
+	resp->etag = xstrdup(req->etag);
+	resp->version = req->version;
+	resp->body = req->body;
+	resp->body_length = req->body_length;
+	resp->last_used = time(NULL);
+	resp->refs = 1;
+	req->body = NULL;
+
+	list_append(responses, resp);
+	cached_bytes += resp->body_length;
+
+	slurm_mutex_unlock(&cache_mutex);
+}
+
+/* Answer request from the cache */
+static int _send_cached(on_http_request_args_t *args, request_cache_t *req,
+			List headers, mime_types_t write_mime)
+{
+	send_http_response_args_t send_args = {
+		.con = args->context->con,
+		.http_major = args->http_major,
+		.http_minor = args->http_minor,
+		.status_code = HTTP_STATUS_CODE_SUCCESS_OK,
+		.headers = headers,
+		.body_encoding = get_mime_type_str(write_mime),
+	};
+	http_stream_t *stream;
+	int rc;
+
+	if (req->not_modified) {
+		debug3("%s: [%s] client already has response %s",
+		       __func__, args->context->con->name, req->etag);
+		send_args.status_code = HTTP_STATUS_CODE_REDIRECT_NOT_MODIFIED;
+		send_args.body_encoding = NULL;
+		return send_http_response(&send_args);
+	}
+
+	debug3("%s: [%s] sending cached response %s",
+	       __func__, args->context->con->name, req->etag);
+
+	stream = http_stream_start(&send_args);
+	rc = http_stream_write(stream, req->hit->body, req->hit->body_length);
+	return http_stream_fini(stream, rc);
+}
+
 static int _call_handler(on_http_request_args_t *args, data_t *params,
 			 data_t *query, operation_handler_t callback,
 			 int callback_tag, mime_types_t write_mime)
 {
 	int rc;
-	data_t *resp = data_new();
+	data_t *resp = data_new_arena();
 	const char *body = NULL;
+	request_cache_t req = { 0 };
+	http_header_entry_t etag_header = { .name = "ETag" };
+	http_header_entry_t cache_header = {
+		.name = "Cache-Control",
+		/* clients must always revalidate */
+		.value = "no-cache",
+	};
+	List headers = NULL;
+
+	if (args->method == HTTP_REQUEST_GET) {
+		rest_auth_context_t *auth = args->context->auth;
+
+		req.key = xstrdup_printf("%s\n%s\n%s?%s",
+					 get_mime_type_str(write_mime),
+					 ((auth && auth->user_name) ?
+					  auth->user_name : ""),
+					 args->path,
+					 (args->query ? args->query : ""));
+		req.if_none_match = find_http_header(args->headers,
+						     "If-None-Match");
+		cache_req = &req;
+	}
 
 	rc = callback(args->context->con->name, args->method, params, query,
 		      callback_tag, resp, args->context->auth);
 
+	cache_req = NULL;
+
+	if (req.etag) {
+		etag_header.value = req.etag;
+		headers = list_create(NULL);
+		list_append(headers, &etag_header);
+		list_append(headers, &cache_header);
+	}
+
+	if (!rc && (req.not_modified || req.hit)) {
+		rc = _send_cached(args, &req, headers, write_mime);
+		goto cleanup;
+	}
+
 	if (data_get_type(resp) == DATA_TYPE_NULL) {
 		rc = _operations_router_reject(
 			args, body, HTTP_STATUS_CODE_SRVERR_NOT_IMPLEMENTED);
 		goto cleanup;
 	}
 
-	if (write_mime == MIME_YAML)
-		body = dump_yaml(resp);
-	else if (write_mime == MIME_JSON)
-		body = dump_json(resp, DUMP_JSON_FLAGS_PRETTY);
-	else
-		fatal_abort("%s: unexpected mime type", __func__);
-
 	if (!rc) {
 		send_http_response_args_t send_args = {
 			.con = args->context->con,
 			.http_major = args->http_major,
 			.http_minor = args->http_minor,
 			.status_code = HTTP_STATUS_CODE_SUCCESS_OK,
-			.body = NULL,
-			.body_length = 0,
+			.headers = headers,
+			.body_encoding = get_mime_type_str(write_mime),
 		};
-
-		if (body) {
-			send_args.body = body;
-			send_args.body_length = strlen(body);
-			send_args.body_encoding = get_mime_type_str(write_mime);
+		/* write response out as it is dumped */
+		http_stream_t *stream = http_stream_start(&send_args);
+		int (*write_func)(void *arg, const char *buf, size_t len) =
+			http_stream_write;
+		void *write_arg = stream;
+
+		if (req.etag) {
+			req.stream = stream;
+			write_func = _write_cached;
+			write_arg = &req;
 		}
 
-		rc = send_http_response(&send_args);
+		if (write_mime == MIME_YAML)
+			rc = dump_yaml_stream(resp, write_func, write_arg);
+		else if (write_mime == MIME_JSON)
+			rc = dump_json_stream(resp, DUMP_JSON_FLAGS_PRETTY,
+					      write_func, write_arg);
+		else
+			fatal_abort("%s: unexpected mime type", __func__);
+
+		rc = http_stream_fini(stream, rc);
+
+		if (!rc && req.etag && !req.body_too_large)
+			_cache_response(&req);
 	} else {
+		if (write_mime == MIME_YAML)
+			body = dump_yaml(resp);
+		else if (write_mime == MIME_JSON)
+			body = dump_json(resp, DUMP_JSON_FLAGS_PRETTY);
+		else
+			fatal_abort("%s: unexpected mime type", __func__);
+
 		rc = _operations_router_reject(
 			args, body, HTTP_STATUS_CODE_SRVERR_INTERNAL);
 	}
 
 cleanup:
+	if (req.hit) {
+		slurm_mutex_lock(&cache_mutex);
+		_release_response(req.hit);
+		slurm_mutex_unlock(&cache_mutex);
+	}
+	FREE_NULL_LIST(headers);
+	xfree(req.key);
+	xfree(req.etag);
+	xfree(req.body);
 	xfree(body);
 	FREE_NULL_DATA(resp);
 
@@ -398,7 +699,9 @@ extern int operations_router(on_http_request_args_t *args)
 	int callback_tag;
 	mime_types_t read_mime = MIME_UNKNOWN;
 	mime_types_t write_mime = MIME_UNKNOWN;
+	DEF_TIMERS;
 
+	START_TIMER;
 	info("%s: [%s] %s %s",
 	     __func__, args->context->con->name,
 	     get_http_method_string(args->method), args->path);
@@ -406,12 +709,12 @@ extern int operations_router(on_http_request_args_t *args)
 	if ((rc = rest_authenticate_http_request(args))) {
 		_operations_router_reject(args, "Authentication failure",
 					  HTTP_STATUS_CODE_ERROR_UNAUTHORIZED);
-		return rc;
+		goto cleanup;
 	}
 
-	params = data_set_dict(data_new());
+	params = data_set_dict(data_new_arena());
 	if ((rc = _resolve_path(args, &path_tag, params)))
-	    return rc;
+		goto cleanup;
 
 	/*
 	 * Hold read lock while the callback is executing to avoid
@@ -419,10 +722,8 @@ extern int operations_router(on_http_request_args_t *args)
 	 */
 	slurm_rwlock_rdlock(&paths_lock);
 
-	if (!(path = list_find_first(paths, _match_path_key, &path_tag)))
+	if (!(path = _get_path(path_tag)))
 		fatal_abort("%s: found tag but missing path handler", __func__);
-	_check_path_magic(path);
-
 	/* clone over the callback info to release lock */
 	callback = path->callback;
 	callback_tag = path->callback_tag;
@@ -445,5 +746,8 @@ cleanup:
 	FREE_NULL_DATA(query);
 	FREE_NULL_DATA(params);
 
+	END_TIMER;
+	con_mgr_add_request_time(args->context->con, DELTA_TIMER);
+
 	return rc;
 }
@@ -93,6 +93,18 @@ extern int bind_operation_handler(const char *path,
  */
 extern int unbind_operation_handler(operation_handler_t callback);
 
+/*
+ * Allow response of current GET request to be cached.
+ * Handlers of read only endpoints call this after loading the data the
+ * response is built from but before populating resp. Responses are cached
+ * per path, query, user and content type and are given an ETag derived from
+ * version so clients can revalidate them with If-None-Match.
+ * IN version - changes whenever the loaded data changes
+ * RET true if the response is already cached or the client has it:
+ *	handler must then return SLURM_SUCCESS without populating resp
+ */
+extern bool operations_response_cached(uint64_t version);
+
 /*
  * Parses incoming requests and calls handlers.
  * expected to be called as on_http_request_t() by http.c.
@@ -51,6 +51,8 @@
 #include "src/slurmrestd/operations.h"
 #include "src/slurmrestd/xjson.h"
 
+#include "src/slurmrestd/plugins/openapi/v0.0.36/load_cache.h"
+
 /*
  * These variables are required by the generic plugin interface.  If they
  * are not found in the plugin, the plugin loader will ignore it.
@@ -115,4 +117,5 @@ extern void slurm_openapi_p_fini(void)
 	destroy_op_jobs();
 	destroy_op_nodes();
 	destroy_op_partitions();
+	load_cache_fini();
 }
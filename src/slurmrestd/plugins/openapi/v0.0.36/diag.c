@@ -48,6 +48,7 @@
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
+#include "src/slurmrestd/conmgr.h"
 #include "src/slurmrestd/operations.h"
 #include "src/slurmrestd/xjson.h"
 
@@ -57,6 +58,49 @@ typedef enum {
 	URL_TAG_PING,
 } url_tag_t;
 
+/* Add statistics of the connection manager of this slurmrestd */
+static void _dump_con_mgr_stats(data_t *d)
+{
+	con_mgr_stats_t stats;
+	data_t *latency;
+	uint64_t max_usec = 1000;
+
+	if (con_mgr_get_stats(&stats))
+		return;
+
+	d = data_set_dict(data_key_set(d, "slurmrestd"));
+	data_set_int(data_key_set(d, "connections"), stats.connections);
+	data_set_int(data_key_set(d, "connections_total"),
+		     stats.connections_total);
+	data_set_int(data_key_set(d, "listeners"), stats.listeners);
+	data_set_int(data_key_set(d, "max_connections"),
+		     stats.max_connections);
+	data_set_int(data_key_set(d, "work_active"), stats.work_active);
+	data_set_int(data_key_set(d, "work_queued"), stats.work_queued);
+	data_set_int(data_key_set(d, "connection_work_queued"),
+		     stats.con_work_queued);
+	data_set_int(data_key_set(d, "inspect_queued"), stats.inspect_queued);
+	data_set_int(data_key_set(d, "requests"), stats.requests);
+	data_set_int(data_key_set(d, "request_time_sum"),
+		     stats.request_time_sum);
+	data_set_int(data_key_set(d, "request_time_max"),
+		     stats.request_time_max);
+
+	latency = data_set_list(data_key_set(d, "request_latency"));
+	for (int i = 0; i < CON_MGR_LATENCY_BUCKETS; i++) {
+		data_t *b = data_set_dict(data_list_append(latency));
+
+		/* last bucket has no upper bound */
+		if (i < (CON_MGR_LATENCY_BUCKETS - 1))
+			data_set_int(data_key_set(b, "max_usec"), max_usec);
+		else
+			data_set_null(data_key_set(b, "max_usec"));
+		data_set_int(data_key_set(b, "count"),
+			     stats.request_latency[i]);
+		max_usec *= 10;
+	}
+}
+
 static int _op_handler_diag(const char *context_id,
 			    http_request_method_t method, data_t *parameters,
 			    data_t *query, int tag, data_t *resp_ptr,
@@ -72,6 +116,8 @@ static int _op_handler_diag(const char *context_id,
 	data_t *d = data_set_dict(data_key_set(p, "statistics"));
 	debug4("%s:[%s] diag handler called", __func__, context_id);
 
+	_dump_con_mgr_stats(p);
+
 	if ((rc = slurm_get_statistics(&resp, req)))
 		goto cleanup;
 
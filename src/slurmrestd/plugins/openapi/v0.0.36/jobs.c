@@ -59,6 +59,7 @@
 #include "src/common/strlcpy.h"
 #include "src/common/tres_bind.h"
 #include "src/common/tres_frequency.h"
+#include "src/common/uid.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
@@ -67,6 +68,8 @@
 #include "src/slurmrestd/operations.h"
 #include "src/slurmrestd/xjson.h"
 
+#include "src/slurmrestd/plugins/openapi/v0.0.36/load_cache.h"
+
 typedef struct {
 	const char *param;
 	int optval;
@@ -697,10 +700,10 @@ static job_parse_list_t _parse_job_list(const data_t *jobs, char *script,
 }
 
 /* dump job integer list as data list
- * IN ptr to integer list (-1 is terminator)
  * IN d ptr to data to populate
+ * IN ptr to integer list (-1 is terminator)
  */
-static void _dump_job_int32_list(const int32_t *ptr, data_t *d)
+static void _dump_job_int32_list(data_t *d, const int32_t *ptr)
 {
 	// based on _print_job_exc_node_inx
 	data_set_list(d);
@@ -708,166 +711,201 @@ static void _dump_job_int32_list(const int32_t *ptr, data_t *d)
 		data_set_int(data_list_append(d), *(ptr++));
 }
 
-static data_t *dump_job_info(slurm_job_info_t *job, data_t *jd)
+/* dump job flags as data list
+ * IN bitflags ptr to data to populate
+ * IN flags job flags
+ */
+static void _dump_job_bitflags(data_t *bitflags, uint32_t flags)
 {
-	data_set_dict(jd);
-	data_set_string(data_key_set(jd, "account"), job->account);
-	data_set_int(data_key_set(jd, "accrue_time"), job->accrue_time);
-	data_set_string(data_key_set(jd, "admin_comment"), job->admin_comment);
-	/* alloc_node intentionally skipped */
-	data_set_int(data_key_set(jd, "array_job_id"), job->array_job_id);
-	if (job->array_task_id == NO_VAL)
-		data_set_null(data_key_set(jd, "array_task_id"));
-	else
-		data_set_int(data_key_set(jd, "array_task_id"),
-			     job->array_task_id);
-	data_set_int(data_key_set(jd, "array_max_tasks"), job->array_max_tasks);
-	data_set_string(data_key_set(jd, "array_task_string"),
-			job->array_task_str);
-	data_set_int(data_key_set(jd, "association_id"), job->assoc_id);
-	data_set_string(data_key_set(jd, "batch_features"),
-			job->batch_features);
-	data_set_bool(data_key_set(jd, "batch_flag"), job->batch_flag == 1);
-	data_set_string(data_key_set(jd, "batch_host"), job->batch_host);
-	data_t *bitflags = data_key_set(jd, "flags");
 	data_set_list(bitflags);
-	if (job->bitflags & KILL_INV_DEP)
+	if (flags & KILL_INV_DEP)
 		data_set_string(data_list_append(bitflags), "KILL_INV_DEP");
-	if (job->bitflags & NO_KILL_INV_DEP)
+	if (flags & NO_KILL_INV_DEP)
 		data_set_string(data_list_append(bitflags), "NO_KILL_INV_DEP");
-	if (job->bitflags & HAS_STATE_DIR)
+	if (flags & HAS_STATE_DIR)
 		data_set_string(data_list_append(bitflags), "HAS_STATE_DIR");
-	if (job->bitflags & BACKFILL_TEST)
+	if (flags & BACKFILL_TEST)
 		data_set_string(data_list_append(bitflags), "BACKFILL_TEST");
-	if (job->bitflags & GRES_ENFORCE_BIND)
+	if (flags & GRES_ENFORCE_BIND)
 		data_set_string(data_list_append(bitflags),
 				"GRES_ENFORCE_BIND");
-	if (job->bitflags & TEST_NOW_ONLY)
+	if (flags & TEST_NOW_ONLY)
 		data_set_string(data_list_append(bitflags), "TEST_NOW_ONLY");
-	if (job->bitflags & NODE_REBOOT)
+	if (flags & NODE_REBOOT)
 		data_set_string(data_list_append(bitflags), "NODE_REBOOT");
-	if (job->bitflags & SPREAD_JOB)
+	if (flags & SPREAD_JOB)
 		data_set_string(data_list_append(bitflags), "SPREAD_JOB");
-	if (job->bitflags & USE_MIN_NODES)
+	if (flags & USE_MIN_NODES)
 		data_set_string(data_list_append(bitflags), "USE_MIN_NODES");
-	if (job->bitflags & JOB_KILL_HURRY)
+	if (flags & JOB_KILL_HURRY)
 		data_set_string(data_list_append(bitflags), "JOB_KILL_HURRY");
-	if (job->bitflags & TRES_STR_CALC)
+	if (flags & TRES_STR_CALC)
 		data_set_string(data_list_append(bitflags), "TRES_STR_CALC");
-	if (job->bitflags & SIB_JOB_FLUSH)
+	if (flags & SIB_JOB_FLUSH)
 		data_set_string(data_list_append(bitflags), "SIB_JOB_FLUSH");
-	if (job->bitflags & HET_JOB_FLAG)
+	if (flags & HET_JOB_FLAG)
 		data_set_string(data_list_append(bitflags), "HET_JOB_FLAG");
-	if (job->bitflags & JOB_CPUS_SET)
+	if (flags & JOB_CPUS_SET)
 		data_set_string(data_list_append(bitflags), "JOB_CPUS_SET ");
-	if (job->bitflags & TOP_PRIO_TMP)
+	if (flags & TOP_PRIO_TMP)
 		data_set_string(data_list_append(bitflags), "TOP_PRIO_TMP");
-	if (job->bitflags & JOB_ACCRUE_OVER)
+	if (flags & JOB_ACCRUE_OVER)
 		data_set_string(data_list_append(bitflags), "JOB_ACCRUE_OVER");
-	if (job->bitflags & GRES_DISABLE_BIND)
+	if (flags & GRES_DISABLE_BIND)
 		data_set_string(data_list_append(bitflags),
 				"GRES_DISABLE_BIND");
-	if (job->bitflags & JOB_WAS_RUNNING)
+	if (flags & JOB_WAS_RUNNING)
 		data_set_string(data_list_append(bitflags), "JOB_WAS_RUNNING");
-	if (job->bitflags & JOB_MEM_SET)
+	if (flags & JOB_MEM_SET)
 		data_set_string(data_list_append(bitflags), "JOB_MEM_SET");
-	if (job->bitflags & JOB_RESIZED)
+	if (flags & JOB_RESIZED)
 		data_set_string(data_list_append(bitflags), "JOB_RESIZED");
+}
+
+/*
+ * Test if field was requested. Only for use in dump_job_info().
+ */
+#define _want_job_field(key) (!fields || data_key_get_const(fields, key))
+
+/*
+ * Set field of job with func(data, ...) only if field was requested, so
+ * nothing is converted for fields that were not. Only for use in
+ * dump_job_info().
+ */
+#define _set_job_field(func, key, ...)					\
+	do {								\
+		if (_want_job_field(key))				\
+			func(data_key_set(jd, key), ##__VA_ARGS__);	\
+	} while (0)
+
+/*
+ * Dump job into data dictionary
+ * IN job - job to dump
+ * IN jd - data to populate
+ * IN fields - dictionary of fields to dump or NULL to dump all fields
+ * RET jd
+ */
+static data_t *dump_job_info(slurm_job_info_t *job, data_t *jd,
+			     const data_t *fields)
+{
+	data_set_dict(jd);
+	_set_job_field(data_set_string, "account", job->account);
+	_set_job_field(data_set_int, "accrue_time", job->accrue_time);
+	_set_job_field(data_set_string, "admin_comment", job->admin_comment);
+	/* alloc_node intentionally skipped */
+	_set_job_field(data_set_int, "array_job_id", job->array_job_id);
+	if (job->array_task_id == NO_VAL)
+		_set_job_field(data_set_null, "array_task_id");
+	else
+		_set_job_field(data_set_int, "array_task_id",
+			       job->array_task_id);
+	_set_job_field(data_set_int, "array_max_tasks", job->array_max_tasks);
+	_set_job_field(data_set_string, "array_task_string",
+		       job->array_task_str);
+	_set_job_field(data_set_int, "association_id", job->assoc_id);
+	_set_job_field(data_set_string, "batch_features", job->batch_features);
+	_set_job_field(data_set_bool, "batch_flag", job->batch_flag == 1);
+	_set_job_field(data_set_string, "batch_host", job->batch_host);
+	_set_job_field(_dump_job_bitflags, "flags", job->bitflags);
 	/* boards_per_node intentionally omitted */
-	data_set_string(data_key_set(jd, "burst_buffer"), job->burst_buffer);
-	data_set_string(data_key_set(jd, "burst_buffer_state"),
-			job->burst_buffer_state);
-	data_set_string(data_key_set(jd, "cluster"), job->cluster);
-	data_set_string(data_key_set(jd, "cluster_features"),
-			job->cluster_features);
-	data_set_string(data_key_set(jd, "command"), job->command);
-	data_set_string(data_key_set(jd, "comment"), job->comment);
+	_set_job_field(data_set_string, "burst_buffer", job->burst_buffer);
+	_set_job_field(data_set_string, "burst_buffer_state",
+		       job->burst_buffer_state);
+	_set_job_field(data_set_string, "cluster", job->cluster);
+	_set_job_field(data_set_string, "cluster_features",
+		       job->cluster_features);
+	_set_job_field(data_set_string, "command", job->command);
+	_set_job_field(data_set_string, "comment", job->comment);
 	if (job->contiguous != NO_VAL16)
-		data_set_bool(data_key_set(jd, "contiguous"),
-			      job->contiguous == 1);
+		_set_job_field(data_set_bool, "contiguous",
+			       job->contiguous == 1);
 	else
-		data_set_null(data_key_set(jd, "contiguous"));
+		_set_job_field(data_set_null, "contiguous");
 	if (job->core_spec == NO_VAL16) {
-		data_set_null(data_key_set(jd, "core_spec"));
-		data_set_null(data_key_set(jd, "thread_spec"));
+		_set_job_field(data_set_null, "core_spec");
+		_set_job_field(data_set_null, "thread_spec");
 	} else {
 		if (CORE_SPEC_THREAD & job->core_spec) {
-			data_set_int(data_key_set(jd, "core_spec"),
-				     job->core_spec);
-			data_set_null(data_key_set(jd, "thread_spec"));
+			_set_job_field(data_set_int, "core_spec",
+				       job->core_spec);
+			_set_job_field(data_set_null, "thread_spec");
 		} else {
-			data_set_int(data_key_set(jd, "thread_spec"),
-				     (job->core_spec & ~CORE_SPEC_THREAD));
-			data_set_null(data_key_set(jd, "core_spec"));
+			_set_job_field(data_set_int, "thread_spec",
+				       (job->core_spec & ~CORE_SPEC_THREAD));
+			_set_job_field(data_set_null, "core_spec");
 		}
 	}
 	if (job->cores_per_socket == NO_VAL16)
-		data_set_null(data_key_set(jd, "cores_per_socket"));
+		_set_job_field(data_set_null, "cores_per_socket");
 	else
-		data_set_int(data_key_set(jd, "cores_per_socket"),
-			     job->cores_per_socket);
+		_set_job_field(data_set_int, "cores_per_socket",
+			       job->cores_per_socket);
 	//skipped cpu_bind and cpu_bind_type per description
 	if (job->billable_tres == (double)NO_VAL)
-		data_set_null(data_key_set(jd, "billable_tres"));
+		_set_job_field(data_set_null, "billable_tres");
 	else
-		data_set_float(data_key_set(jd, "billable_tres"),
+		_set_job_field(data_set_float, "billable_tres",
 			       job->billable_tres);
 	if (job->cpu_freq_min == NO_VAL)
-		data_set_null(data_key_set(jd, "cpus_per_task"));
+		_set_job_field(data_set_null, "cpus_per_task");
 	else
-		data_set_int(data_key_set(jd, "cpus_per_task"),
-			     job->cpus_per_task);
+		_set_job_field(data_set_int, "cpus_per_task",
+			       job->cpus_per_task);
 	if (job->cpu_freq_min == NO_VAL)
-		data_set_null(data_key_set(jd, "cpu_frequency_minimum"));
+		_set_job_field(data_set_null, "cpu_frequency_minimum");
 	else
-		data_set_int(data_key_set(jd, "cpu_frequency_minumum"),
-			     job->cpu_freq_min);
+		_set_job_field(data_set_int, "cpu_frequency_minumum",
+			       job->cpu_freq_min);
 	if (job->cpu_freq_max == NO_VAL)
-		data_set_null(data_key_set(jd, "cpu_frequency_maximum"));
+		_set_job_field(data_set_null, "cpu_frequency_maximum");
 	else
-		data_set_int(data_key_set(jd, "cpu_frequency_maximum"),
-			     job->cpu_freq_max);
+		_set_job_field(data_set_int, "cpu_frequency_maximum",
+			       job->cpu_freq_max);
 	if (job->cpu_freq_gov == NO_VAL)
-		data_set_null(data_key_set(jd, "cpu_frequency_governor"));
+		_set_job_field(data_set_null, "cpu_frequency_governor");
 	else
-		data_set_int(data_key_set(jd, "cpu_frequency_governor"),
-			     job->cpu_freq_gov);
-	data_set_string(data_key_set(jd, "cpus_per_tres"), job->cpus_per_tres);
-	data_set_int(data_key_set(jd, "deadline"), job->deadline);
+		_set_job_field(data_set_int, "cpu_frequency_governor",
+			       job->cpu_freq_gov);
+	_set_job_field(data_set_string, "cpus_per_tres", job->cpus_per_tres);
+	_set_job_field(data_set_int, "deadline", job->deadline);
 	if (job->delay_boot == NO_VAL)
-		data_set_null(data_key_set(jd, "delay_boot"));
+		_set_job_field(data_set_null, "delay_boot");
 	else
-		data_set_int(data_key_set(jd, "delay_boot"), job->delay_boot);
-	data_set_string(data_key_set(jd, "dependency"), job->dependency);
-	data_set_int(data_key_set(jd, "derived_exit_code"), job->derived_ec);
-	data_set_int(data_key_set(jd, "eligible_time"), job->eligible_time);
-	data_set_int(data_key_set(jd, "end_time"), job->end_time);
-	data_set_string(data_key_set(jd, "excluded_nodes"), job->exc_nodes);
+		_set_job_field(data_set_int, "delay_boot", job->delay_boot);
+	_set_job_field(data_set_string, "dependency", job->dependency);
+	_set_job_field(data_set_int, "derived_exit_code", job->derived_ec);
+	_set_job_field(data_set_int, "eligible_time", job->eligible_time);
+	_set_job_field(data_set_int, "end_time", job->end_time);
+	_set_job_field(data_set_string, "excluded_nodes", job->exc_nodes);
 	/* exc_node_inx intentionally omitted */
-	data_set_int(data_key_set(jd, "exit_code"), job->exit_code);
-	data_set_string(data_key_set(jd, "features"), job->features);
-	data_set_string(data_key_set(jd, "federation_origin"),
-			job->fed_origin_str);
-	data_set_string(data_key_set(jd, "federation_siblings_active"),
-			job->fed_siblings_active_str);
-	data_set_string(data_key_set(jd, "federation_siblings_viable"),
-			job->fed_siblings_viable_str);
-	data_t *gres_detail = data_key_set(jd, "gres_detail");
-	data_set_list(gres_detail);
-	for (size_t i = 0; i < job->gres_detail_cnt; ++i)
-		data_set_string(data_list_append(gres_detail),
-				job->gres_detail_str[i]);
+	_set_job_field(data_set_int, "exit_code", job->exit_code);
+	_set_job_field(data_set_string, "features", job->features);
+	_set_job_field(data_set_string, "federation_origin",
+		       job->fed_origin_str);
+	_set_job_field(data_set_string, "federation_siblings_active",
+		       job->fed_siblings_active_str);
+	_set_job_field(data_set_string, "federation_siblings_viable",
+		       job->fed_siblings_viable_str);
+	if (_want_job_field("gres_detail")) {
+		data_t *gres_detail =
+			data_set_list(data_key_set(jd, "gres_detail"));
+
+		for (size_t i = 0; i < job->gres_detail_cnt; ++i)
+			data_set_string(data_list_append(gres_detail),
+					job->gres_detail_str[i]);
+	}
 	if (job->group_id == NO_VAL)
-		data_set_null(data_key_set(jd, "group_id"));
+		_set_job_field(data_set_null, "group_id");
 	else
-		data_set_int(data_key_set(jd, "group_id"), job->group_id);
+		_set_job_field(data_set_int, "group_id", job->group_id);
 	if (job->job_id == NO_VAL)
-		data_set_null(data_key_set(jd, "job_id"));
+		_set_job_field(data_set_null, "job_id");
 	else
-		data_set_int(data_key_set(jd, "job_id"), job->job_id);
-	data_t *jrsc = data_key_set(jd, "job_resources");
-	data_set_dict(jrsc);
-	if (job->job_resrcs) {
+		_set_job_field(data_set_int, "job_id", job->job_id);
+	data_t *jrsc = NULL;
+	if (_want_job_field("job_resources"))
+		jrsc = data_set_dict(data_key_set(jd, "job_resources"));
+	if (job->job_resrcs && jrsc) {
 		/* based on log_job_resources() */
 		job_resources_t *j = job->job_resrcs;
 		data_set_string(data_key_set(jrsc, "nodes"), j->nodes);
@@ -937,89 +975,87 @@ static data_t *dump_job_info(slurm_job_info_t *job, data_t *jd)
 			}
 		}
 	}
-	data_set_string(data_key_set(jd, "job_state"),
-			job_state_string(job->job_state));
-	data_set_int(data_key_set(jd, "last_sched_evaluation"), job->last_sched_eval);
-	data_set_string(data_key_set(jd, "licenses"), job->licenses);
+	_set_job_field(data_set_string, "job_state",
+		       job_state_string(job->job_state));
+	_set_job_field(data_set_int, "last_sched_evaluation",
+		       job->last_sched_eval);
+	_set_job_field(data_set_string, "licenses", job->licenses);
 	if (job->max_cpus == NO_VAL)
-		data_set_null(data_key_set(jd, "max_cpus"));
+		_set_job_field(data_set_null, "max_cpus");
 	else
-		data_set_int(data_key_set(jd, "max_cpus"), job->max_cpus);
+		_set_job_field(data_set_int, "max_cpus", job->max_cpus);
 	if (job->max_nodes == NO_VAL)
-		data_set_null(data_key_set(jd, "max_nodes"));
+		_set_job_field(data_set_null, "max_nodes");
 	else
-		data_set_int(data_key_set(jd, "max_nodes"), job->max_nodes);
-	data_set_string(data_key_set(jd, "mcs_label"), job->mcs_label);
-	data_set_string(data_key_set(jd, "memory_per_tres"), job->mem_per_tres);
-	data_set_string(data_key_set(jd, "name"), job->name);
+		_set_job_field(data_set_int, "max_nodes", job->max_nodes);
+	_set_job_field(data_set_string, "mcs_label", job->mcs_label);
+	_set_job_field(data_set_string, "memory_per_tres", job->mem_per_tres);
+	_set_job_field(data_set_string, "name", job->name);
 	/* network intentionally omitted */
-	data_set_string(data_key_set(jd, "nodes"), job->nodes);
+	_set_job_field(data_set_string, "nodes", job->nodes);
 	if (job->nice == NO_VAL || job->nice == NICE_OFFSET)
-		data_set_null(data_key_set(jd, "nice"));
+		_set_job_field(data_set_null, "nice");
 	else
-		data_set_int(data_key_set(jd, "nice"), job->nice - NICE_OFFSET);
+		_set_job_field(data_set_int, "nice", job->nice - NICE_OFFSET);
 	/* node_index intentionally omitted */
 	if (job->node_inx)
-		_dump_job_int32_list(job->node_inx,
-				     data_key_set(jd, "node_index"));
+		_set_job_field(_dump_job_int32_list, "node_index",
+			       job->node_inx);
 	else
-		data_set_null(data_key_set(jd, "node_index"));
+		_set_job_field(data_set_null, "node_index");
 	if (job->ntasks_per_core == NO_VAL16 ||
 	    job->ntasks_per_core == INFINITE16)
-		data_set_null(data_key_set(jd, "tasks_per_core"));
+		_set_job_field(data_set_null, "tasks_per_core");
 	else
-		data_set_int(data_key_set(jd, "tasks_per_core"),
-			     job->ntasks_per_core);
-	data_set_int(data_key_set(jd, "tasks_per_node"), job->ntasks_per_node);
+		_set_job_field(data_set_int, "tasks_per_core",
+			       job->ntasks_per_core);
+	_set_job_field(data_set_int, "tasks_per_node", job->ntasks_per_node);
 	if (job->ntasks_per_socket == NO_VAL16 ||
 	    job->ntasks_per_socket == INFINITE16)
-		data_set_null(data_key_set(jd, "tasks_per_socket"));
+		_set_job_field(data_set_null, "tasks_per_socket");
 	else
-		data_set_int(data_key_set(jd, "tasks_per_socket"),
-			     job->ntasks_per_socket);
-	data_set_int(data_key_set(jd, "tasks_per_board"),
-		     job->ntasks_per_board);
+		_set_job_field(data_set_int, "tasks_per_socket",
+			       job->ntasks_per_socket);
+	_set_job_field(data_set_int, "tasks_per_board", job->ntasks_per_board);
 	if (job->num_tasks != NO_VAL && job->num_tasks != INFINITE)
-		data_set_int(data_key_set(jd, "cpus"), job->num_cpus);
+		_set_job_field(data_set_int, "cpus", job->num_cpus);
 	else
-		data_set_null(data_key_set(jd, "cpus"));
-	data_set_int(data_key_set(jd, "nodes"), job->num_nodes);
+		_set_job_field(data_set_null, "cpus");
+	_set_job_field(data_set_int, "nodes", job->num_nodes);
 	if (job->num_tasks != NO_VAL && job->num_tasks != INFINITE)
-		data_set_int(data_key_set(jd, "tasks"), job->num_tasks);
+		_set_job_field(data_set_int, "tasks", job->num_tasks);
 	else
-		data_set_null(data_key_set(jd, "tasks"));
-	data_set_int(data_key_set(jd, "het_job_id"), job->het_job_id);
-	data_set_string(data_key_set(jd, "het_job_id_set"),
-			job->het_job_id_set);
-	data_set_int(data_key_set(jd, "het_job_offset"), job->het_job_offset);
-	data_set_string(data_key_set(jd, "partition"), job->partition);
+		_set_job_field(data_set_null, "tasks");
+	_set_job_field(data_set_int, "het_job_id", job->het_job_id);
+	_set_job_field(data_set_string, "het_job_id_set", job->het_job_id_set);
+	_set_job_field(data_set_int, "het_job_offset", job->het_job_offset);
+	_set_job_field(data_set_string, "partition", job->partition);
 	if (job->pn_min_memory & MEM_PER_CPU) {
-		data_set_null(data_key_set(jd, "memory_per_node"));
-		data_set_int(data_key_set(jd, "memory_per_cpu"),
-			     (job->pn_min_memory & ~MEM_PER_CPU));
+		_set_job_field(data_set_null, "memory_per_node");
+		_set_job_field(data_set_int, "memory_per_cpu",
+			       (job->pn_min_memory & ~MEM_PER_CPU));
 	} else if (job->pn_min_memory) {
-		data_set_int(data_key_set(jd, "memory_per_node"),
-			     job->pn_min_memory);
-		data_set_null(data_key_set(jd, "memory_per_cpu"));
+		_set_job_field(data_set_int, "memory_per_node",
+			       job->pn_min_memory);
+		_set_job_field(data_set_null, "memory_per_cpu");
 	} else {
-		data_set_null(data_key_set(jd, "memory_per_node"));
-		data_set_null(data_key_set(jd, "memory_per_cpu"));
+		_set_job_field(data_set_null, "memory_per_node");
+		_set_job_field(data_set_null, "memory_per_cpu");
 	}
-	data_set_int(data_key_set(jd, "minimum_cpus_per_node"), job->pn_min_cpus);
-	data_set_int(data_key_set(jd, "pn_min_tmp_disk"), job->pn_min_tmp_disk);
+	_set_job_field(data_set_int, "minimum_cpus_per_node", job->pn_min_cpus);
+	_set_job_field(data_set_int, "pn_min_tmp_disk", job->pn_min_tmp_disk);
 	/* power_flags intentionally omitted */
-	data_set_int(data_key_set(jd, "preempt_time"), job->preempt_time);
-	data_set_int(data_key_set(jd, "pre_sus_time"), job->pre_sus_time);
+	_set_job_field(data_set_int, "preempt_time", job->preempt_time);
+	_set_job_field(data_set_int, "pre_sus_time", job->pre_sus_time);
 	if (job->priority == NO_VAL || job->priority == INFINITE)
-		data_set_null(data_key_set(jd, "priority"));
+		_set_job_field(data_set_null, "priority");
 	else
-		data_set_int(data_key_set(jd, "priority"), job->priority);
+		_set_job_field(data_set_int, "priority", job->priority);
 	if (job->profile == ACCT_GATHER_PROFILE_NOT_SET)
-		data_set_null(data_key_set(jd, "profile"));
-	else {
+		_set_job_field(data_set_null, "profile");
+	else if (_want_job_field("profile")) {
 		//based on acct_gather_profile_to_string
-		data_t *profile = data_key_set(jd, "profile");
-		data_set_list(profile);
+		data_t *profile = data_set_list(data_key_set(jd, "profile"));
 
 		if (job->profile == ACCT_GATHER_PROFILE_NONE)
 			data_set_string(data_list_append(profile), "None");
@@ -1032,134 +1068,115 @@ static data_t *dump_job_info(slurm_job_info_t *job, data_t *jd)
 		if (job->profile & ACCT_GATHER_PROFILE_TASK)
 			data_set_string(data_list_append(profile), "Task");
 	}
-	data_set_string(data_key_set(jd, "qos"), job->qos);
-	data_set_bool(data_key_set(jd, "reboot"), job->reboot);
-	data_set_string(data_key_set(jd, "required_nodes"), job->req_nodes);
+	_set_job_field(data_set_string, "qos", job->qos);
+	_set_job_field(data_set_bool, "reboot", job->reboot);
+	_set_job_field(data_set_string, "required_nodes", job->req_nodes);
 	if (job->req_node_inx)
-		_dump_job_int32_list(job->req_node_inx,
-				     data_key_set(jd,
-						  "requested_node_by_index"));
+		_set_job_field(_dump_job_int32_list, "requested_node_by_index",
+			       job->req_node_inx);
 	else
-		data_set_null(data_key_set(jd, "requested_node_by_index"));
-	data_set_bool(data_key_set(jd, "requeue"), job->requeue);
-	data_set_int(data_key_set(jd, "resize_time"), job->resize_time);
-	data_set_int(data_key_set(jd, "restart_cnt"), job->restart_cnt);
-	data_set_string(data_key_set(jd, "resv_name"), job->resv_name);
+		_set_job_field(data_set_null, "requested_node_by_index");
+	_set_job_field(data_set_bool, "requeue", job->requeue);
+	_set_job_field(data_set_int, "resize_time", job->resize_time);
+	_set_job_field(data_set_int, "restart_cnt", job->restart_cnt);
+	_set_job_field(data_set_string, "resv_name", job->resv_name);
 	/* sched_nodes intentionally omitted */
 	/* select_jobinfo intentionally omitted */
 	switch (job->shared) {
 	case JOB_SHARED_NONE:
-		data_set_string(data_key_set(jd, "shared"), "none");
+		_set_job_field(data_set_string, "shared", "none");
 		break;
 	case JOB_SHARED_OK:
-		data_set_string(data_key_set(jd, "shared"), "shared");
+		_set_job_field(data_set_string, "shared", "shared");
 		break;
 	case JOB_SHARED_USER:
-		data_set_string(data_key_set(jd, "shared"), "user");
+		_set_job_field(data_set_string, "shared", "user");
 		break;
 	case JOB_SHARED_MCS:
-		data_set_string(data_key_set(jd, "shared"), "mcs");
+		_set_job_field(data_set_string, "shared", "mcs");
 		break;
 	case NO_VAL16:
-		data_set_null(data_key_set(jd, "shared"));
+		_set_job_field(data_set_null, "shared");
 		break;
 	default:
-		data_set_int(data_key_set(jd, "shared"), job->shared);
+		_set_job_field(data_set_int, "shared", job->shared);
 		xassert(false);
 		break;
 	}
-	data_t *sflags = data_key_set(jd, "show_flags");
-	data_set_list(sflags);
-	if (job->show_flags & SHOW_ALL)
-		data_set_string(data_list_append(sflags), "SHOW_ALL");
-	if (job->show_flags & SHOW_DETAIL)
-		data_set_string(data_list_append(sflags), "SHOW_DETAIL");
-	if (job->show_flags & SHOW_MIXED)
-		data_set_string(data_list_append(sflags), "SHOW_MIXED");
-	if (job->show_flags & SHOW_LOCAL)
-		data_set_string(data_list_append(sflags), "SHOW_LOCAL");
-	if (job->show_flags & SHOW_SIBLING)
-		data_set_string(data_list_append(sflags), "SHOW_SIBLING");
-	if (job->show_flags & SHOW_FEDERATION)
-		data_set_string(data_list_append(sflags), "SHOW_FEDERATION");
-	if (job->show_flags & SHOW_FUTURE)
-		data_set_string(data_list_append(sflags), "SHOW_FUTURE");
-	data_set_int(data_key_set(jd, "sockets_per_board"),
-		     job->sockets_per_board);
+	if (_want_job_field("show_flags")) {
+		data_t *sflags = data_set_list(data_key_set(jd, "show_flags"));
+
+		if (job->show_flags & SHOW_ALL)
+			data_set_string(data_list_append(sflags), "SHOW_ALL");
+		if (job->show_flags & SHOW_DETAIL)
+			data_set_string(data_list_append(sflags),
+					"SHOW_DETAIL");
+		if (job->show_flags & SHOW_MIXED)
+			data_set_string(data_list_append(sflags), "SHOW_MIXED");
+		if (job->show_flags & SHOW_LOCAL)
+			data_set_string(data_list_append(sflags), "SHOW_LOCAL");
+		if (job->show_flags & SHOW_SIBLING)
+			data_set_string(data_list_append(sflags),
+					"SHOW_SIBLING");
+		if (job->show_flags & SHOW_FEDERATION)
+			data_set_string(data_list_append(sflags),
+					"SHOW_FEDERATION");
+		if (job->show_flags & SHOW_FUTURE)
+			data_set_string(data_list_append(sflags),
+					"SHOW_FUTURE");
+	}
+	_set_job_field(data_set_int, "sockets_per_board",
+		       job->sockets_per_board);
 	if (job->sockets_per_node == NO_VAL16)
-		data_set_null(data_key_set(jd, "sockets_per_node"));
+		_set_job_field(data_set_null, "sockets_per_node");
 	else
-		data_set_int(data_key_set(jd, "sockets_per_node"),
-			     job->sockets_per_node);
-	data_set_int(data_key_set(jd, "start_time"), job->start_time);
+		_set_job_field(data_set_int, "sockets_per_node",
+			       job->sockets_per_node);
+	_set_job_field(data_set_int, "start_time", job->start_time);
 	/* start_protocol_ver intentionally omitted */
-	data_set_string(data_key_set(jd, "state_description"), job->state_desc);
-	data_set_string(data_key_set(jd, "state_reason"),
-			job_reason_string(job->state_reason));
-	data_set_string(data_key_set(jd, "standard_error"), job->std_err);
-	data_set_string(data_key_set(jd, "standard_input"), job->std_in);
-	data_set_string(data_key_set(jd, "standard_output"), job->std_out);
-	data_set_int(data_key_set(jd, "submit_time"), job->submit_time);
-	data_set_int(data_key_set(jd, "suspend_time"), job->suspend_time);
-	data_set_string(data_key_set(jd, "system_comment"),
-			job->system_comment);
+	_set_job_field(data_set_string, "state_description", job->state_desc);
+	_set_job_field(data_set_string, "state_reason",
+		       job_reason_string(job->state_reason));
+	_set_job_field(data_set_string, "standard_error", job->std_err);
+	_set_job_field(data_set_string, "standard_input", job->std_in);
+	_set_job_field(data_set_string, "standard_output", job->std_out);
+	_set_job_field(data_set_int, "submit_time", job->submit_time);
+	_set_job_field(data_set_int, "suspend_time", job->suspend_time);
+	_set_job_field(data_set_string, "system_comment", job->system_comment);
 	if (job->time_limit != INFINITE)
-		data_set_int(data_key_set(jd, "time_limit"), job->time_limit);
+		_set_job_field(data_set_int, "time_limit", job->time_limit);
 	else
-		data_set_null(data_key_set(jd, "time_limit"));
+		_set_job_field(data_set_null, "time_limit");
 	if (job->time_min != INFINITE)
-		data_set_int(data_key_set(jd, "time_minimum"), job->time_min);
+		_set_job_field(data_set_int, "time_minimum", job->time_min);
 	else
-		data_set_null(data_key_set(jd, "time_minimum"));
+		_set_job_field(data_set_null, "time_minimum");
 	if (job->threads_per_core == NO_VAL16)
-		data_set_null(data_key_set(jd, "threads_per_core"));
+		_set_job_field(data_set_null, "threads_per_core");
 	else
-		data_set_int(data_key_set(jd, "threads_per_core"),
-			     job->threads_per_core);
-	data_set_string(data_key_set(jd, "tres_bind"), job->tres_bind);
-	data_set_string(data_key_set(jd, "tres_freq"), job->tres_freq);
-	data_set_string(data_key_set(jd, "tres_per_job"), job->tres_per_job);
-	data_set_string(data_key_set(jd, "tres_per_node"), job->tres_per_node);
-	data_set_string(data_key_set(jd, "tres_per_socket"),
-			job->tres_per_socket);
-	data_set_string(data_key_set(jd, "tres_per_task"), job->tres_per_task);
-	data_set_string(data_key_set(jd, "tres_req_str"), job->tres_req_str);
-	data_set_string(data_key_set(jd, "tres_alloc_str"),
-			job->tres_alloc_str);
-	data_set_int(data_key_set(jd, "user_id"), job->user_id);
-	data_set_string(data_key_set(jd, "user_name"), job->user_name);
+		_set_job_field(data_set_int, "threads_per_core",
+			       job->threads_per_core);
+	_set_job_field(data_set_string, "tres_bind", job->tres_bind);
+	_set_job_field(data_set_string, "tres_freq", job->tres_freq);
+	_set_job_field(data_set_string, "tres_per_job", job->tres_per_job);
+	_set_job_field(data_set_string, "tres_per_node", job->tres_per_node);
+	_set_job_field(data_set_string, "tres_per_socket",
+		       job->tres_per_socket);
+	_set_job_field(data_set_string, "tres_per_task", job->tres_per_task);
+	_set_job_field(data_set_string, "tres_req_str", job->tres_req_str);
+	_set_job_field(data_set_string, "tres_alloc_str", job->tres_alloc_str);
+	_set_job_field(data_set_int, "user_id", job->user_id);
+	_set_job_field(data_set_string, "user_name", job->user_name);
 	/* wait4switch intentionally omitted */
-	data_set_string(data_key_set(jd, "wckey"), job->wckey);
-	data_set_string(data_key_set(jd, "current_working_directory"),
-			job->work_dir);
+	_set_job_field(data_set_string, "wckey", job->wckey);
+	_set_job_field(data_set_string, "current_working_directory",
+		       job->work_dir);
 
 	return jd;
 }
 
-static int _op_handler_jobs(const char *context_id,
-			    http_request_method_t method,
-			    data_t *parameters, data_t *query, int tag,
-			    data_t *resp, void *auth)
-{
-	int rc = SLURM_SUCCESS;
-	job_info_msg_t *job_info_ptr = NULL;
-
-	data_set_list(resp);
-	debug4("%s: jobs handler called by %s", __func__, context_id);
-
-	rc = slurm_load_jobs((time_t)NULL, &job_info_ptr,
-			     SHOW_ALL|SHOW_DETAIL);
-
-	if (rc == SLURM_SUCCESS && job_info_ptr &&
-	    job_info_ptr->record_count)
-		for (size_t i = 0; i < job_info_ptr->record_count; ++i)
-			dump_job_info(job_info_ptr->job_array + i,
-				      data_list_append(resp));
-
-	slurm_free_job_info_msg(job_info_ptr);
-
-	return rc;
-}
+#undef _set_job_field
+#undef _want_job_field
 
 #define _job_error(...)                                                      \
 	do {                                                                 \
@@ -1177,6 +1194,360 @@ static int _op_handler_jobs(const char *context_id,
 		data_set_int(data_key_set(error, "error_code"), errno);      \
 	} while (0)
 
+/* filters from query of GET /jobs/ */
+typedef struct {
+	job_info_filter_t info; /* user_ids, accounts, partitions and states
+				 * for slurmctld or NULL for all jobs */
+	data_t *fields; /* dictionary of fields to dump or NULL for all */
+	uint32_t after; /* only dump jobs with a larger job_id */
+	uint32_t limit; /* most jobs to dump or 0 for all */
+} job_filter_t;
+
+/* JOB_FIELD_* group of job_info_t read for each dumped field */
+static const struct {
+	const char *field;
+	uint32_t group;
+} job_field_groups[] = {
+	{ "admin_comment", JOB_FIELD_COMMENT },
+	{ "batch_features", JOB_FIELD_FEATURES },
+	{ "cluster_features", JOB_FIELD_FEATURES },
+	{ "command", JOB_FIELD_COMMAND },
+	{ "comment", JOB_FIELD_COMMENT },
+	{ "cpus_per_tres", JOB_FIELD_TRES },
+	{ "current_working_directory", JOB_FIELD_WORK_DIR },
+	{ "dependency", JOB_FIELD_DEPENDENCY },
+	{ "excluded_nodes", JOB_FIELD_EXC_NODES },
+	{ "features", JOB_FIELD_FEATURES },
+	{ "federation_origin", JOB_FIELD_FED },
+	{ "federation_siblings_active", JOB_FIELD_FED },
+	{ "federation_siblings_viable", JOB_FIELD_FED },
+	{ "memory_per_tres", JOB_FIELD_TRES },
+	{ "node_index", JOB_FIELD_NODE_INX },
+	{ "required_nodes", JOB_FIELD_REQ_NODES },
+	{ "requested_node_by_index", JOB_FIELD_REQ_NODES },
+	{ "standard_error", JOB_FIELD_STD_IO },
+	{ "standard_input", JOB_FIELD_STD_IO },
+	{ "standard_output", JOB_FIELD_STD_IO },
+	{ "system_comment", JOB_FIELD_COMMENT },
+	{ "tres_alloc_str", JOB_FIELD_TRES },
+	{ "tres_bind", JOB_FIELD_TRES },
+	{ "tres_freq", JOB_FIELD_TRES },
+	{ "tres_per_job", JOB_FIELD_TRES },
+	{ "tres_per_node", JOB_FIELD_TRES },
+	{ "tres_per_socket", JOB_FIELD_TRES },
+	{ "tres_per_task", JOB_FIELD_TRES },
+	{ "tres_req_str", JOB_FIELD_TRES },
+};
+
+/*
+ * Return JOB_FIELD_* groups no requested field reads so slurmctld can leave
+ * them out. sched_nodes, gres_used and mail_user are never dumped.
+ */
+static uint32_t _job_skip_fields(const data_t *fields)
+{
+	uint32_t skip_fields = JOB_FIELD_COMMAND | JOB_FIELD_WORK_DIR |
+		JOB_FIELD_STD_IO | JOB_FIELD_COMMENT | JOB_FIELD_FEATURES |
+		JOB_FIELD_DEPENDENCY | JOB_FIELD_TRES | JOB_FIELD_NODE_INX |
+		JOB_FIELD_REQ_NODES | JOB_FIELD_EXC_NODES | JOB_FIELD_FED |
+		JOB_FIELD_SCHED_NODES | JOB_FIELD_GRES | JOB_FIELD_MAIL;
+
+	for (int i = 0; i < ARRAY_SIZE(job_field_groups); i++)
+		if (!fields ||
+		    data_key_get_const(fields, job_field_groups[i].field))
+			skip_fields &= ~job_field_groups[i].group;
+
+	return skip_fields;
+}
+
+typedef struct {
+	const char *context_id;
+	job_filter_t *filter;
+	data_t *resp;
+	data_t *errors;
+	int rc;
+} parse_job_filter_t;
+
+static int _parse_job_filter_uint32(const data_t *data, uint32_t *ptr)
+{
+	int64_t value;
+
+	if (data_get_int_converted(data, &value) || (value < 0) ||
+	    (value >= NO_VAL))
+		return ESLURM_REST_INVALID_QUERY;
+
+	*ptr = value;
+	return SLURM_SUCCESS;
+}
+
+static int _parse_job_filter_states(job_filter_t *filter, char *str)
+{
+	char *save_ptr = NULL;
+
+	for (char *tok = strtok_r(str, ",", &save_ptr); tok;
+	     tok = strtok_r(NULL, ",", &save_ptr)) {
+		uint32_t *state, state_num = job_state_num(tok);
+
+		if (state_num == NO_VAL)
+			return ESLURM_REST_INVALID_QUERY;
+
+		if (!filter->info.states)
+			filter->info.states = list_create(xfree_ptr);
+		state = xmalloc(sizeof(*state));
+		*state = state_num;
+		list_append(filter->info.states, state);
+	}
+
+	return SLURM_SUCCESS;
+}
+
+static void _parse_job_filter_fields(job_filter_t *filter, char *str)
+{
+	char *save_ptr = NULL;
+
+	if (!filter->fields) {
+		filter->fields = data_set_dict(data_new());
+		/* job_id is always needed to get the next page */
+		data_set_null(data_key_set(filter->fields, "job_id"));
+	}
+
+	for (char *tok = strtok_r(str, ",", &save_ptr); tok;
+	     tok = strtok_r(NULL, ",", &save_ptr))
+		data_set_null(data_key_set(filter->fields, tok));
+}
+
+static data_for_each_cmd_t _parse_job_filter(const char *key,
+					     const data_t *data, void *arg)
+{
+	parse_job_filter_t *args = arg;
+	job_filter_t *filter = args->filter;
+	data_t *errors = args->errors;
+	char *str = NULL;
+	int rc = SLURM_SUCCESS;
+
+	if (!xstrcasecmp(key, "after")) {
+		rc = _parse_job_filter_uint32(data, &filter->after);
+	} else if (!xstrcasecmp(key, "limit")) {
+		rc = _parse_job_filter_uint32(data, &filter->limit);
+	} else if (!xstrcasecmp(key, "user") || !xstrcasecmp(key, "account") ||
+		   !xstrcasecmp(key, "partition") ||
+		   !xstrcasecmp(key, "state") || !xstrcasecmp(key, "fields")) {
+		if (data_get_string_converted(data, &str) || !str || !str[0])
+			rc = ESLURM_REST_INVALID_QUERY;
+	} else {
+		debug("%s: [%s] ignoring unknown query parameter %s",
+		      __func__, args->context_id, key);
+		return DATA_FOR_EACH_CONT;
+	}
+
+	if (rc || !str) {
+	} else if (!xstrcasecmp(key, "user")) {
+		uid_t uid;
+
+		if (uid_from_string(str, &uid)) {
+			rc = ESLURM_USER_ID_MISSING;
+		} else {
+			uint32_t *user_id = xmalloc(sizeof(*user_id));
+
+			*user_id = uid;
+			filter->info.user_ids = list_create(xfree_ptr);
+			list_append(filter->info.user_ids, user_id);
+		}
+	} else if (!xstrcasecmp(key, "account")) {
+		if (!filter->info.accounts)
+			filter->info.accounts = list_create(xfree_ptr);
+		slurm_addto_char_list(filter->info.accounts, str);
+	} else if (!xstrcasecmp(key, "partition")) {
+		if (!filter->info.partitions)
+			filter->info.partitions = list_create(xfree_ptr);
+		/* partition names are case sensitive */
+		slurm_addto_char_list_with_case(filter->info.partitions, str,
+						false);
+	} else if (!xstrcasecmp(key, "state")) {
+		rc = _parse_job_filter_states(filter, str);
+	} else if (!xstrcasecmp(key, "fields")) {
+		_parse_job_filter_fields(filter, str);
+	}
+
+	xfree(str);
+
+	if (rc) {
+		if (!errors)
+			errors = args->errors = data_set_list(
+				data_key_set(data_set_dict(args->resp),
+					     "errors"));
+
+		errno = rc;
+		_job_error("%s: [%s] invalid query parameter %s: %s",
+			   __func__, args->context_id, key,
+			   slurm_strerror(rc));
+		args->rc = rc;
+	}
+
+	return DATA_FOR_EACH_CONT;
+}
+
+static void _free_job_filter(job_filter_t *filter)
+{
+	FREE_NULL_LIST(filter->info.user_ids);
+	FREE_NULL_LIST(filter->info.accounts);
+	FREE_NULL_LIST(filter->info.partitions);
+	FREE_NULL_LIST(filter->info.states);
+	FREE_NULL_DATA(filter->fields);
+}
+
+static int _find_uint32(void *x, void *key)
+{
+	return (*(uint32_t *) x == *(uint32_t *) key);
+}
+
+static int _find_job_state(void *x, void *key)
+{
+	uint32_t state = *(uint32_t *) x, job_state = *(uint32_t *) key;
+
+	if (state & JOB_STATE_FLAGS)
+		return ((job_state & state) != 0);
+	return ((job_state & JOB_STATE_BASE) == state);
+}
+
+static int _find_partition(void *x, void *key)
+{
+	const char *part = x;
+	const char *job_parts = key;
+	size_t len = strlen(part);
+
+	/* pending jobs may have been submitted to multiple partitions */
+	for (const char *p = job_parts; p; p = xstrchr(p, ',')) {
+		if (*p == ',')
+			p++;
+		if (!strncmp(p, part, len) && ((p[len] == ',') || !p[len]))
+			return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Test if job matches filter. slurmctld applies the same filter, but one
+ * older than 20.11 ignores it and sends every job.
+ */
+static bool _match_job_filter(const job_filter_t *filter,
+			      slurm_job_info_t *job)
+{
+	uint32_t job_state = job->job_state & ~JOB_UPDATE_DB;
+
+	if (job->job_id <= filter->after)
+		return false;
+
+	if (filter->info.user_ids &&
+	    !list_find_first(filter->info.user_ids, _find_uint32,
+			     &job->user_id))
+		return false;
+
+	if (filter->info.accounts &&
+	    (!job->account ||
+	     !list_find_first(filter->info.accounts, slurm_find_char_in_list,
+			      job->account)))
+		return false;
+
+	if (filter->info.partitions &&
+	    (!job->partition ||
+	     !list_find_first(filter->info.partitions, _find_partition,
+			      job->partition)))
+		return false;
+
+	if (filter->info.states &&
+	    !list_find_first(filter->info.states, _find_job_state, &job_state))
+		return false;
+
+	return true;
+}
+
+static int _sort_job_id(const void *x, const void *y)
+{
+	const slurm_job_info_t *job1 = *(slurm_job_info_t **) x;
+	const slurm_job_info_t *job2 = *(slurm_job_info_t **) y;
+
+	if (job1->job_id < job2->job_id)
+		return -1;
+	if (job1->job_id > job2->job_id)
+		return 1;
+	return 0;
+}
+
+static int _op_handler_jobs(const char *context_id,
+			    http_request_method_t method,
+			    data_t *parameters, data_t *query, int tag,
+			    data_t *resp, void *auth)
+{
+	int rc = SLURM_SUCCESS;
+	job_info_msg_t *job_info_ptr = NULL;
+	uint64_t version;
+	bool cached = false;
+	job_filter_t filter = { { 0 } };
+	parse_job_filter_t parse_args = {
+		.context_id = context_id,
+		.filter = &filter,
+		.resp = resp,
+	};
+	slurm_job_info_t **jobs = NULL;
+	uint32_t count = 0;
+
+	debug4("%s: jobs handler called by %s", __func__, context_id);
+
+	if (query && (data_get_type(query) == DATA_TYPE_DICT))
+		(void) data_dict_for_each_const(query, _parse_job_filter,
+						&parse_args);
+	if ((rc = parse_args.rc))
+		goto cleanup;
+
+	if (filter.info.user_ids || filter.info.accounts ||
+	    filter.info.partitions || filter.info.states || filter.fields) {
+		/* slurmctld only packs the jobs and fields to be dumped */
+		filter.info.skip_fields = _job_skip_fields(filter.fields);
+		rc = slurm_load_jobs_filter(0, &job_info_ptr,
+					    SHOW_ALL|SHOW_DETAIL,
+					    &filter.info);
+	} else {
+		cached = true;
+		rc = load_cache_jobs(auth, SHOW_ALL|SHOW_DETAIL, &job_info_ptr,
+				     &version);
+
+		if (rc == SLURM_SUCCESS && operations_response_cached(version))
+			goto cleanup;
+	}
+
+	data_set_list(resp);
+
+	if (rc || !job_info_ptr || !job_info_ptr->record_count)
+		goto cleanup;
+
+	jobs = xcalloc(job_info_ptr->record_count, sizeof(*jobs));
+	for (uint32_t i = 0; i < job_info_ptr->record_count; i++)
+		if (_match_job_filter(&filter, &job_info_ptr->job_array[i]))
+			jobs[count++] = &job_info_ptr->job_array[i];
+
+	if (filter.limit) {
+		/* pages are in job_id order to make "after" a cursor */
+		qsort(jobs, count, sizeof(*jobs), _sort_job_id);
+
+		if (count > filter.limit)
+			count = filter.limit;
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+		dump_job_info(jobs[i], data_list_append(resp), filter.fields);
+
+cleanup:
+	xfree(jobs);
+	if (cached)
+		load_cache_release(job_info_ptr);
+	else
+		slurm_free_job_info_msg(job_info_ptr);
+	_free_job_filter(&filter);
+
+	return rc;
+}
+
 static int _handle_job_get(const char *context_id, http_request_method_t method,
 			   data_t *parameters, data_t *query, int tag,
 			   data_t *resp, const uint32_t job_id,
@@ -1189,7 +1560,8 @@ static int _handle_job_get(const char *context_id, http_request_method_t method,
 	if (rc == SLURM_SUCCESS && job_info_ptr &&
 	    job_info_ptr->record_count)
 		for (size_t i = 0; i < job_info_ptr->record_count; ++i)
-			dump_job_info(job_info_ptr->job_array + i, resp);
+			dump_job_info(job_info_ptr->job_array + i, resp,
+				      NULL);
 	else
 		_job_error("%s: unknown job %d", __func__, job_id);
 
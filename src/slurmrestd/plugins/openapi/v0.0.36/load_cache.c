@@ -0,0 +1,338 @@
+/*****************************************************************************\
+ *  load_cache.c - Slurm REST API cache of slurmctld load results
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#include "config.h"
+
+#include <pthread.h>
+
+#include "slurm/slurm.h"
+#include "slurm/slurm_errno.h"
+
+#include "src/common/list.h"
+#include "src/common/log.h"
+#include "src/common/macros.h"
+#include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "src/slurmrestd/rest_auth.h"
+
+#include "src/slurmrestd/plugins/openapi/v0.0.36/load_cache.h"
+
+/* most users and show flags combinations to keep results for */
+#define MAX_CACHED_LOADS 128
+
+#define MAGIC_LOADED 0xDAF0A1D3
+
+typedef enum {
+	LOAD_JOBS = 1,
+	LOAD_NODES,
+	LOAD_PARTITIONS,
+} load_type_t;
+
+/* result of one RPC shared by all the requests using it */
+typedef struct {
+	int magic;
+	load_type_t type;
+	void *msg;
+	time_t last_update;
+	uint64_t version;
+	int refs; /* requests using msg plus one if still cached */
+} loaded_t;
+
+typedef struct {
+	load_type_t type;
+	char *user_name;
+	uint16_t show_flags;
+	loaded_t *loaded; /* most recent result */
+	time_t last_used;
+} cache_entry_t;
+
+typedef struct {
+	load_type_t type;
+	const char *user_name;
+	uint16_t show_flags;
+} cache_key_t;
+
+static pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static List cache = NULL; /* list of cache_entry_t */
+static List loaded = NULL; /* list of loaded_t still referenced */
+static uint64_t last_version = 0;
+
+/* Drop a reference to a result. cache_lock must be held. */
+static void _release(loaded_t *l)
+{
+	xassert(l->magic == MAGIC_LOADED);
+	xassert(l->refs > 0);
+
+	if (--l->refs)
+		return;
+
+	switch (l->type) {
+	case LOAD_JOBS:
+		slurm_free_job_info_msg(l->msg);
+		break;
+	case LOAD_NODES:
+		slurm_free_node_info_msg(l->msg);
+		break;
+	case LOAD_PARTITIONS:
+		slurm_free_partition_info_msg(l->msg);
+		break;
+	}
+
+	list_delete_ptr(loaded, l);
+	l->magic = ~MAGIC_LOADED;
+	xfree(l);
+}
+
+static void _free_cache_entry(void *x)
+{
+	cache_entry_t *entry = x;
+
+	if (entry->loaded)
+		_release(entry->loaded);
+	xfree(entry->user_name);
+	xfree(entry);
+}
+
+static int _find_cache_entry(void *x, void *key)
+{
+	cache_entry_t *entry = x;
+	cache_key_t *k = key;
+
+	return ((entry->type == k->type) &&
+		(entry->show_flags == k->show_flags) &&
+		!xstrcmp(entry->user_name, k->user_name));
+}
+
+static int _find_loaded_msg(void *x, void *key)
+{
+	return (((loaded_t *) x)->msg == key);
+}
+
+static int _find_oldest(void *x, void *arg)
+{
+	cache_entry_t *entry = x, **oldest = arg;
+
+	if (!*oldest || (entry->last_used < (*oldest)->last_used))
+		*oldest = entry;
+
+	return 0;
+}
+
+/* Find or add cache entry. cache_lock must be held. */
+static cache_entry_t *_get_cache_entry(cache_key_t *key)
+{
+	cache_entry_t *entry;
+
+	if (!cache) {
+		cache = list_create(_free_cache_entry);
+		loaded = list_create(NULL);
+	}
+
+	if (!(entry = list_find_first(cache, _find_cache_entry, key))) {
+		if (list_count(cache) >= MAX_CACHED_LOADS) {
+			cache_entry_t *oldest = NULL;
+
+			list_for_each(cache, _find_oldest, &oldest);
+			list_delete_ptr(cache, oldest);
+		}
+
+		entry = xmalloc(sizeof(*entry));
+		entry->type = key->type;
+		entry->user_name = xstrdup(key->user_name);
+		entry->show_flags = key->show_flags;
+		list_append(cache, entry);
+	}
+
+	entry->last_used = time(NULL);
+
+	return entry;
+}
+
+static int _rpc(load_type_t type, time_t update_time, uint16_t show_flags,
+		void **msg, time_t *last_update)
+{
+	int rc = SLURM_ERROR;
+
+	switch (type) {
+	case LOAD_JOBS:
+	{
+		job_info_msg_t *jobs = NULL;
+
+		if (!(rc = slurm_load_jobs(update_time, &jobs, show_flags))) {
+			*msg = jobs;
+			*last_update = jobs->last_update;
+		}
+		break;
+	}
+	case LOAD_NODES:
+	{
+		node_info_msg_t *nodes = NULL;
+
+		if (!(rc = slurm_load_node(update_time, &nodes, show_flags))) {
+			*msg = nodes;
+			*last_update = nodes->last_update;
+		}
+		break;
+	}
+	case LOAD_PARTITIONS:
+	{
+		partition_info_msg_t *parts = NULL;
+
+		if (!(rc = slurm_load_partitions(update_time, &parts,
+						 show_flags))) {
+			*msg = parts;
+			*last_update = parts->last_update;
+		}
+		break;
+	}
+	}
+
+	if (rc && !(rc = slurm_get_errno()))
+		rc = SLURM_ERROR;
+
+	return rc;
+}
+
+static int _load(load_type_t type, void *auth, uint16_t show_flags,
+		 void **msg, uint64_t *version)
+{
+	rest_auth_context_t *ctxt = auth;
+	cache_key_t key = {
+		.type = type,
+		.user_name = (ctxt ? ctxt->user_name : NULL),
+		.show_flags = show_flags,
+	};
+	cache_entry_t *entry;
+	loaded_t *old, *new = NULL;
+	void *new_msg = NULL;
+	time_t last_update = 0;
+	int rc;
+
+	*msg = NULL;
+	*version = 0;
+
+	slurm_mutex_lock(&cache_lock);
+	entry = _get_cache_entry(&key);
+	if ((old = entry->loaded))
+		old->refs++;
+	slurm_mutex_unlock(&cache_lock);
+
+	/* slurmctld checks the user every time even if nothing changed */
+	rc = _rpc(type, (old ? old->last_update : 0), show_flags, &new_msg,
+		  &last_update);
+
+	slurm_mutex_lock(&cache_lock);
+	if (!rc) {
+		new = xmalloc(sizeof(*new));
+		new->magic = MAGIC_LOADED;
+		new->type = type;
+		new->msg = new_msg;
+		new->last_update = last_update;
+		new->version = ++last_version;
+		new->refs = 1;
+		list_append(loaded, new);
+
+		/* entry may have been evicted or updated while unlocked */
+		entry = _get_cache_entry(&key);
+		if (!entry->loaded ||
+		    (entry->loaded->version < new->version)) {
+			if (entry->loaded)
+				_release(entry->loaded);
+			entry->loaded = new;
+			new->refs++;
+		}
+
+		if (old)
+			_release(old);
+
+		*msg = new->msg;
+		*version = new->version;
+	} else if (old && (rc == SLURM_NO_CHANGE_IN_DATA)) {
+		debug3("%s: reusing result for %s from %ld",
+		       __func__, key.user_name, old->last_update);
+		rc = SLURM_SUCCESS;
+		*msg = old->msg;
+		*version = old->version;
+	} else if (old) {
+		_release(old);
+	}
+	slurm_mutex_unlock(&cache_lock);
+
+	return rc;
+}
+
+extern int load_cache_jobs(void *auth, uint16_t show_flags,
+			   job_info_msg_t **msg, uint64_t *version)
+{
+	return _load(LOAD_JOBS, auth, show_flags, (void **) msg, version);
+}
+
+extern int load_cache_nodes(void *auth, uint16_t show_flags,
+			    node_info_msg_t **msg, uint64_t *version)
+{
+	return _load(LOAD_NODES, auth, show_flags, (void **) msg, version);
+}
+
+extern int load_cache_partitions(void *auth, uint16_t show_flags,
+				 partition_info_msg_t **msg,
+				 uint64_t *version)
+{
+	return _load(LOAD_PARTITIONS, auth, show_flags, (void **) msg,
+		     version);
+}
+
+extern void load_cache_release(void *msg)
+{
+	loaded_t *l;
+
+	if (!msg)
+		return;
+
+	slurm_mutex_lock(&cache_lock);
+	if (!(l = list_find_first(loaded, _find_loaded_msg, msg)))
+		fatal_abort("%s: unknown result %p", __func__, msg);
+	_release(l);
+	slurm_mutex_unlock(&cache_lock);
+}
+
+extern void load_cache_fini(void)
+{
+	slurm_mutex_lock(&cache_lock);
+	FREE_NULL_LIST(cache);
+	FREE_NULL_LIST(loaded);
+	slurm_mutex_unlock(&cache_lock);
+}
@@ -0,0 +1,78 @@
+/*****************************************************************************\
+ *  load_cache.h - Slurm REST API cache of slurmctld load results
+ *****************************************************************************
+ *  Copyright (C) 2020 SchedMD LLC.
+ *
+ *  This file is part of Slurm, a resource management program.
+ *  For details, see <https://slurm.schedmd.com/>.
+ *  Please also read the included file: DISCLAIMER.
+ *
+ *  Slurm is free software; you can redistribute it and/or modify it under
+ *  the terms of the GNU General Public License as published by the Free
+ *  Software Foundation; either version 2 of the License, or (at your option)
+ *  any later version.
+ *
+ *  In addition, as a special exception, the copyright holders give permission
+ *  to link the code of portions of this program with the OpenSSL library under
+ *  certain conditions as described in each individual source file, and
+ *  distribute linked combinations including the two. You must obey the GNU
+ *  General Public License in all respects for all of the code used other than
+ *  OpenSSL. If you modify file(s) with this exception, you may extend this
+ *  exception to your version of the file(s), but you are not obligated to do
+ *  so. If you do not wish to do so, delete this exception statement from your
+ *  version.  If you delete this exception statement from all source files in
+ *  the program, then also delete it here.
+ *
+ *  Slurm is distributed in the hope that it will be useful, but WITHOUT ANY
+ *  WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ *  FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+ *  details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with Slurm; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA.
+\*****************************************************************************/
+
+#ifndef SLURMRESTD_OPENAPI_V0036_LOAD_CACHE_H
+#define SLURMRESTD_OPENAPI_V0036_LOAD_CACHE_H
+
+#include "slurm/slurm.h"
+
+/*
+ * The most recent jobs, nodes and partitions loaded from slurmctld are kept
+ * for each user and set of show flags. Every load still sends an RPC to
+ * slurmctld as the requesting user but passes the update time of the kept
+ * result so slurmctld only has to send everything again if something
+ * changed. Results are shared between requests and must not be modified.
+ *
+ * Each result gets a version that is different from any other result, even
+ * ones loaded in the same second, for operations_response_cached().
+ */
+
+/*
+ * Load all jobs visible to user of request
+ * IN auth - authentication context of request
+ * IN show_flags - SHOW_* flags for slurm_load_jobs()
+ * OUT msg - jobs (release with load_cache_release())
+ * OUT version - version of jobs
+ * RET SLURM_SUCCESS or error
+ */
+extern int load_cache_jobs(void *auth, uint16_t show_flags,
+			   job_info_msg_t **msg, uint64_t *version);
+
+/* Same as load_cache_jobs() but for slurm_load_node() */
+extern int load_cache_nodes(void *auth, uint16_t show_flags,
+			    node_info_msg_t **msg, uint64_t *version);
+
+/* Same as load_cache_jobs() but for slurm_load_partitions() */
+extern int load_cache_partitions(void *auth, uint16_t show_flags,
+				 partition_info_msg_t **msg,
+				 uint64_t *version);
+
+/* Release result of load_cache_*() */
+extern void load_cache_release(void *msg);
+
+/* Free all cached results */
+extern void load_cache_fini(void);
+
+#endif /* SLURMRESTD_OPENAPI_V0036_LOAD_CACHE_H */
@@ -55,6 +55,8 @@
 #include "src/slurmrestd/operations.h"
 #include "src/slurmrestd/xjson.h"
 
+#include "src/slurmrestd/plugins/openapi/v0.0.36/load_cache.h"
+
 typedef enum {
 	URL_TAG_UNKNOWN = 0,
 	URL_TAG_NODE,
@@ -160,9 +162,16 @@ static int _op_handler_nodes(const char *context_id,
 	data_t *nodes = data_set_list(data_key_set(d, "nodes"));
 	node_info_msg_t *node_info_ptr = NULL;
 
-	if (tag == URL_TAG_NODES)
-		rc = slurm_load_node(0, &node_info_ptr, SHOW_ALL|SHOW_DETAIL);
-	else if (tag == URL_TAG_NODE) {
+	if (tag == URL_TAG_NODES) {
+		uint64_t version;
+
+		rc = load_cache_nodes(auth, SHOW_ALL|SHOW_DETAIL,
+				      &node_info_ptr, &version);
+		if (!rc && operations_response_cached(version)) {
+			load_cache_release(node_info_ptr);
+			return rc;
+		}
+	} else if (tag == URL_TAG_NODE) {
 		const data_t *node_name = data_key_get_const(parameters,
 							     "node_name");
 		char *name = NULL;
@@ -192,7 +201,10 @@ static int _op_handler_nodes(const char *context_id,
 		data_set_int(data_key_set(e, "errno"), rc);
 	}
 
-	slurm_free_node_info_msg(node_info_ptr);
+	if (tag == URL_TAG_NODES)
+		load_cache_release(node_info_ptr);
+	else
+		slurm_free_node_info_msg(node_info_ptr);
 	return rc;
 }
 
@@ -53,6 +53,8 @@
 #include "src/slurmrestd/operations.h"
 #include "src/slurmrestd/xjson.h"
 
+#include "src/slurmrestd/plugins/openapi/v0.0.36/load_cache.h"
+
 typedef enum {
 	URL_TAG_UNKNOWN = 0,
 	URL_TAG_PARTITION,
@@ -173,6 +175,7 @@ static int _op_handler_partitions(const char *context_id,
 	data_t *partitions = data_set_list(data_key_set(d, "partitions"));
 	char *name = NULL;
 	partition_info_msg_t *part_info_ptr = NULL;
+	uint64_t version;
 
 	if (tag == URL_TAG_PARTITION) {
 		const data_t *part_name = data_key_get_const(parameters,
@@ -183,7 +186,11 @@ static int _op_handler_partitions(const char *context_id,
 	}
 
 	if (!rc)
-		rc = slurm_load_partitions(0, &part_info_ptr, SHOW_ALL);
+		rc = load_cache_partitions(auth, SHOW_ALL, &part_info_ptr,
+					   &version);
+
+	if (!rc && operations_response_cached(version))
+		goto cleanup;
 
 	if (!rc && part_info_ptr) {
 		int found = 0;
@@ -212,7 +219,8 @@ static int _op_handler_partitions(const char *context_id,
 		data_set_int(data_key_set(e, "errno"), rc);
 	}
 
-	slurm_free_partition_info_msg(part_info_ptr);
+cleanup:
+	load_cache_release(part_info_ptr);
 	xfree(name);
 	return rc;
 }
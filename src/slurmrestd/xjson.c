@@ -36,10 +36,14 @@
 
 #include "config.h"
 
+#include <math.h>
+
 #include "slurm/slurm.h"
 
 #include "src/common/log.h"
+#include "src/common/pack.h"
 #include "src/common/xassert.h"
+#include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
 
 #include "src/slurmrestd/xjson.h"
@@ -52,8 +56,6 @@
 #include <json/json.h>
 #endif
 
-static json_object *_data_to_json(const data_t *d);
-
 static json_object *_try_parse(const char *buffer, size_t stringlen,
 			       struct json_tokener *tok)
 {
@@ -144,114 +146,273 @@ extern data_t *parse_json(const char *buffer, size_t len)
 	return data;
 }
 
-static data_for_each_cmd_t _convert_dict_json(const char *key,
-					      const data_t *data,
-					      void *arg)
+#else /* HAVE_JSON */
+
+extern data_t *parse_json(const char *buf, size_t len)
+{
+	error("%s: JSON support not compiled", __func__);
+	return NULL;
+}
+
+#endif /* HAVE_JSON */
+
+/*
+ * JSON is written directly from the data_t tree instead of through json-c
+ * which needs a copy of the whole tree as json objects and then the whole
+ * output as a string before it can be sent anywhere. Output is staged in a
+ * small buffer and handed to the writer callback as it fills.
+ */
+#define JSON_STAGE_BYTES 4096
+
+typedef struct {
+	dump_json_flags_t flags;
+	int (*write_func)(void *arg, const char *buf, size_t len);
+	void *arg;
+	int rc;
+	int depth;
+	bool first; /* no entry written yet in current dict or list */
+	size_t len;
+	char buf[JSON_STAGE_BYTES];
+} json_emit_t;
+
+static int _dump_data(const data_t *d, json_emit_t *e);
+
+static void _flush(json_emit_t *e)
+{
+	if (!e->rc && e->len)
+		e->rc = e->write_func(e->arg, e->buf, e->len);
+	e->len = 0;
+}
+
+static void _emit(json_emit_t *e, const char *str, size_t len)
 {
-	json_object *jobj = arg;
-	json_object *jobject = _data_to_json(data);
+	if (e->rc)
+		return;
+
+	if (len > (sizeof(e->buf) - e->len))
+		_flush(e);
+
+	if (len >= sizeof(e->buf)) {
+		if (!e->rc)
+			e->rc = e->write_func(e->arg, str, len);
+		return;
+	}
+
+	memcpy(e->buf + e->len, str, len);
+	e->len += len;
+}
 
-	json_object_object_add(jobj, key, jobject);
+#define _emit_str(e, str) _emit(e, str, strlen(str))
+
+static void _emit_indent(json_emit_t *e)
+{
+	static const char spaces[] = "                                ";
+	int indent = e->depth * 2;
+
+	if (!(e->flags & DUMP_JSON_FLAGS_PRETTY))
+		return;
+
+	_emit(e, "\n", 1);
+	while (indent > 0) {
+		int len = MIN(indent, sizeof(spaces) - 1);
+
+		_emit(e, spaces, len);
+		indent -= len;
+	}
+}
+
+/* Write quoted string, escaped per RFC8259 */
+static void _emit_string(json_emit_t *e, const char *str)
+{
+	const char *start;
+
+	_emit(e, "\"", 1);
+
+	for (start = str; str && *str; str++) {
+		unsigned char c = *str;
+		char esc[8];
+
+		if ((c >= 0x20) && (c != '"') && (c != '\\'))
+			continue;
+
+		_emit(e, start, (str - start));
+		start = str + 1;
+
+		switch (c) {
+		case '"':
+			_emit(e, "\\\"", 2);
+			break;
+		case '\\':
+			_emit(e, "\\\\", 2);
+			break;
+		case '\b':
+			_emit(e, "\\b", 2);
+			break;
+		case '\f':
+			_emit(e, "\\f", 2);
+			break;
+		case '\n':
+			_emit(e, "\\n", 2);
+			break;
+		case '\r':
+			_emit(e, "\\r", 2);
+			break;
+		case '\t':
+			_emit(e, "\\t", 2);
+			break;
+		default:
+			snprintf(esc, sizeof(esc), "\\u%04x", c);
+			_emit(e, esc, 6);
+		}
+	}
+
+	if (str)
+		_emit(e, start, (str - start));
+
+	_emit(e, "\"", 1);
+}
+
+static data_for_each_cmd_t _dump_dict_json(const char *key, const data_t *data,
+					   void *arg)
+{
+	json_emit_t *e = arg;
+
+	if (!e->first)
+		_emit(e, ",", 1);
+	_emit_indent(e);
+	_emit_string(e, key);
+	if (e->flags & DUMP_JSON_FLAGS_PRETTY)
+		_emit(e, ": ", 2);
+	else
+		_emit(e, ":", 1);
+
+	if (_dump_data(data, e))
+		return DATA_FOR_EACH_FAIL;
+
+	e->first = false;
 	return DATA_FOR_EACH_CONT;
 }
 
-static data_for_each_cmd_t _convert_list_json(const data_t *data, void *arg)
+static data_for_each_cmd_t _dump_list_json(const data_t *data, void *arg)
 {
-	json_object *jobj = arg;
-	json_object *jarray = _data_to_json(data);
+	json_emit_t *e = arg;
+
+	if (!e->first)
+		_emit(e, ",", 1);
+	_emit_indent(e);
 
-	json_object_array_add(jobj, jarray);
+	if (_dump_data(data, e))
+		return DATA_FOR_EACH_FAIL;
+
+	e->first = false;
 	return DATA_FOR_EACH_CONT;
 }
 
-static json_object *_data_to_json(const data_t *d)
+static int _dump_data(const data_t *d, json_emit_t *e)
 {
+	char buffer[64];
+	int count;
+
 	if (!d)
-		return NULL;
+		return SLURM_ERROR;
 
 	switch (data_get_type(d)) {
 	case DATA_TYPE_NULL:
-		return NULL;
+		_emit_str(e, "null");
 		break;
 	case DATA_TYPE_BOOL:
-		return json_object_new_boolean(data_get_bool(d));
+		_emit_str(e, (data_get_bool(d) ? "true" : "false"));
 		break;
 	case DATA_TYPE_FLOAT:
-		return json_object_new_double(data_get_float(d));
+	{
+		double value = data_get_float(d);
+
+		/* JSON has no way to express these */
+		if (isnan(value) || isinf(value)) {
+			_emit_str(e, "null");
+			break;
+		}
+
+		snprintf(buffer, sizeof(buffer), "%.17g", value);
+		_emit_str(e, buffer);
+		/* keep it a float to the reader */
+		if (!strpbrk(buffer, ".eE"))
+			_emit(e, ".0", 2);
 		break;
+	}
 	case DATA_TYPE_INT_64:
-		return json_object_new_int64(data_get_int(d));
+		snprintf(buffer, sizeof(buffer), "%"PRId64, data_get_int(d));
+		_emit_str(e, buffer);
 		break;
 	case DATA_TYPE_DICT:
-	{
-		json_object *jobj = json_object_new_object();
-		if (data_dict_for_each_const(d, _convert_dict_json, jobj) < 0)
-			error("%s: unexpected error calling _convert_dict_json()",
-			      __func__);
-		return jobj;
-	}
+		_emit(e, "{", 1);
+		e->depth++;
+		e->first = true;
+		count = data_dict_for_each_const(d, _dump_dict_json, e);
+		e->depth--;
+		if (count < 0)
+			return SLURM_ERROR;
+		if (count)
+			_emit_indent(e);
+		_emit(e, "}", 1);
+		break;
 	case DATA_TYPE_LIST:
-	{
-		json_object *jobj = json_object_new_array();
-		if (data_list_for_each_const(d, _convert_list_json, jobj) < 0)
-			error("%s: unexpected error calling _convert_list_json()",
-			      __func__);
-		return jobj;
-	}
+		_emit(e, "[", 1);
+		e->depth++;
+		e->first = true;
+		count = data_list_for_each_const(d, _dump_list_json, e);
+		e->depth--;
+		if (count < 0)
+			return SLURM_ERROR;
+		if (count)
+			_emit_indent(e);
+		_emit(e, "]", 1);
+		break;
 	case DATA_TYPE_STRING:
-	{
-		const char *str = data_get_string_const(d);
-		if (str)
-			return json_object_new_string(str);
-		else
-			return json_object_new_string("");
+		_emit_string(e, data_get_string_const(d));
 		break;
-	}
 	default:
-		fatal_abort("%s: unknown type", __func__);
-	};
+		error("%s: unknown type", __func__);
+		return SLURM_ERROR;
+	}
+
+	return e->rc;
 }
 
-extern char *dump_json(const data_t *data, dump_json_flags_t flags)
+extern int dump_json_stream(const data_t *data, dump_json_flags_t flags,
+			    int (*write_func)(void *arg, const char *buf,
+					      size_t len),
+			    void *arg)
 {
-	struct json_object *jobj = _data_to_json(data);
-	char *buffer = NULL;
-	int jflags = 0;
+	json_emit_t *e = xmalloc(sizeof(*e));
+	int rc;
 
 	/* can't be pretty and compact at the same time! */
 	xassert((flags & (DUMP_JSON_FLAGS_PRETTY | DUMP_JSON_FLAGS_COMPACT)) !=
 		(DUMP_JSON_FLAGS_PRETTY | DUMP_JSON_FLAGS_COMPACT));
 
-	switch (flags) {
-	case DUMP_JSON_FLAGS_PRETTY:
-		jflags = JSON_C_TO_STRING_SPACED | JSON_C_TO_STRING_PRETTY;
-		break;
-	case DUMP_JSON_FLAGS_COMPACT: /* fallthrough */
-	default:
-		jflags = JSON_C_TO_STRING_PLAIN;
-	}
-
-	/* string will die with jobj */
-	buffer = xstrdup(json_object_to_json_string_ext(jobj, jflags));
+	e->flags = flags;
+	e->write_func = write_func;
+	e->arg = arg;
 
-	/* put is equiv to free() */
-	json_object_put(jobj);
+	if (!(rc = _dump_data(data, e))) {
+		_flush(e);
+		rc = e->rc;
+	}
 
-	return buffer;
-}
-
-#else /* HAVE_JSON */
-
-extern data_t *parse_json(const char *buf, size_t len)
-{
-	error("%s: JSON support not compiled", __func__);
-	return NULL;
+	xfree(e);
+	return rc;
 }
 
 extern char *dump_json(const data_t *data, dump_json_flags_t flags)
 {
-	error("%s: JSON support not compiled", __func__);
-	return NULL;
-}
+	Buf buffer = init_buf(JSON_STAGE_BYTES);
 
-#endif /* HAVE_JSON */
+	if (dump_json_stream(data, flags, write_buf, buffer)) {
+		free_buf(buffer);
+		return NULL;
+	}
+
+	get_buf_data(buffer)[get_buf_offset(buffer)] = '\0';
+	return xfer_buf_data(buffer);
+}
@@ -59,11 +59,25 @@ typedef enum {
 } dump_json_flags_t;
 
 /*
- * Read JSON formatted buffer
- * IN buf string buffer containing JSON formatted data
+ * Dump data as JSON formatted string
+ * IN data data to dump
  * IN flags flags to format the output
- * RET structured data or NULL on error (must call xfree())
+ * RET JSON string or NULL on error (must call xfree())
  */
 extern char *dump_json(const data_t *data, dump_json_flags_t flags);
 
+/*
+ * Write data as JSON a piece at a time, never holding the whole output
+ * IN data data to dump
+ * IN flags flags to format the output
+ * IN write_func called with each piece of output in order
+ *	RET SLURM_SUCCESS or error to stop dumping
+ * IN arg arbitrary pointer handed to write_func
+ * RET SLURM_SUCCESS or error
+ */
+extern int dump_json_stream(const data_t *data, dump_json_flags_t flags,
+			    int (*write_func)(void *arg, const char *buf,
+					      size_t len),
+			    void *arg);
+
 #endif /* _XJSON_H */
@@ -39,6 +39,7 @@
 #include "slurm/slurm.h"
 
 #include "src/common/log.h"
+#include "src/common/pack.h"
 #include "src/common/xassert.h"
 #include "src/common/xmalloc.h"
 #include "src/common/xstring.h"
@@ -49,8 +50,8 @@
 
 #include <yaml.h>
 
-/* Default to about 1MB */
-static const size_t yaml_buffer_size = 4096 * 256;
+/* Initial size of buffer when dumping to a string */
+static const size_t yaml_buffer_size = 4096;
 
 /* YAML parser doesn't give constants for the well defined scalars */
 #define YAML_NULL "null"
@@ -792,10 +793,27 @@ yaml_fail:
 	return SLURM_ERROR;
 }
 
+typedef struct {
+	int (*write_func)(void *arg, const char *buf, size_t len);
+	void *arg;
+	int rc;
+} yaml_write_args_t;
+
+/* libyaml output handler: returns 1 on success and 0 on error */
+static int _yaml_write(void *data, unsigned char *buffer, size_t size)
+{
+	yaml_write_args_t *args = data;
+
+	if (!args->rc)
+		args->rc = args->write_func(args->arg, (const char *) buffer,
+					    size);
+
+	return args->rc ? 0 : 1;
+}
+
 static int _dump_yaml(const data_t *data, yaml_emitter_t *emitter,
-		      yaml_char_t *buffer, const size_t buffer_len)
+		      yaml_write_args_t *args)
 {
-	size_t written = 0;
 	yaml_event_t event;
 
 	//TODO: only version 1.1 is currently supported by libyaml
@@ -804,10 +822,11 @@ static int _dump_yaml(const data_t *data, yaml_emitter_t *emitter,
 		.minor = 1,
 	};
 
-	if (!yaml_emitter_initialize(emitter))
-		_yaml_emitter_error;
-
-	yaml_emitter_set_output_string(emitter, buffer, buffer_len, &written);
+	/*
+	 * libyaml hands over its output as its internal buffer fills instead
+	 * of building all of it first
+	 */
+	yaml_emitter_set_output(emitter, _yaml_write, args);
 
 	//TODO defaulted to UTF8 but maybe this should be a flag?
 	if (!yaml_stream_start_event_initialize(&event, YAML_UTF8_ENCODING))
@@ -845,22 +864,48 @@ yaml_fail:
 
 #undef _yaml_emitter_error
 
-extern char *dump_yaml(const data_t *data)
+extern int dump_yaml_stream(const data_t *data,
+			    int (*write_func)(void *arg, const char *buf,
+					      size_t len),
+			    void *arg)
 {
 	yaml_emitter_t emitter;
-	yaml_char_t *buffer = xmalloc(yaml_buffer_size);
+	yaml_write_args_t args = {
+		.write_func = write_func,
+		.arg = arg,
+	};
+	int rc;
+
+	if (!yaml_emitter_initialize(&emitter)) {
+		error("%s: YAML emitter error: %s",
+		      __func__, (char *) emitter.problem);
+		return SLURM_ERROR;
+	}
 
-	if (_dump_yaml(data, &emitter, buffer, yaml_buffer_size)) {
+	rc = _dump_yaml(data, &emitter, &args);
+	if (args.rc)
+		rc = args.rc;
+
+	yaml_emitter_delete(&emitter);
+
+	return rc;
+}
+
+extern char *dump_yaml(const data_t *data)
+{
+	Buf buffer = init_buf(yaml_buffer_size);
+
+	if (dump_yaml_stream(data, write_buf, buffer)) {
 		error("%s: dump yaml failed", __func__);
 
-		xfree(buffer);
+		free_buf(buffer);
 		return NULL;
 	}
 
-	yaml_emitter_delete(&emitter);
+	get_buf_data(buffer)[get_buf_offset(buffer)] = '\0';
 
 	/* recast as signed as that is the Slurm default */
-	return (char *)buffer;
+	return xfer_buf_data(buffer);
 }
 
 #else /* HAVE_YAML */
@@ -877,4 +922,13 @@ extern char *dump_yaml(const data_t *data)
 	return NULL;
 }
 
+extern int dump_yaml_stream(const data_t *data,
+			    int (*write_func)(void *arg, const char *buf,
+					      size_t len),
+			    void *arg)
+{
+	error("%s: YAML support not compiled", __func__);
+	return SLURM_ERROR;
+}
+
 #endif /* HAVE_YAML */
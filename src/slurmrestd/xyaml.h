@@ -47,10 +47,23 @@
 extern data_t *parse_yaml(const char *buf, size_t len);
 
 /*
- * read YAML formatted buffer
- * IN buf string buffer containing YAML formatted data
- * RET structured data or NULL on error (must call xfree())
+ * Dump data as YAML formatted string
+ * IN data data to dump
+ * RET YAML string or NULL on error (must call xfree())
  */
 extern char *dump_yaml(const data_t *data);
 
+/*
+ * Write data as YAML a piece at a time, never holding the whole output
+ * IN data data to dump
+ * IN write_func called with each piece of output in order
+ *	RET SLURM_SUCCESS or error to stop dumping
+ * IN arg arbitrary pointer handed to write_func
+ * RET SLURM_SUCCESS or error
+ */
+extern int dump_yaml_stream(const data_t *data,
+			    int (*write_func)(void *arg, const char *buf,
+					      size_t len),
+			    void *arg);
+
 #endif /* _XYAML_H */
@@ -267,6 +267,8 @@ static void _job_list_del(void *x)
 {
 	squeue_job_rec_t *job_rec_ptr = (squeue_job_rec_t *) x;
 	xfree(job_rec_ptr->part_name);
+	xfree(job_rec_ptr->sort_group);
+	FREE_NULL_HOSTLIST(job_rec_ptr->sort_nodes);
 	xfree(job_rec_ptr);
 }
 
@@ -305,36 +307,39 @@ static void _part_state_load(void)
 
 static int _print_str(char *str, int width, bool right, bool cut_output)
 {
-	char format[64];
-	int printed = 0;
-
-	if (right == true && width > 0)
-		snprintf(format, 64, "%%%ds", width);
-	else if (width > 0)
-		snprintf(format, 64, "%%.%ds", width);
-	else if (width < 0) {
-		format[0] = '%';
-		format[1] = 's';
-		format[2] = ' ';
-		format[3] = '\0';
-	} else if (width == 0) {
-		format[0] = '%';
-		format[1] = 's';
-		format[2] = '\0';
-	}
-
-	if ((width <= 0) || (cut_output == false) ) {
-		if ((printed = printf(format, str)) < 0)
-			return printed;
+	int len, printed;
+
+	/*
+	 * Written out directly rather than through a printf() format built
+	 * for every field, this is called for each field of each job.
+	 */
+	if (!str)
+		str = "(null)";
+	len = strlen(str);
+
+	if (width > 0) {
+		if (right && (len < width)) {
+			for (printed = len; printed < width; printed++)
+				putchar(' ');
+			fwrite(str, 1, len, stdout);
+		} else {
+			/* Left justified fields are always cut */
+			if ((!right || cut_output) && (len > width))
+				len = width;
+			fwrite(str, 1, len, stdout);
+			printed = len;
+		}
 	} else {
-		char temp[width + 1];
-		snprintf(temp, width + 1, format, str);
-		if ((printed = printf("%s",temp)) < 0)
-			return printed;
+		fwrite(str, 1, len, stdout);
+		printed = len;
+		if (width < 0) {
+			putchar(' ');
+			printed++;
+		}
 	}
 
 	while (printed++ < width)
-		printf(" ");
+		putchar(' ');
 
 	return printed;
 }
@@ -487,6 +492,75 @@ job_format_add_function(List list, int width, bool right, char *suffix,
 	return SLURM_SUCCESS;
 }
 
+/* JOB_FIELD_* groups of job_info_t read by print functions */
+static const struct {
+	int (*function) (job_info_t *, int, bool, char*);
+	uint32_t fields;
+} job_format_fields[] = {
+	{ _print_job_admin_comment, JOB_FIELD_COMMENT },
+	{ _print_job_cluster_features, JOB_FIELD_FEATURES },
+	{ _print_job_command, JOB_FIELD_COMMAND },
+	{ _print_job_comment, JOB_FIELD_COMMENT },
+	{ _print_job_cpus_per_tres, JOB_FIELD_TRES },
+	{ _print_job_dependency, JOB_FIELD_DEPENDENCY },
+	{ _print_job_exc_node_inx, JOB_FIELD_EXC_NODES },
+	{ _print_job_exc_nodes, JOB_FIELD_EXC_NODES },
+	{ _print_job_features, JOB_FIELD_FEATURES },
+	{ _print_job_fed_origin, JOB_FIELD_FED },
+	{ _print_job_fed_origin_raw, JOB_FIELD_FED },
+	{ _print_job_fed_siblings_active, JOB_FIELD_FED },
+	{ _print_job_fed_siblings_active_raw, JOB_FIELD_FED },
+	{ _print_job_fed_siblings_viable, JOB_FIELD_FED },
+	{ _print_job_fed_siblings_viable_raw, JOB_FIELD_FED },
+	{ _print_job_mem_per_tres, JOB_FIELD_TRES },
+	{ _print_job_node_inx, JOB_FIELD_NODE_INX },
+	{ _print_job_req_node_inx, JOB_FIELD_REQ_NODES },
+	{ _print_job_req_nodes, JOB_FIELD_REQ_NODES },
+	{ _print_job_schednodes, JOB_FIELD_SCHED_NODES },
+	{ _print_job_std_err, JOB_FIELD_STD_IO | JOB_FIELD_WORK_DIR },
+	{ _print_job_std_in, JOB_FIELD_STD_IO },
+	{ _print_job_std_out, JOB_FIELD_STD_IO | JOB_FIELD_WORK_DIR },
+	{ _print_job_system_comment, JOB_FIELD_COMMENT },
+	{ _print_job_tres_alloc, JOB_FIELD_TRES },
+	{ _print_job_tres_bind, JOB_FIELD_TRES },
+	{ _print_job_tres_freq, JOB_FIELD_TRES },
+	{ _print_job_tres_per_job, JOB_FIELD_TRES },
+	{ _print_job_tres_per_node, JOB_FIELD_TRES },
+	{ _print_job_tres_per_socket, JOB_FIELD_TRES },
+	{ _print_job_tres_per_task, JOB_FIELD_TRES },
+	{ _print_job_work_dir, JOB_FIELD_WORK_DIR },
+};
+
+static int _clear_format_fields(void *x, void *arg)
+{
+	job_format_t *format = x;
+	uint32_t *skip_fields = arg;
+
+	for (int i = 0; i < ARRAY_SIZE(job_format_fields); i++) {
+		if (job_format_fields[i].function == format->function)
+			*skip_fields &= ~job_format_fields[i].fields;
+	}
+
+	return 0;
+}
+
+/*
+ * Return JOB_FIELD_* groups no function in format prints so slurmctld can
+ * leave them out of the jobs it sends
+ */
+uint32_t job_format_skip_fields(List format)
+{
+	uint32_t skip_fields = JOB_FIELD_COMMAND | JOB_FIELD_WORK_DIR |
+		JOB_FIELD_STD_IO | JOB_FIELD_COMMENT | JOB_FIELD_FEATURES |
+		JOB_FIELD_DEPENDENCY | JOB_FIELD_TRES | JOB_FIELD_NODE_INX |
+		JOB_FIELD_REQ_NODES | JOB_FIELD_EXC_NODES | JOB_FIELD_FED |
+		JOB_FIELD_SCHED_NODES | JOB_FIELD_GRES | JOB_FIELD_MAIL;
+
+	list_for_each(format, _clear_format_fields, &skip_fields);
+
+	return skip_fields;
+}
+
 int _print_job_array_job_id(job_info_t * job, int width, bool right,
 			    char* suffix)
 {
@@ -42,6 +42,7 @@
 
 #include "slurm/slurm.h"
 
+#include "src/common/hostlist.h"
 #include "src/common/list.h"
 
 #define FORMAT_STRING_SIZE 32
@@ -67,6 +68,8 @@ typedef struct squeue_job_rec {
 	job_info_t *	job_ptr;
 	char *		part_name;
 	uint32_t	part_prio;
+	char *		sort_group;	/* group name, set by sort_job_list() */
+	hostlist_t	sort_nodes;	/* sorted nodes, set by sort_job_list() */
 } squeue_job_rec_t;
 
 long job_time_used(job_info_t * job_ptr);
@@ -83,6 +86,7 @@ int print_steps_array(job_step_info_t * steps, int size, List format);
 int job_format_add_function(List list, int width, bool right_justify,
 			    char *suffix,
 			    int (*function) (job_info_t *, int, bool, char*));
+uint32_t job_format_skip_fields(List format);
 #define job_format_add_array_job_id(list,wid,right,suffix) \
 	job_format_add_function(list,wid,right,suffix,_print_job_array_job_id)
 #define job_format_add_array_task_id(list,wid,right,suffix) \
@@ -92,8 +92,17 @@ static int _sort_step_by_time_limit(void *void1, void *void2);
 static int _sort_step_by_time_used(void *void1, void *void2);
 static int _sort_step_by_user_id(void *void1, void *void2);
 static int _sort_step_by_user_name(void *void1, void *void2);
-static int _sort_by_node_list(char *nodes1, char *nodes2);
+static int _sort_by_node_list(hostlist_t hostlist1, hostlist_t hostlist2);
 
+typedef struct {
+	gid_t gid;
+	char *name;
+} group_name_t;
+
+typedef struct {
+	List group_names;	/* group_name_t looked up so far */
+	bool nodes;
+} sort_keys_args_t;
 
 static time_t now;
 
@@ -101,6 +110,71 @@ static time_t now;
  * Global Print Functions
  *****************************************************************************/
 
+static void _free_group_name(void *x)
+{
+	group_name_t *group = x;
+
+	xfree(group->name);
+	xfree(group);
+}
+
+static int _find_group_name(void *x, void *key)
+{
+	return (((group_name_t *) x)->gid == *(gid_t *) key);
+}
+
+/* Set keys of job record that are too slow to get on every comparison */
+static int _set_sort_keys(void *x, void *arg)
+{
+	squeue_job_rec_t *job_rec_ptr = x;
+	sort_keys_args_t *args = arg;
+	job_info_t *job_ptr = job_rec_ptr->job_ptr;
+
+	if (args->group_names && !job_rec_ptr->sort_group) {
+		gid_t gid = (gid_t) job_ptr->group_id;
+		group_name_t *group;
+
+		if (!(group = list_find_first(args->group_names,
+					      _find_group_name, &gid))) {
+			struct group *group_info = getgrgid(gid);
+
+			group = xmalloc(sizeof(*group));
+			group->gid = gid;
+			group->name = xstrdup(group_info ?
+					      group_info->gr_name : "");
+			list_append(args->group_names, group);
+		}
+		job_rec_ptr->sort_group = xstrdup(group->name);
+	}
+
+	if (args->nodes && !job_rec_ptr->sort_nodes) {
+		job_rec_ptr->sort_nodes = hostlist_create(job_ptr->nodes);
+		hostlist_sort(job_rec_ptr->sort_nodes);
+	}
+
+	return SLURM_SUCCESS;
+}
+
+/*
+ * Look up the group names and node lists to sort by once per job instead of
+ * on every comparison
+ */
+static void _set_job_sort_keys(List job_list)
+{
+	sort_keys_args_t args = { 0 };
+
+	/* "cluster" is the only long sort key and has neither 'g' nor 'N' */
+	if (strchr(params.sort, 'g'))
+		args.group_names = list_create(_free_group_name);
+	if (strchr(params.sort, 'N'))
+		args.nodes = true;
+
+	if (args.group_names || args.nodes)
+		list_for_each(job_list, _set_sort_keys, &args);
+
+	FREE_NULL_LIST(args.group_names);
+}
+
 void sort_job_list(List job_list)
 {
 	int i;
@@ -109,6 +183,8 @@ void sort_job_list(List job_list)
 	if (params.sort == NULL)
 		params.sort = xstrdup("P,t,-p"); /* Partition,state,priority */
 
+	_set_job_sort_keys(job_list);
+
 	for (i=(strlen(params.sort)-1); i >= 0; i--) {
 		reverse_order = false;
 		if ((params.sort[i] == ',') ||
@@ -368,18 +444,10 @@ static int _sort_job_by_group_id(void *void1, void *void2)
 static int _sort_job_by_group_name(void *void1, void *void2)
 {
 	int diff;
-	job_info_t *job1;
-	job_info_t *job2;
-	struct group *group_info = NULL;
-	char *name1 = "", *name2 = "";
+	squeue_job_rec_t *job_rec1 = *(squeue_job_rec_t **) void1;
+	squeue_job_rec_t *job_rec2 = *(squeue_job_rec_t **) void2;
 
-	_get_job_info_from_void(&job1, &job2, void1, void2);
-
-	if ((group_info = getgrgid((gid_t) job1->group_id)))
-		name1 = group_info->gr_name;
-	if ((group_info = getgrgid((gid_t) job2->group_id)))
-		name2 = group_info->gr_name;
-	diff = xstrcmp(name1, name2);
+	diff = xstrcmp(job_rec1->sort_group, job_rec2->sort_group);
 
 	if (reverse_order)
 		diff = -diff;
@@ -449,39 +517,48 @@ static int _sort_job_by_name(void *void1, void *void2)
 
 static int _sort_job_by_node_list(void *void1, void *void2)
 {
-	job_info_t *job1, *job2;
-	_get_job_info_from_void(&job1, &job2, void1, void2);
-	return _sort_by_node_list(job1->nodes, job2->nodes);
+	squeue_job_rec_t *job_rec1 = *(squeue_job_rec_t **) void1;
+	squeue_job_rec_t *job_rec2 = *(squeue_job_rec_t **) void2;
+
+	return _sort_by_node_list(job_rec1->sort_nodes, job_rec2->sort_nodes);
 }
 
 static int _sort_step_by_node_list(void *void1, void *void2)
 {
+	int diff;
 	job_step_info_t *step1, *step2;
+	hostlist_t hostlist1, hostlist2;
+
 	_get_step_info_from_void(&step1, &step2, void1, void2);
-	return _sort_by_node_list(step1->nodes, step2->nodes);
+
+	hostlist1 = hostlist_create(step1->nodes);
+	hostlist_sort(hostlist1);
+	hostlist2 = hostlist_create(step2->nodes);
+	hostlist_sort(hostlist2);
+
+	diff = _sort_by_node_list(hostlist1, hostlist2);
+
+	hostlist_destroy(hostlist1);
+	hostlist_destroy(hostlist2);
+
+	return diff;
 }
 
-static int _sort_by_node_list(char *nodes1, char *nodes2)
+/* Compare first node of sorted hostlists */
+static int _sort_by_node_list(hostlist_t hostlist1, hostlist_t hostlist2)
 {
 	int diff = 0;
-	hostlist_t hostlist1, hostlist2;
 #if	PURE_ALPHA_SORT
 	char *val1, *val2;
 	char *ptr1, *ptr2;
-#endif
-	hostlist1 = hostlist_create(nodes1);
-	hostlist_sort(hostlist1);
-	hostlist2 = hostlist_create(nodes2);
-	hostlist_sort(hostlist2);
 
-#if	PURE_ALPHA_SORT
-	val1 = hostlist_shift(hostlist1);
+	val1 = hostlist_nth(hostlist1, 0);
 	if (val1)
 		ptr1 = val1;
 	else
 		ptr1 = "";
 
-	val2 = hostlist_shift(hostlist2);
+	val2 = hostlist_nth(hostlist2, 0);
 	if (val2)
 		ptr2 = val2;
 	else
@@ -499,8 +576,6 @@ static int _sort_by_node_list(char *nodes1, char *nodes2)
 	 */
 	diff = hostlist_cmp_first(hostlist1, hostlist2);
 #endif
-	hostlist_destroy(hostlist1);
-	hostlist_destroy(hostlist2);
 
 	if (reverse_order)
 		diff = -diff;
@@ -167,10 +167,52 @@ _get_window_width( void )
 }
 
 
+/*
+ * Build filter for slurmctld from the options. squeue still filters the jobs
+ * itself, so this only has to leave out jobs that would never be printed.
+ */
+static job_info_filter_t *_build_job_filter(void)
+{
+	job_info_filter_t *filter = xmalloc(sizeof(*filter));
+	char hostlist[8192];
+
+	filter->accounts = params.account_list;
+	filter->names = params.name_list;
+	filter->partitions = params.part_list;
+	filter->qos = params.qos_list;
+	filter->reservation = params.reservation;
+	filter->user_ids = params.user_list;
+
+	if (params.nodes &&
+	    (hostset_ranged_string(params.nodes, sizeof(hostlist),
+				   hostlist) >= 0))
+		filter->nodes = xstrdup(hostlist);
+
+	if (params.state_list) {
+		filter->states = params.state_list;
+	} else {
+		/* Same default states as _filter_job() */
+		uint32_t states[] = { JOB_PENDING, JOB_RUNNING, JOB_SUSPENDED,
+				      JOB_COMPLETING, JOB_STAGE_OUT };
+
+		filter->states = list_create(NULL);
+		for (int i = 0; i < ARRAY_SIZE(states); i++) {
+			uint32_t *state = xmalloc(sizeof(*state));
+			*state = states[i];
+			list_append(filter->states, state);
+		}
+	}
+
+	filter->skip_fields = job_format_skip_fields(params.format_list);
+
+	return filter;
+}
+
 /* _print_job - print the specified job's information */
 static int _print_job(bool clear_old, bool log_cluster_name)
 {
 	static job_info_msg_t *old_job_ptr;
+	static job_info_filter_t *filter = NULL;
 	job_info_msg_t *new_job_ptr = NULL;
 	int error_code;
 	uint16_t show_flags = 0;
@@ -188,6 +230,32 @@ static int _print_job(bool clear_old, bool log_cluster_name)
 	if (params.format && strstr(params.format, "C"))
 		show_flags |= SHOW_DETAIL;
 
+	if (!params.format && !params.format_long) {
+		if (log_cluster_name)
+			xstrcat(params.format_long, "cluster:10 ,");
+		if (params.long_list) {
+			xstrcat(params.format_long,
+				"jobarrayid:.18 ,partition:.9 ,name:.8 ,"
+				"username:.8 ,state:.8 ,timeused:.10 ,"
+				"timelimit:.9 ,numnodes:.6 ,reasonlist:0");
+		} else {
+			xstrcat(params.format_long,
+				"jobarrayid:.18 ,partition:.9 ,name:.8 ,"
+				"username:.8 ,statecompact:.2 ,timeused:.10 ,"
+				"numnodes:.6 ,reasonlist:0");
+		}
+	}
+
+	if (!params.format_list) {
+		if (params.format)
+			parse_format(params.format);
+		else if (params.format_long)
+			parse_long_format(params.format_long);
+	}
+
+	if (!filter)
+		filter = _build_job_filter();
+
 	if (old_job_ptr) {
 		if (clear_old)
 			old_job_ptr->last_update = 0;
@@ -195,16 +263,12 @@ static int _print_job(bool clear_old, bool log_cluster_name)
 			error_code = slurm_load_job(
 				&new_job_ptr, params.job_id,
 				show_flags);
-		} else if (params.user_id) {
-			error_code = slurm_load_job_user(&new_job_ptr,
-							 params.user_id,
-							 show_flags);
 		} else {
 			if (params.clusters)
 				show_flags |= SHOW_LOCAL;
-			error_code = slurm_load_jobs(
+			error_code = slurm_load_jobs_filter(
 				old_job_ptr->last_update,
-				&new_job_ptr, show_flags);
+				&new_job_ptr, show_flags, filter);
 		}
 		if (error_code ==  SLURM_SUCCESS)
 			slurm_free_job_info_msg( old_job_ptr );
@@ -215,12 +279,9 @@ static int _print_job(bool clear_old, bool log_cluster_name)
 	} else if (params.job_id) {
 		error_code = slurm_load_job(&new_job_ptr, params.job_id,
 					    show_flags);
-	} else if (params.user_id) {
-		error_code = slurm_load_job_user(&new_job_ptr, params.user_id,
-						 show_flags);
 	} else {
-		error_code = slurm_load_jobs((time_t) NULL, &new_job_ptr,
-					     show_flags);
+		error_code = slurm_load_jobs_filter((time_t) NULL, &new_job_ptr,
+						    show_flags, filter);
 	}
 
 	if (error_code) {
@@ -228,7 +289,7 @@ static int _print_job(bool clear_old, bool log_cluster_name)
 		return SLURM_ERROR;
 	}
 	old_job_ptr = new_job_ptr;
-	if (params.job_id || params.user_id)
+	if (params.job_id)
 		old_job_ptr->last_update = (time_t) 0;
 
 	if (params.verbose) {
@@ -237,28 +298,6 @@ static int _print_job(bool clear_old, bool log_cluster_name)
 			new_job_ptr->record_count);
 	}
 
-	if (!params.format && !params.format_long) {
-		if (log_cluster_name)
-			xstrcat(params.format_long, "cluster:10 ,");
-		if (params.long_list) {
-			xstrcat(params.format_long,
-				"jobarrayid:.18 ,partition:.9 ,name:.8 ,"
-				"username:.8 ,state:.8 ,timeused:.10 ,"
-				"timelimit:.9 ,numnodes:.6 ,reasonlist:0");
-		} else {
-			xstrcat(params.format_long,
-				"jobarrayid:.18 ,partition:.9 ,name:.8 ,"
-				"username:.8 ,statecompact:.2 ,timeused:.10 ,"
-				"numnodes:.6 ,reasonlist:0");
-		}
-	}
-
-	if (!params.format_list) {
-		if (params.format)
-			parse_format(params.format);
-		else if (params.format_long)
-			parse_long_format(params.format_long);
-	}
 
 	print_jobs_array(new_job_ptr->job_array, new_job_ptr->record_count,
 			 params.format_list) ;
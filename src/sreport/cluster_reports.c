@@ -79,7 +79,7 @@ static int _set_wckey_cond(int *start, int argc, char **argv,
 		return -1;
 	}
 
-	wckey_cond->with_usage = 1;
+	wckey_cond->with_usage = SLURMDB_USAGE_PERIODS | SLURMDB_USAGE_SUMMED;
 	wckey_cond->with_deleted = 1;
 
 	if (!wckey_cond->cluster_list)
@@ -185,7 +185,7 @@ static int _set_assoc_cond(int *start, int argc, char **argv,
 		return SLURM_ERROR;
 	}
 
-	assoc_cond->with_usage = 1;
+	assoc_cond->with_usage = SLURMDB_USAGE_PERIODS | SLURMDB_USAGE_SUMMED;
 	assoc_cond->with_deleted = 1;
 
 	if (!assoc_cond->cluster_list)
@@ -289,7 +289,7 @@ static int _set_cluster_cond(int *start, int argc, char **argv,
 	}
 
 	cluster_cond->with_deleted = 1;
-	cluster_cond->with_usage = 1;
+	cluster_cond->with_usage = SLURMDB_USAGE_PERIODS | SLURMDB_USAGE_SUMMED;
 
 	if (!cluster_cond->cluster_list)
 		cluster_cond->cluster_list = list_create(xfree_ptr);
@@ -615,7 +615,7 @@ static List _get_cluster_list(int argc, char **argv, uint32_t *total_time,
 
 	slurmdb_init_cluster_cond(cluster_cond, 0);
 	cluster_cond->with_deleted = 1;
-	cluster_cond->with_usage = 1;
+	cluster_cond->with_usage = SLURMDB_USAGE_PERIODS | SLURMDB_USAGE_SUMMED;
 
 	_set_cluster_cond(&i, argc, argv, cluster_cond, format_list);
 
@@ -0,0 +1,141 @@
+/*
+ * Test of the columnar archive format in src/common/archive_col.c
+ *
+ * Writes an archive of several blocks, reads all of it back and then
+ * reads a time range out of it. The number of rows may be given as the
+ * first argument.
+ *
+ * Avoid duplicate wait() symbol definition (in both testsuite/dejagnu.h
+ * and sys/wait.h
+ */
+#define _SYS_WAIT_H 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "slurm/slurm_errno.h"
+#include "src/common/archive_col.h"
+#include "src/common/slurmdbd_defs.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include <testsuite/dejagnu.h>
+
+/*
+ * Test for failure:
+ */
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define DEFAULT_ROW_CNT 100000
+#define BASE_TIME 1500000000
+
+static char *col_names[] = { "job_db_inx", "time_submit", "job_name" };
+
+static long _elapsed_usec(struct timeval *start)
+{
+	struct timeval end;
+
+	gettimeofday(&end, NULL);
+	return ((end.tv_sec - start->tv_sec) * 1000000) +
+		(end.tv_usec - start->tv_usec);
+}
+
+/* Read all rows in range, return the count or -1 on a bad row */
+static int _read_rows(Buf buffer, time_t start, time_t end)
+{
+	archive_col_reader_t *reader;
+	char **row;
+	int cnt = 0, bad = 0;
+
+	set_buf_offset(buffer, 0);
+	if (!(reader = archive_col_reader_create(buffer, start, end)))
+		return -1;
+
+	while ((archive_col_next_row(reader, &row) == SLURM_SUCCESS) && row) {
+		long inx = atol(row[0]);
+
+		if ((atol(row[1]) != BASE_TIME + inx) ||
+		    ((inx % 7) ? !row[2] : (row[2] != NULL)))
+			bad++;
+		if ((start && (atol(row[1]) < start)) ||
+		    (end && (atol(row[1]) > end)))
+			bad++;
+		cnt++;
+	}
+	archive_col_reader_destroy(reader);
+
+	return bad ? -1 : cnt;
+}
+
+int
+main(int argc, char *argv[])
+{
+	archive_col_writer_t *writer;
+	archive_col_reader_t *reader;
+	archive_col_hdr_t *hdr;
+	struct timeval start;
+	Buf buffer;
+	char *row[3], inx[16], submit[16];
+	int row_cnt = DEFAULT_ROW_CNT, i;
+
+	if (argc > 1)
+		row_cnt = atoi(argv[1]);
+	if (row_cnt < 2 * ARCHIVE_COL_BLOCK_ROWS)
+		row_cnt = 2 * ARCHIVE_COL_BLOCK_ROWS;
+
+	gettimeofday(&start, NULL);
+	writer = archive_col_writer_create(DBD_GOT_JOBS, "test", 0,
+					   col_names, 3, 1);
+	for (i = 0; i < row_cnt; i++) {
+		snprintf(inx, sizeof(inx), "%d", i);
+		snprintf(submit, sizeof(submit), "%d", BASE_TIME + i);
+		row[0] = inx;
+		row[1] = submit;
+		row[2] = (i % 7) ? "job" : NULL;
+		archive_col_add_row(writer, row);
+	}
+	buffer = archive_col_writer_fini(writer);
+	note("wrote %d rows in %u bytes in %ld usec", row_cnt,
+	     get_buf_offset(buffer), _elapsed_usec(&start));
+
+	set_buf_offset(buffer, 0);
+	TEST(archive_col_detect(buffer), "columnar archive detected");
+
+	reader = archive_col_reader_create(buffer, 0, 0);
+	TEST(reader, "archive header read");
+	if (!reader) {
+		totals();
+		return failed;
+	}
+	hdr = archive_col_reader_hdr(reader);
+	TEST((hdr->type == DBD_GOT_JOBS) && (hdr->col_cnt == 3) &&
+	     (hdr->time_col == 1) && (hdr->rec_cnt == row_cnt) &&
+	     !xstrcmp(hdr->cluster_name, "test") &&
+	     !xstrcmp(hdr->col_names[2], "job_name"), "header matches");
+	TEST((hdr->min_time == BASE_TIME) &&
+	     (hdr->max_time == BASE_TIME + row_cnt - 1), "time range matches");
+	archive_col_reader_destroy(reader);
+
+	gettimeofday(&start, NULL);
+	TEST(_read_rows(buffer, 0, 0) == row_cnt, "all rows read back");
+	note("read %d rows in %ld usec", row_cnt, _elapsed_usec(&start));
+
+	/* A range inside the last block only */
+	TEST(_read_rows(buffer, BASE_TIME + row_cnt - 10,
+			BASE_TIME + row_cnt + 10) == 10, "time range read");
+	TEST(_read_rows(buffer, BASE_TIME - 10, BASE_TIME) == 1,
+	     "first row read");
+	TEST(_read_rows(buffer, BASE_TIME + row_cnt, 0) == 0,
+	     "empty range read");
+
+	set_buf_offset(buffer, 2);
+	TEST(!archive_col_detect(buffer), "misaligned archive not detected");
+	free_buf(buffer);
+
+	totals();
+	return failed;
+}
@@ -0,0 +1,388 @@
+/*
+ * Test of the association manager lookups in src/common/assoc_mgr.c
+ *
+ * Loads a cache of users, accounts, associations, QOS and wckeys from a
+ * state file the way slurmctld does without a database, resolves every
+ * user's association the way the job submit path does and checks the
+ * lookups stay right as users and QOS are added, renamed and removed. The
+ * number of users may be given as the first argument.
+ *
+ * Avoid duplicate wait() symbol definition (in both testsuite/dejagnu.h
+ * and sys/wait.h
+ */
+#define _SYS_WAIT_H 1
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "slurm/slurm_errno.h"
+#include "src/common/assoc_mgr.h"
+#include "src/common/slurmdbd_defs.h"
+#include "src/common/slurmdbd_pack.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include <testsuite/dejagnu.h>
+
+/*
+ * Test for failure:
+ */
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define DEFAULT_USER_CNT 20000
+#define ACCT_CNT 100
+#define QOS_CNT 500
+#define ROOT_ASSOC_ID 1
+#define ACCT_ASSOC_ID(_a) (2 + (_a))
+#define USER_ASSOC_ID(_u) (2 + ACCT_CNT + (_u))
+
+static long _elapsed_usec(struct timeval *start)
+{
+	struct timeval end;
+
+	gettimeofday(&end, NULL);
+	return ((end.tv_sec - start->tv_sec) * 1000000) +
+		(end.tv_usec - start->tv_usec);
+}
+
+static int _write_file(char *dir, char *name, Buf buffer)
+{
+	char *file = xstrdup_printf("%s/%s", dir, name);
+	int fd, rc = SLURM_SUCCESS;
+
+	if (((fd = creat(file, 0600)) < 0) ||
+	    (write(fd, get_buf_data(buffer), get_buf_offset(buffer)) !=
+	     get_buf_offset(buffer)))
+		rc = SLURM_ERROR;
+	if (fd >= 0)
+		close(fd);
+	xfree(file);
+	free_buf(buffer);
+
+	return rc;
+}
+
+/* The type in front of the list is only there in assoc_mgr_state */
+static void _pack_list(uint16_t type, List list, bool with_type, Buf buffer)
+{
+	dbd_list_msg_t msg = { .my_list = list };
+
+	if (with_type)
+		pack16(type, buffer);
+	slurmdbd_pack_list_msg(&msg, SLURM_PROTOCOL_VERSION, type, buffer);
+	FREE_NULL_LIST(list);
+}
+
+static slurmdb_assoc_rec_t *_create_assoc(uint32_t id, uint32_t parent_id,
+					  char *acct, char *user)
+{
+	slurmdb_assoc_rec_t *assoc = xmalloc(sizeof(*assoc));
+
+	slurmdb_init_assoc_rec(assoc, 0);
+	assoc->id = id;
+	assoc->parent_id = parent_id;
+	assoc->acct = xstrdup(acct);
+	assoc->user = xstrdup(user);
+	assoc->cluster = xstrdup("test");
+	assoc->shares_raw = 1;
+	assoc->is_def = 1;
+
+	return assoc;
+}
+
+/* Write the last_tres and assoc_mgr_state files to load from */
+static int _write_state(char *dir, int user_cnt)
+{
+	List list;
+	Buf buffer;
+	slurmdb_tres_rec_t *tres;
+	slurmdb_user_rec_t *user;
+	slurmdb_coord_rec_t *coord;
+	slurmdb_qos_rec_t *qos;
+	slurmdb_wckey_rec_t *wckey;
+	char acct[32], name[32];
+	int i;
+
+	buffer = init_buf(BUF_SIZE);
+	pack16(SLURM_PROTOCOL_VERSION, buffer);
+	pack_time(time(NULL), buffer);
+	list = list_create(slurmdb_destroy_tres_rec);
+	tres = xmalloc(sizeof(*tres));
+	tres->id = TRES_CPU;
+	tres->type = xstrdup("cpu");
+	list_append(list, tres);
+	_pack_list(DBD_ADD_TRES, list, false, buffer);
+	if (_write_file(dir, "last_tres", buffer) != SLURM_SUCCESS)
+		return SLURM_ERROR;
+
+	buffer = init_buf(BUF_SIZE);
+	pack16(SLURM_PROTOCOL_VERSION, buffer);
+	pack_time(time(NULL), buffer);
+
+	list = list_create(slurmdb_destroy_user_rec);
+	for (i = 0; i < user_cnt; i++) {
+		user = xmalloc(sizeof(*user));
+		user->name = xstrdup_printf("aml_user%d", i);
+		user->admin_level = SLURMDB_ADMIN_NONE;
+		user->default_acct = xstrdup_printf("acct%d", i % ACCT_CNT);
+		user->default_wckey = xstrdup_printf("wckey%d", i);
+		list_append(list, user);
+	}
+	user = xmalloc(sizeof(*user));
+	user->name = xstrdup("root");
+	user->admin_level = SLURMDB_ADMIN_SUPER_USER;
+	user->default_acct = xstrdup("acct0");
+	user->coord_accts = list_create(slurmdb_destroy_coord_rec);
+	coord = xmalloc(sizeof(*coord));
+	coord->name = xstrdup("acct1");
+	list_append(user->coord_accts, coord);
+	list_append(list, user);
+	_pack_list(DBD_ADD_USERS, list, true, buffer);
+
+	list = list_create(slurmdb_destroy_qos_rec);
+	for (i = 0; i < QOS_CNT; i++) {
+		qos = xmalloc(sizeof(*qos));
+		slurmdb_init_qos_rec(qos, 0, NO_VAL);
+		qos->id = i + 1;
+		qos->name = xstrdup_printf("qos%d", i);
+		list_append(list, qos);
+	}
+	_pack_list(DBD_ADD_QOS, list, true, buffer);
+
+	list = list_create(slurmdb_destroy_wckey_rec);
+	for (i = 0; i < user_cnt; i++) {
+		wckey = xmalloc(sizeof(*wckey));
+		slurmdb_init_wckey_rec(wckey, 0);
+		wckey->id = i + 1;
+		wckey->name = xstrdup_printf("wckey%d", i);
+		wckey->user = xstrdup_printf("aml_user%d", i);
+		wckey->cluster = xstrdup("test");
+		wckey->is_def = 1;
+		list_append(list, wckey);
+	}
+	_pack_list(DBD_ADD_WCKEYS, list, true, buffer);
+
+	list = list_create(slurmdb_destroy_assoc_rec);
+	list_append(list, _create_assoc(ROOT_ASSOC_ID, 0, "root", NULL));
+	for (i = 0; i < ACCT_CNT; i++) {
+		snprintf(acct, sizeof(acct), "acct%d", i);
+		list_append(list, _create_assoc(ACCT_ASSOC_ID(i),
+						ROOT_ASSOC_ID, acct, NULL));
+	}
+	for (i = 0; i < user_cnt; i++) {
+		snprintf(acct, sizeof(acct), "acct%d", i % ACCT_CNT);
+		snprintf(name, sizeof(name), "aml_user%d", i);
+		list_append(list, _create_assoc(USER_ASSOC_ID(i),
+						ACCT_ASSOC_ID(i % ACCT_CNT),
+						acct, name));
+	}
+	for (i = 0; i < 2; i++) {
+		snprintf(acct, sizeof(acct), "acct%d", i);
+		list_append(list, _create_assoc(USER_ASSOC_ID(user_cnt + i),
+						ACCT_ASSOC_ID(i), acct,
+						"root"));
+	}
+	_pack_list(DBD_ADD_ASSOCS, list, true, buffer);
+
+	return _write_file(dir, "assoc_mgr_state", buffer);
+}
+
+/* Send a single update of type for object through assoc_mgr_update() */
+static int _update(uint16_t type, void *object)
+{
+	slurmdb_update_object_t *update = xmalloc(sizeof(*update));
+	List update_list = list_create(slurmdb_destroy_update_object);
+	int rc;
+
+	update->type = type;
+	update->objects = list_create(NULL);
+	list_append(update->objects, object);
+	list_append(update_list, update);
+	rc = assoc_mgr_update(update_list, false);
+	FREE_NULL_LIST(update_list);
+
+	return rc;
+}
+
+static bool _find_user(char *name)
+{
+	slurmdb_user_rec_t user = { .uid = NO_VAL, .name = name };
+
+	return (assoc_mgr_fill_in_user(NULL, &user, ACCOUNTING_ENFORCE_ASSOCS,
+				       NULL, false) == SLURM_SUCCESS);
+}
+
+static bool _find_qos(uint32_t id, char *name)
+{
+	slurmdb_qos_rec_t qos = { .id = id, .name = name };
+	slurmdb_qos_rec_t *qos_ptr = NULL;
+
+	return ((assoc_mgr_fill_in_qos(NULL, &qos, ACCOUNTING_ENFORCE_QOS,
+				       &qos_ptr, false) == SLURM_SUCCESS) &&
+		qos_ptr);
+}
+
+int
+main(int argc, char *argv[])
+{
+	assoc_mgr_lock_t locks = { .assoc = READ_LOCK };
+	uint16_t running_cache = RUNNING_CACHE_STATE_RUNNING;
+	assoc_init_args_t args = {
+		.cache_level = ASSOC_MGR_CACHE_ALL,
+		.running_cache = &running_cache,
+	};
+	slurmdb_assoc_rec_t assoc, *assoc_ptr;
+	slurmdb_user_rec_t *user;
+	slurmdb_qos_rec_t *qos;
+	slurmdb_wckey_rec_t wckey;
+	struct timeval start;
+	List assoc_list;
+	char dir[] = "/tmp/assoc-mgr-test.XXXXXX", *dir_ptr = dir;
+	char name[32], *file;
+	int user_cnt = DEFAULT_USER_CNT, bad, i;
+
+	if (argc > 1)
+		user_cnt = atoi(argv[1]);
+	if (user_cnt < ACCT_CNT)
+		user_cnt = ACCT_CNT;
+
+	if (!mkdtemp(dir)) {
+		fail("state directory created");
+		totals();
+		return failed;
+	}
+	args.state_save_location = &dir_ptr;
+	slurm_conf.cluster_name = "test";
+
+	TEST(_write_state(dir, user_cnt) == SLURM_SUCCESS, "state written");
+	assoc_mgr_init(NULL, &args, SLURM_SUCCESS);
+	TEST(load_assoc_mgr_last_tres() == SLURM_SUCCESS, "tres loaded");
+	gettimeofday(&start, NULL);
+	TEST(load_assoc_mgr_state(false) == SLURM_SUCCESS, "state loaded");
+	note("loaded %d users in %ld usec", user_cnt, _elapsed_usec(&start));
+
+	/* Resolve every user's association as a job submission would */
+	gettimeofday(&start, NULL);
+	for (i = 0, bad = 0; i < user_cnt; i++) {
+		snprintf(name, sizeof(name), "aml_user%d", i);
+		memset(&assoc, 0, sizeof(assoc));
+		assoc.uid = NO_VAL;
+		assoc.user = name;
+		assoc.acct = NULL;
+		if (!_find_user(name)) {
+			bad++;
+			continue;
+		}
+		assoc.acct = xstrdup_printf("acct%d", i % ACCT_CNT);
+		if ((assoc_mgr_fill_in_assoc(NULL, &assoc,
+					     ACCOUNTING_ENFORCE_ASSOCS,
+					     &assoc_ptr, false) != SLURM_SUCCESS) ||
+		    !assoc_ptr || (assoc_ptr->id != USER_ASSOC_ID(i)))
+			bad++;
+		xfree(assoc.acct);
+	}
+	note("resolved %d associations in %ld usec", user_cnt,
+	     _elapsed_usec(&start));
+	TEST(!bad, "user associations resolved");
+
+	gettimeofday(&start, NULL);
+	for (i = 0, bad = 0; i < QOS_CNT; i++) {
+		snprintf(name, sizeof(name), "QOS%d", i);
+		if (!_find_qos(0, name) || !_find_qos(i + 1, NULL))
+			bad++;
+	}
+	note("resolved %d qos twice in %ld usec", QOS_CNT,
+	     _elapsed_usec(&start));
+	TEST(!bad, "qos found by name and id");
+	TEST(!_find_qos(0, "qos_missing"), "missing qos not found");
+
+	gettimeofday(&start, NULL);
+	for (i = 0, bad = 0; i < user_cnt; i++) {
+		slurmdb_wckey_rec_t *wckey_ptr = NULL;
+
+		snprintf(name, sizeof(name), "wckey%d", i);
+		memset(&wckey, 0, sizeof(wckey));
+		wckey.uid = NO_VAL;
+		wckey.name = name;
+		wckey.user = xstrdup_printf("aml_user%d", i);
+		if ((assoc_mgr_fill_in_wckey(NULL, &wckey,
+					     ACCOUNTING_ENFORCE_WCKEYS,
+					     &wckey_ptr, false) != SLURM_SUCCESS) ||
+		    !wckey_ptr || (wckey_ptr->id != i + 1))
+			bad++;
+		xfree(wckey.user);
+	}
+	note("resolved %d wckeys in %ld usec", user_cnt,
+	     _elapsed_usec(&start));
+	TEST(!bad, "wckeys found by user and name");
+
+	/* root resolves to uid 0 everywhere */
+	assoc_list = list_create(NULL);
+	memset(&assoc, 0, sizeof(assoc));
+	assoc.uid = 0;
+	assoc_mgr_lock(&locks);
+	TEST((assoc_mgr_get_user_assocs(NULL, &assoc,
+					ACCOUNTING_ENFORCE_ASSOCS,
+					assoc_list) == SLURM_SUCCESS) &&
+	     (list_count(assoc_list) == 2), "uid associations found");
+	assoc_mgr_unlock(&locks);
+	FREE_NULL_LIST(assoc_list);
+	TEST(assoc_mgr_get_admin_level(NULL, 0) == SLURMDB_ADMIN_SUPER_USER,
+	     "admin level found");
+	TEST(assoc_mgr_is_user_acct_coord(NULL, 0, "acct1") &&
+	     !assoc_mgr_is_user_acct_coord(NULL, 0, "acct0"),
+	     "coordinator found");
+
+	/* The indexes follow updates */
+	user = xmalloc(sizeof(*user));
+	user->name = xstrdup("aml_user0");
+	TEST((_update(SLURMDB_REMOVE_USER, user) == SLURM_SUCCESS) &&
+	     !_find_user("aml_user0") && _find_user("aml_user1"),
+	     "removed user not found");
+
+	user = xmalloc(sizeof(*user));
+	user->old_name = xstrdup("aml_user1");
+	user->name = xstrdup("aml_renamed");
+	user->admin_level = SLURMDB_ADMIN_NOTSET;
+	TEST((_update(SLURMDB_MODIFY_USER, user) == SLURM_SUCCESS) &&
+	     !_find_user("aml_user1") && _find_user("aml_renamed"),
+	     "renamed user found");
+
+	user = xmalloc(sizeof(*user));
+	user->name = xstrdup("aml_added");
+	TEST((_update(SLURMDB_ADD_USER, user) == SLURM_SUCCESS) &&
+	     _find_user("aml_added"), "added user found");
+
+	qos = xmalloc(sizeof(*qos));
+	slurmdb_init_qos_rec(qos, 0, NO_VAL);
+	qos->id = QOS_CNT + 1;
+	qos->name = xstrdup("qos_added");
+	TEST((_update(SLURMDB_ADD_QOS, qos) == SLURM_SUCCESS) &&
+	     _find_qos(0, "qos_added") && _find_qos(QOS_CNT + 1, NULL),
+	     "added qos found");
+
+	qos = xmalloc(sizeof(*qos));
+	slurmdb_init_qos_rec(qos, 0, NO_VAL);
+	qos->id = 1;
+	TEST((_update(SLURMDB_REMOVE_QOS, qos) == SLURM_SUCCESS) &&
+	     !_find_qos(0, "qos0") && !_find_qos(1, NULL) &&
+	     _find_qos(0, "qos1"), "removed qos not found");
+
+	assoc_mgr_fini(false);
+	file = xstrdup_printf("%s/last_tres", dir);
+	unlink(file);
+	xfree(file);
+	file = xstrdup_printf("%s/assoc_mgr_state", dir);
+	unlink(file);
+	xfree(file);
+	rmdir(dir);
+
+	totals();
+	return failed;
+}
@@ -0,0 +1,166 @@
+/*
+ * Test and micro-benchmark of launch credential verification in
+ * src/common/slurm_cred.c
+ *
+ * Uses the cred/none plugin, loaded from $SLURM_TEST_PLUGIN_DIR or else
+ * from the build tree. The number of credentials verified may be given as
+ * the first argument.
+ *
+ * Avoid duplicate wait() symbol definition (in both testsuite/dejagnu.h
+ * and sys/wait.h
+ */
+#define _SYS_WAIT_H 1
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "slurm/slurm_errno.h"
+#include "src/common/bitstring.h"
+#include "src/common/read_config.h"
+#include "src/common/slurm_cred.h"
+#include "src/common/slurm_protocol_api.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include <testsuite/dejagnu.h>
+
+/*
+ * Test for failure:
+ */
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define DEFAULT_CRED_CNT 20000
+#define PLUGIN_DIR "../../../src/plugins/cred/none/.libs"
+
+static long _elapsed_usec(struct timeval *start)
+{
+	struct timeval end;
+
+	gettimeofday(&end, NULL);
+	return ((end.tv_sec - start->tv_sec) * 1000000) +
+		(end.tv_usec - start->tv_usec);
+}
+
+static void _report(const char *what, int cnt, long usec)
+{
+	note("%s: %d credentials in %ld usec (%.0f/sec)", what, cnt, usec,
+	     usec ? ((double) cnt * 1000000 / usec) : 0.0);
+}
+
+int
+main(int argc, char *argv[])
+{
+	slurm_cred_ctx_t creator, verifier;
+	slurm_cred_t **creds;
+	slurm_cred_arg_t arg, out;
+	struct timeval start;
+	uint16_t cores_per_socket = 1, sockets_per_node = 1;
+	uint32_t sock_core_rep_count = 1;
+	int cred_cnt = DEFAULT_CRED_CNT, ok_cnt, i;
+	char *plugin_dir;
+
+	if (argc > 1)
+		cred_cnt = atoi(argv[1]);
+	if (cred_cnt < 1)
+		cred_cnt = 1;
+
+	if (!(plugin_dir = getenv("SLURM_TEST_PLUGIN_DIR")))
+		plugin_dir = PLUGIN_DIR;
+	slurm_conf.plugindir = xstrdup(plugin_dir);
+	slurm_conf.cred_type = xstrdup("cred/none");
+	slurm_conf.launch_params = xstrdup("disable_send_gids");
+
+	if (slurm_cred_init() != SLURM_SUCCESS) {
+		note("cred/none plugin not found in %s, skipping", plugin_dir);
+		return 77;
+	}
+
+	creator = slurm_cred_creator_ctx_create(NULL);
+	verifier = slurm_cred_verifier_ctx_create(NULL);
+	TEST(creator && verifier, "credential contexts created");
+	if (!creator || !verifier) {
+		totals();
+		return failed;
+	}
+
+	memset(&arg, 0, sizeof(arg));
+	arg.uid = getuid();
+	arg.gid = getgid();
+	arg.step_hostlist = "node0";
+	arg.job_hostlist = "node0";
+	arg.job_nhosts = 1;
+	arg.job_core_bitmap = bit_alloc(1);
+	bit_set(arg.job_core_bitmap, 0);
+	arg.step_core_bitmap = bit_copy(arg.job_core_bitmap);
+	arg.cores_per_socket = &cores_per_socket;
+	arg.sockets_per_node = &sockets_per_node;
+	arg.sock_core_rep_count = &sock_core_rep_count;
+
+	creds = xcalloc(cred_cnt, sizeof(slurm_cred_t *));
+	for (i = 0; i < cred_cnt; i++) {
+		arg.step_id.job_id = i + 1;
+		arg.step_id.step_id = 0;
+		arg.step_id.step_het_comp = NO_VAL;
+		if (!(creds[i] = slurm_cred_create(creator, &arg,
+						   SLURM_PROTOCOL_VERSION)))
+			break;
+	}
+	TEST(i == cred_cnt, "credentials created");
+	cred_cnt = i;
+
+	/* Every job and cred state is new, each lookup misses */
+	ok_cnt = 0;
+	gettimeofday(&start, NULL);
+	for (i = 0; i < cred_cnt; i++) {
+		if (slurm_cred_verify(verifier, creds[i], &out,
+				      SLURM_PROTOCOL_VERSION) == SLURM_SUCCESS) {
+			slurm_cred_free_args(&out);
+			ok_cnt++;
+		}
+	}
+	_report("first verification", cred_cnt, _elapsed_usec(&start));
+	TEST(ok_cnt == cred_cnt, "credentials verified");
+
+	/* Every lookup now finds the credential state */
+	ok_cnt = 0;
+	gettimeofday(&start, NULL);
+	for (i = 0; i < cred_cnt; i++) {
+		if ((slurm_cred_verify(verifier, creds[i], &out,
+				       SLURM_PROTOCOL_VERSION) != SLURM_SUCCESS)
+		    && (slurm_get_errno() == ESLURMD_CREDENTIAL_REPLAYED))
+			ok_cnt++;
+	}
+	_report("replay detection", cred_cnt, _elapsed_usec(&start));
+	TEST(ok_cnt == cred_cnt, "replayed credentials rejected");
+
+	TEST(slurm_cred_jobid_cached(verifier, cred_cnt), "job state cached");
+	TEST(!slurm_cred_jobid_cached(verifier, cred_cnt + 1),
+	     "job state not cached");
+
+	TEST(slurm_cred_rewind(verifier, creds[0]) == SLURM_SUCCESS,
+	     "credential rewound");
+	i = slurm_cred_verify(verifier, creds[0], &out, SLURM_PROTOCOL_VERSION);
+	TEST(i == SLURM_SUCCESS, "rewound credential verified");
+	if (i == SLURM_SUCCESS)
+		slurm_cred_free_args(&out);
+
+	TEST(slurm_cred_revoke(verifier, 1, time(NULL), 0) == SLURM_SUCCESS,
+	     "job credentials revoked");
+	TEST(slurm_cred_revoked(verifier, creds[0]), "credential revoked");
+
+	for (i = 0; i < cred_cnt; i++)
+		slurm_cred_destroy(creds[i]);
+	xfree(creds);
+	FREE_NULL_BITMAP(arg.job_core_bitmap);
+	FREE_NULL_BITMAP(arg.step_core_bitmap);
+	slurm_cred_ctx_destroy(creator);
+	slurm_cred_ctx_destroy(verifier);
+	slurm_cred_fini();
+
+	totals();
+	return failed;
+}
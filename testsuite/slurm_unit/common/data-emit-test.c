@@ -0,0 +1,220 @@
+/*
+ * Test of the slurmrestd JSON and YAML emitters in src/slurmrestd/xjson.c
+ * and src/slurmrestd/xyaml.c
+ *
+ * Dumps a small tree and checks the exact JSON, then dumps a tree larger
+ * than the emitter's staging buffer through write_buf() and through a
+ * counting writer and checks both give the same output. Output is parsed
+ * back where the parsers were compiled in.
+ *
+ * Avoid duplicate wait() symbol definition (in both testsuite/dejagnu.h
+ * and sys/wait.h
+ */
+#define _SYS_WAIT_H 1
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config.h"
+
+#include "slurm/slurm_errno.h"
+#include "src/common/data.h"
+#include "src/common/pack.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include "src/slurmrestd/xjson.h"
+#include "src/slurmrestd/xyaml.h"
+#include <testsuite/dejagnu.h>
+
+/*
+ * Test for failure:
+ */
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define JOB_CNT 500
+#define LONG_STR_LEN 10000
+
+static const char small_compact[] =
+	"{\"name\":\"a \\\"b\\\"\\n\\t\\u0001\",\"id\":42,\"ratio\":2.0,"
+	"\"ok\":true,\"none\":null,\"list\":[1,\"x\",{}],\"empty\":[]}";
+
+static const char small_pretty[] =
+	"{\n"
+	"  \"name\": \"a \\\"b\\\"\\n\\t\\u0001\",\n"
+	"  \"id\": 42,\n"
+	"  \"ratio\": 2.0,\n"
+	"  \"ok\": true,\n"
+	"  \"none\": null,\n"
+	"  \"list\": [\n"
+	"    1,\n"
+	"    \"x\",\n"
+	"    {}\n"
+	"  ],\n"
+	"  \"empty\": []\n"
+	"}";
+
+typedef struct {
+	Buf buffer;
+	int calls;
+	int fail_at;
+} writer_args_t;
+
+/* Keep every piece handed to us, fail on call fail_at if set */
+static int _count_write(void *arg, const char *buf, size_t len)
+{
+	writer_args_t *args = arg;
+
+	if (++args->calls == args->fail_at)
+		return SLURM_ERROR;
+
+	return write_buf(args->buffer, buf, len);
+}
+
+static data_t *_build_small(void)
+{
+	data_t *d = data_set_dict(data_new());
+	data_t *list;
+
+	data_set_string(data_key_set(d, "name"), "a \"b\"\n\t\001");
+	data_set_int(data_key_set(d, "id"), 42);
+	data_set_float(data_key_set(d, "ratio"), 2);
+	data_set_bool(data_key_set(d, "ok"), true);
+	data_set_null(data_key_set(d, "none"));
+	list = data_set_list(data_key_set(d, "list"));
+	data_set_int(data_list_append(list), 1);
+	data_set_string(data_list_append(list), "x");
+	data_set_dict(data_list_append(list));
+	data_set_list(data_key_set(d, "empty"));
+
+	return d;
+}
+
+static data_t *_build_large(void)
+{
+	data_t *d = data_set_dict(data_new());
+	data_t *jobs = data_set_list(data_key_set(d, "jobs"));
+	char *str = xmalloc(LONG_STR_LEN + 1);
+
+	memset(str, 'z', LONG_STR_LEN);
+	data_set_string_own(data_key_set(d, "long"), str);
+
+	for (int i = 0; i < JOB_CNT; i++) {
+		data_t *job = data_set_dict(data_list_append(jobs));
+
+		data_set_int(data_key_set(job, "job_id"), i);
+		data_set_string(data_key_set(job, "partition"), "debug");
+		data_set_float(data_key_set(job, "billing"), i / 4.0);
+		data_set_bool(data_key_set(job, "requeue"), (i % 2));
+	}
+
+	return d;
+}
+
+/* Dump through a counting writer, RET output or NULL on error */
+static char *_dump_stream(const data_t *d, bool yaml, int fail_at,
+			  int *calls)
+{
+	writer_args_t args = { init_buf(1), 0, fail_at };
+	int rc;
+
+	if (yaml)
+		rc = dump_yaml_stream(d, _count_write, &args);
+	else
+		rc = dump_json_stream(d, DUMP_JSON_FLAGS_PRETTY, _count_write,
+				      &args);
+	*calls = args.calls;
+
+	if (rc) {
+		free_buf(args.buffer);
+		return NULL;
+	}
+
+	get_buf_data(args.buffer)[get_buf_offset(args.buffer)] = '\0';
+	return xfer_buf_data(args.buffer);
+}
+
+int
+main(int argc, char *argv[])
+{
+	data_t *small, *large;
+	char *out, *stream_out;
+	int calls, bad = 0;
+	Buf buffer;
+
+	if (data_init_static()) {
+		fail("data_init_static");
+		totals();
+		return failed;
+	}
+	small = _build_small();
+	large = _build_large();
+
+	/* write_buf() grows as needed and leaves room for the NUL */
+	buffer = init_buf(1);
+	for (int i = 0; i < 100; i++)
+		if (write_buf(buffer, "0123456789", 10) ||
+		    (remaining_buf(buffer) < 1))
+			bad++;
+	TEST(!bad && (get_buf_offset(buffer) == 1000) &&
+	     !memcmp(get_buf_data(buffer) + 990, "0123456789", 10),
+	     "write_buf appends");
+	free_buf(buffer);
+
+	out = dump_json(small, DUMP_JSON_FLAGS_COMPACT);
+	TEST(!xstrcmp(out, small_compact), "compact JSON");
+	xfree(out);
+
+	out = dump_json(small, DUMP_JSON_FLAGS_PRETTY);
+	TEST(!xstrcmp(out, small_pretty), "pretty JSON");
+	xfree(out);
+
+	out = dump_json(large, DUMP_JSON_FLAGS_PRETTY);
+	stream_out = _dump_stream(large, false, 0, &calls);
+	TEST(out && !xstrcmp(out, stream_out), "JSON stream matches dump");
+	TEST(calls > 1, "JSON written a piece at a time");
+	note("JSON of %zu bytes written in %d pieces",
+	     (out ? strlen(out) : 0), calls);
+#if HAVE_JSON
+	{
+		data_t *parsed = parse_json(out, strlen(out));
+
+		TEST(parsed && data_check_match(large, parsed, false),
+		     "JSON parsed back");
+		FREE_NULL_DATA(parsed);
+	}
+#endif
+	xfree(out);
+	xfree(stream_out);
+
+	TEST(!_dump_stream(large, false, 2, &calls) && (calls == 2),
+	     "JSON writer error stops the dump");
+
+#if HAVE_YAML
+	out = dump_yaml(large);
+	stream_out = _dump_stream(large, true, 0, &calls);
+	TEST(out && !xstrcmp(out, stream_out), "YAML stream matches dump");
+	TEST(calls > 1, "YAML written a piece at a time");
+	{
+		data_t *parsed = parse_yaml(out, strlen(out));
+
+		TEST(parsed && data_check_match(large, parsed, false),
+		     "YAML parsed back");
+		FREE_NULL_DATA(parsed);
+	}
+	xfree(out);
+	xfree(stream_out);
+
+	TEST(!_dump_stream(large, true, 2, &calls),
+	     "YAML writer error stops the dump");
+#endif
+
+	FREE_NULL_DATA(small);
+	FREE_NULL_DATA(large);
+
+	totals();
+	return failed;
+}
@@ -0,0 +1,183 @@
+/*
+ * Test of the dictionary key index and arena allocation of data_t in
+ * src/common/data.c
+ *
+ * Builds a large dictionary and checks lookups, removals and key order,
+ * then builds a response like tree of job dictionaries with and without an
+ * arena. The number of keys and jobs may be given as the first argument.
+ *
+ * Avoid duplicate wait() symbol definition (in both testsuite/dejagnu.h
+ * and sys/wait.h
+ */
+#define _SYS_WAIT_H 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "slurm/slurm_errno.h"
+#include "src/common/data.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include <testsuite/dejagnu.h>
+
+/*
+ * Test for failure:
+ */
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define DEFAULT_KEY_CNT 20000
+#define JOB_KEY_CNT 40
+
+static long _elapsed_usec(struct timeval *start)
+{
+	struct timeval end;
+
+	gettimeofday(&end, NULL);
+	return ((end.tv_sec - start->tv_sec) * 1000000) +
+		(end.tv_usec - start->tv_usec);
+}
+
+typedef struct {
+	int64_t next;
+	int bad;
+} order_args_t;
+
+/* Check keys come back in the order they were added */
+static data_for_each_cmd_t _check_order(const char *key, const data_t *d,
+					void *arg)
+{
+	order_args_t *args = arg;
+
+	while (args->next % 2)
+		args->next++;
+	if (data_get_int(d) != args->next)
+		args->bad++;
+	args->next++;
+
+	return DATA_FOR_EACH_CONT;
+}
+
+static data_for_each_cmd_t _delete_all(const char *key, data_t *d, void *arg)
+{
+	return DATA_FOR_EACH_DELETE;
+}
+
+static void _build_jobs(data_t *jobs, int job_cnt)
+{
+	char key[32];
+
+	for (int i = 0; i < job_cnt; i++) {
+		data_t *job = data_set_dict(data_list_append(jobs));
+
+		for (int k = 0; k < JOB_KEY_CNT; k++) {
+			snprintf(key, sizeof(key), "field_%d", k);
+			if (k % 2)
+				data_set_int(data_key_set(job, key), i);
+			else
+				data_set_string(data_key_set(job, key), key);
+		}
+		data_set_string_own(data_key_set(job, "name"),
+				    xstrdup_printf("job%d", i));
+	}
+}
+
+int
+main(int argc, char *argv[])
+{
+	struct timeval start;
+	data_t *dict, *jobs, *arena_jobs, *copy;
+	order_args_t args = { 0 };
+	char key[32];
+	int key_cnt = DEFAULT_KEY_CNT, bad = 0, i;
+	long usec;
+
+	if (argc > 1)
+		key_cnt = atoi(argv[1]);
+	if (key_cnt < 100)
+		key_cnt = 100;
+
+	if (data_init_static()) {
+		fail("data_init_static");
+		totals();
+		return failed;
+	}
+
+	dict = data_set_dict(data_new());
+	gettimeofday(&start, NULL);
+	for (i = 0; i < key_cnt; i++) {
+		snprintf(key, sizeof(key), "key%d", i);
+		data_set_int(data_key_set(dict, key), i);
+	}
+	for (i = 0; i < key_cnt; i++) {
+		const data_t *d;
+
+		snprintf(key, sizeof(key), "key%d", i);
+		if (!(d = data_key_get_const(dict, key)) ||
+		    (data_get_int(d) != i))
+			bad++;
+	}
+	note("set and got %d keys in %ld usec", key_cnt,
+	     _elapsed_usec(&start));
+	TEST(!bad, "all keys found");
+	TEST(data_get_dict_length(dict) == key_cnt, "dictionary length");
+	TEST(!data_key_get(dict, "missing"), "missing key not found");
+	TEST(data_key_set(dict, "key1") == data_key_get(dict, "key1"),
+	     "existing key reused");
+
+	for (i = 1; i < key_cnt; i += 2) {
+		snprintf(key, sizeof(key), "key%d", i);
+		if (!data_key_unset(dict, key))
+			bad++;
+	}
+	TEST(!bad, "odd keys removed");
+	TEST(!data_key_get(dict, "key1") && data_key_get(dict, "key2"),
+	     "removed keys gone");
+	TEST(data_dict_for_each_const(dict, _check_order, &args) ==
+	     (key_cnt + 1) / 2, "remaining keys walked");
+	TEST(!args.bad, "key order kept");
+
+	TEST(data_dict_for_each(dict, _delete_all, NULL) == (key_cnt + 1) / 2,
+	     "all keys deleted while walking");
+	TEST(!data_get_dict_length(dict), "dictionary empty");
+	data_set_int(data_key_set(dict, "key0"), 0);
+	TEST(data_key_get(dict, "key0"), "key set after delete");
+	FREE_NULL_DATA(dict);
+
+	gettimeofday(&start, NULL);
+	jobs = data_set_list(data_new());
+	_build_jobs(jobs, key_cnt / 10);
+	copy = data_new();
+	data_copy(copy, jobs);
+	usec = _elapsed_usec(&start);
+	gettimeofday(&start, NULL);
+	FREE_NULL_DATA(jobs);
+	note("built %d jobs in %ld usec, freed in %ld usec", key_cnt / 10,
+	     usec, _elapsed_usec(&start));
+
+	gettimeofday(&start, NULL);
+	arena_jobs = data_set_list(data_new_arena());
+	_build_jobs(arena_jobs, key_cnt / 10);
+	usec = _elapsed_usec(&start);
+	TEST(data_check_match(copy, arena_jobs, false), "arena tree matches");
+
+	/* replacing parts of an arena tree must leave the rest alone */
+	data_set_dict(data_list_append(arena_jobs));
+	data_set_null(data_list_append(arena_jobs));
+	TEST(data_get_list_length(arena_jobs) == (key_cnt / 10) + 2,
+	     "arena list appended");
+
+	gettimeofday(&start, NULL);
+	FREE_NULL_DATA(arena_jobs);
+	note("built %d jobs in arena in %ld usec, freed in %ld usec",
+	     key_cnt / 10, usec, _elapsed_usec(&start));
+	FREE_NULL_DATA(copy);
+
+	data_destroy_static();
+	totals();
+	return failed;
+}
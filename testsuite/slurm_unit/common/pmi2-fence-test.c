@@ -0,0 +1,340 @@
+/*
+ * Time the mpi/pmi2 KVS fence of one node with fake PMI clients
+ *
+ * Forks 64, 128 and 256 fake clients playing the tasks of a node. Each
+ * client puts <keys> values of <size> bytes and fences, once staging the
+ * puts in the node-local KVS segment the way libpmi2 does and once sending
+ * one put command per pair over its socket the way other PMI clients do.
+ * The test plays slurmstepd with the plugin's kvs.c: it answers the puts,
+ * drains the slots as the fences arrive and checks that the node blob sent
+ * up the tree holds every pair. The fence times are reported as notes.
+ *
+ * usage: pmi2-fence-test [keys] [size]
+ *
+ * Avoid duplicate wait() symbol definition (in both testsuite/dejagnu.h
+ * and sys/wait.h
+ */
+#define _SYS_WAIT_H 1
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "slurm/slurm_errno.h"
+/* as in the plugin, slurm_xlator.h has to come before the common headers */
+#include "src/plugins/mpi/pmi2/setup.h"
+#include "src/plugins/mpi/pmi2/kvs.h"
+#include "src/plugins/mpi/pmi2/pmi.h"
+#include "src/common/env.h"
+#include "src/common/pack.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include <testsuite/dejagnu.h>
+
+extern pid_t waitpid(pid_t pid, int *status, int options);
+
+/*
+ * Test for failure:
+ */
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define DEFAULT_KEYS 4
+#define DEFAULT_SIZE 256
+#define CMD_LEN_SIZE 6
+#define MAX_CMD_LEN (PMI2_MAX_VALLEN + 256)
+
+/* What the plugin's kvs.c expects from the rest of the plugin */
+const char plugin_type[] = "mpi/pmi2";
+pmi2_job_info_t job_info;
+pmi2_tree_info_t tree_info;
+char tree_sock_addr[128];
+
+static int keys = DEFAULT_KEYS, vsize = DEFAULT_SIZE;
+static uint32_t blob_pairs = 0, blob_bad = 0, blob_size = 0;
+
+extern bool in_stepd(void)
+{
+	return true;
+}
+
+/* The node blob of a first level slurmstepd, check every pair in it */
+extern int tree_msg_to_srun(uint32_t len, char *msg)
+{
+	Buf buf = init_buf(len);
+	uint16_t cmd;
+	uint32_t nodeid, num_children, seq, key_len, val_len;
+	char *node, *key, *val, expect[64];
+	int gtid, k;
+
+	memcpy(get_buf_data(buf), msg, len);
+	blob_size = len;
+	blob_pairs = blob_bad = 0;
+	if (unpack16(&cmd, buf) || (cmd != TREE_CMD_KVS_FENCE) ||
+	    unpack32(&nodeid, buf) || unpackmem_ptr(&node, &key_len, buf) ||
+	    unpack32(&num_children, buf) || unpack32(&seq, buf)) {
+		blob_bad++;
+		goto fini;
+	}
+
+	while (remaining_buf(buf)) {
+		if (unpackmem_ptr(&key, &key_len, buf) ||
+		    unpackmem_ptr(&val, &val_len, buf) ||
+		    (sscanf(key, "bc-%d-%d", &gtid, &k) != 2)) {
+			blob_bad++;
+			break;
+		}
+		snprintf(expect, sizeof(expect), "bc-%d-%d", gtid, k);
+		if (xstrcmp(key, expect) || (val_len != vsize) ||
+		    (val[0] != 'a' + (gtid + k) % 26) || val[vsize - 1])
+			blob_bad++;
+		blob_pairs++;
+	}
+
+fini:
+	free_buf(buf);
+	return SLURM_SUCCESS;
+}
+
+static long _elapsed_usec(struct timeval *start)
+{
+	struct timeval end;
+
+	gettimeofday(&end, NULL);
+	return ((end.tv_sec - start->tv_sec) * 1000000) +
+		(end.tv_usec - start->tv_usec);
+}
+
+/* PMI2 wire format: 6 digit length followed by "cmd=...;" */
+static int _send_cmd(int fd, const char *cmd)
+{
+	char buf[MAX_CMD_LEN + CMD_LEN_SIZE + 1];
+	int len;
+
+	len = snprintf(buf, sizeof(buf), "%-*d%s", CMD_LEN_SIZE,
+		       (int) strlen(cmd), cmd);
+	return (write(fd, buf, len) == len) ? 0 : -1;
+}
+
+static int _read_all(int fd, char *buf, int len)
+{
+	int n;
+
+	while (len > 0) {
+		if ((n = read(fd, buf, len)) <= 0)
+			return -1;
+		buf += n;
+		len -= n;
+	}
+	return 0;
+}
+
+static int _recv_cmd(int fd, char *buf)
+{
+	char len_buf[CMD_LEN_SIZE + 1];
+	int len;
+
+	if (_read_all(fd, len_buf, CMD_LEN_SIZE))
+		return -1;
+	len_buf[CMD_LEN_SIZE] = '\0';
+	len = atoi(len_buf);
+	if ((len <= 0) || (len > MAX_CMD_LEN) || _read_all(fd, buf, len))
+		return -1;
+	buf[len] = '\0';
+	return 0;
+}
+
+/* Append a pair to our slot, the same way libpmi2's PMIi_ShmPut() does */
+static int _shm_put(pmi2_shm_slot_t *slot, const char *key, const char *val)
+{
+	size_t key_len = strlen(key) + 1, val_len = strlen(val) + 1;
+
+	if (slot->used + key_len + val_len > PMI2_SHM_DATA_SIZE)
+		return 0;
+	memcpy(slot->data + slot->used, key, key_len);
+	memcpy(slot->data + slot->used + key_len, val, val_len);
+	slot->used += key_len + val_len;
+	slot->count++;
+	return 1;
+}
+
+/* A fake PMI client, put our values and fence */
+static int _client(int fd, int rank)
+{
+	pmi2_shm_hdr_t *hdr = NULL;
+	pmi2_shm_slot_t *slot = NULL;
+	struct stat st;
+	char key[64], *val, *cmd;
+	int k;
+
+	if (shm_kvs_fd >= 0) {
+		if (fstat(shm_kvs_fd, &st) ||
+		    ((hdr = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+				 MAP_SHARED, shm_kvs_fd, 0)) == MAP_FAILED) ||
+		    (hdr->magic != PMI2_SHM_MAGIC) || (rank >= hdr->slot_cnt))
+			return 1;
+		slot = PMI2_SHM_SLOT(hdr, rank);
+	}
+
+	val = xmalloc(vsize);
+	cmd = xmalloc(MAX_CMD_LEN + 1);
+
+	/* wait until all clients are there */
+	if (read(fd, cmd, 1) != 1)
+		return 1;
+
+	for (k = 0; k < keys; k++) {
+		snprintf(key, sizeof(key), "bc-%d-%d", rank, k);
+		memset(val, 'a' + (rank + k) % 26, vsize - 1);
+		val[vsize - 1] = '\0';
+		if (slot && _shm_put(slot, key, val))
+			continue;
+		snprintf(cmd, MAX_CMD_LEN, "cmd=kvs-put;key=%s;value=%s;",
+			 key, val);
+		if (_send_cmd(fd, cmd) || _recv_cmd(fd, cmd) ||
+		    xstrcmp(cmd, "cmd=kvs-put-response;rc=0;"))
+			return 1;
+	}
+
+	if (_send_cmd(fd, "cmd=kvs-fence;") || _recv_cmd(fd, cmd) ||
+	    xstrcmp(cmd, "cmd=kvs-fence-response;rc=0;"))
+		return 1;
+	return 0;
+}
+
+/* Play slurmstepd for one fence of ntasks clients, RET fence time or -1 */
+static long _fence(int ntasks, bool use_shm)
+{
+	struct pollfd *pfds = xcalloc(ntasks, sizeof(struct pollfd));
+	pid_t *pids = xcalloc(ntasks, sizeof(pid_t));
+	char **env = NULL, *cmd = xmalloc(MAX_CMD_LEN + 1), *key, *val, *p;
+	int fds[2], i, fences = 0, status, bad = 0;
+	struct timeval start;
+	long usec = -1;
+
+	job_info.ltasks = ntasks;
+	xfree(job_info.gtids);
+	job_info.gtids = xcalloc(ntasks, sizeof(uint32_t));
+	for (i = 0; i < ntasks; i++)
+		job_info.gtids[i] = i;
+	if (!use_shm)
+		env_array_append(&env, PMI2_SHM_DISABLE_ENV, "1");
+	shm_kvs_init(&env);
+	temp_kvs_init();
+
+	for (i = 0; i < ntasks; i++) {
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0)
+			goto fini;
+		if ((pids[i] = fork()) == 0) {
+			close(fds[0]);
+			_exit(_client(fds[1], i));
+		}
+		close(fds[1]);
+		pfds[i].fd = fds[0];
+		pfds[i].events = POLLIN;
+	}
+
+	gettimeofday(&start, NULL);
+	for (i = 0; i < ntasks; i++)
+		if (write(pfds[i].fd, "g", 1) != 1)
+			goto fini;
+
+	while (fences < ntasks) {
+		if (poll(pfds, ntasks, 10000) <= 0)
+			goto fini;
+		for (i = 0; i < ntasks; i++) {
+			if (!(pfds[i].revents & (POLLIN | POLLHUP)))
+				continue;
+			if (_recv_cmd(pfds[i].fd, cmd))
+				goto fini;
+			if (!xstrncmp(cmd, "cmd=kvs-put;", 12)) {
+				key = cmd + 12 + 4;
+				if (!(p = strchr(key, ';')))
+					goto fini;
+				*p = '\0';
+				val = p + 1 + 6;
+				if (!(p = strchr(val, ';')))
+					goto fini;
+				*p = '\0';
+				shm_kvs_drain(i);
+				temp_kvs_add(key, val);
+				_send_cmd(pfds[i].fd,
+					  "cmd=kvs-put-response;rc=0;");
+			} else if (!xstrcmp(cmd, "cmd=kvs-fence;")) {
+				shm_kvs_drain(i);
+				pfds[i].events = 0;
+				fences++;
+			} else
+				goto fini;
+		}
+	}
+
+	temp_kvs_send();
+	for (i = 0; i < ntasks; i++)
+		_send_cmd(pfds[i].fd, "cmd=kvs-fence-response;rc=0;");
+	usec = _elapsed_usec(&start);
+
+fini:
+	for (i = 0; i < ntasks; i++) {
+		if (pfds[i].fd > 0)
+			close(pfds[i].fd);
+		if (pids[i] > 0) {
+			if ((waitpid(pids[i], &status, 0) != pids[i]) ||
+			    status)
+				bad++;
+		}
+	}
+	shm_kvs_fini();
+	env_array_free(env);
+	xfree(cmd);
+	xfree(pfds);
+	xfree(pids);
+
+	return bad ? -1 : usec;
+}
+
+int
+main(int argc, char *argv[])
+{
+	static const int ntasks[] = { 64, 128, 256 };
+	char msg[128];
+	long usec;
+	int i, s;
+
+	if (argc > 1)
+		keys = atoi(argv[1]);
+	if (argc > 2)
+		vsize = atoi(argv[2]);
+	if ((keys < 1) || (keys * (vsize + 16) > PMI2_SHM_DATA_SIZE))
+		keys = DEFAULT_KEYS;
+	if ((vsize < 2) || (vsize > PMI2_MAX_VALLEN - 64))
+		vsize = DEFAULT_SIZE;
+
+	job_info.step_id.job_id = getpid();
+	tree_info.this_node = "node0";
+
+	for (i = 0; i < sizeof(ntasks) / sizeof(ntasks[0]); i++) {
+		for (s = 0; s < 2; s++) {
+			usec = _fence(ntasks[i], s);
+			snprintf(msg, sizeof(msg), "%d tasks fence over %s",
+				 ntasks[i], s ? "shared memory" : "sockets");
+			TEST((usec >= 0) && !blob_bad &&
+			     (blob_pairs == ntasks[i] * keys), msg);
+			note("%s: %ld usec, node blob of %u pairs in %u bytes",
+			     msg, usec, blob_pairs, blob_size);
+		}
+	}
+	xfree(job_info.gtids);
+
+	totals();
+	return failed;
+}
@@ -0,0 +1,368 @@
+/*
+ * Test of the sacct --columnar writer in src/sacct/columnar.c
+ *
+ * Writes synthesized job and step records, more than fit in one row group,
+ * decodes the output the way contribs/sacct_columnar.py does and checks
+ * every row against the records it came from.
+ *
+ * Avoid duplicate wait() symbol definition (in both testsuite/dejagnu.h
+ * and sys/wait.h
+ */
+#define _SYS_WAIT_H 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "slurm/slurm_errno.h"
+#include "src/common/pack.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include "src/sacct/sacct.h"
+#include <testsuite/dejagnu.h>
+
+/*
+ * Test for failure:
+ */
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define JOB_CNT 30000
+
+/* What sacct.c has for columnar.c */
+sacct_parameters_t params;
+List g_tres_list = NULL;
+void *acct_db_conn = NULL;
+
+typedef struct {
+	slurmdb_job_rec_t *job;
+	slurmdb_step_rec_t *step;	/* NULL on the job row */
+} row_t;
+
+typedef struct {
+	char *name;
+	uint8_t type;
+	uint64_t *ints;		/* COLUMN_UINT32 and COLUMN_UINT64 */
+	char **strs;		/* COLUMN_STRING, point into the output */
+} column_t;
+
+static row_t *rows = NULL;
+static int row_cnt = 0;
+static column_t *columns = NULL;
+static uint32_t column_cnt = 0;
+
+static void _add_tres(uint32_t id, char *type, char *name)
+{
+	slurmdb_tres_rec_t *tres = xmalloc(sizeof(*tres));
+
+	tres->id = id;
+	tres->type = xstrdup(type);
+	tres->name = xstrdup(name);
+	list_append(g_tres_list, tres);
+}
+
+static void _set_stats(slurmdb_stats_t *stats, int i)
+{
+	stats->consumed_energy = 1000 + i;
+	stats->tres_usage_in_max = xstrdup_printf("1=%d,2=%d", i, i * 1024);
+	stats->tres_usage_in_max_nodeid = xstrdup("1=0,2=1");
+}
+
+/*
+ * Every fifth job does not track its steps and has its usage on the job
+ * record, the others have a batch step and one step. Some strings are NULL.
+ */
+static slurmdb_job_rec_t *_make_job(int i)
+{
+	slurmdb_job_rec_t *job = xmalloc(sizeof(*job));
+	int step_cnt = (i % 5) ? 2 : 1;
+
+	job->jobid = 1000 + i;
+	job->array_task_id = NO_VAL;
+	job->het_job_offset = NO_VAL;
+	job->cluster = (i % 7) ? xstrdup("cluster") : NULL;
+	job->partition = xstrdup((i % 2) ? "batch" : "debug");
+	job->jobname = xstrdup_printf("job%d", i);
+	job->uid = i % 100;
+	job->gid = i % 10;
+	job->state = (i % 3) ? JOB_COMPLETE : JOB_FAILED;
+	job->submit = 1600000000 + i;
+	job->start = job->submit + 10;
+	job->end = job->start + 3600 + i;
+	job->alloc_nodes = (i % 4) + 1;
+	job->nodes = xstrdup_printf("n[%d-%d]", i, i + job->alloc_nodes - 1);
+	job->req_mem = (uint64_t) i << 33;
+	job->tres_alloc_str = xstrdup_printf("1=%d,2=%d", i % 64, i);
+	job->track_steps = (i % 5) ? 1 : 0;
+	job->steps = list_create(NULL);
+
+	rows[row_cnt++] = (row_t) { job, NULL };
+	for (int s = 0; s < step_cnt; s++) {
+		slurmdb_step_rec_t *step = xmalloc(sizeof(*step));
+
+		step->job_ptr = job;
+		step->step_id.job_id = job->jobid;
+		step->step_id.step_id = s ? 0 : SLURM_BATCH_SCRIPT;
+		step->step_id.step_het_comp = NO_VAL;
+		step->stepname = (s || (i % 3)) ?
+			xstrdup(s ? "a.out" : "batch") : NULL;
+		step->nodes = xstrdup(job->nodes);
+		step->nnodes = job->alloc_nodes;
+		step->ntasks = job->alloc_nodes * 4 + s;
+		step->state = job->state;
+		step->start = job->start + s;
+		step->end = job->end;
+		step->tres_alloc_str = xstrdup_printf("1=%d", s);
+		_set_stats(&step->stats, i + s);
+		list_append(job->steps, step);
+		rows[row_cnt++] = (row_t) { job, step };
+	}
+
+	if (!job->track_steps) {
+		job->first_step_ptr = list_peek(job->steps);
+		_set_stats(&job->stats, i);
+	}
+
+	return job;
+}
+
+/* Write the records to path, RET 0 on success */
+static int _write(List job_list, char *path)
+{
+	ListIterator itr = list_iterator_create(job_list);
+	slurmdb_job_rec_t *job;
+	int fd, saved_fd;
+
+	if ((fd = mkstemp(path)) < 0)
+		return -1;
+	fflush(stdout);
+	saved_fd = dup(STDOUT_FILENO);
+	dup2(fd, STDOUT_FILENO);
+	close(fd);
+
+	columnar_begin();
+	while ((job = list_next(itr))) {
+		ListIterator step_itr = list_iterator_create(job->steps);
+		slurmdb_step_rec_t *step;
+
+		columnar_add(JOB, job);
+		while ((step = list_next(step_itr)))
+			columnar_add(JOBSTEP, step);
+		list_iterator_destroy(step_itr);
+	}
+	columnar_end();
+	list_iterator_destroy(itr);
+
+	fflush(stdout);
+	dup2(saved_fd, STDOUT_FILENO);
+	close(saved_fd);
+	return 0;
+}
+
+/* Decode the header, RET 0 if it is as written for g_tres_list */
+static int _read_header(Buf buffer)
+{
+	char magic[8], *str;
+	uint16_t version;
+	uint32_t cnt, id, len;
+	ListIterator itr;
+	slurmdb_tres_rec_t *tres;
+	char *type, *name;
+	int rc = SLURM_SUCCESS;
+
+	if (unpackmem_array(magic, sizeof(magic), buffer) ||
+	    memcmp(magic, "SACCTCOL", sizeof(magic)) ||
+	    unpack16(&version, buffer) || (version != 1) ||
+	    unpack32(&cnt, buffer) || (cnt != list_count(g_tres_list)))
+		return SLURM_ERROR;
+
+	itr = list_iterator_create(g_tres_list);
+	while ((tres = list_next(itr))) {
+		if (unpack32(&id, buffer) ||
+		    unpackmem_ptr(&type, &len, buffer) ||
+		    unpackmem_ptr(&name, &len, buffer) ||
+		    (id != tres->id) || xstrcmp(type, tres->type) ||
+		    xstrcmp(name, tres->name)) {
+			rc = SLURM_ERROR;
+			break;
+		}
+	}
+	list_iterator_destroy(itr);
+	if (rc)
+		return rc;
+
+	if (unpack32(&column_cnt, buffer))
+		return SLURM_ERROR;
+	columns = xcalloc(column_cnt, sizeof(column_t));
+	for (int i = 0; i < column_cnt; i++) {
+		if (unpackmem_ptr(&str, &len, buffer) || !str ||
+		    unpack8(&columns[i].type, buffer) ||
+		    (columns[i].type < 1) || (columns[i].type > 3))
+			return SLURM_ERROR;
+		columns[i].name = str;
+		if (columns[i].type == 3)
+			columns[i].strs = xcalloc(row_cnt, sizeof(char *));
+		else
+			columns[i].ints = xcalloc(row_cnt, sizeof(uint64_t));
+	}
+
+	return SLURM_SUCCESS;
+}
+
+/* Decode the row groups, RET number of groups or -1 on error */
+static int _read_rows(Buf buffer)
+{
+	uint32_t cnt, size, len, u32;
+	int groups = 0, done = 0;
+
+	while (!unpack32(&cnt, buffer) && cnt) {
+		if ((done + cnt) > row_cnt)
+			return -1;
+		for (int i = 0; i < column_cnt; i++) {
+			column_t *col = &columns[i];
+			uint32_t end;
+
+			if (unpack32(&size, buffer))
+				return -1;
+			end = get_buf_offset(buffer) + size;
+			for (int r = done; r < done + cnt; r++) {
+				if (col->type == 1) {
+					if (unpack32(&u32, buffer))
+						return -1;
+					col->ints[r] = u32;
+				} else if (col->type == 2) {
+					if (unpack64(&col->ints[r], buffer))
+						return -1;
+				} else if (unpackmem_ptr(&col->strs[r], &len,
+							 buffer))
+					return -1;
+			}
+			if (get_buf_offset(buffer) != end)
+				return -1;
+		}
+		done += cnt;
+		groups++;
+	}
+
+	if (cnt || (done != row_cnt) || remaining_buf(buffer))
+		return -1;
+	return groups;
+}
+
+static column_t *_col(char *name)
+{
+	for (int i = 0; i < column_cnt; i++)
+		if (!xstrcmp(columns[i].name, name))
+			return &columns[i];
+	fail(name);
+	return NULL;
+}
+
+/* RET number of rows whose values differ from their records */
+static int _check_rows(void)
+{
+	column_t *row_type = _col("RowType"), *job_id = _col("JobID");
+	column_t *step_id = _col("StepID"), *cluster = _col("Cluster");
+	column_t *job_name = _col("JobName"), *uid = _col("UID");
+	column_t *state = _col("State"), *submit = _col("Submit");
+	column_t *start = _col("Start"), *req_mem = _col("ReqMem");
+	column_t *nnodes = _col("NNodes"), *ntasks = _col("NTasks");
+	column_t *nodes = _col("NodeList"), *energy = _col("ConsumedEnergy");
+	column_t *tres = _col("AllocTRES"), *in_max = _col("TRESUsageInMax");
+	column_t *in_max_node = _col("TRESUsageInMaxNodeID");
+	int bad = 0;
+
+	if (!row_type || !job_id || !step_id || !cluster || !job_name ||
+	    !uid || !state || !submit || !start || !req_mem || !nnodes ||
+	    !ntasks || !nodes || !energy || !tres || !in_max || !in_max_node)
+		return row_cnt;
+
+	for (int r = 0; r < row_cnt; r++) {
+		slurmdb_job_rec_t *job = rows[r].job;
+		slurmdb_step_rec_t *step = rows[r].step;
+		slurmdb_stats_t *stats = NULL;
+		uint32_t exp_ntasks = NO_VAL;
+
+		if (step) {
+			stats = &step->stats;
+			exp_ntasks = step->ntasks;
+		} else if (!job->track_steps) {
+			slurmdb_step_rec_t *first_step = job->first_step_ptr;
+
+			stats = &job->stats;
+			exp_ntasks = first_step->ntasks;
+		}
+
+		if ((row_type->ints[r] != (step ? 1 : 0)) ||
+		    (job_id->ints[r] != job->jobid) ||
+		    (step_id->ints[r] !=
+		     (step ? step->step_id.step_id : NO_VAL)) ||
+		    xstrcmp(cluster->strs[r], job->cluster) ||
+		    xstrcmp(job_name->strs[r],
+			    step ? step->stepname : job->jobname) ||
+		    (uid->ints[r] != job->uid) ||
+		    (state->ints[r] != (step ? step->state : job->state)) ||
+		    (submit->ints[r] != job->submit) ||
+		    (start->ints[r] != (step ? step->start : job->start)) ||
+		    (req_mem->ints[r] != job->req_mem) ||
+		    (nnodes->ints[r] !=
+		     (step ? step->nnodes : job->alloc_nodes)) ||
+		    (ntasks->ints[r] != exp_ntasks) ||
+		    xstrcmp(nodes->strs[r], step ? step->nodes : job->nodes) ||
+		    (energy->ints[r] !=
+		     (stats ? stats->consumed_energy : NO_VAL64)) ||
+		    xstrcmp(tres->strs[r], step ? step->tres_alloc_str :
+			    job->tres_alloc_str) ||
+		    xstrcmp(in_max->strs[r],
+			    stats ? stats->tres_usage_in_max : NULL) ||
+		    xstrcmp(in_max_node->strs[r],
+			    stats ? stats->tres_usage_in_max_nodeid : NULL))
+			bad++;
+	}
+
+	return bad;
+}
+
+int
+main(int argc, char *argv[])
+{
+	char path[] = "/tmp/sacct-columnar-test.XXXXXX";
+	List job_list = list_create(NULL);
+	Buf buffer = NULL;
+	int groups;
+
+	g_tres_list = list_create(NULL);
+	_add_tres(1, "cpu", NULL);
+	_add_tres(2, "mem", NULL);
+	_add_tres(1001, "gres", "gpu");
+
+	rows = xcalloc(JOB_CNT * 3, sizeof(row_t));
+	for (int i = 0; i < JOB_CNT; i++)
+		list_append(job_list, _make_job(i));
+
+	TEST(!_write(job_list, path) && (buffer = create_mmap_buf(path)),
+	     "records written");
+	if (!buffer) {
+		totals();
+		return failed;
+	}
+	note("%d rows written in %u bytes", row_cnt, size_buf(buffer));
+
+	TEST(!_read_header(buffer), "header read back");
+	TEST((column_cnt > 50) && _col("TRESUsageOutTot"), "all columns");
+
+	groups = _read_rows(buffer);
+	TEST(groups > 1, "rows read back in several row groups");
+	if (groups > 0)
+		TEST(!_check_rows(), "rows match their records");
+
+	free_buf(buffer);
+	unlink(path);
+
+	totals();
+	return failed;
+}
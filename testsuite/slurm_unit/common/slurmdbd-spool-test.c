@@ -0,0 +1,218 @@
+/*
+ * Test of the slurmdbd agent spool in
+ * src/plugins/accounting_storage/slurmdbd/slurmdbd_spool.c
+ *
+ * Spools records, reads them back in order, reopens the spool with records
+ * in flight and with a torn record at its end, and fills more than one
+ * segment.
+ *
+ * Avoid duplicate wait() symbol definition (in both testsuite/dejagnu.h
+ * and sys/wait.h
+ */
+#define _SYS_WAIT_H 1
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "slurm/slurm_errno.h"
+#include "src/common/pack.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include "src/plugins/accounting_storage/slurmdbd/slurmdbd_spool.h"
+#include <testsuite/dejagnu.h>
+
+/*
+ * Test for failure:
+ */
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define BIG_REC_SIZE (4 * 1024 * 1024)
+#define BIG_REC_CNT 20
+
+const char plugin_type[] = "accounting_storage/slurmdbd";
+
+static char *spool_dir = NULL;
+
+/* Record i holds i in its first bytes, and is filled up to size */
+static int _append(uint32_t i, uint32_t size)
+{
+	Buf buffer = init_buf(size);
+	int rc;
+
+	pack32(i, buffer);
+	memset(get_buf_data(buffer) + sizeof(uint32_t), i & 0xff,
+	       size - sizeof(uint32_t));
+	set_buf_offset(buffer, size);
+	rc = slurmdbd_spool_append(buffer);
+	free_buf(buffer);
+	return rc;
+}
+
+/* Read the next record, RET its number or -1 if it is missing or bad */
+static int _read(uint32_t size)
+{
+	Buf buffer = slurmdbd_spool_read();
+	uint32_t i;
+	char *data;
+
+	if (!buffer)
+		return -1;
+	data = get_buf_data(buffer);
+	set_buf_offset(buffer, 0);
+	if ((size_buf(buffer) != size) || unpack32(&i, buffer) ||
+	    (data[size - 1] != (char) (i & 0xff))) {
+		free_buf(buffer);
+		return -1;
+	}
+	free_buf(buffer);
+	return i;
+}
+
+static int _seg_cnt(void)
+{
+	DIR *dp = opendir(spool_dir);
+	struct dirent *ent;
+	int cnt = 0;
+
+	if (!dp)
+		return -1;
+	while ((ent = readdir(dp)))
+		if (!strncmp(ent->d_name, "seg.", 4))
+			cnt++;
+	closedir(dp);
+	return cnt;
+}
+
+/* Leave half a record behind the last one, as a crash during a write */
+static void _tear_last_seg(void)
+{
+	DIR *dp = opendir(spool_dir);
+	struct dirent *ent;
+	char *fname = NULL, *last = NULL;
+	uint32_t torn[2] = { 100, 0 };
+	int fd;
+
+	while (dp && (ent = readdir(dp)))
+		if (!strncmp(ent->d_name, "seg.", 4) &&
+		    (xstrcmp(ent->d_name, last) > 0)) {
+			xfree(last);
+			last = xstrdup(ent->d_name);
+		}
+	if (dp)
+		closedir(dp);
+	fname = xstrdup_printf("%s/%s", spool_dir, last);
+	if ((fd = open(fname, O_WRONLY | O_APPEND)) >= 0) {
+		if (write(fd, torn, sizeof(torn)) != sizeof(torn))
+			fail("write torn record");
+		close(fd);
+	}
+	xfree(fname);
+	xfree(last);
+}
+
+int
+main(int argc, char *argv[])
+{
+	char tmpl[] = "/tmp/slurmdbd-spool-test.XXXXXX", *cmd;
+	int i, bad, fd;
+
+	if (!mkdtemp(tmpl)) {
+		fail("mkdtemp");
+		totals();
+		return failed;
+	}
+	spool_dir = xstrdup_printf("%s/dbd.spool", tmpl);
+
+	TEST(slurmdbd_spool_open(spool_dir, false) == ENOENT,
+	     "missing spool not created");
+	TEST(slurmdbd_spool_open(spool_dir, true) == SLURM_SUCCESS,
+	     "spool created");
+
+	for (i = 0, bad = 0; i < 1000; i++)
+		if (_append(i, 16 + (i % 200)) != SLURM_SUCCESS)
+			bad++;
+	TEST(!bad && (slurmdbd_spool_unread() == 1000), "records appended");
+
+	/* Appends are synced in batches */
+	TEST(slurmdbd_spool_unsynced() == 1000, "appended records not synced");
+	fd = slurmdbd_spool_sync();
+	TEST(fd >= 0, "batch of records due for sync");
+	slurmdbd_spool_flush(fd);
+	TEST(!slurmdbd_spool_unsynced() && (slurmdbd_spool_sync() < 0),
+	     "nothing left to sync");
+
+	/* Read 300, acknowledge 200, leave 100 in flight */
+	for (i = 0, bad = 0; i < 300; i++)
+		if (_read(16 + (i % 200)) != i)
+			bad++;
+	for (i = 0; i < 200; i++)
+		slurmdbd_spool_ack();
+	TEST(!bad && (slurmdbd_spool_unread() == 700) &&
+	     (slurmdbd_spool_inflight() == 100), "records read in order");
+	slurmdbd_spool_close();
+
+	/* Records in flight are read again after a restart */
+	TEST(slurmdbd_spool_open(spool_dir, false) == SLURM_SUCCESS,
+	     "spool reopened");
+	TEST((slurmdbd_spool_unread() == 800) && !slurmdbd_spool_inflight(),
+	     "unacknowledged records pending after reopen");
+	TEST(_read(16 + (200 % 200)) == 200,
+	     "reading resumes at the first unacknowledged record");
+	slurmdbd_spool_ack();
+	slurmdbd_spool_close();
+
+	/* A torn record is dropped, records appended after it are kept */
+	_tear_last_seg();
+	TEST(slurmdbd_spool_open(spool_dir, false) == SLURM_SUCCESS,
+	     "spool with torn record reopened");
+	TEST(slurmdbd_spool_unread() == 799, "torn record dropped");
+	TEST(_append(1000, 64) == SLURM_SUCCESS, "append after torn record");
+	for (i = 201, bad = 0; i < 1000; i++) {
+		if (_read(16 + (i % 200)) != i)
+			bad++;
+		slurmdbd_spool_ack();
+	}
+	TEST(!bad && (_read(64) == 1000), "all records read back in order");
+	slurmdbd_spool_ack();
+	TEST(!slurmdbd_spool_unread() && !slurmdbd_spool_inflight() &&
+	     (_seg_cnt() == 1), "drained spool starts over");
+
+	/* More than a segment worth, read while appending */
+	for (i = 0, bad = 0; i < BIG_REC_CNT; i++) {
+		if (_append(i, BIG_REC_SIZE) != SLURM_SUCCESS)
+			bad++;
+		if (i && !(i % 4)) {
+			if (_read(BIG_REC_SIZE) != (i / 4) - 1)
+				bad++;
+		}
+	}
+	TEST(!bad && (_seg_cnt() > 1), "records spread over segments");
+	slurmdbd_spool_close();
+	TEST(slurmdbd_spool_open(spool_dir, false) == SLURM_SUCCESS,
+	     "spool of several segments reopened");
+	for (i = 0, bad = 0; i < BIG_REC_CNT; i++) {
+		if (_read(BIG_REC_SIZE) != i)
+			bad++;
+		slurmdbd_spool_ack();
+	}
+	TEST(!bad && !slurmdbd_spool_unread() && (_seg_cnt() == 1),
+	     "segments read back in order and removed");
+	slurmdbd_spool_close();
+
+	cmd = xstrdup_printf("rm -rf %s", tmpl);
+	if (system(cmd))
+		note("unable to remove %s", tmpl);
+	xfree(cmd);
+	xfree(spool_dir);
+
+	totals();
+	return failed;
+}
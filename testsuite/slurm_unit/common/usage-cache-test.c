@@ -0,0 +1,184 @@
+/*
+ * Test of the cache of summed usage in
+ * src/plugins/accounting_storage/mysql/as_mysql_usage_cache.c
+ *
+ * Caches results and reads them back, drops them per cluster and on
+ * association changes, and does not keep results of queries that ran while
+ * the cache was being cleared.
+ *
+ * Avoid duplicate wait() symbol definition (in both testsuite/dejagnu.h
+ * and sys/wait.h
+ */
+#define _SYS_WAIT_H 1
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "slurm/slurmdb.h"
+#include "src/common/list.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+#include "src/plugins/accounting_storage/mysql/as_mysql_usage_cache.h"
+#include <testsuite/dejagnu.h>
+
+/*
+ * Test for failure:
+ */
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define COL_CNT 3
+
+static void _set_key(usage_cache_t *key, char *cluster, char *id_str,
+		     time_t start)
+{
+	memset(key, 0, sizeof(*key));
+	key->cluster_name = cluster;
+	key->col_cnt = COL_CNT;
+	key->start = start;
+	key->end = start + 3600;
+	key->id_str = id_str;
+	key->table = "assoc_usage_hour_table";
+	key->type = DBD_GET_ASSOC_USAGE;
+}
+
+/* Look key up and add rows rows of values derived from seed on a miss */
+static void _fill(usage_cache_t *key, uint32_t rows, uint64_t seed)
+{
+	uint64_t *values = NULL;
+	uint32_t row_cnt = 0, i;
+
+	if (as_mysql_usage_cache_get(key, &values, &row_cnt)) {
+		xfree(values);
+		return;
+	}
+	values = xcalloc(rows ? rows : 1, sizeof(uint64_t) * COL_CNT);
+	for (i = 0; i < (rows * COL_CNT); i++)
+		values[i] = seed + i;
+	as_mysql_usage_cache_add(key, values, rows);
+	xfree(values);
+}
+
+/* Return true if key is cached with the values _fill() gave it */
+static bool _cached(usage_cache_t *key, uint32_t rows, uint64_t seed)
+{
+	uint64_t *values = NULL;
+	uint32_t row_cnt = 0, i;
+	bool ok;
+
+	if (!as_mysql_usage_cache_get(key, &values, &row_cnt))
+		return false;
+	ok = (row_cnt == rows);
+	for (i = 0; ok && (i < (rows * COL_CNT)); i++)
+		ok = (values[i] == (seed + i));
+	xfree(values);
+	return ok;
+}
+
+static List _update_list(slurmdb_update_type_t type, char *cluster)
+{
+	List update_list = list_create(slurmdb_destroy_update_object);
+	slurmdb_update_object_t *object = xmalloc(sizeof(*object));
+	slurmdb_assoc_rec_t *assoc = xmalloc(sizeof(*assoc));
+
+	slurmdb_init_assoc_rec(assoc, false);
+	assoc->cluster = xstrdup(cluster);
+	object->type = type;
+	object->objects = list_create(slurmdb_destroy_assoc_rec);
+	list_append(object->objects, assoc);
+	list_append(update_list, object);
+
+	return update_list;
+}
+
+int
+main(int argc, char *argv[])
+{
+	usage_cache_t key_a, key_b, key_c;
+	List update_list;
+	char id_str[32];
+	int i, bad;
+
+	_set_key(&key_a, "alpha", "t1.id_assoc=2", 0);
+	_set_key(&key_b, "beta", "t1.id_assoc=2", 0);
+	_set_key(&key_c, "alpha", "t1.id_assoc=3", 0);
+
+	TEST(!_cached(&key_a, 10, 1), "empty cache misses");
+	_fill(&key_a, 10, 1);
+	_fill(&key_b, 5, 100);
+	TEST(_cached(&key_a, 10, 1) && _cached(&key_b, 5, 100),
+	     "cached results read back");
+	TEST(!_cached(&key_c, 10, 1), "other ids miss");
+	_fill(&key_c, 0, 0);
+	TEST(_cached(&key_c, 0, 0), "empty result cached");
+
+	as_mysql_usage_cache_clear("alpha");
+	TEST(!_cached(&key_a, 10, 1) && !_cached(&key_c, 0, 0) &&
+	     _cached(&key_b, 5, 100), "cleared cluster only");
+
+	/* A query that missed before a clear may have read old rows */
+	TEST(!_cached(&key_a, 10, 1), "miss before clear");
+	as_mysql_usage_cache_clear("beta");
+	as_mysql_usage_cache_add(&key_a, NULL, 0);
+	TEST(!_cached(&key_a, 0, 0), "result of a query across a clear dropped");
+
+	_fill(&key_a, 10, 1);
+	_fill(&key_b, 5, 100);
+	update_list = _update_list(SLURMDB_MODIFY_WCKEY, "alpha");
+	as_mysql_usage_cache_update(update_list);
+	FREE_NULL_LIST(update_list);
+	TEST(_cached(&key_a, 10, 1), "wckey change keeps association usage");
+
+	update_list = _update_list(SLURMDB_ADD_ASSOC, "alpha");
+	as_mysql_usage_cache_update(update_list);
+	FREE_NULL_LIST(update_list);
+	TEST(!_cached(&key_a, 10, 1) && _cached(&key_b, 5, 100),
+	     "association add drops usage of its cluster");
+
+	_fill(&key_a, 10, 1);
+	update_list = _update_list(SLURMDB_MODIFY_ASSOC, "alpha");
+	as_mysql_usage_cache_update(update_list);
+	FREE_NULL_LIST(update_list);
+	TEST(!_cached(&key_a, 10, 1),
+	     "association change (e.g. lft and rgt) drops usage");
+
+	_fill(&key_a, 10, 1);
+	update_list = _update_list(SLURMDB_REMOVE_ASSOC, NULL);
+	as_mysql_usage_cache_update(update_list);
+	FREE_NULL_LIST(update_list);
+	TEST(!_cached(&key_a, 10, 1) && !_cached(&key_b, 5, 100),
+	     "association removal without a cluster drops everything");
+
+	/* Least recently used results go first */
+	_fill(&key_a, 10, 1);
+	for (i = 0; i < USAGE_CACHE_MAX_ENTRIES; i++) {
+		snprintf(id_str, sizeof(id_str), "t1.id_assoc=%d", 100 + i);
+		_set_key(&key_c, "beta", id_str, 0);
+		_fill(&key_c, 1, i);
+		if (i == (USAGE_CACHE_MAX_ENTRIES / 2))
+			(void) _cached(&key_a, 10, 1);
+	}
+	TEST(_cached(&key_a, 10, 1), "recently used result kept");
+	for (i = 0, bad = 0; i < USAGE_CACHE_MAX_ENTRIES; i++) {
+		snprintf(id_str, sizeof(id_str), "t1.id_assoc=%d", 100 + i);
+		_set_key(&key_c, "beta", id_str, 0);
+		if (!_cached(&key_c, 1, i))
+			bad++;
+	}
+	TEST(bad == 1, "least recently used result evicted");
+
+	_set_key(&key_c, "alpha", "t1.id_assoc=4", 0);
+	_fill(&key_c, USAGE_CACHE_MAX_ROWS + 1, 0);
+	TEST(!_cached(&key_c, USAGE_CACHE_MAX_ROWS + 1, 0),
+	     "large result not cached");
+
+	as_mysql_usage_cache_clear(NULL);
+	TEST(!_cached(&key_a, 10, 1), "cache emptied");
+
+	totals();
+	return failed;
+}